@@ -42,7 +42,7 @@
 #endif
 
 /// LLPC major interface version.
-#define LLPC_INTERFACE_MAJOR_VERSION 40
+#define LLPC_INTERFACE_MAJOR_VERSION 41
 
 /// LLPC minor interface version.
 #define LLPC_INTERFACE_MINOR_VERSION 0
@@ -287,6 +287,17 @@ struct PipelineOptions {
 /// Prototype of allocator for output data buffer, used in shader-specific operations.
 typedef void *(VKAPI_CALL *OutputAllocFunc)(void *pInstance, void *pUserData, size_t size);
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+/// Prototype of the notification callback for a shader stage completing during a relocatable pipeline build.
+/// It is called once per active stage with the unlinked stage ELF, as soon as the stage has been retrieved from
+/// a cache (fromCache is true) or freshly compiled, so the client can overlap dependent work such as cache
+/// insertion or upload staging with the remaining stages' compilation and the final link. The ELF data is only
+/// valid for the duration of the call, and the callback may be invoked concurrently from the compiler's worker
+/// threads.
+typedef void(VKAPI_CALL *StageElfReadyFunc)(void *pInstance, void *pUserData, ShaderStage stage,
+                                            const BinaryData *pStageElf, bool fromCache);
+#endif
+
 /// Enumerates types of shader binary.
 enum class BinaryType : unsigned {
   Unknown = 0, ///< Invalid type
@@ -321,13 +332,21 @@ struct ShaderModuleUsage {
   bool useSubgroupSize;        ///< Whether gl_SubgroupSize is used
   bool useHelpInvocation;      ///< Whether fragment shader has helper-invocation for subgroup
   bool useSpecConstant;        ///< Whether specializaton constant is used
+  bool specConstantsFoldable;  ///< Whether every specialization constant is a scalar whose value can be substituted
+                               ///  after translation, so one translation serves all specializations
   bool keepUnusedFunctions;    ///< Whether to keep unused function
   bool useIsNan;               ///< Whether IsNan is used
+  bool trustedMode;            ///< Whether the client guarantees the binary already passed external validation
+                               ///  (e.g. spirv-val), allowing the translator to skip redundant operand checks
+  bool useFp16;                ///< Whether 16-bit floating-point types are declared in the module
+  bool useFp64;                ///< Whether 64-bit floating-point types are declared in the module
+  bool useFpArith;             ///< Whether any floating-point arithmetic or conversion appears in the module
 };
 
 /// Represents common part of shader module data
 struct ShaderModuleData {
-  unsigned hash[4];        ///< Shader hash code
+  unsigned hash[4];        ///< 128-bit digest of the shader binary, computed once at module build time; folded
+                           ///  into per-pipeline hashes instead of rehashing the code bytes
   BinaryType binType;      ///< Shader binary type
   BinaryData binCode;      ///< Shader binary data
   unsigned cacheHash[4];   ///< Hash code for calculate pipeline cache key
@@ -349,6 +368,10 @@ struct ShaderModuleDataEx {
   unsigned entryOffset;     ///< Shader entry offset in ShaderModuleDataEx
   unsigned resNodeOffset;   ///< Resource node offset in ShaderModuleDataEX
   unsigned fsOutInfoOffset; ///< FsOutInfo offset in ShaderModuleDataEX
+  unsigned spirvOffset;     ///< Offset of the retained SPIR-V binary in ShaderModuleDataEx. Only present (spirvSize
+                            ///  is non-zero) when the module was pre-lowered to bitcode but uses specialization
+                            ///  constants, so pipelines that specialize can retranslate from SPIR-V.
+  unsigned spirvSize;       ///< Size of the retained SPIR-V binary in bytes
   struct {
     unsigned fsOutInfoCount;             ///< Count of fragment shader output
     const FsOutInfo *pFsOutInfos;        ///< Fragment output info array
@@ -500,6 +523,13 @@ struct PipelineShaderOptions {
 
   /// Forcibly disable loop unrolling - overrides any explicit unroll directives
   bool disableLoopUnroll;
+
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  /// Precision tier for transcendental functions the compiler expands to ALU sequences (asin, acos, atan,
+  /// pow, ...): 0 = full precision (default), 1 = relaxed (shorter minimax expansions, absolute error around
+  /// 1e-4), 2 = fast (shortest expansions, absolute error around 5e-3).
+  unsigned transcendentalPrecision;
+#endif
 };
 
 /// Represents YCbCr sampler meta data in resource descriptor
@@ -600,6 +630,10 @@ struct GraphicsPipelineBuildInfo {
   OutputAllocFunc pfnOutputAlloc; ///< Output buffer allocator
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38 || LLPC_ENABLE_SHADER_CACHE
   IShaderCache *pShaderCache; ///< Shader cache, used to search for the compiled shader data
+#endif
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  StageElfReadyFunc pfnStageElfReady; ///< If non-null, called with each unlinked stage ELF as it completes
+                                      ///  during a relocatable pipeline build
 #endif
   PipelineShaderInfo vs;  ///< Vertex shader
   PipelineShaderInfo tcs; ///< Tessellation control shader
@@ -660,6 +694,10 @@ struct ComputePipelineBuildInfo {
   OutputAllocFunc pfnOutputAlloc; ///< Output buffer allocator
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38 || LLPC_ENABLE_SHADER_CACHE
   IShaderCache *pShaderCache; ///< Shader cache, used to search for the compiled shader data
+#endif
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  StageElfReadyFunc pfnStageElfReady; ///< If non-null, called with each unlinked stage ELF as it completes
+                                      ///  during a relocatable pipeline build
 #endif
   unsigned deviceIndex;    ///< Device index for device group
   PipelineShaderInfo cs;   ///< Compute shader
@@ -275,6 +275,13 @@ Value *ArithBuilder::CreateFma(Value *a, Value *b, Value *c, const Twine &instNa
   return CreateIntrinsic(Intrinsic::fma, a->getType(), {a, b, c}, nullptr, instName);
 }
 
+// =====================================================================================================================
+// Gets the transcendental precision tier for the shader being built. Expansions below select shorter minimax
+// polynomials for the relaxed and fast tiers; full precision keeps the existing sequences.
+TranscendentalPrecision ArithBuilder::getTranscendentalPrecision() {
+  return getPipelineState()->getShaderOptions(m_shaderStage).transcendentalPrecision;
+}
+
 // =====================================================================================================================
 // Create a "tan" operation for a scalar or vector float or half.
 //
@@ -301,12 +308,23 @@ Value *ArithBuilder::CreateASin(Value *x, const Twine &instName) {
     x = CreateFPExt(x, extTy);
   }
 
-  // atan2(x, y), y = sqrt(1 - x * x)
-  Value *y = CreateFMul(x, x);
-  Value *one = ConstantFP::get(x->getType(), 1.0);
-  y = CreateFSub(one, y);
-  y = CreateUnaryIntrinsic(Intrinsic::sqrt, y);
-  Value *result = CreateATan2(x, y);
+  Value *result = nullptr;
+  if (getTranscendentalPrecision() == TranscendentalPrecision::Full) {
+    // atan2(x, y), y = sqrt(1 - x * x)
+    Value *y = CreateFMul(x, x);
+    Value *one = ConstantFP::get(x->getType(), 1.0);
+    y = CreateFSub(one, y);
+    y = CreateUnaryIntrinsic(Intrinsic::sqrt, y);
+    result = CreateATan2(x, y);
+  } else {
+    // Relaxed/fast tiers: use the same sqrt-scaled polynomial shape as acos (absolute error below 1e-4, with
+    // coefficients fitted for this shape) instead of the much longer atan2-based expansion.
+    // asin coefficient p0 = 0.0827
+    auto coefP0 = getFpConstant(x->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0x3FB52BD3C0000000)));
+    // asin coefficient p1 = -0.02545
+    auto coefP1 = getFpConstant(x->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0xBF9A0F90A0000000)));
+    result = aSinACosCommon(x, coefP0, coefP1);
+  }
 
   result = CreateFPTrunc(result, origTy);
   result->setName(instName);
@@ -380,38 +398,65 @@ Value *ArithBuilder::CreateATan(Value *yOverX, const Twine &instName) {
   Value *min = CreateBinaryIntrinsic(Intrinsic::minnum, absX, one);
   Value *boundedX = CreateFMul(min, CreateFDiv(one, max));
   Value *square = CreateFMul(boundedX, boundedX);
-  Value *cube = CreateFMul(square, boundedX);
-  Value *pow5 = CreateFMul(cube, square);
-  Value *pow7 = CreateFMul(pow5, square);
-  Value *pow9 = CreateFMul(pow7, square);
-  Value *pow11 = CreateFMul(pow9, square);
-
-  // coef1 = 0.99997932
-  auto coef1 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0x3FEFFFD4A0000000)));
-  // coef3 = -0.33267564
-  auto coef3 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0xBFD54A8EC0000000)));
-  // coef5 = 0.19389249
-  auto coef5 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0x3FC8D17820000000)));
-  // coef7 = -0.11735032
-  auto coef7 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0xBFBE0AABA0000000)));
-  // coef9 = 0.05368138
-  auto coef9 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0x3FAB7C2020000000)));
-  // coef11 = -0.01213232
-  auto coef11 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0xBF88D8D4A0000000)));
-
-  Value *term1 = CreateFMul(boundedX, coef1);
-  Value *term3 = CreateFMul(cube, coef3);
-  Value *term5 = CreateFMul(pow5, coef5);
-  Value *term7 = CreateFMul(pow7, coef7);
-  Value *term9 = CreateFMul(pow9, coef9);
-  Value *term11 = CreateFMul(pow11, coef11);
-
-  Value *result = CreateFAdd(term1, term3);
-  result = CreateFAdd(result, term5);
-  result = CreateFAdd(result, term7);
-  result = CreateFAdd(result, term9);
-  Value *partialResult = CreateFAdd(result, term11);
-  result = CreateFMul(partialResult, ConstantFP::get(yOverX->getType(), -2.0));
+
+  Value *partialResult = nullptr;
+  const TranscendentalPrecision precision = getTranscendentalPrecision();
+  if (precision == TranscendentalPrecision::Full) {
+    Value *cube = CreateFMul(square, boundedX);
+    Value *pow5 = CreateFMul(cube, square);
+    Value *pow7 = CreateFMul(pow5, square);
+    Value *pow9 = CreateFMul(pow7, square);
+    Value *pow11 = CreateFMul(pow9, square);
+
+    // coef1 = 0.99997932
+    auto coef1 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0x3FEFFFD4A0000000)));
+    // coef3 = -0.33267564
+    auto coef3 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0xBFD54A8EC0000000)));
+    // coef5 = 0.19389249
+    auto coef5 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0x3FC8D17820000000)));
+    // coef7 = -0.11735032
+    auto coef7 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0xBFBE0AABA0000000)));
+    // coef9 = 0.05368138
+    auto coef9 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0x3FAB7C2020000000)));
+    // coef11 = -0.01213232
+    auto coef11 = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, 0xBF88D8D4A0000000)));
+
+    Value *term1 = CreateFMul(boundedX, coef1);
+    Value *term3 = CreateFMul(cube, coef3);
+    Value *term5 = CreateFMul(pow5, coef5);
+    Value *term7 = CreateFMul(pow7, coef7);
+    Value *term9 = CreateFMul(pow9, coef9);
+    Value *term11 = CreateFMul(pow11, coef11);
+
+    Value *result = CreateFAdd(term1, term3);
+    result = CreateFAdd(result, term5);
+    result = CreateFAdd(result, term7);
+    result = CreateFAdd(result, term9);
+    partialResult = CreateFAdd(result, term11);
+  } else {
+    // Shorter minimax polynomials in odd powers of x on [-1, 1], evaluated with Horner's scheme, highest
+    // coefficient first:
+    // relaxed: degree 9 (Abramowitz & Stegun 4.4.49), absolute error <= 1e-5
+    //          0.0208351, -0.0851330, 0.1801410, -0.3302995, 0.9998660
+    // fast: degree 3 minimax, absolute error around 5e-3
+    //       -0.19194795, 0.97239411
+    static const uint64_t RelaxedCoefs[] = {0x3F9555CBE0000000, 0xBFB5CB46C0000000, 0x3FC70EDC40000000,
+                                            0xBFD523A080000000, 0x3FEFFEE700000000};
+    static const uint64_t FastCoefs[] = {0xBFC891C020000000, 0x3FEF1DDA40000000};
+
+    ArrayRef<uint64_t> coefs(RelaxedCoefs);
+    if (precision == TranscendentalPrecision::Fast)
+      coefs = FastCoefs;
+
+    Value *sum = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, coefs[0])));
+    for (uint64_t coef : coefs.drop_front()) {
+      Value *next = getFpConstant(yOverX->getType(), APFloat(APFloat::IEEEdouble(), APInt(64, coef)));
+      sum = CreateFAdd(CreateFMul(sum, square), next);
+    }
+    partialResult = CreateFMul(boundedX, sum);
+  }
+
+  Value *result = CreateFMul(partialResult, ConstantFP::get(yOverX->getType(), -2.0));
   result = CreateFAdd(result, getPiByTwo(yOverX->getType()));
   Value *outsideBound = CreateSelect(CreateFCmpOGT(absX, one), one, zero);
   result = CreateFMul(outsideBound, result);
@@ -593,8 +638,9 @@ Value *ArithBuilder::CreatePower(Value *x, Value *y, const Twine &instName) {
   if (x == ConstantFP::get(x->getType(), 2.0))
     return CreateUnaryIntrinsic(Intrinsic::exp2, y, nullptr, instName);
 
-  // llvm.pow only works with (vector of) float.
-  if (x->getType()->getScalarType()->isFloatTy())
+  // llvm.pow only works with (vector of) float. In the relaxed and fast tiers drop to the exp2/log2 expansion
+  // below instead; the hardware exp2 and log2 ops are single VALU instructions.
+  if (x->getType()->getScalarType()->isFloatTy() && getTranscendentalPrecision() == TranscendentalPrecision::Full)
     return CreateBinaryIntrinsic(Intrinsic::pow, x, y, nullptr, instName);
 
   // pow(x, y) = exp2(y * log2(x))
@@ -45,7 +45,37 @@ using namespace llvm;
 // @param instName : Name to give instruction
 CallInst *BuilderBase::CreateNamedCall(StringRef funcName, Type *retTy, ArrayRef<Value *> args,
                                        ArrayRef<Attribute::AttrKind> attribs, const Twine &instName) {
+  Function *func = getNamedCallee(funcName, retTy, args, attribs);
+  auto call = CreateCall(func, args, instName);
+  call->setCallingConv(CallingConv::C);
+  call->setAttributes(func->getAttributes());
+
+  return call;
+}
+
+// =====================================================================================================================
+// Get the declaration for the named callee in the current module, creating it if necessary. The interned cache
+// lets repeated internal calls bypass the module symbol table string map; it relies on callees not being erased
+// from the module while this builder is still emitting calls, which holds for the llpc.*/lgc.* declarations as
+// the cleanup of unused ones only happens in later patch passes with their own builders.
+//
+// @param funcName : Name of the callee
+// @param retTy : Return type of the callee
+// @param args : Arguments to pass to the callee
+// @param attribs : Function attributes
+Function *BuilderBase::getNamedCallee(StringRef funcName, Type *retTy, ArrayRef<Value *> args,
+                                      ArrayRef<Attribute::AttrKind> attribs) {
   Module *module = GetInsertBlock()->getParent()->getParent();
+  if (module != m_calleeModule) {
+    // First call emitted into this module; drop callees interned from any previous module.
+    m_internedCallees.clear();
+    m_calleeModule = module;
+  }
+
+  auto cached = m_internedCallees.find(CachedHashStringRef(funcName));
+  if (cached != m_internedCallees.end())
+    return cached->second;
+
   Function *func = dyn_cast_or_null<Function>(module->getFunction(funcName));
   if (!func) {
     SmallVector<Type *, 8> argTys;
@@ -63,11 +93,9 @@ CallInst *BuilderBase::CreateNamedCall(StringRef funcName, Type *retTy, ArrayRef
       func->addFnAttr(attrib);
   }
 
-  auto call = CreateCall(func, args, instName);
-  call->setCallingConv(CallingConv::C);
-  call->setAttributes(func->getAttributes());
-
-  return call;
+  // Key the cache entry off the function's own name storage, which outlives any caller-formatted name.
+  m_internedCallees[CachedHashStringRef(func->getName())] = func;
+  return func;
 }
 
 // =====================================================================================================================
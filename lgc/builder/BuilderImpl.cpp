@@ -61,15 +61,17 @@ ShaderModes *BuilderImplBase::getShaderModes() {
 // @param vector2 : The float vector 2
 // @param instName : Name to give instruction(s)
 Value *BuilderImplBase::CreateDotProduct(Value *const vector1, Value *const vector2, const Twine &instName) {
-  Value *product = CreateFMul(vector1, vector2);
-  if (!isa<VectorType>(product->getType()))
-    return product;
+  if (!isa<VectorType>(vector1->getType()))
+    return CreateFMul(vector1, vector2, instName);
 
-  const unsigned compCount = cast<VectorType>(product->getType())->getNumElements();
-  Value *scalar = CreateExtractElement(product, uint64_t(0));
+  // Chain the products through fmuladd, so the backend selects one fused multiply-add per component instead of
+  // a separate multiply and add chain.
+  const unsigned compCount = cast<VectorType>(vector1->getType())->getNumElements();
+  Value *scalar = CreateFMul(CreateExtractElement(vector1, uint64_t(0)), CreateExtractElement(vector2, uint64_t(0)));
 
   for (unsigned i = 1; i < compCount; ++i)
-    scalar = CreateFAdd(scalar, CreateExtractElement(product, i));
+    scalar = CreateIntrinsic(Intrinsic::fmuladd, scalar->getType(),
+                             {CreateExtractElement(vector1, i), CreateExtractElement(vector2, i), scalar});
 
   scalar->setName(instName);
   return scalar;
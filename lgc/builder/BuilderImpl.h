@@ -32,6 +32,8 @@
 
 #include "lgc/Builder.h"
 #include "lgc/state/PipelineState.h"
+#include <map>
+#include <tuple>
 
 namespace lgc {
 
@@ -202,6 +204,9 @@ private:
   // Common code for asin and acos
   llvm::Value *aSinACosCommon(llvm::Value *x, llvm::Constant *coefP0, llvm::Constant *coefP1);
 
+  // Get the transcendental precision tier for the shader being built.
+  TranscendentalPrecision getTranscendentalPrecision();
+
   // Generate FP division, using fast fdiv for float to bypass optimization.
   llvm::Value *fDivFast(llvm::Value *numerator, llvm::Value *denominator);
 
@@ -298,10 +303,20 @@ private:
   llvm::Value *getDescPtrAndStride(ResourceNodeType resType, unsigned descSet, unsigned binding,
                                    const ResourceNode *topNode, const ResourceNode *node, bool shadow);
 
+  // Get a struct containing the pointer and byte stride for a descriptor, reusing a cached one where possible
+  llvm::Value *getCachedDescPtrAndStride(ResourceNodeType resType, unsigned descSet, unsigned binding,
+                                         const ResourceNode *topNode, const ResourceNode *node, bool shadow);
+
   // Get a pointer to a descriptor, as a pointer to i8
   llvm::Value *getDescPtr(ResourceNodeType resType, unsigned descSet, unsigned binding, const ResourceNode *topNode,
                           const ResourceNode *node, bool shadow);
 
+  // Get the descriptor table base pointer for a descriptor set, shared per function
+  llvm::Value *getDescTablePtr(unsigned descSet, unsigned highHalf);
+
+  // Get the spill table pointer, shared per function
+  llvm::Value *getSpillTablePtr();
+
   llvm::Value *scalarizeIfUniform(llvm::Value *value, bool isNonUniform);
 
   // Calculate a buffer descriptor for an inline buffer
@@ -309,6 +324,20 @@ private:
 
   // Build buffer compact descriptor
   llvm::Value *buildBufferCompactDesc(llvm::Value *desc);
+
+  // Cache of descriptor pointers hoisted to the function entry block, keyed on function, descriptor type and
+  // (set, binding). Lets repeated image operations on the same binding share one descriptor load instead of
+  // leaving one load per operation for later passes to CSE away.
+  std::map<std::tuple<llvm::Function *, unsigned, unsigned, unsigned>, llvm::Value *> m_descPtrCache;
+  // Descriptors loaded from cached descriptor pointers; an entry exists (initially null) for each cached pointer
+  std::map<llvm::Value *, llvm::Value *> m_loadedDescCache;
+  // Descriptor table base pointers (lgc.descriptor.set calls), keyed on function, descriptor set and high address
+  // half, derived once per function in the entry block so every binding in a set shares one base derivation.
+  // Together with the caches above this groups a function's descriptor setup and loads at the function entry,
+  // where the backend can merge the adjacent scalar loads into wide cache-line-filling ones.
+  std::map<std::tuple<llvm::Function *, unsigned, unsigned>, llvm::Value *> m_descTablePtrCache;
+  // Spill table pointers (lgc.spill.table calls), derived once per function in the entry block
+  std::map<llvm::Function *, llvm::Value *> m_spillTablePtrCache;
 };
 
 // =====================================================================================================================
@@ -402,6 +431,11 @@ private:
                                        llvm::ArrayRef<llvm::Value *> address, const llvm::Twine &instName,
                                        bool isSample);
 
+  // Generate the expanded code for an image sample with YCbCr conversion.
+  llvm::Value *createYCbCrImageSampleInternal(llvm::Type *resultTy, unsigned dim, unsigned flags,
+                                              llvm::Value *imageDesc, llvm::Value *convertingSamplerDesc,
+                                              llvm::ArrayRef<llvm::Value *> address, const llvm::Twine &instName);
+
   // Common code for CreateImageAtomic and CreateImageAtomicCompareSwap
   llvm::Value *CreateImageAtomicCommon(unsigned atomicOp, unsigned dim, unsigned flags, llvm::AtomicOrdering ordering,
                                        llvm::Value *imageDesc, llvm::Value *coord, llvm::Value *inputValue,
@@ -34,6 +34,8 @@
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/ShaderModes.h"
 #include "lgc/util/Internal.h"
+#include "llvm/ADT/STLExtras.h"
+#include <vector>
 
 #define DEBUG_TYPE "lgc-builder-recorder"
 
@@ -1818,6 +1820,42 @@ Value *BuilderRecorder::CreateSubgroupMbcnt(Value *const mask, const Twine &inst
 // @param instName : Name to give instruction
 Instruction *BuilderRecorder::record(BuilderRecorder::Opcode opcode, Type *resultTy, ArrayRef<Value *> args,
                                      const Twine &instName) {
+  // Look up the cached declaration for this opcode and return type, so a recorded call normally costs no more
+  // than the CreateCall. The cache is keyed on the Type pointer, which the LLVMContext uniques, so it stands in
+  // for the mangled name. The builder records into one module per shader stage; reset the cache on a new module.
+  Module *const module = GetInsertBlock()->getModule();
+  if (module != m_declModule) {
+    m_declModule = module;
+    m_callDecls.clear();
+    m_callDecls.resize(Opcode::Count);
+  }
+
+  Function *func = nullptr;
+  auto &decls = m_callDecls[opcode];
+  for (const auto &decl : decls) {
+    if (decl.first == resultTy) {
+      func = decl.second;
+      break;
+    }
+  }
+  if (!func) {
+    func = getCallDecl(opcode, resultTy, module);
+    decls.push_back({resultTy, func});
+  }
+
+  // Create the call.
+  auto call = CreateCall(func, args, instName);
+
+  return call;
+}
+
+// =====================================================================================================================
+// Get the lgc.create.* declaration for the given opcode and return type, creating it on first use.
+//
+// @param opcode : Opcode of Builder method call being recorded
+// @param resultTy : Return type (can be nullptr for void)
+// @param module : Module being recorded into
+Function *BuilderRecorder::getCallDecl(BuilderRecorder::Opcode opcode, Type *resultTy, Module *module) {
   // Create mangled name of builder call. This only needs to be mangled on return type.
   std::string mangledName;
   {
@@ -1832,7 +1870,6 @@ Instruction *BuilderRecorder::record(BuilderRecorder::Opcode opcode, Type *resul
   }
 
   // See if the declaration already exists in the module.
-  Module *const module = GetInsertBlock()->getModule();
   Function *func = dyn_cast_or_null<Function>(module->getFunction(mangledName));
   if (!func) {
     // Does not exist. Create it as a varargs function.
@@ -1990,32 +2027,34 @@ Instruction *BuilderRecorder::record(BuilderRecorder::Opcode opcode, Type *resul
     }
   }
 
-  // Create the call.
-  auto call = CreateCall(func, args, instName);
-
-  return call;
+  return func;
 }
 
 // =====================================================================================================================
 // Get the recorded call opcode from the function name. Asserts if not found.
-// This does not have to be particularly efficient, as it is only used with the lgc command-line utility.
+// This is only the fallback for IR without opcode metadata on the declarations (the lgc command-line utility
+// reading "amdllpc -emit-lgc" output); compiles driven through BuilderReplayer read the opcode from the
+// metadata and never come here. The mangled name carries a type suffix after the opcode name, so the lookup
+// is a longest-prefix match over a table of the opcode names, built once and sorted by descending length so
+// the first prefix hit is the longest one.
 //
 // @param name : Name of function declaration
 // @return : Opcode
 BuilderRecorder::Opcode BuilderRecorder::getOpcodeFromName(StringRef name) {
   assert(name.startswith(BuilderCallPrefix));
   name = name.drop_front(strlen(BuilderCallPrefix));
-  unsigned bestOpcode = 0;
-  unsigned bestLength = 0;
-  for (unsigned opcode = 0; opcode != Opcode::Count; ++opcode) {
-    StringRef opcodeName = getCallName(static_cast<Opcode>(opcode));
-    if (name.startswith(opcodeName)) {
-      if (opcodeName.size() > bestLength) {
-        bestLength = opcodeName.size();
-        bestOpcode = opcode;
-      }
-    }
+  static const std::vector<std::pair<StringRef, unsigned>> namesByDescendingLength = [] {
+    std::vector<std::pair<StringRef, unsigned>> names;
+    for (unsigned opcode = 0; opcode != Opcode::Count; ++opcode)
+      names.push_back({getCallName(static_cast<Opcode>(opcode)), opcode});
+    llvm::sort(names.begin(), names.end(),
+               [](const auto &lhs, const auto &rhs) { return lhs.first.size() > rhs.first.size(); });
+    return names;
+  }();
+  for (const auto &entry : namesByDescendingLength) {
+    if (name.startswith(entry.first))
+      return static_cast<Opcode>(entry.second);
   }
-  assert(bestLength != 0 && "No matching lgc.create.* name found!");
-  return static_cast<Opcode>(bestOpcode);
+  llvm_unreachable("No matching lgc.create.* name found!");
+  return Opcode::Nop;
 }
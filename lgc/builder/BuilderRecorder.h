@@ -31,6 +31,7 @@
 #pragma once
 
 #include "lgc/Builder.h"
+#include <vector>
 #ifndef NDEBUG
 #include "llvm/IR/ValueHandle.h"
 #endif
@@ -553,9 +554,18 @@ private:
   llvm::Instruction *record(Opcode opcode, llvm::Type *returnTy, llvm::ArrayRef<llvm::Value *> args,
                             const llvm::Twine &instName);
 
+  // Get the lgc.create.* declaration for the given opcode and return type, creating it on first use
+  llvm::Function *getCallDecl(Opcode opcode, llvm::Type *resultTy, llvm::Module *module);
+
   PipelineState *m_pipelineState;             // PipelineState; nullptr for shader compile
   std::unique_ptr<ShaderModes> m_shaderModes; // ShaderModes for a shader compile
   bool m_omitOpcodes;                         // Omit opcodes on lgc.create.* function declarations
+
+  // Cache of lgc.create.* declarations, indexed by opcode and keyed by return type. Type pointers are uniqued
+  // in the LLVMContext, so the (opcode, type) pair identifies the mangled name without rebuilding it on every
+  // recorded call. The cache belongs to one module and is reset when recording moves to another module.
+  llvm::Module *m_declModule = nullptr; // Module the cached declarations belong to
+  std::vector<llvm::SmallVector<std::pair<llvm::Type *, llvm::Function *>, 2>> m_callDecls; // Cached declarations
 };
 
 // Create BuilderReplayer pass
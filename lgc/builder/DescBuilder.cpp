@@ -175,6 +175,26 @@ Value *DescBuilder::CreateLoadDescFromPtr(Value *descPtrStruct, const Twine &ins
   // Mark usage of images, to allow the compute workgroup reconfiguration optimization.
   getPipelineState()->getShaderResourceUsage(m_shaderStage)->useImages = true;
 
+  // If this is a cached descriptor pointer hoisted to the function entry, load it only once, next to the pointer
+  // computation, so every image operation on the same (set, binding) shares one load.
+  auto cacheIt = m_loadedDescCache.find(descPtrStruct);
+  if (cacheIt != m_loadedDescCache.end()) {
+    if (!cacheIt->second) {
+      InsertPoint savedInsertPoint = saveIP();
+      if (auto descPtrStructInst = dyn_cast<Instruction>(descPtrStruct)) {
+        SetInsertPoint(descPtrStructInst->getNextNode());
+      } else {
+        // The whole pointer struct constant-folded (e.g. an immutable sampler); load at the start of the entry block.
+        BasicBlock &entryBlock = GetInsertBlock()->getParent()->getEntryBlock();
+        SetInsertPoint(&entryBlock, entryBlock.begin());
+      }
+      Value *descPtr = CreateExtractValue(descPtrStruct, 0);
+      cacheIt->second = CreateLoad(descPtr->getType()->getPointerElementType(), descPtr, instName);
+      restoreIP(savedInsertPoint);
+    }
+    return cacheIt->second;
+  }
+
   Value *descPtr = CreateExtractValue(descPtrStruct, 0);
   return CreateLoad(descPtr->getType()->getPointerElementType(), descPtr, instName);
 }
@@ -199,7 +219,8 @@ Value *DescBuilder::CreateGetSamplerDescPtr(unsigned descSet, unsigned binding,
   }
 
   // Get the descriptor pointer and stride as a struct.
-  return getDescPtrAndStride(ResourceNodeType::DescriptorSampler, descSet, binding, topNode, node, /*shadow=*/false);
+  return getCachedDescPtrAndStride(ResourceNodeType::DescriptorSampler, descSet, binding, topNode, node,
+                                   /*shadow=*/false);
 }
 
 // =====================================================================================================================
@@ -222,7 +243,8 @@ Value *DescBuilder::CreateGetImageDescPtr(unsigned descSet, unsigned binding, co
   }
 
   // Get the descriptor pointer and stride as a struct.
-  return getDescPtrAndStride(ResourceNodeType::DescriptorResource, descSet, binding, topNode, node, /*shadow=*/false);
+  return getCachedDescPtrAndStride(ResourceNodeType::DescriptorResource, descSet, binding, topNode, node,
+                                   /*shadow=*/false);
 }
 
 // =====================================================================================================================
@@ -246,8 +268,8 @@ Value *DescBuilder::CreateGetTexelBufferDescPtr(unsigned descSet, unsigned bindi
   }
 
   // Get the descriptor pointer and stride as a struct.
-  return getDescPtrAndStride(ResourceNodeType::DescriptorTexelBuffer, descSet, binding, topNode, node,
-                             /*shadow=*/false);
+  return getCachedDescPtrAndStride(ResourceNodeType::DescriptorTexelBuffer, descSet, binding, topNode, node,
+                                   /*shadow=*/false);
 }
 
 // =====================================================================================================================
@@ -277,7 +299,7 @@ Value *DescBuilder::CreateGetFmaskDescPtr(unsigned descSet, unsigned binding, co
   }
 
   // Get the descriptor pointer and stride as a struct.
-  return getDescPtrAndStride(ResourceNodeType::DescriptorFmask, descSet, binding, topNode, node, shadow);
+  return getCachedDescPtrAndStride(ResourceNodeType::DescriptorFmask, descSet, binding, topNode, node, shadow);
 }
 
 // =====================================================================================================================
@@ -297,6 +319,41 @@ Value *DescBuilder::CreateLoadPushConstantsPtr(Type *pushConstantsTy, const Twin
   return CreateNamedCall(callName, returnTy, {}, Attribute::ReadOnly, instName);
 }
 
+// =====================================================================================================================
+// Get a struct containing the pointer and byte stride for a descriptor, reusing a cached one if the same descriptor
+// has already been referenced in this function.
+//
+// The pointer computation is generated at the start of the function entry block, so the cached value (and the
+// descriptor subsequently loaded from it in CreateLoadDescFromPtr) dominates all of its uses.
+//
+// @param resType : Resource type
+// @param descSet : Descriptor set
+// @param binding : Binding
+// @param topNode : Node in top-level descriptor table (nullptr for shader compilation)
+// @param node : The descriptor node itself (nullptr for shader compilation)
+// @param shadow : Whether to load from shadow descriptor table
+Value *DescBuilder::getCachedDescPtrAndStride(ResourceNodeType resType, unsigned descSet, unsigned binding,
+                                              const ResourceNode *topNode, const ResourceNode *node, bool shadow) {
+  Function *func = GetInsertBlock()->getParent();
+  auto cacheKey = std::make_tuple(func, static_cast<unsigned>(resType), descSet, binding);
+  auto cacheIt = m_descPtrCache.find(cacheKey);
+  if (cacheIt != m_descPtrCache.end())
+    return cacheIt->second;
+
+  // Not seen before in this function. Generate the pointer computation at the start of the entry block.
+  InsertPoint savedInsertPoint = saveIP();
+  BasicBlock &entryBlock = func->getEntryBlock();
+  SetInsertPoint(&entryBlock, entryBlock.begin());
+  Value *descPtrAndStride = getDescPtrAndStride(resType, descSet, binding, topNode, node, shadow);
+  restoreIP(savedInsertPoint);
+
+  m_descPtrCache[cacheKey] = descPtrAndStride;
+  // NOTE: Two keys can yield the same constant-folded struct (e.g. the same immutable sampler bound twice), so do
+  // not clobber a descriptor that has already been loaded from it.
+  m_loadedDescCache.insert({descPtrAndStride, nullptr});
+  return descPtrAndStride;
+}
+
 // =====================================================================================================================
 // Get a struct containing the pointer and byte stride for a descriptor
 //
@@ -419,19 +476,14 @@ Value *DescBuilder::getDescPtr(ResourceNodeType resType, unsigned descSet, unsig
     // The descriptor is in the top-level table. (This can only happen for a DescriptorBuffer.) Contrary
     // to what used to happen, we just load from the spill table, so we can get a pointer to the descriptor.
     // The spill table gets returned as a pointer to array of i8.
-    descPtr =
-        CreateNamedCall(lgcName::SpillTable, getInt8Ty()->getPointerTo(ADDR_SPACE_CONST), {}, Attribute::ReadNone);
+    descPtr = getSpillTablePtr();
     // Ensure we mark spill table usage.
     getPipelineState()->getPalMetadata()->setUserDataSpillUsage(node->offsetInDwords);
   } else {
     // Get the descriptor table pointer for the set, which might be passed as a user SGPR to the shader.
-    // The args to the lgc.descriptor.set call are:
-    // - descriptor set number
-    // - value for high 32 bits of pointer; HighAddrPc to use PC
     // TODO Shader compilation: For the "shadow" case, the high half of the address needs to be a reloc.
     unsigned highHalf = shadow ? m_pipelineState->getOptions().shadowDescriptorTable : HighAddrPc;
-    descPtr = CreateNamedCall(lgcName::DescriptorSet, getInt8Ty()->getPointerTo(ADDR_SPACE_CONST),
-                              {getInt32(descSet), getInt32(highHalf)}, Attribute::ReadNone);
+    descPtr = getDescTablePtr(descSet, highHalf);
   }
 
   // Add on the byte offset of the descriptor.
@@ -474,6 +526,55 @@ Value *DescBuilder::getDescPtr(ResourceNodeType resType, unsigned descSet, unsig
   return descPtr;
 }
 
+// =====================================================================================================================
+// Get the descriptor table base pointer for a descriptor set, deriving it once per function in the entry block
+// so every binding in the set shares one base derivation, and so all descriptor setup in a function groups
+// together at the entry where the backend can merge the adjacent scalar loads.
+//
+// The args to the lgc.descriptor.set call are:
+// - descriptor set number
+// - value for high 32 bits of pointer; HighAddrPc to use PC
+//
+// @param descSet : Descriptor set
+// @param highHalf : Value for high 32 bits of the pointer, or HighAddrPc to use PC
+Value *DescBuilder::getDescTablePtr(unsigned descSet, unsigned highHalf) {
+  Function *func = GetInsertBlock()->getParent();
+  auto cacheKey = std::make_tuple(func, descSet, highHalf);
+  auto cacheIt = m_descTablePtrCache.find(cacheKey);
+  if (cacheIt != m_descTablePtrCache.end())
+    return cacheIt->second;
+
+  InsertPoint savedInsertPoint = saveIP();
+  BasicBlock &entryBlock = func->getEntryBlock();
+  SetInsertPoint(&entryBlock, entryBlock.begin());
+  Value *descTablePtr = CreateNamedCall(lgcName::DescriptorSet, getInt8Ty()->getPointerTo(ADDR_SPACE_CONST),
+                                        {getInt32(descSet), getInt32(highHalf)}, Attribute::ReadNone);
+  restoreIP(savedInsertPoint);
+
+  m_descTablePtrCache[cacheKey] = descTablePtr;
+  return descTablePtr;
+}
+
+// =====================================================================================================================
+// Get the spill table pointer, deriving it once per function in the entry block so all descriptors read from the
+// top-level table share one derivation.
+Value *DescBuilder::getSpillTablePtr() {
+  Function *func = GetInsertBlock()->getParent();
+  auto cacheIt = m_spillTablePtrCache.find(func);
+  if (cacheIt != m_spillTablePtrCache.end())
+    return cacheIt->second;
+
+  InsertPoint savedInsertPoint = saveIP();
+  BasicBlock &entryBlock = func->getEntryBlock();
+  SetInsertPoint(&entryBlock, entryBlock.begin());
+  Value *spillTablePtr =
+      CreateNamedCall(lgcName::SpillTable, getInt8Ty()->getPointerTo(ADDR_SPACE_CONST), {}, Attribute::ReadNone);
+  restoreIP(savedInsertPoint);
+
+  m_spillTablePtrCache[func] = spillTablePtr;
+  return spillTablePtr;
+}
+
 // =====================================================================================================================
 // Scalarize a value (pass it through readfirstlane) if uniform
 //
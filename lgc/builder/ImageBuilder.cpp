@@ -772,6 +772,91 @@ Value *ImageBuilder::CreateImageSampleConvert(Type *resultTy, unsigned dim, unsi
 Value *ImageBuilder::CreateImageSampleConvertYCbCr(Type *resultTy, unsigned dim, unsigned flags, Value *imageDesc,
                                                    Value *convertingSamplerDesc, ArrayRef<Value *> address,
                                                    const Twine &instName) {
+  // The converting sampler descriptor is always a constant here; the YCbCr metadata in its last four dwords
+  // selects the conversion code to generate.
+  auto samplerDescConst = cast<Constant>(convertingSamplerDesc);
+
+  // A non-uniform sample needs the descriptor load chain visible at the sample site so the waterfall loop can
+  // find the non-uniform index, so expand it in place.
+  if (flags & (ImageFlagNonUniformImage | ImageFlagNonUniformSampler))
+    return createYCbCrImageSampleInternal(resultTy, dim, flags, imageDesc, convertingSamplerDesc, address, instName);
+
+  // The conversion expands to a few hundred IR instructions, and the same converting sampler is typically sampled
+  // from many sites in a shader. Outline the expansion into an internal always-inline helper function keyed on
+  // everything the generated code depends on, so each distinct conversion is only generated once per module; the
+  // existing inliner passes put the code back into the shader before optimization.
+  SmallVector<Value *, 8> args;
+  SmallVector<unsigned, 8> presentAddressIdxs;
+  args.push_back(imageDesc);
+  for (unsigned idx = 0; idx != address.size(); ++idx) {
+    if (address[idx]) {
+      args.push_back(address[idx]);
+      presentAddressIdxs.push_back(idx);
+    }
+  }
+
+  std::string helperName;
+  {
+    raw_string_ostream nameStream(helperName);
+    nameStream << lgcName::YCbCrSampleHelper;
+    for (unsigned compIdx = 0; compIdx != 8; ++compIdx)
+      nameStream << cast<ConstantInt>(samplerDescConst->getAggregateElement(compIdx))->getZExtValue() << ".";
+    // The generated code and its resource usage side-effects depend on the shader stage, so key on that too.
+    nameStream << dim << "." << flags << "." << static_cast<unsigned>(m_shaderStage);
+    for (unsigned idx : presentAddressIdxs)
+      nameStream << "." << idx;
+    for (Value *arg : args) {
+      nameStream << ".";
+      getTypeName(arg->getType(), nameStream);
+    }
+    nameStream << ".";
+    getTypeName(resultTy, nameStream);
+  }
+
+  Module *const module = GetInsertBlock()->getModule();
+  Function *helper = module->getFunction(helperName);
+  if (!helper) {
+    SmallVector<Type *, 8> argTys;
+    for (Value *arg : args)
+      argTys.push_back(arg->getType());
+    helper =
+        Function::Create(FunctionType::get(resultTy, argTys, false), GlobalValue::InternalLinkage, helperName, module);
+    helper->addFnAttr(Attribute::NoUnwind);
+    helper->addFnAttr(Attribute::AlwaysInline);
+
+    // Generate the conversion code into the new function, then restore the insert point.
+    InsertPoint savedInsertPoint = saveIP();
+    SetInsertPoint(BasicBlock::Create(getContext(), "", helper));
+
+    auto argIt = helper->arg_begin();
+    Value *helperImageDesc = &*argIt++;
+    SmallVector<Value *, 8> helperAddress(address.size(), nullptr);
+    for (unsigned idx : presentAddressIdxs)
+      helperAddress[idx] = &*argIt++;
+
+    CreateRet(
+        createYCbCrImageSampleInternal(resultTy, dim, flags, helperImageDesc, samplerDescConst, helperAddress, ""));
+    restoreIP(savedInsertPoint);
+  }
+
+  return CreateCall(helper, args, instName);
+}
+
+// =====================================================================================================================
+// Generate the expanded code for an image sample with a converting sampler.
+// The caller supplies all arguments to the image sample op in "address", in the order specified
+// by the indices defined as ImageAddressIdx* below.
+//
+// @param resultTy : Result type
+// @param dim : Image dimension
+// @param flags : ImageFlag* flags
+// @param imageDesc : Image descriptor
+// @param convertingSamplerDesc : Converting sampler descriptor (v8i32)
+// @param address : Address and other arguments
+// @param instName : Name to give instruction(s)
+Value *ImageBuilder::createYCbCrImageSampleInternal(Type *resultTy, unsigned dim, unsigned flags, Value *imageDesc,
+                                                    Value *convertingSamplerDesc, ArrayRef<Value *> address,
+                                                    const Twine &instName) {
   Value *result = nullptr;
 
   // Helper function to extract YCbCr meta data from ycbcrSamplerDesc
@@ -287,7 +287,7 @@ void InOutBuilder::markGenericInputOutputUsage(bool isOutput, unsigned location,
   auto resUsage = getPipelineState()->getShaderResourceUsage(m_shaderStage);
 
   // Mark the input or output locations as in use.
-  std::map<unsigned, unsigned> *inOutLocMap = nullptr;
+  LocationMap *inOutLocMap = nullptr;
   if (!isOutput) {
     if (m_shaderStage != ShaderStageTessEval || vertexIndex) {
       // Normal input
@@ -140,14 +140,16 @@ Value *MatrixBuilder::CreateMatrixTimesVector(Value *const matrix, Value *const
   const unsigned rowCount = cast<VectorType>(columnTy)->getNumElements();
   Value *result = nullptr;
 
+  // Accumulate whole columns with fmuladd, so the backend can select fused multiply-adds at the vector width
+  // (packed-math pairs for 16-bit components) instead of re-vectorizing separate multiplies and adds.
   for (unsigned i = 0; i < matrix->getType()->getArrayNumElements(); ++i) {
     SmallVector<int, 4> shuffleMask(rowCount, i);
-    auto partialResult = CreateShuffleVector(vector, vector, shuffleMask);
-    partialResult = CreateFMul(CreateExtractValue(matrix, i), partialResult);
+    auto splatVector = CreateShuffleVector(vector, vector, shuffleMask);
+    auto column = CreateExtractValue(matrix, i);
     if (result)
-      result = CreateFAdd(result, partialResult);
+      result = CreateIntrinsic(Intrinsic::fmuladd, columnTy, {column, splatVector, result});
     else
-      result = partialResult;
+      result = CreateFMul(column, splatVector);
   }
 
   result->setName(instName);
@@ -490,12 +490,15 @@ Value *SubgroupBuilder::CreateSubgroupClusteredReduction(GroupArithOp groupArith
                                          createPermLaneX16(result, result, UINT32_MAX, UINT32_MAX, true, false)),
           result);
 
-      Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
-      Value *const broadcast63 = CreateSubgroupBroadcast(result, getInt32(63), instName);
+      // Only needed for wave size 64; on wave32 a cluster can never span more than the wave.
+      if (getShaderSubgroupSize() == 64) {
+        Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
+        Value *const broadcast63 = CreateSubgroupBroadcast(result, getInt32(63), instName);
 
-      // Combine broadcast from the 31st and 63rd for the final result.
-      result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(64)),
-                            createGroupArithmeticOperation(groupArithOp, broadcast31, broadcast63), result);
+        // Combine broadcast from the 31st and 63rd for the final result.
+        result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(64)),
+                              createGroupArithmeticOperation(groupArithOp, broadcast31, broadcast63), result);
+      }
     } else {
       // Use a row broadcast to move the 15th element in each cluster of 16 to the next cluster. The row mask is
       // set to 0xa (0b1010) so that only the 2nd and 4th clusters of 16 perform the calculation.
@@ -648,13 +651,16 @@ Value *SubgroupBuilder::CreateSubgroupClusteredInclusive(GroupArithOp groupArith
       result = CreateSelect(CreateICmpUGE(clusterSize, getInt32(32)),
                             createGroupArithmeticOperation(groupArithOp, result, maskedPermLane), result);
 
-      Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
+      // Only needed for wave size 64; on wave32 a cluster can never span more than the wave.
+      if (getShaderSubgroupSize() == 64) {
+        Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
 
-      Value *const maskedBroadcast = createThreadMaskedSelect(threadMask, 0xFFFFFFFF00000000, broadcast31, identity);
+        Value *const maskedBroadcast = createThreadMaskedSelect(threadMask, 0xFFFFFFFF00000000, broadcast31, identity);
 
-      // Combine broadcast of 31 with the top two rows only.
-      result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(64)),
-                            createGroupArithmeticOperation(groupArithOp, result, maskedBroadcast), result);
+        // Combine broadcast of 31 with the top two rows only.
+        result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(64)),
+                              createGroupArithmeticOperation(groupArithOp, result, maskedBroadcast), result);
+      }
     } else {
       // The DPP operation has a row mask of 0xa (0b1010) so only the 2nd and 4th clusters of 16 perform the
       // operation.
@@ -825,13 +831,16 @@ Value *SubgroupBuilder::CreateSubgroupClusteredExclusive(GroupArithOp groupArith
       result = CreateSelect(CreateICmpUGE(clusterSize, getInt32(32)),
                             createGroupArithmeticOperation(groupArithOp, result, maskedPermLane), result);
 
-      Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
+      // Only needed for wave size 64; on wave32 a cluster can never span more than the wave.
+      if (getShaderSubgroupSize() == 64) {
+        Value *const broadcast31 = CreateSubgroupBroadcast(result, getInt32(31), instName);
 
-      Value *const maskedBroadcast = createThreadMaskedSelect(threadMask, 0xFFFFFFFF00000000, broadcast31, identity);
+        Value *const maskedBroadcast = createThreadMaskedSelect(threadMask, 0xFFFFFFFF00000000, broadcast31, identity);
 
-      // Combine broadcast of 31 with the top two rows only.
-      result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(64)),
-                            createGroupArithmeticOperation(groupArithOp, result, maskedBroadcast), result);
+        // Combine broadcast of 31 with the top two rows only.
+        result = CreateSelect(CreateICmpEQ(clusterSize, getInt32(64)),
+                              createGroupArithmeticOperation(groupArithOp, result, maskedBroadcast), result);
+      }
     } else {
       // The DPP operation has a row mask of 0xa (0b1010) so only the 2nd and 4th clusters of 16 perform the
       // operation.
@@ -440,14 +440,11 @@ Value *YCbCrConverter::generateSamplerDesc(Value *samplerDesc, SamplerFilter fil
   //     XyFilterAnisotropicLinear,  ///< Use anisotropic with linear sampling
   //     XyFilterCount
   // };
-  if ((filter == SamplerFilter::Nearest) || forceExplicitReconstruction) {
-    imgRegHelper.setReg(SqSampRegs::xyMagFilter, m_builder->getInt32(0b00));
-    imgRegHelper.setReg(SqSampRegs::xyMinFilter, m_builder->getInt32(0b00));
-  } else // filter == SamplerFilter::Linear
-  {
-    imgRegHelper.setReg(SqSampRegs::xyMagFilter, m_builder->getInt32(0b01));
-    imgRegHelper.setReg(SqSampRegs::xyMinFilter, m_builder->getInt32(0b01));
-  }
+  // XyMagFilter and XyMinFilter are adjacent in the descriptor, so both are set with one masked write
+  if ((filter == SamplerFilter::Nearest) || forceExplicitReconstruction)
+    imgRegHelper.setReg(SqSampRegs::xyMagMinFilter, m_builder->getInt32(0b0000));
+  else // filter == SamplerFilter::Linear
+    imgRegHelper.setReg(SqSampRegs::xyMagMinFilter, m_builder->getInt32(0b0101));
 
   return imgRegHelper.getRegister();
 }
@@ -93,6 +93,9 @@ public:
   // Get the output file offset of a particular input section in the output section
   uint64_t getOutputOffset(unsigned inputIdx) { return m_offset + m_inputSections[inputIdx].offset; }
 
+  // Get the output file offset of this section. Only valid once the section has been written.
+  uint64_t getOffset() const { return m_offset; }
+
   // Get the overall alignment requirement, after calling layout().
   uint64_t getAlignment() const { return m_alignment; }
 
@@ -135,6 +138,9 @@ public:
   // -----------------------------------------------------------------------------------------------------------------
   // Implementations of ElfLinker methods exposed to the front-end
 
+  // Add a further unlinked ELF input after the linker was created
+  void addInputElf(MemoryBufferRef elf) override final;
+
   // Get information on the glue code that will be needed for the link
   llvm::ArrayRef<StringRef> getGlueInfo() override final;
 
@@ -167,6 +173,9 @@ private:
   // Get the value of the symbol referenced in a reloc
   uint64_t getRelocValue(object::RelocationRef reloc);
 
+  // Find the symbol of the given name defined in the output ELF
+  unsigned findDefinedSymbol(StringRef name);
+
   // Find where an input section contributes to an output section
   std::pair<unsigned, unsigned> findInputSection(ElfInput &elfInput, object::SectionRef section);
 
@@ -186,6 +195,8 @@ private:
   RelocHandler m_relocHandler;                               // RelocHandler object
   SmallVector<ElfInput, 5> m_elfInputs;                      // ELF objects to link
   SmallVector<std::unique_ptr<GlueShader>, 4> m_glueShaders; // Glue shaders needed for link
+  bool m_fetchShaderCreated = false;                         // Whether a fetch shader has been created
+  bool m_colorExportShaderCreated = false;                   // Whether a color export shader has been created
   SmallVector<StringRef, 5> m_glueStrings;                   // Strings to return for glue shader cache keys
   ELF::Elf64_Ehdr m_ehdr;                                    // Output ELF header, copied from first input
   SmallVector<OutputSection, 4> m_outputSections;            // Output sections
@@ -223,20 +234,29 @@ inline uint64_t cantFail(uint64_t value, const char *Msg = nullptr) {
 // @param elfs : Array of unlinked ELF modules to link
 ElfLinkerImpl::ElfLinkerImpl(PipelineState *pipelineState, ArrayRef<MemoryBufferRef> elfs)
     : m_pipelineState(pipelineState), m_relocHandler(pipelineState) {
-  // For each input ELF, create an ELF object for it.
-  for (auto elfBuffer : elfs)
-    m_elfInputs.push_back({cantFail(object::ObjectFile::createELFObjectFile(elfBuffer))});
-
-  // Gather and merge PAL metadata.
   m_pipelineState->clearPalMetadata();
-  for (auto &elfInput : m_elfInputs)
-    mergePalMetadataFromElf(*elfInput.objectFile);
+  for (auto elfBuffer : elfs)
+    addInputElf(elfBuffer);
+}
 
-  // Create any needed glue shaders.
+// =====================================================================================================================
+// Add a further unlinked ELF input. Inputs may also arrive after construction, so that a client can create the
+// linker over the ELFs it already has and pre-compile glue shaders while the remaining stages compile; all
+// inputs must be added before link() is called.
+//
+// @param elfBuffer : Unlinked ELF module to add
+void ElfLinkerImpl::addInputElf(MemoryBufferRef elfBuffer) {
+  // Populate the output ELF header from the first input.
+  if (m_elfInputs.empty())
+    memcpy(&m_ehdr, elfBuffer.getBuffer().data(), sizeof(ELF::Elf64_Ehdr));
+
+  // Create an ELF object for the input and merge its PAL metadata.
+  m_elfInputs.push_back({cantFail(object::ObjectFile::createELFObjectFile(elfBuffer))});
+  mergePalMetadataFromElf(*m_elfInputs.back().objectFile);
+
+  // (Re)check whether the PAL metadata seen so far calls for glue shaders; for example the fetch shader can
+  // only be discovered once the input carrying the vertex-processing metadata has been added.
   createGlueShaders();
-
-  // Populate output ELF header
-  memcpy(&m_ehdr, elfs[0].getBuffer().data(), sizeof(ELF::Elf64_Ehdr));
 }
 
 // =====================================================================================================================
@@ -248,14 +268,28 @@ ElfLinkerImpl::~ElfLinkerImpl() {
 // Create a GlueShader object for each glue shader needed for this link. This does not actually create
 // the glue shaders themselves, just the GlueShader objects that represent them.
 void ElfLinkerImpl::createGlueShaders() {
-  // Create a fetch shader object if we need one.
-  SmallVector<VertexFetchInfo, 8> fetches;
-  m_pipelineState->getPalMetadata()->getVertexFetchInfo(fetches);
-  if (!fetches.empty()) {
-    VsEntryRegInfo vsEntryRegInfo = {};
-    m_pipelineState->getPalMetadata()->getVsEntryRegInfo(vsEntryRegInfo);
-    m_glueShaders.push_back(
-        std::unique_ptr<GlueShader>(GlueShader::createFetchShader(m_pipelineState, fetches, vsEntryRegInfo)));
+  // Create a fetch shader object if we need one and do not have one already.
+  if (!m_fetchShaderCreated) {
+    SmallVector<VertexFetchInfo, 8> fetches;
+    m_pipelineState->getPalMetadata()->getVertexFetchInfo(fetches);
+    if (!fetches.empty()) {
+      m_fetchShaderCreated = true;
+      VsEntryRegInfo vsEntryRegInfo = {};
+      m_pipelineState->getPalMetadata()->getVsEntryRegInfo(vsEntryRegInfo);
+      m_glueShaders.push_back(
+          std::unique_ptr<GlueShader>(GlueShader::createFetchShader(m_pipelineState, fetches, vsEntryRegInfo)));
+    }
+  }
+
+  // Create a color export shader object if we need one and do not have one already.
+  if (!m_colorExportShaderCreated) {
+    SmallVector<ColorExportInfo, 8> exports;
+    m_pipelineState->getPalMetadata()->getColorExportInfo(exports);
+    if (!exports.empty()) {
+      m_colorExportShaderCreated = true;
+      m_glueShaders.push_back(
+          std::unique_ptr<GlueShader>(GlueShader::createColorExportShader(m_pipelineState, exports)));
+    }
   }
 }
 
@@ -289,7 +323,7 @@ ArrayRef<StringRef> ElfLinkerImpl::getGlueInfo() {
 // @param glueIndex : Index into the array that was returned by getGlueInfo()
 // @param blob : Blob for the glue code
 void ElfLinkerImpl::addGlue(unsigned glueIndex, StringRef blob) {
-  llvm_unreachable("Not implemented");
+  m_glueShaders[glueIndex]->setElfBlob(blob);
 }
 
 // =====================================================================================================================
@@ -423,26 +457,51 @@ bool ElfLinkerImpl::link(raw_pwrite_stream &outStream) {
     for (const object::SectionRef section : elfInput.objectFile->sections()) {
       unsigned sectType = object::ELFSectionRef(section).getType();
       if (sectType == ELF::SHT_REL || sectType == ELF::SHT_RELA) {
-        for (object::RelocationRef reloc : section.relocations()) {
-          unsigned outputSectIdx = UINT_MAX;
-          unsigned withinSectIdx = UINT_MAX;
-          std::tie(outputSectIdx, withinSectIdx) = findInputSection(elfInput, *cantFail(section.getRelocatedSection()));
-          if (outputSectIdx != UINT_MAX) {
+        // Resolve the relocated section's output placement and contents once for the whole reloc section,
+        // rather than once per reloc.
+        object::section_iterator relocatedSection = cantFail(section.getRelocatedSection());
+        unsigned outputSectIdx = UINT_MAX;
+        unsigned withinSectIdx = UINT_MAX;
+        std::tie(outputSectIdx, withinSectIdx) = findInputSection(elfInput, *relocatedSection);
+        if (outputSectIdx != UINT_MAX) {
+          uint64_t sectionOutputOffset = m_outputSections[outputSectIdx].getOutputOffset(withinSectIdx);
+          StringRef contents = cantFail(relocatedSection->getContents());
+          for (object::RelocationRef reloc : section.relocations()) {
             uint64_t inputOffset = reloc.getOffset();
-            uint64_t outputOffset = m_outputSections[outputSectIdx].getOutputOffset(withinSectIdx) + inputOffset;
+            uint64_t outputOffset = sectionOutputOffset + inputOffset;
             uint64_t addend = 0;
             if (sectType == ELF::SHT_RELA)
               addend = cantFail(object::ELFRelocationRef(reloc).getAddend());
-            uint64_t value = getRelocValue(reloc);
-
             switch (reloc.getType()) {
 
             case ELF::R_AMDGPU_ABS32: {
-              StringRef contents = cantFail(cantFail(section.getRelocatedSection())->getContents());
               assert(inputOffset + sizeof(uint32_t) <= contents.size() && "Out of range reloc offset");
               if (sectType == ELF::SHT_REL)
                 addend = *reinterpret_cast<const uint32_t *>(contents.data() + inputOffset);
-              uint32_t inst = addend + value;
+              uint32_t inst = addend + getRelocValue(reloc);
+              outStream.pwrite(reinterpret_cast<const char *>(&inst), sizeof(inst), outputOffset);
+              break;
+            }
+
+            case ELF::R_AMDGPU_REL32:
+            case ELF::R_AMDGPU_REL32_LO:
+            case ELF::R_AMDGPU_REL32_HI: {
+              // PC-relative reference to a symbol defined in the output ELF. This is how code from one input
+              // references code or data from another input merged into the same output section, such as a
+              // separately compiled code fragment supplied with addInputElf, or constant pools in a .rodata
+              // section that gets merged into .text.
+              assert(inputOffset + sizeof(uint32_t) <= contents.size() && "Out of range reloc offset");
+              if (sectType == ELF::SHT_REL)
+                addend = *reinterpret_cast<const uint32_t *>(contents.data() + inputOffset);
+              StringRef symName = cantFail(reloc.getSymbol()->getName());
+              const ELF::Elf64_Sym &sym = m_symbols[findDefinedSymbol(symName)];
+              // A file-offset delta only matches the delta the code sees at run time when both ends are loaded
+              // as part of the same section, so insist that the symbol lives in the section being relocated.
+              if (sym.st_shndx != outputSectIdx)
+                report_fatal_error("Reloc to symbol in another section not supported: " + symName);
+              uint64_t delta = m_outputSections[sym.st_shndx].getOffset() + sym.st_value + addend - outputOffset;
+              uint32_t inst =
+                  reloc.getType() == ELF::R_AMDGPU_REL32_HI ? uint32_t(delta >> 32) : uint32_t(delta);
               outStream.pwrite(reinterpret_cast<const char *>(&inst), sizeof(inst), outputOffset);
               break;
             }
@@ -507,17 +566,28 @@ unsigned ElfLinkerImpl::findSymbol(unsigned nameIndex) {
 uint64_t ElfLinkerImpl::getRelocValue(object::RelocationRef reloc) {
   StringRef name = cantFail(reloc.getSymbol()->getName());
 
-  // Handle the special case relocs from pipeline state
+  // Handle the special case relocs from pipeline state. Relocs to symbols defined in the output ELF are
+  // PC-relative and are resolved in the reloc loop in link() instead.
   uint64_t value = 0;
   if (m_relocHandler.getValue(name, value))
     return value;
 
-  // TODO: Handle a reloc to a symbol, so we are then able to generate a shader ELF with its constant pools
-  // in a separate .rodata section that gets merged into .text in the linker.
-
   report_fatal_error("Unknown reloc: " + name);
 }
 
+// =====================================================================================================================
+// Find the symbol of the given name defined in the output ELF, for resolving a reloc that references it
+//
+// @param name : Name of the symbol
+// @return : Index in the output symbol table
+unsigned ElfLinkerImpl::findDefinedSymbol(StringRef name) {
+  unsigned nameIndex = m_stringMap.lookup(name);
+  unsigned symIndex = nameIndex ? findSymbol(nameIndex) : 0;
+  if (symIndex == 0)
+    report_fatal_error("Unknown reloc: " + name);
+  return symIndex;
+}
+
 // =====================================================================================================================
 // Find where an input section contributes to an output section
 //
@@ -30,6 +30,7 @@
  */
 #include "GlueShader.h"
 #include "lgc/BuilderBase.h"
+#include "lgc/patch/FragColorExport.h"
 #include "lgc/patch/ShaderInputs.h"
 #include "lgc/patch/VertexFetch.h"
 #include "lgc/state/PassManagerCache.h"
@@ -41,6 +42,7 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IntrinsicsAMDGPU.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 
 using namespace lgc;
@@ -54,8 +56,10 @@ void GlueShader::compile(raw_pwrite_stream &outStream) {
   // Generate the glue shader IR module.
   std::unique_ptr<Module> module(generate());
 
-  // Add empty PAL metadata, to ensure that the back-end writes its PAL metadata in MsgPack format.
+  // Add empty PAL metadata, to ensure that the back-end writes its PAL metadata in MsgPack format, and give the
+  // glue shader a chance to add registers it has computed itself (such as the color export formats).
   PalMetadata *palMetadata = new PalMetadata(nullptr);
+  updatePalMetadata(*palMetadata);
   palMetadata->record(&*module);
   delete palMetadata;
 
@@ -103,6 +107,44 @@ private:
   std::string m_shaderString;
 };
 
+// =====================================================================================================================
+// A color export shader, generated as an epilog for an exportless fragment shader once the color target formats
+// are known
+class ColorExportShader : public GlueShader {
+public:
+  ColorExportShader(PipelineState *pipelineState, ArrayRef<ColorExportInfo> exports);
+  ~ColorExportShader() override {}
+
+  // Get the string for this glue shader. This is some encoding or hash of the inputs to the create*Shader function
+  // that the front-end client can use as a cache key to avoid compiling the same glue shader more than once.
+  StringRef getString() override;
+
+  // Get the symbol name of the main shader that this glue shader is prolog or epilog for.
+  StringRef getMainShaderName() override;
+
+  // Get the name of this glue shader.
+  StringRef getName() const override { return "color export shader"; }
+
+protected:
+  // Generate the glue shader to IR module
+  Module *generate() override;
+
+  // Update the PAL metadata that is recorded into the glue shader module
+  void updatePalMetadata(PalMetadata &palMetadata) override;
+
+private:
+  Function *createColorExportFunc();
+
+  // Unlike the fetch shader, we keep access to PipelineState, as FragColorExport needs it to derive the export
+  // format of each target. The shader string is built from just the state that influences the generated code.
+  PipelineState *m_pipelineState;
+  SmallVector<ColorExportInfo, 8> m_exports;
+  // Export format chosen for each hardware color target, set when the shader is generated.
+  unsigned m_exportFormat[MaxColorTargets] = {};
+  // The encoded or hashed (in some way) single string version of the above.
+  std::string m_shaderString;
+};
+
 } // anonymous namespace
 
 // =====================================================================================================================
@@ -112,6 +154,12 @@ GlueShader *GlueShader::createFetchShader(PipelineState *pipelineState, ArrayRef
   return new FetchShader(pipelineState, fetches, vsEntryRegInfo);
 }
 
+// =====================================================================================================================
+// Create a color export shader object
+GlueShader *GlueShader::createColorExportShader(PipelineState *pipelineState, ArrayRef<ColorExportInfo> exports) {
+  return new ColorExportShader(pipelineState, exports);
+}
+
 // =====================================================================================================================
 // Constructor. This is where we store all the information needed to generate the fetch shader; other methods
 // do not need to look at PipelineState.
@@ -124,19 +172,28 @@ FetchShader::FetchShader(PipelineState *pipelineState, ArrayRef<VertexFetchInfo>
 }
 
 // =====================================================================================================================
-// Get the string for this fetch shader. This is some encoding or hash of the inputs to the createFetchShader function
+// Get the string for this fetch shader. This is a canonical encoding of the inputs to the createFetchShader function
 // that the front-end client can use as a cache key to avoid compiling the same glue shader more than once.
+//
+// Only the fields that influence the generated code are encoded, so pipelines whose vertex layouts differ in ways
+// that do not change the fetch code (such as the numbering of the input locations) share one fetch shader blob.
+// The fetch types are encoded by printing them rather than by their uniqued Type pointers, so the string is stable
+// across compiler processes and safe to use as the key of a cache that outlives this one.
 StringRef FetchShader::getString() {
   if (m_shaderString.empty()) {
-    m_shaderString =
-        StringRef(reinterpret_cast<const char *>(m_fetches.data()), m_fetches.size() * sizeof(VertexFetchInfo)).str();
-    m_shaderString += StringRef(reinterpret_cast<const char *>(&m_vsEntryRegInfo), sizeof(m_vsEntryRegInfo)).str();
-    for (const VertexInputDescription *description : m_fetchDescriptions) {
-      if (!description)
-        m_shaderString += StringRef("\0", 1);
-      else
-        m_shaderString += StringRef(reinterpret_cast<const char *>(description), sizeof(*description));
+    raw_string_ostream stream(m_shaderString);
+    stream << m_vsEntryRegInfo.callingConv << ',' << m_vsEntryRegInfo.vertexBufferTable << ','
+           << m_vsEntryRegInfo.baseVertex << ',' << m_vsEntryRegInfo.baseInstance << ',' << m_vsEntryRegInfo.sgprCount
+           << ',' << m_vsEntryRegInfo.vertexId << ',' << m_vsEntryRegInfo.instanceId << ','
+           << m_vsEntryRegInfo.vgprCount << ',' << m_vsEntryRegInfo.wave32;
+    for (unsigned idx = 0; idx != m_fetches.size(); ++idx) {
+      stream << ';' << m_fetches[idx].component << ',' << *m_fetches[idx].ty;
+      if (const VertexInputDescription *description = m_fetchDescriptions[idx]) {
+        stream << ',' << description->binding << ',' << description->offset << ',' << description->stride << ','
+               << description->dfmt << ',' << description->nfmt << ',' << description->inputRate;
+      }
     }
+    stream.flush();
   }
   return m_shaderString;
 }
@@ -282,3 +339,161 @@ Function *FetchShader::createFetchFunc() {
 
   return func;
 }
+
+// =====================================================================================================================
+// Constructor. The information stored here, plus the color export state and formats in PipelineState, is all that
+// is needed to generate the color export shader.
+ColorExportShader::ColorExportShader(PipelineState *pipelineState, ArrayRef<ColorExportInfo> exports)
+    : GlueShader(pipelineState->getLgcContext()), m_pipelineState(pipelineState) {
+  m_exports.append(exports.begin(), exports.end());
+}
+
+// =====================================================================================================================
+// Get the string for this color export shader. This is a canonical encoding of the inputs to the
+// createColorExportShader function that the front-end client can use as a cache key to avoid compiling the same
+// glue shader more than once.
+//
+// Only the state that influences the generated code is encoded: the deferred exports recorded by the fragment
+// shader, and the color export state and the format of each referenced color target from the pipeline state. The
+// export types are encoded by printing them rather than by their uniqued Type pointers, so the string is stable
+// across compiler processes and safe to use as the key of a cache that outlives this one.
+StringRef ColorExportShader::getString() {
+  if (m_shaderString.empty()) {
+    raw_string_ostream stream(m_shaderString);
+    const ColorExportState &exportState = m_pipelineState->getColorExportState();
+    stream << exportState.alphaToCoverageEnable << ',' << exportState.dualSourceBlendEnable;
+    for (const ColorExportInfo &exportInfo : m_exports) {
+      const ColorExportFormat &format = m_pipelineState->getColorExportFormat(exportInfo.location);
+      stream << ';' << exportInfo.hwColorTarget << ',' << exportInfo.location << ',' << exportInfo.isSigned << ','
+             << *exportInfo.ty << ',' << format.dfmt << ',' << format.nfmt << ',' << format.blendEnable << ','
+             << format.blendSrcAlphaToColor;
+    }
+    stream.flush();
+  }
+  return m_shaderString;
+}
+
+// =====================================================================================================================
+// Get the symbol name of the main shader that this glue shader is prolog or epilog for
+StringRef ColorExportShader::getMainShaderName() {
+  return getEntryPointName(CallingConv::AMDGPU_PS, /*isFetchlessVs=*/false);
+}
+
+// =====================================================================================================================
+// Generate the IR module for the color export shader
+Module *ColorExportShader::generate() {
+  // Create the function.
+  Function *colorExportFunc = createColorExportFunc();
+
+  // Tell FragColorExport the original location and type of each output. It reads them from the fragment shader's
+  // resource usage, which is otherwise unpopulated in a link-time compile.
+  auto resUsage = m_pipelineState->getShaderResourceUsage(ShaderStageFragment);
+  for (const ColorExportInfo &exportInfo : m_exports) {
+    resUsage->inOutUsage.fs.outputOrigLocs[exportInfo.hwColorTarget] = exportInfo.location;
+    BasicType outputType = BasicType::Float;
+    if (exportInfo.isSigned) {
+      switch (exportInfo.ty->getScalarSizeInBits()) {
+      case 8:
+        outputType = BasicType::Int8;
+        break;
+      case 16:
+        outputType = BasicType::Int16;
+        break;
+      default:
+        outputType = BasicType::Int;
+        break;
+      }
+    }
+    resUsage->inOutUsage.fs.outputTypes[exportInfo.location] = outputType;
+  }
+
+  // Generate the export conversion for each output.
+  auto ret = cast<ReturnInst>(colorExportFunc->back().getTerminator());
+  BuilderBase builder(ret);
+  FragColorExport fragColorExport(m_pipelineState, colorExportFunc->getParent());
+  CallInst *lastExport = nullptr;
+
+  for (unsigned idx = 0; idx != m_exports.size(); ++idx) {
+    const ColorExportInfo &exportInfo = m_exports[idx];
+
+    // Convert the VGPR argument back to the original output type.
+    Value *value = colorExportFunc->getArg(idx);
+    if (value->getType() != exportInfo.ty) {
+      const unsigned bitWidth = exportInfo.ty->getPrimitiveSizeInBits();
+      value = builder.CreateBitCast(value, builder.getIntNTy(value->getType()->getPrimitiveSizeInBits()));
+      if (bitWidth != value->getType()->getPrimitiveSizeInBits())
+        value = builder.CreateTrunc(value, builder.getIntNTy(bitWidth));
+      value = builder.CreateBitCast(value, exportInfo.ty);
+    }
+
+    if (Value *exportInst = fragColorExport.run(value, exportInfo.hwColorTarget, ret))
+      lastExport = cast<CallInst>(exportInst);
+    m_exportFormat[exportInfo.hwColorTarget] = resUsage->inOutUsage.fs.expFmts[exportInfo.hwColorTarget];
+  }
+
+  if (lastExport) {
+    // Set "done" flag on the last export.
+    if (lastExport->getCalledFunction()->getName() == "llvm.amdgcn.exp.f32")
+      lastExport->setOperand(6, builder.getTrue());
+    else {
+      assert(lastExport->getCalledFunction()->getName() == "llvm.amdgcn.exp.compr.v2f16");
+      lastExport->setOperand(4, builder.getTrue());
+    }
+  } else {
+    // All color targets ended up with export format ZERO; export a dummy value so the hardware still sees an
+    // export with the "done" flag.
+    builder.CreateIntrinsic(Intrinsic::amdgcn_exp, builder.getFloatTy(),
+                            {builder.getInt32(EXP_TARGET_MRT_0), builder.getInt32(0x1),
+                             ConstantFP::get(builder.getFloatTy(), 0.0), UndefValue::get(builder.getFloatTy()),
+                             UndefValue::get(builder.getFloatTy()), UndefValue::get(builder.getFloatTy()),
+                             builder.getTrue(), builder.getTrue()});
+  }
+
+  return colorExportFunc->getParent();
+}
+
+// =====================================================================================================================
+// Update the PAL metadata of the glue shader with the export formats chosen while generating it, so the linked
+// pipeline gets the correct SPI_SHADER_COL_FORMAT.
+//
+// @param [in/out] palMetadata : PAL metadata recorded into the glue shader module
+void ColorExportShader::updatePalMetadata(PalMetadata &palMetadata) {
+  unsigned spiShaderColFormat = 0;
+  for (unsigned hwColorTarget = 0; hwColorTarget != MaxColorTargets; ++hwColorTarget)
+    spiShaderColFormat |= m_exportFormat[hwColorTarget] << (4 * hwColorTarget);
+  palMetadata.setRegister(mmSPI_SHADER_COL_FORMAT, spiShaderColFormat);
+}
+
+// =====================================================================================================================
+// Create module with function for the color export shader. On return, the function contains only a "ret void";
+// the caller generates the export code before it.
+Function *ColorExportShader::createColorExportFunc() {
+  // Create the module
+  Module *module = new Module("colorExportShader", getContext());
+  TargetMachine *targetMachine = m_lgcContext->getTargetMachine();
+  module->setTargetTriple(targetMachine->getTargetTriple().getTriple());
+  module->setDataLayout(targetMachine->createDataLayout());
+
+  // Get the function type. Its inputs are the deferred fragment shader outputs, which arrive in the VGPRs where
+  // the exportless fragment shader returned them.
+  SmallVector<Type *, 8> entryTys;
+  for (const ColorExportInfo &exportInfo : m_exports)
+    entryTys.push_back(VertexFetch::getVgprTy(exportInfo.ty));
+  auto funcTy = FunctionType::get(Type::getVoidTy(getContext()), entryTys, false);
+
+  // Create the function. All inputs are in VGPRs, so none is marked "inreg".
+  Function *func = Function::Create(funcTy, GlobalValue::ExternalLinkage, "color_export_shader", module);
+  func->setCallingConv(CallingConv::AMDGPU_PS);
+
+  if (m_lgcContext->getTargetInfo().getGfxIpVersion().major >= 10) {
+    // Set up wave32 or wave64 to match the fragment shader.
+    const unsigned waveSize = m_pipelineState->getShaderWaveSize(ShaderStageFragment);
+    func->addFnAttr("target-features", waveSize == 32 ? "+wavefrontsize32" : "+wavefrontsize64");
+  }
+
+  BasicBlock *block = BasicBlock::Create(func->getContext(), "", func);
+  BuilderBase builder(block);
+  builder.CreateRetVoid();
+
+  return func;
+}
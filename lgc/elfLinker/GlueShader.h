@@ -48,10 +48,17 @@ public:
   static GlueShader *createFetchShader(PipelineState *pipelineState, llvm::ArrayRef<VertexFetchInfo> fetches,
                                        const VsEntryRegInfo &vsEntryRegInfo);
 
+  // Create a color export shader
+  static GlueShader *createColorExportShader(PipelineState *pipelineState, llvm::ArrayRef<ColorExportInfo> exports);
+
   // Get the string for this glue shader. This is some encoding or hash of the inputs to the create*Shader function
   // that the front-end client can use as a cache key to avoid compiling the same glue shader more than once.
   virtual llvm::StringRef getString() = 0;
 
+  // Set the ELF blob for this glue shader, typically retrieved from a cache, so that getElfBlob() does not
+  // need to compile it.
+  void setElfBlob(llvm::StringRef blob) { m_elfBlob.assign(blob.begin(), blob.end()); }
+
   // Get the ELF blob for this glue shader, compiling if not already compiled.
   llvm::StringRef getElfBlob() {
     if (m_elfBlob.empty()) {
@@ -79,6 +86,9 @@ protected:
   // Generate the IR module for the glue shader
   virtual llvm::Module *generate() = 0;
 
+  // Update the PAL metadata that compile() records into the glue shader module. The default is to add nothing.
+  virtual void updatePalMetadata(PalMetadata &palMetadata) {}
+
   llvm::LLVMContext &getContext() const { return m_lgcContext->getContext(); }
 
   LgcContext *m_lgcContext;
@@ -65,10 +65,31 @@ static bool parseDescSetBinding(StringRef str, unsigned &descSet, unsigned &bind
 // =====================================================================================================================
 // Get value for a reloc, if it is an internal LGC one
 //
+// The value for a given symbol is resolved from pipeline state once per link and memoized; the resource node
+// searches behind the descriptor symbols are not repeated for each section the symbol relocates.
+//
 // @param name : Symbol name used by relocation
 // @param [out] value : Returns value of symbol if found
 // @return : True if successful, false if not handled
 bool RelocHandler::getValue(StringRef name, uint64_t &value) {
+  auto cacheIt = m_valueCache.find(name);
+  if (cacheIt != m_valueCache.end()) {
+    value = cacheIt->second;
+    return true;
+  }
+  if (!calcValue(name, value))
+    return false;
+  m_valueCache[name] = value;
+  return true;
+}
+
+// =====================================================================================================================
+// Resolve a reloc value from pipeline state, uncached
+//
+// @param name : Symbol name used by relocation
+// @param [out] value : Returns value of symbol if found
+// @return : True if successful, false if not handled
+bool RelocHandler::calcValue(StringRef name, uint64_t &value) {
 
   if (name.startswith(reloc::DescriptorOffset)) {
     // Descriptor offset in bytes in the descriptor table for its set, or in the spill table if in the root table.
@@ -30,6 +30,7 @@
  */
 #pragma once
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace lgc {
@@ -42,13 +43,19 @@ class RelocHandler {
 public:
   RelocHandler(PipelineState *pipelineState) : m_pipelineState(pipelineState) {}
 
-  // Get value for a reloc, if it is an internal LGC one
+  // Get value for a reloc, if it is an internal LGC one. Resolved values are memoized per symbol name, as the
+  // pipeline state they derive from is fixed for the lifetime of this handler (one link), and the same symbol
+  // typically relocates every text section.
   bool getValue(llvm::StringRef name, uint64_t &value);
 
 private:
   PipelineState *getPipelineState() const { return m_pipelineState; }
 
+  // Resolve a reloc value from pipeline state, uncached.
+  bool calcValue(llvm::StringRef name, uint64_t &value);
+
   PipelineState *m_pipelineState;
+  llvm::StringMap<uint64_t> m_valueCache; // Values already resolved for this link, keyed by symbol name
 };
 
 } // namespace lgc
@@ -58,6 +58,7 @@ void initializePatchPeepholeOptPass(PassRegistry &);
 void initializePatchPreparePipelineAbiPass(PassRegistry &);
 void initializePatchResourceCollectPass(PassRegistry &);
 void initializePatchSetupTargetFeaturesPass(PassRegistry &);
+void initializePipelineSystemValuesWrapperPass(PassRegistry &);
 
 } // namespace llvm
 
@@ -83,6 +84,7 @@ inline static void initializePatchPasses(llvm::PassRegistry &passRegistry) {
   initializePatchPreparePipelineAbiPass(passRegistry);
   initializePatchResourceCollectPass(passRegistry);
   initializePatchSetupTargetFeaturesPass(passRegistry);
+  initializePipelineSystemValuesWrapperPass(passRegistry);
 }
 
 llvm::ModulePass *createLowerVertexFetch();
@@ -127,6 +129,7 @@ protected:
 
 private:
   static void addOptimizationPasses(llvm::legacy::PassManager &passMgr);
+  static void addFastCompileOptimizationPasses(llvm::legacy::PassManager &passMgr);
 
   Patch() = delete;
   Patch(const Patch &) = delete;
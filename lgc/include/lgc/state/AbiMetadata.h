@@ -108,6 +108,8 @@ static constexpr char NumInterpolants[] = ".num_interpolants";
 static constexpr char CalcWaveBreakSizeAtDrawTime[] = ".calc_wave_break_size_at_draw_time";
 static constexpr char Api[] = ".api";
 static constexpr char ApiCreateInfo[] = ".api_create_info";
+// LLPC extension, not consumed by PAL: NGG LDS region layout, for offline tooling
+static constexpr char NggLdsLayout[] = ".nggLdsLayout";
 }; // namespace PipelineMetadataKey
 
 namespace HardwareStageMetadataKey {
@@ -222,6 +224,7 @@ constexpr unsigned mmSPI_SHADER_PGM_RSRC2_VS = 0x2C4B;
 // Other SPI register numbers in PAL metadata
 constexpr unsigned int mmPA_CL_CLIP_CNTL = 0xA204;
 constexpr unsigned mmVGT_SHADER_STAGES_EN = 0xA2D5;
+constexpr unsigned mmSPI_SHADER_COL_FORMAT = 0xA1C5;
 
 // Register bitfield layout.
 
@@ -86,6 +86,9 @@ const static char LaterCallPrefix[] = "lgc.late.";
 const static char LateLaunderFatPointer[] = "lgc.late.launder.fat.pointer";
 const static char LateBufferLength[] = "lgc.late.buffer.desc.length";
 
+// Prefix of the per-module helper function holding the expansion of one YCbCr converting image sample
+const static char YCbCrSampleHelper[] = "lgc.ycbcr.sample.";
+
 // Names of global variables
 const static char ImmutableSamplerGlobal[] = "lgc.immutable.sampler";
 const static char ImmutableConvertingSamplerGlobal[] = "lgc.immutable.converting.sampler";
@@ -37,11 +37,18 @@
 
 #include "lgc/CommonDefs.h"
 #include "lgc/state/AbiMetadata.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
+#include <utility>
 
 namespace llvm {
 class Module;
 class Type;
+
+namespace msgpack {
+class Writer;
+} // namespace msgpack
+
 } // namespace llvm
 
 namespace lgc {
@@ -56,6 +63,23 @@ struct VertexFetchInfo {
   llvm::Type *ty;
 };
 
+// =====================================================================================================================
+// Struct with the information for one deferred color export of an exportless fragment shader
+struct ColorExportInfo {
+  unsigned hwColorTarget; // Hardware color target the value is exported to
+  unsigned location;      // Original output location, used to find the color target format
+  bool isSigned;          // Whether the output is of signed integer type
+  llvm::Type *ty;         // Type of the output value
+};
+
+// =====================================================================================================================
+// Struct with the information for one NGG LDS region, written by NggLdsManager
+struct NggLdsRegionInfo {
+  const char *name; // Human-readable region name
+  unsigned offset;  // Byte offset of the region within LDS
+  unsigned size;    // Size of the region in bytes
+};
+
 // =====================================================================================================================
 // Struct with information on wave dispatch SGPRs and VGPRs for VS, written by getVsEntryRegInfo
 struct VsEntryRegInfo {
@@ -89,8 +113,13 @@ public:
   // Record the PAL metadata into IR metadata in the specified module.
   void record(llvm::Module *module);
 
-  // Get the MsgPack document for explicit manipulation. Only ConfigBuilder* uses this.
-  llvm::msgpack::Document *getDocument() { return m_document; }
+  // Get the MsgPack document for explicit manipulation. Only ConfigBuilder* and the ELF linker use this.
+  // Any registers staged by setRegister() are flushed into the document first, so the caller sees the
+  // complete register map.
+  llvm::msgpack::Document *getDocument() {
+    flushStagedRegisters();
+    return m_document;
+  }
 
   // Set the PAL metadata SPI register for one user data entry
   void setUserDataEntry(ShaderStage stage, unsigned userDataIndex, unsigned userDataValue, unsigned dwordCount = 1);
@@ -122,6 +151,18 @@ public:
   // Get the VS entry register info. Used by the linker to generate the fetch shader.
   void getVsEntryRegInfo(VsEntryRegInfo &regInfo);
 
+  // Store the color export information in PAL metadata for an exportless fragment shader with shader compilation.
+  void addColorExportInfo(llvm::ArrayRef<ColorExportInfo> exports);
+
+  // Get the count of deferred color exports for an exportless fragment shader (or 0 otherwise).
+  unsigned getColorExportCount();
+
+  // Get the color export information out of PAL metadata
+  void getColorExportInfo(llvm::SmallVectorImpl<ColorExportInfo> &exports);
+
+  // Store the NGG LDS region layout in PAL metadata, for consumption by offline tooling.
+  void addNggLdsLayoutInfo(llvm::ArrayRef<NggLdsRegionInfo> regions);
+
   // Finalize PAL metadata for pipeline.
   // TODO Shader compilation: The idea is that this will be called at the end of a pipeline compilation, or in
   // an ELF link, but not at the end of a shader/half-pipeline compile.
@@ -137,15 +178,35 @@ private:
   // Set userDataLimit to maximum
   void setUserDataLimit();
 
+  // Flush registers staged by setRegister() into the MsgPack document's register map
+  void flushStagedRegisters();
+
+  // Sort the staged register array by register number and OR together duplicate entries
+  void sortStagedRegisters();
+
+  // Write a MsgPack document node with the given msgpack writer, splicing in any staged registers
+  void writeNode(llvm::msgpack::DocNode node, llvm::msgpack::Writer &writer);
+
+  // Write the register map, merging staged registers with those already in the document
+  void writeRegisters(llvm::msgpack::MapDocNode domRegisters, llvm::msgpack::Writer &writer);
+
   PipelineState *m_pipelineState;             // PipelineState
   llvm::msgpack::Document *m_document;        // The MsgPack document
   llvm::msgpack::MapDocNode m_pipelineNode;   // MsgPack map node for amdpal.pipelines[0]
   llvm::msgpack::MapDocNode m_registers;      // MsgPack map node for amdpal.pipelines[0].registers
   llvm::msgpack::ArrayDocNode m_vertexInputs; // MsgPack map node for amdpal.pipelines[0].vertexInputs
+  llvm::msgpack::ArrayDocNode m_colorExports; // MsgPack map node for amdpal.pipelines[0].colorExports
   // Mapping from ShaderStage to SPI user data register start, allowing for merged shaders and NGG.
   unsigned m_userDataRegMapping[ShaderStageCountInternal] = {};
   llvm::msgpack::DocNode *m_userDataLimit;  // Maximum so far number of user data dwords used
   llvm::msgpack::DocNode *m_spillThreshold; // Minimum so far dword offset used in user data spill table
+  // Registers staged by setRegister(). Keeping them in a flat (regNum, value) array, rather than building a
+  // document node per register, avoids allocating thousands of MsgPack document nodes in a whole-pipeline
+  // compilation; setRegister() just appends, and the array is sorted and deduplicated (ORing duplicates) in a
+  // single pass when the registers are spliced into the blob in record(), or flushed into the document when
+  // anything needs to read or merge the document's register map directly.
+  llvm::SmallVector<std::pair<unsigned, unsigned>, 64> m_stagedRegisters;
+  bool m_stagedRegistersSorted = true; // Whether m_stagedRegisters is currently sorted and deduplicated
 };
 
 } // namespace lgc
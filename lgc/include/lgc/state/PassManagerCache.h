@@ -83,6 +83,9 @@ public:
   // Get pass manager for glue shader compilation
   PassManager &getGlueShaderPassManager(llvm::raw_pwrite_stream &outStream);
 
+  // Get pass manager for the codegen phase of a main pipeline compilation
+  PassManager &getCodeGenPassManager(llvm::raw_pwrite_stream &outStream);
+
 private:
   PassManager &getPassManager(const PassManagerInfo &info, llvm::raw_pwrite_stream &outStream);
 
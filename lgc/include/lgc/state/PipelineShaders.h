@@ -32,8 +32,8 @@
 
 #include "lgc/CommonDefs.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Pass.h"
-#include <map>
 
 namespace lgc {
 
@@ -52,12 +52,16 @@ public:
 
   ShaderStage getShaderStage(const llvm::Function *func) const;
 
+  void updateEntryPoint(ShaderStage shaderStage, llvm::Function *entryPoint);
+
 private:
   PipelineShaders(const PipelineShaders &) = delete;
   PipelineShaders &operator=(const PipelineShaders &) = delete;
 
-  llvm::Function *m_entryPoints[ShaderStageCountInternal];       // The entry-point for each shader stage.
-  std::map<const llvm::Function *, ShaderStage> m_entryPointMap; // Map from shader entry-point to shader stage.
+  llvm::Function *m_entryPoints[ShaderStageCountInternal]; // The entry-point for each shader stage.
+  // Cache of shader stage for each function carrying stage metadata (not just entry-points), so repeated
+  // stage queries are a pointer-keyed table hit instead of a metadata lookup.
+  llvm::DenseMap<const llvm::Function *, ShaderStage> m_stageMap;
 };
 
 llvm::ModulePass *createPipelineShaders();
@@ -240,6 +240,7 @@ public:
   // Accessors for color export state
   const ColorExportFormat &getColorExportFormat(unsigned location);
   const ColorExportState &getColorExportState() { return m_colorExportState; }
+  bool hasColorExportFormats() const { return !m_colorExportFormats.empty(); }
 
   // Accessors for pipeline state
   unsigned getDeviceIndex() const { return m_deviceIndex; }
@@ -410,6 +411,9 @@ private:
 
   std::string m_lastError;                              // Error to be reported by getLastError()
   bool m_noReplayer = false;                            // True if no BuilderReplayer needed
+  bool m_directHandoff = false;                         // True if irLink populated this state object, so generate()
+                                                        //  hands it straight to the patch phase without the IR
+                                                        //  metadata round trip
   bool m_emitLgc = false;                               // Whether -emit-lgc is on
   bool m_unlinked = false;                              // Whether generating an unlinked half-pipeline ELF
   unsigned m_stageMask = 0;                             // Mask of active shader stages
@@ -32,7 +32,9 @@
 
 #include "lgc/state/Defs.h"
 #include "lgc/state/IntrinsDefs.h"
+#include "lgc/util/ArenaAllocator.h"
 #include "lgc/util/Internal.h"
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -121,6 +123,12 @@ enum class WorkgroupLayout : unsigned {
   SexagintiQuads // 8x8
 };
 
+// Map from shader specified locations (or built-in IDs) to mapped locations. Location mapping relies on iterating
+// this in ascending key order, so it must stay an ordered map; only the allocator differs from a plain std::map,
+// taking the nodes from the owning ResourceUsage's per-compile arena.
+typedef std::map<unsigned, unsigned, std::less<unsigned>, ArenaAllocator<std::pair<const unsigned, unsigned>>>
+    LocationMap;
+
 // Represents the usage info of shader resources.
 //
 // NOTE: All fields must be initialized in InitShaderResourceUsage().
@@ -311,24 +319,35 @@ struct ResourceUsage {
 
   } builtInUsage = {};
 
+  // Bump arena backing the location maps in inOutUsage below: their nodes live exactly as long as this
+  // ResourceUsage, so they are bump-allocated and freed in one go rather than per node. Declared before
+  // inOutUsage so the arena outlives the maps.
+  llvm::BumpPtrAllocator arena;
+
   // Usage of generic input/output
-  struct {
+  struct InOutUsage {
+    // All location maps allocate their nodes from the given arena, owned by the enclosing ResourceUsage.
+    InOutUsage(llvm::BumpPtrAllocator &arena)
+        : inputLocMap(arena), outputLocMap(arena), inOutLocMap(arena), perPatchInputLocMap(arena),
+          perPatchOutputLocMap(arena), builtInInputLocMap(arena), builtInOutputLocMap(arena),
+          perPatchBuiltInInputLocMap(arena), perPatchBuiltInOutputLocMap(arena) {}
+
     // Map from shader specified locations to tightly packed locations
-    std::map<unsigned, unsigned> inputLocMap;
-    std::map<unsigned, unsigned> outputLocMap;
+    LocationMap inputLocMap;
+    LocationMap outputLocMap;
 
     // The original and new InOutLocations for shader cache
-    std::map<unsigned, unsigned> inOutLocMap;
+    LocationMap inOutLocMap;
 
-    std::map<unsigned, unsigned> perPatchInputLocMap;
-    std::map<unsigned, unsigned> perPatchOutputLocMap;
+    LocationMap perPatchInputLocMap;
+    LocationMap perPatchOutputLocMap;
 
     // Map from built-in IDs to specially assigned locations
-    std::map<unsigned, unsigned> builtInInputLocMap;
-    std::map<unsigned, unsigned> builtInOutputLocMap;
+    LocationMap builtInInputLocMap;
+    LocationMap builtInOutputLocMap;
 
-    std::map<unsigned, unsigned> perPatchBuiltInInputLocMap;
-    std::map<unsigned, unsigned> perPatchBuiltInOutputLocMap;
+    LocationMap perPatchBuiltInInputLocMap;
+    LocationMap perPatchBuiltInOutputLocMap;
 
     // Transform feedback strides
     unsigned xfbStrides[MaxTransformFeedbackBuffers] = {};
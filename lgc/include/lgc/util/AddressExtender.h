@@ -30,6 +30,7 @@
  */
 #pragma once
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/IRBuilder.h"
 
 namespace llvm {
@@ -52,7 +53,8 @@ public:
   // Get first insertion point in the function, after PC-getting code if already inserted.
   llvm::Instruction *getFirstInsertionPt();
 
-  // Extend an i32 into a 64-bit pointer
+  // Extend an i32 into a 64-bit pointer. The extension code for each (input, high half) pair is only emitted
+  // once per function, at a point dominating all uses of the input, and reused by subsequent calls.
   //
   // @param addr32 : Address as 32-bit value
   // @param highHalf : Value to use for high half; HighAddrPc to use PC
@@ -65,8 +67,14 @@ private:
   // Get PC value as v2i32.
   llvm::Instruction *getPc();
 
+  // Get the insertion point for the shared extension code of the given input address.
+  llvm::Instruction *getExtensionInsertionPt(llvm::Value *addr32);
+
   llvm::Function *m_func;
   llvm::Instruction *m_pc = nullptr;
+
+  // Extended addresses (as i64) already emitted in this function, keyed by (input value, high half)
+  llvm::DenseMap<std::pair<llvm::Value *, unsigned>, llvm::Value *> m_extended;
 };
 
 } // namespace lgc
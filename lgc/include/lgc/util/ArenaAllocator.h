@@ -0,0 +1,63 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  ArenaAllocator.h
+ * @brief LLPC header file: STL allocator adapter over an llvm::BumpPtrAllocator
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llvm/Support/Allocator.h"
+#include <cstddef>
+
+namespace lgc {
+
+// =====================================================================================================================
+// Minimal STL allocator adapter over an llvm::BumpPtrAllocator, for per-compile containers whose contents all die
+// together: each allocation is a pointer bump, deallocation is a no-op, and the memory is returned in one bulk free
+// when the arena is destroyed or reset. The arena must outlive every container using it.
+template <typename T> class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  ArenaAllocator(llvm::BumpPtrAllocator &arena) : m_arena(&arena) {}
+  template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : m_arena(other.getArena()) {}
+
+  T *allocate(size_t count) { return static_cast<T *>(m_arena->Allocate(count * sizeof(T), alignof(T))); }
+  void deallocate(T *, size_t) {} // Freed in bulk when the arena goes away
+
+  llvm::BumpPtrAllocator *getArena() const { return m_arena; }
+
+  template <typename U> bool operator==(const ArenaAllocator<U> &other) const { return m_arena == other.getArena(); }
+  template <typename U> bool operator!=(const ArenaAllocator<U> &other) const { return m_arena != other.getArena(); }
+
+private:
+  ArenaAllocator() = delete;
+
+  llvm::BumpPtrAllocator *m_arena; // The arena allocations are bumped from
+};
+
+} // namespace lgc
@@ -30,6 +30,7 @@
  */
 #pragma once
 
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace lgc {
@@ -37,12 +38,47 @@ namespace lgc {
 // Get pointer to stream for LLPC_OUTS, or nullptr if disabled.
 llvm::raw_ostream *getLgcOuts();
 
+// =====================================================================================================================
+// Represents the builder of one log message. The message is accumulated in a buffer on the calling thread's stack
+// and handed to the shared output stream as a single write when the statement ends, so concurrent compile threads
+// neither serialize on the stream for each stream operand nor interleave partial messages.
+class DebugStream {
+public:
+  //
+  // @param sink : Stream that the message is written to when the statement ends
+  explicit DebugStream(llvm::raw_ostream &sink) : m_sink(sink), m_stream(m_buffer) {}
+
+  ~DebugStream() { m_sink << m_stream.str(); }
+
+  // Gets the stream that the message is built into.
+  llvm::raw_ostream &stream() { return m_stream; }
+
+private:
+  DebugStream(const DebugStream &) = delete;
+  DebugStream &operator=(const DebugStream &) = delete;
+
+  llvm::raw_ostream &m_sink;          // Stream that the message is written to when the statement ends
+  llvm::SmallString<512> m_buffer;    // Per-message buffer, written to the sink in one go
+  llvm::raw_svector_ostream m_stream; // Stream wrapping the buffer
+};
+
 } // namespace lgc
 
 // Output general message
 #define LLPC_OUTS(msg)                                                                                                 \
   do                                                                                                                   \
     if (llvm::raw_ostream *pStream = getLgcOuts()) {                                                                   \
-      *pStream << msg;                                                                                                 \
+      lgc::DebugStream _stream(*pStream);                                                                              \
+      _stream.stream() << msg;                                                                                         \
+    }                                                                                                                  \
+  while (false)
+
+// Output general message built by a callable taking a llvm::raw_ostream&, for messages whose formatting is itself
+// expensive: the callable only runs when output is enabled.
+#define LLPC_OUTS_LAZY(callable)                                                                                       \
+  do                                                                                                                   \
+    if (llvm::raw_ostream *pStream = getLgcOuts()) {                                                                   \
+      lgc::DebugStream _stream(*pStream);                                                                              \
+      (callable)(_stream.stream());                                                                                    \
     }                                                                                                                  \
   while (false)
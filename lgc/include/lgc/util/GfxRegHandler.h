@@ -85,6 +85,10 @@ protected:
     m_bitsState[regId].isModified = 1;
   }
 
+  // Mark the cached value for the hardware register as out of date, so the next get fetches it again.
+  // Needed when a register overlapping this one is set through a different ID.
+  void markRegModified(unsigned regId) { m_bitsState[regId].isModified = 1; }
+
   // Get combined data from two seperate dwords
   llvm::Value *getRegCombine(unsigned regIdLo, unsigned regIdHi);
 
@@ -113,6 +117,10 @@ enum class SqSampRegs {
   xyMagFilter,
   xyMinFilter,
 
+  // Combined xyMinFilter:xyMagFilter field. The two subfields are adjacent in the descriptor, so accessing both
+  // through the combined field takes a single masked read or write.
+  xyMagMinFilter,
+
   Count,
 };
 
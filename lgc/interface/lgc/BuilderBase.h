@@ -30,6 +30,8 @@
  */
 #pragma once
 
+#include "llvm/ADT/CachedHashString.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/IRBuilder.h"
 
 namespace lgc {
@@ -70,6 +72,23 @@ public:
   // @param byteOffset : Byte offset to add
   // @param instName : Name to give instruction
   llvm::Value *CreateAddByteOffset(llvm::Value *pointer, llvm::Value *byteOffset, const llvm::Twine &instName = "");
+
+private:
+  // Get the declaration for the named callee in the current module, creating it if necessary. Looks in a
+  // per-builder interned cache first, so repeated internal calls (llpc.* and lgc.* helpers) skip the module
+  // symbol table string map on the hot path. The cache keys precomputed hashes off the function's own name
+  // storage, and is flushed whenever the builder moves to a different module.
+  //
+  // @param funcName : Name of the callee
+  // @param retTy : Return type of the callee
+  // @param args : Arguments to pass to the callee
+  // @param attribs : Function attributes
+  llvm::Function *getNamedCallee(llvm::StringRef funcName, llvm::Type *retTy, llvm::ArrayRef<llvm::Value *> args,
+                                 llvm::ArrayRef<llvm::Attribute::AttrKind> attribs);
+
+  llvm::Module *m_calleeModule = nullptr; // Module that the interned callees below belong to
+  llvm::SmallDenseMap<llvm::CachedHashStringRef, llvm::Function *, 8>
+      m_internedCallees; // Map from callee name to its declaration in m_calleeModule
 };
 
 } // namespace lgc
@@ -49,6 +49,16 @@ class ElfLinker {
 public:
   virtual ~ElfLinker() {}
 
+  // Add a further unlinked ELF input after the linker was created. This lets a client create the linker over
+  // the ELFs it already has in hand (e.g. retrieved from a cache) and pre-compile glue shaders while the
+  // remaining stages are still compiling, then supply their ELFs as they arrive. All inputs must be added
+  // before link() is called. Glue shaders are discovered from the PAL metadata of the inputs seen so far, so
+  // getGlueInfo() should only be called once the ELFs that determine the glue (e.g. the one carrying the
+  // vertex-processing metadata for the fetch shader) have been added.
+  //
+  // @param elf : Unlinked ELF module to add
+  virtual void addInputElf(llvm::MemoryBufferRef elf) = 0;
+
   // Get information on the glue code that will be needed for the link. It is an implementation detail how many
   // chunks of glue there might be and what they are for, but, for information, they will be some subset of:
   // - A CS prolog
@@ -62,8 +72,8 @@ public:
   // retrieve the compiled glue code to store in the cache.
   virtual llvm::ArrayRef<llvm::StringRef> getGlueInfo() = 0;
 
-  // Add a blob for a particular chunk of glue code, typically retrieved from a cache. The blob is not copied,
-  // and remains in use until the first of the link completing or the ElfLinker's parent Pipeline being destroyed.
+  // Add a blob for a particular chunk of glue code, typically retrieved from a cache. The blob is copied, so
+  // it does not need to outlive the call.
   //
   // @param glueIndex : Index into the array that was returned by getGlueInfo()
   // @param blob : Blob for the glue code
@@ -30,11 +30,18 @@
  */
 #pragma once
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace llvm {
 
 class LLVMContext;
+class Module;
 class ModulePass;
 class raw_pwrite_stream;
 class TargetMachine;
@@ -54,6 +61,7 @@ class Builder;
 class PassManager;
 class PassManagerCache;
 class Pipeline;
+struct ResourceNode;
 class TargetInfo;
 
 // =====================================================================================================================
@@ -74,6 +82,20 @@ public:
   // @param palAbiVersion : PAL pipeline ABI version to compile for
   static LgcContext *Create(llvm::LLVMContext &context, llvm::StringRef gpuName, unsigned palAbiVersion);
 
+  // Create the LgcContext, adopting a target machine created by a previous LgcContext for the same GPU. The
+  // target machine is independent of the LLVMContext, so a recycled compilation context can hand its target
+  // machine (the expensive part of creation) to its replacement with takeTargetMachine.
+  //
+  // @param context : LLVM context to use on all compiles
+  // @param gpuName : LLVM GPU name (e.g. "gfx900"); empty to use -mcpu option setting
+  // @param palAbiVersion : PAL pipeline ABI version to compile for
+  // @param targetMachine : Target machine to adopt, created for the same GPU
+  static LgcContext *Create(llvm::LLVMContext &context, llvm::StringRef gpuName, unsigned palAbiVersion,
+                            std::unique_ptr<llvm::TargetMachine> targetMachine);
+
+  // Release ownership of the target machine so it can outlive this LgcContext and be adopted by a new one.
+  std::unique_ptr<llvm::TargetMachine> takeTargetMachine();
+
   ~LgcContext();
 
   // Get LLVM context
@@ -92,7 +114,9 @@ public:
   Pipeline *createPipeline();
 
   // Create a Builder object. For a shader compile (pPipelineState is nullptr), useBuilderRecorder is ignored
-  // because it always uses BuilderRecorder.
+  // because it always uses BuilderRecorder. For a pipeline compile whose shader stage mask has a single stage
+  // set, BuilderImpl is handed out directly even if useBuilderRecorder was requested, because there is no
+  // cross-stage state to defer; -disable-direct-builder restores the recorder for such pipelines.
   //
   // @param pipeline : Pipeline object for pipeline compile, nullptr for shader compile
   // @param useBuilderRecorder : True to use BuilderRecorder, false to use BuilderImpl
@@ -121,6 +145,50 @@ public:
   // Get pass manager cache
   PassManagerCache *getPassManagerCache();
 
+  // Get the module holding pipeline-independent library functions (such as the NGG culling helpers), shared by
+  // all compiles with this LgcContext and created empty on first use. Code wanting a library function looks for
+  // it here first, and emits it here on a miss so later compiles can copy it instead of re-emitting it.
+  llvm::Module *getLibraryModule();
+
+  // Get the cached module holding merged-shader entry glue for the given configuration key, calling the given
+  // builder to create it on first use. The returned module is owned by this LgcContext and must not be
+  // modified; callers clone it into their pipeline module.
+  llvm::Module *getGlueModule(llvm::StringRef glueKey, llvm::function_ref<std::unique_ptr<llvm::Module>()> builder);
+
+  // Checks whether the given module contains the null fragment shader the middle-end synthesizes when a
+  // graphics pipeline has no fragment shader of its own.
+  static bool hasNullFragmentShader(const llvm::Module &module);
+
+  // Get the finished pipeline ELF retained for a synthesized shader shape (currently the null fragment shader),
+  // keyed by a hash of the shape and the pipeline state it was compiled with. This LgcContext is already
+  // specific to one GPU, so the graphics IP need not be part of the key. Returns an empty ArrayRef on miss; on
+  // a hit the storage is owned by this LgcContext and stays valid for its lifetime.
+  llvm::ArrayRef<char> lookUpSynthesizedShaderElf(uint64_t shapeHash);
+
+  // Retain the finished pipeline ELF holding a synthesized shader, for later compiles with the same shape.
+  void storeSynthesizedShaderElf(uint64_t shapeHash, llvm::ArrayRef<char> elf);
+
+  // Get the canonical copy of a flattened user data node table, so pipelines with the same descriptor layout
+  // share one table, and consumers can key caches of data derived from a table on its address. Takes ownership
+  // of the given buffer; the buffer is kept if it becomes the canonical copy and freed otherwise.
+  //
+  // @param nodes : Flattened node buffer as built by PipelineState::setUserDataNodes
+  // @param totalNodeCount : Total node count, including inner table nodes
+  // @param outerNodeCount : Count of outer (root table) nodes at the start of the buffer
+  llvm::ArrayRef<ResourceNode> getCanonicalUserDataNodes(std::unique_ptr<ResourceNode[]> nodes,
+                                                         unsigned totalNodeCount, unsigned outerNodeCount);
+
+  // Get the composed "target-features" attribute string for a shader entry-point with the given per-function
+  // inputs, composing it on first use and returning the cached copy after that. This LgcContext is already
+  // specific to one GPU, so the graphics IP need not be part of the key.
+  //
+  // @param waveSize : Wavefront size of the entry-point; 0 on targets without a wavefrontsize feature
+  // @param includeDisassembly : Whether disassembly is requested for the pipeline
+  // @param useSiScheduler : Whether the SI machine scheduler is enabled for the shader stage
+  // @param enableDs128 : Whether 128-bit LDS load/store operations are enabled
+  llvm::StringRef getTargetFeatureString(unsigned waveSize, bool includeDisassembly, bool useSiScheduler,
+                                         bool enableDs128);
+
 private:
   LgcContext() = delete;
   LgcContext(const LgcContext &) = delete;
@@ -128,12 +196,28 @@ private:
 
   LgcContext(llvm::LLVMContext &context, unsigned palAbiVersion);
 
+  // One canonical user data node table; see getCanonicalUserDataNodes
+  struct CanonicalUserDataNodes {
+    std::unique_ptr<ResourceNode[]> nodes; // Storage for the flattened table
+    unsigned totalNodeCount;               // Total node count, including inner table nodes
+    unsigned outerNodeCount;               // Count of outer (root table) nodes
+  };
+
   static llvm::raw_ostream *m_llpcOuts;           // nullptr or stream for LLPC_OUTS
   llvm::LLVMContext &m_context;                   // LLVM context
   llvm::TargetMachine *m_targetMachine = nullptr; // Target machine
-  TargetInfo *m_targetInfo = nullptr;             // Target info
+  std::string m_targetMachineKey;                 // Key the target machine is parked under in the process-wide
+                                                  //  idle-machine pool when this LgcContext is destroyed
+  const TargetInfo *m_targetInfo = nullptr;       // Target info; immutable and shared process-wide per GPU
   unsigned m_palAbiVersion = 0xFFFFFFFF;          // PAL pipeline ABI version to compile for
   PassManagerCache *m_passManagerCache = nullptr; // Pass manager cache and creator
+  std::unique_ptr<llvm::Module> m_libraryModule;  // Module holding pipeline-independent library functions
+
+  std::map<uint64_t, std::string> m_synthesizedShaderElfs; // Finished ELFs for synthesized shader shapes
+  std::map<std::string, std::unique_ptr<llvm::Module>> m_glueModules; // Merged-shader entry glue per configuration
+  std::map<uint64_t, std::vector<CanonicalUserDataNodes>> m_canonicalUserDataNodes; // Canonical user data node
+                                                                                    //  tables by content hash
+  std::map<unsigned, std::string> m_targetFeatureStrings; // Composed "target-features" strings by packed inputs
 };
 
 } // namespace lgc
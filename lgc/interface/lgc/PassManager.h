@@ -30,10 +30,19 @@
  */
 #pragma once
 
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include <atomic>
 
 namespace lgc {
 
+// =====================================================================================================================
+// Record of the wall-clock time spent in one pass, collected when pass timing is enabled on the thread
+struct PassTimeInfo {
+  llvm::StringRef passName; // Name of the pass
+  uint64_t nanos;           // Wall-clock time spent running the pass, in nanoseconds
+};
+
 // =====================================================================================================================
 // Public interface of LLPC middle-end's legacy::PassManager override
 class PassManager : public llvm::legacy::PassManager {
@@ -42,6 +51,32 @@ public:
   virtual ~PassManager() {}
   virtual void stop() = 0;
   virtual void setPassIndex(unsigned *passIndex) = 0;
+
+  // Run the passes. Overrides the non-virtual legacy run() so the implementation can bracket the run for the
+  // per-pass timing below.
+  virtual bool run(llvm::Module &module) = 0;
+
+  // Start collecting the wall-clock time of each pass run by any lgc PassManager on the calling thread into
+  // the given vector, until stopPassTimingOnThread is called. The front-end uses this to attribute
+  // over-budget compilations to passes. The first call (on any thread) turns on insertion of the sampling
+  // markers; pass managers built before that do not report their passes.
+  static void startPassTimingOnThread(llvm::SmallVectorImpl<PassTimeInfo> *passTimes);
+
+  // Stop collecting per-pass times on the calling thread.
+  static void stopPassTimingOnThread();
+
+  // Register a cancellation flag for compilations on the calling thread, until clearCancelFlagOnThread is
+  // called. Once the flag becomes true, run() calls by this thread return immediately without running any
+  // pass, so a canceled compilation stops at the next pass-manager phase boundary instead of running to
+  // completion. The front-end must check isCanceledOnThread afterwards and discard the results of any run
+  // that was skipped.
+  static void setCancelFlagOnThread(const std::atomic<bool> *canceled);
+
+  // Stop honoring a previously registered cancellation flag on the calling thread.
+  static void clearCancelFlagOnThread();
+
+  // Checks whether the cancellation flag registered on the calling thread (if any) has been raised.
+  static bool isCanceledOnThread();
 };
 
 } // namespace lgc
@@ -91,6 +91,15 @@ enum class WaveBreak : unsigned {
   DrawTime = 0xF, ///< Choose wave break size per draw
 };
 
+// Precision tier for transcendental operations that the builder expands to ALU sequences (asin, acos, atan,
+// pow, ...). Lower tiers use shorter minimax expansions; full precision is the default and keeps the existing
+// expansions.
+enum class TranscendentalPrecision : unsigned {
+  Full = 0, ///< Full-precision expansions
+  Relaxed,  ///< Shorter minimax expansions, absolute error around 1e-5
+  Fast,     ///< Shortest expansions, absolute error around 5e-3
+};
+
 // Value for shadowDescriptorTable pipeline option.
 static const unsigned ShadowDescriptorTableDisable = ~0U;
 
@@ -116,6 +125,10 @@ struct Options {
   unsigned shadowDescriptorTable;      // High dword of shadow descriptor table address, or
                                        //   ShadowDescriptorTableDisable to disable shadow descriptor tables
   unsigned allowNullDescriptor;        // Allow and give defined behavior for null descriptor
+  unsigned fastCompile;                // If set, run a minimal middle-end optimization set to produce a usable
+                                       //   pipeline as quickly as possible. Intended for the first tier of a tiered
+                                       //   compilation scheme, where the client recompiles at full optimization in
+                                       //   the background and replaces the pipeline once that completes.
 };
 
 // Middle-end per-shader options to pass to SetShaderOptions.
@@ -163,6 +176,9 @@ struct ShaderOptions {
 
   /// Default unroll threshold for LLVM.
   unsigned unrollThreshold;
+
+  /// Precision tier for transcendentals the builder expands to ALU sequences (asin/acos/atan/pow).
+  TranscendentalPrecision transcendentalPrecision;
 };
 
 // =====================================================================================================================
@@ -317,20 +317,15 @@ void ConfigBuilderBase::appendConfig(ArrayRef<PalMetadataNoteEntry> config) {
 }
 
 // =====================================================================================================================
-// Finish ConfigBuilder processing by writing into the PalMetadata document
+// Finish ConfigBuilder processing by writing into the PalMetadata register map
 void ConfigBuilderBase::writePalMetadata() {
-  // Generating MsgPack metadata.
-  // Add the register values to the MsgPack document. The value is ORed in because an earlier pass may have
-  // already set some bits in the same register.
-  msgpack::MapDocNode registers = m_pipelineNode[".registers"].getMap(true);
+  // Add the register values to PAL metadata. The value is ORed in because an earlier pass may have already
+  // set some bits in the same register. PalMetadata stages the registers in a flat map and splices them into
+  // the MsgPack blob when it is written, rather than building a document node per register here.
+  PalMetadata *palMetadata = m_pipelineState->getPalMetadata();
   for (const auto &entry : m_config) {
     assert(entry.key != InvalidMetadataKey);
-    auto key = entry.key;
-    auto &regEntry = registers[key];
-    unsigned oredValue = entry.value;
-    if (regEntry.getKind() == msgpack::Type::UInt)
-      oredValue = regEntry.getUInt();
-    regEntry = oredValue;
+    palMetadata->setRegister(entry.key, entry.value);
   }
 }
 
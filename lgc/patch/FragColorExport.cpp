@@ -42,6 +42,59 @@ using namespace llvm;
 
 namespace lgc {
 
+namespace {
+
+// Per-format properties consumed by the export format decision, indexed directly by BufDataFormat value.
+// Encoding them as one table replaces the per-render-target switches over the format enum.
+struct BufFormatInfo {
+  unsigned char numChannels;     // Number of channels
+  bool hasAlpha;                 // Whether the alpha channel is present
+  unsigned char maxCompBitCount; // Maximum bit-count of any component
+};
+
+constexpr BufFormatInfo BufFormatInfoTable[] = {
+    // numChannels, hasAlpha, maxCompBitCount
+    {1, false, 0},  // BufDataFormatInvalid
+    {1, false, 8},  // BufDataFormat8
+    {1, false, 16}, // BufDataFormat16
+    {2, false, 8},  // BufDataFormat8_8
+    {1, false, 32}, // BufDataFormat32
+    {2, false, 16}, // BufDataFormat16_16
+    {3, false, 11}, // BufDataFormat10_11_11
+    {3, false, 11}, // BufDataFormat11_11_10
+    {4, true, 10},  // BufDataFormat10_10_10_2
+    {4, true, 10},  // BufDataFormat2_10_10_10
+    {4, true, 8},   // BufDataFormat8_8_8_8
+    {2, false, 32}, // BufDataFormat32_32
+    {4, true, 16},  // BufDataFormat16_16_16_16
+    {3, false, 32}, // BufDataFormat32_32_32
+    {4, true, 32},  // BufDataFormat32_32_32_32
+    {1, false, 0},  // BufDataFormatReserved
+    {4, true, 8},   // BufDataFormat8_8_8_8_Bgra
+    {3, false, 8},  // BufDataFormat8_8_8
+    {3, false, 8},  // BufDataFormat8_8_8_Bgr
+    {4, true, 10},  // BufDataFormat2_10_10_10_Bgra
+    {1, false, 64}, // BufDataFormat64
+    {2, false, 64}, // BufDataFormat64_64
+    {3, false, 64}, // BufDataFormat64_64_64
+    {4, true, 64},  // BufDataFormat64_64_64_64
+    {2, false, 4},  // BufDataFormat4_4
+    {4, true, 4},   // BufDataFormat4_4_4_4
+    {4, true, 4},   // BufDataFormat4_4_4_4_Bgra
+    {3, false, 6},  // BufDataFormat5_6_5
+    {3, false, 6},  // BufDataFormat5_6_5_Bgr
+    {4, true, 6},   // BufDataFormat5_6_5_1
+    {4, true, 6},   // BufDataFormat5_6_5_1_Bgra
+    {4, true, 6},   // BufDataFormat1_5_6_5
+    {4, true, 9},   // BufDataFormat5_9_9_9
+};
+
+constexpr unsigned BufFormatInfoCount = sizeof(BufFormatInfoTable) / sizeof(BufFormatInfoTable[0]);
+
+static_assert(BufFormatInfoCount == BufDataFormat5_9_9_9 + 1, "BufFormatInfoTable is out of step with BufDataFormat");
+
+} // anonymous namespace
+
 // =====================================================================================================================
 //
 // @param pipelineState : Pipeline state
@@ -466,46 +519,9 @@ CompSetting FragColorExport::computeCompSetting(BufDataFormat dfmt) {
 //
 // @param dfmt : Color attachment data format
 unsigned FragColorExport::getNumChannels(BufDataFormat dfmt) {
-  switch (dfmt) {
-  case BufDataFormatInvalid:
-  case BufDataFormatReserved:
-  case BufDataFormat8:
-  case BufDataFormat16:
-  case BufDataFormat32:
-  case BufDataFormat64:
-    return 1;
-  case BufDataFormat4_4:
-  case BufDataFormat8_8:
-  case BufDataFormat16_16:
-  case BufDataFormat32_32:
-  case BufDataFormat64_64:
-    return 2;
-  case BufDataFormat8_8_8:
-  case BufDataFormat8_8_8_Bgr:
-  case BufDataFormat10_11_11:
-  case BufDataFormat11_11_10:
-  case BufDataFormat32_32_32:
-  case BufDataFormat64_64_64:
-  case BufDataFormat5_6_5:
-  case BufDataFormat5_6_5_Bgr:
-    return 3;
-  case BufDataFormat10_10_10_2:
-  case BufDataFormat2_10_10_10:
-  case BufDataFormat8_8_8_8:
-  case BufDataFormat16_16_16_16:
-  case BufDataFormat32_32_32_32:
-  case BufDataFormat8_8_8_8_Bgra:
-  case BufDataFormat2_10_10_10_Bgra:
-  case BufDataFormat64_64_64_64:
-  case BufDataFormat4_4_4_4:
-  case BufDataFormat4_4_4_4_Bgra:
-  case BufDataFormat5_6_5_1:
-  case BufDataFormat5_6_5_1_Bgra:
-  case BufDataFormat1_5_6_5:
-  case BufDataFormat5_9_9_9:
-    return 4;
-  }
-  return 0;
+  if (static_cast<unsigned>(dfmt) >= BufFormatInfoCount)
+    return 0;
+  return BufFormatInfoTable[dfmt].numChannels;
 }
 
 // =====================================================================================================================
@@ -513,25 +529,9 @@ unsigned FragColorExport::getNumChannels(BufDataFormat dfmt) {
 //
 // @param dfmt : Color attachment data format
 bool FragColorExport::hasAlpha(BufDataFormat dfmt) {
-  switch (dfmt) {
-  case BufDataFormat10_10_10_2:
-  case BufDataFormat2_10_10_10:
-  case BufDataFormat8_8_8_8:
-  case BufDataFormat16_16_16_16:
-  case BufDataFormat32_32_32_32:
-  case BufDataFormat8_8_8_8_Bgra:
-  case BufDataFormat2_10_10_10_Bgra:
-  case BufDataFormat64_64_64_64:
-  case BufDataFormat4_4_4_4:
-  case BufDataFormat4_4_4_4_Bgra:
-  case BufDataFormat5_6_5_1:
-  case BufDataFormat5_6_5_1_Bgra:
-  case BufDataFormat1_5_6_5:
-  case BufDataFormat5_9_9_9:
-    return true;
-  default:
+  if (static_cast<unsigned>(dfmt) >= BufFormatInfoCount)
     return false;
-  }
+  return BufFormatInfoTable[dfmt].hasAlpha;
 }
 
 // =====================================================================================================================
@@ -539,52 +539,9 @@ bool FragColorExport::hasAlpha(BufDataFormat dfmt) {
 //
 // @param dfmt : Color attachment data format
 unsigned FragColorExport::getMaxComponentBitCount(BufDataFormat dfmt) {
-  switch (dfmt) {
-  case BufDataFormatInvalid:
-  case BufDataFormatReserved:
+  if (static_cast<unsigned>(dfmt) >= BufFormatInfoCount)
     return 0;
-  case BufDataFormat4_4:
-  case BufDataFormat4_4_4_4:
-  case BufDataFormat4_4_4_4_Bgra:
-    return 4;
-  case BufDataFormat5_6_5:
-  case BufDataFormat5_6_5_Bgr:
-  case BufDataFormat5_6_5_1:
-  case BufDataFormat5_6_5_1_Bgra:
-  case BufDataFormat1_5_6_5:
-    return 6;
-  case BufDataFormat8:
-  case BufDataFormat8_8:
-  case BufDataFormat8_8_8:
-  case BufDataFormat8_8_8_Bgr:
-  case BufDataFormat8_8_8_8:
-  case BufDataFormat8_8_8_8_Bgra:
-    return 8;
-  case BufDataFormat5_9_9_9:
-    return 9;
-  case BufDataFormat10_10_10_2:
-  case BufDataFormat2_10_10_10:
-  case BufDataFormat2_10_10_10_Bgra:
-    return 10;
-  case BufDataFormat10_11_11:
-  case BufDataFormat11_11_10:
-    return 11;
-  case BufDataFormat16:
-  case BufDataFormat16_16:
-  case BufDataFormat16_16_16_16:
-    return 16;
-  case BufDataFormat32:
-  case BufDataFormat32_32:
-  case BufDataFormat32_32_32:
-  case BufDataFormat32_32_32_32:
-    return 32;
-  case BufDataFormat64:
-  case BufDataFormat64_64:
-  case BufDataFormat64_64_64:
-  case BufDataFormat64_64_64_64:
-    return 64;
-  }
-  return 0;
+  return BufFormatInfoTable[dfmt].maxCompBitCount;
 }
 
 // =====================================================================================================================
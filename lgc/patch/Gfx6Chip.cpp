@@ -29,6 +29,8 @@
  ***********************************************************************************************************************
  */
 #include "Gfx6Chip.h"
+#include <mutex>
+#include <unordered_map>
 
 #define DEBUG_TYPE "lgc-gfx6-chip"
 
@@ -180,11 +182,17 @@ CsRegConfig::CsRegConfig() {
   INIT_REG(COMPUTE_NUM_THREAD_Z);
 }
 
+// Map from register ID to its name string, built lazily by getRegisterNameString
+static std::unordered_map<unsigned, const char *> RegNameMap;
+
+// Adds an entry for the map from register ID to its name string
+#define ADD_REG_MAP(_reg) RegNameMap[mm##_reg * 4] = #_reg;
+
 // =====================================================================================================================
 // Adds entries to register name map.
 //
 // @param gfxIp : Graphics IP version info
-void initRegisterNameMap(GfxIpVersion gfxIp) {
+static void initRegisterNameMap(GfxIpVersion gfxIp) {
   assert(gfxIp.major <= 8);
 
   ADD_REG_MAP(SPI_SHADER_PGM_RSRC1_VS);
@@ -417,6 +425,28 @@ void initRegisterNameMap(GfxIpVersion gfxIp) {
   ADD_REG_MAP(IA_MULTI_VGT_PARAM);
 }
 
+// =====================================================================================================================
+// Gets the name string of the given register, or nullptr if it is not a register the config builders emit.
+// Builds the name map on first use.
+//
+// @param gfxIp : Graphics IP version info
+// @param regId : Byte-based ID of the register
+const char *getRegisterNameString(GfxIpVersion gfxIp, unsigned regId) {
+  assert(gfxIp.major <= 8);
+
+  static std::mutex RegNameMapMutex;
+  std::lock_guard<std::mutex> lock(RegNameMapMutex);
+
+  static bool Built = false;
+  if (!Built) {
+    initRegisterNameMap(gfxIp);
+    Built = true;
+  }
+
+  auto it = RegNameMap.find(regId);
+  return it != RegNameMap.end() ? it->second : nullptr;
+}
+
 } // namespace Gfx6
 
 } // namespace lgc
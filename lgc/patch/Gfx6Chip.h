@@ -33,7 +33,6 @@
 #include "ConfigBuilderBase.h"
 #include "lgc/state/TargetInfo.h"
 #include <cstdint>
-#include <unordered_map>
 
 namespace lgc {
 
@@ -59,9 +58,6 @@ using namespace Pal::Gfx6::Chip;
     _reg##_VAL.u32All = 0;                                                                                             \
   }
 
-// Adds an entry for the map from register ID to its name string
-#define ADD_REG_MAP(_reg) RegNameMap[mm##_reg * 4] = #_reg;
-
 // Gets register value
 #define GET_REG(_stage, _reg) ((_stage)->_reg##_VAL.u32All)
 
@@ -273,11 +269,13 @@ struct CsRegConfig {
   CsRegConfig();
 };
 
-// Map from register ID to its name string
-static std::unordered_map<unsigned, const char *> RegNameMap;
-
-// Adds entries to register name map.
-void initRegisterNameMap(GfxIpVersion gfxIp);
+// Gets the name string of the given register, or nullptr if it is not a register the config builders emit. The
+// name map consulted lives in one translation unit and is built once per process on first use, rather than
+// being instantiated (with its global constructor) into every translation unit including this header.
+//
+// @param gfxIp : Graphics IP version info
+// @param regId : Byte-based ID of the register
+const char *getRegisterNameString(GfxIpVersion gfxIp, unsigned regId);
 
 } // namespace Gfx6
 
@@ -30,6 +30,8 @@
  */
 #include "Gfx9Chip.h"
 #include "llvm/Support/ErrorHandling.h"
+#include <mutex>
+#include <unordered_map>
 
 #define DEBUG_TYPE "lgc-gfx9-chip"
 
@@ -306,11 +308,23 @@ CsRegConfig::CsRegConfig(GfxIpVersion gfxIp) {
   }
 }
 
+// Maps from register ID to its name string, built lazily by getRegisterNameString
+static std::unordered_map<unsigned, const char *> RegNameMap;
+static std::unordered_map<unsigned, const char *> RegNameMapGfx9;  // GFX9 specific
+static std::unordered_map<unsigned, const char *> RegNameMapGfx10; // GFX10 specific
+
+// Adds an entry for the map from register ID to its name string
+#define ADD_REG_MAP(_reg) RegNameMap[mm##_reg * 4] = #_reg;
+
+#define ADD_REG_MAP_GFX9(_reg) RegNameMapGfx9[Gfx09::mm##_reg * 4] = #_reg;
+#define ADD_REG_MAP_GFX10(_reg) RegNameMapGfx10[Pal::Gfx9::Chip::Gfx10::mm##_reg * 4] = #_reg;
+#define ADD_REG_MAP_APU09_1X_PLUS(_reg) RegNameMapGfx10[Apu09_1xPlus::mm##_reg * 4] = #_reg;
+
 // =====================================================================================================================
 // Adds entries to register name map.
 //
 // @param gfxIp : Graphics IP version info
-void initRegisterNameMap(GfxIpVersion gfxIp) {
+static void initRegisterNameMap(GfxIpVersion gfxIp) {
   assert(gfxIp.major == 9 || gfxIp.major == 10);
 
   ADD_REG_MAP(SPI_SHADER_PGM_RSRC1_VS);
@@ -690,6 +704,33 @@ void initRegisterNameMap(GfxIpVersion gfxIp) {
   }
 }
 
+// =====================================================================================================================
+// Gets the name string of the given register, or nullptr if it is not a register the config builders emit.
+// Builds the name maps for the given GFX IP version on first use.
+//
+// @param gfxIp : Graphics IP version info
+// @param regId : Byte-based ID of the register
+const char *getRegisterNameString(GfxIpVersion gfxIp, unsigned regId) {
+  assert(gfxIp.major == 9 || gfxIp.major == 10);
+
+  static std::mutex RegNameMapMutex;
+  std::lock_guard<std::mutex> lock(RegNameMapMutex);
+
+  static bool BuiltForMajor[2] = {};
+  bool &built = BuiltForMajor[gfxIp.major == 9 ? 0 : 1];
+  if (!built) {
+    initRegisterNameMap(gfxIp);
+    built = true;
+  }
+
+  auto it = RegNameMap.find(regId);
+  if (it != RegNameMap.end())
+    return it->second;
+  const auto &gfxMap = gfxIp.major == 9 ? RegNameMapGfx9 : RegNameMapGfx10;
+  auto gfxIt = gfxMap.find(regId);
+  return gfxIt != gfxMap.end() ? gfxIt->second : nullptr;
+}
+
 } // namespace Gfx9
 
 } // namespace lgc
@@ -33,7 +33,7 @@
 #include "ConfigBuilderBase.h"
 #include "lgc/state/TargetInfo.h"
 #include <cstdint>
-#include <unordered_map>
+#include <mutex>
 
 namespace lgc {
 
@@ -142,13 +142,6 @@ using namespace Pal::Gfx9::Chip;
     break;                                                                                                             \
   }
 
-// Adds an entry for the map from register ID to its name string
-#define ADD_REG_MAP(_reg) RegNameMap[mm##_reg * 4] = #_reg;
-
-#define ADD_REG_MAP_GFX9(_reg) RegNameMapGfx9[Gfx09::mm##_reg * 4] = #_reg;
-#define ADD_REG_MAP_GFX10(_reg) RegNameMapGfx10[Pal::Gfx9::Chip::Gfx10::mm##_reg * 4] = #_reg;
-#define ADD_REG_MAP_APU09_1X_PLUS(_reg) RegNameMapGfx10[Apu09_1xPlus::mm##_reg * 4] = #_reg;
-
 // Gets register value
 #define GET_REG(_stage, _reg) ((_stage)->_reg##_VAL.u32All)
 
@@ -529,13 +522,35 @@ struct CsRegConfig {
   CsRegConfig(GfxIpVersion gfxIp);
 };
 
-// Map from register ID to its name string
-static std::unordered_map<unsigned, const char *> RegNameMap;
-static std::unordered_map<unsigned, const char *> RegNameMapGfx9;  // GFX9 specific
-static std::unordered_map<unsigned, const char *> RegNameMapGfx10; // GFX10 specific
-
-// Adds entries to register name map.
-void initRegisterNameMap(GfxIpVersion gfxIp);
+// =====================================================================================================================
+// Gets a pre-initialized template of the given register config struct for the given GFX IP version.
+// The INIT_REG* chains in the config constructors select a register offset (or mark the register invalid) per
+// GFX IP for every register. Doing that once per (config type, GFX IP) and copying the flat struct leaves only
+// the patching of pipeline-dependent register values as per-pipeline work, which adds up when a driver builds
+// tens of thousands of pipelines.
+//
+// @param gfxIp : Graphics IP version info
+template <typename RegConfig> RegConfig regConfigTemplate(GfxIpVersion gfxIp) {
+  static std::mutex Mutex;
+  static llvm::SmallVector<std::pair<GfxIpVersion, RegConfig>, 2> Templates;
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  for (const auto &entry : Templates) {
+    if (entry.first.major == gfxIp.major && entry.first.minor == gfxIp.minor &&
+        entry.first.stepping == gfxIp.stepping)
+      return entry.second;
+  }
+  Templates.push_back({gfxIp, RegConfig(gfxIp)});
+  return Templates.back().second;
+}
+
+// Gets the name string of the given register, or nullptr if it is not a register the config builders emit. The
+// name maps consulted live in one translation unit and are built once per process on first use, rather than
+// being instantiated (with their global constructors) into every translation unit including this header.
+//
+// @param gfxIp : Graphics IP version info
+// @param regId : Byte-based ID of the register
+const char *getRegisterNameString(GfxIpVersion gfxIp, unsigned regId);
 
 } // namespace Gfx9
 
@@ -98,7 +98,7 @@ void ConfigBuilder::buildPipelineVsFsRegConfig() // [out] Size of register confi
 
   const unsigned stageMask = m_pipelineState->getShaderStageMask();
 
-  PipelineVsFsRegConfig config(gfxIp);
+  PipelineVsFsRegConfig config = regConfigTemplate<PipelineVsFsRegConfig>(gfxIp);
 
   addApiHwShaderMapping(ShaderStageFragment, Util::Abi::HwShaderPs);
 
@@ -163,7 +163,7 @@ void ConfigBuilder::buildPipelineVsTsFsRegConfig() {
 
   const unsigned stageMask = m_pipelineState->getShaderStageMask();
 
-  PipelineVsTsFsRegConfig config(gfxIp);
+  PipelineVsTsFsRegConfig config = regConfigTemplate<PipelineVsTsFsRegConfig>(gfxIp);
 
   addApiHwShaderMapping(ShaderStageVertex, Util::Abi::HwShaderHs);
   addApiHwShaderMapping(ShaderStageTessControl, Util::Abi::HwShaderHs);
@@ -264,7 +264,7 @@ void ConfigBuilder::buildPipelineVsGsFsRegConfig() // [out] Size of register con
 
   const unsigned stageMask = m_pipelineState->getShaderStageMask();
 
-  PipelineVsGsFsRegConfig config(gfxIp);
+  PipelineVsGsFsRegConfig config = regConfigTemplate<PipelineVsGsFsRegConfig>(gfxIp);
 
   addApiHwShaderMapping(ShaderStageVertex, Util::Abi::HwShaderGs);
   addApiHwShaderMapping(ShaderStageGeometry, Util::Abi::HwShaderGs | Util::Abi::HwShaderVs);
@@ -344,7 +344,7 @@ void ConfigBuilder::buildPipelineVsTsGsFsRegConfig() {
 
   const unsigned stageMask = m_pipelineState->getShaderStageMask();
 
-  PipelineVsTsGsFsRegConfig config(gfxIp);
+  PipelineVsTsGsFsRegConfig config = regConfigTemplate<PipelineVsTsGsFsRegConfig>(gfxIp);
 
   addApiHwShaderMapping(ShaderStageVertex, Util::Abi::HwShaderHs);
   addApiHwShaderMapping(ShaderStageTessControl, Util::Abi::HwShaderHs);
@@ -468,7 +468,7 @@ void ConfigBuilder::buildPipelineNggVsFsRegConfig() {
 
   const unsigned stageMask = m_pipelineState->getShaderStageMask();
 
-  PipelineNggVsFsRegConfig config(gfxIp);
+  PipelineNggVsFsRegConfig config = regConfigTemplate<PipelineNggVsFsRegConfig>(gfxIp);
 
   addApiHwShaderMapping(ShaderStageVertex, Util::Abi::HwShaderGs);
   addApiHwShaderMapping(ShaderStageFragment, Util::Abi::HwShaderPs);
@@ -537,7 +537,7 @@ void ConfigBuilder::buildPipelineNggVsTsFsRegConfig() {
 
   const unsigned stageMask = m_pipelineState->getShaderStageMask();
 
-  PipelineNggVsTsFsRegConfig config(gfxIp);
+  PipelineNggVsTsFsRegConfig config = regConfigTemplate<PipelineNggVsTsFsRegConfig>(gfxIp);
 
   addApiHwShaderMapping(ShaderStageVertex, Util::Abi::HwShaderHs);
   addApiHwShaderMapping(ShaderStageTessControl, Util::Abi::HwShaderHs);
@@ -628,7 +628,7 @@ void ConfigBuilder::buildPipelineNggVsGsFsRegConfig() {
 
   const unsigned stageMask = m_pipelineState->getShaderStageMask();
 
-  PipelineNggVsGsFsRegConfig config(gfxIp);
+  PipelineNggVsGsFsRegConfig config = regConfigTemplate<PipelineNggVsGsFsRegConfig>(gfxIp);
 
   addApiHwShaderMapping(ShaderStageVertex, Util::Abi::HwShaderGs);
   addApiHwShaderMapping(ShaderStageGeometry, Util::Abi::HwShaderGs);
@@ -701,7 +701,7 @@ void ConfigBuilder::buildPipelineNggVsTsGsFsRegConfig() {
 
   const unsigned stageMask = m_pipelineState->getShaderStageMask();
 
-  PipelineNggVsTsGsFsRegConfig config(gfxIp);
+  PipelineNggVsTsGsFsRegConfig config = regConfigTemplate<PipelineNggVsTsGsFsRegConfig>(gfxIp);
 
   addApiHwShaderMapping(ShaderStageVertex, Util::Abi::HwShaderHs);
   addApiHwShaderMapping(ShaderStageTessControl, Util::Abi::HwShaderHs);
@@ -804,7 +804,7 @@ void ConfigBuilder::buildPipelineCsRegConfig() {
 
   assert(m_pipelineState->getShaderStageMask() == shaderStageToMask(ShaderStageCompute));
 
-  CsRegConfig config(gfxIp);
+  CsRegConfig config = regConfigTemplate<CsRegConfig>(gfxIp);
 
   addApiHwShaderMapping(ShaderStageCompute, Util::Abi::HwShaderCs);
 
@@ -31,6 +31,7 @@
 #include "NggLdsManager.h"
 #include "Gfx9Chip.h"
 #include "lgc/patch/Patch.h"
+#include "lgc/state/PalMetadata.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
 #include "lgc/util/Debug.h"
@@ -47,6 +48,9 @@ using namespace llvm;
 
 namespace lgc {
 
+// Number of LDS banks on GFX10 (each bank is one dword wide)
+static const unsigned LdsBankCount = 32;
+
 // =====================================================================================================================
 // Initialize static members
 const unsigned NggLdsManager::LdsRegionSizes[LdsRegionCount] = {
@@ -97,6 +101,38 @@ const unsigned NggLdsManager::LdsRegionSizes[LdsRegionCount] = {
     // clang-format on
 };
 
+// =====================================================================================================================
+// Initialize static members
+const NggLdsAccessPhase NggLdsManager::LdsRegionAccessPhases[LdsRegionCount] = {
+    // clang-format off
+    //
+    // LDS region access phase for ES-only
+    //
+    LdsAccessPhasePerPrimitive, // LdsRegionDistribPrimId (written per primitive, read back per vertex)
+    LdsAccessPhasePerVertex,    // LdsRegionPosData
+    LdsAccessPhasePerPrimitive, // LdsRegionDrawFlag (written for the vertices of each surviving primitive)
+    LdsAccessPhasePerWave,      // LdsRegionVertCountInWaves
+    LdsAccessPhasePerVertex,    // LdsRegionCullDistance
+    LdsAccessPhasePerVertex,    // LdsRegionVertThreadIdMap
+    LdsAccessPhasePerVertex,    // LdsRegionCompactVertexId
+    LdsAccessPhasePerVertex,    // LdsRegionCompactInstanceId
+    LdsAccessPhasePerVertex,    // LdsRegionCompactPrimId
+    LdsAccessPhasePerVertex,    // LdsRegionCompactTessCoordX
+    LdsAccessPhasePerVertex,    // LdsRegionCompactTessCoordY
+    LdsAccessPhasePerVertex,    // LdsRegionCompactPatchId
+    LdsAccessPhasePerVertex,    // LdsRegionCompactRelPatchId
+
+    //
+    // LDS region access phase for ES-GS
+    //
+    LdsAccessPhasePerVertex,    // LdsRegionEsGsRing
+    LdsAccessPhasePerPrimitive, // LdsRegionOutPrimData
+    LdsAccessPhasePerWave,      // LdsRegionOutVertCountInWaves
+    LdsAccessPhasePerVertex,    // LdsRegionOutVertThreadIdMap
+    LdsAccessPhasePerVertex,    // LdsRegionGsVsRing
+    // clang-format on
+};
+
 // =====================================================================================================================
 // Initialize static members
 const char *NggLdsManager::m_ldsRegionNames[LdsRegionCount] = {
@@ -165,6 +201,9 @@ NggLdsManager::NggLdsManager(Module *module, PipelineState *pipelineState, IRBui
 
   const auto &calcFactor = m_pipelineState->getShaderResourceUsage(ShaderStageGeometry)->inOutUsage.gs.calcFactor;
 
+  // Final layout, exposed in PAL metadata for tooling (to correlate LDS traffic in GPU captures with regions)
+  SmallVector<NggLdsRegionInfo, LdsRegionCount> ldsLayoutInfo;
+
   if (hasGs) {
     //
     // The LDS layout is something like this:
@@ -197,6 +236,8 @@ NggLdsManager::NggLdsManager(Module *module, PipelineState *pipelineState, IRBui
       assert(ldsRegionSize != InvalidValue);
       ldsRegionStart += ldsRegionSize;
 
+      ldsLayoutInfo.push_back({m_ldsRegionNames[region], m_ldsRegionStart[region], ldsRegionSize});
+
       LLPC_OUTS(format("%-40s : offset = 0x%04" PRIX32 ", size = 0x%04" PRIX32, m_ldsRegionNames[region],
                        m_ldsRegionStart[region], ldsRegionSize)
                 << "\n");
@@ -204,54 +245,55 @@ NggLdsManager::NggLdsManager(Module *module, PipelineState *pipelineState, IRBui
   } else {
     m_ldsRegionStart[LdsRegionDistribPrimId] = 0;
 
+    ldsLayoutInfo.push_back(
+        {m_ldsRegionNames[LdsRegionDistribPrimId], 0, LdsRegionSizes[LdsRegionDistribPrimId]});
+
     LLPC_OUTS(format("%-40s : offset = 0x%04" PRIX32 ", size = 0x%04" PRIX32, m_ldsRegionNames[LdsRegionDistribPrimId],
                      m_ldsRegionStart[LdsRegionDistribPrimId], LdsRegionSizes[LdsRegionDistribPrimId])
               << "\n");
 
     if (!nggControl->passthroughMode) {
       //
-      // The LDS layout is something like this:
+      // The LDS layout is something like this (regions are grouped by access phase and each region start is
+      // skewed to a different LDS bank, see calcEsNonPassthroughLayout for details):
       //
-      // +--------------------------+-----------+----------------------------+---------------+
-      // | Vertex position data     | Draw flag | Vertex count (in waves)    | Cull distance | >>>
-      // +--------------------------+-----------+----------------------------+---------------+
-      // | Distributed primitive ID |           | Primitive count (in waves) |
-      // +--------------------------+           +----------------------------+
+      // +--------------------------+---------------+------------------------------------------------------+
+      // | Vertex position data     | Cull distance | ====== Compacted data region (vertex compaction) ===== >>>
+      // +--------------------------+---------------+------------------------------------------------------+
+      // | Distributed primitive ID |
+      // +--------------------------+
       //
-      //                            | ====== Compacted data region (for vertex compaction) ====== |
-      //     +----------------------+-------------+-------------+-------------+
-      // >>> | Vertex thread ID map | Vertex ID   | Instance ID | Primtive ID |                     (VS)
+      //     +----------------------+-------------+-------------+-------------+                     (VS)
+      // >>> | Vertex thread ID map | Vertex ID   | Instance ID | Primtive ID |
       //     +----------------------+-------------+-------------+-------------+-------------------+
       //                            | Tesscoord X | Tesscoord Y | Patch ID    | Relative patch ID | (TES)
       //                            +-------------+-------------+-------------+-------------------+
       //
-      unsigned ldsRegionStart = 0;
+      //     +-----------+----------------------------+
+      // >>> | Draw flag | Vertex count (in waves)    |
+      //     +-----------+----------------------------+
+      //                 | Primitive count (in waves) |
+      //                 +----------------------------+
+      //
+      unsigned regionStarts[LdsRegionCount] = {};
+      unsigned regionPaddings[LdsRegionCount] = {};
+      calcEsNonPassthroughLayout(m_pipelineState, regionStarts, regionPaddings);
+
       for (unsigned region = LdsRegionEsBeginRange; region <= LdsRegionEsEndRange; ++region) {
         // NOTE: For NGG non pass-through mode, primitive ID region is overlapped with position data.
         if (region == LdsRegionDistribPrimId)
           continue;
 
-        // NOTE: If cull distance culling is disabled, skip this region
-        if (region == LdsRegionCullDistance && !nggControl->enableCullDistanceCulling)
-          continue;
+        if (regionStarts[region] == InvalidValue)
+          continue; // Skipped region, not valid for this pipeline
+
+        m_ldsRegionStart[region] = regionStarts[region];
+
+        ldsLayoutInfo.push_back({m_ldsRegionNames[region], m_ldsRegionStart[region], LdsRegionSizes[region]});
 
-        if (hasTs) {
-          // Skip those regions that are for VS only
-          if (region == LdsRegionCompactVertexId || region == LdsRegionCompactInstanceId ||
-              region == LdsRegionCompactPrimId)
-            continue;
-        } else {
-          // Skip those regions that are for TES only
-          if (region == LdsRegionCompactTessCoordX || region == LdsRegionCompactTessCoordY ||
-              region == LdsRegionCompactRelPatchId || region == LdsRegionCompactPatchId)
-            continue;
-        }
-
-        m_ldsRegionStart[region] = ldsRegionStart;
-        ldsRegionStart += LdsRegionSizes[region];
-
-        LLPC_OUTS(format("%-40s : offset = 0x%04" PRIX32 ", size = 0x%04" PRIX32, m_ldsRegionNames[region],
-                         m_ldsRegionStart[region], LdsRegionSizes[region])
+        LLPC_OUTS(format("%-40s : offset = 0x%04" PRIX32 ", size = 0x%04" PRIX32 ", padding = 0x%04" PRIX32,
+                         m_ldsRegionNames[region], m_ldsRegionStart[region], LdsRegionSizes[region],
+                         regionPaddings[region])
                   << "\n");
       }
     }
@@ -260,41 +302,52 @@ NggLdsManager::NggLdsManager(Module *module, PipelineState *pipelineState, IRBui
   LLPC_OUTS(format("%-40s :                  size = 0x%04" PRIX32, static_cast<const char *>("LDS total"),
                    calcFactor.gsOnChipLdsSize * SizeOfDword)
             << "\n\n");
+
+  // Expose the computed layout in PAL metadata for tooling
+  m_pipelineState->getPalMetadata()->addNggLdsLayoutInfo(ldsLayoutInfo);
 }
 
 // =====================================================================================================================
-// Calculates ES extra LDS size.
+// Lays out the LDS regions of the ES-only (no GS) non pass-through path, modeling GFX10 LDS bank conflicts.
+//
+// GFX10 LDS is built from LdsBankCount banks, each one dword wide, and consecutive dwords map to consecutive
+// banks. Every per-thread region size is a whole multiple of the bank rotation (LdsBankCount dwords), so a
+// tightly packed layout makes all regions start on bank 0: back-to-back LDS instructions in the culling and
+// compaction phases, which walk several regions with the same per-thread addressing, then produce the same bank
+// access pattern again and again and serialize on the same bank ports. To spread this traffic, regions are
+// grouped by the prim shader phase that accesses them (per-vertex, per-primitive, per-wave) and the start of
+// each region is padded to begin one bank after the previous region of the same phase. The position data region
+// keeps 16-byte alignment for DS128 access.
+//
+// This function computes the layout for both the constructor (which records region starts) and
+// calcEsExtraLdsSize (which only needs the total), keeping the two consistent including padding.
 //
 // @param pipelineState : Pipeline state
-unsigned NggLdsManager::calcEsExtraLdsSize(PipelineState *pipelineState) {
+// @param [out] regionStarts : If not nullptr, receives start offsets of all regions (InvalidValue if unused)
+// @param [out] regionPaddings : If not nullptr, receives padding inserted before each region (in bytes)
+unsigned NggLdsManager::calcEsNonPassthroughLayout(PipelineState *pipelineState, unsigned *regionStarts,
+                                                   unsigned *regionPaddings) {
   const auto nggControl = pipelineState->getNggControl();
-  if (!nggControl->enableNgg)
-    return 0;
+  assert(!nggControl->passthroughMode);
 
   const unsigned stageMask = pipelineState->getShaderStageMask();
-  const bool hasGs = ((stageMask & shaderStageToMask(ShaderStageGeometry)) != 0);
-
-  if (hasGs) {
-    // NOTE: Not need ES extra LDS when GS is present.
-    return 0;
-  }
-
   const bool hasTs =
       ((stageMask & (shaderStageToMask(ShaderStageTessControl) | shaderStageToMask(ShaderStageTessEval))) != 0);
 
-  unsigned esExtraLdsSize = 0;
+  if (regionStarts)
+    memset(regionStarts, InvalidValue, sizeof(unsigned) * LdsRegionCount); // Initialized to invalid value
+  if (regionPaddings)
+    memset(regionPaddings, 0, sizeof(unsigned) * LdsRegionCount);
 
-  if (nggControl->passthroughMode) {
-    // NOTE: For NGG pass-through mode, only primitive ID region is valid.
-    bool distributePrimId = false;
-    if (!hasTs) {
-      const auto &builtInUsage = pipelineState->getShaderResourceUsage(ShaderStageVertex)->builtInUsage.vs;
-      distributePrimId = builtInUsage.primitiveId;
-    }
+  // Collect the regions valid for this pipeline, grouped by access phase (stable order within each phase)
+  unsigned layoutOrder[LdsRegionCount] = {};
+  unsigned layoutRegionCount = 0;
 
-    esExtraLdsSize = distributePrimId ? LdsRegionSizes[LdsRegionDistribPrimId] : 0;
-  } else {
+  for (unsigned phase = 0; phase < LdsAccessPhaseCount; ++phase) {
     for (unsigned region = LdsRegionEsBeginRange; region <= LdsRegionEsEndRange; ++region) {
+      if (LdsRegionAccessPhases[region] != phase)
+        continue;
+
       // NOTE: For NGG non pass-through mode, primitive ID region is overlapped with position data.
       if (region == LdsRegionDistribPrimId)
         continue;
@@ -315,8 +368,79 @@ unsigned NggLdsManager::calcEsExtraLdsSize(PipelineState *pipelineState) {
           continue;
       }
 
-      esExtraLdsSize += LdsRegionSizes[region];
+      layoutOrder[layoutRegionCount++] = region;
+    }
+  }
+
+  unsigned ldsRegionStart = 0;
+  unsigned nextBankSkew[LdsAccessPhaseCount] = {};
+
+  for (unsigned i = 0; i < layoutRegionCount; ++i) {
+    const unsigned region = layoutOrder[i];
+    const NggLdsAccessPhase phase = LdsRegionAccessPhases[region];
+
+    unsigned padding = 0;
+    if (region == LdsRegionPosData) {
+      // Keep position data 16-byte aligned for DS128 access (DS128 alignment trumps bank skew)
+      padding = alignTo(ldsRegionStart, SizeOfVec4) - ldsRegionStart;
+    } else {
+      // Pad the region start up to the next skewed bank of its access phase
+      const unsigned startBank = (ldsRegionStart / SizeOfDword) % LdsBankCount;
+      padding = ((nextBankSkew[phase] + LdsBankCount - startBank) % LdsBankCount) * SizeOfDword;
+    }
+    ldsRegionStart += padding;
+
+    if (regionStarts)
+      regionStarts[region] = ldsRegionStart;
+    if (regionPaddings)
+      regionPaddings[region] = padding;
+
+    nextBankSkew[phase] = ((ldsRegionStart / SizeOfDword) + 1) % LdsBankCount;
+    ldsRegionStart += LdsRegionSizes[region];
+  }
+
+  // NOTE: For NGG non pass-through mode, primitive ID region is overlapped with position data.
+  if (regionStarts)
+    regionStarts[LdsRegionDistribPrimId] = regionStarts[LdsRegionPosData];
+
+  return ldsRegionStart;
+}
+
+// =====================================================================================================================
+// Calculates ES extra LDS size.
+//
+// @param pipelineState : Pipeline state
+unsigned NggLdsManager::calcEsExtraLdsSize(PipelineState *pipelineState) {
+  const auto nggControl = pipelineState->getNggControl();
+  if (!nggControl->enableNgg)
+    return 0;
+
+  const unsigned stageMask = pipelineState->getShaderStageMask();
+  const bool hasGs = ((stageMask & shaderStageToMask(ShaderStageGeometry)) != 0);
+
+  if (hasGs) {
+    // NOTE: Not need ES extra LDS when GS is present.
+    return 0;
+  }
+
+  const bool hasTs =
+      ((stageMask & (shaderStageToMask(ShaderStageTessControl) | shaderStageToMask(ShaderStageTessEval))) != 0);
+
+  unsigned esExtraLdsSize = 0;
+
+  if (nggControl->passthroughMode) {
+    // NOTE: For NGG pass-through mode, only primitive ID region is valid.
+    bool distributePrimId = false;
+    if (!hasTs) {
+      const auto &builtInUsage = pipelineState->getShaderResourceUsage(ShaderStageVertex)->builtInUsage.vs;
+      distributePrimId = builtInUsage.primitiveId;
     }
+
+    esExtraLdsSize = distributePrimId ? LdsRegionSizes[LdsRegionDistribPrimId] : 0;
+  } else {
+    // NOTE: The total must include the bank-skew padding inserted by the layout step, so the layout computation
+    // is shared with the constructor.
+    esExtraLdsSize = calcEsNonPassthroughLayout(pipelineState, nullptr, nullptr);
   }
 
   return esExtraLdsSize;
@@ -85,6 +85,16 @@ enum NggLdsRegionType {
   // clang-format on
 };
 
+// Enumerates the NGG prim shader phases in which an LDS region is predominantly accessed. The layout step uses
+// this to group regions whose accesses are issued back-to-back and to rotate their starting LDS banks.
+enum NggLdsAccessPhase : unsigned {
+  LdsAccessPhasePerVertex = 0, // Accessed once per vertex (vertex culling, compaction, and export)
+  LdsAccessPhasePerPrimitive,  // Accessed once per primitive (primitive culling and export)
+  LdsAccessPhasePerWave,       // Accessed per wave or per sub-group (count accumulation)
+
+  LdsAccessPhaseCount
+};
+
 // Size of a dword
 static const unsigned SizeOfDword = sizeof(unsigned);
 
@@ -114,8 +124,12 @@ private:
   NggLdsManager(const NggLdsManager &) = delete;
   NggLdsManager &operator=(const NggLdsManager &) = delete;
 
-  static const unsigned LdsRegionSizes[LdsRegionCount]; // LDS sizes for all LDS region types (in bytes)
-  static const char *m_ldsRegionNames[LdsRegionCount];  // Name strings for all LDS region types
+  static unsigned calcEsNonPassthroughLayout(PipelineState *pipelineState, unsigned *regionStarts,
+                                             unsigned *regionPaddings);
+
+  static const unsigned LdsRegionSizes[LdsRegionCount];                 // LDS sizes for all LDS region types (in bytes)
+  static const NggLdsAccessPhase LdsRegionAccessPhases[LdsRegionCount]; // Access phases for all LDS region types
+  static const char *m_ldsRegionNames[LdsRegionCount];                  // Name strings for all LDS region types
 
   PipelineState *m_pipelineState; // Pipeline state
   llvm::LLVMContext *m_context;   // LLVM context
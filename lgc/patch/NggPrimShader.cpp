@@ -32,6 +32,7 @@
 #include "Gfx9Chip.h"
 #include "NggLdsManager.h"
 #include "ShaderMerger.h"
+#include "lgc/LgcContext.h"
 #include "lgc/PassManager.h"
 #include "lgc/state/PalMetadata.h"
 #include "llvm/IR/Constants.h"
@@ -3609,9 +3610,7 @@ Value *NggPrimShader::doBackfaceCulling(Module *module, Value *cullFlag, Value *
                                         Value *vertex2) {
   assert(m_nggControl->enableBackfaceCulling);
 
-  auto backfaceCuller = module->getFunction(lgcName::NggCullingBackface);
-  if (!backfaceCuller)
-    backfaceCuller = createBackfaceCuller(module);
+  auto backfaceCuller = getOrCreateCuller(module, lgcName::NggCullingBackface, &NggPrimShader::createBackfaceCuller);
 
   // Get register PA_SU_SC_MODE_CNTL
   Value *paSuScModeCntl = nullptr;
@@ -3627,6 +3626,8 @@ Value *NggPrimShader::doBackfaceCulling(Module *module, Value *cullFlag, Value *
   auto paClVportYscale = fetchCullingControlRegister(module, m_cbLayoutTable.vportControls[0].paClVportYscale);
 
   // Do backface culling
+  // NOTE: The backface exponent is the one culling control with no slot in the PAL-defined primitive shader
+  // table layout, so it stays a compile-time constant even when every other control is fetched from the table.
   return m_builder->CreateCall(backfaceCuller, {cullFlag, vertex0, vertex1, vertex2,
                                                 m_builder->getInt32(m_nggControl->backfaceExponent), paSuScModeCntl,
                                                 paClVportXscale, paClVportYscale});
@@ -3644,9 +3645,7 @@ Value *NggPrimShader::doFrustumCulling(Module *module, Value *cullFlag, Value *v
                                        Value *vertex2) {
   assert(m_nggControl->enableFrustumCulling);
 
-  auto frustumCuller = module->getFunction(lgcName::NggCullingFrustum);
-  if (!frustumCuller)
-    frustumCuller = createFrustumCuller(module);
+  auto frustumCuller = getOrCreateCuller(module, lgcName::NggCullingFrustum, &NggPrimShader::createFrustumCuller);
 
   // Get register PA_CL_CLIP_CNTL
   Value *paClClipCntl = nullptr;
@@ -3678,12 +3677,14 @@ Value *NggPrimShader::doBoxFilterCulling(Module *module, Value *cullFlag, Value
                                          Value *vertex2) {
   assert(m_nggControl->enableBoxFilterCulling);
 
-  auto boxFilterCuller = module->getFunction(lgcName::NggCullingBoxFilter);
-  if (!boxFilterCuller)
-    boxFilterCuller = createBoxFilterCuller(module);
+  auto boxFilterCuller = getOrCreateCuller(module, lgcName::NggCullingBoxFilter, &NggPrimShader::createBoxFilterCuller);
 
   // Get register PA_CL_VTE_CNTL
-  Value *paClVteCntl = m_builder->getInt32(m_nggControl->primShaderTable.pipelineStateCb.paClVteCntl);
+  Value *paClVteCntl = nullptr;
+  if (m_nggControl->alwaysUsePrimShaderTable)
+    paClVteCntl = fetchCullingControlRegister(module, m_cbLayoutTable.paClVteCntl);
+  else
+    paClVteCntl = m_builder->getInt32(m_nggControl->primShaderTable.pipelineStateCb.paClVteCntl);
 
   // Get register PA_CL_CLIP_CNTL
   Value *paClClipCntl = nullptr;
@@ -3714,12 +3715,14 @@ Value *NggPrimShader::doBoxFilterCulling(Module *module, Value *cullFlag, Value
 Value *NggPrimShader::doSphereCulling(Module *module, Value *cullFlag, Value *vertex0, Value *vertex1, Value *vertex2) {
   assert(m_nggControl->enableSphereCulling);
 
-  auto sphereCuller = module->getFunction(lgcName::NggCullingSphere);
-  if (!sphereCuller)
-    sphereCuller = createSphereCuller(module);
+  auto sphereCuller = getOrCreateCuller(module, lgcName::NggCullingSphere, &NggPrimShader::createSphereCuller);
 
   // Get register PA_CL_VTE_CNTL
-  Value *paClVteCntl = m_builder->getInt32(m_nggControl->primShaderTable.pipelineStateCb.paClVteCntl);
+  Value *paClVteCntl = nullptr;
+  if (m_nggControl->alwaysUsePrimShaderTable)
+    paClVteCntl = fetchCullingControlRegister(module, m_cbLayoutTable.paClVteCntl);
+  else
+    paClVteCntl = m_builder->getInt32(m_nggControl->primShaderTable.pipelineStateCb.paClVteCntl);
 
   // Get register PA_CL_CLIP_CNTL
   Value *paClClipCntl = nullptr;
@@ -3751,12 +3754,15 @@ Value *NggPrimShader::doSmallPrimFilterCulling(Module *module, Value *cullFlag,
                                                Value *vertex2) {
   assert(m_nggControl->enableSmallPrimFilter);
 
-  auto smallPrimFilterCuller = module->getFunction(lgcName::NggCullingSmallPrimFilter);
-  if (!smallPrimFilterCuller)
-    smallPrimFilterCuller = createSmallPrimFilterCuller(module);
+  auto smallPrimFilterCuller =
+      getOrCreateCuller(module, lgcName::NggCullingSmallPrimFilter, &NggPrimShader::createSmallPrimFilterCuller);
 
   // Get register PA_CL_VTE_CNTL
-  Value *paClVteCntl = m_builder->getInt32(m_nggControl->primShaderTable.pipelineStateCb.paClVteCntl);
+  Value *paClVteCntl = nullptr;
+  if (m_nggControl->alwaysUsePrimShaderTable)
+    paClVteCntl = fetchCullingControlRegister(module, m_cbLayoutTable.paClVteCntl);
+  else
+    paClVteCntl = m_builder->getInt32(m_nggControl->primShaderTable.pipelineStateCb.paClVteCntl);
 
   // Get register PA_CL_VPORT_XSCALE
   auto paClVportXscale = fetchCullingControlRegister(module, m_cbLayoutTable.vportControls[0].paClVportXscale);
@@ -3792,9 +3798,8 @@ Value *NggPrimShader::doCullDistanceCulling(Module *module, Value *cullFlag, Val
                                             Value *signMask2) {
   assert(m_nggControl->enableCullDistanceCulling);
 
-  auto cullDistanceCuller = module->getFunction(lgcName::NggCullingCullDistance);
-  if (!cullDistanceCuller)
-    cullDistanceCuller = createCullDistanceCuller(module);
+  auto cullDistanceCuller =
+      getOrCreateCuller(module, lgcName::NggCullingCullDistance, &NggPrimShader::createCullDistanceCuller);
 
   // Do cull distance culling
   return m_builder->CreateCall(cullDistanceCuller, {cullFlag, signMask0, signMask1, signMask2});
@@ -3806,15 +3811,73 @@ Value *NggPrimShader::doCullDistanceCulling(Module *module, Value *cullFlag, Val
 // @param module : LLVM module
 // @param regOffset : Register offset in the primitive shader table (in bytes)
 Value *NggPrimShader::fetchCullingControlRegister(Module *module, unsigned regOffset) {
-  auto fetchCullingRegister = module->getFunction(lgcName::NggCullingFetchReg);
-  if (!fetchCullingRegister)
-    fetchCullingRegister = createFetchCullingRegister(module);
+  auto fetchCullingRegister =
+      getOrCreateCuller(module, lgcName::NggCullingFetchReg, &NggPrimShader::createFetchCullingRegister);
 
   return m_builder->CreateCall(
       fetchCullingRegister,
       {m_nggFactor.primShaderTableAddrLow, m_nggFactor.primShaderTableAddrHigh, m_builder->getInt32(regOffset)});
 }
 
+// =====================================================================================================================
+// Gets the specified culling helper function of the given module, creating it on first use.
+//
+// The culling helper functions do not depend on the pipeline (everything pipeline-specific is passed in as an
+// argument), so each one is emitted once into the library module shared by all compiles with the same LgcContext
+// and copied from there into the module of each NGG pipeline that wants it, instead of being re-emitted from
+// scratch per pipeline.
+//
+// @param module : LLVM module
+// @param cullerName : Name of the culling helper function
+// @param creator : Method that emits the culling helper function into a module
+Function *NggPrimShader::getOrCreateCuller(Module *module, StringRef cullerName,
+                                           Function *(NggPrimShader::*creator)(Module *)) {
+  if (auto culler = module->getFunction(cullerName))
+    return culler;
+
+  Module *libraryModule = m_pipelineState->getLgcContext()->getLibraryModule();
+  Function *libraryFunc = libraryModule->getFunction(cullerName);
+  if (!libraryFunc)
+    libraryFunc = (this->*creator)(libraryModule);
+
+  return copyCullerToModule(libraryFunc, module);
+}
+
+// =====================================================================================================================
+// Copies a culling helper function from the library module into the given module.
+//
+// @param libraryFunc : Definition of the culling helper function in the library module
+// @param module : LLVM module to copy the function into
+Function *NggPrimShader::copyCullerToModule(Function *libraryFunc, Module *module) {
+  auto func =
+      Function::Create(libraryFunc->getFunctionType(), GlobalValue::InternalLinkage, libraryFunc->getName(), module);
+  func->copyAttributesFrom(libraryFunc);
+
+  ValueToValueMapTy valueMap;
+  auto libraryArgIt = libraryFunc->arg_begin();
+  for (auto &arg : func->args()) {
+    arg.setName(libraryArgIt->getName());
+    valueMap[&*libraryArgIt++] = &arg;
+  }
+
+  // Map the (intrinsic) declarations referenced from the library module to matching declarations of this module.
+  for (Function &libraryDecl : *libraryFunc->getParent()) {
+    if (!libraryDecl.isDeclaration())
+      continue;
+    Function *decl = module->getFunction(libraryDecl.getName());
+    if (!decl) {
+      decl =
+          Function::Create(libraryDecl.getFunctionType(), GlobalValue::ExternalLinkage, libraryDecl.getName(), module);
+      decl->copyAttributesFrom(&libraryDecl);
+    }
+    valueMap[&libraryDecl] = decl;
+  }
+
+  SmallVector<ReturnInst *, 8> returns;
+  CloneFunctionInto(func, libraryFunc, valueMap, /*moduleLevelChanges=*/false, returns);
+  return func;
+}
+
 // =====================================================================================================================
 // Creates the function that does backface culling.
 //
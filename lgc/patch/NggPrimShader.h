@@ -178,6 +178,10 @@ private:
 
   llvm::Value *fetchCullingControlRegister(llvm::Module *module, unsigned regOffset);
 
+  llvm::Function *getOrCreateCuller(llvm::Module *module, llvm::StringRef cullerName,
+                                    llvm::Function *(NggPrimShader::*creator)(llvm::Module *));
+  llvm::Function *copyCullerToModule(llvm::Function *libraryFunc, llvm::Module *module);
+
   llvm::Function *createBackfaceCuller(llvm::Module *module);
   llvm::Function *createFrustumCuller(llvm::Module *module);
   llvm::Function *createBoxFilterCuller(llvm::Module *module);
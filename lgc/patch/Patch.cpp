@@ -108,17 +108,27 @@ void Patch::addPasses(PipelineState *pipelineState, legacy::PassManager &passMgr
                                      "// LLPC pipeline before-patching results\n"));
   }
 
+  // Schedule the graphics-only passes from the pipeline's stage mask, so a compute-only compile does not
+  // construct and run passes that would only no-op their way through the module. The mask is zero in the
+  // standalone lgc tool, where the state lives in IR metadata and is only read once the passes run; in that
+  // case schedule everything.
+  const unsigned stageMask = pipelineState->getShaderStageMask();
+  const bool stageMaskKnown = stageMask != 0;
+
   // Build null fragment shader if necessary
-  passMgr.add(createPatchNullFragShader());
+  if (!stageMaskKnown || pipelineState->isGraphics())
+    passMgr.add(createPatchNullFragShader());
 
   // Patch resource collecting, remove inactive resources (should be the first preliminary pass)
   passMgr.add(createPatchResourceCollect());
 
   // Generate copy shader if necessary.
-  passMgr.add(createPatchCopyShader());
+  if (!stageMaskKnown || (stageMask & shaderStageToMask(ShaderStageGeometry)))
+    passMgr.add(createPatchCopyShader());
 
   // Lower vertex fetch operations.
-  passMgr.add(createLowerVertexFetch());
+  if (!stageMaskKnown || (stageMask & shaderStageToMask(ShaderStageVertex)))
+    passMgr.add(createLowerVertexFetch());
 
   // Patch entry-point mutation (should be done before external library link)
   passMgr.add(createPatchEntryPointMutate());
@@ -153,8 +163,12 @@ void Patch::addPasses(PipelineState *pipelineState, legacy::PassManager &passMgr
   // Need to run a first promote mem 2 reg to remove alloca's whose only args are lifetimes
   passMgr.add(createPromoteMemoryToRegisterPass());
 
-  if (!cl::DisablePatchOpt)
-    addOptimizationPasses(passMgr);
+  if (!cl::DisablePatchOpt) {
+    if (pipelineState->getOptions().fastCompile)
+      addFastCompileOptimizationPasses(passMgr);
+    else
+      addOptimizationPasses(passMgr);
+  }
 
   // Stop timer for optimization passes and restart timer for patching passes.
   if (patchTimer) {
@@ -320,6 +334,26 @@ void Patch::addOptimizationPasses(legacy::PassManager &passMgr) {
   }
 }
 
+// =====================================================================================================================
+// Add the minimal optimization passes used for a fast compile to pass manager
+//
+// This is a small subset of the passes added by addOptimizationPasses, covering just the clean-up that the rest of
+// patching relies on plus the cheap optimizations with the biggest impact on code quality. It is used when the client
+// requests the fastest possible compile via the fastCompile pipeline option; the expectation is that the client
+// recompiles the same pipeline at full optimization later and replaces the result.
+//
+// @param [in/out] passMgr : Pass manager to add passes to
+void Patch::addFastCompileOptimizationPasses(legacy::PassManager &passMgr) {
+  passMgr.add(createSROAPass());
+  passMgr.add(createEarlyCSEPass());
+  passMgr.add(createInstructionCombiningPass(2));
+  passMgr.add(createPatchPeepholeOpt());
+  passMgr.add(createInstSimplifyLegacyPass());
+  passMgr.add(createCFGSimplificationPass());
+  passMgr.add(createAggressiveDCEPass());
+  passMgr.add(createGlobalDCEPass());
+}
+
 // =====================================================================================================================
 // Initializes the pass according to the specified module.
 //
@@ -129,6 +129,7 @@ bool PatchBufferOp::runOnFunction(Function &function) {
   }
 
   m_replacementMap.clear();
+  m_baseAddrMap.clear();
   m_invariantSet.clear();
   m_divergenceSet.clear();
 
@@ -158,7 +159,7 @@ void PatchBufferOp::visitAtomicCmpXchgInst(AtomicCmpXchgInst &atomicCmpXchgInst)
 
   // If our buffer descriptor is divergent or is not a 32-bit integer, need to handle it differently.
   if (m_divergenceSet.count(bufferDesc) > 0 || !storeType->isIntegerTy(32)) {
-    Value *const baseAddr = getBaseAddressFromBufferDesc(bufferDesc);
+    Value *const baseAddr = getCachedBaseAddressFromBufferDesc(bufferDesc);
 
     // The 2nd element in the buffer descriptor is the byte bound, we do this to support robust buffer access.
     Value *const bound = m_builder->CreateExtractElement(bufferDesc, 2);
@@ -263,7 +264,7 @@ void PatchBufferOp::visitAtomicRMWInst(AtomicRMWInst &atomicRmwInst) {
 
   // If our buffer descriptor is divergent, need to handle it differently.
   if (m_divergenceSet.count(bufferDesc) > 0) {
-    Value *const baseAddr = getBaseAddressFromBufferDesc(bufferDesc);
+    Value *const baseAddr = getCachedBaseAddressFromBufferDesc(bufferDesc);
 
     // The 2nd element in the buffer descriptor is the byte bound, we do this to support robust buffer access.
     Value *const bound = m_builder->CreateExtractElement(bufferDesc, 2);
@@ -1198,6 +1199,38 @@ Value *PatchBufferOp::getPointerOperandAsInst(Value *const value) {
   return newInst;
 }
 
+// =====================================================================================================================
+// Extract the 64-bit address from a buffer descriptor, reusing a previously extracted one for the same descriptor.
+//
+// The extraction is generated immediately after the descriptor's definition, so it dominates every access through
+// the descriptor; repeated accesses - for example in a loop whose descriptor setup is loop-invariant - then share
+// one extraction instead of recomputing the address at each access. No CSE or LICM runs after this pass, so the
+// recomputations would otherwise survive into the final ISA.
+//
+// @param bufferDesc : The buffer descriptor to extract the address from
+Value *PatchBufferOp::getCachedBaseAddressFromBufferDesc(Value *const bufferDesc) {
+  auto cacheIt = m_baseAddrMap.find(bufferDesc);
+  if (cacheIt != m_baseAddrMap.end())
+    return cacheIt->second;
+
+  auto savedInsertPoint = m_builder->saveIP();
+  if (auto bufferDescInst = dyn_cast<Instruction>(bufferDesc)) {
+    if (auto phiNode = dyn_cast<PHINode>(bufferDescInst))
+      m_builder->SetInsertPoint(phiNode->getParent()->getFirstNonPHI());
+    else
+      m_builder->SetInsertPoint(bufferDescInst->getNextNode());
+  } else {
+    // A constant or argument descriptor; generate the extraction at the start of the function.
+    BasicBlock &entryBlock = m_builder->GetInsertBlock()->getParent()->getEntryBlock();
+    m_builder->SetInsertPoint(&entryBlock, entryBlock.begin());
+  }
+  Value *const baseAddr = getBaseAddressFromBufferDesc(bufferDesc);
+  m_builder->restoreIP(savedInsertPoint);
+
+  m_baseAddrMap[bufferDesc] = baseAddr;
+  return baseAddr;
+}
+
 // =====================================================================================================================
 // Extract the 64-bit address from a buffer descriptor.
 //
@@ -1341,7 +1374,7 @@ Value *PatchBufferOp::replaceLoadStore(Instruction &inst) {
 
   // If our buffer descriptor is divergent, need to handle that differently.
   if (m_divergenceSet.count(bufferDesc) > 0) {
-    Value *const baseAddr = getBaseAddressFromBufferDesc(bufferDesc);
+    Value *const baseAddr = getCachedBaseAddressFromBufferDesc(bufferDesc);
 
     // The 2nd element in the buffer descriptor is the byte bound, we do this to support robust buffer access.
     Value *const bound = m_builder->CreateExtractElement(bufferDesc, 2);
@@ -78,6 +78,7 @@ private:
 
   llvm::Value *getPointerOperandAsInst(llvm::Value *const value);
   llvm::Value *getBaseAddressFromBufferDesc(llvm::Value *const bufferDesc) const;
+  llvm::Value *getCachedBaseAddressFromBufferDesc(llvm::Value *const bufferDesc);
   void copyMetadata(llvm::Value *const dest, const llvm::Value *const src) const;
   llvm::PointerType *getRemappedType(llvm::Type *const type) const;
   bool removeUsersForInvariantStarts(llvm::Value *const value);
@@ -90,6 +91,7 @@ private:
 
   using Replacement = std::pair<llvm::Value *, llvm::Value *>;
   llvm::DenseMap<llvm::Value *, Replacement> m_replacementMap; // The replacement map.
+  llvm::DenseMap<llvm::Value *, llvm::Value *> m_baseAddrMap;  // Base addresses extracted from buffer descriptors.
   llvm::DenseSet<llvm::Value *> m_invariantSet;                // The invariant set.
   llvm::DenseSet<llvm::Value *> m_divergenceSet;               // The divergence set.
   llvm::LegacyDivergenceAnalysis *m_divergenceAnalysis;        // The divergence analysis.
@@ -68,7 +68,8 @@ public:
   void getAnalysisUsage(AnalysisUsage &analysisUsage) const override {
     analysisUsage.addRequired<PipelineStateWrapper>();
     analysisUsage.addRequired<PipelineShaders>();
-    // Pass does not preserve PipelineShaders as it adds a new shader.
+    // The pass registers the copy shader it adds via updateEntryPoint(), so the analysis stays valid.
+    analysisUsage.addPreserved<PipelineShaders>();
   }
 
 private:
@@ -271,8 +272,10 @@ bool PatchCopyShader::runOnModule(Module &module) {
     builder.CreateBr(endBlock);
   }
 
-  // Set the shader stage on the new function.
+  // Set the shader stage on the new function, and register it so the PipelineShaders analysis stays valid
+  // without a rescan.
   setShaderStage(entryPoint, ShaderStageCopyShader);
+  pipelineShaders->updateEntryPoint(ShaderStageCopyShader, entryPoint);
 
   // Tell pipeline state there is a copy shader.
   m_pipelineState->setShaderStageMask(m_pipelineState->getShaderStageMask() | (1U << ShaderStageCopyShader));
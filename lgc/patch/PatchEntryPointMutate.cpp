@@ -50,6 +50,7 @@
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include <algorithm>
 
 #define DEBUG_TYPE "lgc-patch-entry-point-mutate"
 
@@ -79,7 +80,8 @@ public:
   void getAnalysisUsage(AnalysisUsage &analysisUsage) const override {
     analysisUsage.addRequired<PipelineStateWrapper>();
     analysisUsage.addRequired<PipelineShaders>();
-    // Does not preserve PipelineShaders because it replaces the entrypoints.
+    // Does not preserve PipelineShaders; updateEntryPoint() keeps it usable within this pass, but the inlining
+    // and DCE passes scheduled afterwards invalidate it anyway.
   }
 
   virtual bool runOnModule(Module &module) override;
@@ -91,7 +93,8 @@ private:
   struct UserDataArg {
     UserDataArg(Type *argTy, unsigned userDataValue = static_cast<unsigned>(UserDataMapping::Invalid),
                 unsigned *argIndex = nullptr, bool isPadding = false)
-        : argTy(argTy), userDataValue(userDataValue), argIndex(argIndex), isPadding(isPadding), mustSpill(false) {
+        : argTy(argTy), userDataValue(userDataValue), argIndex(argIndex), isPadding(isPadding), mustSpill(false),
+          useCount(0) {
       if (isa<PointerType>(argTy))
         argDwordSize = argTy->getPointerAddressSpace() == ADDR_SPACE_CONST_32BIT ? 1 : 2;
       else
@@ -107,6 +110,7 @@ private:
     unsigned *argIndex;     // Where to store arg index once it is allocated, nullptr for none
     bool isPadding;         // Whether this is a padding arg to maintain fixed layout
     bool mustSpill;         // Whether this is an arg that must be spilled
+    unsigned useCount;      // Number of uses of the node in the shader, for SGPR allocation priority
   };
 
   // User data usage for one user data node
@@ -163,7 +167,8 @@ private:
                           unsigned *argIndex, bool useFixedLayout, unsigned userDataSize, IRBuilder<> &builder);
 
   void determineUnspilledUserDataArgs(ArrayRef<UserDataArg> userDataArgs, ArrayRef<UserDataArg> specialUserDataArgs,
-                                      IRBuilder<> &builder, SmallVectorImpl<UserDataArg> &unspilledArgs);
+                                      unsigned firstAllocatableArg, IRBuilder<> &builder,
+                                      SmallVectorImpl<UserDataArg> &unspilledArgs);
 
   uint64_t pushFixedShaderArgTys(SmallVectorImpl<Type *> &argTys) const;
 
@@ -173,9 +178,10 @@ private:
   // Get the shader stage that the given shader stage is merged into.
   ShaderStage getMergedShaderStage(ShaderStage stage) const;
 
-  bool m_hasTs;                             // Whether the pipeline has tessllation shader
-  bool m_hasGs;                             // Whether the pipeline has geometry shader
-  PipelineState *m_pipelineState = nullptr; // Pipeline state from PipelineStateWrapper pass
+  bool m_hasTs;                                 // Whether the pipeline has tessllation shader
+  bool m_hasGs;                                 // Whether the pipeline has geometry shader
+  PipelineState *m_pipelineState = nullptr;     // Pipeline state from PipelineStateWrapper pass
+  PipelineShaders *m_pipelineShaders = nullptr; // Cached function-to-shader-stage analysis
   // Per-HW-shader-stage gathered user data usage information.
   SmallVector<std::unique_ptr<UserDataUsage>, ShaderStageCount> m_userDataUsage;
 };
@@ -206,6 +212,7 @@ bool PatchEntryPointMutate::runOnModule(Module &module) {
   Patch::init(&module);
 
   m_pipelineState = getAnalysis<PipelineStateWrapper>().getPipelineState(&module);
+  m_pipelineShaders = &getAnalysis<PipelineShaders>();
 
   const unsigned stageMask = m_pipelineState->getShaderStageMask();
   m_hasTs = (stageMask & (shaderStageToMask(ShaderStageTessControl) | shaderStageToMask(ShaderStageTessEval))) != 0;
@@ -219,9 +226,8 @@ bool PatchEntryPointMutate::runOnModule(Module &module) {
   shaderInputs.gatherUsage(module);
 
   // Process each shader in turn, but not the copy shader.
-  auto pipelineShaders = &getAnalysis<PipelineShaders>();
   for (unsigned shaderStage = ShaderStageVertex; shaderStage < ShaderStageNativeStageCount; ++shaderStage) {
-    m_entryPoint = pipelineShaders->getEntryPoint(static_cast<ShaderStage>(shaderStage));
+    m_entryPoint = m_pipelineShaders->getEntryPoint(static_cast<ShaderStage>(shaderStage));
     if (m_entryPoint) {
       m_shaderStage = static_cast<ShaderStage>(shaderStage);
       processShader(&shaderInputs);
@@ -257,7 +263,7 @@ void PatchEntryPointMutate::gatherUserDataUsage(Module *module) {
     if (func.getName().startswith(lgcName::SpillTable)) {
       for (User *user : func.users()) {
         CallInst *call = cast<CallInst>(user);
-        ShaderStage stage = getShaderStage(call->getFunction());
+        ShaderStage stage = m_pipelineShaders->getShaderStage(call->getFunction());
         assert(stage != ShaderStageCopyShader);
         getUserDataUsage(stage)->spillTable.users.push_back(call);
       }
@@ -270,7 +276,7 @@ void PatchEntryPointMutate::gatherUserDataUsage(Module *module) {
         // push into userDataUsage->pushConstOffsets. If we fail, set userDataUsage->pushConstSpill to indicate that
         // we need to keep the pointer to the push const, derived as an offset into the spill table.
         CallInst *call = cast<CallInst>(user);
-        ShaderStage stage = getShaderStage(call->getFunction());
+        ShaderStage stage = m_pipelineShaders->getShaderStage(call->getFunction());
         assert(stage != ShaderStageCopyShader);
         auto userDataUsage = getUserDataUsage(stage);
         userDataUsage->pushConst.users.push_back(call);
@@ -332,7 +338,7 @@ void PatchEntryPointMutate::gatherUserDataUsage(Module *module) {
       for (User *user : func.users()) {
         CallInst *call = cast<CallInst>(user);
         unsigned dwordOffset = cast<ConstantInt>(call->getArgOperand(0))->getZExtValue();
-        ShaderStage stage = getShaderStage(call->getFunction());
+        ShaderStage stage = m_pipelineShaders->getShaderStage(call->getFunction());
         assert(stage != ShaderStageCopyShader);
         auto &rootDescriptors = getUserDataUsage(stage)->rootDescriptors;
         rootDescriptors.resize(std::max(rootDescriptors.size(), size_t(dwordOffset + 1)));
@@ -344,7 +350,7 @@ void PatchEntryPointMutate::gatherUserDataUsage(Module *module) {
     if (func.getName().startswith(lgcName::SpecialUserData)) {
       for (User *user : func.users()) {
         CallInst *call = cast<CallInst>(user);
-        ShaderStage stage = getShaderStage(call->getFunction());
+        ShaderStage stage = m_pipelineShaders->getShaderStage(call->getFunction());
         assert(stage != ShaderStageCopyShader);
         auto &specialUserData = getUserDataUsage(stage)->specialUserData;
         unsigned index = cast<ConstantInt>(call->getArgOperand(0))->getZExtValue() -
@@ -359,7 +365,7 @@ void PatchEntryPointMutate::gatherUserDataUsage(Module *module) {
       for (User *user : func.users()) {
         CallInst *call = cast<CallInst>(user);
         unsigned set = cast<ConstantInt>(call->getArgOperand(0))->getZExtValue();
-        ShaderStage stage = getShaderStage(call->getFunction());
+        ShaderStage stage = m_pipelineShaders->getShaderStage(call->getFunction());
         assert(stage != ShaderStageCopyShader);
         auto &descriptorSets = getUserDataUsage(stage)->descriptorSets;
         descriptorSets.resize(std::max(descriptorSets.size(), size_t(set + 1)));
@@ -392,7 +398,7 @@ void PatchEntryPointMutate::fixupUserDataUses(Module &module) {
     if (func.isDeclaration())
       continue;
 
-    ShaderStage stage = getShaderStage(&func);
+    ShaderStage stage = m_pipelineShaders->getShaderStage(&func);
     auto userDataUsage = getUserDataUsage(stage);
 
     // If needed, generate code for the spill table pointer (as pointer to i8) at the start of the function.
@@ -620,6 +626,9 @@ void PatchEntryPointMutate::processShader(ShaderInputs *shaderInputs) {
   Function *entryPoint =
       addFunctionArgs(origEntryPoint, origEntryPoint->getFunctionType()->getReturnType(), argTys, inRegMask);
 
+  // Keep the cached stage analysis in step with the replacement, so the fix-up phases below can still use it.
+  m_pipelineShaders->updateEntryPoint(m_shaderStage, entryPoint);
+
   // Set Attributes on new function here.
   AttrBuilder builder;
   if (m_shaderStage == ShaderStageFragment) {
@@ -763,11 +772,14 @@ uint64_t PatchEntryPointMutate::generateEntryPointArgTys(ShaderInputs *shaderInp
 
   addSpecialUserDataArgs(userDataArgs, specialUserDataArgs, builder);
 
+  // Args before this index are internal tables with ABI-fixed positions; only the root-layout nodes added
+  // below compete for the remaining SGPRs by access frequency.
+  const unsigned firstAllocatableArg = userDataArgs.size();
   addUserDataArgs(userDataArgs, builder);
 
   // Determine which user data args are going to be "unspilled", and put them in unspilledArgs.
   SmallVector<UserDataArg, 8> unspilledArgs;
-  determineUnspilledUserDataArgs(userDataArgs, specialUserDataArgs, builder, unspilledArgs);
+  determineUnspilledUserDataArgs(userDataArgs, specialUserDataArgs, firstAllocatableArg, builder, unspilledArgs);
 
   // Scan unspilledArgs: for each one:
   // * add it to the arg type array
@@ -969,6 +981,7 @@ void PatchEntryPointMutate::addUserDataArgs(SmallVectorImpl<UserDataArg> &userDa
                                  static_cast<unsigned>(UserDataMapping::DescriptorSet0));
         unsigned userDataValue = static_cast<unsigned>(UserDataMapping::DescriptorSet0) + descSetIdx;
         userDataArgs.push_back(UserDataArg(builder.getInt32Ty(), userDataValue, &descriptorSet.entryArgIdx));
+        userDataArgs.back().useCount = descriptorSet.users.size();
       }
     }
 
@@ -1004,6 +1017,7 @@ void PatchEntryPointMutate::addUserDataArgs(SmallVectorImpl<UserDataArg> &userDa
       addUserDataArg(userDataArgs, static_cast<unsigned>(UserDataMapping::PushConst0) + dwordOffset,
                      pushConstOffset.dwordSize, &pushConstOffset.entryArgIdx, /*useFixedLayout=*/0, /*userDataSize=*/0,
                      builder);
+      userDataArgs.back().useCount = pushConstOffset.users.size();
     }
 
     return;
@@ -1048,6 +1062,7 @@ void PatchEntryPointMutate::addUserDataArgs(SmallVectorImpl<UserDataArg> &userDa
       // Add the arg (descriptor set pointer) that we can potentially unspill.
       userDataSize = addUserDataArg(userDataArgs, userDataValue, node.sizeInDwords, &descSetUsage.entryArgIdx,
                                     useFixedLayout, userDataSize, builder);
+      userDataArgs.back().useCount = descSetUsage.users.size();
       break;
     }
 
@@ -1094,6 +1109,7 @@ void PatchEntryPointMutate::addUserDataArgs(SmallVectorImpl<UserDataArg> &userDa
         // Add the arg (part of the push const) that we can potentially unspill.
         userDataSize = addUserDataArg(userDataArgs, node.offsetInDwords + dwordOffset, pushConstOffset.dwordSize,
                                       &pushConstOffset.entryArgIdx, useFixedLayout, userDataSize, builder);
+        userDataArgs.back().useCount = pushConstOffset.users.size();
       }
 
       // Ensure we mark the push constant's part of the spill table as used.
@@ -1131,6 +1147,7 @@ void PatchEntryPointMutate::addUserDataArgs(SmallVectorImpl<UserDataArg> &userDa
         // Add the arg (root descriptor) that we can potentially unspill.
         userDataSize = addUserDataArg(userDataArgs, dwordOffset, dwordSize, &rootDescUsage.entryArgIdx, useFixedLayout,
                                       userDataSize, builder);
+        userDataArgs.back().useCount = rootDescUsage.users.size();
       }
       break;
     }
@@ -1174,13 +1191,15 @@ unsigned PatchEntryPointMutate::addUserDataArg(SmallVectorImpl<UserDataArg> &use
 //
 // @param userDataArgs : First array of UserDataArg structs for candidate args
 // @param specialUserDataArgs : Second array of UserDataArg structs for candidate args
+// @param firstAllocatableArg : Index of first entry in userDataArgs that may compete for SGPRs by access
+//                              frequency; earlier entries are internal tables with ABI-fixed positions
 // @param builder : IRBuilder to get types from
 // @param [out] unspilledArgs : Output vector of UserDataArg structs that will be "unspilled". Mostly these are
 //                              copied from the input arrays, plus an extra one for the spill table pointer if
 //                              needed. For compute shader fixed layout there may be extra nodes for padding.
 void PatchEntryPointMutate::determineUnspilledUserDataArgs(ArrayRef<UserDataArg> userDataArgs,
                                                            ArrayRef<UserDataArg> specialUserDataArgs,
-                                                           IRBuilder<> &builder,
+                                                           unsigned firstAllocatableArg, IRBuilder<> &builder,
                                                            SmallVectorImpl<UserDataArg> &unspilledArgs) {
 
   SmallVector<UserDataArg, 1> spillTableArg;
@@ -1242,7 +1261,24 @@ void PatchEntryPointMutate::determineUnspilledUserDataArgs(ArrayRef<UserDataArg>
   bool useFixedLayout = m_shaderStage == ShaderStageCompute;
   unsigned userDataIdx = 0;
 
-  for (const UserDataArg &userDataArg : userDataArgs) {
+  // Consider the allocatable candidates in descending order of per-shader access frequency, so that when
+  // there are not enough SGPRs the hottest descriptor tables, push constants and root descriptors win them
+  // and the cold ones spill. The SGPR-to-node mapping is recorded per node in PAL metadata, so the allocation
+  // need not follow declaration order; the selected args are still emitted in declaration order below.
+  // CS fixed layout places nodes at hardware-fixed offsets, so it keeps declaration order.
+  SmallVector<unsigned, 8> candidateOrder;
+  for (unsigned i = 0; i != userDataArgs.size(); ++i)
+    candidateOrder.push_back(i);
+  if (!useFixedLayout) {
+    std::stable_sort(candidateOrder.begin() + firstAllocatableArg, candidateOrder.end(),
+                     [&userDataArgs](unsigned lhs, unsigned rhs) {
+                       return userDataArgs[lhs].useCount > userDataArgs[rhs].useCount;
+                     });
+  }
+
+  SmallVector<unsigned, 8> selectedArgs;
+  for (unsigned candidateIdx : candidateOrder) {
+    const UserDataArg &userDataArg = userDataArgs[candidateIdx];
     unsigned afterUserDataIdx = userDataIdx + userDataArg.argDwordSize;
     if (userDataArg.mustSpill || afterUserDataIdx > userDataEnd) {
       // Spill this node. Allocate the spill table arg.
@@ -1256,14 +1292,15 @@ void PatchEntryPointMutate::determineUnspilledUserDataArgs(ArrayRef<UserDataArg>
 
         if (userDataIdx > userDataEnd) {
           // We over-ran the available SGPRs by filling them up and then realizing we needed a spill table pointer.
-          // Remove the last unspilled node (and any padding arg before that), and ensure that spill usage is
+          // Remove the last selected node (and any padding arg before that), and ensure that spill usage is
           // set correctly so that PAL metadata spill threshold is correct.
-          userDataIdx -= unspilledArgs.back().argDwordSize;
-          userDataUsage->spillUsage = std::min(userDataUsage->spillUsage, unspilledArgs.back().userDataValue);
-          unspilledArgs.pop_back();
-          if (!unspilledArgs.empty() && unspilledArgs.back().isPadding) {
-            userDataIdx -= unspilledArgs.back().argDwordSize;
-            unspilledArgs.pop_back();
+          userDataIdx -= userDataArgs[selectedArgs.back()].argDwordSize;
+          userDataUsage->spillUsage =
+              std::min(userDataUsage->spillUsage, userDataArgs[selectedArgs.back()].userDataValue);
+          selectedArgs.pop_back();
+          if (!selectedArgs.empty() && userDataArgs[selectedArgs.back()].isPadding) {
+            userDataIdx -= userDataArgs[selectedArgs.back()].argDwordSize;
+            selectedArgs.pop_back();
           }
         }
       }
@@ -1280,11 +1317,17 @@ void PatchEntryPointMutate::determineUnspilledUserDataArgs(ArrayRef<UserDataArg>
 
       continue;
     }
-    // Keep this node on the unspilled list.
+    // Keep this node on the selected list.
     userDataIdx = afterUserDataIdx;
-    unspilledArgs.push_back(userDataArg);
+    selectedArgs.push_back(candidateIdx);
   }
 
+  // Copy the selected args across to unspilledArgs in declaration order.
+  if (!useFixedLayout)
+    std::sort(selectedArgs.begin(), selectedArgs.end());
+  for (unsigned selectedIdx : selectedArgs)
+    unspilledArgs.push_back(userDataArgs[selectedIdx]);
+
   // Remove trailing padding nodes (compute shader).
   while (!unspilledArgs.empty() && unspilledArgs.back().isPadding) {
     userDataIdx -= unspilledArgs.back().argDwordSize;
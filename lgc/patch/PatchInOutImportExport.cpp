@@ -33,13 +33,16 @@
 #include "lgc/BuiltIns.h"
 #include "lgc/LgcContext.h"
 #include "lgc/patch/FragColorExport.h"
+#include "lgc/patch/VertexFetch.h"
 #include "lgc/state/AbiUnlinked.h"
+#include "lgc/state/PalMetadata.h"
 #include "lgc/state/PipelineShaders.h"
 #include "lgc/util/Debug.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/IntrinsicsAMDGPU.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
+#include <map>
 #include <unordered_set>
 
 #define DEBUG_TYPE "lgc-patch-in-out-import-export"
@@ -84,6 +87,10 @@ void PatchInOutImportExport::initPerShader() {
   m_viewportIndex = nullptr;
   m_layer = nullptr;
   m_threadId = nullptr;
+  m_tfBufferPatchByteOffset = nullptr;
+  m_tcsOutPatchBaseOffset = nullptr;
+  m_tcsPatchConstBaseOffset = nullptr;
+  m_deferredColorExports.clear();
 }
 
 // =====================================================================================================================
@@ -95,9 +102,12 @@ bool PatchInOutImportExport::runOnModule(Module &module) {
 
   Patch::init(&module);
 
+  // Interned call kinds refer to the previous module's declarations if the pass object is being reused.
+  m_inOutCallKinds.clear();
+
   m_pipelineState = getAnalysis<PipelineStateWrapper>().getPipelineState(&module);
   m_gfxIp = m_pipelineState->getTargetInfo().getGfxIpVersion();
-  m_pipelineSysValues.initialize(m_pipelineState);
+  m_pipelineSysValues = &getAnalysis<PipelineSystemValuesWrapper>();
 
   const unsigned stageMask = m_pipelineState->getShaderStageMask();
   m_hasTs = (stageMask & (shaderStageToMask(ShaderStageTessControl) | shaderStageToMask(ShaderStageTessEval))) != 0;
@@ -122,6 +132,20 @@ bool PatchInOutImportExport::runOnModule(Module &module) {
       // Now process the call and return instructions.
       visit(*m_entryPoint);
 
+      // For the last vertex-processing stage, pack the partial generic ("param") exports emitted above into
+      // full ones. This is done as a planned step over the whole function rather than during lowering, because
+      // component-qualified outputs arrive as independent output.export calls.
+      const auto nextStage = m_pipelineState->getNextShaderStage(m_shaderStage);
+      if ((m_shaderStage == ShaderStageVertex || m_shaderStage == ShaderStageTessEval ||
+           m_shaderStage == ShaderStageCopyShader) &&
+          (nextStage == ShaderStageInvalid || nextStage == ShaderStageFragment))
+        coalesceGenericExports(m_entryPoint);
+
+      // If this is a fragment shader whose color exports were deferred to a link-time color export shader,
+      // rewrite it to return the output values in VGPRs.
+      if (m_shaderStage == ShaderStageFragment && !m_deferredColorExports.empty())
+        finalizeDeferredColorExports();
+
       delete m_fragColorExport;
       m_fragColorExport = nullptr;
     }
@@ -141,7 +165,6 @@ bool PatchInOutImportExport::runOnModule(Module &module) {
 
   for (auto &fragColors : m_expFragColors)
     fragColors.clear();
-  m_pipelineSysValues.clear();
 
   return true;
 }
@@ -301,6 +324,42 @@ void PatchInOutImportExport::processShader() {
   }
 }
 
+// =====================================================================================================================
+// Gets the input/output helper call kind of the given callee, interning it on first sight. All calls to one
+// declaration share a kind, so the name prefix matching here runs once per declaration per module.
+//
+// @param callee : Callee to classify
+InOutCallKind PatchInOutImportExport::getInOutCallKind(const Function *callee) {
+  auto kindIt = m_inOutCallKinds.find(callee);
+  if (kindIt != m_inOutCallKinds.end())
+    return kindIt->second;
+
+  auto mangledName = callee->getName();
+
+  InOutCallKind kind = InOutCallKind::NotInOut;
+  if (mangledName.startswith(lgcName::InputImportGeneric))
+    kind = InOutCallKind::GenericInputImport;
+  else if (mangledName.startswith(lgcName::InputImportBuiltIn))
+    kind = InOutCallKind::BuiltInInputImport;
+  else if (mangledName.startswith(lgcName::InputImportInterpolant))
+    kind = InOutCallKind::InterpolantInputImport;
+  else if (mangledName.startswith(lgcName::OutputImportGeneric))
+    kind = InOutCallKind::GenericOutputImport;
+  else if (mangledName.startswith(lgcName::OutputImportBuiltIn))
+    kind = InOutCallKind::BuiltInOutputImport;
+  else if (mangledName.startswith(lgcName::OutputExportGeneric))
+    kind = InOutCallKind::GenericOutputExport;
+  else if (mangledName.startswith(lgcName::OutputExportBuiltIn))
+    kind = InOutCallKind::BuiltInOutputExport;
+  else if (mangledName.startswith(lgcName::OutputExportXfb))
+    kind = InOutCallKind::XfbOutputExport;
+  else if (callee->isIntrinsic() && callee->getIntrinsicID() == Intrinsic::amdgcn_s_sendmsg)
+    kind = InOutCallKind::GsSendMsg;
+
+  m_inOutCallKinds[callee] = kind;
+  return kind;
+}
+
 // =====================================================================================================================
 // Visits "call" instruction.
 //
@@ -313,30 +372,24 @@ void PatchInOutImportExport::visitCallInst(CallInst &callInst) {
   IRBuilder<> builder(*m_context);
   auto resUsage = m_pipelineState->getShaderResourceUsage(m_shaderStage);
 
-  auto mangledName = callee->getName();
-
-  auto importGenericInput = lgcName::InputImportGeneric;
-  auto importBuiltInInput = lgcName::InputImportBuiltIn;
-  auto importInterpolantInput = lgcName::InputImportInterpolant;
-  auto importGenericOutput = lgcName::OutputImportGeneric;
-  auto importBuiltInOutput = lgcName::OutputImportBuiltIn;
+  // Dispatch on the interned call kind of the callee; the name prefix matching behind it runs only the first
+  // time a declaration is seen, not once per call.
+  const InOutCallKind callKind = getInOutCallKind(callee);
+  if (callKind == InOutCallKind::NotInOut)
+    return;
 
-  const bool isGenericInputImport = mangledName.startswith(importGenericInput);
-  const bool isBuiltInInputImport = mangledName.startswith(importBuiltInInput);
-  const bool isInterpolantInputImport = mangledName.startswith(importInterpolantInput);
-  const bool isGenericOutputImport = mangledName.startswith(importGenericOutput);
-  const bool isBuiltInOutputImport = mangledName.startswith(importBuiltInOutput);
+  const bool isGenericInputImport = callKind == InOutCallKind::GenericInputImport;
+  const bool isBuiltInInputImport = callKind == InOutCallKind::BuiltInInputImport;
+  const bool isInterpolantInputImport = callKind == InOutCallKind::InterpolantInputImport;
+  const bool isGenericOutputImport = callKind == InOutCallKind::GenericOutputImport;
+  const bool isBuiltInOutputImport = callKind == InOutCallKind::BuiltInOutputImport;
 
   const bool isImport = (isGenericInputImport || isBuiltInInputImport || isInterpolantInputImport ||
                          isGenericOutputImport || isBuiltInOutputImport);
 
-  auto exportGenericOutput = lgcName::OutputExportGeneric;
-  auto exportBuiltInOutput = lgcName::OutputExportBuiltIn;
-  auto exportXfbOutput = lgcName::OutputExportXfb;
-
-  const bool isGenericOutputExport = mangledName.startswith(exportGenericOutput);
-  const bool isBuiltInOutputExport = mangledName.startswith(exportBuiltInOutput);
-  const bool isXfbOutputExport = mangledName.startswith(exportXfbOutput);
+  const bool isGenericOutputExport = callKind == InOutCallKind::GenericOutputExport;
+  const bool isBuiltInOutputExport = callKind == InOutCallKind::BuiltInOutputExport;
+  const bool isXfbOutputExport = callKind == InOutCallKind::XfbOutputExport;
 
   const bool isExport = (isGenericOutputExport || isBuiltInOutputExport || isXfbOutputExport);
 
@@ -824,7 +877,7 @@ void PatchInOutImportExport::visitCallInst(CallInst &callInst) {
 
       if (emitStream != InvalidValue) {
         // Increment emit vertex counter
-        auto emitCounterPtr = m_pipelineSysValues.get(m_entryPoint)->getEmitCounterPtr()[emitStream];
+        auto emitCounterPtr = m_pipelineSysValues->get(m_entryPoint)->getEmitCounterPtr()[emitStream];
         auto emitCounterTy = emitCounterPtr->getType()->getPointerElementType();
         Value *emitCounter = new LoadInst(emitCounterTy, emitCounterPtr, "", &callInst);
         emitCounter =
@@ -1323,6 +1376,11 @@ void PatchInOutImportExport::visitReturnInst(ReturnInst &retInst) {
       m_lastExport = emitCall("llvm.amdgcn.exp.f32", Type::getVoidTy(*m_context), args, {}, insertPos);
     }
 
+    // If this is an unlinked compile with no color export formats provided, the export conversion is deferred
+    // to a color export shader that the linker generates once the formats are known. Leave the output values
+    // to be returned in VGPRs instead of exporting them here.
+    const bool deferExports = m_pipelineState->isUnlinked() && !m_pipelineState->hasColorExportFormats();
+
     // Export fragment colors
     for (unsigned location = 0; location < MaxColorTargets; ++location) {
       auto &expFragColor = m_expFragColors[location];
@@ -1354,6 +1412,11 @@ void PatchInOutImportExport::visitReturnInst(ReturnInst &retInst) {
           }
         }
 
+        if (deferExports) {
+          m_deferredColorExports.push_back({location, output});
+          continue;
+        }
+
         // Do fragment color exporting
         auto exportInst = m_fragColorExport->run(output, location, insertPos);
         if (exportInst)
@@ -1367,7 +1430,11 @@ void PatchInOutImportExport::visitReturnInst(ReturnInst &retInst) {
     // NOTE: GFX10 can allow no dummy export when the fragment shader does not have discard operation
     // or ROV (Raster-ordered views)
     resUsage->inOutUsage.fs.dummyExport = (m_gfxIp.major < 10 || resUsage->builtInUsage.fs.discard);
-    if (!m_lastExport && resUsage->inOutUsage.fs.dummyExport) {
+    if (!m_deferredColorExports.empty()) {
+      // The color export shader glued on by the linker does the final export, so this shader must neither
+      // export a dummy value nor set the "done" flag.
+      resUsage->inOutUsage.fs.dummyExport = false;
+    } else if (!m_lastExport && resUsage->inOutUsage.fs.dummyExport) {
       Value *args[] = {
           ConstantInt::get(Type::getInt32Ty(*m_context), EXP_TARGET_MRT_0), // tgt
           ConstantInt::get(Type::getInt32Ty(*m_context), 0x1),              // en
@@ -1382,7 +1449,7 @@ void PatchInOutImportExport::visitReturnInst(ReturnInst &retInst) {
     }
   }
 
-  if (m_lastExport) {
+  if (m_lastExport && m_deferredColorExports.empty()) {
     // Set "done" flag
     auto exportName = m_lastExport->getCalledFunction()->getName();
     if (exportName == "llvm.amdgcn.exp.f32")
@@ -1394,6 +1461,66 @@ void PatchInOutImportExport::visitReturnInst(ReturnInst &retInst) {
   }
 }
 
+// =====================================================================================================================
+// Rewrites the fragment shader entry-point so the color outputs whose export conversion was deferred are returned
+// in VGPRs, and records their information in PAL metadata. The linker reads the information back and generates a
+// color export shader that is glued on as an epilog once the color target formats are known.
+void PatchInOutImportExport::finalizeDeferredColorExports() {
+  // Record the deferred exports in PAL metadata for the linker.
+  auto resUsage = m_pipelineState->getShaderResourceUsage(ShaderStageFragment);
+  SmallVector<ColorExportInfo, 8> exportInfo;
+  for (const auto &deferredExport : m_deferredColorExports) {
+    const unsigned origLoc = resUsage->inOutUsage.fs.outputOrigLocs[deferredExport.first];
+    const BasicType outputType = resUsage->inOutUsage.fs.outputTypes[origLoc];
+    const bool isSigned =
+        (outputType == BasicType::Int8 || outputType == BasicType::Int16 || outputType == BasicType::Int);
+    exportInfo.push_back({deferredExport.first, origLoc, isSigned, deferredExport.second->getType()});
+  }
+  m_pipelineState->getPalMetadata()->addColorExportInfo(exportInfo);
+
+  // Convert each deferred output to the all-float type that maps it on to VGPRs, in the same way that the
+  // fetch shader passes fetched values on to a fetchless vertex shader.
+  ReturnInst *retInst = nullptr;
+  for (BasicBlock &block : *m_entryPoint) {
+    if (auto ret = dyn_cast<ReturnInst>(block.getTerminator())) {
+      assert(!retInst && "Expected a single return in the fragment shader");
+      retInst = ret;
+    }
+  }
+  assert(retInst);
+  IRBuilder<> builder(retInst);
+
+  SmallVector<Type *, 8> retTys;
+  SmallVector<Value *, 8> retVals;
+  for (const auto &deferredExport : m_deferredColorExports) {
+    Value *output = deferredExport.second;
+    Type *vgprTy = VertexFetch::getVgprTy(output->getType());
+    if (vgprTy != output->getType()) {
+      const unsigned bitWidth = output->getType()->getPrimitiveSizeInBits();
+      output = builder.CreateBitCast(output, builder.getIntNTy(bitWidth));
+      if (bitWidth != vgprTy->getPrimitiveSizeInBits())
+        output = builder.CreateZExt(output, builder.getIntNTy(vgprTy->getPrimitiveSizeInBits()));
+      output = builder.CreateBitCast(output, vgprTy);
+    }
+    retTys.push_back(vgprTy);
+    retVals.push_back(output);
+  }
+
+  // Create a new entry-point that returns the output values, and move the code across to it.
+  Type *retTy = StructType::get(*m_context, retTys);
+  Function *oldEntryPoint = m_entryPoint;
+  m_entryPoint = addFunctionArgs(oldEntryPoint, retTy, {});
+
+  // Replace the "ret void" with a return of the output values.
+  Value *retVal = UndefValue::get(retTy);
+  for (unsigned idx = 0; idx != retVals.size(); ++idx)
+    retVal = builder.CreateInsertValue(retVal, retVals[idx], idx);
+  builder.CreateRet(retVal);
+  retInst->eraseFromParent();
+
+  oldEntryPoint->eraseFromParent();
+}
+
 // =====================================================================================================================
 // Patches import calls for generic inputs of tessellation control shader.
 //
@@ -1973,11 +2100,11 @@ Value *PatchInOutImportExport::patchTcsBuiltInInputImport(Type *inputTy, unsigne
     break;
   }
   case BuiltInPrimitiveId: {
-    input = m_pipelineSysValues.get(m_entryPoint)->getPrimitiveId();
+    input = m_pipelineSysValues->get(m_entryPoint)->getPrimitiveId();
     break;
   }
   case BuiltInInvocationId: {
-    input = m_pipelineSysValues.get(m_entryPoint)->getInvocationId();
+    input = m_pipelineSysValues->get(m_entryPoint)->getInvocationId();
     break;
   }
   case BuiltInSubgroupSize: {
@@ -2078,7 +2205,7 @@ Value *PatchInOutImportExport::patchTesBuiltInInputImport(Type *inputTy, unsigne
     break;
   }
   case BuiltInTessCoord: {
-    auto tessCoord = m_pipelineSysValues.get(m_entryPoint)->getTessCoord();
+    auto tessCoord = m_pipelineSysValues->get(m_entryPoint)->getTessCoord();
 
     if (elemIdx)
       input = ExtractElementInst::Create(tessCoord, elemIdx, "", insertPos);
@@ -2504,7 +2631,7 @@ Value *PatchInOutImportExport::getSamplePosOffset(Type *inputTy, Value *sampleId
   Value *sampleValid = builder.CreateICmpUGT(numSamples, sampleId);
   Value *offset = builder.CreateSelect(sampleValid, validOffset, builder.getInt32(0));
   // Load sample position descriptor.
-  Value *desc = m_pipelineSysValues.get(m_entryPoint)->loadDescFromDriverTable(SiDrvTableSamplepos, builder);
+  Value *desc = m_pipelineSysValues->get(m_entryPoint)->loadDescFromDriverTable(SiDrvTableSamplepos, builder);
   // Load the value using the descriptor.
   offset = builder.CreateShl(offset, builder.getInt32(4));
   return builder.CreateIntrinsic(Intrinsic::amdgcn_raw_buffer_load, inputTy,
@@ -2542,7 +2669,7 @@ Value *PatchInOutImportExport::patchCsBuiltInInputImport(Type *inputTy, unsigned
     break;
   }
   case BuiltInNumWorkgroups: {
-    input = m_pipelineSysValues.get(m_entryPoint)->getNumWorkgroups();
+    input = m_pipelineSysValues->get(m_entryPoint)->getNumWorkgroups();
     break;
   }
   case BuiltInWorkgroupId: {
@@ -3428,7 +3555,7 @@ void PatchInOutImportExport::patchXfbOutputExport(Value *output, unsigned xfbBuf
   assert(m_shaderStage == ShaderStageVertex || m_shaderStage == ShaderStageTessEval ||
          m_shaderStage == ShaderStageCopyShader);
 
-  Value *streamOutBufDesc = m_pipelineSysValues.get(m_entryPoint)->getStreamOutBufDesc(xfbBuffer);
+  Value *streamOutBufDesc = m_pipelineSysValues->get(m_entryPoint)->getStreamOutBufDesc(xfbBuffer);
 
   const auto &xfbStrides = m_pipelineState->getShaderResourceUsage(m_shaderStage)->inOutUsage.xfbStrides;
   unsigned xfbStride = xfbStrides[xfbBuffer];
@@ -3957,7 +4084,7 @@ void PatchInOutImportExport::storeValueToEsGsRing(Value *storeValue, unsigned lo
       Value *storePtr = GetElementPtrInst::Create(nullptr, m_lds, idxs, "", insertPos);
       new StoreInst(storeValue, storePtr, false, m_lds->getAlign().getValue(), insertPos);
     } else {
-      Value *esGsRingBufDesc = m_pipelineSysValues.get(m_entryPoint)->getEsGsRingBufDesc();
+      Value *esGsRingBufDesc = m_pipelineSysValues->get(m_entryPoint)->getEsGsRingBufDesc();
 
       // NOTE: Here we use tbuffer_store instruction instead of buffer_store because we have to do explicit control
       // of soffset. This is required by swizzle enabled mode when address range checking should be complied with.
@@ -4035,7 +4162,7 @@ Value *PatchInOutImportExport::loadValueFromEsGsRing(Type *loadTy, unsigned loca
       if (loadTy->isFloatingPointTy())
         loadValue = new BitCastInst(loadValue, loadTy, "", insertPos);
     } else {
-      Value *esGsRingBufDesc = m_pipelineSysValues.get(m_entryPoint)->getEsGsRingBufDesc();
+      Value *esGsRingBufDesc = m_pipelineSysValues->get(m_entryPoint)->getEsGsRingBufDesc();
       CoherentFlag coherent = {};
       coherent.bits.glc = true;
       coherent.bits.slc = true;
@@ -4136,7 +4263,7 @@ void PatchInOutImportExport::storeValueToGsVsRing(Value *storeValue, unsigned lo
     const auto &entryArgIdxs = m_pipelineState->getShaderInterfaceData(m_shaderStage)->entryArgIdxs;
     Value *gsVsOffset = getFunctionArgument(m_entryPoint, entryArgIdxs.gs.gsVsOffset);
 
-    auto emitCounterPtr = m_pipelineSysValues.get(m_entryPoint)->getEmitCounterPtr()[streamId];
+    auto emitCounterPtr = m_pipelineSysValues->get(m_entryPoint)->getEmitCounterPtr()[streamId];
     auto emitCounterTy = emitCounterPtr->getType()->getPointerElementType();
     auto emitCounter = new LoadInst(emitCounterTy, emitCounterPtr, "", insertPos);
 
@@ -4160,7 +4287,7 @@ void PatchInOutImportExport::storeValueToGsVsRing(Value *storeValue, unsigned lo
         coherent.bits.swz = true;
         Value *args[] = {
             storeValue,                                                          // vdata
-            m_pipelineSysValues.get(m_entryPoint)->getGsVsRingBufDesc(streamId), // rsrc
+            m_pipelineSysValues->get(m_entryPoint)->getGsVsRingBufDesc(streamId), // rsrc
             ringOffset,                                                          // voffset
             gsVsOffset,                                                          // soffset
             ConstantInt::get(Type::getInt32Ty(*m_context), combineFormat.u32All),
@@ -4174,7 +4301,7 @@ void PatchInOutImportExport::storeValueToGsVsRing(Value *storeValue, unsigned lo
         coherent.bits.swz = true;
         Value *args[] = {
             storeValue,                                                          // vdata
-            m_pipelineSysValues.get(m_entryPoint)->getGsVsRingBufDesc(streamId), // rsrc
+            m_pipelineSysValues->get(m_entryPoint)->getGsVsRingBufDesc(streamId), // rsrc
             ringOffset,                                                          // voffset
             gsVsOffset,                                                          // soffset
             ConstantInt::get(Type::getInt32Ty(*m_context), BUF_FORMAT_32_UINT),  // format
@@ -4231,7 +4358,7 @@ Value *PatchInOutImportExport::calcEsGsRingOffsetForOutput(unsigned location, un
 Value *PatchInOutImportExport::calcEsGsRingOffsetForInput(unsigned location, unsigned compIdx, Value *vertexIdx,
                                                           Instruction *insertPos) {
   Value *ringOffset = nullptr;
-  auto esGsOffsets = m_pipelineSysValues.get(m_entryPoint)->getEsGsOffsets();
+  auto esGsOffsets = m_pipelineSysValues->get(m_entryPoint)->getEsGsOffsets();
 
   if (m_pipelineState->isGsOnChip() || m_gfxIp.major >= 9) // ES -> GS ring is always on-chip on GFX9
   {
@@ -4352,7 +4479,7 @@ Value *PatchInOutImportExport::readValueFromLds(bool isOutput, Type *readTy, Val
             ? m_pipelineState->getShaderInterfaceData(m_shaderStage)->entryArgIdxs.tes.offChipLdsBase
             : m_pipelineState->getShaderInterfaceData(m_shaderStage)->entryArgIdxs.tcs.offChipLdsBase;
 
-    auto offChipLdsDesc = m_pipelineSysValues.get(m_entryPoint)->getOffChipLdsDesc();
+    auto offChipLdsDesc = m_pipelineSysValues->get(m_entryPoint)->getOffChipLdsDesc();
 
     auto offChipLdsBase = getFunctionArgument(m_entryPoint, offChipLdsBaseArgIdx);
 
@@ -4466,7 +4593,7 @@ void PatchInOutImportExport::writeValueToLds(Value *writeValue, Value *ldsOffset
     // Convert dword off-chip LDS offset to byte offset
     ldsOffset = BinaryOperator::CreateMul(ldsOffset, ConstantInt::get(Type::getInt32Ty(*m_context), 4), "", insertPos);
 
-    auto offChipLdsDesc = m_pipelineSysValues.get(m_entryPoint)->getOffChipLdsDesc();
+    auto offChipLdsDesc = m_pipelineSysValues->get(m_entryPoint)->getOffChipLdsDesc();
 
     CoherentFlag coherent = {};
     coherent.bits.glc = true;
@@ -4614,12 +4741,9 @@ void PatchInOutImportExport::storeTessFactorToBuffer(const std::vector<Value *>
       return;
     }
 
-    auto relativeId = m_pipelineSysValues.get(m_entryPoint)->getRelativeId();
-    Value *tfBufferOffset = BinaryOperator::CreateMul(relativeId, tessFactorStride, "", insertPos);
-    tfBufferOffset =
-        BinaryOperator::CreateMul(tfBufferOffset, ConstantInt::get(Type::getInt32Ty(*m_context), 4), "", insertPos);
+    Value *tfBufferOffset = getTfBufferPatchByteOffset();
 
-    auto tfBufDesc = m_pipelineSysValues.get(m_entryPoint)->getTessFactorBufDesc();
+    auto tfBufDesc = m_pipelineSysValues->get(m_entryPoint)->getTessFactorBufDesc();
     std::vector<Value *> tfValues(tessFactors.size());
     for (unsigned i = 0; i < tessFactors.size(); i++)
       tfValues[i] = new BitCastInst(tessFactors[i], Type::getInt32Ty(*m_context), "", insertPos);
@@ -4652,9 +4776,9 @@ void PatchInOutImportExport::storeTessFactorToBuffer(const std::vector<Value *>
     }
 
     Value *args[] = {
-        m_pipelineSysValues.get(m_entryPoint)->getTessFactorBufDesc(), // tfBufferDesc
+        m_pipelineSysValues->get(m_entryPoint)->getTessFactorBufDesc(), // tfBufferDesc
         tfBufferBase,                                                  // tfBufferBase
-        m_pipelineSysValues.get(m_entryPoint)->getRelativeId(),        // relPatchId
+        m_pipelineSysValues->get(m_entryPoint)->getRelativeId(),        // relPatchId
         tessFactorStride,                                              // tfStride
         tessFactorOffsetVal,                                           // tfOffset
         tessFactors[0]                                                 // tfValue
@@ -4663,6 +4787,28 @@ void PatchInOutImportExport::storeTessFactorToBuffer(const std::vector<Value *>
   }
 }
 
+// =====================================================================================================================
+// Gets the byte offset of the current patch in the tessellation factor (TF) buffer (TCS).
+//
+// NOTE: The offset depends only on the relative patch ID, so it is emitted right after that value near the start of
+// the entry-point and shared by all TF buffer stores of the shader, rather than re-emitting the multiply chain per
+// store.
+Value *PatchInOutImportExport::getTfBufferPatchByteOffset() {
+  assert(m_shaderStage == ShaderStageTessControl);
+
+  if (!m_tfBufferPatchByteOffset) {
+    const auto &calcFactor = m_pipelineState->getShaderResourceUsage(ShaderStageTessControl)->inOutUsage.tcs.calcFactor;
+
+    // tfBufferPatchByteOffset = relativeId * tessFactorStride * 4
+    auto relativeId = cast<Instruction>(m_pipelineSysValues->get(m_entryPoint)->getRelativeId());
+    m_tfBufferPatchByteOffset = BinaryOperator::CreateMul(
+        relativeId, ConstantInt::get(Type::getInt32Ty(*m_context), calcFactor.tessFactorStride * 4), "",
+        relativeId->getNextNode());
+  }
+
+  return m_tfBufferPatchByteOffset;
+}
+
 // =====================================================================================================================
 // Creates the LLPC intrinsic "llpc.tfbuffer.store.f32" to store tessellation factor (dynamic element indexing for
 // tessellation level array).
@@ -4834,7 +4980,7 @@ Value *PatchInOutImportExport::calcLdsOffsetForTcsInput(Type *inputTy, unsigned
   // dwordOffset = (relativeId * inVertexCount + vertexId) * inVertexStride + attribOffset
   auto inVertexCount = m_pipelineState->getInputAssemblyState().patchControlPoints;
   auto inVertexCountVal = ConstantInt::get(Type::getInt32Ty(*m_context), inVertexCount);
-  auto relativeId = m_pipelineSysValues.get(m_entryPoint)->getRelativeId();
+  auto relativeId = m_pipelineSysValues->get(m_entryPoint)->getRelativeId();
 
   Value *ldsOffset = BinaryOperator::CreateMul(relativeId, inVertexCountVal, "", insertPos);
   ldsOffset = BinaryOperator::CreateAdd(ldsOffset, vertexIdx, "", insertPos);
@@ -4863,63 +5009,109 @@ Value *PatchInOutImportExport::calcLdsOffsetForTcsOutput(Type *outputTy, unsigne
   const auto &inOutUsage = m_pipelineState->getShaderResourceUsage(ShaderStageTessControl)->inOutUsage.tcs;
   const auto &calcFactor = inOutUsage.calcFactor;
 
-  auto outPatchStart =
-      m_pipelineState->isTessOffChip() ? calcFactor.offChip.outPatchStart : calcFactor.onChip.outPatchStart;
-
-  auto patchConstStart =
-      m_pipelineState->isTessOffChip() ? calcFactor.offChip.patchConstStart : calcFactor.onChip.patchConstStart;
-
   // attribOffset = (location + locOffset) * 4 + compIdx * bitWidth / 32
-  Value *attibOffset = ConstantInt::get(Type::getInt32Ty(*m_context), location);
-
-  if (locOffset)
-    attibOffset = BinaryOperator::CreateAdd(attibOffset, locOffset, "", insertPos);
-
-  attibOffset =
-      BinaryOperator::CreateMul(attibOffset, ConstantInt::get(Type::getInt32Ty(*m_context), 4), "", insertPos);
+  // NOTE: The constant parts are folded at emission time so the common constant-indexed outputs do not each emit an
+  // add/mul chain that later passes have to clean up.
+  Value *attibOffset = nullptr;
+  if (!locOffset)
+    attibOffset = ConstantInt::get(Type::getInt32Ty(*m_context), location * 4);
+  else if (auto constLocOffset = dyn_cast<ConstantInt>(locOffset))
+    attibOffset = ConstantInt::get(Type::getInt32Ty(*m_context), (location + constLocOffset->getZExtValue()) * 4);
+  else {
+    attibOffset = BinaryOperator::CreateAdd(ConstantInt::get(Type::getInt32Ty(*m_context), location), locOffset, "",
+                                            insertPos);
+    attibOffset =
+        BinaryOperator::CreateMul(attibOffset, ConstantInt::get(Type::getInt32Ty(*m_context), 4), "", insertPos);
+  }
 
   if (compIdx) {
     const unsigned bitWidth = outputTy->getScalarSizeInBits();
     assert(bitWidth == 8 || bitWidth == 16 || bitWidth == 32 || bitWidth == 64);
 
-    if (bitWidth == 64) {
-      // For 64-bit data type, the component indexing must multiply by 2
-      compIdx = BinaryOperator::CreateMul(compIdx, ConstantInt::get(Type::getInt32Ty(*m_context), 2), "", insertPos);
-    }
+    // For 64-bit data type, the component indexing must multiply by 2
+    const unsigned compScale = bitWidth == 64 ? 2 : 1;
 
-    attibOffset = BinaryOperator::CreateAdd(attibOffset, compIdx, "", insertPos);
-  }
+    if (isa<ConstantInt>(compIdx) && isa<ConstantInt>(attibOffset)) {
+      attibOffset = ConstantInt::get(Type::getInt32Ty(*m_context),
+                                     cast<ConstantInt>(attibOffset)->getZExtValue() +
+                                         cast<ConstantInt>(compIdx)->getZExtValue() * compScale);
+    } else {
+      if (compScale > 1) {
+        compIdx = BinaryOperator::CreateMul(compIdx, ConstantInt::get(Type::getInt32Ty(*m_context), compScale), "",
+                                            insertPos);
+      }
 
-  Value *ldsOffset = nullptr;
+      attibOffset = BinaryOperator::CreateAdd(attibOffset, compIdx, "", insertPos);
+    }
+  }
 
   const bool perPatch = (!vertexIdx); // Vertex indexing is unavailable for per-patch output
-  auto relativeId = m_pipelineSysValues.get(m_entryPoint)->getRelativeId();
-  if (perPatch) {
-    // dwordOffset = patchConstStart + relativeId * patchConstSize + attribOffset
-    auto patchConstSize = ConstantInt::get(Type::getInt32Ty(*m_context), calcFactor.patchConstSize);
-    ldsOffset = BinaryOperator::CreateMul(relativeId, patchConstSize, "", insertPos);
 
-    auto patchConstStartVal = ConstantInt::get(Type::getInt32Ty(*m_context), patchConstStart);
-    ldsOffset = BinaryOperator::CreateAdd(ldsOffset, patchConstStartVal, "", insertPos);
+  // Per-patch output:  dwordOffset = patchConstStart + relativeId * patchConstSize + attribOffset
+  // Per-vertex output: dwordOffset = outPatchStart + (relativeId * outVertexCount + vertexId) * outVertexStride +
+  //                                      attribOffset
+  //                                = outPatchStart + relativeId * outPatchSize + vertexId * outVertexStride +
+  //                                      attribOffset
+  Value *ldsOffset = getTcsOutputPatchBaseOffset(perPatch);
+
+  if (!perPatch) {
+    Value *vertexOffset = nullptr;
+    if (auto constVertexIdx = dyn_cast<ConstantInt>(vertexIdx)) {
+      vertexOffset =
+          ConstantInt::get(Type::getInt32Ty(*m_context), constVertexIdx->getZExtValue() * calcFactor.outVertexStride);
+    } else {
+      auto outVertexStride = ConstantInt::get(Type::getInt32Ty(*m_context), calcFactor.outVertexStride);
+      vertexOffset = BinaryOperator::CreateMul(vertexIdx, outVertexStride, "", insertPos);
+    }
 
-    ldsOffset = BinaryOperator::CreateAdd(ldsOffset, attibOffset, "", insertPos);
-  } else {
-    // dwordOffset = outPatchStart + (relativeId * outVertexCount + vertexId) * outVertexStride + attribOffset
-    //             = outPatchStart + relativeId * outPatchSize + vertexId  * outVertexStride + attribOffset
-    auto outPatchSize = ConstantInt::get(Type::getInt32Ty(*m_context), calcFactor.outPatchSize);
-    ldsOffset = BinaryOperator::CreateMul(relativeId, outPatchSize, "", insertPos);
+    if (isa<ConstantInt>(vertexOffset) && isa<ConstantInt>(attibOffset)) {
+      attibOffset = ConstantInt::get(Type::getInt32Ty(*m_context),
+                                     cast<ConstantInt>(vertexOffset)->getZExtValue() +
+                                         cast<ConstantInt>(attibOffset)->getZExtValue());
+    } else
+      ldsOffset = BinaryOperator::CreateAdd(ldsOffset, vertexOffset, "", insertPos);
+  }
 
-    auto outPatchStartVal = ConstantInt::get(Type::getInt32Ty(*m_context), outPatchStart);
-    ldsOffset = BinaryOperator::CreateAdd(ldsOffset, outPatchStartVal, "", insertPos);
+  ldsOffset = BinaryOperator::CreateAdd(ldsOffset, attibOffset, "", insertPos);
 
-    auto outVertexStride = ConstantInt::get(Type::getInt32Ty(*m_context), calcFactor.outVertexStride);
-    ldsOffset = BinaryOperator::CreateAdd(
-        ldsOffset, BinaryOperator::CreateMul(vertexIdx, outVertexStride, "", insertPos), "", insertPos);
+  return ldsOffset;
+}
 
-    ldsOffset = BinaryOperator::CreateAdd(ldsOffset, attibOffset, "", insertPos);
+// =====================================================================================================================
+// Gets the base dword offset in LDS of the current patch's TCS outputs (TCS).
+//
+// NOTE: The offset depends only on the relative patch ID, so it is emitted right after that value near the start of
+// the entry-point and shared by all outputs of the shader, rather than re-emitting the multiply chain per output.
+//
+// @param perPatch : Whether to get the base offset of per-patch outputs (false: per-vertex outputs)
+Value *PatchInOutImportExport::getTcsOutputPatchBaseOffset(bool perPatch) {
+  assert(m_shaderStage == ShaderStageTessControl);
+
+  Value *&patchBaseOffset = perPatch ? m_tcsPatchConstBaseOffset : m_tcsOutPatchBaseOffset;
+  if (!patchBaseOffset) {
+    const auto &calcFactor = m_pipelineState->getShaderResourceUsage(ShaderStageTessControl)->inOutUsage.tcs.calcFactor;
+    const bool offChip = m_pipelineState->isTessOffChip();
+
+    unsigned patchStart = 0;
+    unsigned patchSize = 0;
+    if (perPatch) {
+      patchStart = offChip ? calcFactor.offChip.patchConstStart : calcFactor.onChip.patchConstStart;
+      patchSize = calcFactor.patchConstSize;
+    } else {
+      patchStart = offChip ? calcFactor.offChip.outPatchStart : calcFactor.onChip.outPatchStart;
+      patchSize = calcFactor.outPatchSize;
+    }
+
+    // patchBaseOffset = patchStart + relativeId * patchSize
+    auto relativeId = cast<Instruction>(m_pipelineSysValues->get(m_entryPoint)->getRelativeId());
+    auto insertPos = relativeId->getNextNode();
+    patchBaseOffset =
+        BinaryOperator::CreateMul(relativeId, ConstantInt::get(Type::getInt32Ty(*m_context), patchSize), "", insertPos);
+    patchBaseOffset = BinaryOperator::CreateAdd(
+        patchBaseOffset, ConstantInt::get(Type::getInt32Ty(*m_context), patchStart), "", insertPos);
   }
 
-  return ldsOffset;
+  return patchBaseOffset;
 }
 
 // =====================================================================================================================
@@ -5239,6 +5431,82 @@ void PatchInOutImportExport::addExportInstForGenericOutput(Value *output, unsign
   }
 }
 
+// =====================================================================================================================
+// Coalesces partial generic ("param") exports after all outputs of an entry-point have been lowered.
+//
+// Outputs written component by component arrive as independent output.export calls and are each lowered to an
+// "exp" instruction with a partial channel mask, so several exports can end up targeting the same param slot.
+// The hardware allocates parameter cache per export, so packing these into one full export per target directly
+// helps parameter-cache-bound vertex throughput, in addition to shrinking the export sequence.
+//
+// Only exports within one basic block are merged. The merged export takes the place of the last export of its
+// group, where every source operand is already available (all of them dominate their original export). Channels
+// are accumulated in program order so a later write to the same channel wins, matching the hardware behavior of
+// the unmerged sequence. Generic exports never set the done or vm flags, and any export that does is left alone,
+// so the flags of the remaining export sequence are unchanged.
+//
+// @param [in,out] entryPoint : Entry-point whose generic exports are to be coalesced
+void PatchInOutImportExport::coalesceGenericExports(Function *entryPoint) {
+  auto &inOutUsage = m_pipelineState->getShaderResourceUsage(m_shaderStage)->inOutUsage;
+
+  for (BasicBlock &block : *entryPoint) {
+    // Gather the block's generic exports, grouped by export target in program order.
+    std::map<unsigned, SmallVector<CallInst *, 4>> exportsByTarget;
+
+    for (Instruction &inst : block) {
+      CallInst *const call = dyn_cast<CallInst>(&inst);
+      if (!call)
+        continue;
+
+      Function *const callee = call->getCalledFunction();
+      if (!callee || callee->getName() != "llvm.amdgcn.exp.f32")
+        continue;
+
+      const unsigned target = cast<ConstantInt>(call->getArgOperand(0))->getZExtValue();
+      if (target < EXP_TARGET_PARAM_0 || target > EXP_TARGET_PARAM_31)
+        continue;
+
+      // Leave any export with the done or vm flag set alone; it must keep its place in the sequence.
+      if (!cast<ConstantInt>(call->getArgOperand(6))->isZero() || !cast<ConstantInt>(call->getArgOperand(7))->isZero())
+        continue;
+
+      exportsByTarget[target].push_back(call);
+    }
+
+    for (auto &targetAndExports : exportsByTarget) {
+      auto &exports = targetAndExports.second;
+      if (exports.size() < 2)
+        continue;
+
+      // Accumulate the enabled channels in program order, so a later write to a channel wins.
+      unsigned channelMask = 0;
+      Value *channels[4] = {nullptr};
+
+      for (CallInst *const expCall : exports) {
+        const unsigned mask = cast<ConstantInt>(expCall->getArgOperand(1))->getZExtValue();
+        for (unsigned i = 0; i < 4; ++i) {
+          if (mask & (1 << i))
+            channels[i] = expCall->getArgOperand(2 + i);
+        }
+        channelMask |= mask;
+      }
+
+      // Rewrite the last export of the group with the packed channels, and remove the others.
+      CallInst *const packedExport = exports.back();
+      packedExport->setArgOperand(1, ConstantInt::get(Type::getInt32Ty(*m_context), channelMask));
+      for (unsigned i = 0; i < 4; ++i) {
+        packedExport->setArgOperand(2 + i, channels[i] ? channels[i] : UndefValue::get(Type::getFloatTy(*m_context)));
+      }
+
+      for (CallInst *const expCall : makeArrayRef(exports).drop_back()) {
+        expCall->eraseFromParent();
+        assert(inOutUsage.expCount > 0);
+        --inOutUsage.expCount;
+      }
+    }
+  }
+}
+
 // =====================================================================================================================
 // Inserts "exp" instruction to export built-in output.
 //
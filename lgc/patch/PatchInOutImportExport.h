@@ -36,6 +36,7 @@
 #include "lgc/state/PipelineShaders.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/InstVisitor.h"
 #include <set>
 
@@ -43,6 +44,23 @@ namespace lgc {
 
 class FragColorExport;
 
+// Kinds of input/output helper calls lowered by PatchInOutImportExport. The kind is interned per callee
+// declaration the first time a call to it is seen, so the name prefix matching runs once per declaration
+// instead of once per call.
+enum class InOutCallKind {
+  NotInOut,               // Not an input/output helper call
+  GenericInputImport,     // lgc.input.import.generic.*
+  BuiltInInputImport,     // lgc.input.import.builtin.*
+  InterpolantInputImport, // lgc.input.import.interpolant.*
+  GenericOutputImport,    // lgc.output.import.generic.*
+  BuiltInOutputImport,    // lgc.output.import.builtin.*
+  GenericOutputExport,    // lgc.output.export.generic.*
+  BuiltInOutputExport,    // lgc.output.export.builtin.*
+  XfbOutputExport,        // lgc.output.export.xfb.*
+  GsSendMsg,              // llvm.amdgcn.s.sendmsg; drives the GS emit vertex counters and the implicit
+                          //  gl_ViewIndex store to the GS-VS ring for multiview
+};
+
 // =====================================================================================================================
 // Represents the pass of LLVM patching opertions for input import and output export.
 class PatchInOutImportExport : public Patch, public llvm::InstVisitor<PatchInOutImportExport> {
@@ -53,6 +71,7 @@ public:
   void getAnalysisUsage(llvm::AnalysisUsage &analysisUsage) const override {
     analysisUsage.addRequired<PipelineStateWrapper>();
     analysisUsage.addRequired<PipelineShaders>();
+    analysisUsage.addRequired<PipelineSystemValuesWrapper>();
     analysisUsage.addPreserved<PipelineShaders>();
   }
 
@@ -68,8 +87,12 @@ private:
 
   void initPerShader();
 
+  InOutCallKind getInOutCallKind(const llvm::Function *callee);
+
   void processShader();
 
+  void finalizeDeferredColorExports();
+
   llvm::Value *patchTcsGenericInputImport(llvm::Type *inputTy, unsigned location, llvm::Value *locOffset,
                                           llvm::Value *compIdx, llvm::Value *vertexIdx, llvm::Instruction *insertPos);
   llvm::Value *patchTesGenericInputImport(llvm::Type *inputTy, unsigned location, llvm::Value *locOffset,
@@ -169,6 +192,10 @@ private:
 
   void createTessBufferStoreFunction();
 
+  llvm::Value *getTfBufferPatchByteOffset();
+
+  llvm::Value *getTcsOutputPatchBaseOffset(bool perPatch);
+
   unsigned calcPatchCountPerThreadGroup(unsigned inVertexCount, unsigned inVertexStride, unsigned outVertexCount,
                                         unsigned outVertexStride, unsigned patchConstCount,
                                         unsigned tessFactorStride) const;
@@ -188,6 +215,7 @@ private:
   void addExportInstForGenericOutput(llvm::Value *output, unsigned location, unsigned compIdx,
                                      llvm::Instruction *insertPos);
   void addExportInstForBuiltInOutput(llvm::Value *output, unsigned builtInId, llvm::Instruction *insertPos);
+  void coalesceGenericExports(llvm::Function *entryPoint);
 
   llvm::Value *adjustCentroidIj(llvm::Value *centroidIj, llvm::Value *centerIj, llvm::Instruction *insertPos);
 
@@ -200,7 +228,7 @@ private:
   llvm::Value *getDeviceIndex(llvm::Instruction *insertPos);
 
   GfxIpVersion m_gfxIp;                     // Graphics IP version info
-  PipelineSystemValues m_pipelineSysValues; // Cache of ShaderSystemValues objects, one per shader stage
+  PipelineSystemValuesWrapper *m_pipelineSysValues = nullptr; // Analysis caching ShaderSystemValues per shader stage
 
   FragColorExport *m_fragColorExport; // Fragment color export manager
 
@@ -226,11 +254,23 @@ private:
   llvm::GlobalVariable *m_lds; // Global variable to model LDS
   llvm::Value *m_threadId;     // Thread ID
 
+  // NOTE: The following offsets depend only on the relative patch ID, so they are emitted once near the start of the
+  // entry-point and shared by all tessellation outputs of the shader (see getTfBufferPatchByteOffset() and
+  // getTcsOutputPatchBaseOffset()).
+  llvm::Value *m_tfBufferPatchByteOffset; // Byte offset of the current patch in the TF buffer (TCS)
+  llvm::Value *m_tcsOutPatchBaseOffset;   // Dword offset in LDS of the current patch's per-vertex outputs (TCS)
+  llvm::Value *m_tcsPatchConstBaseOffset; // Dword offset in LDS of the current patch's per-patch outputs (TCS)
+
   std::vector<llvm::Value *> m_expFragColors[MaxColorTargets]; // Exported fragment colors
+  // Fragment color outputs whose export conversion is deferred to a link-time color export shader, as pairs of
+  // {hardware color target, output value}
+  std::vector<std::pair<unsigned, llvm::Value *>> m_deferredColorExports;
   std::vector<llvm::CallInst *> m_importCalls;                 // List of "call" instructions to import inputs
   std::vector<llvm::CallInst *> m_exportCalls;                 // List of "call" instructions to export outputs
   PipelineState *m_pipelineState = nullptr;                    // Pipeline state from PipelineStateWrapper pass
 
+  llvm::DenseMap<const llvm::Function *, InOutCallKind> m_inOutCallKinds; // Interned call kind per callee
+
   std::set<unsigned> m_expLocs; // The locations that already have an export instruction for the vertex shader.
 };
 
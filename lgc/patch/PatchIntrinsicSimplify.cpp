@@ -37,6 +37,7 @@
 
 #include "PatchIntrinsicSimplify.h"
 #include "lgc/state/PipelineState.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/IR/Intrinsics.h"
@@ -53,6 +54,55 @@ using namespace lgc;
 // Initializes static members.
 char PatchIntrinsicSimplify::ID = 0;
 
+namespace {
+
+// =====================================================================================================================
+// Operand predicate for the trigonometric rules: only calls whose input is a multiply or divide by a constant
+// can match the 2*PI pattern, so anything else is rejected before being recorded as a candidate.
+//
+// @param intrinsicCall : The intrinsic call to check
+bool isScaledByConstant(const IntrinsicInst &intrinsicCall) {
+  const BinaryOperator *const binOp = dyn_cast<BinaryOperator>(intrinsicCall.getOperand(0));
+
+  if (!binOp)
+    return false;
+
+  if (binOp->getOpcode() != BinaryOperator::FMul && binOp->getOpcode() != BinaryOperator::FDiv)
+    return false;
+
+  return isa<ConstantFP>(binOp->getOperand(1));
+}
+
+// Extra rewrite rules registered with PatchIntrinsicSimplify::registerSimplification().
+SmallVector<PatchIntrinsicSimplify::SimplifyRule, 4> RegisteredRules;
+
+} // namespace
+
+// =====================================================================================================================
+// The built-in rewrite rules. Image entries carry the number of coordinate operands, which always start at
+// operand 1 for the intrinsics listed.
+const PatchIntrinsicSimplify::SimplifyRule PatchIntrinsicSimplify::BuiltInRules[] = {
+    {Intrinsic::amdgcn_image_load_1d, nullptr, &PatchIntrinsicSimplify::simplifyImage, 1},
+    {Intrinsic::amdgcn_image_load_2d, nullptr, &PatchIntrinsicSimplify::simplifyImage, 2},
+    {Intrinsic::amdgcn_image_load_3d, nullptr, &PatchIntrinsicSimplify::simplifyImage, 3},
+    {Intrinsic::amdgcn_image_sample_1d, nullptr, &PatchIntrinsicSimplify::simplifyImage, 1},
+    {Intrinsic::amdgcn_image_sample_2d, nullptr, &PatchIntrinsicSimplify::simplifyImage, 2},
+    {Intrinsic::amdgcn_image_sample_3d, nullptr, &PatchIntrinsicSimplify::simplifyImage, 3},
+    {Intrinsic::amdgcn_image_sample_l_1d, nullptr, &PatchIntrinsicSimplify::simplifyImage, 2},
+    {Intrinsic::amdgcn_image_sample_l_2d, nullptr, &PatchIntrinsicSimplify::simplifyImage, 3},
+    {Intrinsic::amdgcn_image_sample_l_3d, nullptr, &PatchIntrinsicSimplify::simplifyImage, 4},
+    {Intrinsic::cos, &isScaledByConstant, &PatchIntrinsicSimplify::simplifyTrigonometric, 0},
+    {Intrinsic::sin, &isScaledByConstant, &PatchIntrinsicSimplify::simplifyTrigonometric, 0},
+};
+
+// =====================================================================================================================
+// Registers an additional rewrite rule; a rule for an intrinsic that already has one overrides it.
+//
+// @param rule : The rule to register
+void PatchIntrinsicSimplify::registerSimplification(const SimplifyRule &rule) {
+  RegisteredRules.push_back(rule);
+}
+
 // =====================================================================================================================
 // Pass creator, creates the LLVM pass intrinsic simplifcations.
 FunctionPass *lgc::createPatchIntrinsicSimplify() {
@@ -80,7 +130,7 @@ void PatchIntrinsicSimplify::getAnalysisUsage(AnalysisUsage &analysisUsage) cons
 //
 // @param [in,out] func : LLVM function to be run on.
 bool PatchIntrinsicSimplify::runOnFunction(Function &func) {
-  SmallVector<IntrinsicInst *, 32> candidateCalls;
+  SmallVector<std::pair<IntrinsicInst *, const SimplifyRule *>, 32> candidateCalls;
   bool changed = false;
 
   m_module = func.getParent();
@@ -90,13 +140,27 @@ bool PatchIntrinsicSimplify::runOnFunction(Function &func) {
   m_scalarEvolution = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
   m_context = &func.getContext();
 
-  // We iterate over users of intrinsics which should be less work than
+  // Build the rule lookup: built-in rules first, then registered extras, which override a built-in rule for the
+  // same intrinsic.
+  DenseMap<unsigned, const SimplifyRule *> ruleForIntrinsic;
+  for (const SimplifyRule &rule : BuiltInRules)
+    ruleForIntrinsic[rule.id] = &rule;
+  for (const SimplifyRule &rule : RegisteredRules)
+    ruleForIntrinsic[rule.id] = &rule;
+
+  // We iterate over users of the few intrinsic declarations the rule table mentions, which is less work than
   // iterating over all instructions in the module.
   for (Function &otherFunc : m_module->functions()) {
-    // Skip non intrinsics.
+    // Skip non intrinsics, and skip intrinsics no rule matches before touching their use-lists.
     if (!otherFunc.isIntrinsic())
       continue;
 
+    auto ruleIt = ruleForIntrinsic.find(otherFunc.getIntrinsicID());
+    if (ruleIt == ruleForIntrinsic.end())
+      continue;
+
+    const SimplifyRule *const rule = ruleIt->second;
+
     for (Value *const user : otherFunc.users()) {
       IntrinsicInst *const intrinsicCall = dyn_cast<IntrinsicInst>(user);
 
@@ -107,15 +171,18 @@ bool PatchIntrinsicSimplify::runOnFunction(Function &func) {
       if (intrinsicCall->getFunction() != &func)
         continue;
 
-      // Record intrinsic only if it can be simplified.
-      if (canSimplify(*intrinsicCall))
-        candidateCalls.push_back(intrinsicCall);
+      // Record the call only if it passes the rule's operand predicate.
+      if (!rule->predicate || rule->predicate(*intrinsicCall))
+        candidateCalls.push_back({intrinsicCall, rule});
     }
   }
 
-  // Process all intrinsics which can be simplified.
-  for (IntrinsicInst *const intrinsicCall : candidateCalls) {
-    Value *const simplifiedValue = simplify(*intrinsicCall);
+  // Process all intrinsic calls a rule matched.
+  for (const auto &candidate : candidateCalls) {
+    IntrinsicInst *const intrinsicCall = candidate.first;
+    const SimplifyRule *const rule = candidate.second;
+
+    Value *const simplifiedValue = rule->builder(*this, *intrinsicCall, *rule);
 
     // We did not simplify the intrinsic call.
     if (!simplifiedValue)
@@ -184,32 +251,34 @@ Value *PatchIntrinsicSimplify::convertTo16Bit(Value &value, IRBuilder<> &builder
 }
 
 // =====================================================================================================================
-// Simplify image intrinsics.
+// Replacement builder for image intrinsics: if every coordinate is provably derived from a 16-bit value, switch
+// the call to the 16-bit coordinate overload.
 //
+// @param pass : The running pass, giving access to target info and analyses
 // @param intrinsicCall : The intrinsic call to simplify
-// @param coordOperandIndices : Operand indices of image coordinate
-Value *PatchIntrinsicSimplify::simplifyImage(IntrinsicInst &intrinsicCall,
-                                             ArrayRef<unsigned> coordOperandIndices) const {
+// @param rule : The matched rule, carrying the coordinate operand count
+Value *PatchIntrinsicSimplify::simplifyImage(PatchIntrinsicSimplify &pass, IntrinsicInst &intrinsicCall,
+                                             const SimplifyRule &rule) {
   // If we're not on GFX9 or above, bail.
-  if (m_gfxIp.major < 9)
+  if (pass.m_gfxIp.major < 9)
     return nullptr;
 
   bool floatCoord = false;
 
-  for (unsigned operandIndex : coordOperandIndices) {
+  for (unsigned operandIndex = 1; operandIndex <= rule.coordOperandCount; operandIndex++) {
     Value *const coord = intrinsicCall.getOperand(operandIndex);
     // If the values are not derived from 16-bit values, we cannot optimize.
-    if (!canSafelyConvertTo16Bit(*coord))
+    if (!pass.canSafelyConvertTo16Bit(*coord))
       return nullptr;
 
-    assert(operandIndex == coordOperandIndices[0] || floatCoord == coord->getType()->isFloatingPointTy());
+    assert(operandIndex == 1 || floatCoord == coord->getType()->isFloatingPointTy());
     floatCoord = coord->getType()->isFloatingPointTy();
   }
 
-  Type *const coordType = floatCoord ? Type::getHalfTy(*m_context) : Type::getInt16Ty(*m_context);
+  Type *const coordType = floatCoord ? Type::getHalfTy(*pass.m_context) : Type::getInt16Ty(*pass.m_context);
 
   Function *const intrinsic =
-      Intrinsic::getDeclaration(m_module, intrinsicCall.getIntrinsicID(), {intrinsicCall.getType(), coordType});
+      Intrinsic::getDeclaration(pass.m_module, intrinsicCall.getIntrinsicID(), {intrinsicCall.getType(), coordType});
 
   assert(intrinsic);
 
@@ -217,17 +286,21 @@ Value *PatchIntrinsicSimplify::simplifyImage(IntrinsicInst &intrinsicCall,
 
   IRBuilder<> builder(&intrinsicCall);
 
-  for (unsigned operandIndex : coordOperandIndices)
-    args[operandIndex] = convertTo16Bit(*intrinsicCall.getOperand(operandIndex), builder);
+  for (unsigned operandIndex = 1; operandIndex <= rule.coordOperandCount; operandIndex++)
+    args[operandIndex] = pass.convertTo16Bit(*intrinsicCall.getOperand(operandIndex), builder);
 
   return builder.CreateCall(intrinsic, args);
 }
 
 // =====================================================================================================================
-// Simplify a trigonometric intrinsic.
+// Replacement builder for trigonometric intrinsics.
 //
+// @param pass : The running pass, giving access to target info and analyses
 // @param intrinsicCall : The intrinsic call to simplify
-Value *PatchIntrinsicSimplify::simplifyTrigonometric(IntrinsicInst &intrinsicCall) const {
+// @param rule : The matched rule (unused; the trigonometric rules carry no extra data)
+Value *PatchIntrinsicSimplify::simplifyTrigonometric(PatchIntrinsicSimplify &pass, IntrinsicInst &intrinsicCall,
+                                                     const SimplifyRule &rule) {
+  (void(rule)); // unused
   // The sin and cos function in the hardware are dividing by 2*PI beforehand.
   // This means      sin(x * 2 * PI) = amdgcn.sin(x)
   // and                      sin(x) = amdgcn.sin(x / (2 * PI))
@@ -295,16 +368,16 @@ Value *PatchIntrinsicSimplify::simplifyTrigonometric(IntrinsicInst &intrinsicCal
 
   Type *intrinsicType = intrinsicCall.getType();
 
-  Function *const intrinsic = Intrinsic::getDeclaration(m_module, intrinsicId, {intrinsicType, intrinsicType});
+  Function *const intrinsic = Intrinsic::getDeclaration(pass.m_module, intrinsicId, {intrinsicType, intrinsicType});
 
   assert(intrinsic);
 
   Value *leftOperand = binOp->getOperand(0);
 
   // If we're not on GFX9 or above, we need to add a clamp from 0..1 (using fract).
-  if (m_gfxIp.major < 9) {
+  if (pass.m_gfxIp.major < 9) {
     Function *const fractIntrinsic =
-        Intrinsic::getDeclaration(m_module, Intrinsic::amdgcn_fract, {intrinsicType, intrinsicType});
+        Intrinsic::getDeclaration(pass.m_module, Intrinsic::amdgcn_fract, {intrinsicType, intrinsicType});
     assert(fractIntrinsic);
 
     CallInst *const fractCall = CallInst::Create(fractIntrinsic, leftOperand, "", &intrinsicCall);
@@ -316,56 +389,6 @@ Value *PatchIntrinsicSimplify::simplifyTrigonometric(IntrinsicInst &intrinsicCal
   return newCall;
 }
 
-// =====================================================================================================================
-// Check if an intrinsic can be simplified.
-//
-// @param intrinsicCall : The intrinsic call to simplify
-bool PatchIntrinsicSimplify::canSimplify(IntrinsicInst &intrinsicCall) const {
-  switch (intrinsicCall.getIntrinsicID()) {
-  case Intrinsic::amdgcn_image_load_1d:
-  case Intrinsic::amdgcn_image_load_2d:
-  case Intrinsic::amdgcn_image_load_3d:
-  case Intrinsic::amdgcn_image_sample_1d:
-  case Intrinsic::amdgcn_image_sample_2d:
-  case Intrinsic::amdgcn_image_sample_l_1d:
-  case Intrinsic::amdgcn_image_sample_3d:
-  case Intrinsic::amdgcn_image_sample_l_2d:
-  case Intrinsic::amdgcn_image_sample_l_3d:
-  case Intrinsic::cos:
-  case Intrinsic::sin:
-    return true;
-  default:
-    return false;
-  }
-}
-
-// =====================================================================================================================
-// Simplify an intrinsic.
-//
-// @param intrinsicCall : The intrinsic call to simplify
-Value *PatchIntrinsicSimplify::simplify(IntrinsicInst &intrinsicCall) const {
-  switch (intrinsicCall.getIntrinsicID()) {
-  case Intrinsic::amdgcn_image_load_1d:
-  case Intrinsic::amdgcn_image_sample_1d:
-    return simplifyImage(intrinsicCall, {1});
-  case Intrinsic::amdgcn_image_load_2d:
-  case Intrinsic::amdgcn_image_sample_2d:
-  case Intrinsic::amdgcn_image_sample_l_1d:
-    return simplifyImage(intrinsicCall, {1, 2});
-  case Intrinsic::amdgcn_image_load_3d:
-  case Intrinsic::amdgcn_image_sample_3d:
-  case Intrinsic::amdgcn_image_sample_l_2d:
-    return simplifyImage(intrinsicCall, {1, 2, 3});
-  case Intrinsic::amdgcn_image_sample_l_3d:
-    return simplifyImage(intrinsicCall, {1, 2, 3, 4});
-  case Intrinsic::cos:
-  case Intrinsic::sin:
-    return simplifyTrigonometric(intrinsicCall);
-  default:
-    return nullptr;
-  }
-}
-
 // =====================================================================================================================
 // Initializes the pass of LLVM patching operations for specifying intrinsic simplifications.
 INITIALIZE_PASS_BEGIN(PatchIntrinsicSimplify, DEBUG_TYPE, "Patch LLVM for intrinsic simplifications", false, false)
@@ -34,6 +34,7 @@
 #include "lgc/state/TargetInfo.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Intrinsics.h"
 
 namespace llvm {
 
@@ -54,25 +55,56 @@ class PipelineState;
 
 // =====================================================================================================================
 // Represents the LLVM pass for intrinsic simplifications.
+//
+// The pass is driven by a declarative table of rewrite rules. Each rule names the intrinsic it matches, an optional
+// cheap operand predicate checked before the call is even recorded as a candidate, and a builder that constructs the
+// replacement value (or returns null to leave the call alone). Matching walks only the use-lists of the intrinsic
+// declarations the table mentions, so the cost scales with the number of relevant calls rather than the function
+// size. Additional rules for app-specific simplifications can be added with registerSimplification().
 class PatchIntrinsicSimplify final : public llvm::FunctionPass {
 public:
+  struct SimplifyRule;
+
+  // Builds the replacement for a matched intrinsic call, or returns null to leave the call alone.
+  typedef llvm::Value *(*ReplacementBuilder)(PatchIntrinsicSimplify &pass, llvm::IntrinsicInst &intrinsicCall,
+                                             const SimplifyRule &rule);
+
+  // A declarative intrinsic rewrite rule.
+  struct SimplifyRule {
+    llvm::Intrinsic::ID id;                                      // Intrinsic the rule matches
+    bool (*predicate)(const llvm::IntrinsicInst &intrinsicCall); // Cheap operand check, may be null
+    ReplacementBuilder builder;                                  // Builds the replacement value
+    unsigned coordOperandCount;                                  // For image rules: number of coordinate operands,
+                                                                 //  starting at operand 1; 0 otherwise
+  };
+
   explicit PatchIntrinsicSimplify();
 
   void getAnalysisUsage(llvm::AnalysisUsage &analysisUsage) const override;
   bool runOnFunction(llvm::Function &func) override;
 
+  // Registers an additional rewrite rule; a rule for an intrinsic that already has one overrides it. Must be
+  // called before compilation threads start running this pass.
+  static void registerSimplification(const SimplifyRule &rule);
+
+  // Gets the graphics IP version being compiled for, for use by replacement builders.
+  GfxIpVersion getGfxIpVersion() const { return m_gfxIp; }
+
   static char ID; // ID of this pass
 
   PatchIntrinsicSimplify(const PatchIntrinsicSimplify &) = delete;
   PatchIntrinsicSimplify &operator=(const PatchIntrinsicSimplify &) = delete;
 
 private:
+  static llvm::Value *simplifyImage(PatchIntrinsicSimplify &pass, llvm::IntrinsicInst &intrinsicCall,
+                                    const SimplifyRule &rule);
+  static llvm::Value *simplifyTrigonometric(PatchIntrinsicSimplify &pass, llvm::IntrinsicInst &intrinsicCall,
+                                            const SimplifyRule &rule);
+
   bool canSafelyConvertTo16Bit(llvm::Value &value) const;
   llvm::Value *convertTo16Bit(llvm::Value &value, llvm::IRBuilder<> &builder) const;
-  llvm::Value *simplifyImage(llvm::IntrinsicInst &intrinsicCall, llvm::ArrayRef<unsigned> coordOperandIndices) const;
-  llvm::Value *simplifyTrigonometric(llvm::IntrinsicInst &intrinsicCall) const;
-  bool canSimplify(llvm::IntrinsicInst &intrinsicCall) const;
-  llvm::Value *simplify(llvm::IntrinsicInst &intrinsicCall) const;
+
+  static const SimplifyRule BuiltInRules[]; // The built-in rewrite rules
 
   llvm::ScalarEvolution *m_scalarEvolution = nullptr;
   llvm::LLVMContext *m_context = nullptr;
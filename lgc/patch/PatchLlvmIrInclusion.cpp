@@ -31,12 +31,25 @@
 #include "PatchLlvmIrInclusion.h"
 #include "lgc/state/Abi.h"
 #include "llvm/IR/Constants.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 
 #define DEBUG_TYPE "lgc-patch-llvm-ir-inclusion"
 
 using namespace llvm;
 using namespace lgc;
 
+// -llvm-ir-inclusion-max-size: cap in bytes on the LLVM IR text embedded in the ELF; 0 means no cap
+static cl::opt<unsigned> LlvmIrInclusionMaxSize("llvm-ir-inclusion-max-size",
+                                                cl::desc("Cap in bytes on the LLVM IR text embedded in the ELF; "
+                                                         "0 means no cap"),
+                                                cl::init(0));
+
+// -compress-llvm-ir-inclusion: compress the embedded LLVM IR with zlib
+static cl::opt<bool> CompressLlvmIrInclusion("compress-llvm-ir-inclusion",
+                                             cl::desc("Compress the LLVM IR embedded in the ELF with zlib"),
+                                             cl::init(false));
+
 namespace lgc {
 
 // =====================================================================================================================
@@ -57,7 +70,9 @@ PatchLlvmIrInclusion::PatchLlvmIrInclusion() : Patch(ID) {
 // Executes this patching pass on the specified LLVM module.
 //
 // This pass includes LLVM IR as a separate section in the ELF binary by inserting a new global variable with explicit
-// section.
+// section. The embedded text can be capped with -llvm-ir-inclusion-max-size, which replaces the tail of an oversized
+// module with a truncation marker, and compressed with -compress-llvm-ir-inclusion, which emits the zlib stream under
+// the section name "llvmir.zlib" so consumers can tell the encodings apart.
 //
 // @param [in,out] module : LLVM module to be run on
 bool PatchLlvmIrInclusion::runOnModule(Module &module) {
@@ -68,6 +83,24 @@ bool PatchLlvmIrInclusion::runOnModule(Module &module) {
   llvmIr << *m_module;
   llvmIr.flush();
 
+  if (LlvmIrInclusionMaxSize != 0 && moduleStr.size() > LlvmIrInclusionMaxSize) {
+    // Cap the embedded text so debug-capture builds of very large modules do not double compile memory.
+    const size_t truncatedSize = moduleStr.size() - LlvmIrInclusionMaxSize;
+    moduleStr.resize(LlvmIrInclusionMaxSize);
+    moduleStr += "\n; truncated " + std::to_string(truncatedSize) + " bytes\n";
+  }
+
+  StringRef sectionSuffix = "llvmir";
+  if (CompressLlvmIrInclusion && zlib::isAvailable()) {
+    SmallVector<char, 0> compressed;
+    if (Error err = zlib::compress(moduleStr, compressed))
+      consumeError(std::move(err)); // Fall back to embedding the uncompressed text
+    else {
+      moduleStr.assign(compressed.begin(), compressed.end());
+      sectionSuffix = "llvmir.zlib";
+    }
+  }
+
   auto globalTy = ArrayType::get(Type::getInt8Ty(*m_context), moduleStr.size());
   auto initializer = ConstantDataArray::getString(m_module->getContext(), moduleStr, false);
   auto global = new GlobalVariable(*m_module, globalTy, true, GlobalValue::ExternalLinkage, initializer, "llvmir",
@@ -75,7 +108,7 @@ bool PatchLlvmIrInclusion::runOnModule(Module &module) {
   assert(global);
 
   std::string namePrefix = Util::Abi::AmdGpuCommentName;
-  global->setSection(namePrefix + "llvmir");
+  global->setSection(namePrefix + sectionSuffix.str());
 
   return true;
 }
@@ -31,8 +31,10 @@
 #include "PatchLoadScalarizer.h"
 #include "lgc/state/PipelineShaders.h"
 #include "lgc/state/PipelineState.h"
+#include "llvm/Analysis/LegacyDivergenceAnalysis.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -41,6 +43,13 @@
 using namespace lgc;
 using namespace llvm;
 
+// -lgc-load-scalarizer-cost-model: only scalarize divergent or misaligned vector loads, keeping naturally aligned
+// wide loads intact rather than trusting later passes to re-vectorize them
+static cl::opt<bool> EnableLoadScalarizerCostModel(
+    "lgc-load-scalarizer-cost-model",
+    cl::desc("Only scalarize divergent or misaligned vector loads, keeping naturally aligned wide loads intact"),
+    cl::init(false));
+
 namespace lgc {
 
 // =====================================================================================================================
@@ -56,6 +65,8 @@ FunctionPass *createPatchLoadScalarizer() {
 // =====================================================================================================================
 PatchLoadScalarizer::PatchLoadScalarizer() : FunctionPass(ID) {
   m_scalarThreshold = 0;
+  m_waveSize = 0;
+  m_divergenceAnalysis = nullptr;
 }
 
 // =====================================================================================================================
@@ -65,6 +76,8 @@ PatchLoadScalarizer::PatchLoadScalarizer() : FunctionPass(ID) {
 void PatchLoadScalarizer::getAnalysisUsage(AnalysisUsage &analysisUsage) const {
   analysisUsage.addRequired<PipelineStateWrapper>();
   analysisUsage.addRequired<PipelineShaders>();
+  if (EnableLoadScalarizerCostModel)
+    analysisUsage.addRequired<LegacyDivergenceAnalysis>();
   analysisUsage.addPreserved<PipelineShaders>();
 }
 
@@ -86,6 +99,11 @@ bool PatchLoadScalarizer::runOnFunction(Function &function) {
   if (m_scalarThreshold == 0)
     return false;
 
+  m_waveSize = pipelineState->getShaderWaveSize(shaderStage);
+  m_divergenceAnalysis = nullptr;
+  if (EnableLoadScalarizerCostModel)
+    m_divergenceAnalysis = &getAnalysis<LegacyDivergenceAnalysis>();
+
   m_builder.reset(new IRBuilder<>(function.getContext()));
 
   visit(function);
@@ -135,6 +153,18 @@ void PatchLoadScalarizer::visitLoadInst(LoadInst &loadInst) {
     Type *compTy = cast<VectorType>(loadTy)->getElementType();
     uint64_t compSize = loadInst.getModule()->getDataLayout().getTypeStoreSize(compTy);
 
+    if (m_divergenceAnalysis) {
+      // Cost model mode: keep a naturally aligned wide load intact rather than splitting it and trusting later
+      // passes to re-vectorize, and only scalarize divergent or misaligned loads. On wave32 the memory system
+      // sees half as many lanes per instruction, so narrower vector loads are already worth keeping; on wave64
+      // only a full dwordx4 load is.
+      uint64_t totalSize = compSize * compCount;
+      uint64_t keepSize = m_waveSize == 32 ? 2 * sizeof(unsigned) : 4 * sizeof(unsigned);
+      if (totalSize >= keepSize && totalSize <= 4 * sizeof(unsigned) && loadInst.getAlignment() >= totalSize &&
+          !m_divergenceAnalysis->isDivergent(loadInst.getPointerOperand()))
+        return;
+    }
+
     Value *loadValue = UndefValue::get(loadTy);
     Type *newLoadPtrTy = PointerType::get(compTy, addrSpace);
     SmallVector<Value *, 4> loadComps;
@@ -177,4 +207,6 @@ void PatchLoadScalarizer::visitLoadInst(LoadInst &loadInst) {
 
 // =====================================================================================================================
 // Initializes the pass of LLVM patching operations for load scalarizer optimization.
-INITIALIZE_PASS(PatchLoadScalarizer, DEBUG_TYPE, "Patch LLVM for load scalarizer optimization", false, false)
+INITIALIZE_PASS_BEGIN(PatchLoadScalarizer, DEBUG_TYPE, "Patch LLVM for load scalarizer optimization", false, false)
+INITIALIZE_PASS_DEPENDENCY(LegacyDivergenceAnalysis)
+INITIALIZE_PASS_END(PatchLoadScalarizer, DEBUG_TYPE, "Patch LLVM for load scalarizer optimization", false, false)
@@ -34,6 +34,10 @@
 #include "lgc/patch/Patch.h"
 #include "llvm/IR/InstVisitor.h"
 
+namespace llvm {
+class LegacyDivergenceAnalysis;
+} // namespace llvm
+
 namespace lgc {
 
 // =====================================================================================================================
@@ -53,9 +57,11 @@ private:
   PatchLoadScalarizer(const PatchLoadScalarizer &) = delete;
   PatchLoadScalarizer &operator=(const PatchLoadScalarizer &) = delete;
 
-  llvm::SmallVector<llvm::Instruction *, 8> m_instsToErase; // Instructions to erase
-  std::unique_ptr<llvm::IRBuilder<>> m_builder;             // The IRBuilder.
-  unsigned m_scalarThreshold;                               // The threshold for load scalarizer
+  llvm::SmallVector<llvm::Instruction *, 8> m_instsToErase;  // Instructions to erase
+  std::unique_ptr<llvm::IRBuilder<>> m_builder;              // The IRBuilder.
+  unsigned m_scalarThreshold;                                // The threshold for load scalarizer
+  unsigned m_waveSize;                                       // Wave size of the shader stage being processed
+  llvm::LegacyDivergenceAnalysis *m_divergenceAnalysis;      // The divergence analysis (cost model mode only)
 };
 
 } // namespace lgc
@@ -31,6 +31,7 @@
 #include "lgc/LgcContext.h"
 #include "lgc/patch/Patch.h"
 #include "lgc/state/IntrinsDefs.h"
+#include "lgc/state/PipelineShaders.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/util/Internal.h"
 #include "llvm/ADT/ArrayRef.h"
@@ -55,6 +56,8 @@ public:
 
   void getAnalysisUsage(AnalysisUsage &analysisUsage) const override {
     analysisUsage.addRequired<PipelineStateWrapper>();
+    // The pass registers the fragment shader it adds via updateEntryPoint(), so the analysis stays valid.
+    analysisUsage.addPreserved<PipelineShaders>();
   }
 
   bool runOnModule(Module &module) override;
@@ -134,8 +137,11 @@ bool PatchNullFragShader::runOnModule(Module &module) {
   addTypeMangling(Type::getVoidTy(*m_context), exportArgs, exportName);
   emitCall(exportName, Type::getVoidTy(*m_context), exportArgs, {}, insertPos);
 
-  // Set the shader stage on the new function.
+  // Set the shader stage on the new function, and register it with the PipelineShaders analysis (if it has
+  // been computed) so the analysis stays valid without a rescan.
   setShaderStage(entryPoint, ShaderStageFragment);
+  if (auto pipelineShaders = getAnalysisIfAvailable<PipelineShaders>())
+    pipelineShaders->updateEntryPoint(ShaderStageFragment, entryPoint);
 
   // Initialize shader info.
   auto resUsage = pipelineState->getShaderResourceUsage(ShaderStageFragment);
@@ -76,7 +76,24 @@ PatchPeepholeOpt::PatchPeepholeOpt() : FunctionPass(ID) {
 bool PatchPeepholeOpt::runOnFunction(Function &function) {
   LLVM_DEBUG(dbgs() << "Run the pass Patch-Peephole-Opt\n");
 
-  visit(function);
+  // Seed the worklist with the instruction kinds this pass matches in one scan over the function. Each rewrite
+  // queues the users of its replacement value for reprocessing, so from here on the work done is proportional to
+  // the number of rewrites rather than the size of the function.
+  for (BasicBlock &block : function) {
+    for (Instruction &inst : block)
+      addToWorklist(&inst);
+  }
+
+  while (!m_worklist.empty()) {
+    Instruction *const inst = m_worklist.pop_back_val();
+    m_onWorklist.erase(inst);
+
+    // Skip anything a rewrite has replaced since it was queued; it is only awaiting deletion.
+    if (m_erasedInsts.count(inst) > 0)
+      continue;
+
+    visit(*inst);
+  }
 
   const bool changed = !m_instsToErase.empty();
 
@@ -85,6 +102,7 @@ bool PatchPeepholeOpt::runOnFunction(Function &function) {
     inst->eraseFromParent();
   }
   m_instsToErase.clear();
+  m_erasedInsts.clear();
 
   return changed;
 }
@@ -160,8 +178,11 @@ void PatchPeepholeOpt::visitBitCast(BitCastInst &bitCast) {
         otherBitCast->replaceAllUsesWith(&bitCast);
 
         // Lastly remember to delete the bit cast we just replaced.
-        m_instsToErase.push_back(otherBitCast);
+        eraseLater(*otherBitCast);
       }
+
+      // The users of the combined bit casts now all use ours; queue them for reprocessing.
+      addUsersToWorklist(bitCast);
     }
   }
 
@@ -194,13 +215,14 @@ void PatchPeepholeOpt::visitBitCast(BitCastInst &bitCast) {
 
     // Replace the bit cast with the new shuffle vector.
     bitCast.replaceAllUsesWith(newShuffleVector);
+    addUsersToWorklist(*newShuffleVector);
 
     // Lastly remember to delete the bit cast we just replaced.
-    m_instsToErase.push_back(&bitCast);
+    eraseLater(bitCast);
 
-    // Visit the bit cast instructions we just inserted in case there are optimization opportunities.
-    visitBitCast(*bitCastLhs);
-    visitBitCast(*bitCastRhs);
+    // Queue the bit cast instructions we just inserted in case there are optimization opportunities.
+    addToWorklist(bitCastLhs);
+    addToWorklist(bitCastRhs);
 
     return;
   }
@@ -237,9 +259,11 @@ void PatchPeepholeOpt::visitBitCast(BitCastInst &bitCast) {
 
     // Replace the bit cast with the new PHI node.
     bitCast.replaceAllUsesWith(newPhiNode);
+    addUsersToWorklist(*newPhiNode);
+    addToWorklist(newPhiNode);
 
     // Lastly remember to delete the bit cast we just replaced.
-    m_instsToErase.push_back(&bitCast);
+    eraseLater(bitCast);
 
     // If the PHI node that we've just replaced had any other users, make a bit cast for them.
     if (!phiNode->hasOneUse()) {
@@ -248,13 +272,14 @@ void PatchPeepholeOpt::visitBitCast(BitCastInst &bitCast) {
       insertAfter(*newBitCast, *newPhiNode);
 
       phiNode->replaceAllUsesWith(newBitCast);
+      addUsersToWorklist(*newBitCast);
 
-      // Visit the bit cast instructions we just inserted in case there are optimization opportunities.
-      visitBitCast(*newBitCast);
+      // Queue the bit cast instruction we just inserted in case there are optimization opportunities.
+      addToWorklist(newBitCast);
     }
 
     // Lastly remember to delete the PHI node we just replaced.
-    m_instsToErase.push_back(phiNode);
+    eraseLater(*phiNode);
 
     return;
   }
@@ -317,6 +342,9 @@ void PatchPeepholeOpt::visitICmp(ICmpInst &iCmp) {
         inst->setOperand(operandIndex, iCmpNot);
     }
   }
+
+  // The former users of the comparison now go through the not; queue them for reprocessing.
+  addUsersToWorklist(*iCmpNot);
 }
 
 // =====================================================================================================================
@@ -353,9 +381,10 @@ void PatchPeepholeOpt::visitExtractElement(ExtractElementInst &extractElement) {
     // If the index of the insertion matches the index we were extracting, forward the insert!
     if (nextIndex->equalsInt(index)) {
       extractElement.replaceAllUsesWith(nextInsertElement->getOperand(1));
+      addUsersToWorklist(*nextInsertElement->getOperand(1));
 
       // Lastly remember to delete the extract we just replaced.
-      m_instsToErase.push_back(&extractElement);
+      eraseLater(extractElement);
 
       return;
     }
@@ -432,9 +461,13 @@ void PatchPeepholeOpt::visitExtractElement(ExtractElementInst &extractElement) {
         otherExtractElement->replaceAllUsesWith(newExtractElement);
 
         // Lastly remember to delete the extract we just replaced.
-        m_instsToErase.push_back(otherExtractElement);
+        eraseLater(*otherExtractElement);
       }
 
+      // The users of the combined extractions now all use the new one; queue them for reprocessing.
+      addUsersToWorklist(*newExtractElement);
+      addToWorklist(newExtractElement);
+
       return;
     }
   }
@@ -478,6 +511,7 @@ void PatchPeepholeOpt::visitPHINode(PHINode &phiNode) {
       PHINode *const newPhiNode =
           PHINode::Create(elementType, numIncomings, phiNode.getName() + "." + Twine(elementIndex));
       insertAfter(*newPhiNode, phiNode);
+      addToWorklist(newPhiNode);
 
       result = InsertElementInst::Create(result, newPhiNode, elementIndexVal, "", insertPos);
 
@@ -519,9 +553,10 @@ void PatchPeepholeOpt::visitPHINode(PHINode &phiNode) {
 
     // Replace all the users of the original PHI node with the new nodes combined using insertions.
     phiNode.replaceAllUsesWith(result);
+    addUsersToWorklist(*result);
 
     // Lastly remember the phi so we can delete it later when it is safe to do so.
-    m_instsToErase.push_back(&phiNode);
+    eraseLater(phiNode);
 
     return;
   }
@@ -564,9 +599,11 @@ void PatchPeepholeOpt::visitPHINode(PHINode &phiNode) {
 
     // Replace all the users of the original PHI node with the incoming value that each incoming references.
     phiNode.replaceAllUsesWith(newInst);
+    addUsersToWorklist(*newInst);
+    addToWorklist(newInst);
 
     // Lastly remember the phi so we can delete it later when it is safe to do so.
-    m_instsToErase.push_back(&phiNode);
+    eraseLater(phiNode);
 
     return;
   }
@@ -649,10 +686,12 @@ void PatchPeepholeOpt::visitPHINode(PHINode &phiNode) {
             // Both our PHI's are actually identical! Optimize away.
             otherPhiNode->replaceAllUsesWith(&phiNode);
             otherSubPhiNode->replaceAllUsesWith(subPhiNode);
+            addUsersToWorklist(phiNode);
+            addUsersToWorklist(*subPhiNode);
 
             // Lastly remember the phis so we can delete them later when it is safe to do so.
-            m_instsToErase.push_back(otherPhiNode);
-            m_instsToErase.push_back(otherSubPhiNode);
+            eraseLater(*otherPhiNode);
+            eraseLater(*otherSubPhiNode);
           }
         }
       }
@@ -660,6 +699,42 @@ void PatchPeepholeOpt::visitPHINode(PHINode &phiNode) {
   }
 }
 
+// =====================================================================================================================
+// Adds an instruction to the worklist if it is one of the kinds this pass matches and is not already queued or
+// awaiting deletion.
+//
+// @param inst : Instruction to queue.
+void PatchPeepholeOpt::addToWorklist(Instruction *inst) {
+  if (!isa<BitCastInst>(inst) && !isa<ICmpInst>(inst) && !isa<ExtractElementInst>(inst) && !isa<PHINode>(inst))
+    return;
+
+  if (m_erasedInsts.count(inst) > 0)
+    return;
+
+  if (m_onWorklist.insert(inst).second)
+    m_worklist.push_back(inst);
+}
+
+// =====================================================================================================================
+// Adds the users of a value to the worklist, so they get reprocessed after the value replaced another one.
+//
+// @param value : Value whose users should be reprocessed.
+void PatchPeepholeOpt::addUsersToWorklist(Value &value) {
+  for (User *const user : value.users()) {
+    if (Instruction *const inst = dyn_cast<Instruction>(user))
+      addToWorklist(inst);
+  }
+}
+
+// =====================================================================================================================
+// Schedules a replaced instruction for deletion at the end of the run, and excludes it from further visits.
+//
+// @param inst : Instruction to delete later.
+void PatchPeepholeOpt::eraseLater(Instruction &inst) {
+  m_instsToErase.push_back(&inst);
+  m_erasedInsts.insert(&inst);
+}
+
 // =====================================================================================================================
 // Helper function to move an instruction after another.
 //
@@ -31,6 +31,7 @@
 #pragma once
 
 #include "lgc/util/Internal.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/IR/InstVisitor.h"
 #include "llvm/Pass.h"
 
@@ -51,6 +52,10 @@ namespace lgc {
 //   multiple extract elements that are identical).
 // - Optimize PHI nodes that are confusingly non-PHIs by deducing these complicated cases and removing the PHIs.
 //
+// The pass is worklist driven: one initial scan seeds the worklist with the instruction kinds matched above, and
+// each rewrite queues the users of the replacement value for reprocessing, so repeat schedulings of the pass cost
+// in proportion to the number of rewrites they perform rather than the size of the function.
+//
 class PatchPeepholeOpt final : public llvm::FunctionPass, public llvm::InstVisitor<PatchPeepholeOpt> {
 public:
   PatchPeepholeOpt();
@@ -73,7 +78,14 @@ private:
   PatchPeepholeOpt(const PatchPeepholeOpt &) = delete;
   PatchPeepholeOpt &operator=(const PatchPeepholeOpt &) = delete;
 
+  void addToWorklist(llvm::Instruction *inst);
+  void addUsersToWorklist(llvm::Value &value);
+  void eraseLater(llvm::Instruction &inst);
+
   llvm::SmallVector<llvm::Instruction *, 8> m_instsToErase;
+  llvm::SmallVector<llvm::Instruction *, 32> m_worklist;    // Instructions still to be (re)visited
+  llvm::DenseSet<llvm::Instruction *> m_onWorklist;         // Instructions currently on the worklist
+  llvm::DenseSet<llvm::Instruction *> m_erasedInsts;        // Replaced instructions awaiting deletion
 };
 
 } // namespace lgc
@@ -28,7 +28,9 @@
 * @brief LLPC source file: contains declaration and implementation of class lgc::PatchPreparePipelineAbi.
 ***********************************************************************************************************************
 */
+#ifdef LLPC_BUILD_GFX6
 #include "Gfx6ConfigBuilder.h"
+#endif
 #include "Gfx9ConfigBuilder.h"
 #include "ShaderMerger.h"
 #include "lgc/patch/Patch.h"
@@ -59,6 +61,8 @@ public:
   void getAnalysisUsage(AnalysisUsage &analysisUsage) const override {
     analysisUsage.addRequired<PipelineStateWrapper>();
     analysisUsage.addRequired<PipelineShaders>();
+    // ShaderMerger re-registers merged entry-points via updateEntryPoint(), so the analysis stays valid.
+    analysisUsage.addPreserved<PipelineShaders>();
   }
 
 private:
@@ -336,8 +340,13 @@ void PatchPreparePipelineAbi::setAbiEntryNames(Module &module) {
 // @param module : LLVM module
 void PatchPreparePipelineAbi::addAbiMetadata(Module &module) {
   if (m_gfxIp.major <= 8) {
+#ifdef LLPC_BUILD_GFX6
     Gfx6::ConfigBuilder configBuilder(&module, m_pipelineState);
     configBuilder.buildPalMetadata();
+#else
+    // GFX6-GFX8 targets are already rejected by TargetInfo::setTargetInfo in this configuration.
+    report_fatal_error("Compiler was built without GFX6-GFX8 support");
+#endif
   } else {
     Gfx9::ConfigBuilder configBuilder(&module, m_pipelineState);
     configBuilder.buildPalMetadata();
@@ -53,6 +53,12 @@ using namespace lgc;
 // -disable-gs-onchip: disable geometry shader on-chip mode
 cl::opt<bool> DisableGsOnChip("disable-gs-onchip", cl::desc("Disable geometry shader on-chip mode"), cl::init(false));
 
+// -disable-const-varying-prop: disable propagation of constant outputs into the fragment shader
+static cl::opt<bool> DisableConstVaryingProp("disable-const-varying-prop",
+                                             cl::desc("Disable propagation of constant outputs into the fragment "
+                                                      "shader"),
+                                             cl::init(false));
+
 namespace lgc {
 
 // =====================================================================================================================
@@ -86,6 +92,15 @@ bool PatchResourceCollect::runOnModule(Module &module) {
   if (m_pipelineState->isPackInOut())
     scalarizeForInOutPacking(&module);
 
+  // Propagate constant outputs of the last vertex processing stage directly into the fragment shader, so the
+  // varyings they fed can be deleted by the inactive input/output cleanup below.
+  if (m_pipelineState->isGraphics() && !m_pipelineState->isUnlinked() && !DisableConstVaryingProp)
+    propagateConstantOutputs(&module);
+
+  // Gather the in/out import/export calls of each shader stage up front, so processing a shader only looks at
+  // the calls it is interested in rather than walking every instruction.
+  collectInOutCalls(&module);
+
   // Process each shader stage, in reverse order.
   for (int shaderStage = ShaderStageCountInternal - 1; shaderStage >= 0; --shaderStage) {
     m_entryPoint = m_pipelineShaders->getEntryPoint(static_cast<ShaderStage>(shaderStage));
@@ -1007,6 +1022,34 @@ unsigned PatchResourceCollect::getVerticesPerPrimitive() const {
   return vertsPerPrim;
 }
 
+// =====================================================================================================================
+// Collects the input/output import/export calls of each shader stage, from the use lists of the matching function
+// declarations. These are the only calls processShader() is interested in, so gathering them this way saves
+// walking every instruction of every shader.
+//
+// @param module : LLVM module to be run on
+void PatchResourceCollect::collectInOutCalls(Module *module) {
+  for (Function &func : *module) {
+    if (!func.isDeclaration())
+      continue;
+    auto mangledName = func.getName();
+    if (!mangledName.startswith(lgcName::InputImportGeneric) &&
+        !mangledName.startswith(lgcName::InputImportInterpolant) &&
+        !mangledName.startswith(lgcName::InputImportBuiltIn) &&
+        !mangledName.startswith(lgcName::OutputImportGeneric) &&
+        !mangledName.startswith(lgcName::OutputImportBuiltIn) &&
+        !mangledName.startswith(lgcName::OutputExportGeneric) &&
+        !mangledName.startswith(lgcName::OutputExportBuiltIn))
+      continue;
+    for (User *const user : func.users()) {
+      auto call = cast<CallInst>(user);
+      ShaderStage shaderStage = m_pipelineShaders->getShaderStage(call->getFunction());
+      if (shaderStage != ShaderStageInvalid)
+        m_stageCalls[shaderStage].push_back(call);
+    }
+  }
+}
+
 // =====================================================================================================================
 // Process a single shader
 void PatchResourceCollect::processShader() {
@@ -1014,8 +1057,9 @@ void PatchResourceCollect::processShader() {
   m_hasDynIndexedOutput = false;
   m_resUsage = m_pipelineState->getShaderResourceUsage(m_shaderStage);
 
-  // Invoke handling of "call" instruction
-  visit(m_entryPoint);
+  // Invoke handling of the gathered in/out import/export calls of this shader
+  for (CallInst *call : m_stageCalls[m_shaderStage])
+    visitCallInst(*call);
 
   clearInactiveInput();
   clearInactiveOutput();
@@ -1080,7 +1124,7 @@ bool PatchResourceCollect::isVertexReuseDisabled() {
 }
 
 // =====================================================================================================================
-// Visits "call" instruction.
+// Handles one input/output import/export call of the shader stage being processed.
 //
 // @param callInst : "Call" instruction
 void PatchResourceCollect::visitCallInst(CallInst &callInst) {
@@ -1552,6 +1596,151 @@ void PatchResourceCollect::clearInactiveOutput() {
   }
 }
 
+// =====================================================================================================================
+// Checks whether the given constant passes through attribute interpolation unchanged, making it safe to substitute
+// directly for a fragment shader input. Finite values interpolate to themselves because the barycentric weights sum
+// to one; infinities and NaNs would be disturbed by the multiply-add evaluation in hardware.
+//
+// @param value : Constant written by the producer stage
+static bool isInterpolationInvariant(const Constant *value) {
+  if (auto vectorTy = dyn_cast<VectorType>(value->getType())) {
+    for (unsigned elem = 0; elem != vectorTy->getNumElements(); ++elem) {
+      auto element = value->getAggregateElement(elem);
+      if (!element || !isInterpolationInvariant(element))
+        return false;
+    }
+    return true;
+  }
+  if (auto floatValue = dyn_cast<ConstantFP>(value))
+    return floatValue->getValueAPF().isFinite();
+  return isa<ConstantInt>(value) || isa<UndefValue>(value);
+}
+
+// =====================================================================================================================
+// Propagates constant outputs of the last vertex processing stage directly into the fragment shader.
+//
+// A varying whose producer writes a compile-time constant costs the consumer an interpolated attribute for a value
+// already known here at compile time. Substitute the constant for the fragment shader's import and delete the
+// export; the location then looks unused to the inactive input/output cleanup and location mapping that run
+// afterwards, so the varying disappears from the parameter cache entirely.
+//
+// Only a VS or TES producer is handled; GS outputs carry stream info and are left alone. Transform feedback is
+// unaffected, as it goes through separate lgc.output.export.xfb calls.
+//
+// @param [in/out] module : LLVM module to be run on
+void PatchResourceCollect::propagateConstantOutputs(Module *module) {
+  if (!m_pipelineState->hasShaderStage(ShaderStageFragment))
+    return;
+  const ShaderStage producerStage = m_pipelineState->getPrevShaderStage(ShaderStageFragment);
+  if (producerStage != ShaderStageVertex && producerStage != ShaderStageTessEval)
+    return;
+
+  // Gather the fragment shader's generic imports and the producer's generic exports of each location.
+  struct LocationUse {
+    SmallVector<CallInst *, 4> imports; // FS generic input imports of the location
+    SmallVector<CallInst *, 4> exports; // Producer generic output exports of the location
+    bool unsupported = false;           // Location cannot be handled (aliased or dynamically addressed)
+  };
+  std::map<unsigned, LocationUse> locUses;
+
+  for (Function &func : *module) {
+    if (!func.isDeclaration())
+      continue;
+    auto mangledName = func.getName();
+    if (mangledName.startswith(lgcName::InputImportGeneric)) {
+      for (User *user : func.users()) {
+        auto call = cast<CallInst>(user);
+        if (m_pipelineShaders->getShaderStage(call->getFunction()) != ShaderStageFragment)
+          continue;
+        // FS: @llpc.input.import.generic.%Type%(i32 location, i32 elemIdx, i32 interpMode, i32 interpLoc)
+        unsigned loc = cast<ConstantInt>(call->getOperand(0))->getZExtValue();
+        auto &locUse = locUses[loc];
+        if (!isa<ConstantInt>(call->getOperand(1)))
+          locUse.unsupported = true;
+        locUse.imports.push_back(call);
+      }
+    } else if (mangledName.startswith(lgcName::InputImportInterpolant)) {
+      for (User *user : func.users()) {
+        auto call = cast<CallInst>(user);
+        if (m_pipelineShaders->getShaderStage(call->getFunction()) != ShaderStageFragment)
+          continue;
+        // Custom interpolation addresses the attribute at other than the pixel's own barycentrics; leave any
+        // location it touches alone. A non-constant location offset can touch anything, so give up entirely.
+        auto locOffset = dyn_cast<ConstantInt>(call->getOperand(1));
+        if (!locOffset)
+          return;
+        unsigned loc = cast<ConstantInt>(call->getOperand(0))->getZExtValue() + locOffset->getZExtValue();
+        locUses[loc].unsupported = true;
+      }
+    } else if (mangledName.startswith(lgcName::OutputExportGeneric)) {
+      for (User *user : func.users()) {
+        auto call = cast<CallInst>(user);
+        if (m_pipelineShaders->getShaderStage(call->getFunction()) != producerStage)
+          continue;
+        // VS/TES: @llpc.output.export.generic.%Type%(i32 location, i32 elemIdx, %Type% outputValue)
+        unsigned loc = cast<ConstantInt>(call->getOperand(0))->getZExtValue();
+        auto &locUse = locUses[loc];
+        if (!isa<ConstantInt>(call->getOperand(1)))
+          locUse.unsupported = true;
+        locUse.exports.push_back(call);
+      }
+    }
+  }
+
+  for (auto &locUseEntry : locUses) {
+    LocationUse &locUse = locUseEntry.second;
+    if (locUse.unsupported || locUse.imports.empty() || locUse.exports.empty())
+      continue;
+
+    // Every export of the location must be a unique per-element interpolation-invariant constant occupying a
+    // single location, so imports and exports can be matched up by element index alone.
+    bool qualified = true;
+    DenseMap<unsigned, CallInst *> exportsByElem;
+    for (CallInst *exportCall : locUse.exports) {
+      auto output = dyn_cast<Constant>(exportCall->getOperand(exportCall->getNumArgOperands() - 1));
+      if (!output || !isInterpolationInvariant(output) || output->getType()->getScalarSizeInBits() > 32 ||
+          output->getType()->getPrimitiveSizeInBits() > (8 * SizeOfVec4)) {
+        qualified = false;
+        break;
+      }
+      unsigned elemIdx = cast<ConstantInt>(exportCall->getOperand(1))->getZExtValue();
+      if (!exportsByElem.insert({elemIdx, exportCall}).second) {
+        // The element is written more than once, so the value reaching the consumer is ambiguous.
+        qualified = false;
+        break;
+      }
+    }
+    if (qualified) {
+      // Every import must read exactly the footprint of one of the constant exports.
+      for (CallInst *importCall : locUse.imports) {
+        unsigned elemIdx = cast<ConstantInt>(importCall->getOperand(1))->getZExtValue();
+        auto exportIt = exportsByElem.find(elemIdx);
+        if (exportIt == exportsByElem.end() ||
+            exportIt->second->getOperand(exportIt->second->getNumArgOperands() - 1)->getType() !=
+                importCall->getType()) {
+          qualified = false;
+          break;
+        }
+      }
+    }
+    if (!qualified)
+      continue;
+
+    // Substitute the constants and delete the varying's calls on both sides. The location is now unused, so the
+    // inactive input/output cleanup and location mapping later in this pass drop it from the maps.
+    for (CallInst *importCall : locUse.imports) {
+      unsigned elemIdx = cast<ConstantInt>(importCall->getOperand(1))->getZExtValue();
+      CallInst *exportCall = exportsByElem[elemIdx];
+      importCall->replaceAllUsesWith(exportCall->getOperand(exportCall->getNumArgOperands() - 1));
+      importCall->eraseFromParent();
+    }
+    for (CallInst *exportCall : locUse.exports) {
+      exportCall->dropAllReferences();
+      exportCall->eraseFromParent();
+    }
+  }
+}
+
 // =====================================================================================================================
 // Does generic input/output matching and does location mapping afterwards.
 //
@@ -2574,8 +2763,9 @@ void PatchResourceCollect::fillInOutLocMap() {
 
     // Get the packed InOutLocation from locationMap
     const InOutLocation *newInLoc = nullptr;
-    assert(m_locationMapManager->findMap(origInLoc, newInLoc));
-    m_locationMapManager->findMap(origInLoc, newInLoc);
+    bool foundMap = m_locationMapManager->findMap(origInLoc, newInLoc);
+    assert(foundMap);
+    ((void)foundMap);
 
     // TODO: inputLocMap can be removed
     inputLocMap[newInLoc->locationInfo.location] = InvalidValue;
@@ -2953,8 +3143,7 @@ void InOutLocationMapManager::buildLocationMap() {
     // Increase consectiveLocation when a vec4 is full or the span isn't compatible to previous
     // Otherwise, increase the compIdx in a packed vector
     if (spanIt != m_locationSpans.begin()) {
-      const auto &prevSpan = *(--spanIt);
-      ++spanIt;
+      const auto &prevSpan = *std::prev(spanIt);
       if (!isCompatible(prevSpan, *spanIt) || compIdx > 3) {
         ++consectiveLocation;
         compIdx = 0;
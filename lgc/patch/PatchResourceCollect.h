@@ -33,7 +33,6 @@
 #include "lgc/patch/Patch.h"
 #include "lgc/state/PipelineShaders.h"
 #include "lgc/state/PipelineState.h"
-#include "llvm/IR/InstVisitor.h"
 #include <unordered_set>
 
 namespace lgc {
@@ -44,7 +43,7 @@ class InOutLocationMapManager;
 
 // =====================================================================================================================
 // Represents the pass of LLVM patching opertions for resource collecting
-class PatchResourceCollect : public Patch, public llvm::InstVisitor<PatchResourceCollect> {
+class PatchResourceCollect : public Patch {
 public:
   PatchResourceCollect();
 
@@ -55,7 +54,6 @@ public:
   }
 
   virtual bool runOnModule(llvm::Module &module) override;
-  virtual void visitCallInst(llvm::CallInst &callInst);
 
   static char ID; // ID of this pass
 
@@ -63,6 +61,12 @@ private:
   PatchResourceCollect(const PatchResourceCollect &) = delete;
   PatchResourceCollect &operator=(const PatchResourceCollect &) = delete;
 
+  // Gathers the input/output import/export calls of each shader stage
+  void collectInOutCalls(llvm::Module *module);
+
+  // Handles one input/output import/export call of the shader stage being processed
+  void visitCallInst(llvm::CallInst &callInst);
+
   // Determines whether GS on-chip mode is valid for this pipeline, also computes ES-GS/GS-VS ring item size.
   bool checkGsOnChipValidity();
 
@@ -79,6 +83,9 @@ private:
   void clearInactiveInput();
   void clearInactiveOutput();
 
+  // Cross-stage propagation of constant outputs into the fragment shader
+  void propagateConstantOutputs(llvm::Module *module);
+
   void matchGenericInOut();
   void mapBuiltInToGenericInOut();
 
@@ -108,6 +115,8 @@ private:
 
   std::vector<llvm::CallInst *> m_inOutCalls; // The import or export calls
 
+  std::vector<llvm::CallInst *> m_stageCalls[ShaderStageCountInternal]; // In/out import/export calls of each stage
+
   bool m_hasDynIndexedInput;  // Whether dynamic indices are used in generic input addressing (valid
                               // for tessellation shader, fragment shader with input interpolation)
   bool m_hasDynIndexedOutput; // Whether dynamic indices are used in generic output addressing (valid
@@ -28,6 +28,7 @@
 * @brief LLPC source file: contains declaration and implementation of class lgc::PatchSetupTargetFeatures.
 ***********************************************************************************************************************
 */
+#include "lgc/LgcContext.h"
 #include "lgc/patch/Patch.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
@@ -95,14 +96,10 @@ bool PatchSetupTargetFeatures::runOnModule(Module &module) {
 //
 // @param [in, out] module : LLVM module
 void PatchSetupTargetFeatures::setupTargetFeatures(Module *module) {
-  std::string globalFeatures = "";
-
-  if (m_pipelineState->getOptions().includeDisassembly)
-    globalFeatures += ",+DumpCode";
+  const bool includeDisassembly = m_pipelineState->getOptions().includeDisassembly;
 
   for (auto func = module->begin(), end = module->end(); func != end; ++func) {
     if (!func->empty() && func->getLinkage() == GlobalValue::ExternalLinkage) {
-      std::string targetFeatures(globalFeatures);
       AttrBuilder builder;
 
       ShaderStage shaderStage = getShaderStageFromCallingConv(func->getCallingConv());
@@ -111,16 +108,13 @@ void PatchSetupTargetFeatures::setupTargetFeatures(Module *module) {
       if (useSiScheduler) {
         // It was found that enabling both SIScheduler and SIFormClauses was bad on one particular
         // game. So we disable the latter here. That only affects XNACK targets.
-        targetFeatures += ",+si-scheduler";
         builder.addAttribute("amdgpu-max-memory-clause", "1");
       }
 
+      bool enableDs128 = false;
       if (func->getCallingConv() == CallingConv::AMDGPU_GS) {
-        // NOTE: For NGG primitive shader, enable 128-bit LDS load/store operations to optimize gvec4 data
-        // read/write. This usage must enable the feature of using CI+ additional instructions.
         const auto nggControl = m_pipelineState->getNggControl();
-        if (nggControl->enableNgg && !nggControl->passthroughMode)
-          targetFeatures += ",+ci-insts,+enable-ds128";
+        enableDs128 = nggControl->enableNgg && !nggControl->passthroughMode;
       }
 
       if (func->getCallingConv() == CallingConv::AMDGPU_HS) {
@@ -137,19 +131,7 @@ void PatchSetupTargetFeatures::setupTargetFeatures(Module *module) {
       }
 
       auto gfxIp = m_pipelineState->getTargetInfo().getGfxIpVersion();
-      if (gfxIp.major >= 9)
-        targetFeatures += ",+enable-scratch-bounds-checks";
-
-      if (gfxIp.major >= 10) {
-        // Setup wavefront size per shader stage
-        unsigned waveSize = m_pipelineState->getShaderWaveSize(shaderStage);
-
-        targetFeatures += ",+wavefrontsize" + std::to_string(waveSize);
-
-        // Allow driver setting for WGP by forcing backend to set 0
-        // which is then OR'ed with the driver set value
-        targetFeatures += ",+cumode";
-      }
+      const unsigned waveSize = gfxIp.major >= 10 ? m_pipelineState->getShaderWaveSize(shaderStage) : 0;
 
       // Set up denormal mode attributes.
 
@@ -178,7 +160,10 @@ void PatchSetupTargetFeatures::setupTargetFeatures(Module *module) {
         }
       }
 
-      builder.addAttribute("target-features", targetFeatures);
+      // The composed feature string only depends on a few bits of state, so it is cached in the LgcContext
+      // rather than reformatted per entry-point; the attribute itself is uniqued by the LLVMContext.
+      builder.addAttribute("target-features", m_pipelineState->getLgcContext()->getTargetFeatureString(
+                                                  waveSize, includeDisassembly, useSiScheduler, enableDs128));
       AttributeList::AttrIndex attribIdx = AttributeList::AttrIndex(AttributeList::FunctionIndex);
       func->addAttributes(attribIdx, builder);
     }
@@ -30,6 +30,7 @@
  */
 #include "ShaderMerger.h"
 #include "NggPrimShader.h"
+#include "lgc/LgcContext.h"
 #include "lgc/patch/Patch.h"
 #include "lgc/state/PipelineShaders.h"
 #include "lgc/state/PipelineState.h"
@@ -37,18 +38,28 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 
 #define DEBUG_TYPE "lgc-shader-merger"
 
 using namespace llvm;
 using namespace lgc;
 
+// Names of the placeholder declarations the cached entry glue calls; they are replaced by the real shader
+// bodies when the glue is copied into a pipeline module.
+static const char LsGlueBodyName[] = "lgc.shadermerger.glue.ls";
+static const char HsGlueBodyName[] = "lgc.shadermerger.glue.hs";
+static const char EsGlueBodyName[] = "lgc.shadermerger.glue.es";
+static const char GsGlueBodyName[] = "lgc.shadermerger.glue.gs";
+
 // =====================================================================================================================
 //
 // @param pipelineState : Pipeline state
 // @param pipelineShaders : API shaders in the pipeline
 ShaderMerger::ShaderMerger(PipelineState *pipelineState, PipelineShaders *pipelineShaders)
-    : m_pipelineState(pipelineState), m_context(&pipelineState->getContext()),
+    : m_pipelineState(pipelineState), m_pipelineShaders(pipelineShaders), m_context(&pipelineState->getContext()),
       m_gfxIp(pipelineState->getTargetInfo().getGfxIpVersion()), m_primShader(pipelineState) {
   assert(m_gfxIp.major >= 9);
   assert(m_pipelineState->isGraphics());
@@ -68,7 +79,25 @@ ShaderMerger::ShaderMerger(PipelineState *pipelineState, PipelineShaders *pipeli
 Function *ShaderMerger::buildPrimShader(Function *esEntryPoint, Function *gsEntryPoint,
                                         Function *copyShaderEntryPoint) {
   NggPrimShader primShader(m_pipelineState);
-  return primShader.generate(esEntryPoint, gsEntryPoint, copyShaderEntryPoint);
+  Function *primShaderEntryPoint = primShader.generate(esEntryPoint, gsEntryPoint, copyShaderEntryPoint);
+  registerMergedEntryPoint(esEntryPoint, primShaderEntryPoint);
+  registerMergedEntryPoint(gsEntryPoint, primShaderEntryPoint);
+  registerMergedEntryPoint(copyShaderEntryPoint, primShaderEntryPoint);
+  return primShaderEntryPoint;
+}
+
+// =====================================================================================================================
+// Re-registers a merged-away entry-point's stage against the merged entry-point in the PipelineShaders analysis,
+// so the analysis stays valid without rescanning the module.
+//
+// @param oldEntryPoint : Entry-point absorbed into the merged shader (could be null)
+// @param mergedEntryPoint : Entry-point of the merged shader
+void ShaderMerger::registerMergedEntryPoint(Function *oldEntryPoint, Function *mergedEntryPoint) {
+  if (!oldEntryPoint)
+    return;
+  ShaderStage stage = m_pipelineShaders->getShaderStage(oldEntryPoint);
+  if (stage != ShaderStageInvalid)
+    m_pipelineShaders->updateEntryPoint(stage, mergedEntryPoint);
 }
 
 // =====================================================================================================================
@@ -127,6 +156,10 @@ FunctionType *ShaderMerger::generateLsHsEntryPointType(uint64_t *inRegMask) cons
 // =====================================================================================================================
 // Generates the new entry-point for LS-HS merged shader.
 //
+// The entry glue depends only on the glue configuration (see getGlueKey), not on the shader bodies, so it is
+// built once per configuration into a module cached on the LgcContext and copied into each pipeline module,
+// with the placeholder body declarations replaced by the real LS/HS entry-points.
+//
 // @param lsEntryPoint : Entry-point of hardware local shader (LS) (could be null)
 // @param hsEntryPoint : Entry-point of hardware hull shader (HS)
 Function *ShaderMerger::generateLsHsEntryPoint(Function *lsEntryPoint, Function *hsEntryPoint) {
@@ -139,13 +172,51 @@ Function *ShaderMerger::generateLsHsEntryPoint(Function *lsEntryPoint, Function
   hsEntryPoint->setLinkage(GlobalValue::InternalLinkage);
   hsEntryPoint->addFnAttr(Attribute::AlwaysInline);
 
+  // NOTE: Generating the entry-point type may assign a spill table user data slot, so it must run even when
+  // the glue itself comes from the cache.
   uint64_t inRegMask = 0;
   auto entryPointTy = generateLsHsEntryPointType(&inRegMask);
 
-  // Create the entrypoint for the merged shader, and insert it just before the old HS.
-  Function *entryPoint = Function::Create(entryPointTy, GlobalValue::ExternalLinkage, lgcName::LsHsEntryPoint);
-  auto module = hsEntryPoint->getParent();
-  module->getFunctionList().insert(hsEntryPoint->getIterator(), entryPoint);
+  Module *glueModule = m_pipelineState->getLgcContext()->getGlueModule(
+      getGlueKey(/*lsHs=*/true, entryPointTy, lsEntryPoint, hsEntryPoint),
+      [&]() { return buildLsHsGlueModule(entryPointTy, inRegMask, lsEntryPoint, hsEntryPoint); });
+
+  Function *lsHsEntryPoint = copyGlueEntryPoint(glueModule, lgcName::LsHsEntryPoint, LsGlueBodyName, lsEntryPoint,
+                                                HsGlueBodyName, hsEntryPoint, hsEntryPoint);
+  registerMergedEntryPoint(lsEntryPoint, lsHsEntryPoint);
+  registerMergedEntryPoint(hsEntryPoint, lsHsEntryPoint);
+  return lsHsEntryPoint;
+}
+
+// =====================================================================================================================
+// Builds the module holding the LS-HS merged shader entry glue for the current configuration. The LS/HS bodies
+// are represented by placeholder declarations carrying the real entry-points' types and attributes.
+//
+// @param entryPointTy : Type of the merged-shader entry-point
+// @param inRegMask : "Inreg" bit mask for the entry-point arguments
+// @param lsEntryPoint : Entry-point of hardware local shader (LS) (could be null)
+// @param hsEntryPoint : Entry-point of hardware hull shader (HS)
+std::unique_ptr<Module> ShaderMerger::buildLsHsGlueModule(FunctionType *entryPointTy, uint64_t inRegMask,
+                                                          Function *lsEntryPoint, Function *hsEntryPoint) {
+  auto glueModule = std::make_unique<Module>("lsHsGlue", *m_context);
+  glueModule->setTargetTriple(hsEntryPoint->getParent()->getTargetTriple());
+  glueModule->setDataLayout(hsEntryPoint->getParent()->getDataLayout());
+
+  // From here on, build against the placeholder declarations rather than the real entry-points.
+  if (lsEntryPoint) {
+    auto lsBody =
+        Function::Create(lsEntryPoint->getFunctionType(), GlobalValue::ExternalLinkage, LsGlueBodyName, &*glueModule);
+    lsBody->setAttributes(lsEntryPoint->getAttributes());
+    lsEntryPoint = lsBody;
+  }
+
+  auto hsBody =
+      Function::Create(hsEntryPoint->getFunctionType(), GlobalValue::ExternalLinkage, HsGlueBodyName, &*glueModule);
+  hsBody->setAttributes(hsEntryPoint->getAttributes());
+  hsEntryPoint = hsBody;
+
+  Function *entryPoint =
+      Function::Create(entryPointTy, GlobalValue::ExternalLinkage, lgcName::LsHsEntryPoint, &*glueModule);
 
   entryPoint->addFnAttr("amdgpu-flat-work-group-size",
                         "128,128"); // Force s_barrier to be present (ignore optimization)
@@ -450,7 +521,7 @@ Function *ShaderMerger::generateLsHsEntryPoint(Function *lsEntryPoint, Function
   // Construct ".endhs" block
   ReturnInst::Create(*m_context, endHsBlock);
 
-  return entryPoint;
+  return glueModule;
 }
 
 // =====================================================================================================================
@@ -535,6 +606,10 @@ FunctionType *ShaderMerger::generateEsGsEntryPointType(uint64_t *inRegMask) cons
 // =====================================================================================================================
 // Generates the new entry-point for ES-GS merged shader.
 //
+// The entry glue depends only on the glue configuration (see getGlueKey), not on the shader bodies, so it is
+// built once per configuration into a module cached on the LgcContext and copied into each pipeline module,
+// with the placeholder body declarations replaced by the real ES/GS entry-points.
+//
 // @param esEntryPoint : Entry-point of hardware export shader (ES) (could be null)
 // @param gsEntryPoint : Entry-point of hardware geometry shader (GS)
 Function *ShaderMerger::generateEsGsEntryPoint(Function *esEntryPoint, Function *gsEntryPoint) {
@@ -547,15 +622,53 @@ Function *ShaderMerger::generateEsGsEntryPoint(Function *esEntryPoint, Function
   gsEntryPoint->setLinkage(GlobalValue::InternalLinkage);
   gsEntryPoint->addFnAttr(Attribute::AlwaysInline);
 
-  auto module = gsEntryPoint->getParent();
-  const bool hasTs = (m_hasTcs || m_hasTes);
-
+  // NOTE: Generating the entry-point type may assign a spill table user data slot, so it must run even when
+  // the glue itself comes from the cache.
   uint64_t inRegMask = 0;
   auto entryPointTy = generateEsGsEntryPointType(&inRegMask);
 
-  // Create the entrypoint for the merged shader, and insert it just before the old GS.
-  Function *entryPoint = Function::Create(entryPointTy, GlobalValue::ExternalLinkage, lgcName::EsGsEntryPoint);
-  module->getFunctionList().insert(gsEntryPoint->getIterator(), entryPoint);
+  Module *glueModule = m_pipelineState->getLgcContext()->getGlueModule(
+      getGlueKey(/*lsHs=*/false, entryPointTy, esEntryPoint, gsEntryPoint),
+      [&]() { return buildEsGsGlueModule(entryPointTy, inRegMask, esEntryPoint, gsEntryPoint); });
+
+  Function *esGsEntryPoint = copyGlueEntryPoint(glueModule, lgcName::EsGsEntryPoint, EsGlueBodyName, esEntryPoint,
+                                                GsGlueBodyName, gsEntryPoint, gsEntryPoint);
+  registerMergedEntryPoint(esEntryPoint, esGsEntryPoint);
+  registerMergedEntryPoint(gsEntryPoint, esGsEntryPoint);
+  return esGsEntryPoint;
+}
+
+// =====================================================================================================================
+// Builds the module holding the ES-GS merged shader entry glue for the current configuration. The ES/GS bodies
+// are represented by placeholder declarations carrying the real entry-points' types and attributes.
+//
+// @param entryPointTy : Type of the merged-shader entry-point
+// @param inRegMask : "Inreg" bit mask for the entry-point arguments
+// @param esEntryPoint : Entry-point of hardware export shader (ES) (could be null)
+// @param gsEntryPoint : Entry-point of hardware geometry shader (GS)
+std::unique_ptr<Module> ShaderMerger::buildEsGsGlueModule(FunctionType *entryPointTy, uint64_t inRegMask,
+                                                          Function *esEntryPoint, Function *gsEntryPoint) {
+  auto glueModule = std::make_unique<Module>("esGsGlue", *m_context);
+  glueModule->setTargetTriple(gsEntryPoint->getParent()->getTargetTriple());
+  glueModule->setDataLayout(gsEntryPoint->getParent()->getDataLayout());
+
+  // From here on, build against the placeholder declarations rather than the real entry-points.
+  if (esEntryPoint) {
+    auto esBody =
+        Function::Create(esEntryPoint->getFunctionType(), GlobalValue::ExternalLinkage, EsGlueBodyName, &*glueModule);
+    esBody->setAttributes(esEntryPoint->getAttributes());
+    esEntryPoint = esBody;
+  }
+
+  auto gsBody =
+      Function::Create(gsEntryPoint->getFunctionType(), GlobalValue::ExternalLinkage, GsGlueBodyName, &*glueModule);
+  gsBody->setAttributes(gsEntryPoint->getAttributes());
+  gsEntryPoint = gsBody;
+
+  const bool hasTs = (m_hasTcs || m_hasTes);
+
+  Function *entryPoint =
+      Function::Create(entryPointTy, GlobalValue::ExternalLinkage, lgcName::EsGsEntryPoint, &*glueModule);
 
   entryPoint->addFnAttr("amdgpu-flat-work-group-size",
                         "128,128"); // Force s_barrier to be present (ignore optimization)
@@ -973,5 +1086,93 @@ Function *ShaderMerger::generateEsGsEntryPoint(Function *esEntryPoint, Function
   // Construct ".endgs" block
   ReturnInst::Create(*m_context, endGsBlock);
 
+  return glueModule;
+}
+
+// =====================================================================================================================
+// Builds the key identifying a merged-shader entry glue configuration. The key must cover everything the glue
+// builders read: wave size, stage presence, tessellation mode, GPU workarounds, the user data and spill table
+// layout of the merged stages, the ES-GS ring factors, and the entry-point signatures. Two pipelines with equal
+// keys get identical glue.
+//
+// @param lsHs : Whether the glue is for the LS-HS merged shader (false means ES-GS)
+// @param entryPointTy : Type of the merged-shader entry-point
+// @param firstEntryPoint : Entry-point of the first merged shader (could be null)
+// @param secondEntryPoint : Entry-point of the second merged shader
+std::string ShaderMerger::getGlueKey(bool lsHs, FunctionType *entryPointTy, Function *firstEntryPoint,
+                                     Function *secondEntryPoint) const {
+  std::string glueKey;
+  raw_string_ostream key(glueKey);
+
+  key << (lsHs ? "lshs" : "esgs");
+  key << "," << m_pipelineState->getShaderWaveSize(lsHs ? ShaderStageTessControl : ShaderStageGeometry);
+  key << "," << m_hasVs << m_hasTcs << m_hasTes << m_hasGs;
+  key << "," << m_pipelineState->isTessOffChip();
+
+  if (lsHs)
+    key << "," << m_pipelineState->getTargetInfo().getGpuWorkarounds().gfx9.fixLsVgprInput;
+
+  for (auto stage : {ShaderStageVertex, ShaderStageTessControl, ShaderStageTessEval, ShaderStageGeometry}) {
+    if (!m_pipelineState->hasShaderStage(stage))
+      continue;
+    const auto intfData = m_pipelineState->getShaderInterfaceData(stage);
+    key << "," << intfData->userDataCount << ":" << intfData->userDataUsage.spillTable << ":"
+        << intfData->spillTable.sizeInDwords;
+  }
+
+  if (!lsHs) {
+    const auto &calcFactor = m_pipelineState->getShaderResourceUsage(ShaderStageGeometry)->inOutUsage.gs.calcFactor;
+    key << "," << calcFactor.esGsRingItemSize << ":" << calcFactor.inputVertices;
+  }
+
+  key << ",";
+  entryPointTy->print(key);
+  if (firstEntryPoint) {
+    key << ",";
+    firstEntryPoint->getFunctionType()->print(key);
+  }
+  key << ",";
+  secondEntryPoint->getFunctionType()->print(key);
+
+  return key.str();
+}
+
+// =====================================================================================================================
+// Copies the cached entry glue into the pipeline module and stitches the real shader bodies in: the glue module
+// is cloned and linked in, the placeholder body declarations are replaced by the given entry-points, and the
+// glue entry-point is moved just before the second (always present) entry-point.
+//
+// @param glueModule : Cached module holding the entry glue
+// @param entryName : Name of the glue entry-point function
+// @param firstBodyName : Name of the placeholder declaration for the first shader body
+// @param firstEntryPoint : Entry-point of the first merged shader (could be null)
+// @param secondBodyName : Name of the placeholder declaration for the second shader body
+// @param secondEntryPoint : Entry-point of the second merged shader
+// @param insertBefore : Function before which the glue entry-point is inserted
+Function *ShaderMerger::copyGlueEntryPoint(Module *glueModule, StringRef entryName, StringRef firstBodyName,
+                                           Function *firstEntryPoint, StringRef secondBodyName,
+                                           Function *secondEntryPoint, Function *insertBefore) {
+  Module *module = insertBefore->getParent();
+
+  bool failed = Linker::linkModules(*module, CloneModule(*glueModule));
+  assert(!failed);
+  (void(failed)); // unused
+
+  auto stitchBody = [module](StringRef bodyName, Function *bodyEntryPoint) {
+    Function *body = module->getFunction(bodyName);
+    if (!body)
+      return; // The glue does not call this body (shader stage not present)
+    assert(bodyEntryPoint);
+    body->replaceAllUsesWith(bodyEntryPoint);
+    body->eraseFromParent();
+  };
+  stitchBody(firstBodyName, firstEntryPoint);
+  stitchBody(secondBodyName, secondEntryPoint);
+
+  // Move the glue entry-point just before the old shader entry-point, matching direct generation.
+  Function *entryPoint = module->getFunction(entryName);
+  assert(entryPoint && !entryPoint->empty());
+  module->getFunctionList().splice(insertBefore->getIterator(), module->getFunctionList(), entryPoint->getIterator());
+
   return entryPoint;
 }
@@ -89,12 +89,26 @@ private:
   ShaderMerger(const ShaderMerger &) = delete;
   ShaderMerger &operator=(const ShaderMerger &) = delete;
 
+  void registerMergedEntryPoint(llvm::Function *oldEntryPoint, llvm::Function *mergedEntryPoint);
+
   llvm::FunctionType *generateLsHsEntryPointType(uint64_t *inRegMask) const;
   llvm::FunctionType *generateEsGsEntryPointType(uint64_t *inRegMask) const;
 
-  PipelineState *m_pipelineState; // Pipeline state
-  llvm::LLVMContext *m_context;   // LLVM context
-  GfxIpVersion m_gfxIp;           // Graphics IP version info
+  std::string getGlueKey(bool lsHs, llvm::FunctionType *entryPointTy, llvm::Function *firstEntryPoint,
+                         llvm::Function *secondEntryPoint) const;
+  std::unique_ptr<llvm::Module> buildLsHsGlueModule(llvm::FunctionType *entryPointTy, uint64_t inRegMask,
+                                                    llvm::Function *lsEntryPoint, llvm::Function *hsEntryPoint);
+  std::unique_ptr<llvm::Module> buildEsGsGlueModule(llvm::FunctionType *entryPointTy, uint64_t inRegMask,
+                                                    llvm::Function *esEntryPoint, llvm::Function *gsEntryPoint);
+  llvm::Function *copyGlueEntryPoint(llvm::Module *glueModule, llvm::StringRef entryName,
+                                     llvm::StringRef firstBodyName, llvm::Function *firstEntryPoint,
+                                     llvm::StringRef secondBodyName, llvm::Function *secondEntryPoint,
+                                     llvm::Function *insertBefore);
+
+  PipelineState *m_pipelineState;     // Pipeline state
+  PipelineShaders *m_pipelineShaders; // API shaders in the pipeline
+  llvm::LLVMContext *m_context;       // LLVM context
+  GfxIpVersion m_gfxIp;               // Graphics IP version info
 
   NggPrimShader m_primShader; // Manager of NGG primitive shader
 
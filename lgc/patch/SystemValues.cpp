@@ -34,6 +34,7 @@
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
 
 #define DEBUG_TYPE "lgc-system-values"
 
@@ -497,3 +498,34 @@ unsigned ShaderSystemValues::findResourceNodeByDescSet(unsigned descSet) {
 bool ShaderSystemValues::isShadowDescTableEnabled() const {
   return m_pipelineState->getOptions().shadowDescriptorTable != ShadowDescriptorTableDisable;
 }
+
+// =====================================================================================================================
+// Initialize static members
+char PipelineSystemValuesWrapper::ID = 0;
+
+// =====================================================================================================================
+// Run the analysis on the specified LLVM module.
+//
+// This only binds the pipeline state; the ShaderSystemValues objects are materialized lazily by get().
+//
+// @param [in,out] module : LLVM module to be run on
+bool PipelineSystemValuesWrapper::runOnModule(Module &module) {
+  LLVM_DEBUG(dbgs() << "Run the analysis Pipeline-System-Values-Wrapper\n");
+
+  m_pipelineSysValues.clear();
+  m_pipelineSysValues.initialize(getAnalysis<PipelineStateWrapper>().getPipelineState(&module));
+  return false;
+}
+
+// =====================================================================================================================
+// Specify what analysis passes this analysis depends on.
+//
+// @param [in,out] analysisUsage : The place to record our analysis pass dependencies
+void PipelineSystemValuesWrapper::getAnalysisUsage(AnalysisUsage &analysisUsage) const {
+  analysisUsage.addRequired<PipelineStateWrapper>();
+  analysisUsage.setPreservesAll();
+}
+
+// =====================================================================================================================
+// Initializes the analysis pass of pipeline system values.
+INITIALIZE_PASS(PipelineSystemValuesWrapper, DEBUG_TYPE, "Pipeline system values cache", false, true)
@@ -35,8 +35,17 @@
 #include "lgc/state/Defs.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Pass.h"
 #include <map>
 
+namespace llvm {
+
+class PassRegistry;
+
+void initializePipelineSystemValuesWrapperPass(PassRegistry &);
+
+} // namespace llvm
+
 namespace lgc {
 
 class PipelineState;
@@ -44,10 +53,11 @@ struct ResourceNode;
 
 // =====================================================================================================================
 // "Shader system values" are values set up in a shader entrypoint, such as the ES->GS ring buffer descriptor, or the
-// user descriptor table pointer, that some passes need access to. The ShaderSystemValues class has an instance for each
-// shader in each pass that needs it, and it implements the on-demand emitting of the code to generate such a value, and
-// caches the result for the duration of the pass using it. If multiple passes need the same value, then multiple copies
-// of the generating code will be emitted, but that will be fixed by a later CSE pass.
+// user descriptor table pointer, that some passes need access to. The ShaderSystemValues class has an instance for
+// each shader, and it implements the on-demand emitting of the code to generate such a value, and caches the result.
+// Passes obtain the instances through the PipelineSystemValuesWrapper analysis, so the cache outlives a single pass
+// as long as the analysis is preserved; when it is invalidated, the next query re-emits the generating code, and any
+// duplicated copies are fixed by a later CSE pass.
 class ShaderSystemValues {
 public:
   // Initialize this ShaderSystemValues if it was previously uninitialized.
@@ -164,4 +174,30 @@ private:
   std::map<llvm::Function *, ShaderSystemValues> m_shaderSysValuesMap;
 };
 
+// =====================================================================================================================
+// Analysis pass owning the pipeline's ShaderSystemValues objects, so the lazily materialized values are shared
+// between passes that preserve this analysis instead of being re-emitted per pass. A pass that does not declare
+// the analysis preserved invalidates it, which clears the cached values; the next get() re-materializes them,
+// so stale llvm::Value pointers are never handed out.
+class PipelineSystemValuesWrapper : public llvm::ModulePass {
+public:
+  static char ID;
+  PipelineSystemValuesWrapper() : llvm::ModulePass(ID) {}
+
+  bool runOnModule(llvm::Module &module) override;
+
+  void getAnalysisUsage(llvm::AnalysisUsage &analysisUsage) const override;
+
+  void releaseMemory() override { m_pipelineSysValues.clear(); }
+
+  // Get the ShaderSystemValues object for the given shader entrypoint.
+  ShaderSystemValues *get(llvm::Function *entryPoint) { return m_pipelineSysValues.get(entryPoint); }
+
+private:
+  PipelineSystemValuesWrapper(const PipelineSystemValuesWrapper &) = delete;
+  PipelineSystemValuesWrapper &operator=(const PipelineSystemValuesWrapper &) = delete;
+
+  PipelineSystemValues m_pipelineSysValues; // Cache of ShaderSystemValues objects, one per shader stage
+};
+
 } // namespace lgc
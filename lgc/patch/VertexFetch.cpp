@@ -73,6 +73,13 @@ struct VertexCompFormatInfo {
   BufDataFmt compDfmt;     // Equivalent data format of each component
 };
 
+// Represents the canonical data format and valid channel count the fetch is done with, indexed by the data format
+// (BufDataFormat) of the vertex input description.
+struct VertexDfmtInfo {
+  BufDataFormat dfmt;   // Canonical data format used for the fetch
+  unsigned numChannels; // Valid number of channels
+};
+
 // =====================================================================================================================
 // Pass to lower vertex fetch calls
 class LowerVertexFetch : public ModulePass {
@@ -135,6 +142,7 @@ private:
   Value *m_instanceIndex = nullptr;     // Instance index
 
   static const VertexCompFormatInfo MVertexCompFormatInfo[]; // Info table of vertex component format
+  static const VertexDfmtInfo MVertexDfmtInfo[];             // Info table of vertex data format remapping
   static const BufFormat MVertexFormatMap[];                 // Info table of vertex format mapping
 
   // Default values for vertex fetch (<4 x i32> or <8 x i32>)
@@ -176,6 +184,44 @@ const VertexCompFormatInfo VertexFetchImpl::MVertexCompFormatInfo[] = {
     {16, 4, 4, BUF_DATA_FORMAT_32},        // BUF_DATA_FORMAT_32_32_32_32
 };
 
+// Initializes info table of vertex data format remapping, indexed by BufDataFormat. Formats with no special
+// handling keep themselves as the canonical data format and fetch a single channel.
+const VertexDfmtInfo VertexFetchImpl::MVertexDfmtInfo[] = {
+    {BufDataFormatInvalid, 1},        // BufDataFormatInvalid
+    {BufDataFormat8, 1},              // BufDataFormat8
+    {BufDataFormat16, 1},             // BufDataFormat16
+    {BufDataFormat8_8, 2},            // BufDataFormat8_8
+    {BufDataFormat32, 1},             // BufDataFormat32
+    {BufDataFormat16_16, 2},          // BufDataFormat16_16
+    {BufDataFormat10_11_11, 3},       // BufDataFormat10_11_11
+    {BufDataFormat11_11_10, 3},       // BufDataFormat11_11_10
+    {BufDataFormat10_10_10_2, 4},     // BufDataFormat10_10_10_2
+    {BufDataFormat2_10_10_10, 4},     // BufDataFormat2_10_10_10
+    {BufDataFormat8_8_8_8, 4},        // BufDataFormat8_8_8_8
+    {BufDataFormat32_32, 2},          // BufDataFormat32_32
+    {BufDataFormat16_16_16_16, 4},    // BufDataFormat16_16_16_16
+    {BufDataFormat32_32_32, 3},       // BufDataFormat32_32_32
+    {BufDataFormat32_32_32_32, 4},    // BufDataFormat32_32_32_32
+    {BufDataFormatReserved, 1},       // BufDataFormatReserved
+    {BufDataFormat8_8_8_8, 4},        // BufDataFormat8_8_8_8_Bgra
+    {BufDataFormat8_8_8, 1},          // BufDataFormat8_8_8
+    {BufDataFormat8_8_8_Bgr, 1},      // BufDataFormat8_8_8_Bgr
+    {BufDataFormat2_10_10_10, 4},     // BufDataFormat2_10_10_10_Bgra
+    {BufDataFormat32_32, 2},          // BufDataFormat64
+    {BufDataFormat32_32_32_32, 4},    // BufDataFormat64_64
+    {BufDataFormat32_32_32_32, 4},    // BufDataFormat64_64_64
+    {BufDataFormat32_32_32_32, 4},    // BufDataFormat64_64_64_64
+    {BufDataFormat4_4, 1},            // BufDataFormat4_4
+    {BufDataFormat4_4_4_4, 1},        // BufDataFormat4_4_4_4
+    {BufDataFormat4_4_4_4_Bgra, 1},   // BufDataFormat4_4_4_4_Bgra
+    {BufDataFormat5_6_5, 1},          // BufDataFormat5_6_5
+    {BufDataFormat5_6_5_Bgr, 1},      // BufDataFormat5_6_5_Bgr
+    {BufDataFormat5_6_5_1, 1},        // BufDataFormat5_6_5_1
+    {BufDataFormat5_6_5_1_Bgra, 1},   // BufDataFormat5_6_5_1_Bgra
+    {BufDataFormat1_5_6_5, 1},        // BufDataFormat1_5_6_5
+    {BufDataFormat5_9_9_9, 1},        // BufDataFormat5_9_9_9
+};
+
 const BufFormat VertexFetchImpl::MVertexFormatMap[] = {
     // BUF_DATA_FORMAT
     //   BUF_NUM_FORMAT_UNORM
@@ -837,47 +883,9 @@ Value *VertexFetchImpl::fetchVertex(Type *inputTy, const VertexInputDescription
 //
 // @param inputDesc : Vertex input description
 VertexFormatInfo VertexFetchImpl::getVertexFormatInfo(const VertexInputDescription *inputDesc) {
-  VertexFormatInfo info = {static_cast<BufNumFormat>(inputDesc->nfmt), static_cast<BufDataFormat>(inputDesc->dfmt), 1};
-  switch (inputDesc->dfmt) {
-  case BufDataFormat8_8:
-  case BufDataFormat16_16:
-  case BufDataFormat32_32:
-    info.numChannels = 2;
-    break;
-  case BufDataFormat32_32_32:
-  case BufDataFormat10_11_11:
-  case BufDataFormat11_11_10:
-    info.numChannels = 3;
-    break;
-  case BufDataFormat8_8_8_8:
-  case BufDataFormat16_16_16_16:
-  case BufDataFormat32_32_32_32:
-  case BufDataFormat10_10_10_2:
-  case BufDataFormat2_10_10_10:
-    info.numChannels = 4;
-    break;
-  case BufDataFormat8_8_8_8_Bgra:
-    info.numChannels = 4;
-    info.dfmt = BufDataFormat8_8_8_8;
-    break;
-  case BufDataFormat2_10_10_10_Bgra:
-    info.numChannels = 4;
-    info.dfmt = BufDataFormat2_10_10_10;
-    break;
-  case BufDataFormat64:
-    info.numChannels = 2;
-    info.dfmt = BufDataFormat32_32;
-    break;
-  case BufDataFormat64_64:
-  case BufDataFormat64_64_64:
-  case BufDataFormat64_64_64_64:
-    info.numChannels = 4;
-    info.dfmt = BufDataFormat32_32_32_32;
-    break;
-  default:
-    break;
-  }
-  return info;
+  assert(inputDesc->dfmt < sizeof(MVertexDfmtInfo) / sizeof(MVertexDfmtInfo[0]));
+  const VertexDfmtInfo &dfmtInfo = MVertexDfmtInfo[inputDesc->dfmt];
+  return {static_cast<BufNumFormat>(inputDesc->nfmt), dfmtInfo.dfmt, dfmtInfo.numChannels};
 }
 
 // =====================================================================================================================
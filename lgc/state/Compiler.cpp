@@ -31,6 +31,7 @@
 #include "lgc/LgcContext.h"
 #include "lgc/PassManager.h"
 #include "lgc/patch/Patch.h"
+#include "lgc/state/PassManagerCache.h"
 #include "lgc/state/PipelineState.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/IRPrintingPasses.h"
@@ -92,8 +93,11 @@ Module *PipelineState::irLink(ArrayRef<std::pair<Module *, ShaderStage>> modules
   assert(shaderStageMask == getShaderStageMask());
 #endif
 
-  // If the front-end was using a BuilderRecorder, record pipeline state into IR metadata.
-  if (!m_noReplayer)
+  // This state object was populated by the client and outlives the module, so generate() can hand it straight
+  // to the patch phase. Serializing it into IR metadata is only needed when the module is written out as -emit-lgc
+  // IR for the standalone lgc tool, which has no state object and reads the metadata back instead.
+  m_directHandoff = true;
+  if (!m_noReplayer && m_emitLgc)
     record(modules[0].first);
 
   // If there is only one shader, just change the name on its module and return it.
@@ -171,12 +175,13 @@ bool PipelineState::generate(std::unique_ptr<Module> pipelineModule, raw_pwrite_
   getLgcContext()->preparePassManager(&*passMgr);
 
   // Manually add a PipelineStateWrapper pass.
-  // If we were not using BuilderRecorder, give our PipelineState to it. (In the BuilderRecorder case,
-  // the first time PipelineStateWrapper is used, it allocates its own PipelineState and populates
-  // it by reading IR metadata.)
+  // For an in-process build the client populated this state object and it outlives the module, so give it to the
+  // wrapper directly and skip the IR metadata round trip. Only when the module came from outside with its state
+  // serialized in metadata (the lgc standalone tool running on a .lgc file) does the first use of
+  // PipelineStateWrapper allocate its own PipelineState and populate it by reading IR metadata.
   PipelineStateWrapper *pipelineStateWrapper = new PipelineStateWrapper(getLgcContext());
   passMgr->add(pipelineStateWrapper);
-  if (m_noReplayer)
+  if (m_noReplayer || m_directHandoff)
     pipelineStateWrapper->setPipelineState(this);
 
   if (m_emitLgc) {
@@ -196,12 +201,20 @@ bool PipelineState::generate(std::unique_ptr<Module> pipelineModule, raw_pwrite_
   // Add pass to clear pipeline state from IR
   passMgr->add(createPipelineStateClearer());
 
-  // Code generation.
-  getLgcContext()->addTargetPasses(*passMgr, codeGenTimer, outStream);
+  // Code generation. When codegen is not being timed, the fully constructed codegen pass manager comes from
+  // the pass manager cache and is reused across pipelines, so pass registration and TargetMachine pass
+  // construction are not repeated for every build. A codegen timer needs the timer start/stop passes wrapped
+  // around the target passes inside the pass manager, so that case still builds them fresh.
+  bool useCachedCodeGen = !codeGenTimer && !m_emitLgc;
+  if (!useCachedCodeGen)
+    getLgcContext()->addTargetPasses(*passMgr, codeGenTimer, outStream);
 
   // Run the "whole pipeline" passes.
   passMgr->run(*pipelineModule);
 
+  if (useCachedCodeGen && getLastError() == "")
+    getLgcContext()->getPassManagerCache()->getCodeGenPassManager(outStream).run(*pipelineModule);
+
   // See if there was a recoverable error.
   if (getLastError() != "")
     return false;
@@ -36,16 +36,20 @@
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
 #include "lgc/util/Internal.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/IR/IRPrintingPasses.h"
+#include "llvm/IR/Module.h"
 #include "llvm/InitializePasses.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include <atomic>
 
 #define DEBUG_TYPE "lgc-context"
 
@@ -77,6 +81,103 @@ static cl::opt<bool> EmitLgc("emit-lgc", cl::desc("Emit LLVM assembly suitable f
 // -show-encoding: show the instruction encoding when emitting assembler. This mirrors llvm-mc behaviour
 static cl::opt<bool> ShowEncoding("show-encoding", cl::desc("Show instruction encodings"), cl::init(false));
 
+// -disable-direct-builder: always use BuilderRecorder/BuilderReplayer, even for single-stage pipelines
+static cl::opt<bool> DisableDirectBuilder("disable-direct-builder",
+                                          cl::desc("Always use BuilderRecorder/BuilderReplayer, even for "
+                                                   "single-stage pipelines"),
+                                          cl::init(false));
+
+// =====================================================================================================================
+// Process-wide cache of per-GPU target info. TargetInfo is immutable once derived, so one instance per GPU name
+// is shared by every LgcContext in the process. The list is push-only and read lock-free; a racing insert can
+// create a short-lived duplicate entry, which is harmless because all entries for one GPU are identical.
+struct TargetInfoNode {
+  std::string gpuName;   // GPU name the info was derived for
+  TargetInfo targetInfo; // The derived target info
+  TargetInfoNode *next;  // Next node in the list
+};
+
+static std::atomic<TargetInfoNode *> SharedTargetInfos;
+
+// =====================================================================================================================
+// Gets the shared target info for the given GPU name, deriving it on first use. Returns nullptr if the GPU name
+// is not found or not supported.
+//
+// @param gpuName : LLVM GPU name (e.g. "gfx900")
+static const TargetInfo *getSharedTargetInfo(StringRef gpuName) {
+  for (TargetInfoNode *node = SharedTargetInfos.load(std::memory_order_acquire); node; node = node->next) {
+    if (node->gpuName == gpuName)
+      return &node->targetInfo;
+  }
+
+  auto node = new TargetInfoNode;
+  node->gpuName = gpuName.str();
+  if (!node->targetInfo.setTargetInfo(gpuName)) {
+    delete node;
+    return nullptr;
+  }
+  node->next = SharedTargetInfos.load(std::memory_order_acquire);
+  while (!SharedTargetInfos.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                  std::memory_order_acquire))
+    ;
+  return &node->targetInfo;
+}
+
+// =====================================================================================================================
+// Process-wide pool of idle target machines, keyed by GPU name plus the options that shape the machine.
+// Creating a TargetMachine parses the feature string and builds the scheduling model, which is pure overhead for
+// short-lived compiler instances; a destroyed LgcContext parks its machine here and Create adopts a matching one
+// instead of constructing afresh. A TargetMachine lazily caches per-function subtarget state and so cannot be
+// shared by concurrent compiles; the pool only ever hands a machine to one LgcContext at a time.
+struct TargetMachineNode {
+  std::string key;              // GPU name plus options digest the machine was created with
+  TargetMachine *targetMachine; // The idle machine
+  TargetMachineNode *next;      // Next node in the pool
+};
+
+static std::atomic<TargetMachineNode *> IdleTargetMachines;
+
+// =====================================================================================================================
+// Pushes one node onto the idle target machine pool.
+//
+// @param node : Node to push
+static void pushIdleTargetMachine(TargetMachineNode *node) {
+  node->next = IdleTargetMachines.load(std::memory_order_acquire);
+  while (!IdleTargetMachines.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                   std::memory_order_acquire))
+    ;
+}
+
+// =====================================================================================================================
+// Takes an idle target machine with the given key out of the pool, or returns nullptr if none is available.
+// The whole pool is detached atomically and non-matching machines are pushed back, which keeps the pop safe
+// without tagged pointers; in practice a process compiles for one GPU and the pool holds a single key.
+//
+// @param key : GPU name plus options digest
+static TargetMachine *takeIdleTargetMachine(StringRef key) {
+  TargetMachineNode *list = IdleTargetMachines.exchange(nullptr, std::memory_order_acquire);
+  TargetMachine *found = nullptr;
+  while (list) {
+    TargetMachineNode *node = list;
+    list = list->next;
+    if (!found && node->key == key) {
+      found = node->targetMachine;
+      delete node;
+    } else {
+      pushIdleTargetMachine(node);
+    }
+  }
+  return found;
+}
+
+// =====================================================================================================================
+// Builds the key identifying target machines interchangeable with one created now for the given GPU.
+//
+// @param gpuName : LLVM GPU name (e.g. "gfx900")
+static std::string getTargetMachineKey(StringRef gpuName) {
+  return (gpuName + (ShowEncoding ? "+show-encoding" : "")).str();
+}
+
 // =====================================================================================================================
 // Set default for a command-line option, but only if command-line processing has not happened yet, or did not see
 // an occurrence of this option.
@@ -163,12 +264,18 @@ LgcContext *LgcContext::Create(LLVMContext &context, StringRef gpuName, unsigned
   if (gpuName == "")
     gpuName = mcpuName;
 
-  builderContext->m_targetInfo = new TargetInfo;
-  if (!builderContext->m_targetInfo->setTargetInfo(gpuName)) {
+  builderContext->m_targetInfo = getSharedTargetInfo(gpuName);
+  if (!builderContext->m_targetInfo) {
     delete builderContext;
     return nullptr;
   }
 
+  // Adopt an idle target machine parked by a destroyed LgcContext for the same GPU, if one is available.
+  builderContext->m_targetMachineKey = getTargetMachineKey(gpuName);
+  builderContext->m_targetMachine = takeIdleTargetMachine(builderContext->m_targetMachineKey);
+  if (builderContext->m_targetMachine)
+    return builderContext;
+
   // Get the LLVM target and create the target machine. This should not fail, as we determined above
   // that we support the requested target.
   const std::string triple = "amdgcn--amdpal";
@@ -191,6 +298,43 @@ LgcContext *LgcContext::Create(LLVMContext &context, StringRef gpuName, unsigned
   return builderContext;
 }
 
+// =====================================================================================================================
+// Create the LgcContext, adopting a target machine created by a previous LgcContext for the same GPU.
+//
+// @param context : LLVM context to give each Builder
+// @param gpuName : LLVM GPU name (e.g. "gfx900"); empty to use -mcpu option setting
+// @param palAbiVersion : PAL pipeline ABI version to compile for
+// @param targetMachine : Target machine to adopt, created for the same GPU
+LgcContext *LgcContext::Create(LLVMContext &context, StringRef gpuName, unsigned palAbiVersion,
+                               std::unique_ptr<TargetMachine> targetMachine) {
+  assert(Initialized && "Must call LgcContext::Initialize before LgcContext::Create");
+
+  LgcContext *builderContext = new LgcContext(context, palAbiVersion);
+
+  std::string mcpuName = codegen::getMCPU(); // -mcpu setting from llvm/CodeGen/CommandFlags.h
+  if (gpuName == "")
+    gpuName = mcpuName;
+
+  builderContext->m_targetInfo = getSharedTargetInfo(gpuName);
+  if (!builderContext->m_targetInfo) {
+    delete builderContext;
+    return nullptr;
+  }
+
+  builderContext->m_targetMachineKey = getTargetMachineKey(gpuName);
+  builderContext->m_targetMachine = targetMachine.release();
+  assert(builderContext->m_targetMachine);
+  return builderContext;
+}
+
+// =====================================================================================================================
+// Releases ownership of the target machine so it can outlive this LgcContext and be adopted by a new one.
+std::unique_ptr<TargetMachine> LgcContext::takeTargetMachine() {
+  TargetMachine *targetMachine = m_targetMachine;
+  m_targetMachine = nullptr;
+  return std::unique_ptr<TargetMachine>(targetMachine);
+}
+
 // =====================================================================================================================
 //
 // @param context : LLVM context to give each Builder
@@ -200,8 +344,14 @@ LgcContext::LgcContext(LLVMContext &context, unsigned palAbiVersion) : m_context
 
 // =====================================================================================================================
 LgcContext::~LgcContext() {
-  delete m_targetMachine;
-  delete m_targetInfo;
+  if (m_targetMachine) {
+    // Park the machine for adoption by a later LgcContext rather than destroying it. The target info is shared
+    // process-wide and not owned here.
+    auto node = new TargetMachineNode;
+    node->key = m_targetMachineKey;
+    node->targetMachine = m_targetMachine;
+    pushIdleTargetMachine(node);
+  }
   delete m_passManagerCache;
 }
 
@@ -217,11 +367,22 @@ Pipeline *LgcContext::createPipeline() {
 // Create a Builder object. For a shader compile (pPipeline is nullptr), useBuilderRecorder is ignored
 // because it always uses BuilderRecorder.
 //
+// For a pipeline with a single shader stage there is no cross-stage state to defer, so BuilderImpl is handed
+// out directly even if useBuilderRecorder was requested, skipping the record/replay round trip through
+// lgc.call.* intrinsics. -disable-direct-builder restores the recorder for such pipelines.
+//
 // @param pipeline : Pipeline object for pipeline compile, nullptr for shader compile
 // @param useBuilderRecorder : true to use BuilderRecorder, false to use BuilderImpl
 Builder *LgcContext::createBuilder(Pipeline *pipeline, bool useBuilderRecorder) {
-  if (!pipeline || useBuilderRecorder || EmitLgc)
+  if (!pipeline || EmitLgc)
     return Builder::createBuilderRecorder(this, pipeline, EmitLgc);
+  if (useBuilderRecorder) {
+    // The shader stage mask must already have been set on the pipeline for the single-stage fast path to
+    // trigger; a pipeline whose mask is not yet known keeps the recorder.
+    const unsigned stageMask = static_cast<PipelineState *>(pipeline)->getShaderStageMask();
+    if (DisableDirectBuilder || !isPowerOf2_32(stageMask))
+      return Builder::createBuilderRecorder(this, pipeline, EmitLgc);
+  }
   return Builder::createBuilderImpl(this, pipeline);
 }
 
@@ -302,3 +463,192 @@ PassManagerCache *LgcContext::getPassManagerCache() {
     m_passManagerCache = new PassManagerCache(this);
   return m_passManagerCache;
 }
+
+// =====================================================================================================================
+// Get the module holding pipeline-independent library functions, creating it empty on first use
+Module *LgcContext::getLibraryModule() {
+  if (!m_libraryModule) {
+    m_libraryModule.reset(new Module("lgcLibrary", getContext()));
+    m_libraryModule->setTargetTriple(getTargetMachine()->getTargetTriple().getTriple());
+    m_libraryModule->setDataLayout(getTargetMachine()->createDataLayout());
+  }
+  return &*m_libraryModule;
+}
+
+// =====================================================================================================================
+// Gets the cached module holding merged-shader entry glue for the given configuration key, calling the given
+// builder to create it on first use. The returned module is owned by this LgcContext and must not be modified;
+// callers clone it into their pipeline module.
+//
+// @param glueKey : Key identifying the glue configuration
+// @param builder : Callback building the glue module on a cache miss
+Module *LgcContext::getGlueModule(StringRef glueKey, function_ref<std::unique_ptr<Module>()> builder) {
+  std::unique_ptr<Module> &glueModule = m_glueModules[glueKey.str()];
+  if (!glueModule)
+    glueModule = builder();
+  return &*glueModule;
+}
+
+// =====================================================================================================================
+// Checks whether the given module contains the null fragment shader the middle-end synthesizes when a graphics
+// pipeline has no fragment shader of its own.
+//
+// @param module : Module to check
+bool LgcContext::hasNullFragmentShader(const Module &module) {
+  return module.getFunction(lgcName::NullFsEntryPoint) != nullptr;
+}
+
+// =====================================================================================================================
+// Gets the finished pipeline ELF retained for a synthesized shader shape, or an empty ArrayRef on miss.
+//
+// @param shapeHash : Hash of the shader shape and the pipeline state it was compiled with
+ArrayRef<char> LgcContext::lookUpSynthesizedShaderElf(uint64_t shapeHash) {
+  auto elfIt = m_synthesizedShaderElfs.find(shapeHash);
+  if (elfIt == m_synthesizedShaderElfs.end())
+    return {};
+  return {elfIt->second.data(), elfIt->second.size()};
+}
+
+// =====================================================================================================================
+// Retains a copy of the finished pipeline ELF holding a synthesized shader, for later compiles with the same
+// shape to reuse.
+//
+// @param shapeHash : Hash of the shader shape and the pipeline state it was compiled with
+// @param elf : The pipeline ELF to retain a copy of
+void LgcContext::storeSynthesizedShaderElf(uint64_t shapeHash, ArrayRef<char> elf) {
+  m_synthesizedShaderElfs[shapeHash] = std::string(elf.data(), elf.size());
+}
+
+// =====================================================================================================================
+// Hash the content of a flattened user data node table. Inner tables are identified by their relative position
+// in the buffer, so two independently built copies of the same layout hash the same.
+//
+// @param table : Start of the flattened node buffer
+// @param count : Total node count, including inner table nodes
+static uint64_t hashUserDataNodeTable(const ResourceNode *table, unsigned count) {
+  hash_code hash = hash_value(count);
+  for (unsigned idx = 0; idx != count; ++idx) {
+    const ResourceNode &node = table[idx];
+    hash = hash_combine(hash, static_cast<unsigned>(node.type), node.sizeInDwords, node.offsetInDwords);
+    switch (node.type) {
+    case ResourceNodeType::DescriptorTableVaPtr:
+      hash = hash_combine(hash, node.innerTable.size(), node.innerTable.data() - table);
+      break;
+    case ResourceNodeType::IndirectUserDataVaPtr:
+    case ResourceNodeType::StreamOutTableVaPtr:
+      hash = hash_combine(hash, node.indirectSizeInDwords);
+      break;
+    default:
+      hash = hash_combine(hash, node.set, node.binding, node.immutableValue);
+      break;
+    }
+  }
+  return static_cast<uint64_t>(hash);
+}
+
+// =====================================================================================================================
+// Check whether two flattened user data node tables describe the same layout. Inner tables are compared by
+// relative position, as the absolute pointers differ between copies.
+//
+// @param table1 : Start of the first flattened node buffer
+// @param table2 : Start of the second flattened node buffer
+// @param count : Total node count of both buffers, including inner table nodes
+static bool userDataNodeTablesIdentical(const ResourceNode *table1, const ResourceNode *table2, unsigned count) {
+  for (unsigned idx = 0; idx != count; ++idx) {
+    const ResourceNode &node1 = table1[idx];
+    const ResourceNode &node2 = table2[idx];
+    if (node1.type != node2.type || node1.sizeInDwords != node2.sizeInDwords ||
+        node1.offsetInDwords != node2.offsetInDwords)
+      return false;
+    switch (node1.type) {
+    case ResourceNodeType::DescriptorTableVaPtr:
+      if (node1.innerTable.size() != node2.innerTable.size() ||
+          node1.innerTable.data() - table1 != node2.innerTable.data() - table2)
+        return false;
+      break;
+    case ResourceNodeType::IndirectUserDataVaPtr:
+    case ResourceNodeType::StreamOutTableVaPtr:
+      if (node1.indirectSizeInDwords != node2.indirectSizeInDwords)
+        return false;
+      break;
+    default:
+      // Immutable values are uniqued constants in this context, so pointer equality is value equality.
+      if (node1.set != node2.set || node1.binding != node2.binding || node1.immutableValue != node2.immutableValue)
+        return false;
+      break;
+    }
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Gets the canonical copy of a flattened user data node table. Titles tend to reuse a handful of descriptor
+// layouts across very many pipelines; sharing one canonical table per layout avoids keeping thousands of
+// identical copies alive, and gives consumers a stable address to key caches of derived data on.
+//
+// @param nodes : Flattened node buffer as built by PipelineState::setUserDataNodes; ownership is taken
+// @param totalNodeCount : Total node count, including inner table nodes
+// @param outerNodeCount : Count of outer (root table) nodes at the start of the buffer
+ArrayRef<ResourceNode> LgcContext::getCanonicalUserDataNodes(std::unique_ptr<ResourceNode[]> nodes,
+                                                             unsigned totalNodeCount, unsigned outerNodeCount) {
+  uint64_t hash = hashUserDataNodeTable(nodes.get(), totalNodeCount);
+  std::vector<CanonicalUserDataNodes> &bucket = m_canonicalUserDataNodes[hash];
+  for (const CanonicalUserDataNodes &canonical : bucket) {
+    if (canonical.totalNodeCount == totalNodeCount && canonical.outerNodeCount == outerNodeCount &&
+        userDataNodeTablesIdentical(canonical.nodes.get(), nodes.get(), totalNodeCount))
+      return ArrayRef<ResourceNode>(canonical.nodes.get(), outerNodeCount);
+  }
+  bucket.push_back({std::move(nodes), totalNodeCount, outerNodeCount});
+  return ArrayRef<ResourceNode>(bucket.back().nodes.get(), outerNodeCount);
+}
+
+// =====================================================================================================================
+// Gets the composed "target-features" attribute string for a shader entry-point. The set of distinct combinations
+// per context is tiny (a couple of wavefront sizes and a few flags), while the string is rebuilt for every
+// entry-point of every pipeline, so the composed copies are cached keyed by the packed inputs. The graphics IP is
+// fixed per LgcContext and so contributes to the composition but not to the key.
+//
+// @param waveSize : Wavefront size of the entry-point; 0 on targets without a wavefrontsize feature
+// @param includeDisassembly : Whether disassembly is requested for the pipeline
+// @param useSiScheduler : Whether the SI machine scheduler is enabled for the shader stage
+// @param enableDs128 : Whether 128-bit LDS load/store operations are enabled
+StringRef LgcContext::getTargetFeatureString(unsigned waveSize, bool includeDisassembly, bool useSiScheduler,
+                                             bool enableDs128) {
+  assert(waveSize < 256);
+  const unsigned key = waveSize | (includeDisassembly ? 1u << 8 : 0) | (useSiScheduler ? 1u << 9 : 0) |
+                       (enableDs128 ? 1u << 10 : 0);
+  auto featuresIt = m_targetFeatureStrings.find(key);
+  if (featuresIt != m_targetFeatureStrings.end())
+    return featuresIt->second;
+
+  std::string targetFeatures;
+
+  if (includeDisassembly)
+    targetFeatures += ",+DumpCode";
+
+  if (useSiScheduler)
+    targetFeatures += ",+si-scheduler";
+
+  if (enableDs128) {
+    // NOTE: For NGG primitive shader, enable 128-bit LDS load/store operations to optimize gvec4 data
+    // read/write. This usage must enable the feature of using CI+ additional instructions.
+    targetFeatures += ",+ci-insts,+enable-ds128";
+  }
+
+  GfxIpVersion gfxIp = getTargetInfo().getGfxIpVersion();
+  if (gfxIp.major >= 9)
+    targetFeatures += ",+enable-scratch-bounds-checks";
+
+  if (gfxIp.major >= 10) {
+    // Setup wavefront size per shader stage
+    targetFeatures += ",+wavefrontsize" + std::to_string(waveSize);
+
+    // Allow driver setting for WGP by forcing backend to set 0
+    // which is then OR'ed with the driver set value
+    targetFeatures += ",+cumode";
+  }
+
+  std::string &cachedFeatures = m_targetFeatureStrings[key];
+  cachedFeatures = std::move(targetFeatures);
+  return cachedFeatures;
+}
@@ -37,9 +37,12 @@
 #include "lgc/state/AbiUnlinked.h"
 #include "lgc/state/PipelineState.h"
 #include "lgc/state/TargetInfo.h"
+#include "llvm/BinaryFormat/MsgPackWriter.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 #define DEBUG_TYPE "lgc-pal-metadata"
 
@@ -119,10 +122,13 @@ void PalMetadata::record(Module *module) {
   versionNode[0] = Util::Abi::PipelineMetadataMajorVersion;
   versionNode[1] = Util::Abi::PipelineMetadataMinorVersion;
 
-  // Write the MsgPack document into an IR metadata node.
+  // Write the MsgPack document into an IR metadata node, splicing in any registers staged by setRegister()
+  // so they never need to be built up as document nodes.
   // The IR named metadata node contains an MDTuple containing an MDString containing the msgpack data.
-  std::string blob;
-  m_document->writeToBlob(blob);
+  SmallString<2048> blob;
+  raw_svector_ostream blobStream(blob);
+  msgpack::Writer writer(blobStream);
+  writeNode(m_document->getRoot(), writer);
   MDString *abiMetaString = MDString::get(module->getContext(), blob);
   MDNode *abiMetaNode = MDNode::get(module->getContext(), abiMetaString);
   NamedMDNode *namedMeta = module->getOrInsertNamedMetadata(PalMetadataName);
@@ -134,6 +140,8 @@ void PalMetadata::record(Module *module) {
 //
 // @param blob : MsgPack PAL metadata to merge
 void PalMetadata::mergeFromBlob(StringRef blob) {
+  // Make sure any registers staged by setRegister() are in the document, so the merge sees them.
+  flushStagedRegisters();
   // Use msgpack::Document::readFromBlob to read the new MsgPack PAL metadata, merging it into the msgpack::Document
   // we already have. We pass it a lambda that determines how to cope with merge conflicts, which returns:
   // -1: failure
@@ -337,6 +345,9 @@ void PalMetadata::setUserDataSpillUsage(unsigned dwordOffset) {
 // Fix up user data registers. Any user data register that has one of the unlinked UserDataMapping values defined
 // in AbiUnlinked.h is fixed up by looking at pipeline state.
 void PalMetadata::fixUpRegisters() {
+  // Registers staged by setRegister() must be in the document before we scan it.
+  flushStagedRegisters();
+
   static const std::pair<unsigned, unsigned> ComputeRegRanges[] = {{mmCOMPUTE_USER_DATA_0, 16}};
   static const std::pair<unsigned, unsigned> Gfx8RegRanges[] = {
       {mmSPI_SHADER_USER_DATA_PS_0, 16}, {mmSPI_SHADER_USER_DATA_VS_0, 16}, {mmSPI_SHADER_USER_DATA_GS_0, 16},
@@ -456,13 +467,157 @@ void PalMetadata::finalizePipeline() {
 // Set a register value in PAL metadata.
 // NOTE: If the register is already set, this ORs in the value.
 //
+// The register is staged in a flat (regNum, value) array rather than being written into the MsgPack document,
+// so setting the thousands of registers in a whole-pipeline compilation does not allocate a document node per
+// register, and does not even pay for an ordered insert here: duplicates are merged with a single sort when
+// the staged registers are spliced into the register map as the blob is written in record(). Any value already
+// in the document for the same register (e.g. set by setUserDataEntry(), or read in from an unlinked
+// half-pipeline ELF) is ORed in at that same point.
+//
 // @param regNum : Register number
 // @param value : Value to OR in
 void PalMetadata::setRegister(unsigned regNum, unsigned value) {
-  msgpack::DocNode &node = m_registers[regNum];
-  if (node.getKind() == msgpack::Type::UInt)
-    value |= node.getUInt();
-  node = value;
+  // Callers often set the same register repeatedly in a burst (e.g. field by field); fold those without
+  // growing the array.
+  if (!m_stagedRegisters.empty() && m_stagedRegisters.back().first == regNum) {
+    m_stagedRegisters.back().second |= value;
+    return;
+  }
+  if (!m_stagedRegisters.empty() && m_stagedRegisters.back().first > regNum)
+    m_stagedRegistersSorted = false;
+  m_stagedRegisters.push_back({regNum, value});
+}
+
+// =====================================================================================================================
+// Sort the array of registers staged by setRegister() by register number, and OR together duplicate entries,
+// leaving one entry per register. Appends that arrived already in order (the common case, as the config
+// builders emit registers roughly in address order) skip the sort entirely.
+void PalMetadata::sortStagedRegisters() {
+  if (!m_stagedRegistersSorted) {
+    std::stable_sort(m_stagedRegisters.begin(), m_stagedRegisters.end(),
+                     [](const std::pair<unsigned, unsigned> &a, const std::pair<unsigned, unsigned> &b) {
+                       return a.first < b.first;
+                     });
+    m_stagedRegistersSorted = true;
+  }
+  // Merge runs of duplicate register numbers in place.
+  unsigned outIdx = 0;
+  for (unsigned idx = 0; idx != m_stagedRegisters.size(); ++idx) {
+    if (outIdx != 0 && m_stagedRegisters[outIdx - 1].first == m_stagedRegisters[idx].first)
+      m_stagedRegisters[outIdx - 1].second |= m_stagedRegisters[idx].second;
+    else
+      m_stagedRegisters[outIdx++] = m_stagedRegisters[idx];
+  }
+  m_stagedRegisters.resize(outIdx);
+}
+
+// =====================================================================================================================
+// Flush registers staged by setRegister() into the MsgPack document's register map. This is needed before any
+// operation that reads or merges the document's registers directly, such as mergeFromBlob() or the linker's
+// register fixup; the common whole-pipeline path never needs it, as record() splices the staged registers
+// straight into the blob.
+void PalMetadata::flushStagedRegisters() {
+  sortStagedRegisters();
+  for (const auto &entry : m_stagedRegisters) {
+    msgpack::DocNode &node = m_registers[entry.first];
+    unsigned value = entry.second;
+    if (node.getKind() == msgpack::Type::UInt)
+      value |= node.getUInt();
+    node = value;
+  }
+  m_stagedRegisters.clear();
+}
+
+// =====================================================================================================================
+// Write a MsgPack document node with the given msgpack writer. This is used instead of
+// msgpack::Document::writeToBlob when recording the PAL metadata, so that the registers staged by setRegister()
+// can be spliced into the register map as it is written, without ever building them as document nodes.
+//
+// @param node : Document node to write
+// @param [in/out] writer : MsgPack writer
+void PalMetadata::writeNode(msgpack::DocNode node, msgpack::Writer &writer) {
+  switch (node.getKind()) {
+  case msgpack::Type::Int:
+    writer.write(node.getInt());
+    break;
+  case msgpack::Type::UInt:
+    writer.write(node.getUInt());
+    break;
+  case msgpack::Type::Boolean:
+    writer.write(node.getBool());
+    break;
+  case msgpack::Type::Float:
+    writer.write(node.getFloat());
+    break;
+  case msgpack::Type::String:
+    writer.write(node.getString());
+    break;
+  case msgpack::Type::Nil:
+    writer.writeNil();
+    break;
+  case msgpack::Type::Array: {
+    auto arrayNode = node.getArray();
+    writer.writeArraySize(arrayNode.size());
+    for (unsigned i = 0, e = arrayNode.size(); i != e; ++i)
+      writeNode(arrayNode[i], writer);
+    break;
+  }
+  case msgpack::Type::Map: {
+    auto mapNode = node.getMap();
+    writer.writeMapSize(mapNode.size());
+    for (auto &entry : mapNode) {
+      writeNode(entry.first, writer);
+      if (entry.first.isString() && entry.first.getString() == ".registers")
+        writeRegisters(entry.second.getMap(), writer);
+      else
+        writeNode(entry.second, writer);
+    }
+    break;
+  }
+  default:
+    llvm_unreachable("Unhandled msgpack node type");
+  }
+}
+
+// =====================================================================================================================
+// Write the register map, merging registers staged by setRegister() with any already in the document (e.g. set
+// by setUserDataEntry()). Both sources are sorted by register number, so this is a single merging pass.
+//
+// @param domRegisters : The document's register map node
+// @param [in/out] writer : MsgPack writer
+void PalMetadata::writeRegisters(msgpack::MapDocNode domRegisters, msgpack::Writer &writer) {
+  sortStagedRegisters();
+  // Count the merged map size first; msgpack needs the element count up front.
+  size_t mapSize = m_stagedRegisters.size();
+  for (auto &entry : domRegisters) {
+    const std::pair<unsigned, unsigned> probe = {unsigned(entry.first.getUInt()), 0};
+    if (!std::binary_search(m_stagedRegisters.begin(), m_stagedRegisters.end(), probe,
+                            [](const std::pair<unsigned, unsigned> &a, const std::pair<unsigned, unsigned> &b) {
+                              return a.first < b.first;
+                            }))
+      ++mapSize;
+  }
+  writer.writeMapSize(mapSize);
+
+  auto domIt = domRegisters.begin(), domEnd = domRegisters.end();
+  auto stagedIt = m_stagedRegisters.begin(), stagedEnd = m_stagedRegisters.end();
+  while (domIt != domEnd || stagedIt != stagedEnd) {
+    if (stagedIt == stagedEnd || (domIt != domEnd && domIt->first.getUInt() < stagedIt->first)) {
+      writer.write(domIt->first.getUInt());
+      writeNode(domIt->second, writer);
+      ++domIt;
+    } else {
+      uint64_t value = stagedIt->second;
+      if (domIt != domEnd && domIt->first.getUInt() == stagedIt->first) {
+        // Register both staged and in the document: OR the values, as setRegister() does.
+        value |= domIt->second.getUInt();
+        ++domIt;
+      }
+      writer.write(uint64_t(stagedIt->first));
+      writer.write(value);
+      ++stagedIt;
+    }
+  }
 }
 
 // =====================================================================================================================
@@ -478,6 +633,37 @@ void PalMetadata::setUserDataLimit() {
   *m_userDataLimit = userDataLimit;
 }
 
+// =====================================================================================================================
+// Get an LLVM type from the name used to encode it in PAL metadata, as written by getTypeName.
+//
+// @param tyName : Type name, e.g. "v4f32"
+// @param context : LLVM context
+static Type *getTypeFromName(StringRef tyName, LLVMContext &context) {
+  unsigned vecLength = 0;
+  if (tyName[0] == 'v') {
+    tyName = tyName.drop_front();
+    tyName.consumeInteger(10, vecLength);
+  }
+  Type *ty = nullptr;
+  if (tyName == "i8")
+    ty = Type::getInt8Ty(context);
+  else if (tyName == "i16")
+    ty = Type::getInt16Ty(context);
+  else if (tyName == "i32")
+    ty = Type::getInt32Ty(context);
+  else if (tyName == "i64")
+    ty = Type::getInt64Ty(context);
+  else if (tyName == "f16")
+    ty = Type::getHalfTy(context);
+  else if (tyName == "f32")
+    ty = Type::getFloatTy(context);
+  else if (tyName == "f64")
+    ty = Type::getDoubleTy(context);
+  if (vecLength != 0)
+    ty = VectorType::get(ty, vecLength);
+  return ty;
+}
+
 // =====================================================================================================================
 // Store the vertex fetch information in PAL metadata for a fetchless vertex shader with shader compilation.
 //
@@ -495,6 +681,24 @@ void PalMetadata::addVertexFetchInfo(ArrayRef<VertexFetchInfo> fetches) {
   }
 }
 
+// =====================================================================================================================
+// Store the NGG LDS region layout in PAL metadata. This is an LLPC extension that PAL ignores; it lets offline
+// tooling correlate LDS traffic in GPU captures with the regions laid out by NggLdsManager.
+//
+// @param regions : Array of NggLdsRegionInfo structs, in the order the regions were laid out
+void PalMetadata::addNggLdsLayoutInfo(ArrayRef<NggLdsRegionInfo> regions) {
+  // Each region is an array containing {name,offset,size}.
+  // .nggLdsLayout is an array containing the regions.
+  auto layoutNode = m_pipelineNode[Util::Abi::PipelineMetadataKey::NggLdsLayout].getArray(true);
+  for (const NggLdsRegionInfo &region : regions) {
+    msgpack::ArrayDocNode regionNode = m_document->getArrayNode();
+    regionNode.push_back(m_document->getNode(region.name));
+    regionNode.push_back(m_document->getNode(region.offset));
+    regionNode.push_back(m_document->getNode(region.size));
+    layoutNode.push_back(regionNode);
+  }
+}
+
 // =====================================================================================================================
 // Get the count of vertex fetches for a fetchless vertex shader with shader compilation (or 0 otherwise).
 unsigned PalMetadata::getVertexFetchCount() {
@@ -519,29 +723,7 @@ void PalMetadata::getVertexFetchInfo(SmallVectorImpl<VertexFetchInfo> &fetches)
     msgpack::ArrayDocNode fetchNode = m_vertexInputs[i].getArray();
     unsigned location = fetchNode[0].getUInt();
     unsigned component = fetchNode[1].getUInt();
-    StringRef tyName = fetchNode[2].getString();
-    unsigned vecLength = 0;
-    if (tyName[0] == 'v') {
-      tyName = tyName.drop_front();
-      tyName.consumeInteger(10, vecLength);
-    }
-    Type *ty = nullptr;
-    if (tyName == "i8")
-      ty = Type::getInt8Ty(m_pipelineState->getContext());
-    else if (tyName == "i16")
-      ty = Type::getInt16Ty(m_pipelineState->getContext());
-    else if (tyName == "i32")
-      ty = Type::getInt32Ty(m_pipelineState->getContext());
-    else if (tyName == "i64")
-      ty = Type::getInt64Ty(m_pipelineState->getContext());
-    else if (tyName == "f16")
-      ty = Type::getHalfTy(m_pipelineState->getContext());
-    else if (tyName == "f32")
-      ty = Type::getFloatTy(m_pipelineState->getContext());
-    else if (tyName == "f64")
-      ty = Type::getDoubleTy(m_pipelineState->getContext());
-    if (vecLength != 0)
-      ty = VectorType::get(ty, vecLength);
+    Type *ty = getTypeFromName(fetchNode[2].getString(), m_pipelineState->getContext());
     fetches.push_back({location, component, ty});
   }
   m_pipelineNode.erase(m_document->getNode(PipelineMetadataKey::VertexInputs));
@@ -554,6 +736,9 @@ void PalMetadata::getVertexFetchInfo(SmallVectorImpl<VertexFetchInfo> &fetches)
 void PalMetadata::getVsEntryRegInfo(VsEntryRegInfo &regInfo) {
   regInfo = {};
 
+  // Registers staged by setRegister() must be in the document before we scan it.
+  flushStagedRegisters();
+
   // Find the first hardware shader stage that has SPI registers set. That must be the API VS, or the merged
   // shader containing it. User data register 0 is always set if a shader stage is active.
   static const std::pair<unsigned, unsigned> shaderTable[] = {{mmSPI_SHADER_USER_DATA_LS_0, CallingConv::AMDGPU_LS},
@@ -642,3 +827,52 @@ void PalMetadata::getVsEntryRegInfo(VsEntryRegInfo &regInfo) {
   if (m_pipelineState->getTargetInfo().getGfxIpVersion().major < 10)
     regInfo.wave32 = false;
 }
+
+// =====================================================================================================================
+// Store the color export information in PAL metadata for an exportless fragment shader with shader compilation.
+//
+// @param exports : Array of ColorExportInfo structs
+void PalMetadata::addColorExportInfo(ArrayRef<ColorExportInfo> exports) {
+  // Each color export is an array containing {hwColorTarget,location,isSigned,type}.
+  // .colorExports is an array containing the color exports.
+  m_colorExports = m_pipelineNode[PipelineMetadataKey::ColorExports].getArray(true);
+  for (const ColorExportInfo &exportInfo : exports) {
+    msgpack::ArrayDocNode exportNode = m_document->getArrayNode();
+    exportNode.push_back(m_document->getNode(exportInfo.hwColorTarget));
+    exportNode.push_back(m_document->getNode(exportInfo.location));
+    exportNode.push_back(m_document->getNode(exportInfo.isSigned));
+    exportNode.push_back(m_document->getNode(getTypeName(exportInfo.ty), /*copy=*/true));
+    m_colorExports.push_back(exportNode);
+  }
+}
+
+// =====================================================================================================================
+// Get the count of deferred color exports for an exportless fragment shader (or 0 otherwise).
+unsigned PalMetadata::getColorExportCount() {
+  if (m_colorExports.isEmpty())
+    return 0;
+  return m_colorExports.size();
+}
+
+// =====================================================================================================================
+// Get the color export information out of PAL metadata. Used by the linker to generate the color export shader.
+// Also removes the color export information, so it does not appear in the final linked ELF.
+//
+// @param [out] exports : Vector to store info of each color export
+void PalMetadata::getColorExportInfo(SmallVectorImpl<ColorExportInfo> &exports) {
+  if (m_colorExports.isEmpty()) {
+    auto it = m_pipelineNode.find(m_document->getNode(PipelineMetadataKey::ColorExports));
+    if (it == m_pipelineNode.end() || !it->second.isArray())
+      return;
+    m_colorExports = it->second.getArray();
+  }
+  for (unsigned i = 0, e = m_colorExports.size(); i != e; ++i) {
+    msgpack::ArrayDocNode exportNode = m_colorExports[i].getArray();
+    unsigned hwColorTarget = exportNode[0].getUInt();
+    unsigned location = exportNode[1].getUInt();
+    bool isSigned = exportNode[2].getBool();
+    Type *ty = getTypeFromName(exportNode[3].getString(), m_pipelineState->getContext());
+    exports.push_back({hwColorTarget, location, isSigned, ty});
+  }
+  m_pipelineNode.erase(m_document->getNode(PipelineMetadataKey::ColorExports));
+}
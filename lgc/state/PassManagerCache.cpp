@@ -43,7 +43,9 @@ using namespace llvm;
 namespace lgc {
 
 // =====================================================================================================================
-// Information on how to create a pass manager. This is used as the key in the pass manager cache.
+// Information on how to create a pass manager. This is used as the key in the pass manager cache. The cache
+// lives on the LgcContext, so the graphics IP and optimization level baked into the TargetMachine are already
+// fixed for all entries and do not need to appear in the key.
 struct PassManagerInfo {
   bool isGlue;
 };
@@ -60,6 +62,16 @@ lgc::PassManager &PassManagerCache::getGlueShaderPassManager(raw_pwrite_stream &
   return getPassManager(info, outStream);
 }
 
+// =====================================================================================================================
+// Get pass manager for the codegen phase of a main pipeline compilation. Reusing the fully constructed pass
+// manager avoids repeating pass registration and TargetMachine pass construction for every pipeline.
+//
+// @param outStream : Stream to output ELF info
+lgc::PassManager &PassManagerCache::getCodeGenPassManager(raw_pwrite_stream &outStream) {
+  PassManagerInfo info = {};
+  return getPassManager(info, outStream);
+}
+
 // =====================================================================================================================
 // Get pass manager given a PassManagerInfo
 //
@@ -76,25 +88,24 @@ lgc::PassManager &PassManagerCache::getPassManager(const PassManagerInfo &info,
     return *passManager;
 
   // Need to create the pass manager.
-  // TODO: Creation of a normal compilation pass manager, not just one for a glue shader.
-  assert(info.isGlue && "Non-glue shader compilation not implemented yet");
-
   passManager.reset(PassManager::Create());
   passManager->add(createTargetTransformInfoWrapperPass(m_lgcContext->getTargetMachine()->getTargetIRAnalysis()));
 
   // Manually add a target-aware TLI pass, so optimizations do not think that we have library functions.
   m_lgcContext->preparePassManager(&*passManager);
 
-  // Add a few optimizations.
-  passManager->add(createInstructionCombiningPass(5));
-  passManager->add(createInstSimplifyLegacyPass());
-  passManager->add(createEarlyCSEPass(true));
+  if (info.isGlue) {
+    // Add a few optimizations.
+    passManager->add(createInstructionCombiningPass(5));
+    passManager->add(createInstSimplifyLegacyPass());
+    passManager->add(createEarlyCSEPass(true));
 
-  // Dump the result
-  if (raw_ostream *outs = LgcContext::getLgcOuts()) {
-    passManager->add(
-        createPrintModulePass(*outs, "===============================================================================\n"
-                                     "// LGC glue shader results\n"));
+    // Dump the result
+    if (raw_ostream *outs = LgcContext::getLgcOuts()) {
+      passManager->add(createPrintModulePass(
+          *outs, "===============================================================================\n"
+                 "// LGC glue shader results\n"));
+    }
   }
 
   // Code generation.
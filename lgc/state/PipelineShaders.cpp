@@ -52,25 +52,27 @@ ModulePass *createPipelineShaders() {
 // Run the pass on the specified LLVM module.
 //
 // This populates the shader array. In the pipeline module, a shader entrypoint is a non-internal function definition,
-// and it has metadata giving the SPIR-V execution model.
+// and it has metadata giving the SPIR-V execution model. The stage map additionally caches the stage of every
+// function definition carrying stage metadata (including internal ones), so getShaderStage() here is a cached
+// equivalent of the metadata query done by lgc::getShaderStage().
 //
 // @param [in,out] module : LLVM module to be run on
 bool PipelineShaders::runOnModule(Module &module) {
   LLVM_DEBUG(dbgs() << "Run the pass Pipeline-Shaders\n");
 
-  m_entryPointMap.clear();
+  m_stageMap.clear();
   for (auto &entryPoint : m_entryPoints)
     entryPoint = nullptr;
 
   for (auto &func : module) {
-    if (!func.empty() && func.getLinkage() != GlobalValue::InternalLinkage) {
-      auto shaderStage = lgc::getShaderStage(&func);
-
-      if (shaderStage != ShaderStageInvalid) {
-        m_entryPoints[shaderStage] = &func;
-        m_entryPointMap[&func] = shaderStage;
-      }
-    }
+    if (func.empty())
+      continue;
+    auto shaderStage = lgc::getShaderStage(&func);
+    if (shaderStage == ShaderStageInvalid)
+      continue;
+    m_stageMap[&func] = shaderStage;
+    if (func.getLinkage() != GlobalValue::InternalLinkage)
+      m_entryPoints[shaderStage] = &func;
   }
   return false;
 }
@@ -85,14 +87,38 @@ Function *PipelineShaders::getEntryPoint(ShaderStage shaderStage) const {
 }
 
 // =====================================================================================================================
-// Get the ABI shader stage for a particular function, or ShaderStageInvalid if not a shader entrypoint.
+// Get the shader stage for a particular function, or ShaderStageInvalid if it carries no stage metadata.
 //
 // @param func : Function to look up
 ShaderStage PipelineShaders::getShaderStage(const Function *func) const {
-  auto entryMapIt = m_entryPointMap.find(func);
-  if (entryMapIt == m_entryPointMap.end())
+  auto stageMapIt = m_stageMap.find(func);
+  if (stageMapIt == m_stageMap.end())
     return ShaderStageInvalid;
-  return entryMapIt->second;
+  return stageMapIt->second;
+}
+
+// =====================================================================================================================
+// Record that a pass added, replaced or removed (passing nullptr) the entry-point of a shader stage.
+//
+// This keeps the analysis valid without rescanning the module; a pass calling this should also declare the
+// analysis preserved. A merged entry-point may be registered for several stages; the reverse mapping then
+// reports the stage registered last.
+//
+// @param shaderStage : Shader stage
+// @param entryPoint : New entry-point for the stage, or nullptr if the stage no longer has one
+void PipelineShaders::updateEntryPoint(ShaderStage shaderStage, Function *entryPoint) {
+  assert((unsigned)shaderStage < ShaderStageCountInternal);
+  Function *oldEntryPoint = m_entryPoints[shaderStage];
+  if (oldEntryPoint && oldEntryPoint != entryPoint) {
+    // Only drop the reverse mapping if it still refers to this stage (it might have been re-registered for
+    // another stage by a merge).
+    auto stageMapIt = m_stageMap.find(oldEntryPoint);
+    if (stageMapIt != m_stageMap.end() && stageMapIt->second == shaderStage)
+      m_stageMap.erase(stageMapIt);
+  }
+  m_entryPoints[shaderStage] = entryPoint;
+  if (entryPoint)
+    m_stageMap[entryPoint] = shaderStage;
 }
 
 // =====================================================================================================================
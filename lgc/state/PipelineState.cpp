@@ -333,15 +333,18 @@ void PipelineState::setUserDataNodes(ArrayRef<ResourceNode> nodes) {
     if (node.type == ResourceNodeType::DescriptorTableVaPtr)
       nodeCount += node.innerTable.size();
   }
-  assert(m_allocUserDataNodes == nullptr);
-  m_allocUserDataNodes = std::make_unique<ResourceNode[]>(nodeCount);
+  assert(m_allocUserDataNodes == nullptr && m_userDataNodes.empty());
+  auto allocUserDataNodes = std::make_unique<ResourceNode[]>(nodeCount);
 
   // Copy nodes in.
-  ResourceNode *destTable = m_allocUserDataNodes.get();
+  ResourceNode *destTable = allocUserDataNodes.get();
   ResourceNode *destInnerTable = destTable + nodeCount;
-  m_userDataNodes = ArrayRef<ResourceNode>(destTable, nodes.size());
   setUserDataNodesTable(nodes, destTable, destInnerTable);
   assert(destInnerTable == destTable + nodes.size());
+
+  // Share one canonical copy of the table between pipelines with the same descriptor layout; the copy is owned
+  // by the LgcContext, which outlives this pipeline.
+  m_userDataNodes = getLgcContext()->getCanonicalUserDataNodes(std::move(allocUserDataNodes), nodeCount, nodes.size());
 }
 
 // =====================================================================================================================
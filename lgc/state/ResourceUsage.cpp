@@ -33,7 +33,7 @@
 using namespace lgc;
 
 // =====================================================================================================================
-ResourceUsage::ResourceUsage(ShaderStage shaderStage) {
+ResourceUsage::ResourceUsage(ShaderStage shaderStage) : inOutUsage(arena) {
   if (shaderStage == ShaderStageVertex) {
     // NOTE: For vertex shader, PAL expects base vertex and base instance in user data,
     // even if they are not used in shader.
@@ -32,6 +32,8 @@
 #include "lgc/state/ShaderModes.h"
 #include "lgc/state/IntrinsDefs.h"
 #include "lgc/state/PipelineState.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Module.h"
 
 #define DEBUG_TYPE "lgc-shader-modes"
 
@@ -45,6 +47,99 @@ static const char GeometryShaderModeMetadataName[] = "llpc.geometry.mode";
 static const char FragmentShaderModeMetadataName[] = "llpc.fragment.mode";
 static const char ComputeShaderModeMetadataName[] = "llpc.compute.mode";
 
+// Each mode struct is recorded as a single i64 constant packing its fields, rather than one i32 constant per
+// field, halving (or better) the metadata nodes created and read per compile. The top byte holds a layout
+// version; bump it whenever any of the per-field bit widths below change.
+static const uint64_t PackedModeMetadataVersion = 1;
+
+// Bit position of the layout version within the packed i64.
+static const unsigned PackedModeVersionShift = 56;
+
+// Per-field bit widths of the packed layouts, in field declaration order.
+static const unsigned CommonShaderModeFieldBits[] = {4, 4, 4, 4, 4, 4, 4}; // FP round/denorm modes, useSubgroupSize
+static const unsigned TessellationModeFieldBits[] = {4, 4, 4, 4, 16}; // Spacing, order, primitive mode, point mode,
+                                                                      //  output vertices
+static const unsigned GeometryShaderModeFieldBits[] = {4, 4, 16, 16}; // Input/output primitive kinds, invocations,
+                                                                      //  output vertices
+static const unsigned FragmentShaderModeFieldBits[] = {4, 4, 4, 4};   // Pixel center, early tests, post-depth
+                                                                      //  coverage, conservative depth
+static const unsigned ComputeShaderModeFieldBits[] = {16, 16, 16};    // Workgroup size X, Y, Z
+
+// =====================================================================================================================
+// Packs an all-unsigned-field mode struct into one versioned i64 and sets it as the named metadata node.
+// Mirroring setNamedMetadataToArrayOfInt32, an all-zero struct removes the named metadata node instead.
+//
+// @param [in/out] module : IR module to record into
+// @param value : Mode struct to pack; all fields must be unsigned, in fieldBits order
+// @param fieldBits : Bit width allotted to each field
+// @param metaName : Name for named metadata node
+template <typename T>
+static void setNamedMetadataToPackedInt64(Module *module, const T &value, ArrayRef<unsigned> fieldBits,
+                                          StringRef metaName) {
+  static_assert(sizeof(T) % sizeof(unsigned) == 0, "Mode struct must consist of unsigned fields");
+  assert(fieldBits.size() == sizeof(T) / sizeof(unsigned));
+
+  const unsigned *fields = reinterpret_cast<const unsigned *>(&value);
+  uint64_t packed = 0;
+  unsigned shift = 0;
+  for (unsigned idx = 0; idx != fieldBits.size(); ++idx) {
+    assert(uint64_t(fields[idx]) < (1ull << fieldBits[idx]) && "Mode field overflows its packed bit width");
+    packed |= uint64_t(fields[idx]) << shift;
+    shift += fieldBits[idx];
+  }
+  assert(shift <= PackedModeVersionShift);
+
+  if (packed == 0) {
+    if (auto namedMetaNode = module->getNamedMetadata(metaName))
+      module->eraseNamedMetadata(namedMetaNode);
+    return;
+  }
+  packed |= PackedModeMetadataVersion << PackedModeVersionShift;
+
+  auto &context = module->getContext();
+  auto namedMetaNode = module->getOrInsertNamedMetadata(metaName);
+  namedMetaNode->clearOperands();
+  namedMetaNode->addOperand(
+      MDNode::get(context, ConstantAsMetadata::get(ConstantInt::get(Type::getInt64Ty(context), packed))));
+}
+
+// =====================================================================================================================
+// Reads a packed mode struct back out of the named metadata node. The struct is left untouched if the node is
+// absent or was written with a different layout version.
+//
+// @param module : IR module to look in
+// @param metaName : Name for named metadata node
+// @param fieldBits : Bit width allotted to each field
+// @param [out] value : Mode struct to unpack into (caller must zero initialize)
+template <typename T>
+static void readNamedMetadataPackedInt64(Module *module, StringRef metaName, ArrayRef<unsigned> fieldBits, T &value) {
+  assert(fieldBits.size() == sizeof(T) / sizeof(unsigned));
+
+  auto namedMetaNode = module->getNamedMetadata(metaName);
+  if (!namedMetaNode || namedMetaNode->getNumOperands() == 0)
+    return;
+  MDNode *metaNode = namedMetaNode->getOperand(0);
+  if (metaNode->getNumOperands() != 1)
+    return;
+  auto constMetadata = dyn_cast<ConstantAsMetadata>(metaNode->getOperand(0));
+  if (!constMetadata)
+    return;
+  auto packedConst = dyn_cast<ConstantInt>(constMetadata->getValue());
+  if (!packedConst || packedConst->getBitWidth() != 64)
+    return;
+
+  uint64_t packed = packedConst->getZExtValue();
+  if ((packed >> PackedModeVersionShift) != PackedModeMetadataVersion)
+    return;
+
+  unsigned *fields = reinterpret_cast<unsigned *>(&value);
+  unsigned shift = 0;
+  for (unsigned idx = 0; idx != fieldBits.size(); ++idx) {
+    fields[idx] = (packed >> shift) & ((1ull << fieldBits[idx]) - 1);
+    shift += fieldBits[idx];
+  }
+}
+
 // =====================================================================================================================
 // Clear shader modes
 void ShaderModes::clear() {
@@ -168,14 +263,16 @@ void ShaderModes::record(Module *module) {
   for (unsigned stage = 0; stage < ArrayRef<CommonShaderMode>(m_commonShaderModes).size(); ++stage) {
     std::string metadataName =
         std::string(CommonShaderModeMetadataPrefix) + getShaderStageAbbreviation(static_cast<ShaderStage>(stage));
-    PipelineState::setNamedMetadataToArrayOfInt32(module, m_commonShaderModes[stage], metadataName);
+    setNamedMetadataToPackedInt64(module, m_commonShaderModes[stage], CommonShaderModeFieldBits, metadataName);
   }
 
   // Then the specific shader modes.
-  PipelineState::setNamedMetadataToArrayOfInt32(module, m_tessellationMode, TessellationModeMetadataName);
-  PipelineState::setNamedMetadataToArrayOfInt32(module, m_geometryShaderMode, GeometryShaderModeMetadataName);
-  PipelineState::setNamedMetadataToArrayOfInt32(module, m_fragmentShaderMode, FragmentShaderModeMetadataName);
-  PipelineState::setNamedMetadataToArrayOfInt32(module, m_computeShaderMode, ComputeShaderModeMetadataName);
+  setNamedMetadataToPackedInt64(module, m_tessellationMode, TessellationModeFieldBits, TessellationModeMetadataName);
+  setNamedMetadataToPackedInt64(module, m_geometryShaderMode, GeometryShaderModeFieldBits,
+                                GeometryShaderModeMetadataName);
+  setNamedMetadataToPackedInt64(module, m_fragmentShaderMode, FragmentShaderModeFieldBits,
+                                FragmentShaderModeMetadataName);
+  setNamedMetadataToPackedInt64(module, m_computeShaderMode, ComputeShaderModeFieldBits, ComputeShaderModeMetadataName);
 }
 
 // =====================================================================================================================
@@ -193,22 +290,25 @@ void ShaderModes::readModesFromShader(Module *module, ShaderStage stage) {
   // First the common state.
   std::string metadataName =
       std::string(CommonShaderModeMetadataPrefix) + getShaderStageAbbreviation(static_cast<ShaderStage>(stage));
-  PipelineState::readNamedMetadataArrayOfInt32(module, metadataName, m_commonShaderModes[stage]);
+  readNamedMetadataPackedInt64(module, metadataName, CommonShaderModeFieldBits, m_commonShaderModes[stage]);
 
   // Then the specific shader modes.
   switch (stage) {
   case ShaderStageTessControl:
   case ShaderStageTessEval:
-    PipelineState::readNamedMetadataArrayOfInt32(module, TessellationModeMetadataName, m_tessellationMode);
+    readNamedMetadataPackedInt64(module, TessellationModeMetadataName, TessellationModeFieldBits, m_tessellationMode);
     break;
   case ShaderStageGeometry:
-    PipelineState::readNamedMetadataArrayOfInt32(module, GeometryShaderModeMetadataName, m_geometryShaderMode);
+    readNamedMetadataPackedInt64(module, GeometryShaderModeMetadataName, GeometryShaderModeFieldBits,
+                                 m_geometryShaderMode);
     break;
   case ShaderStageFragment:
-    PipelineState::readNamedMetadataArrayOfInt32(module, FragmentShaderModeMetadataName, m_fragmentShaderMode);
+    readNamedMetadataPackedInt64(module, FragmentShaderModeMetadataName, FragmentShaderModeFieldBits,
+                                 m_fragmentShaderMode);
     break;
   case ShaderStageCompute:
-    PipelineState::readNamedMetadataArrayOfInt32(module, ComputeShaderModeMetadataName, m_computeShaderMode);
+    readNamedMetadataPackedInt64(module, ComputeShaderModeMetadataName, ComputeShaderModeFieldBits,
+                                 m_computeShaderMode);
     break;
   default:
     break;
@@ -224,12 +324,15 @@ void ShaderModes::readModesFromPipeline(Module *module) {
   for (unsigned stage = 0; stage < ArrayRef<CommonShaderMode>(m_commonShaderModes).size(); ++stage) {
     std::string metadataName =
         std::string(CommonShaderModeMetadataPrefix) + getShaderStageAbbreviation(static_cast<ShaderStage>(stage));
-    PipelineState::readNamedMetadataArrayOfInt32(module, metadataName, m_commonShaderModes[stage]);
+    readNamedMetadataPackedInt64(module, metadataName, CommonShaderModeFieldBits, m_commonShaderModes[stage]);
   }
 
   // Then the specific shader modes.
-  PipelineState::readNamedMetadataArrayOfInt32(module, TessellationModeMetadataName, m_tessellationMode);
-  PipelineState::readNamedMetadataArrayOfInt32(module, GeometryShaderModeMetadataName, m_geometryShaderMode);
-  PipelineState::readNamedMetadataArrayOfInt32(module, FragmentShaderModeMetadataName, m_fragmentShaderMode);
-  PipelineState::readNamedMetadataArrayOfInt32(module, ComputeShaderModeMetadataName, m_computeShaderMode);
+  readNamedMetadataPackedInt64(module, TessellationModeMetadataName, TessellationModeFieldBits, m_tessellationMode);
+  readNamedMetadataPackedInt64(module, GeometryShaderModeMetadataName, GeometryShaderModeFieldBits,
+                               m_geometryShaderMode);
+  readNamedMetadataPackedInt64(module, FragmentShaderModeMetadataName, FragmentShaderModeFieldBits,
+                               m_fragmentShaderMode);
+  readNamedMetadataPackedInt64(module, ComputeShaderModeMetadataName, ComputeShaderModeFieldBits,
+                               m_computeShaderMode);
 }
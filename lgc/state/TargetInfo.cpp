@@ -77,6 +77,7 @@ static void setGfx6BaseInfo(TargetInfo *targetInfo) {
   targetInfo->getGpuProperty().descriptorSizeBuffer = 4 * sizeof(uint32_t);
 }
 
+#ifdef LLPC_BUILD_GFX6
 // gfx6
 //
 // @param [in/out] targetInfo : Target info
@@ -118,6 +119,7 @@ static void setGfx601Info(TargetInfo *targetInfo) {
   setGfx6Info(targetInfo);
   targetInfo->getGpuProperty().numShaderEngines = 1;
 }
+#endif
 
 // gfx7+
 //
@@ -128,6 +130,7 @@ static void setGfx7BaseInfo(TargetInfo *targetInfo) {
   targetInfo->getGpuProperty().ldsSizeDwordGranularityShift = 7;
 }
 
+#ifdef LLPC_BUILD_GFX6
 // gfx7
 //
 // @param [in/out] targetInfo : Target info
@@ -174,6 +177,7 @@ static void setGfx703Info(TargetInfo *targetInfo) {
   targetInfo->getGpuWorkarounds().gfx6.shaderSpiBarrierMgmt = 1;
   targetInfo->getGpuWorkarounds().gfx6.shaderSpiCsRegAllocFragmentation = 1;
 }
+#endif
 
 // gfx8+
 //
@@ -182,6 +186,7 @@ static void setGfx8BaseInfo(TargetInfo *targetInfo) {
   setGfx7BaseInfo(targetInfo);
 }
 
+#ifdef LLPC_BUILD_GFX6
 // gfx8
 //
 // @param [in/out] targetInfo : Target info
@@ -231,6 +236,7 @@ static void setGfx81Info(TargetInfo *targetInfo) {
   setGfx8Info(targetInfo);
   targetInfo->getGpuProperty().numShaderEngines = 1;
 }
+#endif
 
 // gfx9+
 //
@@ -332,6 +338,7 @@ bool TargetInfo::setTargetInfo(StringRef gpuName) {
   };
 
   static const GpuNameStringMap GpuNameMap[] = {
+#ifdef LLPC_BUILD_GFX6
     {"gfx600", &setGfx600Info},   // gfx600, tahiti
     {"gfx601", &setGfx601Info},   // gfx601, pitcairn, verde, oland, hainan
     {"gfx700", &setGfx700Info},   // gfx700, kaveri
@@ -345,6 +352,7 @@ bool TargetInfo::setTargetInfo(StringRef gpuName) {
     {"gfx803", &setGfx803Info},   // gfx803, fiji, polaris10, polaris11
     {"gfx804", &setGfx803Info},   // gfx804
     {"gfx810", &setGfx81Info},    // gfx810, stoney
+#endif
     {"gfx900", &setGfx900Info},   // gfx900
     {"gfx901", &setGfx9Info},     // gfx901
     {"gfx902", &setGfx900Info},   // gfx902
@@ -0,0 +1,155 @@
+# -*- Python -*-
+
+# Golden ISA statistics harness.
+#
+# Reads the ISA assembly listing produced by lgc (or amdllpc -v), derives per-shader statistics from it, and
+# compares them against a checked-in baseline with per-entry tolerances, failing on regressions. This turns the
+# ISA-dumping flow into an automated shader-quality gate: a codegen change (e.g. an LLVM uprev) that silently
+# costs instructions, registers or scratch on the compiled corpus fails the affected tests instead of shipping.
+#
+# Statistics, keyed by hardware stage (cs, ps, vs, gs, hs, es, ls):
+#   instructions - number of ISA instructions in the stage's code
+#   branches     - number of branch instructions, a proxy for control-flow/loop structure changes
+#   sgprs        - SGPR count from the PAL metadata emitted by the config builders
+#   vgprs        - VGPR count from the PAL metadata
+#   scratch      - scratch memory size in bytes from the PAL metadata
+#
+# Baseline file format: one "<stage> <metric> <value> [tolerance-percent]" per line, '#' comments allowed.
+# A per-line tolerance overrides --tolerance. A run value of at most baseline * (1 + tolerance/100) passes;
+# improvements beyond the tolerance are reported but do not fail, so baselines can be re-tightened on purpose
+# with --update rather than silently.
+#
+# Usage:
+#   isa-stats.py [--baseline FILE] [--update] [--tolerance PCT] INPUT
+# with INPUT an ISA listing file or '-' for stdin. --update (re)writes the baseline from the current run.
+
+from __future__ import print_function
+
+import argparse
+import re
+import sys
+
+# Label openers of the per-stage entry points, e.g. "_amdgpu_cs_main:".
+ENTRY_LABEL_RE = re.compile(r'^_amdgpu_([a-z]+)_[\w.$]+:')
+# Any label, so instruction attribution stops at the next symbol that is not a basic block.
+LABEL_RE = re.compile(r'^([\w.$]+):')
+# An instruction line: indented mnemonic, not a directive.
+INSTRUCTION_RE = re.compile(r'^\s+([a-zA-Z][\w.]*)')
+# Per-stage register/scratch statistics in the PAL metadata block.
+HW_STAGE_RE = re.compile(r'^\s*\.(cs|ps|vs|gs|hs|es|ls):')
+METADATA_VALUE_RE = re.compile(r'^\s*\.(sgpr_count|vgpr_count|scratch_memory_size):\s*(0x[0-9a-fA-F]+|\d+)')
+
+METRICS = ['instructions', 'branches', 'sgprs', 'vgprs', 'scratch']
+
+
+def collect_stats(lines):
+    """Derives the per-stage statistics from an ISA assembly listing."""
+    stats = {}
+    stage = None
+    metadata_stage = None
+    for line in lines:
+        # Strip trailing comments; the listing uses both separators depending on the assembler dialect.
+        line = line.split(';')[0].split('//')[0].rstrip()
+        if not line:
+            continue
+
+        entry = ENTRY_LABEL_RE.match(line)
+        if entry:
+            stage = entry.group(1)
+            stats.setdefault(stage, dict.fromkeys(METRICS, 0))
+            continue
+        label = LABEL_RE.match(line)
+        if label:
+            # Basic block labels (BB..., .LBB...) keep the current attribution; any other symbol ends it.
+            if not label.group(1).startswith(('BB', '.L')):
+                stage = None
+            continue
+
+        hw_stage = HW_STAGE_RE.match(line)
+        if hw_stage:
+            metadata_stage = hw_stage.group(1)
+            continue
+        value = METADATA_VALUE_RE.match(line)
+        if value and metadata_stage is not None:
+            metric = {'sgpr_count': 'sgprs', 'vgpr_count': 'vgprs', 'scratch_memory_size': 'scratch'}[value.group(1)]
+            stats.setdefault(metadata_stage, dict.fromkeys(METRICS, 0))[metric] = int(value.group(2), 0)
+            continue
+
+        instruction = INSTRUCTION_RE.match(line)
+        if instruction and stage is not None and not instruction.group(1).startswith('.'):
+            stats[stage]['instructions'] += 1
+            if instruction.group(1).startswith(('s_branch', 's_cbranch')):
+                stats[stage]['branches'] += 1
+    return stats
+
+
+def read_baseline(path):
+    """Reads baseline entries as a {(stage, metric): (value, tolerance-or-None)} map."""
+    baseline = {}
+    with open(path) as baseline_file:
+        for line_number, line in enumerate(baseline_file, 1):
+            line = line.split('#')[0].strip()
+            if not line:
+                continue
+            fields = line.split()
+            if len(fields) not in (3, 4) or fields[1] not in METRICS:
+                sys.exit('%s:%d: malformed baseline line: %s' % (path, line_number, line))
+            tolerance = float(fields[3]) if len(fields) == 4 else None
+            baseline[(fields[0], fields[1])] = (int(fields[2]), tolerance)
+    return baseline
+
+
+def write_baseline(path, stats):
+    with open(path, 'w') as baseline_file:
+        baseline_file.write('# Golden ISA statistics; regenerate deliberately with isa-stats.py --update.\n')
+        for stage in sorted(stats):
+            for metric in METRICS:
+                baseline_file.write('%s %s %d\n' % (stage, metric, stats[stage][metric]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare per-shader ISA statistics against a golden baseline.')
+    parser.add_argument('--baseline', required=True, help='baseline statistics file')
+    parser.add_argument('--update', action='store_true', help='rewrite the baseline from the current run')
+    parser.add_argument('--tolerance', type=float, default=0.0,
+                        help='default allowed regression in percent for entries without their own tolerance')
+    parser.add_argument('input', help="ISA assembly listing, or '-' for stdin")
+    args = parser.parse_args()
+
+    lines = sys.stdin.readlines() if args.input == '-' else open(args.input).readlines()
+    stats = collect_stats(lines)
+    if not stats:
+        sys.exit('isa-stats: no shader entry points found in %s' % args.input)
+
+    if args.update:
+        write_baseline(args.baseline, stats)
+        return
+
+    baseline = read_baseline(args.baseline)
+    failed = False
+    for (stage, metric), (golden, tolerance) in sorted(baseline.items()):
+        if tolerance is None:
+            tolerance = args.tolerance
+        if stage not in stats:
+            print('FAIL: stage %s is in the baseline but was not compiled' % stage)
+            failed = True
+            continue
+        value = stats[stage][metric]
+        limit = golden * (1.0 + tolerance / 100.0)
+        if value > limit:
+            print('FAIL: %s %s regressed: %d vs golden %d (+%.1f%% allowed)' % (stage, metric, value, golden,
+                                                                                tolerance))
+            failed = True
+        elif value * (1.0 + tolerance / 100.0) < golden:
+            print('NOTE: %s %s improved: %d vs golden %d; consider refreshing the baseline' % (stage, metric,
+                                                                                               value, golden))
+    for stage in sorted(stats):
+        if not any(key[0] == stage for key in baseline):
+            print('NOTE: stage %s has no baseline entries yet' % stage)
+
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -39,3 +39,9 @@ config.test_exec_root = os.path.join(config.llvm_obj_root, 'test')
 llvm_config.with_environment('PATH', config.llvm_tools_dir, append_path=True)
 
 llvm_config.use_default_substitutions()
+
+# %isa-stats: golden ISA statistics harness; compares per-shader statistics derived from an ISA listing
+# against a checked-in baseline with tolerances. See isa-stats.py for the baseline format.
+config.substitutions.append(
+    ('%isa-stats', '"%s" "%s"' % (config.python_executable,
+                                  os.path.join(config.test_source_root, 'isa-stats.py'))))
@@ -36,8 +36,15 @@
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/Timer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 using namespace lgc;
 using namespace llvm;
@@ -50,6 +57,12 @@ cl::OptionCategory LgcCategory("lgc");
 cl::list<std::string> InFiles(cl::Positional, cl::OneOrMore, cl::ValueRequired, cl::cat(LgcCategory),
                               cl::desc("Input file(s) (\"-\" for stdin)"));
 
+// -bench: microbenchmark mode
+cl::opt<unsigned> Bench("bench",
+                        cl::desc("Compile each input module N times and report the median per-phase compile "
+                                 "times. Inputs are always processed serially in this mode"),
+                        cl::init(0), cl::cat(LgcCategory), cl::value_desc("N"));
+
 // -extract: extract a single module from a multi-module input file
 cl::opt<unsigned> Extract("extract", cl::desc("Extract single module from multi-module input file. Index is 1-based"),
                           cl::init(0), cl::cat(LgcCategory), cl::value_desc("index"));
@@ -58,6 +71,12 @@ cl::opt<unsigned> Extract("extract", cl::desc("Extract single module from multi-
 cl::opt<unsigned> Glue("glue", cl::desc("Compile a single glue shader instead of doing a link. Index is 1-based"),
                        cl::init(0), cl::cat(LgcCategory), cl::value_desc("index"));
 
+// -j: number of parallel compile threads
+cl::opt<unsigned> NumThreads("j",
+                             cl::desc("Number of worker threads used to compile separate input files in "
+                                      "parallel (0 or 1 = compile serially)"),
+                             cl::init(0), cl::cat(LgcCategory), cl::value_desc("N"));
+
 // -l: link
 cl::opt<bool> Link("l", cl::cat(LgcCategory),
                    cl::desc("Link shader/half-pipeline ELFs. First input filename is "
@@ -71,6 +90,16 @@ cl::opt<std::string> OutFileName("o", cl::cat(LgcCategory), cl::desc("Output fil
 cl::opt<unsigned> PalAbiVersion("pal-abi-version", cl::init(0xFFFFFFFF), cl::cat(LgcCategory),
                                 cl::desc("PAL pipeline version to compile for (default latest known)"),
                                 cl::value_desc("version"));
+
+// Compile phases reported by -bench: the three timers understood by Pipeline::generate, plus the overall time
+// of the generate() call.
+enum BenchPhase : unsigned {
+  BenchPhasePatch,   // Patch passes
+  BenchPhaseOpt,     // LLVM optimizations
+  BenchPhaseCodegen, // Codegen
+  BenchPhaseTotal,   // Whole generate() call
+  BenchPhaseCount
+};
 } // anonymous namespace
 
 // =====================================================================================================================
@@ -96,6 +125,232 @@ static bool isIsaText(StringRef data) {
   // with a tab character.
   return data.startswith("\t");
 }
+
+// =====================================================================================================================
+// Returns the median of a set of -bench timing samples, in seconds
+//
+// @param [in/out] samples : Timing samples; sorted in place
+static double medianTime(MutableArrayRef<double> samples) {
+  assert(!samples.empty());
+  std::sort(samples.begin(), samples.end());
+  const size_t mid = samples.size() / 2;
+  if (samples.size() % 2 == 0)
+    return (samples[mid - 1] + samples[mid]) / 2;
+  return samples[mid];
+}
+
+// =====================================================================================================================
+// Processes one input buffer: splits it into modules, then compiles or links each one
+//
+// @param context : LLVM context to parse and compile in
+// @param lgcContext : Corresponding LGC context
+// @param bufferRef : Input buffer to process
+// @param inBuffers : All input buffers; used by the -l (link) option, where inputs after the first are ELFs
+// @param progName : Name of the tool, for error reporting
+// @return : 0 on success, non-zero on error (suitable as the process exit code)
+static int processInputBuffer(LLVMContext &context, LgcContext *lgcContext, MemoryBufferRef bufferRef,
+                              ArrayRef<std::unique_ptr<MemoryBuffer>> inBuffers, const char *progName) {
+  StringRef bufferName = bufferRef.getBufferIdentifier();
+
+  // Split the input into multiple LLVM IR modules. We assume that a new module starts with
+  // a "target" line to set the datalayout or triple, but not until after we have seen at least
+  // one line starting with '!' (metadata declaration) in the previous module.
+  SmallVector<StringRef, 4> separatedAsms;
+  StringRef remaining = bufferRef.getBuffer();
+  separatedAsms.push_back(remaining);
+  bool hadMetadata = false;
+  for (;;) {
+    auto notSpacePos = remaining.find_first_not_of(" \t\n");
+    if (notSpacePos != StringRef::npos) {
+      if (remaining[notSpacePos] == '!')
+        hadMetadata = true;
+      else if (hadMetadata && remaining.slice(notSpacePos, StringRef::npos).startswith("target")) {
+        // End the current split module and go on to the next one.
+        separatedAsms.back() = separatedAsms.back().slice(0, remaining.data() - separatedAsms.back().data());
+        separatedAsms.push_back(remaining);
+        hadMetadata = false;
+      }
+    }
+    auto nlPos = remaining.find_first_of('\n');
+    if (nlPos == StringRef::npos)
+      break;
+    remaining = remaining.slice(nlPos + 1, StringRef::npos);
+  }
+
+  // Check that the -extract option is not out of range.
+  if (Extract > separatedAsms.size()) {
+    errs() << progName << ": " << bufferName << ": Not enough modules for -extract value\n";
+    return 1;
+  }
+
+  // Process each module. Put extra newlines at the start of each one other than the first so that
+  // line numbers are correct for error reporting.
+  unsigned extraNlCount = 0;
+  for (unsigned idx = 0; idx != separatedAsms.size(); ++idx) {
+    StringRef separatedAsm = separatedAsms[idx];
+    std::string asmText;
+    asmText.insert(asmText.end(), extraNlCount, '\n');
+    extraNlCount += separatedAsm.count('\n');
+    asmText += separatedAsm;
+
+    // Skip this module if -extract was specified for a different index.
+    if (Extract && Extract != idx + 1)
+      continue;
+
+    // Use a MemoryBufferRef with the original filename so error reporting reports it.
+    MemoryBufferRef asmBuffer(asmText, bufferName);
+
+    // Assemble the text
+    SMDiagnostic error;
+    std::unique_ptr<Module> module = parseAssembly(asmBuffer, error, context);
+    if (!module) {
+      error.print(progName, errs());
+      errs() << "\n";
+      return 1;
+    }
+
+    // Verify the resulting IR.
+    if (verifyModule(*module, &errs())) {
+      errs() << progName << ": " << bufferName << ": IR verification errors in module " << idx << "\n";
+      return 1;
+    }
+
+    // Determine whether we are outputting to a file.
+    bool outputToFile = OutFileName != "-";
+    if (OutFileName.empty()) {
+      // No -o specified: output to stdout if input is -
+      outputToFile = bufferName != "-" && bufferName != "<stdin>";
+    }
+
+    SmallString<64> outFileName;
+    if (OutFileName.empty()) {
+      // Start to determine the output filename by taking the input filename, removing the directory,
+      // removing the extension. We add the extension below once we can see what the output contents
+      // look like.
+      outFileName = sys::path::stem(bufferName);
+    }
+
+    SmallString<16> outBuffer;
+    raw_svector_ostream outStream(outBuffer);
+    std::unique_ptr<Pipeline> pipeline(lgcContext->createPipeline());
+    StringRef err;
+
+    if (Link) {
+      // The -l option (link) is handled differently: We have just read the first input file as IR, and
+      // we get the pipeline state from that. Subsequent input files are ELF, and we link them.
+      pipeline->setStateFromModule(&*module);
+
+      SmallVector<MemoryBufferRef, 4> elfRefs;
+      for (unsigned i = 1; i != inBuffers.size(); ++i)
+        elfRefs.push_back(inBuffers[i]->getMemBufferRef());
+      std::unique_ptr<ElfLinker> elfLinker(pipeline->createElfLinker(elfRefs));
+
+      if (Glue) {
+        // Instead of doing a full link, we have been asked to compile a glue shader used in a link.
+        ArrayRef<StringRef> glueInfo = elfLinker->getGlueInfo();
+        if (Glue > glueInfo.size())
+          report_fatal_error("Only " + Twine(glueInfo.size()) + " glue shader(s) in this link");
+        outStream << elfLinker->compileGlue(Glue - 1);
+        if (outStream.str().empty())
+          err = pipeline->getLastError();
+      } else {
+        // Do a full link.
+        if (!elfLinker->link(outStream))
+          err = pipeline->getLastError();
+      }
+    } else {
+      // Run the middle-end compiler. With -bench, compile the module repeatedly, collecting per-phase times
+      // through the timers interface of Pipeline::generate and reporting the median of each phase.
+      const unsigned runCount = std::max(Bench.getValue(), 1u);
+      SmallVector<double, 8> sampleTimes[BenchPhaseCount];
+      for (unsigned run = 0; run != runCount && err == ""; ++run) {
+        if (run != 0) {
+          // generate() consumed the module and the pipeline state on the previous run; re-create both.
+          // The text parsed successfully the first time round, so it cannot fail now.
+          module = parseAssembly(asmBuffer, error, context);
+          assert(module);
+          pipeline.reset(lgcContext->createPipeline());
+          outBuffer.clear();
+        }
+        Timer phaseTimers[] = {
+            {"patch", "Patch passes"}, {"opt", "LLVM optimizations"}, {"codegen", "Codegen"}};
+        Timer *timers[] = {&phaseTimers[BenchPhasePatch], &phaseTimers[BenchPhaseOpt],
+                           &phaseTimers[BenchPhaseCodegen]};
+        ArrayRef<Timer *> timersArg;
+        if (Bench)
+          timersArg = timers;
+        const auto startTime = std::chrono::steady_clock::now();
+        if (!pipeline->generate(std::move(module), outStream, nullptr, timersArg, {}))
+          err = pipeline->getLastError();
+        if (Bench) {
+          const std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - startTime;
+          sampleTimes[BenchPhaseTotal].push_back(totalTime.count());
+          for (unsigned phase = 0; phase != BenchPhaseTotal; ++phase) {
+            sampleTimes[phase].push_back(phaseTimers[phase].getTotalTime().getWallTime());
+            // Reset the timer so the default timer group does not print it at shutdown.
+            phaseTimers[phase].clear();
+          }
+        }
+      }
+      if (Bench && err == "") {
+        outs() << "lgc-bench: " << bufferName;
+        if (separatedAsms.size() > 1)
+          outs() << " module " << idx + 1;
+        outs() << ": " << runCount << " runs, median seconds:"
+               << format(" total %.6f", medianTime(sampleTimes[BenchPhaseTotal]))
+               << format(", patch %.6f", medianTime(sampleTimes[BenchPhasePatch]))
+               << format(", opt %.6f", medianTime(sampleTimes[BenchPhaseOpt]))
+               << format(", codegen %.6f", medianTime(sampleTimes[BenchPhaseCodegen])) << "\n";
+      }
+    }
+
+    if (err != "") {
+      // Link or compile reported recoverable error.
+      errs() << err << "\n";
+      return 1;
+    }
+
+    if (outputToFile == false) {
+      // Output to stdout.
+      outs() << outBuffer;
+    } else {
+      // Output to file.
+      if (outFileName.empty()) {
+        // Use given filename.
+        outFileName = OutFileName;
+      } else {
+        // We are in the middle of deriving the output filename from the input filename. Add the
+        // extension now.
+        const char *ext = ".s";
+        if (isElfBinary(outBuffer)) {
+          ext = ".elf";
+        } else if (isIsaText(outBuffer)) {
+          ext = ".s";
+        } else {
+          ext = ".ll";
+        }
+        outFileName += ext;
+      }
+
+      bool fileWriteSuccess = false;
+      if (FILE *outFile = fopen(outFileName.c_str(), "wb")) {
+        if (fwrite(outBuffer.data(), 1, outBuffer.size(), outFile) == outBuffer.size())
+          fileWriteSuccess = fclose(outFile) == 0;
+      }
+      if (!fileWriteSuccess) {
+        errs() << progName << ": " << outFileName << ": " << strerror(errno) << "\n";
+        return 1;
+      }
+    }
+
+    // With the -l option (link), we have already consumed all the input files.
+    if (Link)
+      return 0;
+  }
+
+  return 0;
+}
+
 // =====================================================================================================================
 // Main code of LGC standalone tool
 //
@@ -159,8 +414,10 @@ int main(int argc, char **argv) {
 
   // Read the input files.
   SmallVector<std::unique_ptr<MemoryBuffer>, 4> inBuffers;
+  bool anyStdinInput = false;
   for (auto inFileName : InFiles) {
     // Read the input file. getFileOrSTDIN handles the case of inFileName being "-".
+    anyStdinInput |= inFileName == "-";
     ErrorOr<std::unique_ptr<MemoryBuffer>> fileOrErr = MemoryBuffer::getFileOrSTDIN(inFileName);
     if (std::error_code errorCode = fileOrErr.getError()) {
       auto error = SMDiagnostic(inFileName, SourceMgr::DK_Error, "Could not open input file: " + errorCode.message());
@@ -171,166 +428,41 @@ int main(int argc, char **argv) {
     inBuffers.push_back(std::move(*fileOrErr));
   }
 
-  // Process each input file.
-  for (auto &inBuffer : inBuffers) {
-    MemoryBufferRef bufferRef = inBuffer->getMemBufferRef();
-    StringRef bufferName = bufferRef.getBufferIdentifier();
-
-    // Split the input into multiple LLVM IR modules. We assume that a new module starts with
-    // a "target" line to set the datalayout or triple, but not until after we have seen at least
-    // one line starting with '!' (metadata declaration) in the previous module.
-    SmallVector<StringRef, 4> separatedAsms;
-    StringRef remaining = bufferRef.getBuffer();
-    separatedAsms.push_back(remaining);
-    bool hadMetadata = false;
-    for (;;) {
-      auto notSpacePos = remaining.find_first_not_of(" \t\n");
-      if (notSpacePos != StringRef::npos) {
-        if (remaining[notSpacePos] == '!')
-          hadMetadata = true;
-        else if (hadMetadata && remaining.slice(notSpacePos, StringRef::npos).startswith("target")) {
-          // End the current split module and go on to the next one.
-          separatedAsms.back() = separatedAsms.back().slice(0, remaining.data() - separatedAsms.back().data());
-          separatedAsms.push_back(remaining);
-          hadMetadata = false;
+  // Process separate input files in parallel when -j asks for it. Each worker thread uses its own LLVMContext
+  // and LgcContext, so the compiles are fully independent; log output of concurrently processed files may
+  // interleave. Linking, -bench runs (which want unperturbed timings), and anything reading stdin or writing
+  // everything to one -o output stay serial.
+  if (!Link && !Bench && NumThreads > 1 && inBuffers.size() > 1 && OutFileName.empty() && !anyStdinInput) {
+    const unsigned threadCount = std::min(NumThreads.getValue(), static_cast<unsigned>(inBuffers.size()));
+    std::atomic<unsigned> nextInput(0);
+    std::atomic<int> result(0);
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i != threadCount; ++i) {
+      workers.emplace_back([&inBuffers, &nextInput, &result, gpuName, progName] {
+        LLVMContext workerContext;
+        std::unique_ptr<LgcContext> workerLgcContext(LgcContext::Create(workerContext, gpuName, PalAbiVersion));
+        for (;;) {
+          const unsigned inputIndex = nextInput.fetch_add(1);
+          if (inputIndex >= inBuffers.size())
+            break;
+          if (int ret = processInputBuffer(workerContext, &*workerLgcContext, inBuffers[inputIndex]->getMemBufferRef(),
+                                           inBuffers, progName))
+            result.store(ret);
         }
-      }
-      auto nlPos = remaining.find_first_of('\n');
-      if (nlPos == StringRef::npos)
-        break;
-      remaining = remaining.slice(nlPos + 1, StringRef::npos);
-    }
-
-    // Check that the -extract option is not out of range.
-    if (Extract > separatedAsms.size()) {
-      errs() << progName << ": " << bufferName << ": Not enough modules for -extract value\n";
-      exit(1);
+      });
     }
+    for (std::thread &worker : workers)
+      worker.join();
+    return result.load();
+  }
 
-    // Process each module. Put extra newlines at the start of each one other than the first so that
-    // line numbers are correct for error reporting.
-    unsigned extraNlCount = 0;
-    for (unsigned idx = 0; idx != separatedAsms.size(); ++idx) {
-      StringRef separatedAsm = separatedAsms[idx];
-      std::string asmText;
-      asmText.insert(asmText.end(), extraNlCount, '\n');
-      extraNlCount += separatedAsm.count('\n');
-      asmText += separatedAsm;
-
-      // Skip this module if -extract was specified for a different index.
-      if (Extract && Extract != idx + 1)
-        continue;
-
-      // Use a MemoryBufferRef with the original filename so error reporting reports it.
-      MemoryBufferRef asmBuffer(asmText, bufferName);
-
-      // Assemble the text
-      SMDiagnostic error;
-      std::unique_ptr<Module> module = parseAssembly(asmBuffer, error, context);
-      if (!module) {
-        error.print(progName, errs());
-        errs() << "\n";
-        return 1;
-      }
-
-      // Verify the resulting IR.
-      if (verifyModule(*module, &errs())) {
-        errs() << progName << ": " << bufferName << ": IR verification errors in module " << idx << "\n";
-        return 1;
-      }
-
-      // Determine whether we are outputting to a file.
-      bool outputToFile = OutFileName != "-";
-      if (OutFileName.empty()) {
-        // No -o specified: output to stdout if input is -
-        outputToFile = bufferName != "-" && bufferName != "<stdin>";
-      }
-
-      SmallString<64> outFileName;
-      if (OutFileName.empty()) {
-        // Start to determine the output filename by taking the input filename, removing the directory,
-        // removing the extension. We add the extension below once we can see what the output contents
-        // look like.
-        outFileName = sys::path::stem(bufferName);
-      }
-
-      SmallString<16> outBuffer;
-      raw_svector_ostream outStream(outBuffer);
-      std::unique_ptr<Pipeline> pipeline(lgcContext->createPipeline());
-      StringRef err;
-
-      if (Link) {
-        // The -l option (link) is handled differently: We have just read the first input file as IR, and
-        // we get the pipeline state from that. Subsequent input files are ELF, and we link them.
-        pipeline->setStateFromModule(&*module);
-
-        SmallVector<MemoryBufferRef, 4> elfRefs;
-        for (unsigned i = 1; i != inBuffers.size(); ++i)
-          elfRefs.push_back(inBuffers[i]->getMemBufferRef());
-        std::unique_ptr<ElfLinker> elfLinker(pipeline->createElfLinker(elfRefs));
-
-        if (Glue) {
-          // Instead of doing a full link, we have been asked to compile a glue shader used in a link.
-          ArrayRef<StringRef> glueInfo = elfLinker->getGlueInfo();
-          if (Glue > glueInfo.size())
-            report_fatal_error("Only " + Twine(glueInfo.size()) + " glue shader(s) in this link");
-          outStream << elfLinker->compileGlue(Glue - 1);
-          if (outStream.str().empty())
-            err = pipeline->getLastError();
-        } else {
-          // Do a full link.
-          if (!elfLinker->link(outStream))
-            err = pipeline->getLastError();
-        }
-      } else {
-        // Run the middle-end compiler.
-        if (!pipeline->generate(std::move(module), outStream, nullptr, {}, {}))
-          err = pipeline->getLastError();
-      }
-
-      if (err != "") {
-        // Link or compile reported recoverable error.
-        errs() << err << "\n";
-        return 1;
-      }
-
-      if (outputToFile == false) {
-        // Output to stdout.
-        outs() << outBuffer;
-      } else {
-        // Output to file.
-        if (outFileName.empty()) {
-          // Use given filename.
-          outFileName = OutFileName;
-        } else {
-          // We are in the middle of deriving the output filename from the input filename. Add the
-          // extension now.
-          const char *ext = ".s";
-          if (isElfBinary(outBuffer)) {
-            ext = ".elf";
-          } else if (isIsaText(outBuffer)) {
-            ext = ".s";
-          } else {
-            ext = ".ll";
-          }
-          outFileName += ext;
-        }
-
-        bool fileWriteSuccess = false;
-        if (FILE *outFile = fopen(outFileName.c_str(), "wb")) {
-          if (fwrite(outBuffer.data(), 1, outBuffer.size(), outFile) == outBuffer.size())
-            fileWriteSuccess = fclose(outFile) == 0;
-        }
-        if (!fileWriteSuccess) {
-          errs() << progName << ": " << outFileName << ": " << strerror(errno) << "\n";
-          return 1;
-        }
-      }
-
-      // With the -l option (link), we have already consumed all the input files.
-      if (Link)
-        return 0;
-    }
+  // Process each input file.
+  for (auto &inBuffer : inBuffers) {
+    if (int ret = processInputBuffer(context, &*lgcContext, inBuffer->getMemBufferRef(), inBuffers, progName))
+      return ret;
+    // With the -l option (link), the first input file's module consumed all the input files.
+    if (Link)
+      break;
   }
 
   return 0;
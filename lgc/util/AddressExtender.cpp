@@ -46,6 +46,21 @@ Instruction *AddressExtender::getFirstInsertionPt() {
   return &*m_func->front().getFirstInsertionPt();
 }
 
+// =====================================================================================================================
+// Get the insertion point for the shared extension code of the given input address. The chosen point dominates
+// every possible use of the input, so the extended address can be reused by all extend() calls for it.
+//
+// @param addr32 : Address as 32-bit value
+Instruction *AddressExtender::getExtensionInsertionPt(Value *addr32) {
+  if (auto inst = dyn_cast<Instruction>(addr32)) {
+    if (isa<PHINode>(inst))
+      return &*inst->getParent()->getFirstInsertionPt();
+    return inst->getNextNode();
+  }
+  // Arguments and constants are extended at the start of the function, after PC-getting code if already inserted.
+  return getFirstInsertionPt();
+}
+
 // =====================================================================================================================
 // Extend an i32 into a 64-bit pointer
 //
@@ -55,17 +70,27 @@ Instruction *AddressExtender::getFirstInsertionPt() {
 // @param builder : IRBuilder to use, already set to the required insert point
 // @return : 64-bit pointer value
 Instruction *AddressExtender::extend(Value *addr32, unsigned highHalf, Type *ptrTy, IRBuilder<> &builder) {
-  Value *ptr = nullptr;
-  if (highHalf == HighAddrPc) {
-    // Extend with PC.
-    ptr = builder.CreateInsertElement(getPc(), addr32, uint64_t(0));
-  } else {
-    // Extend with given value
-    ptr = builder.CreateInsertElement(UndefValue::get(VectorType::get(builder.getInt32Ty(), 2)), addr32, uint64_t(0));
-    ptr = builder.CreateInsertElement(ptr, builder.getInt32(highHalf), 1);
+  // The same (input, high half) pair is only extended once per function, at a point dominating all uses of the
+  // input; later extend() calls for it reuse the 64-bit address, so shaders addressing many descriptor tables do
+  // not accumulate duplicate extension sequences that CSE may or may not clean up.
+  Value *&addr64 = m_extended[{addr32, highHalf}];
+  if (!addr64) {
+    // This uses its own builder, as the shared code must not be inserted at the caller's use site.
+    IRBuilder<> extendBuilder(m_func->getContext());
+    extendBuilder.SetInsertPoint(getExtensionInsertionPt(addr32));
+    Value *ptr = nullptr;
+    if (highHalf == HighAddrPc) {
+      // Extend with PC.
+      ptr = extendBuilder.CreateInsertElement(getPc(), addr32, uint64_t(0));
+    } else {
+      // Extend with given value
+      ptr = extendBuilder.CreateInsertElement(UndefValue::get(VectorType::get(extendBuilder.getInt32Ty(), 2)), addr32,
+                                              uint64_t(0));
+      ptr = extendBuilder.CreateInsertElement(ptr, extendBuilder.getInt32(highHalf), 1);
+    }
+    addr64 = extendBuilder.CreateBitCast(ptr, extendBuilder.getInt64Ty());
   }
-  ptr = builder.CreateBitCast(ptr, builder.getInt64Ty());
-  return cast<Instruction>(builder.CreateIntToPtr(ptr, ptrTy));
+  return cast<Instruction>(builder.CreateIntToPtr(addr64, ptrTy));
 }
 
 // =====================================================================================================================
@@ -29,7 +29,6 @@
 ***********************************************************************************************************************
 */
 #include "lgc/util/GfxRegHandler.h"
-#include "llvm/IR/IntrinsicsAMDGPU.h"
 
 using namespace lgc;
 using namespace llvm;
@@ -70,9 +69,17 @@ Value *GfxRegHandler::getRegCommon(unsigned regId) {
 // @param regIdLo : The ID of low part register
 // @param regIdHi : Reg ID of high part register
 Value *GfxRegHandler::getRegCombine(unsigned regIdLo, unsigned regIdHi) {
+  const BitsInfo &bitsInfoLo = m_bitsInfo[regIdLo];
+  const BitsInfo &bitsInfoHi = m_bitsInfo[regIdHi];
+
+  // When the two parts are adjacent within one dword they form a single contiguous bit range, so the combined
+  // value can be fetched with one extract instead of extracting the parts and re-concatenating them.
+  if (bitsInfoLo.index == bitsInfoHi.index && bitsInfoLo.offset + bitsInfoLo.count == bitsInfoHi.offset)
+    return getBits({bitsInfoLo.index, bitsInfoLo.offset, bitsInfoLo.count + bitsInfoHi.count});
+
   Value *regValueLo = getRegCommon(regIdLo);
   Value *regValueHi = getRegCommon(regIdHi);
-  return m_builder->CreateOr(m_builder->CreateShl(regValueHi, m_bitsInfo[regIdLo].count), regValueLo);
+  return m_builder->CreateOr(m_builder->CreateShl(regValueHi, bitsInfoLo.count), regValueLo);
 }
 
 // =====================================================================================================================
@@ -83,9 +90,9 @@ Value *GfxRegHandler::getRegCombine(unsigned regIdLo, unsigned regIdHi) {
 // @param regIdHi : Reg ID of high part register
 // @param regValue : Data used for setting
 void GfxRegHandler::setRegCombine(unsigned regIdLo, unsigned regIdHi, Value *regValue) {
+  // The low part starts at bit zero of the input, so a plain mask extracts it; no bitfield intrinsic needed.
   Value *regValueLo =
-      m_builder->CreateIntrinsic(Intrinsic::amdgcn_ubfe, m_builder->getInt32Ty(),
-                                 {regValue, m_builder->getInt32(0), m_builder->getInt32(m_bitsInfo[regIdLo].count)});
+      m_builder->CreateAnd(regValue, m_builder->getInt32((1u << m_bitsInfo[regIdLo].count) - 1));
 
   Value *regValueHi = m_builder->CreateLShr(regValue, m_builder->getInt32(m_bitsInfo[regIdLo].count));
 
@@ -100,6 +107,7 @@ static constexpr BitsInfo SqImgSampRegBitsGfx9[static_cast<unsigned>(SqSampRegs:
     {0, 30, 2}, // FilterMode
     {2, 20, 2}, // XyMagFilter
     {2, 22, 2}, // XyMinFilter
+    {2, 20, 4}, // XyMagMinFilter
 };
 
 // =====================================================================================================================
@@ -133,6 +141,7 @@ Value *SqImgSampRegHandler::getReg(SqSampRegs regId) {
   case SqSampRegs::FilterMode:
   case SqSampRegs::xyMagFilter:
   case SqSampRegs::xyMinFilter:
+  case SqSampRegs::xyMagMinFilter:
     return getRegCommon(static_cast<unsigned>(regId));
   default:
     // TODO: More will be implemented.
@@ -150,9 +159,19 @@ Value *SqImgSampRegHandler::getReg(SqSampRegs regId) {
 void SqImgSampRegHandler::setReg(SqSampRegs regId, Value *regValue) {
   switch (regId) {
   case SqSampRegs::FilterMode:
+    setRegCommon(static_cast<unsigned>(regId), regValue);
+    break;
   case SqSampRegs::xyMagFilter:
   case SqSampRegs::xyMinFilter:
     setRegCommon(static_cast<unsigned>(regId), regValue);
+    // The combined field overlaps the single-filter fields, so its cached value is now out of date
+    markRegModified(static_cast<unsigned>(SqSampRegs::xyMagMinFilter));
+    break;
+  case SqSampRegs::xyMagMinFilter:
+    setRegCommon(static_cast<unsigned>(regId), regValue);
+    // The combined field overlaps the single-filter fields, so their cached values are now out of date
+    markRegModified(static_cast<unsigned>(SqSampRegs::xyMagFilter));
+    markRegModified(static_cast<unsigned>(SqSampRegs::xyMinFilter));
     break;
   default:
     llvm_unreachable("Bad SqImgSampRegHandler::SetReg!");
@@ -95,6 +95,14 @@ Value *GfxRegHandlerBase::getBits(const BitsInfo &bitsInfo) {
 
   extractDwordIfNecessary(bitsInfo.index);
 
+  // A field that touches a dword boundary only needs a plain mask or shift, which stays transparent to later IR
+  // optimization; the opaque ubfe intrinsic is kept for interior fields, where it maps to a single ISA instruction.
+  if (bitsInfo.offset == 0)
+    return m_builder->CreateAnd(m_dwords[bitsInfo.index], m_builder->getInt32((1u << bitsInfo.count) - 1));
+
+  if (bitsInfo.offset + bitsInfo.count == 32)
+    return m_builder->CreateLShr(m_dwords[bitsInfo.index], m_builder->getInt32(bitsInfo.offset));
+
   return m_builder->CreateIntrinsic(
       Intrinsic::amdgcn_ubfe, m_builder->getInt32Ty(),
       {m_dwords[bitsInfo.index], m_builder->getInt32(bitsInfo.offset), m_builder->getInt32(bitsInfo.count)});
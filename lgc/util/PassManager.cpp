@@ -33,6 +33,8 @@
 #include "llvm/Analysis/CFGPrinter.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/CommandLine.h"
+#include <atomic>
+#include <chrono>
 
 namespace llvm {
 namespace cl {
@@ -58,8 +60,55 @@ static cl::list<unsigned> DisablePassIndices("disable-pass-indices", cl::ZeroOrM
 using namespace lgc;
 using namespace llvm;
 
+// Whether any caller has ever requested per-pass timing; pass-time markers are only inserted once this is set.
+static std::atomic<bool> PassTimingRequested(false);
+
+// Per-thread collection vector for pass times, or nullptr if the thread is not collecting
+static thread_local SmallVectorImpl<lgc::PassTimeInfo> *PassTimesOnThread = nullptr;
+
+// Per-thread monotonic time of the last pass-time sample
+static thread_local uint64_t LastPassTimeNanos = 0;
+
+// Per-thread cancellation flag of the compilation in progress, or nullptr if the thread's compilations are not
+// cancelable
+static thread_local const std::atomic<bool> *CancelFlagOnThread = nullptr;
+
+// =====================================================================================================================
+// Gets the current monotonic time in nanoseconds.
+static uint64_t getMonotonicNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
 namespace {
 
+// =====================================================================================================================
+// Marker pass inserted after each real pass when per-pass timing has been requested. When its thread is
+// collecting, it attributes the time since the previous marker (or the start of the run) to the preceding pass.
+class PassTimeMarker final : public ModulePass {
+public:
+  static char ID;
+  PassTimeMarker() : ModulePass(ID) {}
+  PassTimeMarker(StringRef passName) : ModulePass(ID), m_passName(passName) {}
+
+  bool runOnModule(Module &module) override {
+    if (SmallVectorImpl<lgc::PassTimeInfo> *passTimes = PassTimesOnThread) {
+      uint64_t now = getMonotonicNanos();
+      passTimes->push_back({m_passName, now - LastPassTimeNanos});
+      LastPassTimeNanos = now;
+    }
+    return false;
+  }
+
+private:
+  PassTimeMarker(const PassTimeMarker &) = delete;
+  PassTimeMarker &operator=(const PassTimeMarker &) = delete;
+
+  StringRef m_passName; // Name of the preceding pass that the sampled time is attributed to
+};
+
+char PassTimeMarker::ID = 0;
+
 // =====================================================================================================================
 // LLPC's legacy::PassManager override.
 // This is the implementation subclass of the PassManager class declared in PassManager.h
@@ -71,6 +120,7 @@ public:
   void setPassIndex(unsigned *passIndex) override { m_passIndex = passIndex; }
   void add(Pass *pass) override;
   void stop() override;
+  bool run(Module &module) override;
 
 private:
   bool m_stopped = false;               // Whether we have already stopped adding new passes.
@@ -154,6 +204,11 @@ void PassManagerImpl::add(Pass *pass) {
   // Add the pass to the superclass pass manager.
   legacy::PassManager::add(pass);
 
+  // Insert a sampling marker after the pass when per-pass timing has been requested. The marker is a no-op on
+  // threads that are not collecting.
+  if (PassTimingRequested.load(std::memory_order_relaxed))
+    legacy::PassManager::add(new PassTimeMarker(pass->getPassName()));
+
   if (cl::VerifyIr) {
     // Add a verify pass after it.
     legacy::PassManager::add(createVerifierPass(true)); // FatalErrors=true
@@ -170,3 +225,56 @@ void PassManagerImpl::add(Pass *pass) {
 void PassManagerImpl::stop() {
   m_stopped = true;
 }
+
+// =====================================================================================================================
+// Run the passes. Resets the per-thread pass-time sample point first, so the first pass-time marker does not
+// get charged with time spent between pass manager runs.
+//
+// @param [in/out] module : Module to run the passes on
+bool PassManagerImpl::run(Module &module) {
+  // A canceled compilation skips every remaining phase; the caller notices via isCanceledOnThread and
+  // abandons the build without consuming the (untouched) module or output stream.
+  if (PassManager::isCanceledOnThread())
+    return false;
+  if (PassTimesOnThread)
+    LastPassTimeNanos = getMonotonicNanos();
+  return legacy::PassManager::run(module);
+}
+
+// =====================================================================================================================
+// Start collecting the wall-clock time of each pass run by any lgc PassManager on the calling thread into the
+// given vector, until stopPassTimingOnThread is called.
+//
+// @param [out] passTimes : Vector the per-pass times are appended to
+void lgc::PassManager::startPassTimingOnThread(SmallVectorImpl<PassTimeInfo> *passTimes) {
+  PassTimingRequested.store(true, std::memory_order_relaxed);
+  PassTimesOnThread = passTimes;
+  LastPassTimeNanos = getMonotonicNanos();
+}
+
+// =====================================================================================================================
+// Stop collecting per-pass times on the calling thread.
+void lgc::PassManager::stopPassTimingOnThread() {
+  PassTimesOnThread = nullptr;
+}
+
+// =====================================================================================================================
+// Register a cancellation flag for compilations on the calling thread, until clearCancelFlagOnThread is called.
+// Once the flag becomes true, run() calls by this thread return immediately without running any pass.
+//
+// @param canceled : Flag raised by another thread to cancel the compilation in progress
+void lgc::PassManager::setCancelFlagOnThread(const std::atomic<bool> *canceled) {
+  CancelFlagOnThread = canceled;
+}
+
+// =====================================================================================================================
+// Stop honoring a previously registered cancellation flag on the calling thread.
+void lgc::PassManager::clearCancelFlagOnThread() {
+  CancelFlagOnThread = nullptr;
+}
+
+// =====================================================================================================================
+// Checks whether the cancellation flag registered on the calling thread (if any) has been raised.
+bool lgc::PassManager::isCanceledOnThread() {
+  return CancelFlagOnThread && CancelFlagOnThread->load(std::memory_order_relaxed);
+}
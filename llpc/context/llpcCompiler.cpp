@@ -48,7 +48,9 @@
 #include "lgc/Builder.h"
 #include "lgc/ElfLinker.h"
 #include "lgc/PassManager.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/Bitcode/BitcodeWriterPass.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/DiagnosticPrinter.h"
@@ -57,12 +59,19 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO/AlwaysInliner.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
 #include <mutex>
 #include <set>
+#include <thread>
 #include <unordered_set>
 
 #ifdef LLPC_ENABLE_SPIRV_OPT
@@ -136,7 +145,8 @@ opt<bool> BuildShaderCache("build-shader-cache",
 // 4 - Use internal on-disk cache in read-only mode.
 static opt<unsigned> ShaderCacheMode("shader-cache-mode",
                                      desc("Shader cache mode, 0 - disable, 1 - runtime cache, 2 - cache to disk, 3 - "
-                                          "load on-disk cache for read/write, 4 - load on-disk cache for read only"),
+                                          "load on-disk cache for read/write, 4 - load on-disk cache for read only, "
+                                          "5 - cross-process shared-memory cache (unix only)"),
                                      init(0));
 
 // -executable-name: executable file name
@@ -168,10 +178,51 @@ opt<bool> TrimDebugInfo("trim-debug-info", cl::desc("Trim debug information in S
 // -enable-per-stage-cache: Enable shader cache per shader stage
 opt<bool> EnablePerStageCache("enable-per-stage-cache", cl::desc("Enable shader cache per shader stage"), init(true));
 
+// -enable-lowered-bc-cache: Cache the post-lowering LLVM bitcode of each shader stage.
+opt<bool> EnableLoweredBcCache("enable-lowered-bc-cache",
+                               cl::desc("Cache the post-lowering LLVM bitcode of each shader stage, keyed by the "
+                                        "per-stage shader hash, so pipelines differing only in back-end state "
+                                        "enter directly at the patch phase"),
+                               init(true));
+
 // -context-reuse-limit: The maximum number of times a compiler context can be reused.
 opt<int> ContextReuseLimit("context-reuse-limit",
                            cl::desc("The maximum number of times a compiler context can be reused"), init(100));
 
+// -async-pipeline-threads: Number of worker threads of the asynchronous pipeline build scheduler.
+opt<unsigned> AsyncPipelineThreads("async-pipeline-threads",
+                                   cl::desc("Number of worker threads servicing asynchronous pipeline builds; "
+                                            "0 means one per hardware thread"),
+                                   init(0));
+
+// -compile-trace-dir: Directory the compile trace is recorded into.
+opt<std::string> CompileTraceDir("compile-trace-dir",
+                                 cl::desc("Record every pipeline build request into this directory, as pipeline "
+                                          "dumps plus a compile.trace index replayable with amdllpc "
+                                          "-replay-trace (\"\" means disabled)"),
+                                 value_desc("dir"), init(""));
+
+// -parallel-reloc-stages: Compile the shader stages of a relocatable pipeline in parallel when more than one
+// stage misses in the shader caches.
+opt<bool> ParallelRelocStages("parallel-reloc-stages",
+                              cl::desc("Compile relocatable shader ELF files for the stages of a pipeline in "
+                                       "parallel when more than one stage misses in the shader caches"),
+                              init(true));
+
+// -auto-tune-wave-size: Compile compute pipelines at both wave sizes and keep the better candidate.
+opt<bool> AutoTuneWaveSize("auto-tune-wave-size",
+                           cl::desc("Compile compute pipelines whose wave size is not pinned by the client at "
+                                    "both wave32 and wave64, and keep the candidate with the better ISA "
+                                    "statistics (GFX10+)"),
+                           init(false));
+
+// -spill-retry-unroll-count: Rebuild spilling pipelines with this forced loop unroll count.
+opt<unsigned> SpillRetryUnrollCount("spill-retry-unroll-count",
+                                    cl::desc("When a built pipeline uses scratch memory, rebuild it once with "
+                                             "this forced loop unroll count and keep the result with less "
+                                             "scratch (0 means disabled)"),
+                                    init(0));
+
 extern opt<bool> EnableOuts;
 
 extern opt<bool> EnableErrs;
@@ -191,8 +242,19 @@ static cl::opt<bool> UseBuilderRecorder("use-builder-recorder",
 
 namespace Llpc {
 
-sys::Mutex Compiler::m_contextPoolMutex;
-std::vector<Context *> *Compiler::m_contextPool = nullptr;
+std::atomic<uint64_t> Compiler::m_memoryBudget(0);
+std::atomic<unsigned> Compiler::m_activeCompiles(0);
+std::atomic<uint64_t> Compiler::m_perCompileFootprint(0);
+std::mutex Compiler::m_memoryBudgetMutex;
+std::condition_variable Compiler::m_memoryBudgetCondition;
+thread_local uint64_t Compiler::m_mallocUsageAtAcquire = 0;
+thread_local Context *Compiler::m_threadFreeContext = nullptr;
+std::atomic<Compiler::FreeContextNode *> Compiler::m_freeContextOverflow(nullptr);
+std::mutex Compiler::m_reclaimMutex;
+std::condition_variable Compiler::m_reclaimCondition;
+std::vector<std::pair<Context *, bool>> Compiler::m_reclaimQueue;
+std::thread Compiler::m_reclaimThread;
+bool Compiler::m_reclaimExit = false;
 
 // Enumerates modes used in shader replacement
 enum ShaderReplaceMode {
@@ -245,6 +307,82 @@ class LlpcDiagnosticHandler : public DiagnosticHandler {
   }
 };
 
+// =====================================================================================================================
+// Process-wide registry of built shader module payloads, keyed by the digest of the input binary. Applications
+// commonly register the same SPIR-V bytes under many client shader module handles; the registry lets repeat
+// builds copy the finished payload instead of re-scanning, re-trimming and (in opt mode) re-lowering the binary.
+// Each client module still gets its own allocation (the output buffer comes from the client's allocator), so
+// only the build work is deduplicated, not the resident copies.
+class ShaderModuleRegistry {
+public:
+  // Key flags for the build knobs that change the payload built from the same binary
+  enum : unsigned {
+    KeyFlagTrimDebugInfo = 1, // Debug info trimming enabled
+    KeyFlagOpt = 2,           // Module pre-lowering (shader module opt) enabled
+    KeyFlagTrusted = 4,       // Module built in trusted mode
+  };
+
+  // Registry key: module code digest plus the flags above
+  struct Key {
+    uint64_t hashLo; // Low half of the 128-bit digest of the input binary
+    uint64_t hashHi; // High half of the 128-bit digest of the input binary
+    unsigned flags;  // Mask of KeyFlag* values
+
+    bool operator<(const Key &other) const {
+      if (hashLo != other.hashLo)
+        return hashLo < other.hashLo;
+      if (hashHi != other.hashHi)
+        return hashHi < other.hashHi;
+      return flags < other.flags;
+    }
+  };
+
+  // Looks up a payload, copying it into the caller's buffer on a hit.
+  //
+  // @param key : Registry key for the module
+  // @param [out] payload : Receives a copy of the stored payload on a hit
+  bool lookup(const Key &key, SmallVectorImpl<uint8_t> &payload) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+      return false;
+    payload.assign(it->second.begin(), it->second.end());
+    return true;
+  }
+
+  // Registers a payload. The payload is copied, so it does not need to outlive the call.
+  //
+  // @param key : Registry key for the module
+  // @param payload : Payload image as stored in the client's allocation
+  // @param size : Size of the payload in bytes
+  void insert(const Key &key, const void *payload, size_t size) {
+    if (size > MaxTotalBytes)
+      return;
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (m_entries.count(key) > 0)
+      return;
+    // Keep the registry bounded by dropping it wholesale when full; the modules still being re-registered
+    // repopulate their entries on their next build each.
+    if (m_totalBytes + size > MaxTotalBytes) {
+      m_entries.clear();
+      m_totalBytes = 0;
+    }
+    auto data = static_cast<const uint8_t *>(payload);
+    m_entries[key].assign(data, data + size);
+    m_totalBytes += size;
+  }
+
+private:
+  // Maximum total payload bytes retained; the registry is dropped wholesale when an insertion would exceed it.
+  static const size_t MaxTotalBytes = 64 * 1024 * 1024;
+
+  std::mutex m_lock;                              // Mutex protecting the members below
+  std::map<Key, std::vector<uint8_t>> m_entries;  // Map from key to stored payload
+  size_t m_totalBytes = 0;                        // Total payload bytes currently retained
+};
+
+static ManagedStatic<ShaderModuleRegistry> SShaderModuleRegistry;
+
 // =====================================================================================================================
 // Creates LLPC compiler from the specified info.
 //
@@ -327,7 +465,7 @@ bool VKAPI_CALL ICompiler::IsVertexFormatSupported(VkFormat format) {
 // @param options : An array of compilation-option strings
 // @param optionHash : Hash code of compilation options
 Compiler::Compiler(GfxIpVersion gfxIp, unsigned optionCount, const char *const *options, MetroHash::Hash optionHash)
-    : m_optionHash(optionHash), m_gfxIp(gfxIp), m_relocatablePipelineCompilations(0) {
+    : m_optionHash(optionHash), m_gfxIp(gfxIp), m_relocatablePipelineCompilations(0), m_asyncExit(false) {
   for (unsigned i = 0; i < optionCount; ++i)
     m_options.push_back(options[i]);
 
@@ -337,13 +475,6 @@ Compiler::Compiler(GfxIpVersion gfxIp, unsigned optionCount, const char *const *
   if (m_instanceCount == 0) {
     // LLVM fatal error handler only can be installed once.
     install_fatal_error_handler(fatalErrorHandler);
-
-    // Initiailze m_pContextPool.
-    {
-      std::lock_guard<sys::Mutex> lock(m_contextPoolMutex);
-
-      m_contextPool = new std::vector<Context *>();
-    }
   }
 
   // Initialize shader cache
@@ -379,29 +510,37 @@ Compiler::Compiler(GfxIpVersion gfxIp, unsigned optionCount, const char *const *
 
 // =====================================================================================================================
 Compiler::~Compiler() {
+  // Drain and stop the asynchronous build scheduler before any shared state goes away.
+  stopAsyncWorkers();
+
   bool shutdown = false;
   {
-    // Free context pool
-    std::lock_guard<sys::Mutex> lock(m_contextPoolMutex);
+    // Trim the overflow list of free contexts.
 
-    // Keep the max allowed count of contexts that reside in the pool so that we can speed up the creatoin of
+    // Keep the max allowed count of contexts resident so that we can speed up the creatoin of
     // compiler next time.
-    for (auto it = m_contextPool->begin(); it != m_contextPool->end();) {
-      auto context = *it;
-      size_t maxResidentContexts = 0;
-
-      // This is just a W/A for Teamcity. Setting AMD_RESIDENT_CONTEXTS could reduce more than 40 minutes of
-      // CTS running time.
-      char *maxResidentContextsEnv = getenv("AMD_RESIDENT_CONTEXTS");
-
-      if (maxResidentContextsEnv)
-        maxResidentContexts = strtoul(maxResidentContextsEnv, nullptr, 0);
-
-      if (!context->isInUse() && m_contextPool->size() > maxResidentContexts) {
-        it = m_contextPool->erase(it);
-        delete context;
+    size_t maxResidentContexts = 0;
+
+    // This is just a W/A for Teamcity. Setting AMD_RESIDENT_CONTEXTS could reduce more than 40 minutes of
+    // CTS running time.
+    char *maxResidentContextsEnv = getenv("AMD_RESIDENT_CONTEXTS");
+
+    if (maxResidentContextsEnv)
+      maxResidentContexts = strtoul(maxResidentContextsEnv, nullptr, 0);
+
+    // Detach the whole list, keep the first maxResidentContexts contexts, and hand the rest to the
+    // reclamation thread. Contexts cached per-thread stay resident for reuse by the next compiler.
+    FreeContextNode *node = m_freeContextOverflow.exchange(nullptr, std::memory_order_acquire);
+    size_t residentCount = 0;
+    while (node) {
+      FreeContextNode *next = node->next;
+      if (residentCount < maxResidentContexts) {
+        pushFreeContext(node->context);
+        ++residentCount;
       } else
-        ++it;
+        reclaimContext(node->context);
+      delete node;
+      node = next;
     }
   }
 
@@ -426,8 +565,7 @@ Compiler::~Compiler() {
   if (shutdown) {
     ShaderCacheManager::shutdown();
     remove_fatal_error_handler();
-    delete m_contextPool;
-    m_contextPool = nullptr;
+    stopReclaimThread();
   }
 }
 
@@ -450,10 +588,13 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
   ShaderModuleDataEx moduleDataEx = {};
   // For trimming debug info
   uint8_t *trimmedCode = nullptr;
+  // SPIR-V retained alongside pre-lowered bitcode for modules that use specialization constants
+  BinaryData retainedSpirv = {};
 
   ElfPackage moduleBinary;
   raw_svector_ostream moduleBinaryStream(moduleBinary);
   std::vector<ShaderEntryName> entryNames;
+  std::vector<SpirvWordRange> debugInfoRanges;
   SmallVector<ShaderModuleEntryData, 4> moduleEntryDatas;
   SmallVector<ShaderModuleEntry, 4> moduleEntries;
   SmallVector<FsOutInfo, 4> fsOutInfos;
@@ -462,69 +603,114 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
   ShaderEntryState cacheEntryState = ShaderEntryState::New;
   CacheEntryHandle hEntry = nullptr;
 
-  // Calculate the hash code of input data
   MetroHash::Hash hash = {};
-  MetroHash64::Hash(reinterpret_cast<const uint8_t *>(shaderInfo->shaderBin.pCode), shaderInfo->shaderBin.codeSize,
-                    hash.bytes);
-
-  memcpy(moduleDataEx.common.hash, &hash, sizeof(hash));
+  MetroHash::Hash cacheHash = {};
+  ShaderModuleRegistry::Key registryKey = {};
+  SmallVector<uint8_t, 0> registryPayload;
+  bool registryHit = false;
+  bool registerModule = false;
+
+  bool enableOpt = cl::EnableShaderModuleOpt;
+  enableOpt = enableOpt || shaderInfo->options.enableOpt;
+
+  // Check the type of input shader binary. The full 128-bit digest of the binary is computed first: it is
+  // stored in the module data so that per-pipeline hashing can fold it in instead of rehashing the code bytes,
+  // and it keys the registry of built module payloads, so the scan, trim and (in opt mode) pre-lowering work
+  // below is skipped for a binary that was already built under another client module handle.
+  if (ShaderModuleHelper::isSpirvBinary(&shaderInfo->shaderBin)) {
+    moduleDataEx.common.binType = BinaryType::Spirv;
+    MetroHash128::Hash(reinterpret_cast<const uint8_t *>(shaderInfo->shaderBin.pCode), shaderInfo->shaderBin.codeSize,
+                       hash.bytes);
 
-  TimerProfiler timerProfiler(MetroHash::compact64(&hash), "LLPC ShaderModule",
-                              TimerProfiler::ShaderModuleTimerEnableMask);
+    memcpy(&registryKey.hashLo, &hash.bytes[0], sizeof(registryKey.hashLo));
+    memcpy(&registryKey.hashHi, &hash.bytes[8], sizeof(registryKey.hashHi));
+    if (cl::TrimDebugInfo)
+      registryKey.flags |= ShaderModuleRegistry::KeyFlagTrimDebugInfo;
+    if (enableOpt)
+      registryKey.flags |= ShaderModuleRegistry::KeyFlagOpt;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+    if (shaderInfo->options.trustedModule)
+      registryKey.flags |= ShaderModuleRegistry::KeyFlagTrusted;
+#endif
+    registryHit = SShaderModuleRegistry->lookup(registryKey, registryPayload);
+
+    if (registryHit) {
+      // The payload is copied into the client's allocation below, exactly like one retrieved from the shader
+      // cache.
+      cacheData = registryPayload.data();
+      allocSize = registryPayload.size();
+      cacheEntryState = ShaderEntryState::Ready;
+    } else {
+      registerModule = true;
+      unsigned debugInfoSize = 0;
 
-  // Check the type of input shader binary
-  if (ShaderModuleHelper::isSpirvBinary(&shaderInfo->shaderBin)) {
-    unsigned debugInfoSize = 0;
+      if (ShaderModuleHelper::verifySpirvBinary(&shaderInfo->shaderBin) != Result::Success) {
+        LLPC_ERRS("Unsupported SPIR-V instructions are found!\n");
+        result = Result::Unsupported;
+      }
+      if (result == Result::Success) {
+        ShaderModuleHelper::collectInfoFromSpirvBinary(&shaderInfo->shaderBin, &moduleDataEx.common.usage, entryNames,
+                                                       &debugInfoSize, &debugInfoRanges);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+        moduleDataEx.common.usage.trustedMode = shaderInfo->options.trustedModule;
+#endif
+      }
 
-    moduleDataEx.common.binType = BinaryType::Spirv;
-    if (ShaderModuleHelper::verifySpirvBinary(&shaderInfo->shaderBin) != Result::Success) {
-      LLPC_ERRS("Unsupported SPIR-V instructions are found!\n");
-      result = Result::Unsupported;
-    }
-    if (result == Result::Success) {
-      ShaderModuleHelper::collectInfoFromSpirvBinary(&shaderInfo->shaderBin, &moduleDataEx.common.usage, entryNames,
-                                                     &debugInfoSize);
+      // Trim debug info. The SPIR-V cache hash covers the trimmed binary, so it is independent of stripped
+      // debug info; without trimming it covers exactly the same bytes as the module hash, so they share one
+      // digest and the binary is only hashed once.
+      moduleDataEx.common.binCode.codeSize = shaderInfo->shaderBin.codeSize;
+      if (cl::TrimDebugInfo) {
+        moduleDataEx.common.binCode.codeSize -= debugInfoSize;
+        trimmedCode = new uint8_t[moduleDataEx.common.binCode.codeSize];
+        ShaderModuleHelper::trimSpirvDebugInfo(&shaderInfo->shaderBin, debugInfoRanges,
+                                               moduleDataEx.common.binCode.codeSize, trimmedCode);
+        moduleDataEx.common.binCode.pCode = trimmedCode;
+        MetroHash128::Hash(trimmedCode, moduleDataEx.common.binCode.codeSize, cacheHash.bytes);
+      } else {
+        moduleDataEx.common.binCode.pCode = shaderInfo->shaderBin.pCode;
+        cacheHash = hash;
+      }
     }
-    moduleDataEx.common.binCode.codeSize = shaderInfo->shaderBin.codeSize;
-    if (cl::TrimDebugInfo)
-      moduleDataEx.common.binCode.codeSize -= debugInfoSize;
   } else if (ShaderModuleHelper::isLlvmBitcode(&shaderInfo->shaderBin)) {
     moduleDataEx.common.binType = BinaryType::LlvmBc;
     moduleDataEx.common.binCode = shaderInfo->shaderBin;
+    MetroHash128::Hash(reinterpret_cast<const uint8_t *>(shaderInfo->shaderBin.pCode), shaderInfo->shaderBin.codeSize,
+                       hash.bytes);
   } else
     result = Result::ErrorInvalidShader;
 
+  memcpy(moduleDataEx.common.hash, &hash, sizeof(hash));
+
+  TimerProfiler timerProfiler(MetroHash::compact64(&hash), "LLPC ShaderModule",
+                              TimerProfiler::ShaderModuleTimerEnableMask);
+
   if (moduleDataEx.common.binType == BinaryType::Spirv) {
     // Dump SPIRV binary
     if (cl::EnablePipelineDump) {
       PipelineDumper::DumpSpirvBinary(cl::PipelineDumpDir.c_str(), &shaderInfo->shaderBin, &hash);
     }
+  }
 
-    // Trim debug info
-    if (cl::TrimDebugInfo) {
-      trimmedCode = new uint8_t[moduleDataEx.common.binCode.codeSize];
-      ShaderModuleHelper::trimSpirvDebugInfo(&shaderInfo->shaderBin, moduleDataEx.common.binCode.codeSize, trimmedCode);
-      moduleDataEx.common.binCode.pCode = trimmedCode;
-    } else
-      moduleDataEx.common.binCode.pCode = shaderInfo->shaderBin.pCode;
-
-    // Calculate SPIR-V cache hash
-    MetroHash::Hash cacheHash = {};
-    MetroHash64::Hash(reinterpret_cast<const uint8_t *>(moduleDataEx.common.binCode.pCode),
-                      moduleDataEx.common.binCode.codeSize, cacheHash.bytes);
+  if (moduleDataEx.common.binType == BinaryType::Spirv && !registryHit) {
     static_assert(sizeof(moduleDataEx.common.cacheHash) == sizeof(cacheHash), "Unexpected value!");
     memcpy(moduleDataEx.common.cacheHash, cacheHash.dwords, sizeof(cacheHash));
 
     // Do SPIR-V translate & lower if possible
-    bool enableOpt = cl::EnableShaderModuleOpt;
-    enableOpt = enableOpt || shaderInfo->options.enableOpt;
-    enableOpt = moduleDataEx.common.usage.useSpecConstant ? false : enableOpt;
-
+    // NOTE: For modules using specialization constants, the pre-lowered bitcode bakes in the default
+    // specialization values; the SPIR-V is retained in the module data so that pipelines which actually
+    // specialize can retranslate from it.
     if (enableOpt) {
       // Check internal cache for shader module build result
       // NOTE: We should not cache non-opt result, we may compile shader module multiple
       // times in async-compile mode.
       cacheEntryState = m_shaderCache->findShader(cacheHash, true, &hEntry);
+      if (cacheEntryState == ShaderEntryState::Failed) {
+        // Shader module builds never record failures, so a failed entry under this hash belongs to another
+        // use of the key space; compile without touching it.
+        cacheEntryState = ShaderEntryState::Unavailable;
+        hEntry = nullptr;
+      }
       if (cacheEntryState == ShaderEntryState::Ready)
         result = m_shaderCache->retrieveShader(hEntry, &cacheData, &allocSize);
       if (cacheEntryState != ShaderEntryState::Ready) {
@@ -626,10 +812,15 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
 
         if (result == Result::Success) {
           moduleDataEx.common.binType = BinaryType::MultiLlvmBc;
+          if (moduleDataEx.common.usage.useSpecConstant)
+            retainedSpirv = moduleDataEx.common.binCode;
           moduleDataEx.common.binCode.pCode = moduleBinary.data();
           moduleDataEx.common.binCode.codeSize = moduleBinary.size();
         }
 
+        // Release the shared SPIR-V parse eagerly: it is keyed on the trimmed code buffer, which is freed
+        // before this function returns, and the entries above were the last consumers.
+        context->releaseParsedSpirvModules();
         context->setDiagnosticHandlerCallBack(nullptr);
       }
       moduleDataEx.extra.entryCount = entryNames.size();
@@ -646,7 +837,8 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
 
         allocSize = sizeof(ShaderModuleDataEx) + moduleDataEx.common.binCode.codeSize +
                     (moduleDataEx.extra.entryCount * (sizeof(ShaderModuleEntryData) + sizeof(ShaderModuleEntry))) +
-                    totalNodeCount * sizeof(ResourceNodeData) + fsOutInfos.size() * sizeof(FsOutInfo);
+                    totalNodeCount * sizeof(ResourceNodeData) + fsOutInfos.size() * sizeof(FsOutInfo) +
+                    retainedSpirv.codeSize;
       }
 
       allocBuf = shaderInfo->pfnOutputAlloc(shaderInfo->pInstance, shaderInfo->pUserData, allocSize);
@@ -660,7 +852,7 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
 
   if (result == Result::Success) {
     // Memory layout of pAllocBuf: ShaderModuleDataEx | ShaderModuleEntryData | ShaderModuleEntry | binCode
-    //                             | Resource nodes | FsOutInfo
+    //                             | Resource nodes | FsOutInfo | Retained SPIR-V
     ShaderModuleDataEx *moduleDataExCopy = reinterpret_cast<ShaderModuleDataEx *>(allocBuf);
 
     ShaderModuleEntryData *entryData = &moduleDataExCopy->extra.entryDatas[0];
@@ -679,6 +871,8 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
       moduleDataExCopy->entryOffset = entryOffset;
       moduleDataExCopy->resNodeOffset = resNodeOffset;
       moduleDataExCopy->fsOutInfoOffset = fsOutInfoOffset;
+      moduleDataExCopy->spirvOffset = fsOutInfoOffset + fsOutInfos.size() * sizeof(FsOutInfo);
+      moduleDataExCopy->spirvSize = retainedSpirv.codeSize;
     } else
       memcpy(moduleDataExCopy, cacheData, allocSize);
 
@@ -707,6 +901,9 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
 
       // Copy binary code
       memcpy(code, moduleDataEx.common.binCode.pCode, moduleDataEx.common.binCode.codeSize);
+      // Copy the retained SPIR-V, if any
+      if (retainedSpirv.codeSize > 0)
+        memcpy(voidPtrInc(allocBuf, moduleDataExCopy->spirvOffset), retainedSpirv.pCode, retainedSpirv.codeSize);
       // Destory the temporary module code
       if (trimmedCode) {
         delete[] trimmedCode;
@@ -723,13 +920,21 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
           m_shaderCache->insertShader(hEntry, moduleDataExCopy, allocSize);
       }
     } else {
-      // Update the pointers
-      for (unsigned i = 0; i < moduleDataEx.extra.entryCount; ++i) {
+      // Update the pointers. The entry count comes from the copied payload, as a registry hit skips the scan
+      // that would populate the local count.
+      for (unsigned i = 0; i < moduleDataExCopy->extra.entryCount; ++i) {
         entryData[i].pShaderEntry = &entry[i];
         entryData[i].pResNodeDatas = resNodeData;
         resNodeData += entryData[i].resNodeDataCount;
       }
     }
+
+    // Register the finished payload so later builds of the same binary copy it instead of redoing the build
+    // work. The stored image contains absolute pointers; they are fixed up against the new allocation on
+    // reuse, just like a payload retrieved from the shader cache.
+    if (registerModule)
+      SShaderModuleRegistry->insert(registryKey, moduleDataExCopy, allocSize);
+
     moduleDataExCopy->common.binCode.pCode = code;
     moduleDataExCopy->extra.pFsOutInfos = fsOutInfo;
     shaderOut->pModuleData = &moduleDataExCopy->common;
@@ -741,6 +946,111 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
   return result;
 }
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+// =====================================================================================================================
+// Builds a batch of shader modules, processing them on internal worker threads.
+//
+// The per-module work (debug info trimming, usage scanning, hashing, pre-lowering) touches no shared state beyond
+// the thread-safe shader cache and context pool, so the modules are simply distributed over one worker per core.
+// Every module is built even if an earlier one fails, so each output is always in a defined state.
+//
+// @param shaderModuleCount : Number of modules in the batch
+// @param shaderInfos : Array of shaderModuleCount infos to build
+// @param [out] shaderOuts : Array of shaderModuleCount outputs, one per info
+// @param [out] results : If non-null, receives the per-module build result for each entry
+Result Compiler::BuildShaderModules(unsigned shaderModuleCount, const ShaderModuleBuildInfo *shaderInfos,
+                                    ShaderModuleBuildOut *shaderOuts, Result *results) const {
+  if (shaderModuleCount == 0)
+    return Result::Success;
+  if (!shaderInfos || !shaderOuts)
+    return Result::ErrorInvalidPointer;
+
+  std::vector<Result> moduleResults(shaderModuleCount, Result::Success);
+  std::atomic<unsigned> nextModule(0);
+
+  // Builds modules pulled from the shared index until the batch is exhausted.
+  auto buildWorker = [&]() {
+    for (;;) {
+      unsigned moduleIndex = nextModule.fetch_add(1);
+      if (moduleIndex >= shaderModuleCount)
+        break;
+      moduleResults[moduleIndex] = BuildShaderModule(&shaderInfos[moduleIndex], &shaderOuts[moduleIndex]);
+    }
+  };
+
+  const unsigned workerCount = std::min(shaderModuleCount, std::max(1u, std::thread::hardware_concurrency()));
+  if (workerCount > 1) {
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < workerCount; ++i)
+      workers.emplace_back(buildWorker);
+    for (std::thread &worker : workers)
+      worker.join();
+  } else
+    buildWorker();
+
+  Result result = Result::Success;
+  for (unsigned i = 0; i < shaderModuleCount; ++i) {
+    if (results)
+      results[i] = moduleResults[i];
+    if (result == Result::Success)
+      result = moduleResults[i];
+  }
+  return result;
+}
+
+// =====================================================================================================================
+// Computes the hashes a graphics pipeline would be built and cached under, without compiling anything.
+//
+// @param pipelineInfo : Info the pipeline would be built from
+// @param [out] pipelineHash : If non-null, receives the 64-bit pipeline hash
+// @param [out] cacheHash : If non-null, receives the 128-bit shader cache key
+void Compiler::GetGraphicsPipelineCacheKeys(const GraphicsPipelineBuildInfo *pipelineInfo, uint64_t *pipelineHash,
+                                            ShaderHash *cacheHash) const {
+  if (pipelineHash) {
+    MetroHash::Hash hash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, false, false);
+    *pipelineHash = MetroHash::compact64(&hash);
+  }
+
+  if (cacheHash) {
+    const PipelineShaderInfo *shaderInfo[ShaderStageGfxCount] = {
+        &pipelineInfo->vs, &pipelineInfo->tcs, &pipelineInfo->tes, &pipelineInfo->gs, &pipelineInfo->fs,
+    };
+
+    // Predict whether the build would take the relocatable path. This mirrors BuildGraphicsPipeline, minus the
+    // -relocatable-shader-elf-limit budget, which cannot be consulted without consuming it.
+    bool relocatableElf = pipelineInfo->options.enableRelocatableShaderElf || cl::UseRelocatableShaderElf;
+    relocatableElf = relocatableElf && isEligibleForRelocatableGraphicsShaderElf(shaderInfo);
+
+    MetroHash::Hash hash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, true, relocatableElf);
+    static_assert(sizeof(*cacheHash) == sizeof(hash), "ShaderHash and MetroHash::Hash sizes differ");
+    memcpy(cacheHash, hash.bytes, sizeof(*cacheHash));
+  }
+}
+
+// =====================================================================================================================
+// Computes the hashes a compute pipeline would be built and cached under, without compiling anything.
+//
+// @param pipelineInfo : Info the pipeline would be built from
+// @param [out] pipelineHash : If non-null, receives the 64-bit pipeline hash
+// @param [out] cacheHash : If non-null, receives the 128-bit shader cache key
+void Compiler::GetComputePipelineCacheKeys(const ComputePipelineBuildInfo *pipelineInfo, uint64_t *pipelineHash,
+                                           ShaderHash *cacheHash) const {
+  if (pipelineHash) {
+    MetroHash::Hash hash = PipelineDumper::generateHashForComputePipeline(pipelineInfo, false, false);
+    *pipelineHash = MetroHash::compact64(&hash);
+  }
+
+  if (cacheHash) {
+    bool relocatableElf = pipelineInfo->options.enableRelocatableShaderElf || cl::UseRelocatableShaderElf;
+    relocatableElf = relocatableElf && isEligibleForRelocatableComputeShaderElf(&pipelineInfo->cs);
+
+    MetroHash::Hash hash = PipelineDumper::generateHashForComputePipeline(pipelineInfo, true, relocatableElf);
+    static_assert(sizeof(*cacheHash) == sizeof(hash), "ShaderHash and MetroHash::Hash sizes differ");
+    memcpy(cacheHash, hash.bytes, sizeof(*cacheHash));
+  }
+}
+#endif
+
 // =====================================================================================================================
 // Builds a pipeline by building relocatable elf files and linking them together.  The relocatable elf files will be
 // cached for future use.
@@ -751,7 +1061,7 @@ Result Compiler::BuildShaderModule(const ShaderModuleBuildInfo *shaderInfo, Shad
 // @param [out] pipelineElf : Output Elf package
 Result Compiler::buildPipelineWithRelocatableElf(Context *context, ArrayRef<const PipelineShaderInfo *> shaderInfo,
                                                  unsigned forceLoopUnrollCount, ElfPackage *pipelineElf) {
-  LLPC_OUTS("Building pipeline with relocatable shader elf.\n")
+  LLPC_OUTS("Building pipeline with relocatable shader elf.\n");
   Result result = Result::Success;
 
   // Merge the user data once for all stages.
@@ -760,18 +1070,54 @@ Result Compiler::buildPipelineWithRelocatableElf(Context *context, ArrayRef<cons
   context->getPipelineContext()->setUnlinked(true);
 
   ElfPackage elf[ShaderStageNativeStageCount];
-  for (unsigned stage = 0; stage < shaderInfo.size() && result == Result::Success; ++stage) {
+
+  // Stage-completion notification: if the client supplied a callback, deliver each unlinked stage ELF as soon
+  // as it is retrieved from a cache or freshly compiled, so the driver can overlap dependent work with the
+  // remaining stages' compilation and the link. In the parallel flavor the callback runs on the worker threads.
+  StageElfReadyFunc pfnStageElfReady = nullptr;
+  void *stageReadyInstance = nullptr;
+  void *stageReadyUserData = nullptr;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  if (context->isGraphics()) {
+    auto pipelineInfo = reinterpret_cast<const GraphicsPipelineBuildInfo *>(context->getPipelineBuildInfo());
+    pfnStageElfReady = pipelineInfo->pfnStageElfReady;
+    stageReadyInstance = pipelineInfo->pInstance;
+    stageReadyUserData = pipelineInfo->pUserData;
+  } else {
+    auto pipelineInfo = reinterpret_cast<const ComputePipelineBuildInfo *>(context->getPipelineBuildInfo());
+    pfnStageElfReady = pipelineInfo->pfnStageElfReady;
+    stageReadyInstance = pipelineInfo->pInstance;
+    stageReadyUserData = pipelineInfo->pUserData;
+  }
+#endif
+  auto notifyStageElfReady = [&](unsigned stage, const BinaryData &elfBin, bool fromCache) {
+    if (pfnStageElfReady)
+      pfnStageElfReady(stageReadyInstance, stageReadyUserData, static_cast<ShaderStage>(stage), &elfBin, fromCache);
+  };
+
+  // Per-stage compile job for a stage that missed in the caches.
+  struct StageCompileJob {
+    unsigned stage;           // Stage to compile
+    ShaderCache *shaderCache; // Cache to update with the compile result
+    CacheEntryHandle hEntry;  // Cache entry to populate
+    Result result;            // Result of the stage compile
+  };
+  SmallVector<StageCompileJob, ShaderStageNativeStageCount> jobs;
+
+  // First pass: look up each active stage in the shader caches and remember the stages that miss. The state
+  // sub-digests are shared across the per-stage hashes, so the state walks are paid once per pipeline rather
+  // than once per stage.
+  PipelineDumper::GraphicsPipelineStateHashes stateHashes;
+  for (unsigned stage = 0; stage < shaderInfo.size(); ++stage) {
     if (!shaderInfo[stage] || !shaderInfo[stage]->pModuleData)
       continue;
 
-    context->getPipelineContext()->setShaderStageMask(shaderStageToMask(static_cast<ShaderStage>(stage)));
-
     // Check the cache for the relocatable shader for this stage.
     MetroHash::Hash cacheHash = {};
     IShaderCache *userShaderCache = nullptr;
     if (context->isGraphics()) {
       auto pipelineInfo = reinterpret_cast<const GraphicsPipelineBuildInfo *>(context->getPipelineBuildInfo());
-      cacheHash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, true, true, stage);
+      cacheHash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, true, true, stage, &stateHashes);
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38 || LLPC_ENABLE_SHADER_CACHE
       userShaderCache = reinterpret_cast<IShaderCache *>(pipelineInfo->pShaderCache);
 #endif
@@ -790,37 +1136,147 @@ Result Compiler::buildPipelineWithRelocatableElf(Context *context, ArrayRef<cons
     CacheEntryHandle hEntry;
     cacheEntryState = lookUpShaderCaches(userShaderCache, &cacheHash, &elfBin, &shaderCache, &hEntry);
 
+    if (cacheEntryState == ShaderEntryState::Failed) {
+      // A recent compile of this stage failed; fail the pipeline with the recorded result without re-paying
+      // the stage compile. The other stages still get compiled (and cached) below.
+      result = shaderCache->getShaderFailureResult(hEntry);
+      LLPC_OUTS("Cached failure for shader stage " << stage << "\n");
+      continue;
+    }
     if (cacheEntryState == ShaderEntryState::Ready) {
       auto data = reinterpret_cast<const char *>(elfBin.pCode);
       elf[stage].assign(data, data + elfBin.codeSize);
       LLPC_OUTS("Cache hit for shader stage " << stage << "\n");
+      notifyStageElfReady(stage, elfBin, /*fromCache=*/true);
       continue;
     }
     LLPC_OUTS("Cache miss for shader stage " << stage << "\n");
 
-    // There was a cache miss, so we need to build the relocatable shader for
-    // this stage.
+    jobs.push_back({stage, shaderCache, hEntry, Result::Success});
+  }
+
+  // Compiles the relocatable shader for one missed stage on the given LLPC context and updates the cache.
+  auto compileStage = [&](StageCompileJob &job, Context *jobContext) {
     const PipelineShaderInfo *singleStageShaderInfo[ShaderStageNativeStageCount] = {nullptr, nullptr, nullptr,
                                                                                     nullptr, nullptr, nullptr};
-    singleStageShaderInfo[stage] = shaderInfo[stage];
+    singleStageShaderInfo[job.stage] = shaderInfo[job.stage];
+    jobContext->getPipelineContext()->setShaderStageMask(shaderStageToMask(static_cast<ShaderStage>(job.stage)));
 
-    result =
-        buildPipelineInternal(context, singleStageShaderInfo, forceLoopUnrollCount, /*unlinked=*/true, &elf[stage]);
+    job.result = buildPipelineInternal(jobContext, singleStageShaderInfo, forceLoopUnrollCount, /*unlinked=*/true,
+                                       &elf[job.stage]);
 
     // Add the result to the cache.
-    if (result == Result::Success) {
-      elfBin.codeSize = elf[stage].size();
-      elfBin.pCode = elf[stage].data();
+    BinaryData elfBin = {};
+    if (job.result == Result::Success) {
+      elfBin.codeSize = elf[job.stage].size();
+      elfBin.pCode = elf[job.stage].data();
+    }
+    updateShaderCache(job.result, &elfBin, job.shaderCache, job.hEntry);
+    LLPC_OUTS("Updating the cache for shader stage " << job.stage << "\n");
+    if (job.result == Result::Success)
+      notifyStageElfReady(job.stage, elfBin, /*fromCache=*/false);
+  };
+
+  // Middle-end objects for a link prepared in parallel with the stage compiles. The pipeline must outlive
+  // the linker.
+  std::unique_ptr<Pipeline> linkPipeline;
+  std::unique_ptr<ElfLinker> elfLinker;
+
+  if (jobs.size() > 1 && cl::ParallelRelocStages) {
+    // Second pass, parallel flavor: compile the missed stages concurrently. Each worker runs on its own LLPC
+    // context (and thus its own LLVMContext) with a private pipeline context, so the per-stage shader stage
+    // masks don't race. The user data nodes were merged above, and the merged tables stay valid because the
+    // caller's pipeline context outlives the workers.
+    MetroHash::Hash pipelineHash = context->getPipelineContext()->getPipelineHash();
+    MetroHash::Hash cacheHash = context->getPipelineContext()->get128BitCacheHash();
+    std::vector<std::thread> workers;
+    for (StageCompileJob &job : jobs) {
+      workers.emplace_back([this, context, pipelineHash, cacheHash, &compileStage, &job] {
+        Context *jobContext = acquireContext();
+        if (context->isGraphics()) {
+          auto pipelineInfo = reinterpret_cast<const GraphicsPipelineBuildInfo *>(context->getPipelineBuildInfo());
+          GraphicsContext jobPipelineContext(m_gfxIp, pipelineInfo, &pipelineHash, &cacheHash);
+          jobPipelineContext.setUnlinked(true);
+          jobContext->attachPipelineContext(&jobPipelineContext);
+          compileStage(job, jobContext);
+        } else {
+          auto pipelineInfo = reinterpret_cast<const ComputePipelineBuildInfo *>(context->getPipelineBuildInfo());
+          ComputeContext jobPipelineContext(m_gfxIp, pipelineInfo, &pipelineHash, &cacheHash);
+          jobPipelineContext.setUnlinked(true);
+          jobContext->attachPipelineContext(&jobPipelineContext);
+          compileStage(job, jobContext);
+        }
+        releaseContext(jobContext);
+      });
     }
-    updateShaderCache((result == Result::Success), &elfBin, shaderCache, hEntry);
-    LLPC_OUTS("Updating the cache for shader stage " << stage << "\n");
+
+    // Pipelined link preparation: while the workers compile the missed stages, create the ELF linker over the
+    // stage ELFs already retrieved from the caches and pre-compile its glue shaders (e.g. the fetch shader) on
+    // this thread, so the link step's inputs are warmed instead of generated serially after the last stage
+    // finishes. Only do this when every cache-hit stage precedes every missed stage, so the linker sees its
+    // inputs in the same stage order as the serial link path. The glue code runs on the caller's context,
+    // which no worker uses for compilation.
+    if (!cl::BuildShaderCache) {
+      unsigned firstJobStage = ShaderStageNativeStageCount;
+      for (const StageCompileJob &job : jobs)
+        firstJobStage = std::min(firstJobStage, job.stage);
+
+      SmallVector<MemoryBufferRef, 3> readyElfs;
+      bool readyStagesFirst = true;
+      for (unsigned stage = 0; stage != ShaderStageNativeStageCount; ++stage) {
+        if (elf[stage].empty())
+          continue;
+        if (stage > firstJobStage)
+          readyStagesFirst = false;
+        else
+          readyElfs.push_back(MemoryBufferRef(elf[stage].str(), getShaderStageName(static_cast<ShaderStage>(stage))));
+      }
+
+      if (readyStagesFirst && !readyElfs.empty()) {
+        context->getPipelineContext()->setUnlinked(false);
+        LgcContext *builderContext = context->getLgcContext();
+        linkPipeline.reset(builderContext->createPipeline());
+        context->getPipelineContext()->setPipelineState(&*linkPipeline, /*unlinked=*/false);
+        elfLinker.reset(linkPipeline->createElfLinker(readyElfs));
+        resolveGlueShaders(&*elfLinker);
+      }
+    }
+
+    for (std::thread &worker : workers)
+      worker.join();
+  } else {
+    // Second pass, serial flavor: compile any missed stages on the caller's context. Compile every stage even
+    // if one fails, so each looked-up cache entry always gets its state resolved.
+    for (StageCompileJob &job : jobs)
+      compileStage(job, context);
   }
   context->getPipelineContext()->setShaderStageMask(originalShaderStageMask);
 
-  if (!cl::BuildShaderCache) {
+  for (const StageCompileJob &job : jobs) {
+    if (job.result != Result::Success) {
+      result = job.result;
+      break;
+    }
+  }
+
+  if (!cl::BuildShaderCache && result == Result::Success) {
     // Link the relocatable shaders into a single pipeline elf file.
     // Not needed if we are just interested in building the cache.
-    linkRelocatableShaderElf(elf, pipelineElf, context);
+    if (elfLinker) {
+      // A linker was prepared in parallel with the stage compiles, with its glue shaders already compiled.
+      // Feed it the freshly compiled stage ELFs and do the link.
+      for (const StageCompileJob &job : jobs) {
+        elfLinker->addInputElf(
+            MemoryBufferRef(elf[job.stage].str(), getShaderStageName(static_cast<ShaderStage>(job.stage))));
+      }
+      raw_svector_ostream outStream(*pipelineElf);
+      if (!elfLinker->link(outStream)) {
+        // Link failed in a recoverable way.
+        // TODO: Action this failure by doing a full pipeline compile.
+        report_fatal_error("Link failed; need full pipeline compile instead: " + linkPipeline->getLastError());
+      }
+    } else
+      linkRelocatableShaderElf(elf, pipelineElf, context);
   }
 
   return result;
@@ -865,6 +1321,24 @@ static bool hasUnrelocatableDescriptorNode(const ResourceMappingNode *nodes, uns
 //
 // @param shaderInfo : Shader info for the pipeline to be built
 bool Compiler::canUseRelocatableGraphicsShaderElf(const ArrayRef<const PipelineShaderInfo *> &shaderInfo) {
+  if (!isEligibleForRelocatableGraphicsShaderElf(shaderInfo))
+    return false;
+
+  if (cl::RelocatableShaderElfLimit != -1) {
+    if (m_relocatablePipelineCompilations >= cl::RelocatableShaderElfLimit)
+      return false;
+    else
+      ++m_relocatablePipelineCompilations;
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Returns true if the given shader info is eligible for relocatable shader compilation, ignoring the
+// -relocatable-shader-elf-limit budget. Side-effect free, so hash-only queries can use it as well.
+//
+// @param shaderInfo : Shader info for the pipeline to be built
+bool Compiler::isEligibleForRelocatableGraphicsShaderElf(const ArrayRef<const PipelineShaderInfo *> &shaderInfo) const {
   for (unsigned stage = 0; stage < shaderInfo.size(); ++stage) {
     if (stage != ShaderStageVertex && stage != ShaderStageFragment) {
       if (shaderInfo[stage] && shaderInfo[stage]->pModuleData)
@@ -884,6 +1358,16 @@ bool Compiler::canUseRelocatableGraphicsShaderElf(const ArrayRef<const PipelineS
     if (moduleData && moduleData->binType != BinaryType::Spirv)
       return false;
   }
+  return true;
+}
+
+// =====================================================================================================================
+// Returns true if a compute pipeline can be built out of the given shader info.
+//
+// @param shaderInfo : Shader info for the pipeline to be built
+bool Compiler::canUseRelocatableComputeShaderElf(const PipelineShaderInfo *shaderInfo) {
+  if (!isEligibleForRelocatableComputeShaderElf(shaderInfo))
+    return false;
 
   if (cl::RelocatableShaderElfLimit != -1) {
     if (m_relocatablePipelineCompilations >= cl::RelocatableShaderElfLimit)
@@ -895,10 +1379,11 @@ bool Compiler::canUseRelocatableGraphicsShaderElf(const ArrayRef<const PipelineS
 }
 
 // =====================================================================================================================
-// Returns true if a compute pipeline can be built out of the given shader info.
+// Returns true if the given compute shader info is eligible for relocatable shader compilation, ignoring the
+// -relocatable-shader-elf-limit budget. Side-effect free, so hash-only queries can use it as well.
 //
 // @param shaderInfo : Shader info for the pipeline to be built
-bool Compiler::canUseRelocatableComputeShaderElf(const PipelineShaderInfo *shaderInfo) {
+bool Compiler::isEligibleForRelocatableComputeShaderElf(const PipelineShaderInfo *shaderInfo) const {
   // Relocatable shader cannot get the order of the user data nodes correct.  We have to disable them for compute
   // shaders until the restriction in PAL has been relaxed.
   // The tests PipelineCs_StrideReloc.pipe, PipelineCs_RelocCombinedTextureSampler.pipe, PipelineCs_ShaderCache.pipe,
@@ -915,14 +1400,37 @@ bool Compiler::canUseRelocatableComputeShaderElf(const PipelineShaderInfo *shade
         return false;
     }
   }
+  return true;
+}
 
-  if (cl::RelocatableShaderElfLimit != -1) {
-    if (m_relocatablePipelineCompilations >= cl::RelocatableShaderElfLimit)
-      return false;
-    else
-      ++m_relocatablePipelineCompilations;
+// =====================================================================================================================
+// Computes the key identifying one shader's translation result in the per-context translation cache: the shader
+// module hash plus everything SPIRVToLLVM folds into the translated IR (entry point, specialization values and
+// the front-end-visible pipeline options).
+//
+// @param context : Acquired context
+// @param shaderInfo : Shader info of the shader
+static uint64_t getTranslationCacheKey(Context *context, const PipelineShaderInfo *shaderInfo) {
+  const ShaderModuleData *moduleData = reinterpret_cast<const ShaderModuleData *>(shaderInfo->pModuleData);
+  MetroHash64 hasher;
+  hasher.Update(reinterpret_cast<const uint8_t *>(&moduleData->hash[0]), sizeof(moduleData->hash));
+  if (shaderInfo->pEntryTarget)
+    hasher.Update(reinterpret_cast<const uint8_t *>(shaderInfo->pEntryTarget), strlen(shaderInfo->pEntryTarget));
+  // When every specialization constant in the module is foldable, the translator runs with symbolic
+  // specialization constants and its result is independent of the specialized values, so they are left out of
+  // the key and all specializations of the shader share one cached translation.
+  const VkSpecializationInfo *specInfo = shaderInfo->pSpecializationInfo;
+  if (specInfo && specInfo->mapEntryCount > 0 && !moduleData->usage.specConstantsFoldable) {
+    hasher.Update(reinterpret_cast<const uint8_t *>(specInfo->pMapEntries),
+                  specInfo->mapEntryCount * sizeof(VkSpecializationMapEntry));
+    hasher.Update(static_cast<const uint8_t *>(specInfo->pData), specInfo->dataSize);
   }
-  return true;
+  const uint8_t contextFlags[] = {context->getScalarBlockLayout(), context->getRobustBufferAccess()};
+  hasher.Update(contextFlags, sizeof(contextFlags));
+
+  MetroHash::Hash hash = {};
+  hasher.Finalize(hash.bytes);
+  return MetroHash::compact64(&hash);
 }
 
 // =====================================================================================================================
@@ -933,14 +1441,26 @@ bool Compiler::canUseRelocatableComputeShaderElf(const PipelineShaderInfo *shade
 // @param forceLoopUnrollCount : Force loop unroll count (0 means disable)
 // @param unlinked : Do not provide some state to LGC, so offsets are generated as relocs
 // @param [out] pipelineElf : Output Elf package
+// @param usePerStageCache : Allow the per-stage shader cache to satisfy and receive half-pipeline results
 Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const PipelineShaderInfo *> shaderInfo,
-                                       unsigned forceLoopUnrollCount, bool unlinked, ElfPackage *pipelineElf) {
+                                       unsigned forceLoopUnrollCount, bool unlinked, ElfPackage *pipelineElf,
+                                       bool usePerStageCache) {
   Result result = Result::Success;
   unsigned passIndex = 0;
   const PipelineShaderInfo *fragmentShaderInfo = nullptr;
   TimerProfiler timerProfiler(context->getPiplineHashCode(), "LLPC", TimerProfiler::PipelineTimerEnableMask);
   bool buildingRelocatableElf = context->getPipelineContext()->isUnlinked();
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  // Compile-time-budget instrumentation: collect per-pass times and the total time while a budget is set.
+  SmallVector<lgc::PassTimeInfo, 64> passTimes;
+  std::chrono::steady_clock::time_point buildStartTime;
+  if (m_compileTimeBudgetUs > 0) {
+    lgc::PassManager::startPassTimingOnThread(&passTimes);
+    buildStartTime = std::chrono::steady_clock::now();
+  }
+#endif
+
   context->setDiagnosticHandler(std::make_unique<LlpcDiagnosticHandler>());
 
   // Set a couple of pipeline options for front-end use.
@@ -953,6 +1473,10 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
     context->getPipelineContext()->doUserDataNodeMerge();
   }
 
+  // Take a snapshot of the derived pipeline state, so hot code below (and the shader cache callback invoked from
+  // the middle-end) reads plain fields instead of re-deriving the values through virtual queries.
+  const PipelineStateSnapshot pipelineState = context->getPipelineContext()->getPipelineStateSnapshot();
+
   // Set up middle-end objects.
   LgcContext *builderContext = context->getLgcContext();
   std::unique_ptr<Pipeline> pipeline(builderContext->createPipeline());
@@ -976,6 +1500,17 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
     // Create empty modules and set target machine in each.
     std::vector<Module *> modules(shaderInfo.size());
     unsigned stageSkipMask = 0;
+
+    // Per-stage shader info overrides. A module pre-lowered to bitcode was translated with the default
+    // specialization values; when the pipeline actually specializes constants for a stage, the stage is
+    // redirected to the SPIR-V retained in the module data and retranslated.
+    std::vector<PipelineShaderInfo> overrideShaderInfos(shaderInfo.size());
+    std::vector<ShaderModuleData> overrideModuleDatas(shaderInfo.size());
+    SmallVector<const PipelineShaderInfo *, 5> effectiveShaderInfo(shaderInfo.begin(), shaderInfo.end());
+
+    // Per-stage entries claimed in the lowered-bitcode cache; populated with this compile's post-lowering
+    // bitcode once the lowering loop has run.
+    SmallVector<CacheEntryHandle, 5> loweredBcEntries(shaderInfo.size(), nullptr);
     for (unsigned shaderIndex = 0; shaderIndex < shaderInfo.size() && result == Result::Success; ++shaderIndex) {
       const PipelineShaderInfo *shaderInfoEntry = shaderInfo[shaderIndex];
       if (!shaderInfoEntry || !shaderInfoEntry->pModuleData)
@@ -984,8 +1519,25 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
       const ShaderModuleDataEx *moduleDataEx =
           reinterpret_cast<const ShaderModuleDataEx *>(shaderInfoEntry->pModuleData);
 
+      const bool specializes =
+          shaderInfoEntry->pSpecializationInfo && shaderInfoEntry->pSpecializationInfo->mapEntryCount > 0;
+
       Module *module = nullptr;
-      if (moduleDataEx->common.binType == BinaryType::MultiLlvmBc) {
+      if (moduleDataEx->common.binType == BinaryType::MultiLlvmBc && specializes && moduleDataEx->spirvSize > 0) {
+        // The pre-lowered bitcode carries the default specialization values, but this pipeline specializes
+        // constants for this stage. Redirect the stage to the retained SPIR-V and retranslate.
+        overrideModuleDatas[shaderIndex] = moduleDataEx->common;
+        overrideModuleDatas[shaderIndex].binType = BinaryType::Spirv;
+        overrideModuleDatas[shaderIndex].binCode.pCode = voidPtrInc(moduleDataEx, moduleDataEx->spirvOffset);
+        overrideModuleDatas[shaderIndex].binCode.codeSize = moduleDataEx->spirvSize;
+        overrideShaderInfos[shaderIndex] = *shaderInfoEntry;
+        overrideShaderInfos[shaderIndex].pModuleData = &overrideModuleDatas[shaderIndex];
+        effectiveShaderInfo[shaderIndex] = &overrideShaderInfos[shaderIndex];
+
+        module = new Module((Twine("llpc") + getShaderStageName(shaderInfoEntry->entryStage)).str() +
+                                std::to_string(getModuleIdByIndex(shaderIndex)),
+                            *context);
+      } else if (moduleDataEx->common.binType == BinaryType::MultiLlvmBc) {
         timerProfiler.startStopTimer(TimerLoadBc, true);
 
         MetroHash::Hash entryNameHash = {};
@@ -1015,9 +1567,44 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
 
         timerProfiler.startStopTimer(TimerLoadBc, false);
       } else {
-        module = new Module((Twine("llpc") + getShaderStageName(shaderInfoEntry->entryStage)).str() +
-                            std::to_string(getModuleIdByIndex(shaderIndex)),
-                            *context);
+        if (cl::EnableLoweredBcCache && moduleDataEx->common.binType == BinaryType::Spirv) {
+          // Early cache probe on the post-lowering bitcode, keyed on the per-stage shader hash plus the
+          // state the translator and the per-shader lowering passes consume. Pipelines differing only in
+          // back-end state (blend, vertex format) share the bitcode and enter directly at the patch phase.
+          MetroHash64 hasher;
+          PipelineDumper::updateHashForPipelineShaderInfo(shaderInfoEntry->entryStage, shaderInfoEntry, true, &hasher,
+                                                          false);
+          auto pipelineOptions = context->getPipelineContext()->getPipelineOptions();
+          hasher.Update(reinterpret_cast<const uint8_t *>(pipelineOptions), sizeof(*pipelineOptions));
+          hasher.Update(forceLoopUnrollCount);
+          hasher.Update(unlinked);
+          MetroHash::Hash loweredBcHash = {};
+          hasher.Finalize(loweredBcHash.bytes);
+
+          CacheEntryHandle hEntry = nullptr;
+          ShaderEntryState entryState = m_shaderCache->findShader(loweredBcHash, true, &hEntry);
+          if (entryState == ShaderEntryState::Ready) {
+            const void *bcCode = nullptr;
+            size_t bcSize = 0;
+            if (m_shaderCache->retrieveShader(hEntry, &bcCode, &bcSize) == Result::Success) {
+              timerProfiler.startStopTimer(TimerLoadBc, true);
+              BinaryData binCode = {};
+              binCode.pCode = bcCode;
+              binCode.codeSize = bcSize;
+              module = context->loadLibary(&binCode).release();
+              timerProfiler.startStopTimer(TimerLoadBc, false);
+              if (module)
+                stageSkipMask |= (1 << shaderIndex);
+            }
+          } else if (entryState == ShaderEntryState::Compiling)
+            loweredBcEntries[shaderIndex] = hEntry;
+        }
+
+        if (!module) {
+          module = new Module((Twine("llpc") + getShaderStageName(shaderInfoEntry->entryStage)).str() +
+                              std::to_string(getModuleIdByIndex(shaderIndex)),
+                              *context);
+        }
       }
 
       modules[shaderIndex] = module;
@@ -1033,6 +1620,16 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
       if (!shaderInfoEntry || !shaderInfoEntry->pModuleData || (stageSkipMask & shaderStageToMask(entryStage)))
         continue;
 
+      // Check the per-context translation cache first: the same shader translated by an earlier build in this
+      // context is cloned instead of re-running the SPIR-V translator.
+      const uint64_t translationKey = getTranslationCacheKey(context, effectiveShaderInfo[shaderIndex]);
+      if (std::unique_ptr<Module> translated = context->lookUpTranslatedModule(translationKey)) {
+        translated->setModuleIdentifier(modules[shaderIndex]->getModuleIdentifier());
+        delete modules[shaderIndex];
+        modules[shaderIndex] = translated.release();
+        continue;
+      }
+
       std::unique_ptr<lgc::PassManager> lowerPassMgr(lgc::PassManager::Create());
       lowerPassMgr->setPassIndex(&passIndex);
 
@@ -1042,8 +1639,10 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
       // Start timer for translate.
       timerProfiler.addTimerStartStopPass(&*lowerPassMgr, TimerTranslate, true);
 
-      // SPIR-V translation, then dump the result.
-      lowerPassMgr->add(createSpirvLowerTranslator(entryStage, shaderInfoEntry));
+      // SPIR-V translation, then dump the result. Foldable specialization constants are translated
+      // symbolically; SpirvLowerSpecConstFold substitutes this pipeline's values ahead of the lowering passes.
+      lowerPassMgr->add(createSpirvLowerTranslator(entryStage, effectiveShaderInfo[shaderIndex],
+                                                   /*foldSpecConstants=*/true));
       if (EnableOuts()) {
         lowerPassMgr->add(createPrintModulePass(
             outs(), "\n"
@@ -1055,10 +1654,16 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
 
       // Run the passes.
       bool success = runPasses(&*lowerPassMgr, modules[shaderIndex]);
-      if (!success) {
+      if (success)
+        context->retainTranslatedModule(translationKey, modules[shaderIndex]);
+      else {
         LLPC_ERRS("Failed to translate SPIR-V or run per-shader passes\n");
         result = Result::ErrorInvalidShader;
       }
+
+      // A canceled build stops at the next phase boundary; our caller then releases the context as usual.
+      if (result == Result::Success && lgc::PassManager::isCanceledOnThread())
+        result = Result::ErrorUnavailable;
     }
     SmallVector<std::pair<Module *, lgc::ShaderStage>, 5> modulesToLink;
     for (unsigned shaderIndex = 0; shaderIndex < shaderInfo.size() && result == Result::Success; ++shaderIndex) {
@@ -1078,6 +1683,14 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
       std::unique_ptr<lgc::PassManager> lowerPassMgr(lgc::PassManager::Create());
       lowerPassMgr->setPassIndex(&passIndex);
 
+      // Substitute this pipeline's specialization values for the symbolic specialization constant globals the
+      // translator emitted. This runs on freshly translated modules and on clones from the translation cache
+      // alike, and must run before the lowering passes so the cached lowered bitcode is fully specialized.
+      const ShaderModuleData *moduleData =
+          reinterpret_cast<const ShaderModuleData *>(effectiveShaderInfo[shaderIndex]->pModuleData);
+      if (moduleData->binType == BinaryType::Spirv && moduleData->usage.specConstantsFoldable)
+        lowerPassMgr->add(createSpirvLowerSpecConstFold(effectiveShaderInfo[shaderIndex]->pSpecializationInfo));
+
       SpirvLower::addPasses(context, entryStage, *lowerPassMgr, timerProfiler.getTimer(TimerLower),
                             forceLoopUnrollCount
                             );
@@ -1087,7 +1700,29 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
         LLPC_ERRS("Failed to translate SPIR-V or run per-shader passes\n");
         result = Result::ErrorInvalidShader;
       }
+
+      if (success && loweredBcEntries[shaderIndex]) {
+        // Store the just-lowered bitcode so later pipelines with the same shader but different back-end
+        // state can skip the translator and the per-shader lowering passes.
+        SmallString<1024> loweredBc;
+        raw_svector_ostream loweredBcStream(loweredBc);
+        WriteBitcodeToFile(*modules[shaderIndex], loweredBcStream);
+        m_shaderCache->insertShader(loweredBcEntries[shaderIndex], loweredBc.data(), loweredBc.size());
+        loweredBcEntries[shaderIndex] = nullptr;
+      }
       modulesToLink.push_back({modules[shaderIndex], getLgcShaderStage(static_cast<ShaderStage>(shaderIndex))});
+
+      if (result == Result::Success && lgc::PassManager::isCanceledOnThread())
+        result = Result::ErrorUnavailable;
+    }
+
+    // Reset any still-claimed lowered-bitcode cache entries if the compile failed part way, so other threads
+    // waiting on them can take over the compile.
+    for (unsigned shaderIndex = 0; shaderIndex < shaderInfo.size(); ++shaderIndex) {
+      if (loweredBcEntries[shaderIndex]) {
+        m_shaderCache->resetShader(loweredBcEntries[shaderIndex]);
+        loweredBcEntries[shaderIndex] = nullptr;
+      }
     }
 
     // Link the shader modules into a single pipeline module.
@@ -1096,10 +1731,15 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
       LLPC_ERRS("Failed to link shader modules into pipeline module\n");
       result = Result::ErrorInvalidShader;
     }
+
+    // The decoded SPIR-V representations are only consumed by the translator and the lowering passes above;
+    // release them now instead of at the end-of-build context reset, so their memory does not stack under the
+    // patch and codegen phases' peak.
+    context->releaseParsedSpirvModules();
   }
 
   // Set up function to check shader cache.
-  GraphicsShaderCacheChecker graphicsShaderCacheChecker(this, context);
+  GraphicsShaderCacheChecker graphicsShaderCacheChecker(this, context, pipelineState);
 
   Pipeline::CheckShaderCacheFunc checkShaderCacheFunc =
       [&graphicsShaderCacheChecker](
@@ -1112,8 +1752,8 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
 
   // Only enable per stage cache for full graphic pipeline
   bool checkPerStageCache =
-      cl::EnablePerStageCache && context->isGraphics() && !buildingRelocatableElf &&
-      (context->getShaderStageMask() & (shaderStageToMask(ShaderStageVertex) | shaderStageToMask(ShaderStageFragment)));
+      usePerStageCache && cl::EnablePerStageCache && context->isGraphics() && !buildingRelocatableElf &&
+      (pipelineState.stageMask & (shaderStageToMask(ShaderStageVertex) | shaderStageToMask(ShaderStageFragment)));
   if (!checkPerStageCache)
     checkShaderCacheFunc = nullptr;
 
@@ -1139,6 +1779,11 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
     catch (const char *) {
     }
 #endif
+
+    // If a cancellation arrived during generation, the pass-manager runs inside generate() were skipped and the
+    // ELF stream holds nothing usable; report the build as canceled rather than handing it back.
+    if (result == Result::Success && lgc::PassManager::isCanceledOnThread())
+      result = Result::ErrorUnavailable;
   }
 
   if (checkPerStageCache) {
@@ -1147,9 +1792,28 @@ Result Compiler::buildPipelineInternal(Context *context, ArrayRef<const Pipeline
   }
 
   if (result == Result::Success && fragmentShaderInfo && fragmentShaderInfo->options.updateDescInElf &&
-      (context->getShaderStageMask() & shaderStageToMask(ShaderStageFragment)))
+      (pipelineState.stageMask & shaderStageToMask(ShaderStageFragment)))
     graphicsShaderCacheChecker.updateRootUserDateOffset(pipelineElf);
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  if (m_compileTimeBudgetUs > 0) {
+    lgc::PassManager::stopPassTimingOnThread();
+    uint64_t elapsedUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - buildStartTime)
+            .count();
+    if (elapsedUs > m_compileTimeBudgetUs && m_compileTimeExceededCallback) {
+      // Report the over-budget compilation with its per-pass breakdown.
+      std::string breakdown;
+      raw_string_ostream breakdownStream(breakdown);
+      for (const auto &passTime : passTimes)
+        breakdownStream << passTime.passName << ": " << passTime.nanos / 1000 << "\n";
+      breakdownStream.flush();
+      m_compileTimeExceededCallback(m_compileTimeExceededUserData, context->getPiplineHashCode(), elapsedUs,
+                                    breakdown.c_str());
+    }
+  }
+#endif
+
   context->setDiagnosticHandlerCallBack(nullptr);
 
   return result;
@@ -1168,7 +1832,7 @@ unsigned GraphicsShaderCacheChecker::check(const Module *module, unsigned stageM
   // Check per stage shader cache
   MetroHash::Hash fragmentHash = {};
   MetroHash::Hash nonFragmentHash = {};
-  Compiler::buildShaderCacheHash(m_context, stageMask, stageHashes, &fragmentHash, &nonFragmentHash);
+  Compiler::buildShaderCacheHash(m_context, *m_pipelineState, stageMask, stageHashes, &fragmentHash, &nonFragmentHash);
 
   IShaderCache *appCache = nullptr;
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38 || LLPC_ENABLE_SHADER_CACHE
@@ -1176,13 +1840,40 @@ unsigned GraphicsShaderCacheChecker::check(const Module *module, unsigned stageM
   appCache = reinterpret_cast<IShaderCache *>(pipelineInfo->pShaderCache);
 #endif
   if (stageMask & shaderStageToMask(ShaderStageFragment)) {
-    m_fragmentCacheEntryState = m_compiler->lookUpShaderCaches(appCache, &fragmentHash, &m_fragmentElf,
-                                                               &m_fragmentShaderCache, &m_hFragmentEntry);
+    // The null fragment shader synthesized for fragment-less pipelines is identical for every pipeline with the
+    // same fragment state, so its finished ELF is retained in the LgcContext. A hit skips an entire shader's
+    // worth of codegen as well as the shader cache's locking; depth-only passes take this path constantly.
+    if (lgc::LgcContext::hasNullFragmentShader(*module)) {
+      m_fragmentIsNullFs = true;
+      m_fragmentHash = fragmentHash;
+      ArrayRef<char> cachedElf =
+          m_context->getLgcContext()->lookUpSynthesizedShaderElf(MetroHash::compact64(&fragmentHash));
+      if (!cachedElf.empty()) {
+        m_fragmentElf.pCode = cachedElf.data();
+        m_fragmentElf.codeSize = cachedElf.size();
+        m_fragmentCacheEntryState = ShaderEntryState::Ready;
+      }
+    }
+
+    if (m_fragmentCacheEntryState == ShaderEntryState::New) {
+      m_fragmentCacheEntryState = m_compiler->lookUpShaderCaches(appCache, &fragmentHash, &m_fragmentElf,
+                                                                 &m_fragmentShaderCache, &m_hFragmentEntry);
+      if (m_fragmentCacheEntryState == ShaderEntryState::Failed) {
+        // Half-pipelines never record failures, so a failed entry under this hash belongs to another use of
+        // the key space; ignore it and compile the half, leaving the entry to expire on its own.
+        m_fragmentCacheEntryState = ShaderEntryState::Compiling;
+        m_hFragmentEntry = nullptr;
+      }
+    }
   }
 
   if (stageMask & ~shaderStageToMask(ShaderStageFragment)) {
     m_nonFragmentCacheEntryState = m_compiler->lookUpShaderCaches(appCache, &nonFragmentHash, &m_nonFragmentElf,
                                                                   &m_nonFragmentShaderCache, &m_hNonFragmentEntry);
+    if (m_nonFragmentCacheEntryState == ShaderEntryState::Failed) {
+      m_nonFragmentCacheEntryState = ShaderEntryState::Compiling;
+      m_hNonFragmentEntry = nullptr;
+    }
   }
 
   if (m_nonFragmentCacheEntryState != ShaderEntryState::Compiling) {
@@ -1223,16 +1914,26 @@ void GraphicsShaderCacheChecker::updateAndMerge(Result result, ElfPackage *outpu
     pipelineElf.codeSize = outputPipelineElf->size();
     pipelineElf.pCode = outputPipelineElf->data();
 
+    // A failure of the combined compile does not pinpoint which half is doomed, so map it to a result that
+    // releases the claims rather than recording a failure on both halves.
+    const Result cacheResult = result == Result::Success ? Result::Success : Result::ErrorUnknown;
+
     if (m_fragmentCacheEntryState == ShaderEntryState::Compiling) {
-      m_compiler->updateShaderCache(result == Result::Success, &pipelineElf, m_fragmentShaderCache, m_hFragmentEntry);
+      m_compiler->updateShaderCache(cacheResult, &pipelineElf, m_fragmentShaderCache, m_hFragmentEntry);
     }
 
     if (m_nonFragmentCacheEntryState == ShaderEntryState::Compiling) {
-      m_compiler->updateShaderCache(result == Result::Success, &pipelineElf, m_nonFragmentShaderCache,
-                                    m_hNonFragmentEntry);
+      m_compiler->updateShaderCache(cacheResult, &pipelineElf, m_nonFragmentShaderCache, m_hNonFragmentEntry);
     }
   }
 
+  // Retain a just-compiled null fragment shader half-pipeline in the LgcContext, so later pipelines with the
+  // same fragment state skip its codegen entirely.
+  if (result == Result::Success && m_fragmentIsNullFs && m_fragmentCacheEntryState == ShaderEntryState::Compiling) {
+    m_context->getLgcContext()->storeSynthesizedShaderElf(
+        MetroHash::compact64(&m_fragmentHash), ArrayRef<char>(outputPipelineElf->data(), outputPipelineElf->size()));
+  }
+
   // Now merge ELFs if one or both parts are from the cache. Nothing needs to be merged if we just compiled the full
   // pipeline, as everything is already contained in the single incoming ELF in this case.
   if (result == Result::Success && (m_fragmentCacheEntryState == ShaderEntryState::Ready ||
@@ -1312,12 +2013,180 @@ Result Compiler::buildGraphicsPipelineInternal(GraphicsContext *graphicsContext,
   Result result = Result::Success;
   if (buildingRelocatableElf)
     result = buildPipelineWithRelocatableElf(context, shaderInfo, forceLoopUnrollCount, pipelineElf);
-  else
+  else {
     result = buildPipelineInternal(context, shaderInfo, forceLoopUnrollCount, /*unlinked=*/false, pipelineElf);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+    result = retryIfSpilled(result, context, shaderInfo, forceLoopUnrollCount, pipelineElf);
+#endif
+  }
   releaseContext(context);
   return result;
 }
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+// =====================================================================================================================
+// Extracts per hardware stage resource statistics from a built pipeline ELF.
+//
+// Register counts only exist once the backend has written them into the PAL metadata note, so the statistics are
+// read back here, while the ELF is still in memory, instead of leaving the client to parse the ELF after the build.
+// A malformed ELF (e.g. from a corrupted cache entry) yields all-zero statistics rather than an error; the binary
+// itself is validated elsewhere.
+//
+// @param gfxIp : Graphics IP version info
+// @param elfBin : Built pipeline ELF binary
+// @param [out] stats : Per hardware stage statistics
+static void extractPipelineStats(GfxIpVersion gfxIp, const BinaryData &elfBin, PipelineStats *stats) {
+  *stats = {};
+
+  // The names of hardware shader stage map keys in PAL metadata, and the corresponding entry-point symbols,
+  // in Util::Abi::HardwareStage order.
+  static const char *const HwStageNames[] = {".ls", ".hs", ".es", ".gs", ".vs", ".ps", ".cs"};
+  static const Util::Abi::PipelineSymbolType HwStageEntrySymbols[] = {
+      Util::Abi::PipelineSymbolType::LsMainEntry, Util::Abi::PipelineSymbolType::HsMainEntry,
+      Util::Abi::PipelineSymbolType::EsMainEntry, Util::Abi::PipelineSymbolType::GsMainEntry,
+      Util::Abi::PipelineSymbolType::VsMainEntry, Util::Abi::PipelineSymbolType::PsMainEntry,
+      Util::Abi::PipelineSymbolType::CsMainEntry};
+  static_assert(sizeof(HwStageNames) / sizeof(HwStageNames[0]) == PipelineStatsHwStageCount,
+                "Hardware stage table mismatch");
+
+  ElfReader<Elf64> reader(gfxIp);
+  size_t readSize = elfBin.codeSize;
+  if (reader.ReadFromBuffer(elfBin.pCode, &readSize) != Result::Success)
+    return;
+
+  auto metaNote = reader.getNote(Util::Abi::PipelineAbiNoteType::PalMetadata);
+  if (!metaNote.data)
+    return;
+
+  msgpack::Document document;
+  if (!document.readFromBlob(StringRef(reinterpret_cast<const char *>(metaNote.data), metaNote.hdr.descSize), false))
+    return;
+
+  auto pipeline = document.getRoot().getMap(true)[Util::Abi::PalCodeObjectMetadataKey::Pipelines].getArray(true)[0];
+  auto hwStages = pipeline.getMap(true)[Util::Abi::PipelineMetadataKey::HardwareStages].getMap(true);
+
+  for (unsigned hwStage = 0; hwStage < PipelineStatsHwStageCount; ++hwStage) {
+    auto stageIt = hwStages.find(document.getNode(HwStageNames[hwStage]));
+    if (stageIt == hwStages.end())
+      continue;
+
+    PipelineStageStats &stageStats = stats->stages[hwStage];
+    stageStats.present = true;
+
+    auto stageNode = stageIt->second.getMap(true);
+    auto readStat = [&](const char *key, unsigned *value) {
+      auto it = stageNode.find(document.getNode(key));
+      if (it != stageNode.end())
+        *value = it->second.getUInt();
+    };
+    readStat(Util::Abi::HardwareStageMetadataKey::VgprCount, &stageStats.vgprCount);
+    readStat(Util::Abi::HardwareStageMetadataKey::SgprCount, &stageStats.sgprCount);
+    readStat(Util::Abi::HardwareStageMetadataKey::LdsSize, &stageStats.ldsSizeBytes);
+    readStat(Util::Abi::HardwareStageMetadataKey::ScratchMemorySize, &stageStats.scratchSizeBytes);
+    readStat(Util::Abi::HardwareStageMetadataKey::WavefrontSize, &stageStats.wavefrontSize);
+  }
+
+  // The ISA size of each stage is the size of its entry-point symbol in the symbol table.
+  for (unsigned idx = 0; idx < reader.getSymbolCount(); ++idx) {
+    ElfSymbol symbol = {};
+    reader.getSymbol(idx, &symbol);
+    for (unsigned hwStage = 0; hwStage < PipelineStatsHwStageCount; ++hwStage) {
+      auto entrySymbolName =
+          Util::Abi::PipelineAbiSymbolNameStrings[static_cast<unsigned>(HwStageEntrySymbols[hwStage])];
+      if (stats->stages[hwStage].present && strcmp(symbol.pSymName, entrySymbolName) == 0)
+        stats->stages[hwStage].isaSizeBytes = symbol.size;
+    }
+  }
+}
+
+// =====================================================================================================================
+// Sums the scratch memory usage of all hardware stages of a built pipeline ELF.
+//
+// @param gfxIp : Graphics IP version info
+// @param pipelineElf : Built pipeline ELF
+static unsigned pipelineElfScratchSize(GfxIpVersion gfxIp, const ElfPackage &pipelineElf) {
+  PipelineStats stats = {};
+  BinaryData elfBin = {};
+  elfBin.pCode = pipelineElf.data();
+  elfBin.codeSize = pipelineElf.size();
+  extractPipelineStats(gfxIp, elfBin, &stats);
+
+  unsigned scratchSize = 0;
+  for (const PipelineStageStats &stageStats : stats.stages)
+    scratchSize += stageStats.scratchSizeBytes;
+  return scratchSize;
+}
+
+// =====================================================================================================================
+// Retries a spilling pipeline build with a tightened loop unroll count, keeping the better result.
+//
+// Spilling pipelines are the worst GPU-side outliers, and the spill is often provoked by over-unrolled loops
+// inflating live ranges. When -spill-retry-unroll-count is set and a successful build uses scratch, the pipeline
+// is rebuilt once with that forced unroll count and the result with less scratch is kept. The retry skips the
+// per-stage shader cache, which the first build just populated with the spilling halves. A client-forced unroll
+// count is respected and not second-guessed.
+//
+// @param result : Result of the first build
+// @param context : Acquired context, still attached to the pipeline being built
+// @param shaderInfo : Shader info of this pipeline
+// @param forceLoopUnrollCount : Force loop unroll count the first build ran with (0 means disable)
+// @param [in/out] pipelineElf : ELF of the first build, replaced when the retry spills less
+Result Compiler::retryIfSpilled(Result result, Context *context, ArrayRef<const PipelineShaderInfo *> shaderInfo,
+                                unsigned forceLoopUnrollCount, ElfPackage *pipelineElf) {
+  if (result != Result::Success || cl::SpillRetryUnrollCount == 0 || forceLoopUnrollCount != 0)
+    return result;
+
+  const unsigned scratchSize = pipelineElfScratchSize(m_gfxIp, *pipelineElf);
+  if (scratchSize == 0)
+    return result;
+
+  ElfPackage retryElf;
+  if (buildPipelineInternal(context, shaderInfo, cl::SpillRetryUnrollCount, /*unlinked=*/false, &retryElf,
+                            /*usePerStageCache=*/false) == Result::Success &&
+      pipelineElfScratchSize(m_gfxIp, retryElf) < scratchSize)
+    *pipelineElf = retryElf;
+  return result;
+}
+#endif
+
+// =====================================================================================================================
+// Records one pipeline build request into the compile trace, when -compile-trace-dir is set.
+//
+// The request inputs are serialized through the pipeline dumper, and a line holding the global sequence number,
+// an index identifying the submitting thread and the dump file name is appended to the compile.trace index in
+// the same directory. Replaying the index with amdllpc -replay-trace re-executes the recorded builds with the
+// recorded thread assignment, reproducing the captured concurrency pattern deterministically.
+//
+// @param pipelineInfo : Build info of the request (graphics or compute)
+void Compiler::traceBuildRequest(Vkgc::PipelineBuildInfo pipelineInfo) {
+  static std::atomic<unsigned> NextSequence(0);
+  static std::atomic<unsigned> NextThreadIndex(0);
+  static thread_local unsigned ThreadIndex = ~0u;
+  static std::mutex TraceIndexMutex;
+
+  if (ThreadIndex == ~0u)
+    ThreadIndex = NextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+  const unsigned sequence = NextSequence.fetch_add(1, std::memory_order_relaxed);
+
+  MetroHash::Hash hash = pipelineInfo.pGraphicsInfo
+                             ? PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo.pGraphicsInfo, false, false)
+                             : PipelineDumper::generateHashForComputePipeline(pipelineInfo.pComputeInfo, false, false);
+
+  // Serialize the request through the pipeline dumper. Repeated builds of the same pipeline share one dump
+  // file; the index repeats its name, preserving the workload shape without duplicating the inputs.
+  PipelineDumpOptions dumpOptions = {};
+  dumpOptions.pDumpDir = cl::CompileTraceDir.c_str();
+  PipelineDumpFile *dumpFile = PipelineDumper::BeginPipelineDump(&dumpOptions, pipelineInfo, &hash);
+  if (dumpFile)
+    PipelineDumper::EndPipelineDump(dumpFile);
+
+  const std::string fileName = PipelineDumper::getPipelineInfoFileName(pipelineInfo, &hash);
+
+  std::lock_guard<std::mutex> lock(TraceIndexMutex);
+  std::ofstream indexFile(cl::CompileTraceDir + "/compile.trace", std::ios::app);
+  indexFile << sequence << " " << ThreadIndex << " " << fileName << ".pipe\n";
+}
+
 // =====================================================================================================================
 // Build graphics pipeline from the specified info.
 //
@@ -1329,6 +2198,12 @@ Result Compiler::BuildGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline
   Result result = Result::Success;
   BinaryData elfBin = {};
 
+  if (!cl::CompileTraceDir.empty()) {
+    Vkgc::PipelineBuildInfo buildInfo = {};
+    buildInfo.pGraphicsInfo = pipelineInfo;
+    traceBuildRequest(buildInfo);
+  }
+
   const PipelineShaderInfo *shaderInfo[ShaderStageGfxCount] = {
       &pipelineInfo->vs, &pipelineInfo->tcs, &pipelineInfo->tes, &pipelineInfo->gs, &pipelineInfo->fs,
   };
@@ -1381,14 +2256,36 @@ Result Compiler::BuildGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline
   else
     cacheEntryState = ShaderEntryState::Compiling;
 
+  if (cacheEntryState == ShaderEntryState::Failed) {
+    // A recent compile of this pipeline failed; return the recorded result right away instead of re-paying
+    // the compile. The failure entry expires on its own, after which the next lookup retries.
+    result = shaderCache->getShaderFailureResult(hEntry);
+  }
+
   ElfPackage candidateElf;
 
   if (cacheEntryState == ShaderEntryState::Compiling) {
     unsigned forceLoopUnrollCount = cl::ForceLoopUnrollCount;
 
-    GraphicsContext graphicsContext(m_gfxIp, pipelineInfo, &pipelineHash, &cacheHash);
-    result = buildGraphicsPipelineInternal(&graphicsContext, shaderInfo, forceLoopUnrollCount, buildingRelocatableElf,
-                                           &candidateElf);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+    Vkgc::PipelineBuildInfo remoteInfo = {};
+    remoteInfo.pGraphicsInfo = pipelineInfo;
+    if (m_remoteCompileFunc && !buildingRelocatableElf &&
+        tryRemoteCompile(remoteInfo, &pipelineHash, &candidateElf) == Result::Success) {
+      // The remote service compiled the pipeline; the cache update below replicates its ELF locally.
+      result = Result::Success;
+    } else
+#endif
+    {
+      GraphicsContext graphicsContext(m_gfxIp, pipelineInfo, &pipelineHash, &cacheHash);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+      PipelineProfileMetrics profileMetrics = {};
+      if (getProfileFeedback(MetroHash::compact64(&pipelineHash), &profileMetrics))
+        graphicsContext.setProfileMetrics(profileMetrics);
+#endif
+      result = buildGraphicsPipelineInternal(&graphicsContext, shaderInfo, forceLoopUnrollCount, buildingRelocatableElf,
+                                             &candidateElf);
+    }
 
     if (result == Result::Success) {
       elfBin.codeSize = candidateElf.size();
@@ -1396,7 +2293,7 @@ Result Compiler::BuildGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline
     }
 
     if (!buildingRelocatableElf)
-      updateShaderCache((result == Result::Success), &elfBin, shaderCache, hEntry);
+      updateShaderCache(result, &elfBin, shaderCache, hEntry);
   }
 
   if (result == Result::Success) {
@@ -1409,6 +2306,10 @@ Result Compiler::BuildGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline
 
       pipelineOut->pipelineBin.codeSize = elfBin.codeSize;
       pipelineOut->pipelineBin.pCode = code;
+
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+      extractPipelineStats(m_gfxIp, elfBin, &pipelineOut->pipelineStats);
+#endif
     } else {
       // Allocator is not specified
       result = Result::ErrorInvalidPointer;
@@ -1439,12 +2340,100 @@ Result Compiler::buildComputePipelineInternal(ComputeContext *computeContext,
   Result result;
   if (buildingRelocatableElf)
     result = buildPipelineWithRelocatableElf(context, shadersInfo, forceLoopUnrollCount, pipelineElf);
-  else
+  else {
     result = buildPipelineInternal(context, shadersInfo, forceLoopUnrollCount, /*unlinked=*/false, pipelineElf);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+    result = retryIfSpilled(result, context, shadersInfo, forceLoopUnrollCount, pipelineElf);
+#endif
+  }
   releaseContext(context);
   return result;
 }
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+// =====================================================================================================================
+// Scores a compute pipeline candidate ELF for wave size auto-tuning; lower is better.
+//
+// Spilling dominates the score: scratch traffic is the worst outcome either wave size can produce. VGPR count
+// comes next; per lane the register cost of the two widths is equal, so the raw count rewards whichever width
+// the register allocator handled better. ISA size breaks remaining ties, as a proxy for instruction count and
+// how well memory clauses formed.
+//
+// @param gfxIp : Graphics IP version info
+// @param candidateElf : Built candidate pipeline ELF
+static uint64_t scoreComputeCandidate(GfxIpVersion gfxIp, const ElfPackage &candidateElf) {
+  PipelineStats stats = {};
+  BinaryData elfBin = {};
+  elfBin.pCode = candidateElf.data();
+  elfBin.codeSize = candidateElf.size();
+  extractPipelineStats(gfxIp, elfBin, &stats);
+
+  const PipelineStageStats &csStats = stats.stages[static_cast<unsigned>(Util::Abi::HardwareStage::Cs)];
+  uint64_t score = uint64_t(std::min(csStats.scratchSizeBytes, 0xFFFFFFu)) << 40;
+  score |= uint64_t(std::min(csStats.vgprCount, 0xFFFFu)) << 24;
+  score |= std::min(csStats.isaSizeBytes, 0xFFFFFFu);
+  return score;
+}
+
+// =====================================================================================================================
+// Builds a compute pipeline at both wave sizes and keeps the candidate with the better ISA statistics.
+//
+// Both candidates run in the same process, so the front-end work is shared through the per-context caches: the
+// second candidate reuses the translated module (the translation cache key does not include the wave size) and
+// forks at the lowering and patch phases. The winning wave size is remembered per shader module, so later
+// pipelines using the same shader build once; the finished pipeline itself is cached by the caller as usual,
+// making a repeat build of the same pipeline free.
+//
+// @param pipelineInfo : Info to build this compute pipeline
+// @param pipelineHash : Pipeline hash code
+// @param cacheHash : Cache hash code
+// @param forceLoopUnrollCount : Force loop unroll count (0 means disable)
+// @param [out] pipelineElf : Output Elf package
+Result Compiler::buildComputePipelineWaveTuned(const ComputePipelineBuildInfo *pipelineInfo,
+                                               MetroHash::Hash *pipelineHash, MetroHash::Hash *cacheHash,
+                                               unsigned forceLoopUnrollCount, ElfPackage *pipelineElf) {
+  const ShaderModuleData *moduleData = reinterpret_cast<const ShaderModuleData *>(pipelineInfo->cs.pModuleData);
+  const uint64_t moduleHash = MetroHash::compact64(reinterpret_cast<const MetroHash::Hash *>(&moduleData->hash[0]));
+
+  ComputePipelineBuildInfo tunedInfo = *pipelineInfo;
+
+  // A decision already made for this shader module is applied directly.
+  {
+    std::lock_guard<std::mutex> lock(m_tunedWaveSizesMutex);
+    auto tunedIt = m_tunedWaveSizes.find(moduleHash);
+    if (tunedIt != m_tunedWaveSizes.end())
+      tunedInfo.cs.options.waveSize = tunedIt->second;
+  }
+
+  if (tunedInfo.cs.options.waveSize != 0) {
+    ComputeContext computeContext(m_gfxIp, &tunedInfo, pipelineHash, cacheHash);
+    return buildComputePipelineInternal(&computeContext, &tunedInfo, forceLoopUnrollCount,
+                                        /*buildingRelocatableElf=*/false, pipelineElf);
+  }
+
+  // Wave64 goes first so it wins ties, matching the untuned default for compute.
+  static const unsigned CandidateWaveSizes[] = {64, 32};
+  ElfPackage candidateElfs[2];
+  uint64_t candidateScores[2] = {};
+  for (unsigned candidate = 0; candidate < 2; ++candidate) {
+    tunedInfo.cs.options.waveSize = CandidateWaveSizes[candidate];
+    ComputeContext computeContext(m_gfxIp, &tunedInfo, pipelineHash, cacheHash);
+    Result result = buildComputePipelineInternal(&computeContext, &tunedInfo, forceLoopUnrollCount,
+                                                 /*buildingRelocatableElf=*/false, &candidateElfs[candidate]);
+    if (result != Result::Success)
+      return result;
+    candidateScores[candidate] = scoreComputeCandidate(m_gfxIp, candidateElfs[candidate]);
+  }
+
+  const unsigned best = candidateScores[1] < candidateScores[0] ? 1 : 0;
+  *pipelineElf = candidateElfs[best];
+
+  std::lock_guard<std::mutex> lock(m_tunedWaveSizesMutex);
+  m_tunedWaveSizes[moduleHash] = CandidateWaveSizes[best];
+  return Result::Success;
+}
+#endif
+
 // =====================================================================================================================
 // Build compute pipeline from the specified info.
 //
@@ -1455,6 +2444,12 @@ Result Compiler::BuildComputePipeline(const ComputePipelineBuildInfo *pipelineIn
                                       ComputePipelineBuildOut *pipelineOut, void *pipelineDumpFile) {
   BinaryData elfBin = {};
 
+  if (!cl::CompileTraceDir.empty()) {
+    Vkgc::PipelineBuildInfo buildInfo = {};
+    buildInfo.pComputeInfo = pipelineInfo;
+    traceBuildRequest(buildInfo);
+  }
+
   bool buildingRelocatableElf = pipelineInfo->options.enableRelocatableShaderElf || cl::UseRelocatableShaderElf;
   buildingRelocatableElf = buildingRelocatableElf && canUseRelocatableComputeShaderElf(&pipelineInfo->cs);
 
@@ -1498,22 +2493,47 @@ Result Compiler::BuildComputePipeline(const ComputePipelineBuildInfo *pipelineIn
   else
     cacheEntryState = ShaderEntryState::Compiling;
 
+  if (cacheEntryState == ShaderEntryState::Failed) {
+    // A recent compile of this pipeline failed; return the recorded result right away instead of re-paying
+    // the compile. The failure entry expires on its own, after which the next lookup retries.
+    result = shaderCache->getShaderFailureResult(hEntry);
+  }
+
   ElfPackage candidateElf;
 
   if (cacheEntryState == ShaderEntryState::Compiling) {
     unsigned forceLoopUnrollCount = cl::ForceLoopUnrollCount;
 
-    ComputeContext computeContext(m_gfxIp, pipelineInfo, &pipelineHash, &cacheHash);
-
-    result = buildComputePipelineInternal(&computeContext, pipelineInfo, forceLoopUnrollCount, buildingRelocatableElf,
-                                          &candidateElf);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+    Vkgc::PipelineBuildInfo remoteInfo = {};
+    remoteInfo.pComputeInfo = pipelineInfo;
+    if (m_remoteCompileFunc && !buildingRelocatableElf &&
+        tryRemoteCompile(remoteInfo, &pipelineHash, &candidateElf) == Result::Success) {
+      // The remote service compiled the pipeline; the cache update below replicates its ELF locally.
+      result = Result::Success;
+    } else if (cl::AutoTuneWaveSize && !buildingRelocatableElf && m_gfxIp.major >= 10 &&
+               pipelineInfo->cs.options.waveSize == 0) {
+      result = buildComputePipelineWaveTuned(pipelineInfo, &pipelineHash, &cacheHash, forceLoopUnrollCount,
+                                             &candidateElf);
+    } else
+#endif
+    {
+      ComputeContext computeContext(m_gfxIp, pipelineInfo, &pipelineHash, &cacheHash);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+      PipelineProfileMetrics profileMetrics = {};
+      if (getProfileFeedback(MetroHash::compact64(&pipelineHash), &profileMetrics))
+        computeContext.setProfileMetrics(profileMetrics);
+#endif
+      result = buildComputePipelineInternal(&computeContext, pipelineInfo, forceLoopUnrollCount, buildingRelocatableElf,
+                                            &candidateElf);
+    }
 
     if (result == Result::Success) {
       elfBin.codeSize = candidateElf.size();
       elfBin.pCode = candidateElf.data();
     }
     if (!buildingRelocatableElf)
-      updateShaderCache((result == Result::Success), &elfBin, shaderCache, hEntry);
+      updateShaderCache(result, &elfBin, shaderCache, hEntry);
   }
 
   if (result == Result::Success) {
@@ -1526,6 +2546,10 @@ Result Compiler::BuildComputePipeline(const ComputePipelineBuildInfo *pipelineIn
 
         pipelineOut->pipelineBin.codeSize = elfBin.codeSize;
         pipelineOut->pipelineBin.pCode = code;
+
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+        extractPipelineStats(m_gfxIp, elfBin, &pipelineOut->pipelineStats);
+#endif
       } else
         result = Result::ErrorOutOfMemory;
     } else {
@@ -1537,12 +2561,449 @@ Result Compiler::BuildComputePipeline(const ComputePipelineBuildInfo *pipelineIn
   return result;
 }
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+// =====================================================================================================================
+// Enqueues a graphics pipeline build on the internal scheduler and returns a handle identifying it.
+//
+// @param pipelineInfo : Info to build this graphics pipeline; must stay valid until the build is waited on
+// @param [out] pipelineOut : Output of the build, valid once the build has been waited on
+// @param [out] phBuild : Handle identifying the enqueued build
+// @param priority : Priority class of the build
+Result Compiler::BuildGraphicsPipelineAsync(const GraphicsPipelineBuildInfo *pipelineInfo,
+                                            GraphicsPipelineBuildOut *pipelineOut, PipelineBuildHandle *phBuild,
+                                            PipelineBuildPriority priority) {
+  assert(phBuild);
+  auto *job = new AsyncBuildJob;
+  job->graphicsInfo = pipelineInfo;
+  job->graphicsOut = pipelineOut;
+  job->computeInfo = nullptr;
+  job->computeOut = nullptr;
+  job->result = Result::ErrorUnknown;
+  job->done = false;
+  job->speculative = false;
+  job->priority = priority;
+  job->canceled = false;
+  enqueueAsyncBuild(job);
+  *phBuild = job;
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Enqueues a compute pipeline build on the internal scheduler and returns a handle identifying it.
+//
+// @param pipelineInfo : Info to build this compute pipeline; must stay valid until the build is waited on
+// @param [out] pipelineOut : Output of the build, valid once the build has been waited on
+// @param [out] phBuild : Handle identifying the enqueued build
+// @param priority : Priority class of the build
+Result Compiler::BuildComputePipelineAsync(const ComputePipelineBuildInfo *pipelineInfo,
+                                           ComputePipelineBuildOut *pipelineOut, PipelineBuildHandle *phBuild,
+                                           PipelineBuildPriority priority) {
+  assert(phBuild);
+  auto *job = new AsyncBuildJob;
+  job->graphicsInfo = nullptr;
+  job->graphicsOut = nullptr;
+  job->computeInfo = pipelineInfo;
+  job->computeOut = pipelineOut;
+  job->result = Result::ErrorUnknown;
+  job->done = false;
+  job->speculative = false;
+  job->priority = priority;
+  job->canceled = false;
+  enqueueAsyncBuild(job);
+  *phBuild = job;
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Waits for an asynchronous pipeline build to complete, releases its handle and returns its result.
+//
+// @param hBuild : Handle of the build to wait for; invalid after this call
+Result Compiler::WaitForPipelineBuild(PipelineBuildHandle hBuild) {
+  auto *job = static_cast<AsyncBuildJob *>(hBuild);
+  assert(job);
+
+  std::unique_lock<std::mutex> lock(m_asyncMutex);
+  m_asyncDoneCondition.wait(lock, [job] { return job->done; });
+  Result result = job->result;
+  lock.unlock();
+
+  delete job;
+  return result;
+}
+
+// =====================================================================================================================
+// Requests cancellation of an asynchronous pipeline build whose result is no longer wanted. A build still in the
+// queue never runs; a running build stops cooperatively at its next compilation phase boundary. The handle must
+// still be released with WaitForPipelineBuild.
+//
+// @param hBuild : Handle of the build to cancel; stays valid until waited on
+Result Compiler::CancelPipelineBuild(PipelineBuildHandle hBuild) {
+  auto *job = static_cast<AsyncBuildJob *>(hBuild);
+  assert(job);
+
+  std::unique_lock<std::mutex> lock(m_asyncMutex);
+  auto queuePos = std::find(m_asyncJobQueue.begin(), m_asyncJobQueue.end(), job);
+  if (queuePos != m_asyncJobQueue.end()) {
+    // Still queued: complete it right here without it ever reaching a worker.
+    m_asyncJobQueue.erase(queuePos);
+    job->result = Result::ErrorUnavailable;
+    job->done = true;
+    lock.unlock();
+    m_asyncDoneCondition.notify_all();
+    return Result::Success;
+  }
+
+  // Already picked up (or already finished): raise the flag the running build polls between its compilation
+  // phases. A build that finishes before noticing keeps its real result.
+  job->canceled.store(true, std::memory_order_relaxed);
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Sets the compile-time budget for pipeline compilations, and the callback fired when one exceeds it.
+//
+// @param budgetUs : Budget for one pipeline compilation in microseconds, or 0 to disable
+// @param pfnCallback : Callback to fire when the budget is exceeded
+// @param pUserData : Client data passed through to the callback
+void Compiler::SetCompileTimeBudget(uint64_t budgetUs, CompileTimeExceededCallback pfnCallback, void *pUserData) {
+  m_compileTimeBudgetUs = budgetUs;
+  m_compileTimeExceededCallback = pfnCallback;
+  m_compileTimeExceededUserData = pUserData;
+}
+
+// =====================================================================================================================
+// Sets the soft memory budget that throttles concurrent compilations.
+//
+// @param budgetBytes : Soft cap on the process allocation footprint in bytes, or 0 to disable
+void Compiler::SetMemoryBudget(uint64_t budgetBytes) {
+  m_memoryBudget.store(budgetBytes, std::memory_order_relaxed);
+  // Wake any throttled threads so a lifted or raised budget takes effect immediately.
+  m_memoryBudgetCondition.notify_all();
+}
+
+// =====================================================================================================================
+// Sets the handler used to forward pipeline compilations to a remote compile service.
+//
+// @param pfnRemoteCompile : Remote compile callback, or null to disable forwarding
+// @param pClientData : Client-opaque data passed to the callback
+void Compiler::SetRemoteCompileHandler(PipelineCompileRemoteFunc pfnRemoteCompile, const void *pClientData) {
+  m_remoteCompileFunc = pfnRemoteCompile;
+  m_remoteCompileClientData = pClientData;
+}
+
+// =====================================================================================================================
+// Offers a pipeline build whose shader cache probe missed to the remote compile handler.
+//
+// The pipeline is serialized to its textual .pipe form - the same replayable representation the pipeline dumper
+// writes, with shader modules referenced by hash - and the handler is asked for a compiled ELF in two phases: a
+// size query with a null buffer, then the fetch. Any failure (no handler, handler error, or a reply that is not
+// an ELF) leaves the output untouched so the caller can fall back to the local compile path; a success is
+// indistinguishable from a local build, so the caller's shader cache insertion replicates the remote result to
+// whatever node-local stores the cache is configured with.
+//
+// @param buildInfo : Build info of the pipeline, with exactly one of pGraphicsInfo/pComputeInfo set
+// @param pipelineHash : Pipeline hash identifying the build to the service
+// @param [out] pipelineElf : Output ELF package, filled on success
+Result Compiler::tryRemoteCompile(Vkgc::PipelineBuildInfo buildInfo, const MetroHash::Hash *pipelineHash,
+                                  ElfPackage *pipelineElf) {
+  if (!m_remoteCompileFunc)
+    return Result::ErrorUnavailable;
+
+  std::ostringstream pipeText;
+  if (buildInfo.pGraphicsInfo)
+    PipelineDumper::dumpGraphicsPipelineInfo(&pipeText, nullptr, buildInfo.pGraphicsInfo);
+  else
+    PipelineDumper::dumpComputePipelineInfo(&pipeText, nullptr, buildInfo.pComputeInfo);
+  const std::string text = pipeText.str();
+  const uint64_t hash = MetroHash::compact64(pipelineHash);
+
+  size_t elfSize = 0;
+  Result result = m_remoteCompileFunc(m_remoteCompileClientData, hash, text.data(), text.size(), nullptr, &elfSize);
+  if (result != Result::Success)
+    return result;
+  if (elfSize == 0)
+    return Result::ErrorUnavailable;
+
+  pipelineElf->resize(elfSize);
+  result = m_remoteCompileFunc(m_remoteCompileClientData, hash, text.data(), text.size(), pipelineElf->data(),
+                               &elfSize);
+  if (result != Result::Success)
+    return result;
+  pipelineElf->resize(elfSize);
+
+  if (elfSize < sizeof(ElfMagic) || memcmp(pipelineElf->data(), &ElfMagic, sizeof(ElfMagic)) != 0)
+    return Result::ErrorInvalidValue;
+
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Loads GPU profile feedback for previously built pipelines from the given file.
+//
+// Each line maps one pipeline to the metrics a profiler observed while it ran:
+// "<pipelineHash> <limiter> <memBound> <averageWaves>" with limiter one of none/vgprs/sgprs/lds; '#' starts a
+// comment. The hash is the 64-bit pipeline hash reported at build time (PIPE in the verbose output). Loaded
+// metrics are consulted by the wave size and loop unrolling decisions on the next compile of the pipeline.
+//
+// @param pFilePath : Path of the feedback file
+Result Compiler::LoadProfileFeedback(const char *pFilePath) {
+  auto bufferOrErr = MemoryBuffer::getFile(pFilePath);
+  if (!bufferOrErr)
+    return Result::ErrorUnavailable;
+
+  // Parse the whole file before publishing anything, so a malformed file does not apply partially.
+  std::map<uint64_t, PipelineProfileMetrics> feedback;
+  StringRef rest = (*bufferOrErr)->getBuffer();
+  while (!rest.empty()) {
+    StringRef line;
+    std::tie(line, rest) = rest.split('\n');
+    line = line.split('#').first.trim();
+    if (line.empty())
+      continue;
+
+    SmallVector<StringRef, 4> fields;
+    line.split(fields, ' ', -1, /*KeepEmpty=*/false);
+    PipelineProfileMetrics metrics = {};
+    unsigned memBound = 0;
+    double averageWaves = 0.0;
+    if (fields.size() != 4 || fields[0].getAsInteger(0, metrics.pipelineHash) ||
+        fields[2].getAsInteger(0, memBound) || fields[3].getAsDouble(averageWaves))
+      return Result::ErrorInvalidValue;
+    metrics.limiter = StringSwitch<ProfileOccupancyLimiter>(fields[1])
+                          .Case("vgprs", ProfileOccupancyLimiter::Vgprs)
+                          .Case("sgprs", ProfileOccupancyLimiter::Sgprs)
+                          .Case("lds", ProfileOccupancyLimiter::Lds)
+                          .Default(ProfileOccupancyLimiter::None);
+    metrics.memoryBound = memBound != 0;
+    metrics.averageWaves = static_cast<float>(averageWaves);
+    feedback[metrics.pipelineHash] = metrics;
+  }
+
+  std::lock_guard<std::mutex> lock(m_profileFeedbackMutex);
+  for (auto &entry : feedback)
+    m_profileFeedback[entry.first] = entry.second;
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Looks up the loaded profile feedback for a pipeline.
+//
+// @param pipelineHash : 64-bit pipeline hash of the pipeline being built
+// @param [out] metrics : Metrics observed for the pipeline, filled when feedback exists
+//
+// @returns Whether feedback was loaded for the pipeline.
+bool Compiler::getProfileFeedback(uint64_t pipelineHash, PipelineProfileMetrics *metrics) {
+  std::lock_guard<std::mutex> lock(m_profileFeedbackMutex);
+  auto feedbackIt = m_profileFeedback.find(pipelineHash);
+  if (feedbackIt == m_profileFeedback.end())
+    return false;
+  *metrics = feedbackIt->second;
+  return true;
+}
+
+// =====================================================================================================================
+// Speculatively compiles variants of a just-built graphics pipeline on the internal scheduler.
+//
+// Each delta is applied to a private copy of the base build info and enqueued as a fire-and-forget job; the
+// workers compile the variants into the shader cache so that a later build of the same state is a cache hit.
+//
+// @param pipelineInfo : Base build info the deltas are applied against
+// @param deltas : Array of state deltas, one per variant to compile
+// @param deltaCount : Number of deltas in the array
+Result Compiler::SpeculateGraphicsPipelineVariants(const GraphicsPipelineBuildInfo *pipelineInfo,
+                                                   const GraphicsPipelineStateDelta *deltas, unsigned deltaCount) {
+  if (!pipelineInfo || (!deltas && deltaCount > 0))
+    return Result::ErrorInvalidPointer;
+
+  for (unsigned i = 0; i < deltaCount; ++i) {
+    auto *job = new AsyncBuildJob;
+    job->speculativeInfo = *pipelineInfo;
+    job->graphicsInfo = &job->speculativeInfo;
+    job->graphicsOut = nullptr;
+    job->computeInfo = nullptr;
+    job->computeOut = nullptr;
+    job->result = Result::ErrorUnknown;
+    job->done = false;
+    job->speculative = true;
+    job->priority = PipelineBuildPriority::Low;
+    job->canceled = false;
+
+    GraphicsPipelineBuildInfo &info = job->speculativeInfo;
+    const GraphicsPipelineStateDelta &delta = deltas[i];
+    if (delta.overrideColorState) {
+      info.cbState.alphaToCoverageEnable = delta.alphaToCoverageEnable;
+      info.cbState.dualSourceBlendEnable = delta.dualSourceBlendEnable;
+      for (unsigned target = 0; target < MaxColorTargets; ++target)
+        info.cbState.target[target] = delta.target[target];
+    }
+    if (delta.overrideDepthState) {
+      info.vpState.depthClipEnable = delta.depthClipEnable;
+      info.rsState.depthBiasEnable = delta.depthBiasEnable;
+    }
+
+    enqueueAsyncBuild(job);
+  }
+
+  return Result::Success;
+}
+#endif
+
+// =====================================================================================================================
+// Builds one speculative pipeline variant, inserting the result into the shader cache and discarding the ELF.
+//
+// This is the cache-populating core of BuildGraphicsPipeline without the client output allocation: the variant's
+// cache entry is claimed, compiled if nobody else got there first, and the resulting binary handed to the cache.
+// Relocatable builds skip the pipeline-level cache and populate the per-half shader caches internally instead.
+//
+// @param pipelineInfo : Build info of the variant
+void Compiler::buildSpeculativeVariant(const GraphicsPipelineBuildInfo *pipelineInfo) {
+  const PipelineShaderInfo *shaderInfo[ShaderStageGfxCount] = {
+      &pipelineInfo->vs, &pipelineInfo->tcs, &pipelineInfo->tes, &pipelineInfo->gs, &pipelineInfo->fs,
+  };
+
+  bool buildingRelocatableElf = pipelineInfo->options.enableRelocatableShaderElf || cl::UseRelocatableShaderElf;
+  buildingRelocatableElf = buildingRelocatableElf && canUseRelocatableGraphicsShaderElf(shaderInfo);
+
+  MetroHash::Hash cacheHash =
+      PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, true, buildingRelocatableElf);
+  MetroHash::Hash pipelineHash = PipelineDumper::generateHashForGraphicsPipeline(pipelineInfo, false, false);
+
+  // Claim the cache entry for the variant. If it is already present, or being compiled by the application or
+  // another speculative build, there is nothing to do.
+  BinaryData elfBin = {};
+  ShaderCache *shaderCache = nullptr;
+  CacheEntryHandle hEntry = nullptr;
+  ShaderEntryState cacheEntryState = ShaderEntryState::Compiling;
+  if (!buildingRelocatableElf) {
+    IShaderCache *appCache = nullptr;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38 || LLPC_ENABLE_SHADER_CACHE
+    appCache = reinterpret_cast<IShaderCache *>(pipelineInfo->pShaderCache);
+#endif
+    cacheEntryState = lookUpShaderCaches(appCache, &cacheHash, &elfBin, &shaderCache, &hEntry);
+  }
+  if (cacheEntryState != ShaderEntryState::Compiling)
+    return;
+
+  ElfPackage candidateElf;
+  GraphicsContext graphicsContext(m_gfxIp, pipelineInfo, &pipelineHash, &cacheHash);
+  Result result = buildGraphicsPipelineInternal(&graphicsContext, shaderInfo, cl::ForceLoopUnrollCount,
+                                                buildingRelocatableElf, &candidateElf);
+
+  if (result == Result::Success) {
+    elfBin.codeSize = candidateElf.size();
+    elfBin.pCode = candidateElf.data();
+  }
+
+  if (!buildingRelocatableElf)
+    updateShaderCache(result, &elfBin, shaderCache, hEntry);
+}
+
+// =====================================================================================================================
+// Hands a build job to the scheduler's worker pool, starting the workers on first use.
+//
+// @param job : Build job to enqueue
+void Compiler::enqueueAsyncBuild(AsyncBuildJob *job) {
+  {
+    std::unique_lock<std::mutex> lock(m_asyncMutex);
+
+    if (m_asyncWorkers.empty()) {
+      // Lazily size the worker pool so purely synchronous clients never pay for it.
+      unsigned threadCount = cl::AsyncPipelineThreads;
+      if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+      for (unsigned i = 0; i < threadCount; ++i)
+        m_asyncWorkers.emplace_back(&Compiler::asyncWorkerLoop, this);
+    }
+
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+    // Keep the queue ordered by priority; builds of the same priority run in submission order. Speculative
+    // variants are enqueued at low priority, so speculation only consumes otherwise idle worker time.
+    auto insertPos = std::find_if(m_asyncJobQueue.begin(), m_asyncJobQueue.end(),
+                                  [job](const AsyncBuildJob *queued) { return queued->priority < job->priority; });
+    m_asyncJobQueue.insert(insertPos, job);
+#else
+    if (job->speculative)
+      m_asyncJobQueue.push_back(job);
+    else
+      m_asyncJobQueue.push_front(job);
+#endif
+  }
+  m_asyncWorkCondition.notify_one();
+}
+
+// =====================================================================================================================
+// Asks the scheduler's workers to drain the queue and exit, then joins them. Safe to call with no workers running.
+void Compiler::stopAsyncWorkers() {
+  {
+    std::unique_lock<std::mutex> lock(m_asyncMutex);
+    m_asyncExit = true;
+  }
+  m_asyncWorkCondition.notify_all();
+  for (std::thread &worker : m_asyncWorkers)
+    worker.join();
+  m_asyncWorkers.clear();
+}
+
+// =====================================================================================================================
+// Main loop of one scheduler worker: picks up queued builds and runs them through the synchronous build entry
+// points, which load-balance contexts through the shared context pool.
+void Compiler::asyncWorkerLoop() {
+  std::unique_lock<std::mutex> lock(m_asyncMutex);
+  for (;;) {
+    m_asyncWorkCondition.wait(lock, [this] { return m_asyncExit || !m_asyncJobQueue.empty(); });
+
+    if (m_asyncJobQueue.empty()) {
+      if (m_asyncExit)
+        break;
+      continue;
+    }
+
+    AsyncBuildJob *job = m_asyncJobQueue.front();
+    m_asyncJobQueue.pop_front();
+    lock.unlock();
+
+    if (job->speculative) {
+      // Speculative variant: populate the shader cache and throw the job away; nobody will wait on it.
+      buildSpeculativeVariant(job->graphicsInfo);
+      delete job;
+      lock.lock();
+      continue;
+    }
+
+    // Register the job's cancellation flag for this thread, so a cancel arriving while the build runs stops it
+    // at the next pass-manager phase boundary and hands the context back to the pool.
+    lgc::PassManager::setCancelFlagOnThread(&job->canceled);
+    Result result = job->graphicsInfo ? BuildGraphicsPipeline(job->graphicsInfo, job->graphicsOut)
+                                      : BuildComputePipeline(job->computeInfo, job->computeOut);
+    lgc::PassManager::clearCancelFlagOnThread();
+
+    lock.lock();
+    job->result = result;
+    job->done = true;
+    m_asyncDoneCondition.notify_all();
+  }
+}
+
 // =====================================================================================================================
 // Builds hash code from compilation-options
 //
 // @param optionCount : Count of compilation-option strings
 // @param options : An array of compilation-option strings
 MetroHash::Hash Compiler::generateHashForCompileOptions(unsigned optionCount, const char *const *options) {
+  // Memoize the filtered, order-insensitive hash below per distinct raw option array: drivers typically create
+  // one compiler instance per device with an identical option array, so repeated calls are the normal case.
+  // The cache key is a cheap digest of the raw strings in their given order. Guarded by the compiler mutex
+  // held by our only caller, ICompiler::Create.
+  static std::map<uint64_t, MetroHash::Hash> SOptionHashCache;
+  MetroHash64 rawHasher;
+  for (unsigned i = 1; i < optionCount; ++i)
+    rawHasher.Update(reinterpret_cast<const uint8_t *>(options[i]), strlen(options[i]) + 1);
+  MetroHash::Hash rawHash = {};
+  rawHasher.Finalize(rawHash.bytes);
+  auto cacheIt = SOptionHashCache.find(MetroHash::compact64(&rawHash));
+  if (cacheIt != SOptionHashCache.end())
+    return cacheIt->second;
+
   // Options which needn't affect compilation results
   static StringRef IgnoredOptions[] = {cl::PipelineDumpDir.ArgStr,
                                        cl::EnablePipelineDump.ArgStr,
@@ -1586,6 +3047,7 @@ MetroHash::Hash Compiler::generateHashForCompileOptions(unsigned optionCount, co
   MetroHash::Hash hash = {};
   hasher.Finalize(hash.bytes);
 
+  SOptionHashCache[MetroHash::compact64(&rawHash)] = hash;
   return hash;
 }
 
@@ -1664,38 +3126,105 @@ Result Compiler::CreateShaderCache(const ShaderCacheCreateInfo *pCreateInfo, ISh
 #endif
 
 // =====================================================================================================================
-// Acquires a free context from context pool.
+// Blocks until starting one more compilation is expected to fit in the memory budget. Returns immediately when
+// no budget is set or no other compilation is in flight, so a single compilation can always proceed no matter
+// how small the budget.
+void Compiler::waitForMemoryBudget() {
+  if (m_memoryBudget.load(std::memory_order_relaxed) == 0)
+    return;
+
+  std::unique_lock<std::mutex> lock(m_memoryBudgetMutex);
+  for (;;) {
+    uint64_t budget = m_memoryBudget.load(std::memory_order_relaxed);
+    if (budget == 0 || m_activeCompiles.load(std::memory_order_relaxed) == 0)
+      return;
+    uint64_t projected = sys::Process::GetMallocUsage() + m_perCompileFootprint.load(std::memory_order_relaxed);
+    if (projected <= budget)
+      return;
+    // Wake on a timeout as well as on checkout release: the footprint can shrink without a compilation
+    // finishing (cache eviction, deferred context reclamation).
+    m_memoryBudgetCondition.wait_for(lock, std::chrono::milliseconds(10));
+  }
+}
+
+// =====================================================================================================================
+// Acquires a free context, preferring this thread's cached context, then the lock-free overflow list, and
+// creating a new one only if neither holds a matching context. Never frees memory inline; contexts past their
+// reuse limit are handed to the reclamation thread.
 Context *Compiler::acquireContext() const {
-  Context *freeContext = nullptr;
+  CompileTraceSpan traceSpan("acquireContext");
 
-  std::lock_guard<sys::Mutex> lock(m_contextPoolMutex);
+  waitForMemoryBudget();
 
-  // Try to find a free context from pool first
-  for (auto &context : *m_contextPool) {
-    GfxIpVersion gfxIpVersion = context->getGfxIpVersion();
+  Context *freeContext = nullptr;
 
-    if (!context->isInUse() && gfxIpVersion.major == m_gfxIp.major && gfxIpVersion.minor == m_gfxIp.minor &&
+  // Fast path: this thread's cached context. No other thread touches the cache, so no synchronization.
+  Context *cached = m_threadFreeContext;
+  if (cached) {
+    GfxIpVersion gfxIpVersion = cached->getGfxIpVersion();
+    if (gfxIpVersion.major == m_gfxIp.major && gfxIpVersion.minor == m_gfxIp.minor &&
         gfxIpVersion.stepping == m_gfxIp.stepping) {
-      // Free up context if it is being used too many times to avoid consuming too much memory.
-      int contextReuseLimit = cl::ContextReuseLimit.getValue();
-      if (contextReuseLimit > 0 && context->getUseCount() > contextReuseLimit) {
-        delete context;
-        context = new Context(m_gfxIp);
+      m_threadFreeContext = nullptr;
+      freeContext = cached;
+    }
+  }
+
+  if (!freeContext) {
+    // Detach the whole overflow list in one exchange (avoiding the ABA hazard of a node-at-a-time pop), take
+    // the first matching context, and push the remainder back. Contexts for other graphics IPs (from other
+    // compiler instances) simply stay on the list.
+    FreeContextNode *list = m_freeContextOverflow.exchange(nullptr, std::memory_order_acquire);
+    FreeContextNode **where = &list;
+    while (*where) {
+      FreeContextNode *node = *where;
+      GfxIpVersion gfxIpVersion = node->context->getGfxIpVersion();
+      if (gfxIpVersion.major == m_gfxIp.major && gfxIpVersion.minor == m_gfxIp.minor &&
+          gfxIpVersion.stepping == m_gfxIp.stepping) {
+        freeContext = node->context;
+        *where = node->next;
+        delete node;
+        break;
       }
-      freeContext = context;
-      break;
+      where = &node->next;
+    }
+
+    if (list) {
+      // Push the remaining sublist back onto the overflow list.
+      FreeContextNode *tail = list;
+      while (tail->next)
+        tail = tail->next;
+      FreeContextNode *head = m_freeContextOverflow.load(std::memory_order_relaxed);
+      do
+        tail->next = head;
+      while (!m_freeContextOverflow.compare_exchange_weak(head, list, std::memory_order_release,
+                                                          std::memory_order_relaxed));
+    }
+  }
+
+  if (freeContext) {
+    // Free up context if it is being used too many times to avoid consuming too much memory. The worn-out
+    // context is destroyed on the reclamation thread, off this compile's critical path, which also builds its
+    // replacement there: the replacement adopts the worn context's target machine and is parked on the free
+    // list ready for a later acquire.
+    int contextReuseLimit = cl::ContextReuseLimit.getValue();
+    if (contextReuseLimit > 0 && freeContext->getUseCount() > contextReuseLimit) {
+      reclaimContext(freeContext, /*recycle=*/true);
+      freeContext = nullptr;
     }
   }
 
   if (!freeContext) {
     // Create a new one if we fail to find an available one
     freeContext = new Context(m_gfxIp);
-    m_contextPool->push_back(freeContext);
   }
 
   assert(freeContext);
   freeContext->setInUse(true);
 
+  m_activeCompiles.fetch_add(1, std::memory_order_relaxed);
+  if (m_memoryBudget.load(std::memory_order_relaxed) != 0)
+    m_mallocUsageAtAcquire = sys::Process::GetMallocUsage();
+
   return freeContext;
 }
 
@@ -1722,13 +3251,119 @@ bool Compiler::runPasses(lgc::PassManager *passMgr, Module *module) const {
 }
 
 // =====================================================================================================================
-// Releases LLPC context.
+// Releases LLPC context. The context is parked in this thread's cache if it is empty, otherwise it is handed
+// off to the lock-free overflow list.
 //
 // @param context : LLPC context
 void Compiler::releaseContext(Context *context) const {
-  std::lock_guard<sys::Mutex> lock(m_contextPoolMutex);
   context->reset();
   context->setInUse(false);
+
+  if (m_memoryBudget.load(std::memory_order_relaxed) != 0 && m_mallocUsageAtAcquire != 0) {
+    // Learn the allocation growth of one compilation, used to project whether another concurrent one fits in
+    // the budget. Growth caused by concurrent compilations is attributed to this one too, making the estimate
+    // an upper bound.
+    uint64_t usageNow = sys::Process::GetMallocUsage();
+    if (usageNow > m_mallocUsageAtAcquire) {
+      uint64_t growth = usageNow - m_mallocUsageAtAcquire;
+      uint64_t footprint = m_perCompileFootprint.load(std::memory_order_relaxed);
+      while (growth > footprint &&
+             !m_perCompileFootprint.compare_exchange_weak(footprint, growth, std::memory_order_relaxed))
+        ;
+    }
+    m_mallocUsageAtAcquire = 0;
+  }
+  m_activeCompiles.fetch_sub(1, std::memory_order_relaxed);
+  m_memoryBudgetCondition.notify_all();
+
+  if (!m_threadFreeContext) {
+    m_threadFreeContext = context;
+    return;
+  }
+  pushFreeContext(context);
+}
+
+// =====================================================================================================================
+// Pushes a free context onto the global lock-free overflow list.
+//
+// @param context : Free LLPC context
+void Compiler::pushFreeContext(Context *context) {
+  FreeContextNode *node = new FreeContextNode;
+  node->context = context;
+  FreeContextNode *head = m_freeContextOverflow.load(std::memory_order_relaxed);
+  do
+    node->next = head;
+  while (!m_freeContextOverflow.compare_exchange_weak(head, node, std::memory_order_release,
+                                                      std::memory_order_relaxed));
+}
+
+// =====================================================================================================================
+// Hands a context to the deferred reclamation thread for destruction, starting the thread on first use.
+// Destroying an LLVMContext is expensive, so it is never done inline on a compile's critical path.
+//
+// @param context : Context to destroy
+// @param recycle : Build a replacement context off the critical path, adopting the worn context's target
+//                  machine, and park it on the free list
+void Compiler::reclaimContext(Context *context, bool recycle) {
+  {
+    std::lock_guard<std::mutex> lock(m_reclaimMutex);
+    if (!m_reclaimThread.joinable()) {
+      m_reclaimExit = false;
+      m_reclaimThread = std::thread([] { reclaimLoop(); });
+    }
+    m_reclaimQueue.push_back({context, recycle});
+  }
+  m_reclaimCondition.notify_one();
+}
+
+// =====================================================================================================================
+// Main loop of the deferred context reclamation thread: destroys queued contexts until asked to exit with an
+// empty queue. A context queued for recycling additionally gets its replacement built here, adopting the worn
+// context's target machine, so acquireContext finds a ready context on the free list instead of creating one
+// inline on a compile thread.
+void Compiler::reclaimLoop() {
+  std::unique_lock<std::mutex> lock(m_reclaimMutex);
+  for (;;) {
+    m_reclaimCondition.wait(lock, [] { return m_reclaimExit || !m_reclaimQueue.empty(); });
+    if (m_reclaimQueue.empty()) {
+      if (m_reclaimExit)
+        return;
+      continue;
+    }
+    std::vector<std::pair<Context *, bool>> deadContexts;
+    deadContexts.swap(m_reclaimQueue);
+    const bool exiting = m_reclaimExit;
+    lock.unlock();
+    for (auto &deadContext : deadContexts) {
+      Context *context = deadContext.first;
+      if (deadContext.second && !exiting) {
+        GfxIpVersion gfxIp = context->getGfxIpVersion();
+        std::unique_ptr<TargetMachine> targetMachine = context->takeTargetMachine();
+        delete context;
+        Context *replacement = new Context(gfxIp, std::move(targetMachine));
+        // Finish the expensive part of creation here rather than lazily on a compile thread.
+        replacement->getLgcContext();
+        pushFreeContext(replacement);
+      } else
+        delete context;
+    }
+    lock.lock();
+  }
+}
+
+// =====================================================================================================================
+// Asks the reclamation thread to drain its queue and exit, and joins it. Called when the last compiler
+// instance is destroyed.
+void Compiler::stopReclaimThread() {
+  std::thread worker;
+  {
+    std::lock_guard<std::mutex> lock(m_reclaimMutex);
+    m_reclaimExit = true;
+    worker.swap(m_reclaimThread);
+  }
+  m_reclaimCondition.notify_all();
+  if (worker.joinable())
+    worker.join();
 }
 
 // =====================================================================================================================
@@ -1737,7 +3372,9 @@ void Compiler::releaseContext(Context *context) const {
 // Then try on the internal shader cache next if it misses.
 //
 // Upon hit, Ready is returned and pElfBin is filled in. Upon miss, Compiling is returned and ppShaderCache and
-// phEntry are filled in.
+// phEntry are filled in. When a cache remembers a recent failed compile of the shader, Failed is returned with
+// ppShaderCache and phEntry referring to the failed entry, and the caller should report the entry's recorded
+// result instead of compiling.
 //
 // @param appPipelineCache : App's pipeline cache
 // @param cacheHash : Hash code of the shader
@@ -1771,6 +3408,10 @@ ShaderEntryState Compiler::lookUpShaderCaches(IShaderCache *appPipelineCache, Me
       *ppShaderCache = shaderCache[i];
       *phEntry = hCurrentEntry;
       return ShaderEntryState::Compiling;
+    } else if (cacheEntryState == ShaderEntryState::Failed) {
+      *ppShaderCache = shaderCache[i];
+      *phEntry = hCurrentEntry;
+      return ShaderEntryState::Failed;
     }
   }
 
@@ -1782,13 +3423,15 @@ ShaderEntryState Compiler::lookUpShaderCaches(IShaderCache *appPipelineCache, Me
 }
 
 // =====================================================================================================================
-// Update the shader caches with the given entry handle, based on the "insert" flag.
+// Update the shader caches with the given entry handle, based on the compile result. A successful compile inserts
+// the shader data; a deterministic failure is recorded on the entry so that recreating the same pipeline fails
+// fast instead of re-paying the compile; any other failure just releases the claim so another thread can retry.
 //
-// @param insert : To insert data or reset the shader cache
+// @param result : Result of the compile whose outcome populates the entry
 // @param elfBin : Pointer to shader data
 // @param shaderCache : Shader cache to update (may be nullptr for default)
 // @param hEntry : Handle to update
-void Compiler::updateShaderCache(bool insert, const BinaryData *elfBin, ShaderCache *shaderCache,
+void Compiler::updateShaderCache(Result result, const BinaryData *elfBin, ShaderCache *shaderCache,
                                  CacheEntryHandle hEntry) {
   if (!hEntry)
     return;
@@ -1796,10 +3439,12 @@ void Compiler::updateShaderCache(bool insert, const BinaryData *elfBin, ShaderCa
   if (!shaderCache)
     shaderCache = m_shaderCache.get();
 
-  if (insert) {
+  if (result == Result::Success) {
     assert(elfBin->codeSize > 0);
     shaderCache->insertShader(hEntry, elfBin->pCode, elfBin->codeSize);
-  } else
+  } else if (ShaderCache::isCacheableFailure(result))
+    shaderCache->markShaderFailed(hEntry, result);
+  else
     shaderCache->resetShader(hEntry);
 }
 
@@ -1807,12 +3452,14 @@ void Compiler::updateShaderCache(bool insert, const BinaryData *elfBin, ShaderCa
 // Builds hash code from input context for per shader stage cache
 //
 // @param context : Acquired context
+// @param pipelineState : Snapshot of the derived pipeline state, including per-stage shader info
 // @param stageMask : Shader stage mask
 // @param stageHashes : Per-stage hash of in/out usage
 // @param [out] fragmentHash : Hash code of fragment shader
 // @param [out] nonFragmentHash : Hash code of all non-fragment shader
-void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayRef<ArrayRef<uint8_t>> stageHashes,
-                                    MetroHash::Hash *fragmentHash, MetroHash::Hash *nonFragmentHash) {
+void Compiler::buildShaderCacheHash(Context *context, const PipelineStateSnapshot &pipelineState, unsigned stageMask,
+                                    ArrayRef<ArrayRef<uint8_t>> stageHashes, MetroHash::Hash *fragmentHash,
+                                    MetroHash::Hash *nonFragmentHash) {
   MetroHash64 fragmentHasher;
   MetroHash64 nonFragmentHasher;
   auto pipelineInfo = reinterpret_cast<const GraphicsPipelineBuildInfo *>(context->getPipelineBuildInfo());
@@ -1823,7 +3470,7 @@ void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayR
     if ((stageMask & shaderStageToMask(stage)) == 0)
       continue;
 
-    auto shaderInfo = context->getPipelineShaderInfo(stage);
+    auto shaderInfo = pipelineState.shaderInfo[stage];
     MetroHash64 hasher;
 
     // Update common shader info
@@ -1869,6 +3516,39 @@ void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayR
   }
 }
 
+// =====================================================================================================================
+// Satisfies the glue shaders of the given ELF linker from the internal shader cache. The space of glue shaders
+// for a given title is tiny (a few dozen vertex layouts and export layouts), so a previously seen glue shader
+// is added from the cache for the cost of a hash lookup, and newly compiled ones are inserted for future
+// links. The cache key is the glue shader's identifying string from ElfLinker::getGlueInfo, and the blobs are
+// persisted alongside everything else in the shader cache.
+//
+// @param elfLinker : ELF linker whose glue shaders are resolved
+void Compiler::resolveGlueShaders(ElfLinker *elfLinker) {
+  ArrayRef<StringRef> glueInfo = elfLinker->getGlueInfo();
+  for (unsigned glueIndex = 0; glueIndex != glueInfo.size(); ++glueIndex) {
+    MetroHash::Hash glueHash = {};
+    MetroHash64::Hash(reinterpret_cast<const uint8_t *>(glueInfo[glueIndex].data()), glueInfo[glueIndex].size(),
+                      glueHash.bytes);
+
+    CacheEntryHandle hEntry = nullptr;
+    ShaderEntryState entryState = m_shaderCache->findShader(glueHash, true, &hEntry);
+    if (entryState == ShaderEntryState::Ready) {
+      const void *blob = nullptr;
+      size_t size = 0;
+      if (m_shaderCache->retrieveShader(hEntry, &blob, &size) == Result::Success)
+        elfLinker->addGlue(glueIndex, StringRef(static_cast<const char *>(blob), size));
+      // On a failed retrieve (e.g. the entry was evicted) the linker just compiles the glue internally.
+    } else if (entryState == ShaderEntryState::Compiling) {
+      StringRef blob = elfLinker->compileGlue(glueIndex);
+      if (!blob.empty())
+        m_shaderCache->insertShader(hEntry, blob.data(), blob.size());
+      else
+        m_shaderCache->resetShader(hEntry);
+    }
+  }
+}
+
 // =====================================================================================================================
 // Link relocatable shader elf file into a pipeline elf file and apply relocations.
 //
@@ -1877,6 +3557,8 @@ void Compiler::buildShaderCacheHash(Context *context, unsigned stageMask, ArrayR
 // @param [out] pipelineElf : Elf package containing the pipeline elf
 // @param context : Acquired context
 void Compiler::linkRelocatableShaderElf(ElfPackage *shaderElfs, ElfPackage *pipelineElf, Context *context) {
+  CompileTraceSpan traceSpan("linkElf", context->getPipelineContext()->getPiplineHashCode());
+
   assert(shaderElfs[ShaderStageTessControl].empty() && "Cannot link tessellation shaders yet.");
   assert(shaderElfs[ShaderStageTessEval].empty() && "Cannot link tessellation shaders yet.");
   assert(shaderElfs[ShaderStageGeometry].empty() && "Cannot link geometry shaders yet.");
@@ -1895,6 +3577,9 @@ void Compiler::linkRelocatableShaderElf(ElfPackage *shaderElfs, ElfPackage *pipe
   }
   std::unique_ptr<ElfLinker> elfLinker(pipeline->createElfLinker(elfs));
 
+  // Satisfy glue shaders from the shader cache where possible.
+  resolveGlueShaders(&*elfLinker);
+
   // Do the link.
   raw_svector_ostream outStream(*pipelineElf);
   if (!elfLinker->link(outStream)) {
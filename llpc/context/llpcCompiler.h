@@ -36,6 +36,12 @@
 #include "vkgcElfReader.h"
 #include "vkgcMetroHash.h"
 #include "lgc/CommonDefs.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
 
 namespace llvm {
 
@@ -45,6 +51,7 @@ class Module;
 
 namespace lgc {
 
+class ElfLinker;
 class PassManager;
 
 } // namespace lgc
@@ -59,12 +66,14 @@ class Compiler;
 class ComputeContext;
 class Context;
 class GraphicsContext;
+struct PipelineStateSnapshot;
 
 // =====================================================================================================================
 // Object to manage checking and updating shader cache for graphics pipeline.
 class GraphicsShaderCacheChecker {
 public:
-  GraphicsShaderCacheChecker(Compiler *compiler, Context *context) : m_compiler(compiler), m_context(context) {}
+  GraphicsShaderCacheChecker(Compiler *compiler, Context *context, const PipelineStateSnapshot &pipelineState)
+      : m_compiler(compiler), m_context(context), m_pipelineState(&pipelineState) {}
 
   // Check shader caches, returning mask of which shader stages we want to keep in this compile.
   unsigned check(const llvm::Module *module, unsigned stageMask, llvm::ArrayRef<llvm::ArrayRef<uint8_t>> stageHashes);
@@ -80,6 +89,7 @@ public:
 private:
   Compiler *m_compiler;
   Context *m_context;
+  const PipelineStateSnapshot *m_pipelineState; // Snapshot of the derived pipeline state being compiled
 
   ShaderEntryState m_nonFragmentCacheEntryState = ShaderEntryState::New;
   ShaderCache *m_nonFragmentShaderCache = nullptr;
@@ -90,6 +100,9 @@ private:
   ShaderCache *m_fragmentShaderCache = nullptr;
   CacheEntryHandle m_hFragmentEntry = {};
   BinaryData m_fragmentElf = {};
+
+  bool m_fragmentIsNullFs = false;     // Whether the fragment stage is the synthesized null fragment shader
+  MetroHash::Hash m_fragmentHash = {}; // Fragment half-pipeline hash, kept for the in-context null FS ELF cache
 };
 
 // =====================================================================================================================
@@ -111,6 +124,46 @@ public:
 
   virtual Result BuildComputePipeline(const ComputePipelineBuildInfo *pipelineInfo,
                                       ComputePipelineBuildOut *pipelineOut, void *pipelineDumpFile = nullptr);
+
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  virtual Result BuildGraphicsPipelineAsync(const GraphicsPipelineBuildInfo *pipelineInfo,
+                                            GraphicsPipelineBuildOut *pipelineOut, PipelineBuildHandle *phBuild,
+                                            PipelineBuildPriority priority = PipelineBuildPriority::Normal);
+
+  virtual Result BuildComputePipelineAsync(const ComputePipelineBuildInfo *pipelineInfo,
+                                           ComputePipelineBuildOut *pipelineOut, PipelineBuildHandle *phBuild,
+                                           PipelineBuildPriority priority = PipelineBuildPriority::Normal);
+
+  virtual Result WaitForPipelineBuild(PipelineBuildHandle hBuild);
+
+  virtual Result CancelPipelineBuild(PipelineBuildHandle hBuild);
+
+  virtual void SetCompileTimeBudget(uint64_t budgetUs, CompileTimeExceededCallback pfnCallback, void *pUserData);
+
+  virtual Result SpeculateGraphicsPipelineVariants(const GraphicsPipelineBuildInfo *pipelineInfo,
+                                                   const GraphicsPipelineStateDelta *deltas, unsigned deltaCount);
+
+  virtual void SetMemoryBudget(uint64_t budgetBytes);
+
+  virtual void SetRemoteCompileHandler(PipelineCompileRemoteFunc pfnRemoteCompile, const void *pClientData);
+
+  virtual Result LoadProfileFeedback(const char *pFilePath);
+
+  virtual Result BuildShaderModules(unsigned shaderModuleCount, const ShaderModuleBuildInfo *shaderInfos,
+                                    ShaderModuleBuildOut *shaderOuts, Result *results) const;
+
+  virtual void GetGraphicsPipelineCacheKeys(const GraphicsPipelineBuildInfo *pipelineInfo, uint64_t *pipelineHash,
+                                            ShaderHash *cacheHash) const;
+
+  virtual void GetComputePipelineCacheKeys(const ComputePipelineBuildInfo *pipelineInfo, uint64_t *pipelineHash,
+                                           ShaderHash *cacheHash) const;
+
+  Result tryRemoteCompile(Vkgc::PipelineBuildInfo buildInfo, const MetroHash::Hash *pipelineHash,
+                          ElfPackage *pipelineElf);
+
+  bool getProfileFeedback(uint64_t pipelineHash, PipelineProfileMetrics *metrics);
+#endif
+
   Result buildGraphicsPipelineInternal(GraphicsContext *graphicsContext,
                                        llvm::ArrayRef<const PipelineShaderInfo *> shaderInfo,
                                        unsigned forceLoopUnrollCount, bool buildingRelocatableElf,
@@ -120,11 +173,21 @@ public:
                                       unsigned forceLoopUnrollCount, bool buildingRelocatableElf,
                                       ElfPackage *pipelineElf);
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  Result buildComputePipelineWaveTuned(const ComputePipelineBuildInfo *pipelineInfo, MetroHash::Hash *pipelineHash,
+                                       MetroHash::Hash *cacheHash, unsigned forceLoopUnrollCount,
+                                       ElfPackage *pipelineElf);
+
+  Result retryIfSpilled(Result result, Context *context, llvm::ArrayRef<const PipelineShaderInfo *> shaderInfo,
+                        unsigned forceLoopUnrollCount, ElfPackage *pipelineElf);
+#endif
+
   Result buildPipelineWithRelocatableElf(Context *context, llvm::ArrayRef<const PipelineShaderInfo *> shaderInfo,
                                          unsigned forceLoopUnrollCount, ElfPackage *pipelineElf);
 
   Result buildPipelineInternal(Context *context, llvm::ArrayRef<const PipelineShaderInfo *> shaderInfo,
-                               unsigned forceLoopUnrollCount, bool unlinked, ElfPackage *pipelineElf);
+                               unsigned forceLoopUnrollCount, bool unlinked, ElfPackage *pipelineElf,
+                               bool usePerStageCache = true);
 
   // Gets the count of compiler instance.
   static unsigned getInstanceCount() { return m_instanceCount; }
@@ -141,9 +204,9 @@ public:
   ShaderEntryState lookUpShaderCaches(IShaderCache *appPipelineCache, MetroHash::Hash *cacheHash, BinaryData *elfBin,
                                       ShaderCache **ppShaderCache, CacheEntryHandle *phEntry);
 
-  void updateShaderCache(bool insert, const BinaryData *elfBin, ShaderCache *shaderCache, CacheEntryHandle phEntry);
+  void updateShaderCache(Result result, const BinaryData *elfBin, ShaderCache *shaderCache, CacheEntryHandle phEntry);
 
-  static void buildShaderCacheHash(Context *context, unsigned stageMask,
+  static void buildShaderCacheHash(Context *context, const PipelineStateSnapshot &pipelineState, unsigned stageMask,
                                    llvm::ArrayRef<llvm::ArrayRef<uint8_t>> stageHashes, MetroHash::Hash *fragmentHash,
                                    MetroHash::Hash *nonFragmentHash);
 
@@ -152,25 +215,117 @@ private:
   Compiler(const Compiler &) = delete;
   Compiler &operator=(const Compiler &) = delete;
 
+  // An asynchronous pipeline build enqueued on the compiler's internal scheduler. Exactly one of graphicsInfo
+  // and computeInfo is non-null. The job is owned by the handle returned to the client and freed by
+  // WaitForPipelineBuild.
+  struct AsyncBuildJob {
+    const GraphicsPipelineBuildInfo *graphicsInfo; // Graphics build info (null for compute builds)
+    GraphicsPipelineBuildOut *graphicsOut;         // Graphics build output
+    const ComputePipelineBuildInfo *computeInfo;   // Compute build info (null for graphics builds)
+    ComputePipelineBuildOut *computeOut;           // Compute build output
+    Result result;                                 // Result of the build, valid once done is set
+    bool done;                                     // Whether the build has completed
+    bool speculative;                              // Whether this is a fire-and-forget speculative variant
+                                                   //  build; the worker frees the job and nobody waits on it
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+    PipelineBuildPriority priority;                // Priority class; orders the job in the build queue
+#endif
+    std::atomic<bool> canceled;                    // Raised by CancelPipelineBuild; a running build checks it
+                                                   //  between compilation phases and stops cooperatively
+    GraphicsPipelineBuildInfo speculativeInfo;     // Owned copy of the variant build info for speculative
+                                                   //  builds; graphicsInfo points at it
+  };
+
+  void buildSpeculativeVariant(const GraphicsPipelineBuildInfo *pipelineInfo);
+
+  void traceBuildRequest(Vkgc::PipelineBuildInfo pipelineInfo);
+
+  void enqueueAsyncBuild(AsyncBuildJob *job);
+  void stopAsyncWorkers();
+  void asyncWorkerLoop();
+
   Result validatePipelineShaderInfo(const PipelineShaderInfo *shaderInfo) const;
 
+  // Node in the global lock-free overflow list of free contexts.
+  struct FreeContextNode {
+    Context *context;      // Free context carried by this node
+    FreeContextNode *next; // Next free context in the list
+  };
+
   Context *acquireContext() const;
   void releaseContext(Context *context) const;
 
+  static void waitForMemoryBudget();
+  static void pushFreeContext(Context *context);
+  static void reclaimContext(Context *context, bool recycle = false);
+  static void reclaimLoop();
+  static void stopReclaimThread();
+
   bool runPasses(lgc::PassManager *passMgr, llvm::Module *module) const;
+  void resolveGlueShaders(lgc::ElfLinker *elfLinker);
   void linkRelocatableShaderElf(ElfPackage *shaderElfs, ElfPackage *pipelineElf, Context *context);
   bool canUseRelocatableGraphicsShaderElf(const llvm::ArrayRef<const PipelineShaderInfo *> &shaderInfo);
   bool canUseRelocatableComputeShaderElf(const PipelineShaderInfo *shaderInfo);
+  bool isEligibleForRelocatableGraphicsShaderElf(const llvm::ArrayRef<const PipelineShaderInfo *> &shaderInfo) const;
+  bool isEligibleForRelocatableComputeShaderElf(const PipelineShaderInfo *shaderInfo) const;
 
   std::vector<std::string> m_options;           // Compilation options
   MetroHash::Hash m_optionHash;                 // Hash code of compilation options
   GfxIpVersion m_gfxIp;                         // Graphics IP version info
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  uint64_t m_compileTimeBudgetUs = 0; // Compile-time budget per pipeline in microseconds, or 0 if disabled
+  CompileTimeExceededCallback m_compileTimeExceededCallback = nullptr; // Callback fired on over-budget compiles
+  void *m_compileTimeExceededUserData = nullptr;                       // Client data for the callback
+  PipelineCompileRemoteFunc m_remoteCompileFunc = nullptr; // Remote compile handler, or null to compile locally
+  const void *m_remoteCompileClientData = nullptr;         // Client data for the remote compile handler
+#endif
   static unsigned m_instanceCount;              // The count of compiler instance
   static unsigned m_outRedirectCount;           // The count of output redirect
-  ShaderCachePtr m_shaderCache;                 // Shader cache
-  static llvm::sys::Mutex m_contextPoolMutex;   // Mutex for context pool access
-  static std::vector<Context *> *m_contextPool; // Context pool
-  unsigned m_relocatablePipelineCompilations;   // The number of pipelines compiled using relocatable shader elf
+  ShaderCachePtr m_shaderCache;               // Shader cache
+  unsigned m_relocatablePipelineCompilations; // The number of pipelines compiled using relocatable shader elf
+
+  // Free contexts are kept in two tiers: a per-thread cache of one context, touched without any
+  // synchronization, and a global lock-free overflow list for contexts released on a thread whose cache is
+  // already occupied. Contexts that must die (reuse limit, pool trimming) are destroyed on a deferred
+  // reclamation thread so that the acquire/release paths never free memory inline.
+  // Soft memory budget shared by all compiler instances. acquireContext blocks while other compilations are
+  // in flight and the process allocation footprint, plus the growth one compilation has been observed to add,
+  // would exceed the budget. The per-compilation growth is learned from completed checkouts; attribution is an
+  // upper bound under concurrency, which errs toward throttling.
+  static std::atomic<uint64_t> m_memoryBudget;            // Soft cap on the allocation footprint, 0 = disabled
+  static std::atomic<unsigned> m_activeCompiles;          // Number of contexts currently checked out
+  static std::atomic<uint64_t> m_perCompileFootprint;     // Largest allocation growth seen over one checkout
+  static std::mutex m_memoryBudgetMutex;                  // Lock for waiting on the budget
+  static std::condition_variable m_memoryBudgetCondition; // Signals waiters when a checkout is released
+  static thread_local uint64_t m_mallocUsageAtAcquire;    // Allocation footprint when this thread checked out
+                                                          //  its context
+
+  static thread_local Context *m_threadFreeContext;            // Per-thread cache of one free context
+  static std::atomic<FreeContextNode *> m_freeContextOverflow; // Lock-free overflow list of free contexts
+  static std::mutex m_reclaimMutex;                            // Lock for the deferred reclamation state
+  static std::condition_variable m_reclaimCondition;           // Signals the reclamation thread
+  static std::vector<std::pair<Context *, bool>> m_reclaimQueue; // Contexts pending destruction; the flag asks
+                                                                 //  for the context to be recycled, i.e. its
+                                                                 //  replacement built off the critical path
+  static std::thread m_reclaimThread;                          // Deferred context reclamation thread
+  static bool m_reclaimExit;                                   // Asks the reclamation thread to exit
+
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  std::mutex m_tunedWaveSizesMutex;            // Lock for the wave size auto-tuning decisions
+  std::map<uint64_t, unsigned> m_tunedWaveSizes; // Winning wave size per compute shader module hash, recorded by
+                                                 //  -auto-tune-wave-size so the shader is tuned only once
+
+  std::mutex m_profileFeedbackMutex;                          // Lock for the profile feedback map
+  std::map<uint64_t, PipelineProfileMetrics> m_profileFeedback; // GPU profile metrics per pipeline hash, loaded
+                                                                //  by LoadProfileFeedback
+#endif
+
+  std::vector<std::thread> m_asyncWorkers;         // Worker threads of the asynchronous build scheduler
+  std::mutex m_asyncMutex;                         // Lock for the asynchronous build queue and job states
+  std::condition_variable m_asyncWorkCondition;    // Signals the workers that work or exit is pending
+  std::condition_variable m_asyncDoneCondition;    // Signals waiters that some build has completed
+  std::deque<AsyncBuildJob *> m_asyncJobQueue;     // Builds waiting to be picked up by a worker
+  bool m_asyncExit;                                // Asks the workers to drain the queue and exit
 };
 
 // Convert front-end LLPC shader stage to middle-end LGC shader stage
@@ -29,7 +29,10 @@
  ***********************************************************************************************************************
  */
 #include "llpcContext.h"
+#include "LLVMSPIRVLib.h"
 #include "SPIRVInternal.h"
+#include "SPIRVModule.h"
+#include "SPIRVStream.h"
 #include "llpcCompiler.h"
 #include "llpcDebug.h"
 #include "llpcPipelineContext.h"
@@ -61,7 +64,10 @@ namespace Llpc {
 // =====================================================================================================================
 //
 // @param gfxIp : Graphics IP version info
-Context::Context(GfxIpVersion gfxIp) : LLVMContext(), m_gfxIp(gfxIp), m_glslEmuLib(this) {
+// @param targetMachine : Target machine taken from a recycled context for the same graphics IP, or null
+Context::Context(GfxIpVersion gfxIp, std::unique_ptr<TargetMachine> targetMachine)
+    : LLVMContext(), m_gfxIp(gfxIp), m_glslEmuLib(this) {
+  m_targetMachine = std::move(targetMachine);
   reset();
 }
 
@@ -74,16 +80,22 @@ void Context::reset() {
   m_pipelineContext = nullptr;
   delete m_builder;
   m_builder = nullptr;
+  m_parsedSpirvModules.clear();
 }
 
 // =====================================================================================================================
 // Get (create if necessary) LgcContext
 LgcContext *Context::getLgcContext() {
   if (!m_builderContext) {
-    // First time: Create the LgcContext.
+    // First time: Create the LgcContext, handing it the target machine adopted from a recycled context if we
+    // have one so it does not have to create its own.
     std::string gpuName;
     PipelineContext::getGpuNameString(m_gfxIp, gpuName);
-    m_builderContext.reset(LgcContext::Create(*this, gpuName, PAL_CLIENT_INTERFACE_MAJOR_VERSION));
+    if (m_targetMachine) {
+      m_builderContext.reset(
+          LgcContext::Create(*this, gpuName, PAL_CLIENT_INTERFACE_MAJOR_VERSION, std::move(m_targetMachine)));
+    } else
+      m_builderContext.reset(LgcContext::Create(*this, gpuName, PAL_CLIENT_INTERFACE_MAJOR_VERSION));
     if (!m_builderContext)
       report_fatal_error(Twine("Unknown target '") + Twine(gpuName) + Twine("'"));
   }
@@ -115,6 +127,60 @@ std::unique_ptr<Module> Context::loadLibary(const BinaryData *lib) {
   return libModule;
 }
 
+// Maximum number of translated shader modules retained per context. The uniqued types and constants of retained
+// modules live in this LLVMContext, so an unbounded cache would grow the context for its whole lifetime.
+static const unsigned MaxTranslatedModules = 16;
+
+// =====================================================================================================================
+// Looks up a retained translated shader module for the given key, returning a clone of it or null on miss.
+//
+// @param key : Key identifying the translation result, as computed by the compiler
+std::unique_ptr<Module> Context::lookUpTranslatedModule(uint64_t key) {
+  auto it = m_translatedModules.find(key);
+  if (it == m_translatedModules.end())
+    return nullptr;
+  return CloneModule(*it->second);
+}
+
+// =====================================================================================================================
+// Retains a clone of the given just-translated shader module under the given key, for later builds in this
+// context to clone instead of re-running the SPIR-V translator.
+//
+// @param key : Key identifying the translation result, as computed by the compiler
+// @param module : Just-translated module to retain a clone of
+void Context::retainTranslatedModule(uint64_t key, Module *module) {
+  // Keep the cache bounded by dropping it wholesale when full; a pipeline family being replayed repopulates
+  // its entries within one build each.
+  if (m_translatedModules.size() >= MaxTranslatedModules)
+    m_translatedModules.clear();
+  m_translatedModules[key] = CloneModule(*module);
+}
+
+// =====================================================================================================================
+// Parses a SPIR-V binary into its in-memory representation, or reuses the representation already parsed from the
+// same binary for another stage of this pipeline build. Stages compiled from one multi-entry-point module then
+// share a single parse. Parse errors surface when the returned module is translated.
+//
+// @param spirvBin : SPIR-V binary to parse; must stay valid for the duration of the pipeline build
+SPIRV::SPIRVModule *Context::getOrParseSpirvModule(const BinaryData &spirvBin) {
+  auto &parsed = m_parsedSpirvModules[{spirvBin.pCode, spirvBin.codeSize}];
+  if (!parsed) {
+    SPIRV::SPIRVMemoryStreamBuf streamBuf(static_cast<const char *>(spirvBin.pCode), spirvBin.codeSize);
+    std::istream stream(&streamBuf);
+    parsed = parseSpirv(stream);
+  }
+  return parsed.get();
+}
+
+// =====================================================================================================================
+// Releases this context's target machine so a replacement context can adopt it. The target machine is
+// independent of the LLVMContext, so it survives this context's destruction.
+std::unique_ptr<TargetMachine> Context::takeTargetMachine() {
+  if (m_builderContext)
+    return m_builderContext->takeTargetMachine();
+  return std::move(m_targetMachine);
+}
+
 // =====================================================================================================================
 // Sets triple and data layout in specified module from the context's target machine.
 //
@@ -38,18 +38,32 @@
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Type.h"
 #include "llvm/Target/TargetMachine.h"
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 
+namespace llvm {
+class Constant;
+class StructType;
+} // namespace llvm
+
+namespace SPIRV {
+class SPIRVModule;
+} // namespace SPIRV
+
 namespace Llpc {
 
 // =====================================================================================================================
 // Represents LLPC context for pipeline compilation. Derived from the base class llvm::LLVMContext.
 class Context : public llvm::LLVMContext {
 public:
-  Context(GfxIpVersion gfxIp);
+  Context(GfxIpVersion gfxIp, std::unique_ptr<llvm::TargetMachine> targetMachine = nullptr);
   ~Context();
 
+  // Releases this context's target machine so a replacement context can adopt it; used when recycling a
+  // worn-out context.
+  std::unique_ptr<llvm::TargetMachine> takeTargetMachine();
+
   void reset();
 
   // Checks whether this context is in use.
@@ -104,6 +118,49 @@ public:
 
   std::unique_ptr<llvm::Module> loadLibary(const BinaryData *lib);
 
+  // Look up a retained translated shader module for the given key, returning a clone of it or null on miss.
+  std::unique_ptr<llvm::Module> lookUpTranslatedModule(uint64_t key);
+
+  // Retain a clone of the given just-translated shader module under the given key.
+  void retainTranslatedModule(uint64_t key, llvm::Module *module);
+
+  // Parse a SPIR-V binary into its in-memory representation, or reuse the representation already parsed from the
+  // same binary for another stage of this pipeline build. Stages compiled from one multi-entry-point module then
+  // share a single parse.
+  SPIRV::SPIRVModule *getOrParseSpirvModule(const BinaryData &spirvBin);
+
+  // Release the parsed SPIR-V representations eagerly, once the front-end no longer needs them. The compiler
+  // calls this when lowering completes, so the decoded entry objects and id maps do not stay resident while the
+  // patch and codegen phases stack their own memory on top; the context reset at the end of the build would
+  // otherwise be the first point they are freed.
+  void releaseParsedSpirvModules() { m_parsedSpirvModules.clear(); }
+
+  // Look up a composite constant already translated from a structurally identical SPIR-V constant in another
+  // module of this context, or null on miss. Constants are uniqued in the LLVMContext, so cached pointers stay
+  // valid for the context's lifetime.
+  llvm::Constant *findDigestedCompositeConstant(uint64_t digest) {
+    auto it = m_compositeConstCache.find(digest);
+    return it != m_compositeConstCache.end() ? it->second : nullptr;
+  }
+
+  // Record a translated composite constant under its structural digest.
+  void addDigestedCompositeConstant(uint64_t digest, llvm::Constant *constant) {
+    m_compositeConstCache[digest] = constant;
+  }
+
+  // Look up an identified struct type already created for a structurally identical SPIR-V struct in another
+  // module of this context, or null on miss. The caller must verify name, element types and packing before
+  // reusing the result, as the digest alone is not a structural proof.
+  llvm::StructType *findDigestedStructType(uint64_t digest) {
+    auto it = m_structTypeCache.find(digest);
+    return it != m_structTypeCache.end() ? it->second : nullptr;
+  }
+
+  // Record a created identified struct type under its structural digest.
+  void addDigestedStructType(uint64_t digest, llvm::StructType *structType) {
+    m_structTypeCache[digest] = structType;
+  }
+
   // Wrappers of interfaces of pipeline context
   bool isGraphics() const { return m_pipelineContext->isGraphics(); }
   const PipelineShaderInfo *getPipelineShaderInfo(ShaderStage shaderStage) const {
@@ -145,11 +202,27 @@ private:
   lgc::Builder *m_builder = nullptr;                     // LLPC builder object
   std::unique_ptr<lgc::LgcContext> m_builderContext; // Builder context
 
-  std::unique_ptr<llvm::TargetMachine> m_targetMachine; // Target machine
+  std::unique_ptr<llvm::TargetMachine> m_targetMachine; // Target machine adopted from a recycled context,
+                                                        //  handed to the LgcContext on first use
   bool m_scalarBlockLayout = false;                     // scalarBlockLayout option from last pipeline compile
   bool m_robustBufferAccess = false;                    // robustBufferAccess option from last pipeline compile
 
   unsigned m_useCount = 0; // Number of times this context is used.
+
+  // Per-context cache of post-translation shader modules, keyed by a hash of the shader module hash, entry point
+  // and specialization values. Subsequent pipeline builds in this context clone a retained module instead of
+  // re-running the SPIR-V translator, which is several times cheaper.
+  std::unordered_map<uint64_t, std::unique_ptr<llvm::Module>> m_translatedModules;
+
+  // Parsed SPIR-V modules of the current pipeline build, keyed by the binary they were parsed from. The binary
+  // pointers are only stable for the duration of one build, so reset() clears this.
+  std::map<std::pair<const void *, size_t>, std::unique_ptr<SPIRV::SPIRVModule>> m_parsedSpirvModules;
+
+  // Structural deduplication caches used by the SPIR-V translator: composite constants and identified struct
+  // types keyed by a digest of their SPIR-V structure, so identical aggregates appearing in several modules
+  // (or several pipelines built in this context) are converted once instead of per module.
+  std::unordered_map<uint64_t, llvm::Constant *> m_compositeConstCache;
+  std::unordered_map<uint64_t, llvm::StructType *> m_structTypeCache;
 };
 
 } // namespace Llpc
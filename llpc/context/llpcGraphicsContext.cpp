@@ -57,6 +57,7 @@ GraphicsContext::GraphicsContext(GfxIpVersion gfxIp, const GraphicsPipelineBuild
   };
 
   for (unsigned stage = 0; stage < ShaderStageGfxCount; ++stage) {
+    m_shaderInfos[stage] = shaderInfo[stage];
     if (shaderInfo[stage]->pModuleData) {
       m_stageMask |= shaderStageToMask(static_cast<ShaderStage>(stage));
       ++m_activeStageCount;
@@ -84,30 +85,7 @@ const PipelineShaderInfo *GraphicsContext::getPipelineShaderInfo(ShaderStage sha
   }
 
   assert(shaderStage < ShaderStageGfxCount);
-
-  const PipelineShaderInfo *shaderInfo = nullptr;
-  switch (shaderStage) {
-  case Llpc::ShaderStageVertex:
-    shaderInfo = &m_pipelineInfo->vs;
-    break;
-  case Llpc::ShaderStageTessControl:
-    shaderInfo = &m_pipelineInfo->tcs;
-    break;
-  case Llpc::ShaderStageTessEval:
-    shaderInfo = &m_pipelineInfo->tes;
-    break;
-  case Llpc::ShaderStageGeometry:
-    shaderInfo = &m_pipelineInfo->gs;
-    break;
-  case Llpc::ShaderStageFragment:
-    shaderInfo = &m_pipelineInfo->fs;
-    break;
-  default:
-    llvm_unreachable("Should never be called!");
-    break;
-  }
-
-  return shaderInfo;
+  return m_shaderInfos[shaderStage];
 }
 
 // =====================================================================================================================
@@ -77,6 +77,8 @@ private:
 
   const GraphicsPipelineBuildInfo *m_pipelineInfo; // Info to build a graphics pipeline
 
+  const PipelineShaderInfo *m_shaderInfos[ShaderStageGfxCount] = {}; // Per-stage shader info within m_pipelineInfo
+
   unsigned m_stageMask;        // Mask of active shader stages bound to this graphics pipeline
   unsigned m_activeStageCount; // Count of active shader stages
 
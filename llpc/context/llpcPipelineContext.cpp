@@ -58,6 +58,11 @@ static cl::opt<bool> IncludeLlvmIr("include-llvm-ir",
                                    cl::desc("Include LLVM IR as a separate section in the ELF binary"),
                                    cl::init(false));
 
+// -fast-compile: use the minimal middle-end optimization set to produce a usable pipeline as quickly as possible
+static cl::opt<bool> FastCompile("fast-compile",
+                                 cl::desc("Use the minimal middle-end optimization set for the fastest compile"),
+                                 cl::init(false));
+
 // -vgpr-limit: maximum VGPR limit for this shader
 static cl::opt<unsigned> VgprLimit("vgpr-limit", cl::desc("Maximum VGPR limit for this shader"), cl::init(0));
 
@@ -86,6 +91,10 @@ static cl::opt<bool> EnableSiScheduler("enable-si-scheduler", cl::desc("Enable t
 // -subgroup-size: sub-group size exposed via Vulkan API.
 static cl::opt<int> SubgroupSize("subgroup-size", cl::desc("Sub-group size exposed via Vulkan API"), cl::init(64));
 
+// A profiled pipeline averaging fewer waves per SIMD than this is considered underoccupied by the profile
+// feedback wave size heuristic.
+static const float LowOccupancyWaves = 8.0f;
+
 // -enable-shadow-desc: enable shadow descriptor table
 static cl::opt<bool> EnableShadowDescriptorTable("enable-shadow-desc", cl::desc("Enable shadow descriptor table"));
 
@@ -186,6 +195,22 @@ ShaderHash PipelineContext::getShaderHashCode(ShaderStage stage) const {
 #endif
 }
 
+// =====================================================================================================================
+// Takes an immutable snapshot of the derived pipeline state
+//
+// The snapshot stays valid for the pipeline build it was taken in: user data node merging rewrites fields of the
+// per-stage PipelineShaderInfo structs in place, but never moves them.
+PipelineStateSnapshot PipelineContext::getPipelineStateSnapshot() const {
+  PipelineStateSnapshot snapshot = {};
+  snapshot.stageMask = getShaderStageMask();
+  snapshot.activeStageCount = getActiveShaderStageCount();
+  for (unsigned stage = 0; stage < ShaderStageCountInternal; ++stage) {
+    if (snapshot.stageMask & shaderStageToMask(static_cast<ShaderStage>(stage)))
+      snapshot.shaderInfo[stage] = getPipelineShaderInfo(static_cast<ShaderStage>(stage));
+  }
+  return snapshot;
+}
+
 // =====================================================================================================================
 // Set pipeline state in Pipeline object for middle-end
 //
@@ -235,6 +260,7 @@ void PipelineContext::setOptionsInPipeline(Pipeline *pipeline) const {
   options.includeDisassembly = (cl::EnablePipelineDump || EnableOuts() || getPipelineOptions()->includeDisassembly);
   options.reconfigWorkgroupLayout = getPipelineOptions()->reconfigWorkgroupLayout;
   options.includeIr = (IncludeLlvmIr || getPipelineOptions()->includeIr);
+  options.fastCompile = FastCompile;
 
   switch (getPipelineOptions()->shadowDescriptorTableUsage) {
   case Vkgc::ShadowDescriptorTableUsage::Auto:
@@ -341,6 +367,18 @@ void PipelineContext::setOptionsInPipeline(Pipeline *pipeline) const {
         shaderOptions.maxThreadGroupsPerComputeUnit = WavesPerEu;
 
       shaderOptions.waveSize = shaderInfo->options.waveSize;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+      // Profile feedback: when the client did not pin a wave size and a previous run of this pipeline was
+      // observed VGPR-limited, or memory-bound while underoccupied, prefer wave32 - the finer per-wave register
+      // allocation fits more waves per SIMD. getShaderWaveSize in the middle-end treats this like a tuning
+      // option. Only meaningful on gfx10+, where both wave sizes exist.
+      if (const PipelineProfileMetrics *metrics = getProfileMetrics()) {
+        if (shaderOptions.waveSize == 0 && m_gfxIp.major >= 10 &&
+            (metrics->limiter == ProfileOccupancyLimiter::Vgprs ||
+             (metrics->memoryBound && metrics->averageWaves < LowOccupancyWaves)))
+          shaderOptions.waveSize = 32;
+      }
+#endif
       shaderOptions.wgpMode = shaderInfo->options.wgpMode;
       if (!shaderInfo->options.allowVaryWaveSize) {
         // allowVaryWaveSize is disabled, so use -subgroup-size (default 64) to override the wave
@@ -373,6 +411,13 @@ void PipelineContext::setOptionsInPipeline(Pipeline *pipeline) const {
       shaderOptions.updateDescInElf = shaderInfo->options.updateDescInElf;
       shaderOptions.unrollThreshold = shaderInfo->options.unrollThreshold;
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+      // Out-of-range values fall back to full precision rather than asserting on client input.
+      if (shaderInfo->options.transcendentalPrecision <= static_cast<unsigned>(TranscendentalPrecision::Fast))
+        shaderOptions.transcendentalPrecision =
+            static_cast<TranscendentalPrecision>(shaderInfo->options.transcendentalPrecision);
+#endif
+
       pipeline->setShaderOptions(getLgcShaderStage(static_cast<ShaderStage>(stage)), shaderOptions);
     }
   }
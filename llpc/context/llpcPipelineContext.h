@@ -89,6 +89,15 @@ struct ShaderFpMode {
   unsigned roundingModeRTZ : 4;          // Bitmask of roundingModeRTZ flags
 };
 
+// =====================================================================================================================
+// Immutable snapshot of the derived pipeline state. Hot code that would otherwise re-derive these values through
+// virtual PipelineContext queries on every call takes one snapshot up front and reads plain fields instead.
+struct PipelineStateSnapshot {
+  unsigned stageMask;                                             // Mask of active shader stages
+  unsigned activeStageCount;                                      // Count of active shader stages
+  const PipelineShaderInfo *shaderInfo[ShaderStageCountInternal]; // Per-stage shader info (null for inactive stages)
+};
+
 // =====================================================================================================================
 // Represents pipeline-specific context for pipeline compilation, it is a part of LLPC context
 class PipelineContext {
@@ -114,6 +123,9 @@ public:
   // Gets the count of active shader stages
   virtual unsigned getActiveShaderStageCount() const = 0;
 
+  // Takes an immutable snapshot of the derived pipeline state
+  PipelineStateSnapshot getPipelineStateSnapshot() const;
+
   // Does user data node merge for merged shader
   virtual void doUserDataNodeMerge() = 0;
 
@@ -127,6 +139,10 @@ public:
   uint64_t getPiplineHashCode() const { return MetroHash::compact64(&m_pipelineHash); }
   uint64_t getCacheHashCode() const { return MetroHash::compact64(&m_cacheHash); }
 
+  // Gets the raw 128-bit pipeline and cache hashes
+  MetroHash::Hash getPipelineHash() const { return m_pipelineHash; }
+  MetroHash::Hash get128BitCacheHash() const { return m_cacheHash; }
+
   virtual ShaderHash getShaderHashCode(ShaderStage stage) const;
 
   // Gets per pipeline options
@@ -148,6 +164,17 @@ public:
   // Get whether we are building a relocatable (unlinked) ElF
   bool isUnlinked() const { return m_unlinked; }
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  // Sets the GPU profile metrics a previous run of this pipeline was observed with
+  void setProfileMetrics(const PipelineProfileMetrics &metrics) {
+    m_profileMetrics = metrics;
+    m_hasProfileMetrics = true;
+  }
+
+  // Gets the GPU profile metrics observed for this pipeline, or null if no feedback was loaded for it
+  const PipelineProfileMetrics *getProfileMetrics() const { return m_hasProfileMetrics ? &m_profileMetrics : nullptr; }
+#endif
+
 protected:
   // Gets dummy vertex input create info
   virtual VkPipelineVertexInputStateCreateInfo *getDummyVertexInputInfo() { return nullptr; }
@@ -190,6 +217,10 @@ private:
 
   ShaderFpMode m_shaderFpModes[ShaderStageCountInternal] = {};
   bool m_unlinked = false; // Whether we are building an "unlinked" half-pipeline ELF
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  PipelineProfileMetrics m_profileMetrics = {}; // GPU profile metrics observed for this pipeline
+  bool m_hasProfileMetrics = false;             // Whether profile metrics were loaded for this pipeline
+#endif
 };
 
 } // namespace Llpc
@@ -29,12 +29,26 @@
 ***********************************************************************************************************************
 */
 #include "llpcShaderCache.h"
+#include "llpcShaderCacheManager.h"
+#include "llpcTimerProfiler.h"
 #include "vkgcUtil.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FileSystem.h"
+#include <algorithm>
 #include <string.h>
+#if defined(__unix__)
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
 
 #define DEBUG_TYPE "llpc-shader-cache"
 
@@ -43,6 +57,26 @@ using namespace llvm;
 static cl::opt<std::string> ShaderCacheFilename("shader-cache-filename", cl::desc("Filename for the shader cache"),
                                                 cl::value_desc("filename"), cl::init(""));
 
+static cl::opt<bool> ShaderCacheMmap("shader-cache-mmap",
+                                     cl::desc("Map the on-disk shader cache file read-only instead of reading "
+                                              "it into heap memory"),
+                                     cl::init(true));
+
+static cl::opt<bool> ShaderCacheNoWait("shader-cache-no-wait",
+                                       cl::desc("Return from shader cache lookups immediately instead of waiting "
+                                                "for another thread's in-flight compile of the same shader"),
+                                       cl::init(false));
+
+#if defined(__unix__)
+static cl::opt<unsigned> ShaderCacheShmEntries("shader-cache-shm-entries",
+                                               cl::desc("Capacity of the shared-memory shader cache index"),
+                                               cl::init(16384));
+
+static cl::opt<unsigned> ShaderCacheShmArenaMb("shader-cache-shm-arena-mb",
+                                               cl::desc("Size in MiB of the shared-memory shader cache blob arena"),
+                                               cl::init(64));
+#endif
+
 namespace Llpc {
 
 #if defined(__unix__)
@@ -110,12 +144,55 @@ static const uint64_t CrcLookup[256] = {
     0xF989DB4A98BD5062, 0x541A097F0C7465CB, 0x4FC6939CCB9986C6, 0xE25541A95F50B36F, 0xB972E5C276C2D83D,
     0x14E137F7E20BED94};
 
+#if defined(__unix__)
+// Layout of the shared-memory cache: a ShmCacheHeader, then entryCapacity ShmCacheEntry slots forming an
+// open-addressed index, then the blob arena. The whole mapping is shared by every process on the node that
+// runs the same LLPC build; the build ID is folded into the mapping's name, so incompatible builds never
+// see each other's data.
+static constexpr uint32_t ShmCacheMagic = 0x4C504343; // 'LPCC', written last during initialization
+
+struct ShmCacheHeader {
+  volatile uint32_t magic; // ShmCacheMagic once the creating process has finished initialization
+  uint32_t entryCapacity;  // Number of slots in the index table
+  uint32_t entryCount;     // Number of occupied slots
+  uint32_t padding;
+  uint64_t arenaSize;      // Size of the blob arena in bytes
+  uint64_t arenaUsed;      // Bytes of the arena already allocated
+  pthread_mutex_t mutex;   // Process-shared robust mutex guarding the index and the arena
+  pthread_cond_t cond;     // Process-shared condition broadcast when an entry leaves the Compiling state
+};
+
+struct ShmCacheEntry {
+  uint64_t key;            // Compacted shader hash; 0 marks a free slot
+  uint64_t crc;            // CRC of the stored blob
+  uint64_t offset;         // Offset of the blob from the mapping base
+  uint64_t size;           // Size of the blob in bytes
+  volatile uint32_t state; // ShaderEntryState of this entry
+  uint32_t padding;
+};
+
+// =====================================================================================================================
+// Locks the shared cache mutex, recovering it if a previous owner died while holding it.
+//
+// @param header : Header of the shared-memory cache
+static void lockSharedCacheMutex(ShmCacheHeader *header) {
+  if (pthread_mutex_lock(&header->mutex) == EOWNERDEAD)
+    pthread_mutex_consistent(&header->mutex);
+}
+#endif
+
 // =====================================================================================================================
 ShaderCache::ShaderCache()
-    : m_onDiskFile(), m_disableCache(true), m_shaderDataEnd(sizeof(ShaderCacheSerializedHeader)), m_totalShaders(0),
-      m_serializedSize(sizeof(ShaderCacheSerializedHeader)), m_getValueFunc(nullptr), m_storeValueFunc(nullptr) {
+    : m_onDiskFile(), m_disableCache(true), m_compressBlobs(false), m_shmBase(nullptr), m_shmSize(0),
+      m_lruHead(nullptr), m_lruTail(nullptr), m_cacheSizeBudget(0), m_evictableDataSize(0),
+      m_shaderDataEnd(sizeof(ShaderCacheSerializedHeader)), m_totalShaders(0),
+      m_fileShaderCount(0), m_writeBehindExit(false), m_prefetchExit(false), m_compilerDigest(0),
+      m_serializedSize(sizeof(ShaderCacheSerializedHeader)), m_activeSnapshots(0),
+      m_getValueFunc(nullptr), m_storeValueFunc(nullptr) {
   memset(m_fileFullPath, 0, MaxFilePathLen);
   memset(&m_gfxIp, 0, sizeof(m_gfxIp));
+  for (auto &word : m_bloomFilter)
+    word.store(0, std::memory_order_relaxed);
 }
 
 // =====================================================================================================================
@@ -126,23 +203,57 @@ ShaderCache::~ShaderCache() {
 // =====================================================================================================================
 // Destruction, does clean-up work.
 void ShaderCache::Destroy() {
+  // Stop the prefetch thread before any memory it may be touching is released.
+  stopPrefetchThread();
+  // Drain any pending write-behind work before the file goes away; this is the flush-on-destroy guarantee.
+  stopWriteBehindThread();
   if (m_onDiskFile.isOpen())
     m_onDiskFile.close();
+#if defined(__unix__)
+  if (m_shmBase) {
+    // Unmap only; the named shared-memory object deliberately outlives this process so other processes on
+    // the node keep their view of the cache.
+    munmap(m_shmBase, m_shmSize);
+    m_shmBase = nullptr;
+    m_shmSize = 0;
+  }
+#endif
   resetRuntimeCache();
 }
 
 // =====================================================================================================================
 // Resets the runtime shader cache to an empty state. Releases all allocator memory and decommits it back to the OS.
 void ShaderCache::resetRuntimeCache() {
-  for (auto indexMap : m_shaderIndexMap)
-    delete indexMap.second;
-  m_shaderIndexMap.clear();
+  for (auto &shard : m_shaderIndexShards) {
+    for (auto indexMap : shard.map) {
+      if (indexMap.second->storeBacked)
+        ShaderCacheManager::getShaderCacheManager()->getBlobStore().release(indexMap.second->dataBlob,
+                                                                            indexMap.second->header.size);
+      delete[] static_cast<uint8_t *>(indexMap.second->decompressedBlob);
+      delete indexMap.second;
+    }
+    shard.map.clear();
+  }
 
+  assert(m_activeSnapshots == 0);
   for (auto allocIt : m_allocationList)
     delete[] allocIt.first;
   m_allocationList.clear();
+  for (auto deferredIt : m_deferredFrees)
+    delete[] deferredIt.first;
+  m_deferredFrees.clear();
+
+  m_lruHead = nullptr;
+  m_lruTail = nullptr;
+  m_evictableDataSize = 0;
+
+  for (auto &word : m_bloomFilter)
+    word.store(0, std::memory_order_relaxed);
+
+  m_onDiskMapping.reset();
 
   m_totalShaders = 0;
+  m_fileShaderCount = 0;
   m_shaderDataEnd = sizeof(ShaderCacheSerializedHeader);
   m_serializedSize = sizeof(ShaderCacheSerializedHeader);
 }
@@ -150,98 +261,319 @@ void ShaderCache::resetRuntimeCache() {
 // =====================================================================================================================
 // Copies the shader cache data to the memory blob provided by the calling function.
 //
+// The cache lock is only held while capturing a frozen view of the serializable state - the header fields and one
+// (pointer, size) region per live entry, no blob bytes - so concurrent findShader callers are not stalled for the
+// duration of the byte assembly. The view stays readable while the bytes are assembled outside the lock: blobs in
+// the shared blob store are pinned with an extra reference for the duration of the copy, allocations freed while a
+// snapshot is active (eviction, blob replacement) are parked on a deferred list and reclaimed once the last
+// snapshot finishes, and the file mapping is never unmapped while the cache is alive.
+//
 // NOTE: It is expected that the calling function has not used this shader cache since querying the size
 //
 // @param [out] blob : System memory pointer where the serialized data should be placed
 // @param [in,out] size : Size of the memory pointed to by pBlob. If the value stored in pSize is zero then no data will
-// be copied and instead the size required for serialization will be returned in pSize
+// be copied and instead the size required for serialization will be returned in pSize. Otherwise it is updated to
+// the number of bytes actually written.
 Result ShaderCache::Serialize(void *blob, size_t *size) {
+  // A shared-memory cache has no meaningful per-process serialized form.
+  if (m_shmBase)
+    return Result::ErrorUnavailable;
+
   Result result = Result::Success;
 
   if (*size == 0) {
-    // Query shader cache serailzied size
+    // Query shader cache serialized size. This is an upper bound on the data pass: stale duplicate records and
+    // index journal bytes counted here are dropped when the blob is assembled from the live entries.
     (*size) = m_serializedSize;
-  } else {
-    // Do serialize
-    assert(m_shaderDataEnd == m_serializedSize || m_shaderDataEnd == sizeof(ShaderCacheSerializedHeader));
-
-    if (m_serializedSize >= sizeof(ShaderCacheSerializedHeader)) {
-      if (blob && (*size) >= m_serializedSize) {
-        // First construct the header and copy it into the memory provided
-        ShaderCacheSerializedHeader header = {};
-        header.headerSize = sizeof(ShaderCacheSerializedHeader);
-        header.shaderCount = m_totalShaders;
-        header.shaderDataEnd = m_shaderDataEnd;
-        getBuildTime(&header.buildId);
-
-        memcpy(blob, &header, sizeof(ShaderCacheSerializedHeader));
-
-        void *dataDst = voidPtrInc(blob, sizeof(ShaderCacheSerializedHeader));
-
-        // Then iterate through all allocators (which hold the backing memory for the shader data)
-        // and copy their contents to the blob.
-        for (auto it : m_allocationList) {
-          assert(it.first);
-
-          const size_t copySize = it.second;
-          if (voidPtrDiff(dataDst, blob) + copySize > (*size)) {
-            result = Result::ErrorUnknown;
-            break;
-          }
+    return result;
+  }
 
-          memcpy(dataDst, it.first, copySize);
-          dataDst = voidPtrInc(dataDst, copySize);
-        }
-      } else {
-        llvm_unreachable("Should never be called!");
-        result = Result::ErrorUnknown;
+  // Capture the frozen view. The serialized form is rebuilt record by record from the index rather than from the
+  // raw backing regions, because entry bytes live in three different places - the file mapping, this cache's own
+  // allocations and the shared blob store - and only the index knows which records are live.
+  ShaderCacheSerializedHeader header = {};
+  llvm::SmallVector<std::pair<const uint8_t *, size_t>, 16> regions;
+  llvm::SmallVector<std::pair<const void *, size_t>, 16> storeRefs;
+  size_t serializedSize = sizeof(ShaderCacheSerializedHeader);
+
+  lockCacheMap(false);
+
+  for (auto &shard : m_shaderIndexShards) {
+    shard.lock.lock();
+    for (auto indexMap : shard.map) {
+      ShaderIndex *const index = indexMap.second;
+
+      // Serialize entries that are servable now, plus entries awaiting revalidation after a driver update -
+      // their bytes are still exactly what a load by the matching older build would want.
+      if (index->state != ShaderEntryState::Ready && !index->staleVersion)
+        continue;
+      if (!index->dataBlob)
+        continue;
+
+      if (index->storeBacked) {
+        // Pin the stored blob so a release by another cache cannot free it before the copy below completes.
+        ShaderCacheManager::getShaderCacheManager()->getBlobStore().acquire(index->dataBlob, index->header.size);
+        storeRefs.push_back({index->dataBlob, index->header.size});
       }
+      regions.push_back({static_cast<const uint8_t *>(index->dataBlob), index->header.size});
+      serializedSize += index->header.size;
     }
+    shard.lock.unlock();
   }
 
+  // The queried size counts every backing byte, including superseded records, so the emitted form never exceeds it.
+  assert(serializedSize <= m_serializedSize);
+
+  header.headerSize = sizeof(ShaderCacheSerializedHeader);
+  header.shaderCount = regions.size();
+  header.shaderDataEnd = serializedSize;
+  getBuildTime(&header.buildId);
+  for (unsigned word = 0; word < BloomFilterWords; ++word)
+    header.bloomFilter[word] = m_bloomFilter[word].load(std::memory_order_relaxed);
+
+  ++m_activeSnapshots;
+
+  unlockCacheMap(false);
+
+  // Assemble the bytes against the frozen view, without the lock.
+  if (blob && (*size) >= serializedSize) {
+    memcpy(blob, &header, sizeof(ShaderCacheSerializedHeader));
+
+    void *dataDst = voidPtrInc(blob, sizeof(ShaderCacheSerializedHeader));
+    for (const auto &region : regions) {
+      assert(region.first);
+      memcpy(dataDst, region.first, region.second);
+      dataDst = voidPtrInc(dataDst, region.second);
+    }
+    (*size) = serializedSize;
+  } else {
+    llvm_unreachable("Should never be called!");
+    result = Result::ErrorUnknown;
+  }
+
+  // Drop the snapshot; the last one out reclaims the allocations freed while any snapshot was active.
+  lockCacheMap(false);
+  assert(m_activeSnapshots > 0);
+  if (--m_activeSnapshots == 0) {
+    for (auto deferredIt : m_deferredFrees)
+      delete[] deferredIt.first;
+    m_deferredFrees.clear();
+  }
+  unlockCacheMap(false);
+
+  // Drop the blob store references that pinned store-backed records during the copy.
+  for (auto storeRef : storeRefs)
+    ShaderCacheManager::getShaderCacheManager()->getBlobStore().release(storeRef.first, storeRef.second);
+
   return result;
 }
 
 // =====================================================================================================================
-// Merges the shader data of source shader caches into this shader cache.
+// Merges the shader data of source shader caches into this shader cache. The merge is incremental: only entries
+// missing from the destination index are copied, existing entries are left untouched, and when the destination has
+// an on-disk file the new entries are appended to it in a single coalesced write.
 //
 // @param srcCacheCount : Count of input source shader caches
 // @param ppSrcCaches : Input shader caches
 Result ShaderCache::Merge(unsigned srcCacheCount, const IShaderCache **ppSrcCaches) {
-  // Merge function is supposed to be called by client created shader caches, which are always runtime mode.
-  assert(m_fileFullPath[0] == '\0');
+  if (m_shmBase)
+    return Result::ErrorUnavailable;
 
   Result result = Result::Success;
 
+  // Entries added by this merge; used to append them to the on-disk file as one batch.
+  std::vector<ShaderIndex *> addedIndices;
+
   lockCacheMap(false);
 
   for (unsigned i = 0; i < srcCacheCount; i++) {
     ShaderCache *srcCache = static_cast<ShaderCache *>(const_cast<IShaderCache *>(ppSrcCaches[i]));
     srcCache->lockCacheMap(true);
 
-    for (auto it : srcCache->m_shaderIndexMap) {
-      uint64_t key = it.first;
+    for (auto &srcShard : srcCache->m_shaderIndexShards) {
+      srcShard.lock.lock();
+      for (auto it : srcShard.map) {
+        uint64_t key = it.first;
+
+        // Entries that are mid-compile, or that await revalidation after a driver update, have nothing
+        // servable to copy.
+        if (it.second->state != ShaderEntryState::Ready)
+          continue;
 
-      auto indexMap = m_shaderIndexMap.find(key);
-      if (indexMap == m_shaderIndexMap.end()) {
         ShaderIndex *index = nullptr;
-        void *mem = getCacheSpace(it.second->header.size);
-        memcpy(mem, it.second->dataBlob, it.second->header.size);
+        ShaderIndexShard &shard = getShaderIndexShard(key);
+        shard.lock.lock();
+        auto indexMap = shard.map.find(key);
+        if (indexMap == shard.map.end()) {
+          // Take a reference on the source blob through the shared blob store. When the source entry was a
+          // runtime insert its bytes are already in the store, so this is a pure reference count bump and no
+          // copy is made.
+          index = new ShaderIndex;
+          memset(index, 0, sizeof(*index));
+          index->dataBlob = const_cast<void *>(ShaderCacheManager::getShaderCacheManager()->getBlobStore().acquire(
+              it.second->dataBlob, it.second->header.size));
+          index->storeBacked = true;
+          index->state = ShaderEntryState::Ready;
+          index->header = it.second->header;
+          m_serializedSize += index->header.size;
 
-        index = new ShaderIndex;
-        index->dataBlob = mem;
-        index->state = ShaderEntryState::Ready;
-        index->header = it.second->header;
+          addToBloomFilter(key);
+          shard.map[key] = index;
+          m_totalShaders++;
+        }
+        shard.lock.unlock();
+
+        if (index) {
+          addedIndices.push_back(index);
 
-        m_shaderIndexMap[key] = index;
-        m_totalShaders++;
+          // Merged blobs are individually releasable, so they take part in eviction like runtime inserts.
+          if (m_cacheSizeBudget != 0)
+            addLruEntry(index);
+        }
       }
+      srcShard.lock.unlock();
     }
     srcCache->unlockCacheMap(true);
   }
 
+  // Stream the new entries to the on-disk file, if there is one. Only the missing entries are written - the
+  // data already in the file is never rewritten - so merging into a large master cache costs IO proportional
+  // to the new entries only.
+  if (m_onDiskFile.isOpen() && !addedIndices.empty()) {
+    if (m_writeBehindThread.joinable()) {
+      for (ShaderIndex *index : addedIndices)
+        addShaderToFile(index);
+    } else
+      appendShadersToFile(addedIndices.data(), addedIndices.size());
+  }
+
+  unlockCacheMap(false);
+
+  return result;
+}
+
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+// =====================================================================================================================
+// Copies a snapshot of the cache's statistics counters. The counters are plain relaxed atomics so this is cheap
+// enough to poll every frame and never takes any of the cache's locks.
+//
+// @param [out] pStats : Statistics of this shader cache
+void ShaderCache::GetStats(ShaderCacheStats *pStats) {
+  assert(pStats);
+  pStats->hits = m_statHits.load(std::memory_order_relaxed);
+  pStats->misses = m_statMisses.load(std::memory_order_relaxed);
+  pStats->missCompileNanos = m_statMissCompileNanos.load(std::memory_order_relaxed);
+  pStats->bytesStored = m_statBytesStored.load(std::memory_order_relaxed);
+  pStats->evictions = m_statEvictions.load(std::memory_order_relaxed);
+  pStats->waitNanos = m_statWaitNanos.load(std::memory_order_relaxed);
+}
+
+// =====================================================================================================================
+// Compacts the cache's on-disk backing file. See IShaderCache::Compact.
+//
+// @param hashCount : Number of entries in pHashes
+// @param pHashes : Manifest of compacted shader hashes giving the desired file order, or null
+Result ShaderCache::Compact(unsigned hashCount, const uint64_t *pHashes) {
+  return compactCacheFile(llvm::makeArrayRef(pHashes, pHashes ? hashCount : 0));
+}
+#endif
+
+// =====================================================================================================================
+// Rewrites the on-disk cache file with its live entries laid out contiguously in the requested order.
+//
+// Appends happen in compile-completion order, so after many incremental runs related entries are scattered across
+// the file and blobs superseded by recompiles of the same shader linger as dead bytes. Compaction rewrites the
+// data section with one record per live entry - manifest entries first in manifest order, then everything else
+// most recently used first - restoring sequential read patterns for cold loads and the prefetch path.
+//
+// Must not run concurrently with compiles that touch this cache.
+//
+// @param manifest : Compacted shader hashes in the order the entries should be laid out, e.g. the expected load
+//                   order of the next run; may be empty
+Result ShaderCache::compactCacheFile(ArrayRef<uint64_t> manifest) {
+  if (m_disableCache || m_shmBase || !m_onDiskFile.isOpen())
+    return Result::ErrorUnavailable;
+
+  // Drain pending appends so every insert of this run is represented in the index, and keep the write-behind
+  // thread away from the file while it is rewritten.
+  const bool writeBehind = m_writeBehindThread.joinable();
+  stopWriteBehindThread();
+
+  lockCacheMap(false);
+
+  // Collect every entry that has stored bytes. Blobs superseded by a later recompile of the same shader are not
+  // reachable from the index map, so dead generations drop out here; entries still being compiled have no blob
+  // yet and get appended through the normal path once they finish.
+  std::vector<ShaderIndex *> entries;
+  entries.reserve(m_fileIndexRecords.size());
+  for (ShaderIndexShard &shard : m_shaderIndexShards) {
+    shard.lock.lock();
+    for (auto &mapEntry : shard.map) {
+      if (mapEntry.second->dataBlob)
+        entries.push_back(mapEntry.second);
+    }
+    shard.lock.unlock();
+  }
+
+  // Manifest entries come first, in manifest order; the rest follow most recently used first. The sort is stable
+  // so file-loaded entries this run never touched (which all carry a lastUseNanos of zero) keep their relative
+  // file order.
+  std::unordered_map<uint64_t, unsigned> manifestRank;
+  for (unsigned i = 0; i < manifest.size(); ++i)
+    manifestRank.emplace(manifest[i], i);
+  std::stable_sort(entries.begin(), entries.end(), [&manifestRank](const ShaderIndex *a, const ShaderIndex *b) {
+    auto rankA = manifestRank.find(a->header.key);
+    auto rankB = manifestRank.find(b->header.key);
+    if (rankA != manifestRank.end() || rankB != manifestRank.end()) {
+      if (rankA == manifestRank.end())
+        return false;
+      if (rankB == manifestRank.end())
+        return true;
+      return rankA->second < rankB->second;
+    }
+    return a->lastUseNanos > b->lastUseNanos;
+  });
+
+  // In zero-copy mode the blobs about to be rewritten live in the mapping of this very file. Move them into
+  // runtime allocations and drop the mapping first, converting the cache to plain read mode.
+  if (m_onDiskMapping) {
+    for (ShaderIndex *index : entries) {
+      void *const copy = getCacheSpace(index->header.size);
+      memcpy(copy, index->dataBlob, index->header.size);
+      ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+      shard.lock.lock();
+      index->dataBlob = copy;
+      shard.lock.unlock();
+    }
+    m_serializedSize -= m_onDiskMapping->getBufferSize() - sizeof(ShaderCacheSerializedHeader);
+    m_onDiskMapping.reset();
+  }
+
+  // Rewrite the file from scratch: a fresh header, then one append of the whole ordered batch, which also lays
+  // down the new index journal.
+  resetCacheFile();
+  m_shaderDataEnd = sizeof(ShaderCacheSerializedHeader);
+  m_totalShaders = entries.size();
+  appendShadersToFile(entries.data(), entries.size());
+
+  // The append rebuilt the index records in the new order; point each entry at its new file location.
+  assert(m_fileIndexRecords.size() == entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    ShaderIndexShard &shard = getShaderIndexShard(entries[i]->header.key);
+    shard.lock.lock();
+    entries[i]->fileOffset = m_fileIndexRecords[i].fileOffset;
+    shard.lock.unlock();
+  }
+
+  // Cut off the stale bytes of the old layout so the journal trailer sits at the end of the file again.
+  const size_t pageCount = (m_fileIndexRecords.size() + IndexPageRecordCount - 1) / IndexPageRecordCount;
+  const Result result = m_onDiskFile.truncate(m_shaderDataEnd + pageCount * sizeof(IndexPage) + sizeof(IndexTrailer));
+
   unlockCacheMap(false);
 
+  if (writeBehind)
+    startWriteBehindThread();
+
   return result;
 }
 
@@ -261,6 +593,19 @@ Result ShaderCache::init(const ShaderCacheCreateInfo *createInfo, const ShaderCa
     m_gfxIp = auxCreateInfo->gfxIp;
     m_hash = auxCreateInfo->hash;
 
+    // Digest of this compiler build, stored with every cache entry. The file-level header only enforces the
+    // outer key (graphics IP and compilation option hash); the per-entry digest is the inner key that decides
+    // whether a blob from an older driver build may be served or must first be revalidated by a recompile.
+    BuildUniqueId buildId = {};
+    getBuildTime(&buildId);
+    m_compilerDigest = calculateCrc(buildId.buildDate, sizeof(buildId.buildDate)) ^
+                       calculateCrc(buildId.buildTime, sizeof(buildId.buildTime));
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+    // Negotiate blob compression: only honor the request if this LLVM build has zlib support.
+    m_compressBlobs = createInfo->compression == ShaderCacheCompression::Zlib && zlib::isAvailable();
+    m_cacheSizeBudget = createInfo->maxRuntimeDataSize;
+#endif
+
     lockCacheMap(false);
 
     // If we're in runtime mode and the caller provided a data blob, try to load the from that blob.
@@ -268,6 +613,12 @@ Result ShaderCache::init(const ShaderCacheCreateInfo *createInfo, const ShaderCa
       if (loadCacheFromBlob(createInfo->pInitialData, createInfo->initialDataSize) != Result::Success)
         resetRuntimeCache();
     }
+    // If we're in shared-memory mode, create or attach to the node-wide mapping. On failure (or on platforms
+    // without shared-memory support) the cache silently degrades to plain runtime mode.
+    else if (auxCreateInfo->shaderCacheMode == ShaderCacheEnableSharedMemory) {
+      if (initSharedMemory(auxCreateInfo) != Result::Success)
+        resetRuntimeCache();
+    }
     // If we're in on-disk mode try to load the cache from file.
     else if (auxCreateInfo->shaderCacheMode == ShaderCacheEnableOnDisk ||
              auxCreateInfo->shaderCacheMode == ShaderCacheForceInternalCacheOnDisk ||
@@ -307,6 +658,11 @@ Result ShaderCache::init(const ShaderCacheCreateInfo *createInfo, const ShaderCa
       // any memory allocated
       if (loadResult != Result::Success)
         resetRuntimeCache();
+
+      // If the file stayed open for writing, service appends from a background thread so compiles don't
+      // stall on disk I/O.
+      if (m_onDiskFile.isOpen())
+        startWriteBehindThread();
     }
 
     unlockCacheMap(false);
@@ -373,6 +729,8 @@ void ShaderCache::resetCacheFile() {
   getBuildTime(&header.buildId);
 
   m_onDiskFile.write(&header, header.headerSize);
+  m_fileShaderCount = 0;
+  m_fileIndexRecords.clear();
 }
 
 // =====================================================================================================================
@@ -382,6 +740,8 @@ void ShaderCache::resetCacheFile() {
 //    Ready       - if a matching shader was found and is ready for use
 //    Compiling   - if an entry was created and must be compiled/populated by the caller
 //    Unavailable - if an unrecoverable error was encountered
+//    Failed      - if a recent compile of this shader failed and its recorded result is still fresh; the caller
+//                  should report that result via getShaderFailureResult instead of compiling
 //
 // @param hash : Hash code of shader
 // @param allocateOnMiss : Whether allocate a new entry for new hash
@@ -393,37 +753,67 @@ ShaderEntryState ShaderCache::findShader(MetroHash::Hash hash, bool allocateOnMi
     return ShaderEntryState::Compiling;
   }
 
-  ShaderEntryState result = ShaderEntryState::Unavailable;
   bool existed = false;
   ShaderIndex *index = nullptr;
-  Result mapResult = Result::Success;
   assert(phEntry);
 
-  bool readOnlyLock = (!allocateOnMiss);
-  lockCacheMap(readOnlyLock);
   uint64_t hashKey = MetroHash::compact64(&hash);
-  auto indexMap = m_shaderIndexMap.find(hashKey);
-  if (indexMap != m_shaderIndexMap.end()) {
-    existed = true;
-    index = indexMap->second;
-  } else if (allocateOnMiss) {
-    index = new ShaderIndex;
-    m_shaderIndexMap[hashKey] = index;
+
+  CompileTraceSpan traceSpan("findShader", hashKey);
+
+#if defined(__unix__)
+  if (m_shmBase) {
+    ShaderEntryState state = findShaderInSharedMemory(hashKey, allocateOnMiss, phEntry);
+    if (state == ShaderEntryState::Ready)
+      m_statHits.fetch_add(1, std::memory_order_relaxed);
+    else if (state == ShaderEntryState::Compiling)
+      m_statMisses.fetch_add(1, std::memory_order_relaxed);
+    return state;
   }
+#endif
 
-  if (!index)
-    mapResult = Result::ErrorUnavailable;
-
-  if (mapResult == Result::Success) {
-    if (existed) {
-      // We don't need to hold on to the write lock if we're not the one doing the compile
-      if (!readOnlyLock) {
-        unlockCacheMap(readOnlyLock);
-        readOnlyLock = true;
-        lockCacheMap(readOnlyLock);
-      }
-    } else {
-      bool needsInit = true;
+  ShaderIndexShard &shard = getShaderIndexShard(hashKey);
+
+  // Consult the Bloom filter before taking any lock. On the first boot of a clean machine every probe is a
+  // miss, and this rejects those in a few cache lines instead of a shard lock and a hash map probe per call.
+  // A filter hit (including a false positive) falls through to the locked probe as before.
+  const bool mayContain = mayContainKey(hashKey);
+  if (!mayContain && !allocateOnMiss)
+    return ShaderEntryState::Unavailable;
+
+  ShaderIndexMap::iterator indexMap;
+  if (mayContain) {
+    // Fast path: probe the owning shard only. Cache hits (the overwhelmingly common case) complete without ever
+    // touching m_lock, so lookups on different shards proceed fully in parallel.
+    shard.lock.lock();
+    indexMap = shard.map.find(hashKey);
+    if (indexMap != shard.map.end()) {
+      existed = true;
+      index = indexMap->second;
+    }
+    shard.lock.unlock();
+  }
+
+  if (!index && allocateOnMiss) {
+    // Slow path: take the allocation lock, then re-probe the shard as another thread may have allocated the
+    // entry while we were waiting.
+    lockCacheMap(false);
+
+    shard.lock.lock();
+    indexMap = shard.map.find(hashKey);
+    if (indexMap != shard.map.end()) {
+      existed = true;
+      index = indexMap->second;
+    }
+    shard.lock.unlock();
+
+    if (!existed) {
+      // Fully initialize the new entry before publishing it in the shard, so other threads can never observe
+      // a half-constructed index.
+      index = new ShaderIndex;
+      memset(index, 0, sizeof(*index));
+      index->header.key = hashKey;
+      index->state = ShaderEntryState::New;
 
       // We didn't find the entry in our own hash map, now search the external cache if available
       if (useExternalCache()) {
@@ -450,7 +840,10 @@ ShaderEntryState ShaderCache::findShader(MetroHash::Hash hash, bool allocateOnMi
 
           index->header = (*header);
           index->state = ShaderEntryState::Ready;
-          needsInit = false;
+
+          // The blob lives in its own allocation, so it takes part in eviction like any runtime insert.
+          if (m_cacheSizeBudget != 0)
+            addLruEntry(index);
         } else if (extResult == Result::ErrorUnavailable) {
           // This means the external cache is unavailable and we shouldn't bother using it anymore. To
           // prevent useless calls we'll zero out the function pointers.
@@ -462,48 +855,83 @@ ShaderEntryState ShaderCache::findShader(MetroHash::Hash hash, bool allocateOnMi
           assert(extResult != Result::ErrorOutOfMemory);
 
           // Any other result means we just need to continue with initializing the new index/compiling.
+          index->header.size = 0;
+          index->dataBlob = nullptr;
         }
       }
 
-      if (needsInit) {
-        // This is a brand new cache entry so we need to initialize the ShaderIndex.
-        memset(index, 0, sizeof(*index));
-        index->header.key = hashKey;
-        index->state = ShaderEntryState::New;
-      }
-    } // End if (existed == false)
+      // Publish the entry, setting its filter bits first so no thread can find it in the shard while the
+      // filter still rejects it; from here on other threads may find it through the fast path.
+      addToBloomFilter(hashKey);
+      shard.lock.lock();
+      shard.map[hashKey] = index;
+      shard.lock.unlock();
+    }
 
-    if (index->state == ShaderEntryState::Compiling) {
-      // The shader is being compiled by another thread, we should release the lock and wait for it to complete
-      while (index->state == ShaderEntryState::Compiling) {
-        unlockCacheMap(readOnlyLock);
-        {
-          std::unique_lock<std::mutex> lock(m_conditionMutex);
+    unlockCacheMap(false);
+  }
 
-          m_conditionVariable.wait_for(lock, std::chrono::seconds(1));
-        }
-        lockCacheMap(readOnlyLock);
-      }
-      // At this point the shader entry is either Ready, New or something failed. We've already
-      // initialized our result code to an error code above, the Ready and New cases are handled below so
-      // nothing else to do here.
+  if (!index)
+    return ShaderEntryState::Unavailable;
+
+  // Examine the entry state and claim the compile if it is up for grabs. The owning shard's lock makes the
+  // check-and-transition atomic with respect to other threads probing the same entry.
+  shard.lock.lock();
+
+  if (index->state == ShaderEntryState::Compiling) {
+    if (ShaderCacheNoWait) {
+      // The caller would rather compile redundantly (or press on without the cache) than block behind the
+      // other thread's compile, so report the entry as unusable without claiming it.
+      shard.lock.unlock();
+      return ShaderEntryState::Unavailable;
     }
 
-    if (index->state == ShaderEntryState::Ready) {
-      // The shader has been compiled, just verify it has valid data and then return success.
-      assert(index->dataBlob && index->header.size != 0);
-    } else if (index->state == ShaderEntryState::New) {
-      // The shader entry is new (or previously failed compilation) and we're the first thread to get a
-      // crack at it, move it into the Compiling state
-      index->state = ShaderEntryState::Compiling;
+    // The shader is being compiled by another thread, we should release the lock and wait for it to complete.
+    // Sleeping on the owning shard's condition variable means only inserts into this shard wake us.
+    const uint64_t waitStartNanos = getMonotonicNanos();
+    while (index->state == ShaderEntryState::Compiling) {
+      shard.lock.unlock();
+      {
+        std::unique_lock<std::mutex> lock(shard.waitMutex);
+
+        shard.condition.wait_for(lock, std::chrono::seconds(1));
+      }
+      shard.lock.lock();
     }
+    m_statWaitNanos.fetch_add(getMonotonicNanos() - waitStartNanos, std::memory_order_relaxed);
+    // At this point the shader entry is either Ready, New, Failed or something failed. The Ready, New and
+    // Failed cases are handled below so nothing else to do here.
+  }
+
+  if (index->state == ShaderEntryState::Failed &&
+      getMonotonicNanos() - index->failedNanos >= FailedEntryTtlNanos) {
+    // The recorded failure has aged out; let this caller retry the compile by dropping the entry back to New,
+    // which the claim below picks up.
+    index->state = ShaderEntryState::New;
+  }
 
-    // Return the ShaderIndex as a handle so subsequent calls into the cache can avoid the hash map lookup.
-    (*phEntry) = index;
-    result = index->state;
+  if (index->state == ShaderEntryState::Ready) {
+    // The shader has been compiled, just verify it has valid data and then return success.
+    assert(index->dataBlob && index->header.size != 0);
+  } else if (index->state == ShaderEntryState::New) {
+    // The shader entry is new (or previously failed compilation) and we're the first thread to get a
+    // crack at it, move it into the Compiling state
+    index->state = ShaderEntryState::Compiling;
+    index->compileStartNanos = getMonotonicNanos();
   }
 
-  unlockCacheMap(readOnlyLock);
+  // Return the ShaderIndex as a handle so subsequent calls into the cache can avoid the hash map lookup.
+  (*phEntry) = index;
+  ShaderEntryState result = index->state;
+
+  shard.lock.unlock();
+
+  if (result == ShaderEntryState::Ready) {
+    m_statHits.fetch_add(1, std::memory_order_relaxed);
+    if (m_cacheSizeBudget != 0)
+      touchLruEntry(index);
+  } else if (result == ShaderEntryState::Compiling)
+    m_statMisses.fetch_add(1, std::memory_order_relaxed);
 
   return result;
 }
@@ -516,8 +944,15 @@ ShaderEntryState ShaderCache::findShader(MetroHash::Hash hash, bool allocateOnMi
 // @param blob : Shader data
 // @param shaderSize : size of shader data in bytes
 void ShaderCache::insertShader(CacheEntryHandle hEntry, const void *blob, size_t shaderSize) {
-  auto *const index = static_cast<ShaderIndex *>(hEntry);
   assert(m_disableCache == false);
+#if defined(__unix__)
+  if (m_shmBase) {
+    insertShaderInSharedMemory(hEntry, blob, shaderSize);
+    return;
+  }
+#endif
+
+  auto *const index = static_cast<ShaderIndex *>(hEntry);
   assert(index && index->state == ShaderEntryState::Compiling);
 
   lockCacheMap(false);
@@ -525,27 +960,83 @@ void ShaderCache::insertShader(CacheEntryHandle hEntry, const void *blob, size_t
   Result result = Result::Success;
 
   if (result == Result::Success) {
-    // Allocate space to store the serialized shader and a copy of the header. The header is duplicated in the
-    // data to simplify serialize/load.
-    index->header.size = (shaderSize + sizeof(ShaderHeader));
-    index->dataBlob = getCacheSpace(index->header.size);
+    const void *storeData = blob;
+    size_t storeSize = shaderSize;
+
+    // Optionally deflate the blob before it is stored; cached ISA and metadata compress well, so this cuts
+    // both the runtime footprint and the on-disk cache size. If compression fails or does not shrink the
+    // blob, fall back to storing it uncompressed.
+    SmallVector<char, 64> compressed;
+    if (m_compressBlobs) {
+      if (Error err = zlib::compress(StringRef(static_cast<const char *>(blob), shaderSize), compressed))
+        consumeError(std::move(err));
+      else if (compressed.size() < shaderSize) {
+        storeData = compressed.data();
+        storeSize = compressed.size();
+      }
+    }
+
+    // For an entry carried across a driver update, the stored stale blob is compared against this recompile
+    // before being replaced; keep its header around for that comparison.
+    const ShaderHeader staleHeader = index->header;
+
+    // The stored image is the serialized shader preceded by a copy of the header. The header is duplicated in
+    // the data to simplify serialize/load.
+    index->header.size = (storeSize + sizeof(ShaderHeader));
+    index->header.uncompressedSize = shaderSize;
+    index->header.compilerDigest = m_compilerDigest;
+
+    // Build the stored image in a staging buffer, then hand it to the blob store shared by all shader caches.
+    // Identical shaders inserted by other ShaderCache instances resolve to the same stored copy, so the bytes
+    // are kept only once per distinct blob across all caches.
+    SmallVector<uint8_t, 64> staging(index->header.size);
+    void *const stagingData = staging.data() + sizeof(ShaderHeader);
+
+    // Serialize the shader into an opaque blob of data.
+    memcpy(stagingData, storeData, storeSize);
+
+    // Compute a CRC for the serialized data (useful for detecting data corruption), and copy the index's
+    // header into the data's header.
+    index->header.crc = calculateCrc(static_cast<uint8_t *>(stagingData), storeSize);
+    memcpy(staging.data(), &index->header, sizeof(ShaderHeader));
+
+    if (index->staleVersion && index->header.size == staleHeader.size &&
+        index->header.uncompressedSize == staleHeader.uncompressedSize && index->header.crc == staleHeader.crc) {
+      // The recompile reproduced the stored bytes exactly, so the entry survives the driver update as-is: keep
+      // the already-loaded blob, revalidate the entry, and rewrite only its compilerDigest in the file. Entries
+      // in a read-only mapping keep the stale digest in their in-memory image; that only costs a redundant
+      // revalidation if this process serializes the cache.
+      index->staleVersion = false;
+      if (!m_onDiskMapping)
+        static_cast<ShaderHeader *>(index->dataBlob)->compilerDigest = m_compilerDigest;
+
+      if (index->compileStartNanos != 0)
+        m_statMissCompileNanos.fetch_add(getMonotonicNanos() - index->compileStartNanos, std::memory_order_relaxed);
+
+      ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+      shard.lock.lock();
+      index->state = ShaderEntryState::Ready;
+      shard.lock.unlock();
+
+      if (m_onDiskFile.isOpen() && index->fileOffset != 0)
+        patchCompilerDigestInFile(index->fileOffset);
+
+      unlockCacheMap(false);
+      shard.condition.notify_all();
+      return;
+    }
+    index->staleVersion = false;
+
+    index->dataBlob = const_cast<void *>(
+        ShaderCacheManager::getShaderCacheManager()->getBlobStore().acquire(staging.data(), staging.size()));
+    index->storeBacked = true;
+    m_serializedSize += index->header.size;
 
     if (!index->dataBlob)
       result = Result::ErrorOutOfMemory;
     else {
       ++m_totalShaders;
 
-      auto *const header = static_cast<ShaderHeader *>(index->dataBlob);
-      void *const dataBlob = (header + 1);
-
-      // Serialize the shader into an opaque blob of data.
-      memcpy(dataBlob, blob, shaderSize);
-
-      // Compute a CRC for the serialized data (useful for detecting data corruption), and copy the index's
-      // header into the data's header.
-      index->header.crc = calculateCrc(static_cast<uint8_t *>(dataBlob), shaderSize);
-      (*header) = index->header;
-
       if (useExternalCache()) {
         // If we're making use of the external shader cache then we need to store the compiled shader data here.
         Result externalResult = m_storeValueFunc(m_clientData, index->header.key, index->dataBlob, index->header.size);
@@ -561,12 +1052,26 @@ void ShaderCache::insertShader(CacheEntryHandle hEntry, const void *blob, size_t
         }
       }
 
-      // Mark this entry as ready, we'll wake the waiting threads once we release the lock
+      m_statBytesStored.fetch_add(index->header.size, std::memory_order_relaxed);
+      if (index->compileStartNanos != 0)
+        m_statMissCompileNanos.fetch_add(getMonotonicNanos() - index->compileStartNanos, std::memory_order_relaxed);
+
+      // Mark this entry as ready, we'll wake the waiting threads once we release the lock. Take the owning
+      // shard's lock so the transition is ordered with threads examining the entry state.
+      ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+      shard.lock.lock();
       index->state = ShaderEntryState::Ready;
+      shard.lock.unlock();
 
       // Finally, update the file if necessary.
       if (m_onDiskFile.isOpen())
         addShaderToFile(index);
+
+      // Track the entry for eviction and trim the cache back inside its budget if one is configured.
+      if (m_cacheSizeBudget != 0) {
+        addLruEntry(index);
+        enforceCacheBudget();
+      }
     }
   }
 
@@ -575,13 +1080,16 @@ void ShaderCache::insertShader(CacheEntryHandle hEntry, const void *blob, size_t
     // can do here except give up on adding data. This means we need to set the entry back to New so if another
     // thread is waiting it will be allowed to continue (it will likely just get to this same point, but at least
     // we won't hang or crash).
+    ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+    shard.lock.lock();
     index->state = ShaderEntryState::New;
     index->header.size = 0;
     index->dataBlob = nullptr;
+    shard.lock.unlock();
   }
 
   unlockCacheMap(false);
-  m_conditionVariable.notify_all();
+  getShaderIndexShard(index->header.key).condition.notify_all();
 }
 
 // =====================================================================================================================
@@ -589,45 +1097,431 @@ void ShaderCache::insertShader(CacheEntryHandle hEntry, const void *blob, size_t
 //
 // @param hEntry : Handle of shader cache entry
 void ShaderCache::resetShader(CacheEntryHandle hEntry) {
-  auto *const index = static_cast<ShaderIndex *>(hEntry);
   assert(m_disableCache == false);
+#if defined(__unix__)
+  if (m_shmBase) {
+    resetShaderInSharedMemory(hEntry);
+    return;
+  }
+#endif
+
+  auto *const index = static_cast<ShaderIndex *>(hEntry);
   assert(index && index->state == ShaderEntryState::Compiling);
-  lockCacheMap(false);
+  ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+  shard.lock.lock();
   index->state = ShaderEntryState::New;
   index->header.size = 0;
   index->dataBlob = nullptr;
-  unlockCacheMap(false);
-  m_conditionVariable.notify_all();
+  shard.lock.unlock();
+  shard.condition.notify_all();
+}
+
+// =====================================================================================================================
+// Records a failed compile on the given claimed entry. Until the failure's TTL expires, lookups of the same
+// shader return ShaderEntryState::Failed together with the recorded result code instead of redoing a compile
+// that is known to be doomed.
+//
+// @param hEntry : Handle of shader cache entry
+// @param failureResult : Result code the failed compile ended with
+void ShaderCache::markShaderFailed(CacheEntryHandle hEntry, Result failureResult) {
+  assert(m_disableCache == false);
+  assert(failureResult != Result::Success);
+#if defined(__unix__)
+  if (m_shmBase) {
+    // The shared-memory layout has no room for per-entry failure data; just release the claim.
+    resetShaderInSharedMemory(hEntry);
+    return;
+  }
+#endif
+
+  auto *const index = static_cast<ShaderIndex *>(hEntry);
+  assert(index && index->state == ShaderEntryState::Compiling);
+  ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+  shard.lock.lock();
+  index->state = ShaderEntryState::Failed;
+  index->failureResult = failureResult;
+  index->failedNanos = getMonotonicNanos();
+  index->header.size = 0;
+  index->dataBlob = nullptr;
+  shard.lock.unlock();
+  shard.condition.notify_all();
+}
+
+// =====================================================================================================================
+// Returns the result code recorded for an entry in the Failed state. Returns ErrorUnknown if the entry left the
+// Failed state since it was looked up (for example because its TTL expired and another thread reclaimed it).
+//
+// @param hEntry : Handle of shader cache entry
+Result ShaderCache::getShaderFailureResult(CacheEntryHandle hEntry) {
+  auto *const index = static_cast<ShaderIndex *>(hEntry);
+  assert(index);
+  ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+  shard.lock.lock();
+  const Result result = index->state == ShaderEntryState::Failed ? index->failureResult : Result::ErrorUnknown;
+  shard.lock.unlock();
+  return result;
 }
 
 // =====================================================================================================================
-// Retrieves the shader from the cache which is identified by the specified entry handle.
+// Retrieves the shader from the cache which is identified by the specified entry handle. The returned pointer
+// refers directly into the cache's storage (or its file mapping) and stays valid until the cache is destroyed,
+// or - when an eviction budget is configured - until the entry goes unused long enough to be evicted.
 //
 // @param hEntry : Handle of shader cache entry
 // @param [out] ppBlob : Shader data
 // @param [out] size : size of shader data in bytes
 Result ShaderCache::retrieveShader(CacheEntryHandle hEntry, const void **ppBlob, size_t *size) {
-  const auto *const index = static_cast<ShaderIndex *>(hEntry);
-
   assert(m_disableCache == false);
+#if defined(__unix__)
+  if (m_shmBase)
+    return retrieveShaderFromSharedMemory(hEntry, ppBlob, size);
+#endif
+
+  auto *const index = static_cast<ShaderIndex *>(hEntry);
+
   assert(index);
+
+  if (m_cacheSizeBudget != 0) {
+    // With an eviction budget in place the entry may have been evicted between the lookup and this call; detect
+    // that under the owning shard's lock and let the caller fall back to compiling. Touching the entry also
+    // refreshes its position in the LRU list so the hot working set stays resident.
+    ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+    shard.lock.lock();
+    const bool ready = index->state == ShaderEntryState::Ready;
+    shard.lock.unlock();
+    if (!ready)
+      return Result::ErrorUnavailable;
+    touchLruEntry(index);
+  }
+
   assert(index->header.size >= sizeof(ShaderHeader));
 
-  lockCacheMap(true);
+  const size_t storedSize = index->header.size - sizeof(ShaderHeader);
+  if (index->header.uncompressedSize == storedSize) {
+    // The blob is stored uncompressed: hand out a zero-copy pointer into the cache storage.
+    *ppBlob = voidPtrInc(index->dataBlob, sizeof(ShaderHeader));
+    *size = storedSize;
+    return *size > 0 ? Result::Success : Result::ErrorUnknown;
+  }
 
-  *ppBlob = voidPtrInc(index->dataBlob, sizeof(ShaderHeader));
-  *size = index->header.size - sizeof(ShaderHeader);
+  // The blob is stored compressed; inflate it on first retrieval and keep the result so later calls are
+  // zero-copy again. The buffer is a plain heap allocation owned by the index - it must not come from
+  // getCacheSpace, whose allocations are charged to the serialized size even though these bytes are
+  // runtime-only and never part of the serialized form.
+  lockCacheMap(false);
+  if (!index->decompressedBlob) {
+    auto *mem = new uint8_t[index->header.uncompressedSize];
+    size_t uncompressedSize = index->header.uncompressedSize;
+    StringRef storedBlob(static_cast<const char *>(voidPtrInc(index->dataBlob, sizeof(ShaderHeader))), storedSize);
+    if (Error err = zlib::uncompress(storedBlob, reinterpret_cast<char *>(mem), uncompressedSize))
+      consumeError(std::move(err));
+    else if (uncompressedSize == index->header.uncompressedSize)
+      index->decompressedBlob = mem;
+    if (!index->decompressedBlob)
+      delete[] mem;
+  }
 
-  unlockCacheMap(true);
+  *ppBlob = index->decompressedBlob;
+  *size = index->decompressedBlob ? index->header.uncompressedSize : 0;
+  unlockCacheMap(false);
 
   return *size > 0 ? Result::Success : Result::ErrorUnknown;
 }
 
 // =====================================================================================================================
-// Adds data for a new shader to the on-disk file
+// Creates or attaches to the named shared-memory cache mapping. The mapping name folds in the executable name,
+// graphics IP and build ID, so only processes running a compatible LLPC build share a mapping. Returns a failure
+// if shared memory is unsupported or unavailable, in which case the caller falls back to runtime mode.
+//
+// @param auxCreateInfo : Shader cache auxiliary info (static fields)
+Result ShaderCache::initSharedMemory(const ShaderCacheAuxCreateInfo *auxCreateInfo) {
+#if defined(__unix__)
+  // Derive the mapping name from everything that affects blob compatibility.
+  BuildUniqueId buildId;
+  getBuildTime(&buildId);
+  char idString[MaxFilePathLen];
+  snprintf(idString, MaxFilePathLen, "%s.%s.%u.%u.%u", auxCreateInfo->executableName, ClientStr,
+           auxCreateInfo->gfxIp.major, auxCreateInfo->gfxIp.minor, auxCreateInfo->gfxIp.stepping);
+  const unsigned nameHash = djbHash(idString, 0);
+  const uint64_t buildCrc = calculateCrc(reinterpret_cast<const uint8_t *>(&buildId), sizeof(buildId));
+
+  char shmName[MaxFilePathLen];
+  snprintf(shmName, MaxFilePathLen, "/AMD_LlpcCache_%08x_%016llx", nameHash,
+           static_cast<unsigned long long>(buildCrc));
+
+  const uint32_t entryCapacity = std::max(64u, ShaderCacheShmEntries.getValue());
+  const size_t arenaSize = static_cast<size_t>(std::max(1u, ShaderCacheShmArenaMb.getValue())) * 1024 * 1024;
+  const size_t mappingSize = sizeof(ShmCacheHeader) + entryCapacity * sizeof(ShmCacheEntry) + arenaSize;
+
+  // Try to create the mapping; exactly one process wins the race and becomes responsible for initialization.
+  bool creator = true;
+  int fd = shm_open(shmName, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+  if (fd < 0 && errno == EEXIST) {
+    creator = false;
+    fd = shm_open(shmName, O_RDWR, 0);
+  }
+  if (fd < 0)
+    return Result::ErrorUnavailable;
+
+  if (creator && ftruncate(fd, mappingSize) != 0) {
+    close(fd);
+    shm_unlink(shmName);
+    return Result::ErrorUnavailable;
+  }
+
+  void *base = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+    return Result::ErrorUnavailable;
+
+  auto *header = static_cast<ShmCacheHeader *>(base);
+  if (creator) {
+    header->entryCapacity = entryCapacity;
+    header->entryCount = 0;
+    header->arenaSize = arenaSize;
+    header->arenaUsed = 0;
+
+    pthread_mutexattr_t mutexAttr;
+    pthread_mutexattr_init(&mutexAttr);
+    pthread_mutexattr_setpshared(&mutexAttr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mutexAttr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header->mutex, &mutexAttr);
+    pthread_mutexattr_destroy(&mutexAttr);
+
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&header->cond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+
+    // Publish the initialized mapping; attachers spin on the magic below.
+    __sync_synchronize();
+    header->magic = ShmCacheMagic;
+  } else {
+    // An attacher may get here before the creator finished initializing; wait for the magic to appear, but
+    // give up rather than hang if the creator died mid-initialization.
+    for (unsigned attempt = 0; header->magic != ShmCacheMagic; ++attempt) {
+      if (attempt > 1000) {
+        munmap(base, mappingSize);
+        return Result::ErrorUnavailable;
+      }
+      usleep(1000);
+    }
+    if (header->entryCapacity == 0 || sizeof(ShmCacheHeader) + header->entryCapacity * sizeof(ShmCacheEntry) +
+                                              header->arenaSize !=
+                                          mappingSize) {
+      // The mapping was created with different sizing options; we can't use it.
+      munmap(base, mappingSize);
+      return Result::ErrorUnavailable;
+    }
+  }
+
+  m_shmBase = base;
+  m_shmSize = mappingSize;
+  return Result::Success;
+#else
+  (void(auxCreateInfo)); // unused
+  return Result::ErrorUnavailable;
+#endif
+}
+
+#if defined(__unix__)
+// =====================================================================================================================
+// Shared-memory flavor of findShader: probes the open-addressed index in the mapping under the process-shared
+// mutex and runs the same New/Compiling/Ready state machine as the in-process cache, except that a Compiling
+// entry may be owned by another process. Entry handles are pointers to slots in the mapping.
+//
+// @param hashKey : Compacted hash key of the shader
+// @param allocateOnMiss : Whether allocate a new entry for new hash
+// @param [out] phEntry : Handle of shader cache entry
+ShaderEntryState ShaderCache::findShaderInSharedMemory(uint64_t hashKey, bool allocateOnMiss,
+                                                       CacheEntryHandle *phEntry) {
+  auto *header = static_cast<ShmCacheHeader *>(m_shmBase);
+  auto *entries = reinterpret_cast<ShmCacheEntry *>(header + 1);
+
+  lockSharedCacheMutex(header);
+
+  // Linear probe; slots are never freed, so probing can stop at the first free slot.
+  ShmCacheEntry *entry = nullptr;
+  const unsigned capacity = header->entryCapacity;
+  for (unsigned probe = 0; probe < capacity; ++probe) {
+    ShmCacheEntry *candidate = &entries[(hashKey + probe) % capacity];
+    if (candidate->key == 0) {
+      // Free slot: the shader is not in the cache. Keep one slot free so probing always terminates.
+      if (allocateOnMiss && header->entryCount + 1 < capacity) {
+        candidate->key = hashKey;
+        candidate->state = static_cast<uint32_t>(ShaderEntryState::New);
+        ++header->entryCount;
+        entry = candidate;
+      }
+      break;
+    }
+    if (candidate->key == hashKey) {
+      entry = candidate;
+      break;
+    }
+  }
+
+  if (!entry) {
+    pthread_mutex_unlock(&header->mutex);
+    *phEntry = nullptr;
+    return ShaderEntryState::Unavailable;
+  }
+
+  // Wait while some other process compiles the shader. If the owner dies the entry stays Compiling forever,
+  // so after enough timeouts we steal it and recompile ourselves.
+  unsigned timeouts = 0;
+  while (entry->state == static_cast<uint32_t>(ShaderEntryState::Compiling)) {
+    if (++timeouts > 10) {
+      entry->state = static_cast<uint32_t>(ShaderEntryState::New);
+      break;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    ++deadline.tv_sec;
+    if (pthread_cond_timedwait(&header->cond, &header->mutex, &deadline) == EOWNERDEAD)
+      pthread_mutex_consistent(&header->mutex);
+  }
+
+  if (entry->state == static_cast<uint32_t>(ShaderEntryState::New))
+    entry->state = static_cast<uint32_t>(ShaderEntryState::Compiling);
+
+  *phEntry = entry;
+  ShaderEntryState result = static_cast<ShaderEntryState>(entry->state);
+
+  pthread_mutex_unlock(&header->mutex);
+  return result;
+}
+
+// =====================================================================================================================
+// Shared-memory flavor of insertShader: copies the blob into the shared arena and publishes the entry to every
+// process attached to the mapping. If the arena is exhausted the entry goes back to New, which degrades to
+// per-process recompiles rather than failing the build.
+//
+// @param hEntry : Handle of shader cache entry
+// @param blob : Shader data
+// @param size : Size of shader data in bytes
+void ShaderCache::insertShaderInSharedMemory(CacheEntryHandle hEntry, const void *blob, size_t size) {
+  auto *header = static_cast<ShmCacheHeader *>(m_shmBase);
+  auto *entry = static_cast<ShmCacheEntry *>(hEntry);
+  assert(entry && entry->state == static_cast<uint32_t>(ShaderEntryState::Compiling));
+
+  lockSharedCacheMutex(header);
+
+  if (header->arenaUsed + size <= header->arenaSize) {
+    const uint64_t offset =
+        sizeof(ShmCacheHeader) + header->entryCapacity * sizeof(ShmCacheEntry) + header->arenaUsed;
+    memcpy(voidPtrInc(m_shmBase, offset), blob, size);
+    header->arenaUsed += size;
+
+    entry->offset = offset;
+    entry->size = size;
+    entry->crc = calculateCrc(static_cast<const uint8_t *>(blob), size);
+    entry->state = static_cast<uint32_t>(ShaderEntryState::Ready);
+    m_statBytesStored.fetch_add(size, std::memory_order_relaxed);
+  } else
+    entry->state = static_cast<uint32_t>(ShaderEntryState::New);
+
+  pthread_cond_broadcast(&header->cond);
+  pthread_mutex_unlock(&header->mutex);
+}
+
+// =====================================================================================================================
+// Shared-memory flavor of resetShader; used when a compile fails.
+//
+// @param hEntry : Handle of shader cache entry
+void ShaderCache::resetShaderInSharedMemory(CacheEntryHandle hEntry) {
+  auto *header = static_cast<ShmCacheHeader *>(m_shmBase);
+  auto *entry = static_cast<ShmCacheEntry *>(hEntry);
+  assert(entry && entry->state == static_cast<uint32_t>(ShaderEntryState::Compiling));
+
+  lockSharedCacheMutex(header);
+  entry->state = static_cast<uint32_t>(ShaderEntryState::New);
+  entry->offset = 0;
+  entry->size = 0;
+  pthread_cond_broadcast(&header->cond);
+  pthread_mutex_unlock(&header->mutex);
+}
+
+// =====================================================================================================================
+// Shared-memory flavor of retrieveShader: validates the CRC and hands out a zero-copy pointer into the
+// shared arena, which stays valid for the lifetime of this cache object.
+//
+// @param hEntry : Handle of shader cache entry
+// @param [out] ppBlob : Shader data
+// @param [out] size : Size of shader data in bytes
+Result ShaderCache::retrieveShaderFromSharedMemory(CacheEntryHandle hEntry, const void **ppBlob, size_t *size) {
+  const auto *entry = static_cast<const ShmCacheEntry *>(hEntry);
+  assert(entry && entry->state == static_cast<uint32_t>(ShaderEntryState::Ready));
+
+  const void *blob = voidPtrInc(m_shmBase, entry->offset);
+  if (entry->size == 0 || calculateCrc(static_cast<const uint8_t *>(blob), entry->size) != entry->crc)
+    return Result::ErrorUnknown;
+
+  *ppBlob = blob;
+  *size = entry->size;
+  return Result::Success;
+}
+#endif
+
+// =====================================================================================================================
+// Adds data for a new shader to the on-disk file. With the write-behind thread running this just queues the shader;
+// the thread appends it to the file later, batched with any other shaders queued in the meantime.
 //
 // @param index : A new shader
-void ShaderCache::addShaderToFile(const ShaderIndex *index) {
+void ShaderCache::addShaderToFile(ShaderIndex *index) {
+  assert(m_onDiskFile.isOpen());
+
+  if (m_writeBehindThread.joinable()) {
+    // Pin the blob until the write-behind thread has serialized it; eviction skips entries with a pending
+    // write, so the thread can read them without further locking.
+    ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+    shard.lock.lock();
+    index->writePending = true;
+    shard.lock.unlock();
+    {
+      std::unique_lock<std::mutex> lock(m_writeQueueMutex);
+      m_writeQueue.push_back(index);
+    }
+    m_writeQueueCondition.notify_one();
+    return;
+  }
+
+  appendShadersToFile(&index, 1);
+}
+
+// =====================================================================================================================
+// Rewrites the stored compilerDigest of a revalidated entry in the on-disk file, in place. Routed through the
+// write-behind thread when it is running, since that thread owns the file position.
+//
+// @param fileOffset : Offset of the entry's ShaderHeader in the file
+void ShaderCache::patchCompilerDigestInFile(uint64_t fileOffset) {
+  assert(m_onDiskFile.isOpen());
+
+  if (m_writeBehindThread.joinable()) {
+    {
+      std::unique_lock<std::mutex> lock(m_writeQueueMutex);
+      m_digestPatchQueue.push_back(fileOffset);
+    }
+    m_writeQueueCondition.notify_one();
+    return;
+  }
+
+  m_onDiskFile.seek(static_cast<unsigned>(fileOffset + offsetof(struct ShaderHeader, compilerDigest)), true);
+  m_onDiskFile.write(&m_compilerDigest, sizeof(m_compilerDigest));
+  m_onDiskFile.flush();
+  updateIndexJournalDigest(fileOffset);
+}
+
+// =====================================================================================================================
+// Appends a batch of shaders to the on-disk file, coalescing their data blobs into a single write, and updates the
+// file header once for the whole batch.
+//
+// @param indices : Shaders to append
+// @param count : Number of shaders in the batch
+void ShaderCache::appendShadersToFile(const ShaderIndex *const *indices, size_t count) {
+  CompileTraceSpan traceSpan("appendCacheFile");
+
   assert(m_onDiskFile.isOpen());
 
   // We only need to update the parts of the file that changed, which is the number of shaders, the new data section,
@@ -637,21 +1531,278 @@ void ShaderCache::addShaderToFile(const ShaderIndex *index) {
   const unsigned shaderCountOffset = offsetof(struct ShaderCacheSerializedHeader, shaderCount);
   const unsigned dataEndOffset = offsetof(struct ShaderCacheSerializedHeader, shaderDataEnd);
 
+  size_t batchSize = 0;
+  for (size_t i = 0; i < count; ++i)
+    batchSize += indices[i]->header.size;
+
+  // Coalesce the batch into one contiguous staging buffer so the data section grows with a single write.
+  auto stagingBuffer = std::make_unique<uint8_t[]>(batchSize);
+  size_t stagingOffset = 0;
+  for (size_t i = 0; i < count; ++i) {
+    memcpy(&stagingBuffer[stagingOffset], indices[i]->dataBlob, indices[i]->header.size);
+    m_fileIndexRecords.push_back({indices[i]->header, m_shaderDataEnd + stagingOffset});
+    stagingOffset += indices[i]->header.size;
+  }
+
+  m_fileShaderCount += count;
   m_onDiskFile.seek(shaderCountOffset, true);
-  m_onDiskFile.write(&m_totalShaders, sizeof(size_t));
+  m_onDiskFile.write(&m_fileShaderCount, sizeof(size_t));
+
+  // Persist the current Bloom filter snapshot alongside the counts, so the next cold start of this file can
+  // reject misses straight from the header. The runtime filter may cover entries not in the file (for example
+  // ones sourced from an external cache); the extra bits only cost the loader false positives.
+  const unsigned bloomOffset = offsetof(struct ShaderCacheSerializedHeader, bloomFilter);
+  uint64_t bloomSnapshot[BloomFilterWords];
+  for (unsigned word = 0; word < BloomFilterWords; ++word)
+    bloomSnapshot[word] = m_bloomFilter[word].load(std::memory_order_relaxed);
+  m_onDiskFile.seek(bloomOffset, true);
+  m_onDiskFile.write(bloomSnapshot, sizeof(bloomSnapshot));
 
   // Write the new shader data at the current end of the data section
   m_onDiskFile.seek(static_cast<unsigned>(m_shaderDataEnd), true);
-  m_onDiskFile.write(index->dataBlob, index->header.size);
+  m_onDiskFile.write(stagingBuffer.get(), batchSize);
 
   // Then update the data end value and write it out to the file.
-  m_shaderDataEnd += index->header.size;
+  m_shaderDataEnd += batchSize;
   m_onDiskFile.seek(dataEndOffset, true);
   m_onDiskFile.write(&m_shaderDataEnd, sizeof(size_t));
 
+  // Rewrite the index journal at the new end of the data section: a run of checksummed pages followed by a
+  // trailer locating them. The data blobs just written overwrote the previous run, so until this write lands the
+  // file has no valid trailer and a crash falls back to the data section scan, which recovers the valid prefix.
+  const size_t recordCount = m_fileIndexRecords.size();
+  const size_t pageCount = (recordCount + IndexPageRecordCount - 1) / IndexPageRecordCount;
+  const size_t journalSize = pageCount * sizeof(IndexPage) + sizeof(IndexTrailer);
+  auto journalBuffer = std::make_unique<uint8_t[]>(journalSize);
+  memset(journalBuffer.get(), 0, journalSize);
+  for (size_t page = 0; page < pageCount; ++page) {
+    auto *indexPage = reinterpret_cast<IndexPage *>(journalBuffer.get() + page * sizeof(IndexPage));
+    const size_t pageRecords = std::min<size_t>(recordCount - page * IndexPageRecordCount, IndexPageRecordCount);
+    memcpy(indexPage->records, &m_fileIndexRecords[page * IndexPageRecordCount],
+           pageRecords * sizeof(IndexPageRecord));
+    indexPage->recordCount = pageRecords;
+    indexPage->checksum =
+        calculateCrc(reinterpret_cast<const uint8_t *>(indexPage->records), pageRecords * sizeof(IndexPageRecord));
+  }
+  auto *trailer = reinterpret_cast<IndexTrailer *>(journalBuffer.get() + pageCount * sizeof(IndexPage));
+  trailer->magic = IndexTrailerMagic;
+  trailer->indexOffset = m_shaderDataEnd;
+  trailer->pageCount = pageCount;
+  trailer->shaderCount = recordCount;
+  trailer->checksum = calculateCrc(reinterpret_cast<const uint8_t *>(trailer), offsetof(IndexTrailer, checksum));
+  m_onDiskFile.seek(static_cast<unsigned>(m_shaderDataEnd), true);
+  m_onDiskFile.write(journalBuffer.get(), journalSize);
+
   m_onDiskFile.flush();
 }
 
+// =====================================================================================================================
+// Starts the background thread that services the write-behind queue.
+void ShaderCache::startWriteBehindThread() {
+  assert(!m_writeBehindThread.joinable());
+  m_writeBehindExit = false;
+  m_writeBehindThread = std::thread(&ShaderCache::writeBehindLoop, this);
+}
+
+// =====================================================================================================================
+// Asks the write-behind thread to drain its queue and exit, then joins it. Safe to call with no thread running.
+void ShaderCache::stopWriteBehindThread() {
+  if (!m_writeBehindThread.joinable())
+    return;
+
+  {
+    std::unique_lock<std::mutex> lock(m_writeQueueMutex);
+    m_writeBehindExit = true;
+  }
+  m_writeQueueCondition.notify_one();
+  m_writeBehindThread.join();
+}
+
+// =====================================================================================================================
+// Main loop of the write-behind thread: waits for queued shaders and appends each accumulated batch to the
+// on-disk file with a single coalesced write. Drains the queue before honoring an exit request.
+void ShaderCache::writeBehindLoop() {
+  std::unique_lock<std::mutex> lock(m_writeQueueMutex);
+  for (;;) {
+    m_writeQueueCondition.wait(
+        lock, [this] { return m_writeBehindExit || !m_writeQueue.empty() || !m_digestPatchQueue.empty(); });
+
+    if (m_writeQueue.empty() && m_digestPatchQueue.empty()) {
+      if (m_writeBehindExit)
+        break;
+      continue;
+    }
+
+    // Take the whole queue in one go; everything queued since the last pass becomes a single file append.
+    std::vector<ShaderIndex *> batch;
+    batch.swap(m_writeQueue);
+    std::vector<uint64_t> patches;
+    patches.swap(m_digestPatchQueue);
+
+    lock.unlock();
+
+    // Rewrite the compilerDigest of revalidated entries in place.
+    for (uint64_t fileOffset : patches) {
+      m_onDiskFile.seek(static_cast<unsigned>(fileOffset + offsetof(struct ShaderHeader, compilerDigest)), true);
+      m_onDiskFile.write(&m_compilerDigest, sizeof(m_compilerDigest));
+      updateIndexJournalDigest(fileOffset);
+    }
+    if (!patches.empty() && batch.empty())
+      m_onDiskFile.flush();
+
+    if (!batch.empty())
+      appendShadersToFile(batch.data(), batch.size());
+
+    // The blobs are on disk now; unpin the entries so they become eligible for eviction again.
+    for (ShaderIndex *index : batch) {
+      ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+      shard.lock.lock();
+      index->writePending = false;
+      shard.lock.unlock();
+    }
+
+    lock.lock();
+  }
+}
+
+// =====================================================================================================================
+// Ingests a manifest of shader hashes and schedules the matching cache entries for background warm-up.
+//
+// The index is probed synchronously, in manifest order, so the caller learns immediately which shaders the cache
+// cannot serve: hashes with no ready entry are appended to missingHashes (when non-null) and are candidates for an
+// ahead-of-time compile. Entries that are present are handed to a background thread that pages their stored bytes
+// in and inflates compressed blobs, so the first real lookup is a memory-speed hit. Returns the number of entries
+// scheduled for warm-up.
+//
+// @param hashes : Shader hashes from the manifest, in the order they are expected to be needed
+// @param [out] missingHashes : If non-null, receives the manifest hashes that have no usable cache entry
+size_t ShaderCache::prefetchShaders(ArrayRef<MetroHash::Hash> hashes, std::vector<MetroHash::Hash> *missingHashes) {
+  if (m_disableCache)
+    return 0;
+#if defined(__unix__)
+  // In shared-memory mode the blobs already live in the node-wide mapping, so there is nothing to warm.
+  if (m_shmBase)
+    return 0;
+#endif
+
+  std::vector<ShaderIndex *> found;
+  found.reserve(hashes.size());
+
+  for (const MetroHash::Hash &hash : hashes) {
+    const uint64_t hashKey = MetroHash::compact64(&hash);
+    ShaderIndexShard &shard = getShaderIndexShard(hashKey);
+
+    // Definite misses are rejected by the Bloom filter without touching the shard.
+    if (!mayContainKey(hashKey)) {
+      if (missingHashes)
+        missingHashes->push_back(hash);
+      continue;
+    }
+
+    shard.lock.lock();
+    auto indexMap = shard.map.find(hashKey);
+    ShaderIndex *const index =
+        indexMap != shard.map.end() && indexMap->second->state == ShaderEntryState::Ready ? indexMap->second : nullptr;
+    shard.lock.unlock();
+
+    if (index)
+      found.push_back(index);
+    else if (missingHashes)
+      missingHashes->push_back(hash);
+  }
+
+  if (!found.empty()) {
+    {
+      std::unique_lock<std::mutex> lock(m_prefetchQueueMutex);
+      if (!m_prefetchThread.joinable())
+        startPrefetchThread();
+      m_prefetchQueue.insert(m_prefetchQueue.end(), found.begin(), found.end());
+    }
+    m_prefetchQueueCondition.notify_one();
+  }
+
+  return found.size();
+}
+
+// =====================================================================================================================
+// Warms one cache entry: touches every page of its stored bytes so file-backed data is read ahead into memory, and
+// inflates compressed blobs so that the first retrieveShader call is zero-copy.
+//
+// @param index : Shader index to warm
+void ShaderCache::warmShader(ShaderIndex *index) {
+  // The entry may have been evicted since it was scheduled; re-check under the owning shard's lock. Refreshing
+  // the LRU position afterwards keeps the blob inside the eviction idle window while it is being touched, the
+  // same guarantee retrieveShader relies on for its zero-copy pointers.
+  ShaderIndexShard &shard = getShaderIndexShard(index->header.key);
+  shard.lock.lock();
+  const bool ready = index->state == ShaderEntryState::Ready && index->dataBlob;
+  shard.lock.unlock();
+  if (!ready)
+    return;
+
+  if (m_cacheSizeBudget != 0)
+    touchLruEntry(index);
+
+  // Touch every page of the stored blob. For entries backed by the on-disk file mapping this faults the pages
+  // in ahead of use; for resident blobs it is a cheap no-op.
+  const auto *const data = static_cast<const volatile uint8_t *>(index->dataBlob);
+  constexpr size_t PageSize = 4096;
+  for (size_t offset = 0; offset < index->header.size; offset += PageSize)
+    (void)data[offset];
+
+  // Inflate compressed blobs through the regular retrieval path, which caches the result on the entry.
+  const size_t storedSize = index->header.size - sizeof(ShaderHeader);
+  if (index->header.uncompressedSize != storedSize) {
+    const void *blob = nullptr;
+    size_t size = 0;
+    retrieveShader(index, &blob, &size);
+  }
+}
+
+// =====================================================================================================================
+// Starts the background thread that warms prefetched cache entries.
+void ShaderCache::startPrefetchThread() {
+  assert(!m_prefetchThread.joinable());
+  m_prefetchExit = false;
+  m_prefetchThread = std::thread(&ShaderCache::prefetchLoop, this);
+}
+
+// =====================================================================================================================
+// Asks the prefetch thread to exit, then joins it. Safe to call with no thread running. Unlike the write-behind
+// queue the prefetch queue is not drained first; an unwarmed entry only costs its first lookup some page faults.
+void ShaderCache::stopPrefetchThread() {
+  if (!m_prefetchThread.joinable())
+    return;
+
+  {
+    std::unique_lock<std::mutex> lock(m_prefetchQueueMutex);
+    m_prefetchExit = true;
+  }
+  m_prefetchQueueCondition.notify_one();
+  m_prefetchThread.join();
+}
+
+// =====================================================================================================================
+// Main loop of the prefetch thread: waits for scheduled entries and warms them in the order they were queued,
+// which is the manifest order the client expects to need them in.
+void ShaderCache::prefetchLoop() {
+  std::unique_lock<std::mutex> lock(m_prefetchQueueMutex);
+  for (;;) {
+    m_prefetchQueueCondition.wait(lock, [this] { return m_prefetchExit || !m_prefetchQueue.empty(); });
+
+    if (m_prefetchExit)
+      break;
+
+    std::vector<ShaderIndex *> batch;
+    batch.swap(m_prefetchQueue);
+
+    lock.unlock();
+    for (ShaderIndex *index : batch)
+      warmShader(index);
+    lock.lock();
+  }
+}
+
 // =====================================================================================================================
 // Loads all shader data from the cache file into the local cache copy. Returns true if the file contents were loaded
 // successfully or false if invalid data was found.
@@ -659,6 +1810,8 @@ void ShaderCache::addShaderToFile(const ShaderIndex *index) {
 // NOTE: This function assumes that a write lock has already been taken by the calling function and that the on-disk
 // file has been successfully opened and the file position is the beginning of the file.
 Result ShaderCache::loadCacheFromFile() {
+  CompileTraceSpan traceSpan("loadCacheFile");
+
   assert(m_onDiskFile.isOpen());
 
   // Read the header from the file and validate it
@@ -671,15 +1824,26 @@ Result ShaderCache::loadCacheFromFile() {
   Result result = validateAndLoadHeader(&header, fileSize);
 
   void *dataMem = nullptr;
-  if (result == Result::Success) {
-    // The header is valid, so allocate space to fit all of the shader data.
-    dataMem = getCacheSpace(dataSize);
+  if (result == Result::Success && ShaderCacheMmap) {
+    // Zero-copy mode: map the cache file read-only and let the shader indices point straight into the mapping.
+    // New shaders added during this run are still appended through the file handle; the region covered by the
+    // mapping is never rewritten in place, only the header fields in front of it.
+    auto bufferOrErr = MemoryBuffer::getFile(m_fileFullPath, -1, /*RequiresNullTerminator=*/false);
+    if (bufferOrErr && (*bufferOrErr)->getBufferSize() == fileSize) {
+      m_onDiskMapping = std::move(*bufferOrErr);
+      dataMem = voidPtrInc(const_cast<char *>(m_onDiskMapping->getBufferStart()),
+                           sizeof(ShaderCacheSerializedHeader));
+      m_serializedSize += dataSize;
+    }
   }
 
-  if (result == Result::Success) {
+  if (result == Result::Success && !dataMem) {
+    // Read mode: allocate space to fit all of the shader data and read it from the file.
+    dataMem = getCacheSpace(dataSize);
     if (dataMem) {
       // Read the shader data into the allocated memory.
       m_onDiskFile.seek(sizeof(ShaderCacheSerializedHeader), true);
+      m_onDiskFile.adviseSequentialRead(dataSize);
       size_t bytesRead = 0;
       result = m_onDiskFile.read(dataMem, dataSize, &bytesRead);
 
@@ -691,12 +1855,16 @@ Result ShaderCache::loadCacheFromFile() {
   }
 
   if (result == Result::Success) {
-    // Now setup the shader index hash map.
-    result = populateIndexMap(dataMem, dataSize);
+    // Now set up the shader index hash map. Prefer the index journal at the tail of the file, which costs
+    // reads proportional to the index rather than the data section. Fall back to scanning the data section
+    // for files written before the journal existed, or whose last append was torn by a crash.
+    if (loadIndexJournal(dataMem, fileSize) != Result::Success)
+      result = populateIndexMap(dataMem, dataSize, /*recoverTruncated=*/true);
   }
 
   if (result != Result::Success) {
-    // Something went wrong in loading the file, so reset it
+    // Something went wrong in loading the file, so drop any mapping of it and reset it
+    m_onDiskMapping.reset();
     resetCacheFile();
   }
 
@@ -726,7 +1894,7 @@ Result ShaderCache::loadCacheFromBlob(const void *initialData, size_t initialDat
     if (dataMem) {
       // Then copy the data and setup the shader index hash map.
       memcpy(dataMem, voidPtrInc(initialData, header->headerSize), dataSize);
-      result = populateIndexMap(dataMem, dataSize);
+      result = populateIndexMap(dataMem, dataSize, /*recoverTruncated=*/false);
     } else
       result = Result::ErrorOutOfMemory;
   }
@@ -736,11 +1904,15 @@ Result ShaderCache::loadCacheFromBlob(const void *initialData, size_t initialDat
 
 // =====================================================================================================================
 // Validates shader data (from a file or a blob) by checking the CRCs and adding index hash map entries if successful.
-// Will return a failure if any of the shader data is invalid.
+//
+// With recoverTruncated set (the on-disk file path), a record that fails its bounds or CRC check ends the scan but
+// keeps the valid prefix: the in-memory counts shrink to match and the next append heals the file in place, rather
+// than the whole file being discarded. Without it (the client blob path), any invalid record fails the whole load.
 //
 // @param dataStart : Start pointer of cached shader data
 // @param dataSize : Shader data size in bytes
-Result ShaderCache::populateIndexMap(void *dataStart, size_t dataSize) {
+// @param recoverTruncated : Whether to keep the valid prefix when a torn or corrupt record is found
+Result ShaderCache::populateIndexMap(void *dataStart, size_t dataSize, bool recoverTruncated) {
   Result result = Result::Success;
 
   // Iterate through all of the entries to verify the data CRC, zero out the GPU memory pointer/offset and add to the
@@ -748,39 +1920,187 @@ Result ShaderCache::populateIndexMap(void *dataStart, size_t dataSize) {
   // take the hit each time we add shader data to the file.
   auto *header = static_cast<ShaderHeader *>(dataStart);
 
-  for (unsigned shader = 0; (shader < m_totalShaders && result == Result::Success); ++shader) {
-    // Guard against buffer overruns.
-    assert(voidPtrDiff(header, dataStart) <= dataSize);
+  // The data section ends at m_shaderDataEnd; with an index journal appended behind it, dataSize can be larger.
+  const size_t dataLimit = std::min(dataSize, m_shaderDataEnd - sizeof(ShaderCacheSerializedHeader));
+
+  if (recoverTruncated)
+    m_fileIndexRecords.clear();
+
+  size_t validShaders = 0;
+  for (unsigned shader = 0; shader < m_totalShaders; ++shader) {
+    const size_t offset = voidPtrDiff(header, dataStart);
 
     // TODO: Add a static function to RelocatableShader to validate the input data.
 
+    // Guard against buffer overruns: a record that runs past the data section means the tail was torn.
+    if (offset + sizeof(ShaderHeader) > dataLimit || header->size < sizeof(ShaderHeader) ||
+        offset + header->size > dataLimit) {
+      if (!recoverTruncated)
+        result = Result::ErrorUnknown;
+      break;
+    }
+
     // The serialized data blob representing each RelocatableShader object immediately follows the header.
     void *const dataBlob = (header + 1);
 
     // Verify the CRC
     const uint64_t crc = calculateCrc(static_cast<uint8_t *>(dataBlob), (header->size - sizeof(ShaderHeader)));
+    if (crc != header->crc) {
+      if (!recoverTruncated)
+        result = Result::ErrorUnknown;
+      break;
+    }
 
-    if (crc == header->crc) {
-      // It all checks out, so add this shader to the hash map!
-      ShaderIndex *index = nullptr;
-      auto indexMap = m_shaderIndexMap.find(header->key);
-      if (indexMap == m_shaderIndexMap.end()) {
-        index = new ShaderIndex;
-        index->header = (*header);
-        index->dataBlob = header;
-        index->state = ShaderEntryState::Ready;
-        m_shaderIndexMap[header->key] = index;
-      }
+    // It all checks out, so add this shader to the hash map! When the same key occurs more than once the
+    // later entry wins: an upgrade appends the recompiled blob for a changed shader behind the stale one.
+    ShaderIndex *index = nullptr;
+    ShaderIndexShard &shard = getShaderIndexShard(header->key);
+    addToBloomFilter(header->key);
+    shard.lock.lock();
+    auto indexMap = shard.map.find(header->key);
+    if (indexMap == shard.map.end()) {
+      index = new ShaderIndex;
+      memset(index, 0, sizeof(*index));
+      shard.map[header->key] = index;
     } else
-      result = Result::ErrorUnknown;
+      index = indexMap->second;
+    index->header = (*header);
+    index->dataBlob = header;
+    index->fileOffset = sizeof(ShaderCacheSerializedHeader) + offset;
+    if (header->compilerDigest == m_compilerDigest) {
+      index->state = ShaderEntryState::Ready;
+      index->staleVersion = false;
+    } else {
+      // The blob came from a different compiler build. Keep its bytes for revalidation, but treat the entry
+      // as a miss so the first use recompiles it; insertShader then decides whether the stored blob can be
+      // kept or must be replaced.
+      index->state = ShaderEntryState::New;
+      index->staleVersion = true;
+    }
+    shard.lock.unlock();
+
+    if (recoverTruncated)
+      m_fileIndexRecords.push_back({*header, index->fileOffset});
+
+    ++validShaders;
 
     // Move to next entry in cache
     header = static_cast<ShaderHeader *>(voidPtrInc(header, header->size));
   }
 
+  if (result == Result::Success && validShaders != m_totalShaders) {
+    // Crash recovery: keep the valid prefix. The next append rewrites the file header, the torn tail and the
+    // index journal from these counts, healing the file in place.
+    m_totalShaders = validShaders;
+    m_fileShaderCount = validShaders;
+    m_shaderDataEnd = sizeof(ShaderCacheSerializedHeader) + voidPtrDiff(header, dataStart);
+  }
+
   return result;
 }
 
+// =====================================================================================================================
+// Builds the shader index hash map from the index journal at the tail of the on-disk file, without reading the data
+// section. Returns a failure if the file carries no journal or its trailer, pages or records do not check out; the
+// caller then falls back to scanning the data section.
+//
+// NOTE: This function assumes the on-disk file is open and m_shaderDataEnd has been loaded from the file header.
+//
+// @param dataStart : Start pointer of cached shader data (the file contents behind the serialized header)
+// @param fileSize : Total size of the on-disk file in bytes
+Result ShaderCache::loadIndexJournal(void *dataStart, size_t fileSize) {
+  // The trailer is the last bytes of the file, directly behind the index pages, which in turn sit behind the
+  // data section.
+  if (fileSize < m_shaderDataEnd + sizeof(IndexTrailer))
+    return Result::ErrorUnknown;
+
+  IndexTrailer trailer = {};
+  m_onDiskFile.seek(static_cast<unsigned>(fileSize - sizeof(IndexTrailer)), true);
+  if (m_onDiskFile.read(&trailer, sizeof(trailer), nullptr) != Result::Success)
+    return Result::ErrorUnknown;
+
+  if (trailer.magic != IndexTrailerMagic ||
+      trailer.checksum != calculateCrc(reinterpret_cast<const uint8_t *>(&trailer), offsetof(IndexTrailer, checksum)) ||
+      trailer.indexOffset != m_shaderDataEnd ||
+      trailer.indexOffset + trailer.pageCount * sizeof(IndexPage) + sizeof(IndexTrailer) != fileSize)
+    return Result::ErrorUnknown;
+
+  // Read and verify the index pages.
+  auto pages = std::make_unique<IndexPage[]>(trailer.pageCount);
+  m_onDiskFile.seek(static_cast<unsigned>(trailer.indexOffset), true);
+  size_t bytesRead = 0;
+  if (m_onDiskFile.read(pages.get(), trailer.pageCount * sizeof(IndexPage), &bytesRead) != Result::Success ||
+      bytesRead != trailer.pageCount * sizeof(IndexPage))
+    return Result::ErrorUnknown;
+
+  std::vector<IndexPageRecord> records;
+  records.reserve(trailer.shaderCount);
+  for (uint64_t pageIdx = 0; pageIdx < trailer.pageCount; ++pageIdx) {
+    const IndexPage &page = pages[pageIdx];
+    if (page.recordCount > IndexPageRecordCount ||
+        page.checksum != calculateCrc(reinterpret_cast<const uint8_t *>(page.records),
+                                      page.recordCount * sizeof(IndexPageRecord)))
+      return Result::ErrorUnknown;
+    records.insert(records.end(), page.records, page.records + page.recordCount);
+  }
+  if (records.size() != trailer.shaderCount)
+    return Result::ErrorUnknown;
+
+  // Build the runtime index straight from the journal records. The blob bytes themselves are never touched;
+  // each record's stored CRC was verified when its blob was inserted, and still travels with the entry for a
+  // consumer that wants to check it. Duplicate keys keep the later record, like the data section scan.
+  for (const IndexPageRecord &record : records) {
+    if (record.fileOffset < sizeof(ShaderCacheSerializedHeader) || record.header.size < sizeof(ShaderHeader) ||
+        record.fileOffset + record.header.size > m_shaderDataEnd)
+      return Result::ErrorUnknown;
+
+    ShaderIndex *index = nullptr;
+    ShaderIndexShard &shard = getShaderIndexShard(record.header.key);
+    addToBloomFilter(record.header.key);
+    shard.lock.lock();
+    auto indexMap = shard.map.find(record.header.key);
+    if (indexMap == shard.map.end()) {
+      index = new ShaderIndex;
+      memset(index, 0, sizeof(*index));
+      shard.map[record.header.key] = index;
+    } else
+      index = indexMap->second;
+    index->header = record.header;
+    index->dataBlob = voidPtrInc(dataStart, record.fileOffset - sizeof(ShaderCacheSerializedHeader));
+    index->fileOffset = record.fileOffset;
+    if (record.header.compilerDigest == m_compilerDigest) {
+      index->state = ShaderEntryState::Ready;
+      index->staleVersion = false;
+    } else {
+      index->state = ShaderEntryState::New;
+      index->staleVersion = true;
+    }
+    shard.lock.unlock();
+  }
+
+  // The journal is authoritative for the counts: the file header may predate the final append of a run that
+  // completed its journal write.
+  m_totalShaders = records.size();
+  m_fileShaderCount = records.size();
+  m_fileIndexRecords = std::move(records);
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Updates the compilerDigest of a revalidated entry's record in the live index journal, so the next journal
+// rewrite persists it. Called on the thread that owns the file position. Patches are rare, so the linear scan
+// does not matter.
+//
+// @param fileOffset : Offset of the entry's ShaderHeader in the file
+void ShaderCache::updateIndexJournalDigest(uint64_t fileOffset) {
+  for (IndexPageRecord &record : m_fileIndexRecords) {
+    if (record.fileOffset == fileOffset) {
+      record.header.compilerDigest = m_compilerDigest;
+      break;
+    }
+  }
+}
+
 // =====================================================================================================================
 // Caclulates a 64-bit CRC of the data provided
 //
@@ -809,20 +2129,29 @@ Result ShaderCache::validateAndLoadHeader(const ShaderCacheSerializedHeader *hea
 
   Result result = Result::Success;
 
+  // Only the outer key - the serialized layout, graphics IP and compilation option hash - decides whether the
+  // file is usable at all. The build date/time deliberately take no part in this check: a file written by an
+  // older driver build loads fine, and populateIndexMap demotes its entries to revalidate-on-use through the
+  // per-entry compiler digest instead of the whole cache being discarded on every driver update.
   if (header->headerSize == sizeof(ShaderCacheSerializedHeader) &&
-      memcmp(header->buildId.buildDate, buildId.buildDate, sizeof(buildId.buildDate)) == 0 &&
-      memcmp(header->buildId.buildTime, buildId.buildTime, sizeof(buildId.buildTime)) == 0 &&
       memcmp(&header->buildId.gfxIp, &buildId.gfxIp, sizeof(buildId.gfxIp)) == 0 &&
       memcmp(&header->buildId.hash, &buildId.hash, sizeof(buildId.hash)) == 0) {
-    // The header appears valid so copy the header data to the runtime cache
+    // The header appears valid so copy the header data to the runtime cache. Seeding the runtime Bloom filter
+    // from the persisted one is strictly optional - populateIndexMap re-adds every key it accepts - but doing
+    // it here means probes racing with the load already benefit from the filter.
     m_totalShaders = header->shaderCount;
+    m_fileShaderCount = header->shaderCount;
     m_shaderDataEnd = header->shaderDataEnd;
+    for (unsigned word = 0; word < BloomFilterWords; ++word)
+      m_bloomFilter[word].fetch_or(header->bloomFilter[word], std::memory_order_relaxed);
   } else
     result = Result::ErrorUnknown;
 
   // Make sure the shader data end value is correct. It's ok for there to be unused space at the end of the file, but
-  // if the shaderDataEnd is beyond the end of the file we have a problem.
-  if (result == Result::Success && m_shaderDataEnd > dataSourceSize)
+  // if the shaderDataEnd is beyond the end of the file we have a problem. It must also cover at least the header
+  // itself, or it was corrupted.
+  if (result == Result::Success &&
+      (m_shaderDataEnd > dataSourceSize || m_shaderDataEnd < sizeof(ShaderCacheSerializedHeader)))
     result = Result::ErrorUnknown;
 
   return result;
@@ -840,6 +2169,147 @@ void *ShaderCache::getCacheSpace(size_t numBytes) {
   return p;
 }
 
+// =====================================================================================================================
+// Returns an allocation made by getCacheSpace to the system. This function assumes that a write lock has been taken
+// by the calling function.
+//
+// @param mem : Allocation to free; must have been returned by getCacheSpace
+void ShaderCache::freeCacheSpace(void *mem) {
+  for (auto it = m_allocationList.begin(); it != m_allocationList.end(); ++it) {
+    if (it->first == mem) {
+      m_serializedSize -= it->second;
+      // While a Serialize snapshot is assembling its frozen view the bytes must stay readable, so park the
+      // allocation on the deferred list; the last snapshot to finish reclaims it.
+      if (m_activeSnapshots != 0)
+        m_deferredFrees.push_back(*it);
+      else
+        delete[] it->first;
+      m_allocationList.erase(it);
+      return;
+    }
+  }
+
+  llvm_unreachable("Should never be called!");
+}
+
+// =====================================================================================================================
+// Adds a newly inserted evictable entry at the head of the LRU list and charges its size against the cache budget.
+//
+// @param index : Shader index to add; its blob must be individually releasable (a blob store reference or its own
+//                getCacheSpace allocation)
+void ShaderCache::addLruEntry(ShaderIndex *index) {
+  m_lruLock.lock();
+  index->lastUseNanos = getMonotonicNanos();
+  index->lruPrev = nullptr;
+  index->lruNext = m_lruHead;
+  if (m_lruHead)
+    m_lruHead->lruPrev = index;
+  m_lruHead = index;
+  if (!m_lruTail)
+    m_lruTail = index;
+  m_evictableDataSize += index->header.size;
+  m_lruLock.unlock();
+}
+
+// =====================================================================================================================
+// Moves an entry to the head of the LRU list on a cache hit. Entries that are not on the list (those backed by a
+// loaded cache file or the file mapping) are left alone.
+//
+// @param index : Shader index that was just hit
+void ShaderCache::touchLruEntry(ShaderIndex *index) {
+  m_lruLock.lock();
+  if (index->lruPrev || index->lruNext || m_lruHead == index) {
+    index->lastUseNanos = getMonotonicNanos();
+    if (m_lruHead != index) {
+      // Unlink the entry and relink it at the head.
+      index->lruPrev->lruNext = index->lruNext;
+      if (index->lruNext)
+        index->lruNext->lruPrev = index->lruPrev;
+      else
+        m_lruTail = index->lruPrev;
+
+      index->lruPrev = nullptr;
+      index->lruNext = m_lruHead;
+      m_lruHead->lruPrev = index;
+      m_lruHead = index;
+    }
+  }
+  m_lruLock.unlock();
+}
+
+// =====================================================================================================================
+// Unlinks an entry from the LRU list and refunds its size. The caller must hold m_lruLock.
+//
+// @param index : Shader index to remove
+void ShaderCache::removeLruEntry(ShaderIndex *index) {
+  if (index->lruPrev)
+    index->lruPrev->lruNext = index->lruNext;
+  else
+    m_lruHead = index->lruNext;
+
+  if (index->lruNext)
+    index->lruNext->lruPrev = index->lruPrev;
+  else
+    m_lruTail = index->lruPrev;
+
+  index->lruPrev = nullptr;
+  index->lruNext = nullptr;
+  m_evictableDataSize -= index->header.size;
+}
+
+// =====================================================================================================================
+// Evicts least recently used entries until the evictable shader data fits the configured byte budget again. Evicted
+// entries stay in the index map in the New state, so a later lookup simply recompiles them. This function assumes
+// that a write lock has been taken by the calling function; it additionally takes m_lruLock and then the owning
+// shard's lock for each candidate.
+void ShaderCache::enforceCacheBudget() {
+  // Entries used within this window are never evicted; a caller that just got a Ready entry from findShader may
+  // still be reading the blob through the zero-copy pointer handed out by retrieveShader.
+  constexpr uint64_t MinEvictionIdleNanos = 1000000000ull;
+
+  const uint64_t nowNanos = getMonotonicNanos();
+
+  m_lruLock.lock();
+
+  ShaderIndex *candidate = m_lruTail;
+  while (m_evictableDataSize > m_cacheSizeBudget && candidate) {
+    ShaderIndex *const prev = candidate->lruPrev;
+
+    // The list is ordered by recency, so once the tail end reaches entries that are too young to evict every
+    // remaining entry is too; the budget is enforced on a best-effort basis during such bursts.
+    if (nowNanos - candidate->lastUseNanos < MinEvictionIdleNanos)
+      break;
+
+    ShaderIndexShard &shard = getShaderIndexShard(candidate->header.key);
+    shard.lock.lock();
+    // Skip entries another thread is racing on: a claimed compile owns the entry, and a blob queued for the
+    // write-behind thread is still being read from.
+    if (candidate->state == ShaderEntryState::Ready && !candidate->writePending) {
+      removeLruEntry(candidate);
+      delete[] static_cast<uint8_t *>(candidate->decompressedBlob);
+      if (candidate->storeBacked) {
+        ShaderCacheManager::getShaderCacheManager()->getBlobStore().release(candidate->dataBlob,
+                                                                            candidate->header.size);
+        candidate->storeBacked = false;
+        m_serializedSize -= candidate->header.size;
+      } else
+        freeCacheSpace(candidate->dataBlob);
+      candidate->dataBlob = nullptr;
+      candidate->decompressedBlob = nullptr;
+      candidate->header.size = 0;
+      candidate->header.uncompressedSize = 0;
+      candidate->state = ShaderEntryState::New;
+      --m_totalShaders;
+      m_statEvictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.lock.unlock();
+
+    candidate = prev;
+  }
+
+  m_lruLock.unlock();
+}
+
 // =====================================================================================================================
 // Returns the time & date that pipeline.cpp was compiled.
 //
@@ -34,19 +34,31 @@
 #include "llpcFile.h"
 #include "llpcUtil.h"
 #include "vkgcMetroHash.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace Llpc {
 
 // Header data that is stored with each shader in the cache.
 struct ShaderHeader {
-  uint64_t key; // Compacted hash key used to identify shaders
-  uint64_t crc; // CRC of the shader cache entry, used to detect data corruption.
-  size_t size;  // Total size of the shader data in the storage file
+  uint64_t key;            // Compacted hash key used to identify shaders
+  uint64_t crc;            // CRC of the shader cache entry, used to detect data corruption.
+  size_t size;             // Total size of the shader data in the storage file
+  size_t uncompressedSize; // Size of the shader blob before compression; equal to (size - sizeof(ShaderHeader))
+                           // when the blob is stored uncompressed
+  uint64_t compilerDigest; // Digest of the compiler build that produced this entry's blob. Entries whose digest
+                           // does not match the running compiler are kept across a driver update but must be
+                           // revalidated by a recompile before they can be served again.
 };
 
 // Enum defining the states a shader cache entry can be in
@@ -55,6 +67,8 @@ enum class ShaderEntryState : unsigned {
   Compiling = 1,   // An entry was created and must be compiled/populated by the caller
   Ready = 2,       // A matching shader was found and is ready for use
   Unavailable = 3, // Entry doesn't exist in cache
+  Failed = 4,      // A recent compile of this shader failed; the recorded failure result applies until the
+                   //  entry's TTL expires
 };
 
 // Enumerates modes used in shader cache.
@@ -64,6 +78,8 @@ enum ShaderCacheMode {
   ShaderCacheEnableOnDisk = 2,             // Enabled with on-disk file
   ShaderCacheForceInternalCacheOnDisk = 3, // Force to use internal cache on disk
   ShaderCacheEnableOnDiskReadOnly = 4,     // Only read on-disk file with write-protection
+  ShaderCacheEnableSharedMemory = 5,       // Enabled with named shared-memory mapping shared across processes
+                                           // (unix only; falls back to runtime mode elsewhere)
 };
 
 // Stores data in the hash map of cached shaders and helps correlated a shader in the hash to a location in the
@@ -72,11 +88,48 @@ struct ShaderIndex {
   ShaderHeader header;             // Shader header data (key, crc, size)
   volatile ShaderEntryState state; // Shader entry state
   void *dataBlob;                  // Serialized data blob representing a cached RelocatableShader object.
+  void *decompressedBlob;          // Lazily inflated copy of dataBlob when the blob is stored compressed; a
+                                   // plain heap allocation owned by the index, runtime-only and never
+                                   // serialized, freed on eviction or cache teardown
+  uint64_t compileStartNanos;      // Time the entry was claimed for compiling, for miss-compile-time stats;
+                                   // runtime-only, never serialized
+  ShaderIndex *lruPrev;            // Previous (more recently used) entry in the cache's LRU list; null when the
+                                   // entry is not evictable or is the list head
+  ShaderIndex *lruNext;            // Next (less recently used) entry in the cache's LRU list
+  uint64_t lastUseNanos;           // Time the entry was last hit or inserted; entries used very recently are
+                                   // never evicted because the caller may still be reading the blob
+  bool writePending;               // Whether the entry is queued for the write-behind thread and its blob must
+                                   // not be evicted yet; guarded by the owning shard's lock
+  bool storeBacked;                // Whether dataBlob is a reference into the shared ShaderBlobStore rather than
+                                   // this cache's own allocation
+  bool staleVersion;               // Whether the entry's blob was produced by a different compiler build and is
+                                   // awaiting revalidation by a recompile
+  uint64_t fileOffset;             // Offset of the entry's ShaderHeader in the on-disk file, or 0 when the entry
+                                   // was not loaded from the file
+  Result failureResult;            // Result code of the failed compile while the entry is in the Failed state;
+                                   // runtime-only, never serialized
+  uint64_t failedNanos;            // Time the failure was recorded, for TTL expiry of Failed entries;
+                                   // runtime-only, never serialized
 };
 
 // The key in hash map is a 64-bit compacted Shader Hash
 typedef std::unordered_map<uint64_t, ShaderIndex *> ShaderIndexMap;
 
+// Number of independently locked shards the shader index map is split into. Concurrent lookups only contend when
+// two threads probe the same shard, so this should comfortably exceed the number of driver compile threads.
+static constexpr unsigned ShaderIndexShardCount = 32;
+
+// One shard of the shader index map. Each shard guards its own slice of the key space, including the entry state
+// of the indices it owns, so that cache-hit lookups on different shards never contend. Threads waiting for an
+// in-flight compile sleep on the owning shard's condition variable, so an insert only wakes the waiters of its
+// own shard rather than every waiter in the cache.
+struct ShaderIndexShard {
+  llvm::sys::Mutex lock;             // Lock for this shard's map and the state of the entries it owns
+  ShaderIndexMap map;                // Slice of the shader index map owned by this shard
+  std::mutex waitMutex;              // Mutex paired with condition for waits on an in-flight compile
+  std::condition_variable condition; // Signaled when an entry owned by this shard leaves the Compiling state
+};
+
 // Specifies auxiliary info necessary to create a shader cache object.
 struct ShaderCacheAuxCreateInfo {
   ShaderCacheMode shaderCacheMode; // Mode of shader cache
@@ -86,6 +139,20 @@ struct ShaderCacheAuxCreateInfo {
   const char *executableName;      // Name of executable file
 };
 
+// Size in bits of the Bloom filter kept over the compacted hash keys resident in the index map. 32K bits keep
+// the filter at 4 KiB while staying well below saturation for typical driver cache populations.
+static constexpr unsigned BloomFilterBits = 1 << 15;
+
+// Number of 64-bit words backing the Bloom filter
+static constexpr unsigned BloomFilterWords = BloomFilterBits / 64;
+
+// Number of filter bits probed per key; each probe uses a separate 15-bit slice of the compacted hash
+static constexpr unsigned BloomFilterProbes = 3;
+
+// How long a Failed entry keeps answering lookups with its recorded failure result before the next lookup is
+// allowed to retry the compile
+static constexpr uint64_t FailedEntryTtlNanos = 30ull * 1000 * 1000 * 1000;
+
 // Length of date field used in BuildUniqueId
 static constexpr uint8_t DateLength = 11;
 
@@ -110,8 +177,49 @@ struct ShaderCacheSerializedHeader {
   BuildUniqueId buildId; // Build time/date of the PAL version that created the cache file
   size_t shaderCount;    // Number of shaders in the shaderIndex array
   size_t shaderDataEnd;  // Offset to the end of shader data
+
+  // Bloom filter over the keys of the shaders stored in the file, so a cache loaded cold can reject misses
+  // before its index has been consulted
+  uint64_t bloomFilter[BloomFilterWords];
+};
+
+// Size in bytes of one page of the on-disk index journal
+static constexpr unsigned IndexPageSize = 4096;
+
+// One record of the on-disk index journal: everything needed to serve a cache entry without reading the data
+// section on open.
+struct IndexPageRecord {
+  ShaderHeader header; // Copy of the entry's ShaderHeader, including the per-record CRC of its blob
+  uint64_t fileOffset; // Offset of the entry's ShaderHeader in the data section of the file
+};
+
+// Number of records that fit in one index page behind the page's checksum and record count
+static constexpr unsigned IndexPageRecordCount =
+    (IndexPageSize - 2 * sizeof(uint64_t)) / sizeof(IndexPageRecord);
+
+// Fixed-size page of index records. The live index is a run of these pages written behind the data section
+// after each batch of blob appends; the next batch's blobs overwrite the stale run and a fresh run is written
+// behind them, so the data section itself stays append-only.
+struct IndexPage {
+  uint64_t checksum;                             // CRC of this page's records
+  uint64_t recordCount;                          // Number of valid records in this page
+  IndexPageRecord records[IndexPageRecordCount]; // Index records
+};
+
+static_assert(sizeof(IndexPage) <= IndexPageSize, "IndexPage must fit in one page");
+
+// Trailer locating the live index journal; always the last bytes of a journaled cache file
+struct IndexTrailer {
+  uint64_t magic;       // IndexTrailerMagic
+  uint64_t indexOffset; // File offset of the first index page; always the end of the data section
+  uint64_t pageCount;   // Number of index pages in the live run
+  uint64_t shaderCount; // Total records across the pages
+  uint64_t checksum;    // CRC of the preceding trailer fields
 };
 
+// Magic value identifying an index journal trailer ("LLPCJRNL")
+static constexpr uint64_t IndexTrailerMagic = 0x4C4E524A43504C4CULL;
+
 constexpr unsigned MaxFilePathLen = 512;
 
 typedef void *CacheEntryHandle;
@@ -131,14 +239,37 @@ public:
 
   virtual Result Merge(unsigned srcCacheCount, const IShaderCache **ppSrcCaches);
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  virtual void GetStats(ShaderCacheStats *pStats);
+
+  virtual Result Compact(unsigned hashCount, const uint64_t *pHashes);
+#endif
+
+  Result compactCacheFile(llvm::ArrayRef<uint64_t> manifest);
+
   ShaderEntryState findShader(MetroHash::Hash hash, bool allocateOnMiss, CacheEntryHandle *phEntry);
 
   void insertShader(CacheEntryHandle hEntry, const void *blob, size_t size);
 
   void resetShader(CacheEntryHandle hEntry);
 
+  void markShaderFailed(CacheEntryHandle hEntry, Result failureResult);
+
+  Result getShaderFailureResult(CacheEntryHandle hEntry);
+
+  // Returns true if the given failed compile result is deterministic enough to negative-cache: retrying the
+  // same build would fail the same way, so lookups within the failure entry's TTL can return the recorded
+  // result instead of re-paying the compile. Resource exhaustion is excluded because a retry under less
+  // memory pressure may well succeed.
+  static bool isCacheableFailure(Result result) {
+    return result == Result::ErrorInvalidShader || result == Result::ErrorInvalidValue ||
+           result == Result::Unsupported || result == Result::ErrorUnavailable;
+  }
+
   Result retrieveShader(CacheEntryHandle hEntry, const void **ppBlob, size_t *size);
 
+  size_t prefetchShaders(llvm::ArrayRef<MetroHash::Hash> hashes, std::vector<MetroHash::Hash> *missingHashes);
+
   bool isCompatible(const ShaderCacheCreateInfo *createInfo, const ShaderCacheAuxCreateInfo *auxCreateInfo);
 
 private:
@@ -149,14 +280,39 @@ private:
                        bool *cacheFileExists);
   Result validateAndLoadHeader(const ShaderCacheSerializedHeader *header, size_t dataSourceSize);
   Result loadCacheFromBlob(const void *initialData, size_t initialDataSize);
-  Result populateIndexMap(void *dataStart, size_t dataSize);
+  Result populateIndexMap(void *dataStart, size_t dataSize, bool recoverTruncated);
+  Result loadIndexJournal(void *dataStart, size_t fileSize);
+  void updateIndexJournalDigest(uint64_t fileOffset);
   uint64_t calculateCrc(const uint8_t *data, size_t numBytes);
 
+  Result initSharedMemory(const ShaderCacheAuxCreateInfo *auxCreateInfo);
+  ShaderEntryState findShaderInSharedMemory(uint64_t hashKey, bool allocateOnMiss, CacheEntryHandle *phEntry);
+  void insertShaderInSharedMemory(CacheEntryHandle hEntry, const void *blob, size_t size);
+  void resetShaderInSharedMemory(CacheEntryHandle hEntry);
+  Result retrieveShaderFromSharedMemory(CacheEntryHandle hEntry, const void **ppBlob, size_t *size);
+
   Result loadCacheFromFile();
   void resetCacheFile();
-  void addShaderToFile(const ShaderIndex *index);
+  void addShaderToFile(ShaderIndex *index);
+  void appendShadersToFile(const ShaderIndex *const *indices, size_t count);
+  void patchCompilerDigestInFile(uint64_t fileOffset);
+
+  void startWriteBehindThread();
+  void stopWriteBehindThread();
+  void writeBehindLoop();
+
+  void startPrefetchThread();
+  void stopPrefetchThread();
+  void prefetchLoop();
+  void warmShader(ShaderIndex *index);
 
   void *getCacheSpace(size_t numBytes);
+  void freeCacheSpace(void *mem);
+
+  void addLruEntry(ShaderIndex *index);
+  void touchLruEntry(ShaderIndex *index);
+  void removeLruEntry(ShaderIndex *index);
+  void enforceCacheBudget();
 
   // Lock cache map
   void lockCacheMap(bool readOnly) { m_lock.lock(); }
@@ -169,30 +325,121 @@ private:
   void resetRuntimeCache();
   void getBuildTime(BuildUniqueId *buildId);
 
-  llvm::sys::Mutex m_lock; // Read/Write lock for access to the shader cache hash map
+  // Returns a monotonic timestamp in nanoseconds for the statistics counters.
+  static uint64_t getMonotonicNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // Returns the index map shard that owns the given compacted hash key.
+  ShaderIndexShard &getShaderIndexShard(uint64_t hashKey) {
+    return m_shaderIndexShards[hashKey % ShaderIndexShardCount];
+  }
+
+  // Marks the given compacted hash key as resident in the Bloom filter.
+  void addToBloomFilter(uint64_t hashKey) {
+    for (unsigned probe = 0; probe < BloomFilterProbes; ++probe) {
+      const unsigned bit = (hashKey >> (probe * 15)) & (BloomFilterBits - 1);
+      m_bloomFilter[bit / 64].fetch_or(1ULL << (bit % 64), std::memory_order_relaxed);
+    }
+  }
+
+  // Returns false if the given compacted hash key is definitely not in the index map. Checked without taking
+  // any lock; a false positive just falls through to the locked probe.
+  bool mayContainKey(uint64_t hashKey) const {
+    for (unsigned probe = 0; probe < BloomFilterProbes; ++probe) {
+      const unsigned bit = (hashKey >> (probe * 15)) & (BloomFilterBits - 1);
+      if (!(m_bloomFilter[bit / 64].load(std::memory_order_relaxed) & (1ULL << (bit % 64))))
+        return false;
+    }
+    return true;
+  }
+
+  llvm::sys::Mutex m_lock; // Lock for the allocate-on-miss path and the cache's backing storage
   File m_onDiskFile;       // File for on-disk storage of the cache
   bool m_disableCache;     // Whether disable cache completely
-
-  // Map of shader index data which detail the hash, crc, size and CPU memory location for each shader
-  // in the cache.
-  ShaderIndexMap m_shaderIndexMap;
+  bool m_compressBlobs;    // Whether to deflate shader blobs before storing them
+
+  // Read-only mapping of the on-disk cache file. When present, shader indices built at load time point
+  // straight into the mapping and retrieveShader hands out zero-copy pointers into the mapped region.
+  std::unique_ptr<llvm::MemoryBuffer> m_onDiskMapping;
+
+  // Base and size of the named shared-memory mapping when running in shared-memory mode; m_shmBase is null
+  // in all other modes. The layout and synchronization protocol live entirely in llpcShaderCache.cpp.
+  void *m_shmBase;
+  size_t m_shmSize;
+
+  // Sharded map of shader index data which detail the hash, crc, size and CPU memory location for each shader
+  // in the cache. Lookups take only the owning shard's lock; allocation additionally takes m_lock.
+  ShaderIndexShard m_shaderIndexShards[ShaderIndexShardCount];
+
+  // Bloom filter over the compacted hash keys resident in the index map, read before any lock is taken so a
+  // definite miss costs a few cache lines. Bits are only ever set, never cleared, except when the whole
+  // runtime cache resets, so a clear bit is a guaranteed miss.
+  std::atomic<uint64_t> m_bloomFilter[BloomFilterWords];
+
+  // LRU list of evictable entries (those whose blob lives in its own runtime allocation), most recently used
+  // first. m_lruLock guards the list and the lruPrev/lruNext links; when it is held together with a shard lock,
+  // m_lruLock is always taken first.
+  llvm::sys::Mutex m_lruLock;    // Lock for the LRU list
+  ShaderIndex *m_lruHead;        // Most recently used evictable entry
+  ShaderIndex *m_lruTail;        // Least recently used evictable entry; eviction candidates come from here
+  size_t m_cacheSizeBudget;      // Byte budget for evictable shader data; 0 means unbounded
+  size_t m_evictableDataSize;    // Total bytes of shader data currently on the LRU list
 
   // In memory copy of the shaderDataEnd and totalShaders stored in the on-disk file. We keep a copy to avoid having
-  //  to do a read/modify/write of the value when adding a new shader.
+  //  to do a read/modify/write of the value when adding a new shader. After init, m_shaderDataEnd and
+  //  m_fileShaderCount are advanced only by the thread appending to the file.
   size_t m_shaderDataEnd;
   size_t m_totalShaders;
+  size_t m_fileShaderCount; // Number of shaders actually written to the on-disk file
+
+  // Live index journal records, in file order. Filled at load (from the journal or the recovery scan) and
+  // after init touched only by the thread appending to the file, like m_shaderDataEnd.
+  std::vector<IndexPageRecord> m_fileIndexRecords;
+
+  std::thread m_writeBehindThread;               // Background thread servicing the write-behind queue
+  std::mutex m_writeQueueMutex;                  // Lock for the write-behind queue
+  std::condition_variable m_writeQueueCondition; // Signals the write-behind thread that work or exit is pending
+  std::vector<ShaderIndex *> m_writeQueue;       // Shaders waiting to be appended to the on-disk file
+  std::vector<uint64_t> m_digestPatchQueue;      // File offsets of revalidated entries whose stored
+                                                 //  compilerDigest awaits rewriting in place; guarded by
+                                                 //  m_writeQueueMutex
+  bool m_writeBehindExit;                        // Asks the write-behind thread to drain its queue and exit
+
+  std::thread m_prefetchThread;                     // Background thread warming prefetched cache entries
+  std::mutex m_prefetchQueueMutex;                  // Lock for the prefetch queue
+  std::condition_variable m_prefetchQueueCondition; // Signals the prefetch thread that work or exit is pending
+  std::vector<ShaderIndex *> m_prefetchQueue;       // Entries waiting to be warmed, in manifest order
+  bool m_prefetchExit;                              // Asks the prefetch thread to exit
+
+  // Statistics counters; updated with relaxed atomics so the hot paths stay cheap and GetStats can be polled
+  // from any thread.
+  std::atomic<uint64_t> m_statHits{0};             // Lookups that found a ready shader
+  std::atomic<uint64_t> m_statMisses{0};           // Lookups that ended with the caller compiling
+  std::atomic<uint64_t> m_statMissCompileNanos{0}; // Total nanoseconds spent compiling on misses
+  std::atomic<uint64_t> m_statBytesStored{0};      // Total bytes of shader data inserted
+  std::atomic<uint64_t> m_statEvictions{0};        // Entries evicted to stay inside the memory budget
+  std::atomic<uint64_t> m_statWaitNanos{0};        // Total nanoseconds spent waiting on another thread's compile
 
   char m_fileFullPath[MaxFilePathLen]; // Full path/filename of the shader cache on-disk file
 
   std::list<std::pair<uint8_t *, size_t>> m_allocationList; // Memory allcoated by GetCacheSpace
-  unsigned m_serializedSize;                                // Serialized byte size of whole shader cache
-  std::mutex m_conditionMutex;                              // Mutex that will be used with the condition variable
-  std::condition_variable m_conditionVariable; // Condition variable that will be used to wait compile finish
+  unsigned m_serializedSize;                                // Upper bound on the serialized byte size of the whole
+                                                            //  shader cache; counts every backing byte, including
+                                                            //  records superseded by a newer blob for the same key
+
+  // Serialize snapshot support. While a Serialize call is assembling its frozen view of the allocation list
+  // outside the cache lock, freed allocations are parked on the deferred list instead of being returned to the
+  // system, so the view stays readable; the last snapshot to finish reclaims them. Both guarded by m_lock.
+  unsigned m_activeSnapshots;                              // Number of Serialize calls assembling a frozen view
+  std::vector<std::pair<uint8_t *, size_t>> m_deferredFrees; // Allocations freed while a snapshot was active
   const void *m_clientData;                    // Client data that will be used by function GetValue and StoreValue
   ShaderCacheGetValue m_getValueFunc;          // GetValue function used to query an external cache for shader data
   ShaderCacheStoreValue m_storeValueFunc;      // StoreValue function used to store shader data in an external cache
   GfxIpVersion m_gfxIp;                        // Graphics IP version info
   MetroHash::Hash m_hash;                      // Hash code of compilation options
+  uint64_t m_compilerDigest;                   // Digest of the running compiler build, stored per cache entry
 };
 
 } // namespace Llpc
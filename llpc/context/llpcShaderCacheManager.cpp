@@ -29,6 +29,7 @@
 ***********************************************************************************************************************
 */
 #include "llpcShaderCacheManager.h"
+#include <string.h>
 
 #define DEBUG_TYPE "llpc-shader-cache-manager"
 
@@ -40,42 +41,140 @@ namespace Llpc {
 // The global ShaderCacheManager object
 ShaderCacheManager *ShaderCacheManager::m_manager = nullptr;
 
+// =====================================================================================================================
+// Frees all stored blobs. The shader caches release their references before the store is destroyed, so anything
+// still present belongs to a cache the client leaked; free the memory regardless.
+ShaderBlobStore::~ShaderBlobStore() {
+  for (auto &bucket : m_blobs) {
+    for (auto &blob : bucket.second)
+      delete[] blob.data;
+  }
+}
+
+// =====================================================================================================================
+// Returns the digest used as the store key for the given blob contents.
+//
+// @param data : Blob contents
+// @param size : Byte size of the blob
+uint64_t ShaderBlobStore::digest(const void *data, size_t size) {
+  MetroHash::Hash hash = {};
+  MetroHash64::Hash(static_cast<const uint8_t *>(data), size, hash.bytes);
+  return MetroHash::compact64(&hash);
+}
+
+// =====================================================================================================================
+// Stores a copy of the given blob, or takes another reference on an already stored identical blob. Returns the
+// stable address of the stored copy; it stays valid until every acquire has been matched by a release.
+//
+// @param data : Blob contents to store
+// @param size : Byte size of the blob
+const void *ShaderBlobStore::acquire(const void *data, size_t size) {
+  const uint64_t key = digest(data, size);
+
+  m_lock.lock();
+  std::list<Blob> &bucket = m_blobs[key];
+  for (Blob &blob : bucket) {
+    if (blob.size == size && memcmp(blob.data, data, size) == 0) {
+      ++blob.refCount;
+      m_lock.unlock();
+      return blob.data;
+    }
+  }
+
+  // Not stored yet (or only digest-colliding blobs are); store a new copy.
+  Blob blob = {};
+  blob.data = new uint8_t[size];
+  blob.size = size;
+  blob.refCount = 1;
+  memcpy(blob.data, data, size);
+  bucket.push_back(blob);
+  m_lock.unlock();
+  return blob.data;
+}
+
+// =====================================================================================================================
+// Releases one reference on a blob previously returned by acquire, freeing it when the last reference goes away.
+//
+// @param data : Blob address returned by acquire
+// @param size : Byte size passed to the matching acquire
+void ShaderBlobStore::release(const void *data, size_t size) {
+  const uint64_t key = digest(data, size);
+
+  m_lock.lock();
+  auto bucketIt = m_blobs.find(key);
+  assert(bucketIt != m_blobs.end());
+  for (auto blobIt = bucketIt->second.begin(); blobIt != bucketIt->second.end(); ++blobIt) {
+    if (blobIt->data == data) {
+      if (--blobIt->refCount == 0) {
+        delete[] blobIt->data;
+        bucketIt->second.erase(blobIt);
+        if (bucketIt->second.empty())
+          m_blobs.erase(bucketIt);
+      }
+      break;
+    }
+  }
+  m_lock.unlock();
+}
+
 // =====================================================================================================================
 // Destroy all objects
 ShaderCacheManager::~ShaderCacheManager() {
-  for (auto cacheIt = m_shaderCaches.begin(), endIt = m_shaderCaches.end(); cacheIt != endIt; ++cacheIt) {
-    // Deletes managed object
-    (*cacheIt).reset();
-  }
+  // Drop the published snapshot; its shared pointers release the managed caches.
+  std::atomic_store(&m_cacheList, std::shared_ptr<const CacheList>());
+}
 
-  m_shaderCaches.clear();
+// =====================================================================================================================
+// Returns the key identifying the compatibility class of a cache: a digest of the create-info option hash and
+// graphics IP, the same fields ShaderCache::isCompatible compares.
+//
+// @param auxCreateInfo : Shader cache auxiliary info (static fields)
+uint64_t ShaderCacheManager::cacheKey(const ShaderCacheAuxCreateInfo *auxCreateInfo) {
+  MetroHash64 hasher;
+  hasher.Update(reinterpret_cast<const uint8_t *>(&auxCreateInfo->hash), sizeof(auxCreateInfo->hash));
+  hasher.Update(reinterpret_cast<const uint8_t *>(&auxCreateInfo->gfxIp), sizeof(auxCreateInfo->gfxIp));
+  uint64_t key = 0;
+  hasher.Finalize(reinterpret_cast<uint8_t *>(&key));
+  return key;
 }
 
 // =====================================================================================================================
 // Get ShaderCache instance with specified create info
 //
+// The managed caches are kept in an immutable snapshot list, so the steady-state path -- every cache created at
+// device initialization -- is an atomic load and a key comparison per cache, with no lock taken. Only creating a
+// new cache serializes, building a fresh snapshot and swapping it in.
+//
 // @param createInfo : Shader cache create info
 // @param auxCreateInfo : Shader cache auxiliary info (static fields)
 ShaderCachePtr ShaderCacheManager::getShaderCacheObject(const ShaderCacheCreateInfo *createInfo,
                                                         const ShaderCacheAuxCreateInfo *auxCreateInfo) {
-  ShaderCachePtr shaderCache;
-  auto cacheIt = m_shaderCaches.begin();
-  auto endIt = m_shaderCaches.end();
+  const uint64_t key = cacheKey(auxCreateInfo);
 
-  for (; cacheIt != endIt; ++cacheIt) {
-    if ((*cacheIt)->isCompatible(createInfo, auxCreateInfo)) {
-      shaderCache = (*cacheIt);
-      break;
-    }
+  auto snapshot = std::atomic_load(&m_cacheList);
+  for (const CacheListEntry &entry : *snapshot) {
+    if (entry.key == key && entry.cache->isCompatible(createInfo, auxCreateInfo))
+      return entry.cache;
   }
 
-  // No compatible object is found, create a new one
-  if (cacheIt == endIt) {
-    shaderCache = std::make_shared<ShaderCache>();
-    m_shaderCaches.push_back(shaderCache);
-    shaderCache->init(createInfo, auxCreateInfo);
+  // No compatible object is found; serialize creation, re-check against the latest snapshot in case another
+  // thread created the cache meanwhile, then publish a new snapshot with the cache appended.
+  m_insertLock.lock();
+  snapshot = std::atomic_load(&m_cacheList);
+  for (const CacheListEntry &entry : *snapshot) {
+    if (entry.key == key && entry.cache->isCompatible(createInfo, auxCreateInfo)) {
+      m_insertLock.unlock();
+      return entry.cache;
+    }
   }
 
+  ShaderCachePtr shaderCache = std::make_shared<ShaderCache>();
+  auto newList = std::make_shared<CacheList>(*snapshot);
+  newList->push_back({key, shaderCache});
+  std::atomic_store(&m_cacheList, std::shared_ptr<const CacheList>(std::move(newList)));
+  m_insertLock.unlock();
+
+  shaderCache->init(createInfo, auxCreateInfo);
   return shaderCache;
 }
 
@@ -84,16 +183,35 @@ ShaderCachePtr ShaderCacheManager::getShaderCacheObject(const ShaderCacheCreateI
 //
 // @param shaderCachePtr : ShaderCache instance to be released
 void ShaderCacheManager::releaseShaderCacheObject(ShaderCachePtr &shaderCachePtr) {
-  auto cacheIt = m_shaderCaches.begin();
-  auto endIt = m_shaderCaches.end();
-  for (; cacheIt != endIt; ++cacheIt) {
-    if ((*cacheIt).get() == shaderCachePtr.get())
-      break;
-  }
-
-  assert(cacheIt != endIt);
+#ifndef NDEBUG
+  auto snapshot = std::atomic_load(&m_cacheList);
+  bool found = false;
+  for (const CacheListEntry &entry : *snapshot)
+    found |= entry.cache.get() == shaderCachePtr.get();
+  assert(found);
+#endif
 
   shaderCachePtr.reset();
 }
 
+// =====================================================================================================================
+// Compacts the on-disk backing file of every managed shader cache. Caches without an on-disk file are skipped.
+// Returns the first hard error encountered, or ErrorUnavailable if no cache had a file to compact.
+//
+// @param manifest : Compacted shader hashes giving the desired file order; may be empty (last-access order)
+Result ShaderCacheManager::compactShaderCaches(ArrayRef<uint64_t> manifest) {
+  Result result = Result::ErrorUnavailable;
+
+  auto snapshot = std::atomic_load(&m_cacheList);
+  for (const CacheListEntry &entry : *snapshot) {
+    const Result cacheResult = entry.cache->compactCacheFile(manifest);
+    if (cacheResult == Result::Success && result == Result::ErrorUnavailable)
+      result = Result::Success;
+    else if (cacheResult != Result::Success && cacheResult != Result::ErrorUnavailable)
+      result = cacheResult;
+  }
+
+  return result;
+}
+
 } // namespace Llpc
@@ -33,11 +33,41 @@
 #include "llpc.h"
 #include "llpcShaderCache.h"
 #include <list>
+#include <memory>
+#include <vector>
 
 namespace Llpc {
 
 typedef std::shared_ptr<ShaderCache> ShaderCachePtr;
 
+// =====================================================================================================================
+// Content-addressed store for cached shader blobs, shared across all ShaderCache instances.
+//
+// The per-GFXIP/per-option caches managed by ShaderCacheManager frequently end up holding byte-identical entries
+// for the same shader. Blobs are keyed by a digest of their contents and reference-counted, so each distinct blob
+// is stored only once no matter how many caches hold it.
+class ShaderBlobStore {
+public:
+  ~ShaderBlobStore();
+
+  const void *acquire(const void *data, size_t size);
+  void release(const void *data, size_t size);
+
+private:
+  // One stored blob together with its reference count.
+  struct Blob {
+    uint8_t *data;     // Heap copy of the blob contents
+    size_t size;       // Byte size of the blob
+    unsigned refCount; // Number of acquire calls not yet matched by a release
+  };
+
+  static uint64_t digest(const void *data, size_t size);
+
+  llvm::sys::Mutex m_lock;                               // Lock for the blob map
+  std::unordered_map<uint64_t, std::list<Blob>> m_blobs; // Stored blobs, keyed by content digest; the list holds
+                                                         //  the (rare) blobs whose digests collide
+};
+
 // =====================================================================================================================
 // This class manages shader cache instances for different GFXIP
 class ShaderCacheManager {
@@ -64,8 +94,30 @@ public:
 
   void releaseShaderCacheObject(ShaderCachePtr &shaderCachePtr);
 
+  Result compactShaderCaches(llvm::ArrayRef<uint64_t> manifest);
+
+  // Get the content-addressed blob store shared by all shader caches
+  ShaderBlobStore &getBlobStore() { return m_blobStore; }
+
 private:
-  std::list<ShaderCachePtr> m_shaderCaches; // ShaderCache instances for all GFXIP
+  // One entry in the immutable cache list snapshot: the cache plus the precomputed key of the compatibility
+  // class it was created for, so steady-state lookups compare one word per cache instead of create infos, and
+  // skip caches created for a different graphics IP without touching the cache object.
+  struct CacheListEntry {
+    uint64_t key;         // Digest of the create-info option hash and gfxIp the cache was created with
+    ShaderCachePtr cache; // The cache itself
+  };
+  typedef std::vector<CacheListEntry> CacheList;
+
+  static uint64_t cacheKey(const ShaderCacheAuxCreateInfo *auxCreateInfo);
+
+  ShaderBlobStore m_blobStore; // Deduplicated blob storage shared across the managed caches; declared first so
+                               //  it outlives the caches that release blobs into it
+
+  // Immutable snapshot of the managed caches, read with an atomic load so the steady-state lookup path (all
+  // caches created at device init) never takes the insert lock. Inserts build a new list and swap it in.
+  std::shared_ptr<const CacheList> m_cacheList = std::make_shared<CacheList>();
+  llvm::sys::Mutex m_insertLock; // Serializes snapshot replacement when a new cache is created
 
   static ShaderCacheManager *m_manager; // Static manager
 };
@@ -79,6 +79,10 @@ static const char VkIcdName[] = "amdvlk";
 struct ShaderModuleOptions {
   PipelineOptions pipelineOptions; ///< Pipeline options related with this shader module
   bool enableOpt;                  ///< Enable translate & lower phase in build shader module
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  bool trustedModule; ///< The shader binary was already validated (e.g. with spirv-val) by the client's
+                      ///  toolchain; the compiler may skip redundant validation of it
+#endif
 };
 
 /// Represents info to build a shader module.
@@ -95,14 +99,44 @@ struct ShaderModuleBuildOut {
   ShaderModuleData *pModuleData; ///< Output shader module data (opaque)
 };
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+/// Number of hardware shader stages reported in PipelineStats, in PAL metadata hardware stage order
+/// (LS, HS, ES, GS, VS, PS, CS).
+static const unsigned PipelineStatsHwStageCount = 7;
+
+/// Resource usage of one hardware shader stage of a built pipeline.
+struct PipelineStageStats {
+  bool present;              ///< Whether this hardware stage is present in the pipeline
+  unsigned vgprCount;        ///< Number of VGPRs in use
+  unsigned sgprCount;        ///< Number of SGPRs in use
+  unsigned ldsSizeBytes;     ///< LDS usage of the stage, in bytes
+  unsigned scratchSizeBytes; ///< Scratch memory usage of the stage, in bytes
+  unsigned wavefrontSize;    ///< Wavefront size the stage was compiled for
+  unsigned isaSizeBytes;     ///< Size of the stage's ISA code, in bytes
+};
+
+/// Resource usage of a built pipeline, indexed by hardware stage. The pipeline build entry points populate this from
+/// the ELF while it is still in memory, so a client can gate on register pressure or code size at build time without
+/// parsing the ELF itself afterwards.
+struct PipelineStats {
+  PipelineStageStats stages[PipelineStatsHwStageCount]; ///< Per hardware stage statistics
+};
+#endif
+
 /// Represents output of building a graphics pipeline.
 struct GraphicsPipelineBuildOut {
   BinaryData pipelineBin; ///< Output pipeline binary data
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  PipelineStats pipelineStats; ///< Resource usage of the built pipeline, valid when the build succeeds
+#endif
 };
 
 /// Represents output of building a compute pipeline.
 struct ComputePipelineBuildOut {
   BinaryData pipelineBin; ///< Output pipeline binary data
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  PipelineStats pipelineStats; ///< Resource usage of the built pipeline, valid when the build succeeds
+#endif
 };
 
 /// Defines callback function used to lookup shader cache info in an external cache
@@ -111,6 +145,52 @@ typedef Result (*ShaderCacheGetValue)(const void *pClientData, uint64_t hash, vo
 /// Defines callback function used to store shader cache info in an external cache
 typedef Result (*ShaderCacheStoreValue)(const void *pClientData, uint64_t hash, const void *pValue, size_t valueLen);
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+/// Defines callback function used to forward a pipeline compilation to a remote compile service.
+///
+/// The pipeline is handed over in the textual .pipe form produced by the pipeline dumper, which is the complete
+/// replayable description of the build (amdllpc can compile it directly); shader modules are referenced by hash,
+/// and the service is expected to resolve them from its own module store. The callback is called twice per
+/// request: first with pElf null to query the required buffer size via pElfSize, then again with a buffer of
+/// that size to fetch the compiled ELF. Returning anything other than Success makes the compiler fall back to a
+/// local build.
+typedef Result (*PipelineCompileRemoteFunc)(const void *pClientData, uint64_t pipelineHash, const char *pPipeText,
+                                            size_t pipeTextSize, void *pElf, size_t *pElfSize);
+
+/// Resource that limited the occupancy of a profiled pipeline.
+enum class ProfileOccupancyLimiter : unsigned {
+  None = 0,  ///< No limiter reported
+  Vgprs = 1, ///< Occupancy was limited by VGPR usage
+  Sgprs = 2, ///< Occupancy was limited by SGPR usage
+  Lds = 3,   ///< Occupancy was limited by LDS usage
+};
+
+/// GPU profile metrics observed for one pipeline, keyed by the 64-bit pipeline hash reported at build time.
+struct PipelineProfileMetrics {
+  uint64_t pipelineHash;           ///< Pipeline hash the metrics were observed for
+  ProfileOccupancyLimiter limiter; ///< Resource that limited the pipeline's occupancy
+  bool memoryBound;                ///< Whether the pipeline was observed to be memory-bound
+  float averageWaves;              ///< Average waves per SIMD observed while the pipeline was running
+};
+
+/// Opaque handle identifying an in-flight asynchronous pipeline build.
+typedef void *PipelineBuildHandle;
+
+/// Priority classes for asynchronous pipeline builds. The scheduler's workers pick up higher-priority builds
+/// ahead of lower-priority ones; builds of the same priority run in submission order.
+enum class PipelineBuildPriority : unsigned {
+  Low = 0,    ///< Wanted opportunistically (e.g. cache prewarming); runs when no other work is queued
+  Normal = 1, ///< Default priority
+  High = 2,   ///< Needed urgently by the client; jumps ahead of all queued normal- and low-priority work
+};
+#endif
+
+/// Compression codecs that can be applied to shader blobs stored in a shader cache.
+enum class ShaderCacheCompression : unsigned {
+  None = 0, ///< Shader blobs are stored uncompressed
+  Zlib = 1, ///< Shader blobs are deflated with zlib; silently degrades to None if LLVM lacks zlib support
+};
+
 /// Specifies all information necessary to create a shader cache object.
 struct ShaderCacheCreateInfo {
   const void *pInitialData; ///< Pointer to a data buffer whose contents should be used to seed the shader
@@ -125,8 +205,27 @@ struct ShaderCacheCreateInfo {
   const void *pClientData;
   ShaderCacheGetValue pfnGetValueFunc;     ///< [Optional] Function to lookup shader cache data in an external cache
   ShaderCacheStoreValue pfnStoreValueFunc; ///< [Optional] Function to store shader cache data in an external cache
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  ShaderCacheCompression compression; ///< Codec applied to shader blobs stored in the cache
+  size_t maxRuntimeDataSize;          ///< Byte budget for shader data inserted into the cache at runtime. When the
+                                      ///  budget is exceeded the least recently used entries are evicted and must be
+                                      ///  recompiled on their next lookup. Zero leaves the cache unbounded.
+#endif
 };
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+/// Statistics accumulated by a shader cache since its creation. All counters are monotonic and can be polled at
+/// any time (e.g. once per frame) without perturbing concurrent cache operations.
+struct ShaderCacheStats {
+  uint64_t hits;             ///< Lookups that found a ready shader
+  uint64_t misses;           ///< Lookups that ended with the caller having to compile the shader
+  uint64_t missCompileNanos; ///< Total time spent compiling shaders on cache misses, in nanoseconds
+  uint64_t bytesStored;      ///< Total bytes of shader data inserted into the cache
+  uint64_t evictions;        ///< Entries evicted to stay inside the cache's memory budget
+  uint64_t waitNanos;        ///< Total time spent waiting on another thread's compile, in nanoseconds
+};
+#endif
+
 // =====================================================================================================================
 /// Represents the interface of a cache for compiled shaders. The shader cache is designed to be optionally passed in at
 /// pipeline create time. The compiled binary for the shaders is stored in the cache object to avoid compiling the same
@@ -158,6 +257,26 @@ public:
   /// Frees all resources associated with this object.
   virtual void Destroy() = 0;
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  /// Returns a snapshot of the statistics accumulated by this shader cache since its creation.
+  ///
+  /// @param [out]  pStats  Snapshot of the cache's statistics counters.
+  virtual void GetStats(ShaderCacheStats *pStats) = 0;
+
+  /// Compacts the cache's on-disk backing file: entries are rewritten contiguously in the requested order and
+  /// blobs superseded by later recompiles of the same shader are dropped, restoring sequential read patterns
+  /// for cold loads. May only be called when no compile is touching the cache concurrently.
+  ///
+  /// @param [in]  hashCount  Number of entries in pHashes.
+  /// @param [in]  pHashes    [Optional] Compacted 64-bit shader hashes in the order the entries should be laid
+  ///                         out in the file, e.g. the expected load order of the next run. Entries not listed
+  ///                         follow in last-access order. This may be null, in which case all entries are laid
+  ///                         out in last-access order (most recently used first).
+  ///
+  /// @returns Success if the file was compacted, ErrorUnavailable if the cache has no on-disk backing file.
+  virtual Result Compact(unsigned hashCount, const uint64_t *pHashes) = 0;
+#endif
+
 protected:
   /// @internal Constructor. Prevent use of new operator on this interface.
   IShaderCache() {}
@@ -226,6 +345,184 @@ public:
   virtual Result BuildComputePipeline(const ComputePipelineBuildInfo *pPipelineInfo,
                                       ComputePipelineBuildOut *pPipelineOut, void *pPipelineDumpFile = nullptr) = 0;
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  /// Enqueues a graphics pipeline build on the compiler's internal scheduler and returns immediately.
+  ///
+  /// The build info and output structure must stay valid until the build has been waited on with
+  /// WaitForPipelineBuild, and every enqueued build must be waited on exactly once.
+  ///
+  /// @param [in]  pPipelineInfo  Info to build this graphics pipeline
+  /// @param [out] pPipelineOut   Output of the build; valid once the build has been waited on
+  /// @param [out] phBuild        Handle identifying the enqueued build
+  /// @param [in]  priority       Priority class of the build
+  ///
+  /// @returns Result::Success if the build was successfully enqueued.
+  virtual Result BuildGraphicsPipelineAsync(const GraphicsPipelineBuildInfo *pPipelineInfo,
+                                            GraphicsPipelineBuildOut *pPipelineOut, PipelineBuildHandle *phBuild,
+                                            PipelineBuildPriority priority = PipelineBuildPriority::Normal) = 0;
+
+  /// Enqueues a compute pipeline build on the compiler's internal scheduler and returns immediately.
+  ///
+  /// The build info and output structure must stay valid until the build has been waited on with
+  /// WaitForPipelineBuild, and every enqueued build must be waited on exactly once.
+  ///
+  /// @param [in]  pPipelineInfo  Info to build this compute pipeline
+  /// @param [out] pPipelineOut   Output of the build; valid once the build has been waited on
+  /// @param [out] phBuild        Handle identifying the enqueued build
+  /// @param [in]  priority       Priority class of the build
+  ///
+  /// @returns Result::Success if the build was successfully enqueued.
+  virtual Result BuildComputePipelineAsync(const ComputePipelineBuildInfo *pPipelineInfo,
+                                           ComputePipelineBuildOut *pPipelineOut, PipelineBuildHandle *phBuild,
+                                           PipelineBuildPriority priority = PipelineBuildPriority::Normal) = 0;
+
+  /// Waits for an asynchronous pipeline build to complete, releases its handle and returns its result.
+  ///
+  /// @param [in] hBuild  Handle of the build to wait for; invalid after this call
+  ///
+  /// @returns Result of the pipeline build identified by the handle.
+  virtual Result WaitForPipelineBuild(PipelineBuildHandle hBuild) = 0;
+
+  /// Requests cancellation of an asynchronous pipeline build whose result is no longer wanted.
+  ///
+  /// A build still waiting in the queue never runs; a build already in progress stops cooperatively at its
+  /// next compilation phase boundary and releases its compiler resources. Either way the build completes with
+  /// Result::ErrorUnavailable, and its handle must still be released with WaitForPipelineBuild. Cancellation
+  /// is best effort: a build that completes before noticing the request keeps its real result.
+  ///
+  /// @param [in] hBuild  Handle of the build to cancel; stays valid until waited on
+  ///
+  /// @returns Result::Success if the cancellation request was recorded.
+  virtual Result CancelPipelineBuild(PipelineBuildHandle hBuild) = 0;
+
+  /// Callback invoked when a pipeline compilation exceeds the budget set with SetCompileTimeBudget.
+  ///
+  /// @param [in] pUserData       Client pointer passed to SetCompileTimeBudget
+  /// @param [in] pipelineHash    Hash of the pipeline that exceeded the budget
+  /// @param [in] elapsedUs       Total time the compilation took, in microseconds
+  /// @param [in] pPassBreakdown  Null-terminated text with one "passName: microseconds" line per compiler
+  ///                             pass run during the compilation; only valid during the callback
+  typedef void(VKAPI_CALL *CompileTimeExceededCallback)(void *pUserData, uint64_t pipelineHash, uint64_t elapsedUs,
+                                                        const char *pPassBreakdown);
+
+  /// Sets the compile-time budget for pipeline compilations, and the callback fired when one exceeds it.
+  ///
+  /// The callback runs on the compiling thread at the end of the offending compilation, so the client can
+  /// attribute hitches to a pipeline hash and a compiler pass without attaching an external profiler. Set the
+  /// budget before the first compilation; a budget of 0 disables the instrumentation.
+  ///
+  /// @param [in] budgetUs     Budget for one pipeline compilation in microseconds, or 0 to disable
+  /// @param [in] pfnCallback  Callback to fire when the budget is exceeded
+  /// @param [in] pUserData    Client data passed through to the callback
+  virtual void SetCompileTimeBudget(uint64_t budgetUs, CompileTimeExceededCallback pfnCallback, void *pUserData) = 0;
+
+  /// Describes one speculative variant of a just-built graphics pipeline as a delta against its state. Only the
+  /// state commonly varied within a pipeline family can be overridden; the shaders and all remaining state are
+  /// taken from the base build info unchanged.
+  struct GraphicsPipelineStateDelta {
+    bool overrideColorState;                  ///< Whether the color fields below replace the base cbState
+    bool alphaToCoverageEnable;               ///< Replacement for cbState.alphaToCoverageEnable
+    bool dualSourceBlendEnable;               ///< Replacement for cbState.dualSourceBlendEnable
+    ColorTarget target[MaxColorTargets];      ///< Replacement per-MRT color target info
+    bool overrideDepthState;                  ///< Whether the depth fields below replace the base state
+    bool depthClipEnable;                     ///< Replacement for vpState.depthClipEnable
+    bool depthBiasEnable;                     ///< Replacement for rsState.depthBiasEnable
+  };
+
+  /// Speculatively compiles variants of a just-built graphics pipeline on the compiler's internal scheduler.
+  ///
+  /// Each delta describes one variant of the base pipeline; the variants are compiled on background threads and
+  /// their results inserted into the shader cache, so that a later BuildGraphicsPipeline call for the same state
+  /// is a cache hit. There is no completion handle: speculative builds are fire-and-forget, queued behind any
+  /// builds the application is waiting on. Everything the base build info points to (shader modules, resource
+  /// mapping, vertex input state) must stay valid until the compiler is destroyed.
+  ///
+  /// @param [in] pPipelineInfo  Base build info the deltas are applied against
+  /// @param [in] pDeltas        Array of state deltas, one per variant to compile
+  /// @param [in] deltaCount     Number of deltas in the array
+  ///
+  /// @returns Result::Success if the variants were successfully enqueued.
+  virtual Result SpeculateGraphicsPipelineVariants(const GraphicsPipelineBuildInfo *pPipelineInfo,
+                                                   const GraphicsPipelineStateDelta *pDeltas,
+                                                   unsigned deltaCount) = 0;
+
+  /// Sets a soft memory budget for concurrent compilations.
+  ///
+  /// When a budget is set, a thread about to start a compilation is held back while other compilations are in
+  /// flight and the process allocation footprint, plus the footprint one compilation has been observed to add,
+  /// would exceed the budget. One compilation is always allowed to proceed, so the budget throttles concurrency
+  /// rather than failing builds. The budget is shared by all compiler instances in the process, matching the
+  /// footprint it caps.
+  ///
+  /// @param [in] budgetBytes  Soft cap on the process allocation footprint in bytes, or 0 to disable
+  virtual void SetMemoryBudget(uint64_t budgetBytes) = 0;
+
+  /// Sets the handler used to forward pipeline compilations to a remote compile service.
+  ///
+  /// Once set, a pipeline build whose shader cache probe misses is offered to the handler before being compiled
+  /// locally; an ELF returned by the handler is inserted into the local shader cache exactly like a local result,
+  /// and so propagates to whatever backing stores the cache is configured with (on-disk file, shared memory,
+  /// external client cache). The handler must be thread-safe, as concurrent builds call it concurrently.
+  ///
+  /// @param [in] pfnRemoteCompile  Remote compile callback, or null to disable forwarding
+  /// @param [in] pClientData       Client-opaque data passed to the callback
+  virtual void SetRemoteCompileHandler(PipelineCompileRemoteFunc pfnRemoteCompile, const void *pClientData) = 0;
+
+  /// Loads GPU profile feedback collected for previously built pipelines.
+  ///
+  /// Each line of the file maps one pipeline to metrics observed while it ran on the GPU:
+  ///   <pipelineHash> <limiter> <memBound> <averageWaves>
+  /// where pipelineHash is the 64-bit pipeline hash reported at build time, limiter is one of
+  /// none/vgprs/sgprs/lds, memBound is 0 or 1, and averageWaves is the average waves per SIMD; '#' starts a
+  /// comment. The metrics are consulted by the wave size and loop unrolling decisions on the next compile of
+  /// that pipeline, so recompiling a profiled workload with its feedback loaded yields profile-guided code.
+  /// Loading is cumulative; later files override earlier entries with the same hash.
+  ///
+  /// @param [in] pFilePath  Path of the feedback file
+  ///
+  /// @returns Success, ErrorUnavailable if the file cannot be read, or ErrorInvalidValue on a malformed line.
+  virtual Result LoadProfileFeedback(const char *pFilePath) = 0;
+
+  /// Build a batch of shader modules from the specified infos, processing them on internal worker threads.
+  ///
+  /// Equivalent to calling BuildShaderModule() once per entry, but the per-module work (debug info trimming,
+  /// usage scanning, hashing) runs in parallel, so a large module corpus builds in roughly corpus-size/cores
+  /// time. Each module's output is still allocated through that module's own pfnOutputAlloc callback, which
+  /// must therefore be thread-safe.
+  ///
+  /// @param [in]  shaderModuleCount  Number of modules in the batch
+  /// @param [in]  pShaderInfos       Array of shaderModuleCount infos to build
+  /// @param [out] pShaderOuts        Array of shaderModuleCount outputs, one per info
+  /// @param [out] pResults           If non-null, receives the per-module build result for each entry
+  ///
+  /// @returns Success if every module built successfully; otherwise the result of the first failing module.
+  virtual Result BuildShaderModules(unsigned shaderModuleCount, const ShaderModuleBuildInfo *pShaderInfos,
+                                    ShaderModuleBuildOut *pShaderOuts, Result *pResults) const = 0;
+
+  /// Computes the hashes a graphics pipeline would be built and cached under, without compiling anything.
+  ///
+  /// These are the hashes BuildGraphicsPipeline computes internally: pPipelineHash matches the 64-bit pipeline
+  /// hash reported at build time, and pCacheHash is the 128-bit key the pipeline's ELF would be looked up under
+  /// in the shader cache, including whether the build would take the relocatable shader path. No Context is
+  /// acquired and nothing is allocated, so the call is cheap enough to make thousands of times per frame when
+  /// planning cache prefetches. Either output pointer may be null to skip that hash.
+  ///
+  /// @param [in]  pPipelineInfo  Info the pipeline would be built from
+  /// @param [out] pPipelineHash  If non-null, receives the 64-bit pipeline hash
+  /// @param [out] pCacheHash     If non-null, receives the 128-bit shader cache key
+  virtual void GetGraphicsPipelineCacheKeys(const GraphicsPipelineBuildInfo *pPipelineInfo, uint64_t *pPipelineHash,
+                                            ShaderHash *pCacheHash) const = 0;
+
+  /// Computes the hashes a compute pipeline would be built and cached under, without compiling anything.
+  /// See GetGraphicsPipelineCacheKeys for the semantics of the outputs.
+  ///
+  /// @param [in]  pPipelineInfo  Info the pipeline would be built from
+  /// @param [out] pPipelineHash  If non-null, receives the 64-bit pipeline hash
+  /// @param [out] pCacheHash     If non-null, receives the 128-bit shader cache key
+  virtual void GetComputePipelineCacheKeys(const ComputePipelineBuildInfo *pPipelineInfo, uint64_t *pPipelineHash,
+                                           ShaderHash *pCacheHash) const = 0;
+#endif
+
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38 || LLPC_ENABLE_SHADER_CACHE
   /// Creates a shader cache object with the requested properties.
   ///
@@ -60,6 +60,20 @@
 using namespace lgc;
 using namespace llvm;
 
+namespace llvm {
+
+namespace cl {
+
+// -disable-fused-spirv-lower: schedule the individual lowering passes instead of the fused instruction walk
+static opt<bool> DisableFusedSpirvLower("disable-fused-spirv-lower",
+                                        desc("Schedule the individual SPIR-V lowering passes instead of the fused "
+                                             "instruction walk"),
+                                        init(false));
+
+} // namespace cl
+
+} // namespace llvm
+
 namespace Llpc {
 // =====================================================================================================================
 // Replace a constant with instructions using a builder.
@@ -174,14 +188,21 @@ void SpirvLower::addPasses(Context *context, ShaderStage stage, legacy::PassMana
   // Lower SPIR-V global variables, inputs, and outputs
   passMgr.add(createSpirvLowerGlobal());
 
-  // Lower SPIR-V constant immediate store.
-  passMgr.add(createSpirvLowerConstImmediateStore());
+  // Lower SPIR-V constant immediate store. By default this concern is handled by the fused pass below; with
+  // -disable-fused-spirv-lower the individual pass is scheduled at its original position instead.
+  if (cl::DisableFusedSpirvLower)
+    passMgr.add(createSpirvLowerConstImmediateStore());
 
   // Lower SPIR-V algebraic transforms, constant folding must be done before instruction combining pass.
   passMgr.add(createSpirvLowerAlgebraTransform(true, false));
 
-  // Lower SPIR-V memory operations
-  passMgr.add(createSpirvLowerMemoryOp());
+  // Lower SPIR-V constant immediate store and memory operations in one fused instruction walk. The algebra
+  // transform above neither creates nor removes the alloca-of-constant pattern, so handling constant immediate
+  // store here instead of before it sees the same candidates.
+  if (cl::DisableFusedSpirvLower)
+    passMgr.add(createSpirvLowerMemoryOp());
+  else
+    passMgr.add(createSpirvLowerFused());
 
   // Remove reduant load/store operations and do minimal optimization
   // It is required by SpirvLowerImageOp.
@@ -50,11 +50,13 @@ class PassRegistry;
 void initializeSpirvLowerAccessChainPass(PassRegistry &);
 void initializeSpirvLowerAlgebraTransformPass(PassRegistry &);
 void initializeSpirvLowerConstImmediateStorePass(PassRegistry &);
+void initializeSpirvLowerFusedPass(PassRegistry &);
 void initializeSpirvLowerMemoryOpPass(PassRegistry &);
 void initializeSpirvLowerGlobalPass(PassRegistry &);
 void initializeSpirvLowerInstMetaRemovePass(PassRegistry &);
 void initializeSpirvLowerLoopUnrollControlPass(PassRegistry &);
 void initializeSpirvLowerResourceCollectPass(PassRegistry &);
+void initializeSpirvLowerSpecConstFoldPass(PassRegistry &);
 void initializeSpirvLowerTranslatorPass(PassRegistry &);
 } // namespace llvm
 
@@ -73,11 +75,13 @@ inline static void initializeLowerPasses(llvm::PassRegistry &passRegistry) {
   initializeSpirvLowerAccessChainPass(passRegistry);
   initializeSpirvLowerAlgebraTransformPass(passRegistry);
   initializeSpirvLowerConstImmediateStorePass(passRegistry);
+  initializeSpirvLowerFusedPass(passRegistry);
   initializeSpirvLowerMemoryOpPass(passRegistry);
   initializeSpirvLowerGlobalPass(passRegistry);
   initializeSpirvLowerInstMetaRemovePass(passRegistry);
   initializeSpirvLowerLoopUnrollControlPass(passRegistry);
   initializeSpirvLowerResourceCollectPass(passRegistry);
+  initializeSpirvLowerSpecConstFoldPass(passRegistry);
   initializeSpirvLowerTranslatorPass(passRegistry);
 }
 
@@ -86,12 +90,15 @@ class Context;
 llvm::ModulePass *createSpirvLowerAccessChain();
 llvm::ModulePass *createSpirvLowerAlgebraTransform(bool enableConstFolding, bool enableFloatOpt);
 llvm::ModulePass *createSpirvLowerConstImmediateStore();
+llvm::ModulePass *createSpirvLowerFused();
 llvm::ModulePass *createSpirvLowerMemoryOp();
 llvm::ModulePass *createSpirvLowerGlobal();
 llvm::ModulePass *createSpirvLowerInstMetaRemove();
 llvm::ModulePass *createSpirvLowerLoopUnrollControl(unsigned forceLoopUnrollCount);
 llvm::ModulePass *createSpirvLowerResourceCollect(bool collectDetailUsage);
-llvm::ModulePass *createSpirvLowerTranslator(ShaderStage stage, const PipelineShaderInfo *shaderInfo);
+llvm::ModulePass *createSpirvLowerSpecConstFold(const VkSpecializationInfo *specializationInfo);
+llvm::ModulePass *createSpirvLowerTranslator(ShaderStage stage, const PipelineShaderInfo *shaderInfo,
+                                             bool foldSpecConstants = false);
 
 // =====================================================================================================================
 // Represents the pass of SPIR-V lowering operations, as the base class.
@@ -109,9 +116,11 @@ public:
   static void removeConstantExpr(Context *context, llvm::GlobalVariable *global);
   static void replaceConstWithInsts(Context *context, llvm::Constant *const constVal);
 
-protected:
+  // Initialize the pass according to the specified module. Called at the beginning of runOnModule, and by the
+  // fused lowering pass to prepare the lowering passes whose handlers it dispatches to.
   void init(llvm::Module *module);
 
+protected:
   llvm::Module *m_module;       // LLVM module to be run on
   Context *m_context;           // Associated LLPC context of the LLVM module that passes run on
   ShaderStage m_shaderStage;    // Shader stage
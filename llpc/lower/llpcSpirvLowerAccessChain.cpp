@@ -30,7 +30,10 @@
  */
 #include "llpcSpirvLowerAccessChain.h"
 #include "SPIRVInternal.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include <stack>
@@ -60,28 +63,76 @@ SpirvLowerAccessChain::SpirvLowerAccessChain() : SpirvLower(ID) {
 // =====================================================================================================================
 // Executes this SPIR-V lowering pass on the specified LLVM module.
 //
+// NOTE: Here, we try to coalesce chained "getelementptr" instructions (created from multi-level access chain).
+// Because the metadata is always decorated on top-level pointer value (actually a global variable).
+//
+// Instead of walking every instruction of the module, the candidate "getelementptr" instructions are collected
+// from the use lists of the pointer roots in the interesting address spaces: every chained "getelementptr" is
+// rooted at a global variable, an "alloca" instruction or a pointer argument. Use lists stay valid across the
+// function inlining that runs before this pass, which a side table populated at translation time would not.
+//
 // @param [in,out] module : LLVM module to be run on
 bool SpirvLowerAccessChain::runOnModule(Module &module) {
   LLVM_DEBUG(dbgs() << "Run the pass Spirv-Lower-Access-Chain\n");
 
   SpirvLower::init(&module);
 
-  // Invoke handling of "getelementptr" instruction
-  visit(m_module);
+  SmallVector<User *, 16> worklist;
+  SmallPtrSet<User *, 16> visited;
+
+  // Seed the worklist with the "getelementptr" users of one pointer root.
+  auto enumerateRoot = [&](Value *root) {
+    const unsigned addrSpace = root->getType()->getPointerAddressSpace();
+    if (addrSpace != SPIRAS_Private && addrSpace != SPIRAS_Input && addrSpace != SPIRAS_Output)
+      return;
+    for (User *const user : root->users()) {
+      if (isa<GEPOperator>(user) && visited.insert(user).second)
+        worklist.push_back(user);
+    }
+  };
 
-  return true;
-}
+  for (GlobalVariable &global : module.globals())
+    enumerateRoot(&global);
 
-// =====================================================================================================================
-// Visits "getelementptr" instruction.
-//
-// @param getElemPtrInst : "Getelementptr" instruction
-void SpirvLowerAccessChain::visitGetElementPtrInst(GetElementPtrInst &getElemPtrInst) {
-  // NOTE: Here, we try to coalesce chained "getelementptr" instructions (created from multi-level access chain).
-  // Because the metadata is always decorated on top-level pointer value (actually a global variable).
-  const unsigned addrSpace = getElemPtrInst.getType()->getPointerAddressSpace();
-  if (addrSpace == SPIRAS_Private || addrSpace == SPIRAS_Input || addrSpace == SPIRAS_Output)
-    tryToCoalesceChain(&getElemPtrInst, addrSpace);
+  for (Function &func : module) {
+    if (func.empty())
+      continue;
+    for (Argument &arg : func.args()) {
+      if (arg.getType()->isPointerTy())
+        enumerateRoot(&arg);
+    }
+    // NOTE: Only the entry block is scanned for "alloca" instructions, on the basis that the SPIR-V translator
+    // puts them all there and the inliner hoists them there too.
+    for (Instruction &inst : func.front()) {
+      if (isa<AllocaInst>(inst))
+        enumerateRoot(&inst);
+    }
+  }
+
+  // Collect the candidate "getelementptr" instructions by following "getelementptr" users transitively, so the
+  // bottoms of chained "getelementptr" instructions/constants are reached as well.
+  std::vector<WeakTrackingVH> candidates;
+  while (!worklist.empty()) {
+    User *const user = worklist.pop_back_val();
+    if (isa<GetElementPtrInst>(user))
+      candidates.push_back(user);
+    for (User *const next : user->users()) {
+      if (isa<GEPOperator>(next) && visited.insert(next).second)
+        worklist.push_back(next);
+    }
+  }
+
+  // Invoke coalescing on the candidates. Coalescing erases chain members and replaces candidates, so they are
+  // held as value handles: erased ones become null and are skipped, replaced ones coalesce to a no-op.
+  for (WeakTrackingVH &candidate : candidates) {
+    if (auto getElemPtr = dyn_cast_or_null<GetElementPtrInst>(candidate)) {
+      const unsigned addrSpace = getElemPtr->getType()->getPointerAddressSpace();
+      if (addrSpace == SPIRAS_Private || addrSpace == SPIRAS_Input || addrSpace == SPIRAS_Output)
+        tryToCoalesceChain(getElemPtr, addrSpace);
+    }
+  }
+
+  return true;
 }
 
 // =====================================================================================================================
@@ -152,7 +203,7 @@ GetElementPtrInst *SpirvLowerAccessChain::tryToCoalesceChain(GetElementPtrInst *
       GetElementPtrInst *inst = removedInsts.top();
       if (inst->user_empty()) {
         if (inst == getElemPtr) {
-          // We cannot remove the current instruction that InstWalker is on. Just stop it using its
+          // We cannot remove the instruction the caller is processing. Just stop it using its
           // pointer operand, and it will be DCEd later.
           auto &operand = inst->getOperandUse(0);
           operand = UndefValue::get(operand->getType());
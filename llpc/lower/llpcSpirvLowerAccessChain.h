@@ -31,18 +31,23 @@
 #pragma once
 
 #include "llpcSpirvLower.h"
-#include "llvm/IR/InstVisitor.h"
+
+namespace llvm {
+class GetElementPtrInst;
+class Value;
+} // namespace llvm
 
 namespace Llpc {
 
 // =====================================================================================================================
-// Represents the pass of SPIR-V lowering opertions for access chain.
-class SpirvLowerAccessChain : public SpirvLower, public llvm::InstVisitor<SpirvLowerAccessChain> {
+// Represents the pass of SPIR-V lowering opertions for access chain. The candidate "getelementptr" instructions
+// are collected from the use lists of the pointer roots (global variables, "alloca" instructions and pointer
+// arguments), rather than by walking every instruction of the module.
+class SpirvLowerAccessChain : public SpirvLower {
 public:
   SpirvLowerAccessChain();
 
   virtual bool runOnModule(llvm::Module &module);
-  virtual void visitGetElementPtrInst(llvm::GetElementPtrInst &getElemPtrInst);
 
   static char ID; // ID of this pass
 
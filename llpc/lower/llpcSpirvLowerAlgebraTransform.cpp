@@ -90,6 +90,23 @@ bool SpirvLowerAlgebraTransform::runOnModule(Module &module) {
                       commonShaderMode.fp64DenormMode == FpDenormMode::FlushInOut;
   m_fp16Rtz = commonShaderMode.fp16RoundMode == FpRoundMode::Zero;
 
+  // Narrow the FP environment with the module-level usage summary collected at shader module build time: denormal
+  // flushing and RTZ rounding only matter for FP widths the module declares, and a module without any FP arithmetic
+  // has nothing for this pass to transform.
+  bool hasFpArith = true;
+  if (m_context->getPipelineContext()) {
+    auto moduleData =
+        reinterpret_cast<const ShaderModuleData *>(m_context->getPipelineShaderInfo(m_shaderStage)->pModuleData);
+    if (moduleData && moduleData->binType == BinaryType::Spirv) {
+      m_fp16DenormFlush &= moduleData->usage.useFp16;
+      m_fp64DenormFlush &= moduleData->usage.useFp64;
+      m_fp16Rtz &= moduleData->usage.useFp16;
+      hasFpArith = moduleData->usage.useFpArith;
+    }
+  }
+  if (!hasFpArith)
+    return false;
+
   if (m_enableConstFolding && (m_fp16DenormFlush || m_fp32DenormFlush || m_fp64DenormFlush)) {
     // Do constant folding if we need flush denorm to zero.
     auto &targetLibInfo = getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(*m_entryPoint);
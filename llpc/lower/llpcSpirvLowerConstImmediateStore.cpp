@@ -75,6 +75,8 @@ bool SpirvLowerConstImmediateStore::runOnModule(Module &module) {
     }
   }
 
+  finishVisit();
+
   return true;
 }
 
@@ -89,16 +91,24 @@ void SpirvLowerConstImmediateStore::processAllocaInsts(Function *func) {
   auto entryBlock = &func->front();
   for (auto instIt = entryBlock->begin(), instItEnd = entryBlock->end(); instIt != instItEnd; ++instIt) {
     auto inst = &*instIt;
-    if (auto allocaInst = dyn_cast<AllocaInst>(inst)) {
-      if (allocaInst->getType()->getElementType()->isAggregateType()) {
-        // Got an "alloca" instruction of aggregate type.
-        auto storeInst = findSingleStore(allocaInst);
-        if (storeInst && isa<Constant>(storeInst->getValueOperand())) {
-          // Got an aggregate "alloca" with a single store to the whole type.
-          // Do the optimization.
-          convertAllocaToReadOnlyGlobal(storeInst);
-        }
-      }
+    if (auto allocaInst = dyn_cast<AllocaInst>(inst))
+      tryProcessAlloca(allocaInst);
+  }
+}
+
+// =====================================================================================================================
+// Processes one "alloca" instruction to see if it can be optimized to a read-only global variable. Called from
+// processAllocaInsts, and directly by the fused lowering pass that shares a single instruction walk.
+//
+// @param allocaInst : The "alloca" instruction to process
+void SpirvLowerConstImmediateStore::tryProcessAlloca(AllocaInst *allocaInst) {
+  if (allocaInst->getType()->getElementType()->isAggregateType()) {
+    // Got an "alloca" instruction of aggregate type.
+    auto storeInst = findSingleStore(allocaInst);
+    if (storeInst && isa<Constant>(storeInst->getValueOperand())) {
+      // Got an aggregate "alloca" with a single store to the whole type.
+      // Do the optimization.
+      convertAllocaToReadOnlyGlobal(storeInst);
     }
   }
 }
@@ -150,8 +160,8 @@ StoreInst *SpirvLowerConstImmediateStore::findSingleStore(AllocaInst *allocaInst
 // =====================================================================================================================
 // Converts an "alloca" instruction with a single constant store into a read-only global variable.
 //
-// NOTE: This erases the "store" instruction (so it will not be lowered by a later lowering pass
-// any more) but not the "alloca" or replaced "getelementptr" instruction (they will be removed
+// NOTE: This records the "store" instruction for erasure by finishVisit (so it will not be lowered by a later
+// lowering pass any more) but not the "alloca" or replaced "getelementptr" instruction (they will be removed
 // later by DCE pass).
 //
 // @param storeInst : The single constant store into the "alloca"
@@ -191,7 +201,19 @@ void SpirvLowerConstImmediateStore::convertAllocaToReadOnlyGlobal(StoreInst *sto
     }
     // Visit next map pair.
   } while (!allocaToGlobalMap.empty());
-  storeInst->eraseFromParent();
+  m_eraseStores.push_back(storeInst);
+}
+
+// =====================================================================================================================
+// Erases the "store" instructions recorded during the visit.
+//
+// NOTE: The conversion must not erase a store while an instruction walk is in flight: the fused pass's InstVisitor
+// has already advanced past the "alloca" when the handler runs, and the dead store may be the very next
+// instruction. Deferring the erase keeps the walk's iterator valid.
+void SpirvLowerConstImmediateStore::finishVisit() {
+  for (StoreInst *storeInst : m_eraseStores)
+    storeInst->eraseFromParent();
+  m_eraseStores.clear();
 }
 
 } // namespace Llpc
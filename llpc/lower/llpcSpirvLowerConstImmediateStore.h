@@ -31,6 +31,7 @@
 #pragma once
 
 #include "llpcSpirvLower.h"
+#include "llvm/ADT/SmallVector.h"
 
 namespace llvm {
 class AllocaInst;
@@ -47,6 +48,12 @@ public:
 
   virtual bool runOnModule(llvm::Module &module);
 
+  // Processes one "alloca" instruction, called directly by the fused lowering pass
+  void tryProcessAlloca(llvm::AllocaInst *allocaInst);
+
+  // Erases the stores recorded during the visit, called after the instruction walk finishes
+  void finishVisit();
+
   static char ID; // ID of this pass
 
 private:
@@ -56,6 +63,9 @@ private:
   void processAllocaInsts(llvm::Function *func);
   llvm::StoreInst *findSingleStore(llvm::AllocaInst *allocaInst);
   void convertAllocaToReadOnlyGlobal(llvm::StoreInst *storeInst);
+
+  llvm::SmallVector<llvm::StoreInst *, 4> m_eraseStores; // Constant stores made dead by the conversion, erased by
+                                                         //  finishVisit once no instruction walk is in flight
 };
 
 } // namespace Llpc
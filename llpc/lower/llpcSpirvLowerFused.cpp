@@ -0,0 +1,111 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcSpirvLowerFused.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::SpirvLowerFused.
+ ***********************************************************************************************************************
+ */
+#include "llpcSpirvLowerFused.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "llpc-spirv-lower-fused"
+
+using namespace llvm;
+using namespace Llpc;
+
+namespace Llpc {
+
+// =====================================================================================================================
+// Initializes static members.
+char SpirvLowerFused::ID = 0;
+
+// =====================================================================================================================
+// Pass creator, creates the fused pass of SPIR-V lowering operations
+ModulePass *createSpirvLowerFused() {
+  return new SpirvLowerFused();
+}
+
+// =====================================================================================================================
+SpirvLowerFused::SpirvLowerFused() : SpirvLower(ID) {
+}
+
+// =====================================================================================================================
+// Executes this SPIR-V lowering pass on the specified LLVM module.
+//
+// The module is walked once; each instruction is dispatched to the handlers of the fused lowering concerns. The
+// handlers either mutate in place behind the walk or record work that is applied once the walk has finished,
+// exactly as they do when their passes run individually.
+//
+// @param [in,out] module : LLVM module to be run on
+bool SpirvLowerFused::runOnModule(Module &module) {
+  LLVM_DEBUG(dbgs() << "Run the pass Spirv-Lower-Fused\n");
+
+  SpirvLower::init(&module);
+  m_constImmediateStoreLower.init(&module);
+  m_memoryOpLower.init(&module);
+
+  visit(m_module);
+
+  m_constImmediateStoreLower.finishVisit();
+  m_memoryOpLower.finishVisit();
+
+  return true;
+}
+
+// =====================================================================================================================
+// Visits "alloca" instruction.
+//
+// @param allocaInst : "Alloca" instruction
+void SpirvLowerFused::visitAllocaInst(AllocaInst &allocaInst) {
+  // NOTE: Only entry-block "alloca" instructions are considered, on the basis that the SPIR-V translator puts all
+  // "alloca" instructions there. This matches the scan of the individual constant immediate store pass.
+  if (allocaInst.getParent() == &allocaInst.getFunction()->front())
+    m_constImmediateStoreLower.tryProcessAlloca(&allocaInst);
+}
+
+// =====================================================================================================================
+// Visits "getelementptr" instruction.
+//
+// @param getElemPtrInst : "Getelementptr" instruction
+void SpirvLowerFused::visitGetElementPtrInst(GetElementPtrInst &getElemPtrInst) {
+  m_memoryOpLower.visitGetElementPtrInst(getElemPtrInst);
+}
+
+// =====================================================================================================================
+// Visits "extractelement" instruction.
+//
+// @param extractElementInst : "ExtractElement" instruction
+void SpirvLowerFused::visitExtractElementInst(ExtractElementInst &extractElementInst) {
+  m_memoryOpLower.visitExtractElementInst(extractElementInst);
+}
+
+} // namespace Llpc
+
+// =====================================================================================================================
+// Initializes the fused pass of SPIR-V lowering operations.
+INITIALIZE_PASS(SpirvLowerFused, DEBUG_TYPE, "Fused SPIR-V lowering operations", false, false)
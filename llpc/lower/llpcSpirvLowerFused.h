@@ -0,0 +1,63 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcSpirvLowerFused.h
+ * @brief LLPC header file: contains declaration of class Llpc::SpirvLowerFused.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llpcSpirvLowerConstImmediateStore.h"
+#include "llpcSpirvLowerMemoryOp.h"
+#include "llvm/IR/InstVisitor.h"
+
+namespace Llpc {
+
+// =====================================================================================================================
+// Represents the fused SPIR-V lowering pass. It walks the instructions of the module once and dispatches each
+// instruction to the handlers of the lowering concerns that would otherwise each walk the whole module, currently
+// constant immediate store and memory operations. The individual passes are kept and can be scheduled instead with
+// -disable-fused-spirv-lower, for debugging.
+class SpirvLowerFused : public SpirvLower, public llvm::InstVisitor<SpirvLowerFused> {
+public:
+  SpirvLowerFused();
+
+  virtual bool runOnModule(llvm::Module &module);
+  void visitAllocaInst(llvm::AllocaInst &allocaInst);
+  void visitGetElementPtrInst(llvm::GetElementPtrInst &getElemPtrInst);
+  void visitExtractElementInst(llvm::ExtractElementInst &extractElementInst);
+
+  static char ID; // ID of this pass
+
+private:
+  SpirvLowerFused(const SpirvLowerFused &) = delete;
+  SpirvLowerFused &operator=(const SpirvLowerFused &) = delete;
+
+  SpirvLowerConstImmediateStore m_constImmediateStoreLower; // Handler for the constant immediate store concern
+  SpirvLowerMemoryOp m_memoryOpLower;                       // Handler for the memory operation concern
+};
+
+} // namespace Llpc
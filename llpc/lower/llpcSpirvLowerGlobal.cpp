@@ -29,7 +29,9 @@
  ***********************************************************************************************************************
  */
 #include "llpcSpirvLowerGlobal.h"
+#include "SPIRVInstruction.h"
 #include "SPIRVInternal.h"
+#include "SPIRVModule.h"
 #include "llpcContext.h"
 #include "llpcDebug.h"
 #include "llpcSpirvLowerUtil.h"
@@ -159,7 +161,8 @@ ModulePass *createSpirvLowerGlobal() {
 
 // =====================================================================================================================
 SpirvLowerGlobal::SpirvLowerGlobal()
-    : SpirvLower(ID), m_retBlock(nullptr), m_lowerInputInPlace(false), m_lowerOutputInPlace(false) {
+    : SpirvLower(ID), m_retBlock(nullptr), m_lowerInputInPlace(false), m_lowerOutputInPlace(false),
+      m_filterUnusedOutputs(false) {
 }
 
 // =====================================================================================================================
@@ -595,6 +598,17 @@ void SpirvLowerGlobal::mapGlobalVariableToProxy(GlobalVariable *globalVar) {
   Twine prefix = LlpcName::GlobalProxyPrefix;
   auto insertPos = m_entryPoint->begin()->getFirstInsertionPt();
 
+  // Fast path: an initialized global variable whose single use is a whole-variable "load" never observes any
+  // other value, so the load just becomes the initializer and no proxy variable is needed.
+  if (globalVar->hasInitializer() && globalVar->hasOneUse()) {
+    if (auto loadInst = dyn_cast<LoadInst>(globalVar->user_back())) {
+      loadInst->replaceAllUsesWith(globalVar->getInitializer());
+      loadInst->eraseFromParent();
+      m_globalVarProxyMap[globalVar] = nullptr;
+      return;
+    }
+  }
+
   auto proxy = new AllocaInst(globalVarTy, dataLayout.getAllocaAddrSpace(), prefix + globalVar->getName(), &*insertPos);
 
   if (globalVar->hasInitializer()) {
@@ -627,6 +641,21 @@ void SpirvLowerGlobal::mapInputToProxy(GlobalVariable *input) {
   assert(metaNode);
 
   auto meta = mdconst::dyn_extract<Constant>(metaNode->getOperand(0));
+
+  // Fast path: an input whose single use is a whole-variable "load" needs no proxy variable. The same import
+  // call that would otherwise feed the proxy is emitted at the load instead, saving the alloca/store/load round
+  // trip that SROA would otherwise have to clean up.
+  if (input->hasOneUse()) {
+    if (auto loadInst = dyn_cast<LoadInst>(input->user_back())) {
+      auto inputValue = addCallInstForInOutImport(inputTy, SPIRAS_Input, meta, nullptr, 0, nullptr, nullptr,
+                                                  InterpLocUnknown, nullptr, loadInst);
+      loadInst->replaceAllUsesWith(inputValue);
+      loadInst->eraseFromParent();
+      m_inputProxyMap[input] = nullptr;
+      return;
+    }
+  }
+
   auto proxy = new AllocaInst(inputTy, dataLayout.getAllocaAddrSpace(), prefix + input->getName(), &*insertPos);
 
   // Import input to proxy variable
@@ -682,6 +711,12 @@ void SpirvLowerGlobal::lowerGlobalVar() {
   for (auto globalVarMap : m_globalVarProxyMap) {
     auto globalVar = cast<GlobalVariable>(globalVarMap.first);
     auto proxy = globalVarMap.second;
+    if (!proxy) {
+      // The global variable was lowered in place at its single load; just remove it.
+      assert(globalVar->use_empty());
+      globalVar->eraseFromParent();
+      continue;
+    }
     globalVar->mutateType(proxy->getType()); // To clear address space for pointer to make replacement valid
     globalVar->replaceAllUsesWith(proxy);
     globalVar->dropAllReferences();
@@ -732,6 +767,13 @@ void SpirvLowerGlobal::lowerInput() {
   for (auto inputMap : m_inputProxyMap) {
     auto input = cast<GlobalVariable>(inputMap.first);
 
+    if (!inputMap.second) {
+      // The input was lowered in place at its single load; just remove it.
+      assert(input->use_empty());
+      input->eraseFromParent();
+      continue;
+    }
+
     for (auto user = input->user_begin(), end = input->user_end(); user != end; ++user) {
       // NOTE: "Getelementptr" and "bitcast" will propogate the address space of pointer value (input variable)
       // to the element pointer value (destination). We have to clear the address space of this element pointer
@@ -754,6 +796,97 @@ void SpirvLowerGlobal::lowerInput() {
   }
 }
 
+// =====================================================================================================================
+// Gets the number of consecutive interface locations the given SPIR-V type occupies, following the location
+// assignment rules for in/out interface variables.
+//
+// @param ty : Pointee type of an interface variable
+static unsigned getLocationCount(SPIRVType *ty) {
+  if (ty->isTypeArray())
+    return ty->getArrayLength() * getLocationCount(ty->getArrayElementType());
+  if (ty->isTypeMatrix())
+    return ty->getMatrixColumnCount() * getLocationCount(ty->getMatrixColumnType());
+  if (ty->isTypeStruct()) {
+    unsigned locCount = 0;
+    for (unsigned memberIdx = 0; memberIdx < ty->getStructMemberCount(); ++memberIdx)
+      locCount += getLocationCount(ty->getStructMemberType(memberIdx));
+    return locCount;
+  }
+  // A 64-bit vector with more than two components covers two consecutive locations.
+  if (ty->isTypeVector() && ty->getVectorComponentCount() > 2 && ty->getVectorComponentType()->getBitWidth() == 64)
+    return 2;
+  return 1;
+}
+
+// =====================================================================================================================
+// Builds the set of generic output locations this stage can skip exporting. When this is the last vertex processing
+// stage of a graphics pipeline, a generic output location not declared as an input of the fragment shader is never
+// read, so its export call need not be built at all (rather than built here and removed by resource collecting in
+// the middle-end). On any uncertainty (no fragment shader SPIR-V at hand, an input without a static location) the
+// filter stays disabled and every output is exported.
+void SpirvLowerGlobal::buildUnusedOutputFilter() {
+  m_filterUnusedOutputs = false;
+  m_nextStageInputLocs.clear();
+
+  if (!m_context->getPipelineContext())
+    return;
+
+  const unsigned stageMask = m_context->getShaderStageMask();
+  if ((stageMask & shaderStageToMask(ShaderStageFragment)) == 0)
+    return;
+
+  // Only the last vertex processing stage feeds the fragment shader directly.
+  ShaderStage lastVertexStage = ShaderStageInvalid;
+  for (auto stage : {ShaderStageGeometry, ShaderStageTessEval, ShaderStageVertex}) {
+    if (stageMask & shaderStageToMask(stage)) {
+      lastVertexStage = stage;
+      break;
+    }
+  }
+  if (m_shaderStage != lastVertexStage)
+    return;
+
+  auto fragShaderInfo = m_context->getPipelineShaderInfo(ShaderStageFragment);
+  if (!fragShaderInfo || !fragShaderInfo->pModuleData)
+    return;
+  auto fragModuleData = reinterpret_cast<const ShaderModuleData *>(fragShaderInfo->pModuleData);
+  if (fragModuleData->binType != BinaryType::Spirv)
+    return;
+
+  SPIRVModule *fragModule = m_context->getOrParseSpirvModule(fragModuleData->binCode);
+  for (unsigned i = 0, varCount = fragModule->getNumVariables(); i < varCount; ++i) {
+    auto var = fragModule->getVariable(i);
+    if (var->getStorageClass() != StorageClassInput)
+      continue;
+
+    auto pointeeTy = var->getType()->getPointerElementType();
+    SPIRVWord loc = 0;
+    if (!var->hasDecorate(DecorationLocation, 0, &loc)) {
+      // Built-in inputs have no location and are not subject to this filter; built-in blocks carry the decoration
+      // on their members instead of the variable.
+      if (var->hasDecorate(DecorationBuiltIn) ||
+          (pointeeTy->isTypeStruct() && pointeeTy->hasMemberDecorate(0, DecorationBuiltIn)))
+        continue;
+      // An input with neither a location nor a built-in decoration leaves the consumed set unknown.
+      return;
+    }
+
+    // Member-level locations may place block members outside the span computed from the type, so do not try to
+    // reason about such inputs.
+    if (pointeeTy->isTypeStruct()) {
+      for (unsigned memberIdx = 0; memberIdx < pointeeTy->getStructMemberCount(); ++memberIdx) {
+        if (pointeeTy->hasMemberDecorate(memberIdx, DecorationLocation))
+          return;
+      }
+    }
+
+    for (unsigned offset = 0, locCount = getLocationCount(pointeeTy); offset < locCount; ++offset)
+      m_nextStageInputLocs.insert(loc + offset);
+  }
+
+  m_filterUnusedOutputs = true;
+}
+
 // =====================================================================================================================
 // Does lowering opertions for SPIR-V outputs, replaces outputs with proxy variables.
 void SpirvLowerGlobal::lowerOutput() {
@@ -784,6 +917,8 @@ void SpirvLowerGlobal::lowerOutput() {
   // instructions with import/export calls in-place.
   assert(m_shaderStage != ShaderStageTessControl);
 
+  buildUnusedOutputFilter();
+
   // Export output from the proxy variable prior to "return" instruction or "emit" calls
   for (auto outputMap : m_outputProxyMap) {
     auto output = cast<GlobalVariable>(outputMap.first);
@@ -1342,6 +1477,21 @@ void SpirvLowerGlobal::addCallInstForOutputExport(Value *outputValue, Constant *
                                         << "xfbOffset = " << cast<ConstantInt>(xfbOffset)->getZExtValue() << "\n");
     }
 
+    // Skip building the export call altogether when the fragment shader provably never reads this location.
+    // Transform feedback outputs are consumed by the stream-out unit regardless of the fragment shader.
+    if (m_filterUnusedOutputs && !outputMeta.IsXfb && isa<ConstantInt>(locOffset)) {
+      const unsigned startLoc = location + cast<ConstantInt>(locOffset)->getZExtValue();
+      // A 64-bit vector with more than two components covers two consecutive locations.
+      const bool isWide64BitVector = outputTy->isVectorTy() && outputTy->getScalarSizeInBits() == 64 &&
+                                     cast<VectorType>(outputTy)->getNumElements() > 2;
+      const unsigned locCount = isWide64BitVector ? 2 : 1;
+      bool consumed = false;
+      for (unsigned i = 0; i < locCount; ++i)
+        consumed |= m_nextStageInputLocs.count(startLoc + i) > 0;
+      if (!consumed)
+        return;
+    }
+
     m_builder->CreateWriteGenericOutput(outputValue, location, locOffset, elemIdx, maxLocOffset, outputInfo, vertexIdx);
   }
 }
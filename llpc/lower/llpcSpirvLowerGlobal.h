@@ -64,6 +64,7 @@ private:
   void lowerGlobalVar();
   void lowerInput();
   void lowerOutput();
+  void buildUnusedOutputFilter();
   void lowerInOutInPlace();
   void lowerBufferBlock();
   void lowerPushConsts();
@@ -105,6 +106,11 @@ private:
   bool m_lowerInputInPlace;  // Whether to lower input inplace
   bool m_lowerOutputInPlace; // Whether to lower output inplace
 
+  bool m_filterUnusedOutputs;                        // Whether to skip building export calls for generic outputs
+                                                     //  the fragment shader provably never reads
+  std::unordered_set<unsigned> m_nextStageInputLocs; // Generic input locations declared by the fragment shader,
+                                                     //  valid when m_filterUnusedOutputs is set
+
   // Flags controlling how to behave when visting the instructions
   union {
     struct {
@@ -31,8 +31,14 @@
 #include "llpcSpirvLowerLoopUnrollControl.h"
 #include "SPIRVInternal.h"
 #include "llpcContext.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/Twine.h"
 #include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/Support/Debug.h"
+#include <algorithm>
+#include <unordered_map>
 #include <vector>
 
 #define DEBUG_TYPE "llpc-spirv-lower-loop-unroll-control"
@@ -51,6 +57,41 @@ using namespace llvm;
 using namespace SPIRV;
 using namespace Llpc;
 
+// -llpc-loop-unroll-overrides: comma-separated headerHash:unrollCount pairs pinning the unroll decision for
+// specific loops without a compiler rebuild. A count of 0 disables unrolling of that loop. The hashes are
+// reported by this pass's debug output (-debug-only=llpc-spirv-lower-loop-unroll-control).
+static cl::opt<std::string>
+    LoopUnrollOverrides("llpc-loop-unroll-overrides", cl::init(""),
+                        cl::desc("Comma-separated headerHash:unrollCount pairs pinning the unroll "
+                                 "decision for specific loops (count 0 disables unrolling)"));
+
+// Loops whose body exceeds this many instructions have their forced unroll count capped hard.
+static const unsigned LargeLoopBodySize = 256;
+
+// Loops with more memory operations than this have their forced unroll count capped.
+static const unsigned MemoryHeavyLoopOps = 32;
+
+// =====================================================================================================================
+// Returns the per-loop override table, parsed once from -llpc-loop-unroll-overrides.
+static const std::unordered_map<uint64_t, unsigned> &getLoopUnrollOverrides() {
+  static const std::unordered_map<uint64_t, unsigned> Overrides = [] {
+    std::unordered_map<uint64_t, unsigned> table;
+    StringRef rest = LoopUnrollOverrides;
+    while (!rest.empty()) {
+      StringRef entry;
+      std::tie(entry, rest) = rest.split(',');
+      StringRef hashStr, countStr;
+      std::tie(hashStr, countStr) = entry.split(':');
+      uint64_t hashKey = 0;
+      unsigned count = 0;
+      if (!hashStr.getAsInteger(0, hashKey) && !countStr.getAsInteger(0, count))
+        table[hashKey] = count;
+    }
+    return table;
+  }();
+  return Overrides;
+}
+
 namespace Llpc {
 
 // =====================================================================================================================
@@ -78,6 +119,75 @@ SpirvLowerLoopUnrollControl::SpirvLowerLoopUnrollControl(unsigned forceLoopUnrol
     : SpirvLower(ID), m_forceLoopUnrollCount(forceLoopUnrollCount), m_disableLicm(false), m_disableLoopUnroll(false) {
 }
 
+// =====================================================================================================================
+// Scans one loop, identified by its latch block, and summarizes it for the unroll policy.
+//
+// The latch branches back to the loop header. With the structured control flow the SPIR-V reader emits, the
+// header precedes the latch in layout order and the loop body is the contiguous block range between them, so a
+// linear walk is a sufficient quick scan; no dominator or loop analysis is available this early in lowering.
+//
+// @param latch : Latch block of the loop (the block carrying the llvm.loop metadata)
+SpirvLowerLoopUnrollControl::LoopScanInfo SpirvLowerLoopUnrollControl::scanLoop(BasicBlock *latch) {
+  LoopScanInfo loopInfo = {};
+
+  // The header is the first successor of the latch in layout order that does not come after the latch.
+  Function *func = latch->getParent();
+  for (BasicBlock &block : *func) {
+    for (BasicBlock *successor : successors(latch)) {
+      if (successor == &block) {
+        loopInfo.header = &block;
+        break;
+      }
+    }
+    if (loopInfo.header || &block == latch)
+      break;
+  }
+  if (!loopInfo.header)
+    return loopInfo;
+
+  // A latch condition comparing against a constant means the trip count is a compile-time constant, the case
+  // where forced unrolling pays off most reliably.
+  if (auto branch = dyn_cast<BranchInst>(latch->getTerminator())) {
+    if (branch->isConditional()) {
+      if (auto compare = dyn_cast<ICmpInst>(branch->getCondition()))
+        loopInfo.constantTripCount =
+            isa<ConstantInt>(compare->getOperand(0)) || isa<ConstantInt>(compare->getOperand(1));
+    }
+  }
+
+  // Hash the opcode structure of the body rather than any names or pointers, so the key is stable across
+  // compiles and compiler builds and can be pinned in -llpc-loop-unroll-overrides.
+  uint64_t hash = 0;
+  for (BasicBlock *block = loopInfo.header;; block = block->getNextNode()) {
+    for (Instruction &inst : *block) {
+      ++loopInfo.bodySize;
+      if (isa<LoadInst>(inst) || isa<StoreInst>(inst) || isa<CallInst>(inst))
+        ++loopInfo.memoryOps;
+      hash = static_cast<size_t>(hash_combine(hash, inst.getOpcode(), inst.getNumOperands()));
+    }
+    if (block == latch)
+      break;
+  }
+  loopInfo.headerHash = hash;
+
+  return loopInfo;
+}
+
+// =====================================================================================================================
+// Derives the unroll count for one loop from the forced count and the loop's scan summary, capping the forced
+// count for loops where aggressive unrolling mostly costs code size and register pressure.
+//
+// @param loopInfo : Scan summary of the loop
+unsigned SpirvLowerLoopUnrollControl::classifyLoopUnrollCount(const LoopScanInfo &loopInfo) const {
+  if (!loopInfo.header)
+    return m_forceLoopUnrollCount;
+  if (loopInfo.bodySize > LargeLoopBodySize)
+    return std::min(m_forceLoopUnrollCount, 2u);
+  if (loopInfo.memoryOps > MemoryHeavyLoopOps && !loopInfo.constantTripCount)
+    return std::min(m_forceLoopUnrollCount, 4u);
+  return m_forceLoopUnrollCount;
+}
+
 // =====================================================================================================================
 // Executes this SPIR-V lowering pass on the specified LLVM module.
 //
@@ -95,9 +205,20 @@ bool SpirvLowerLoopUnrollControl::runOnModule(Module &module) {
     m_disableLicm = shaderOptions->disableLicm | cl::DisableLicm;
 #endif
     m_disableLoopUnroll = shaderOptions->disableLoopUnroll;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+    // Profile feedback: a pipeline observed VGPR-limited gets no forced unrolling at all, since unrolling
+    // mostly grows in-flight register state there; one observed memory-bound has its forced count capped, as
+    // the extra ILP cannot hide misses the way more waves can.
+    if (const PipelineProfileMetrics *metrics = m_context->getPipelineContext()->getProfileMetrics()) {
+      if (metrics->limiter == ProfileOccupancyLimiter::Vgprs)
+        m_forceLoopUnrollCount = std::min(m_forceLoopUnrollCount, 1u);
+      else if (metrics->memoryBound)
+        m_forceLoopUnrollCount = std::min(m_forceLoopUnrollCount, 2u);
+    }
+#endif
   }
 
-  if (m_forceLoopUnrollCount == 0 && !m_disableLicm && !m_disableLoopUnroll)
+  if (m_forceLoopUnrollCount == 0 && !m_disableLicm && !m_disableLoopUnroll && getLoopUnrollOverrides().empty())
     return false;
 
   if (m_shaderStage == ShaderStageTessControl || m_shaderStage == ShaderStageTessEval ||
@@ -115,21 +236,45 @@ bool SpirvLowerLoopUnrollControl::runOnModule(Module &module) {
           (loopMetaNode->getNumOperands() != 1 && !m_disableLicm && !m_disableLoopUnroll))
         continue;
 
-      if (m_disableLoopUnroll) {
+      // Differentiate the decision per loop: a quick scan classifies the loop, and the override table can pin
+      // the decision for a specific loop by its stable header hash.
+      unsigned unrollCount = m_forceLoopUnrollCount;
+      bool disableUnroll = m_disableLoopUnroll;
+      if (!getLoopUnrollOverrides().empty() || (unrollCount != 0 && !disableUnroll)) {
+        const LoopScanInfo loopInfo = scanLoop(&block);
+        LLVM_DEBUG(dbgs() << "Loop with header hash 0x" << Twine::utohexstr(loopInfo.headerHash) << ": body size "
+                          << loopInfo.bodySize << ", memory ops " << loopInfo.memoryOps << ", constant trip count "
+                          << loopInfo.constantTripCount << "\n");
+        auto &overrides = getLoopUnrollOverrides();
+        auto overrideIt = overrides.find(loopInfo.headerHash);
+        if (overrideIt != overrides.end()) {
+          if (overrideIt->second == 0) {
+            disableUnroll = true;
+          } else {
+            unrollCount = overrideIt->second;
+            disableUnroll = false;
+          }
+        } else if (unrollCount != 0 && !disableUnroll) {
+          unrollCount = classifyLoopUnrollCount(loopInfo);
+        }
+      }
+
+      MDNode *origLoopMetaNode = loopMetaNode;
+      if (disableUnroll) {
         // The disableLoopUnroll option overrides any existing loop metadata (so is subtly different to
         // forceLoopUnrollCount=1 which defers to any existing metadata). We can simply concatenate
         // it as it takes precedence over any other metadata that may already be present.
         MDNode *disableLoopUnrollMetaNode =
             MDNode::get(*m_context, MDString::get(*m_context, "llvm.loop.unroll.disable"));
         loopMetaNode = MDNode::concatenate(loopMetaNode, MDNode::get(*m_context, disableLoopUnrollMetaNode));
-      } else if (m_forceLoopUnrollCount && loopMetaNode->getNumOperands() <= 1) {
+      } else if (unrollCount && loopMetaNode->getNumOperands() <= 1) {
         // We have a loop backedge with !llvm.loop metadata containing just
         // one operand pointing to itself, meaning that the SPIR-V did not
         // have an unroll or don't-unroll directive, so we can add the force
         // unroll count metadata.
         Metadata *unrollCountMeta[] = {
             MDString::get(*m_context, "llvm.loop.unroll.count"),
-            ConstantAsMetadata::get(ConstantInt::get(Type::getInt32Ty(*m_context), m_forceLoopUnrollCount))};
+            ConstantAsMetadata::get(ConstantInt::get(Type::getInt32Ty(*m_context), unrollCount))};
         MDNode *loopUnrollCountMetaNode = MDNode::get(*m_context, unrollCountMeta);
         loopMetaNode = MDNode::concatenate(loopMetaNode, MDNode::get(*m_context, loopUnrollCountMetaNode));
         // We also disable all nonforced loop transformations to ensure our transformation is not blocked
@@ -141,6 +286,8 @@ bool SpirvLowerLoopUnrollControl::runOnModule(Module &module) {
         MDNode *licmDisableNode = MDNode::get(*m_context, MDString::get(*m_context, "llvm.licm.disable"));
         loopMetaNode = MDNode::concatenate(loopMetaNode, MDNode::get(*m_context, licmDisableNode));
       }
+      if (loopMetaNode == origLoopMetaNode)
+        continue;
       loopMetaNode->replaceOperandWith(0, loopMetaNode);
       terminator->setMetadata("llvm.loop", loopMetaNode);
       changed = true;
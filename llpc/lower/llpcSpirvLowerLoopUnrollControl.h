@@ -32,6 +32,10 @@
 
 #include "llpcSpirvLower.h"
 
+namespace llvm {
+class BasicBlock;
+} // namespace llvm
+
 namespace Llpc {
 
 // =====================================================================================================================
@@ -49,6 +53,18 @@ private:
   SpirvLowerLoopUnrollControl(const SpirvLowerLoopUnrollControl &) = delete;
   SpirvLowerLoopUnrollControl &operator=(const SpirvLowerLoopUnrollControl &) = delete;
 
+  // Summary of one loop produced by a quick scan of its body, used to differentiate the unroll policy per loop
+  struct LoopScanInfo {
+    llvm::BasicBlock *header; // Loop header block (back edge target of the latch)
+    uint64_t headerHash;      // Stable structural hash of the loop body, used as the per-loop override key
+    unsigned bodySize;        // Number of instructions in the loop body
+    unsigned memoryOps;       // Number of loads, stores and calls in the loop body
+    bool constantTripCount;   // Whether the latch condition compares against a constant
+  };
+
+  LoopScanInfo scanLoop(llvm::BasicBlock *latch);
+  unsigned classifyLoopUnrollCount(const LoopScanInfo &loopInfo) const;
+
   unsigned m_forceLoopUnrollCount; // Forced loop unroll count
   bool m_disableLicm;              // Disable LLVM LICM pass
   bool m_disableLoopUnroll;        // Forcibly disable loop unroll
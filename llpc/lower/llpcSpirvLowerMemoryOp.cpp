@@ -69,6 +69,17 @@ bool SpirvLowerMemoryOp::runOnModule(Module &module) {
 
   visit(m_module);
 
+  finishVisit();
+
+  LLVM_DEBUG(dbgs() << "After the pass Spirv-Lower-Memory-Op " << module);
+
+  return true;
+}
+
+// =====================================================================================================================
+// Applies the changes recorded during the visit. Called after the instruction walk finishes, either from
+// runOnModule or from the fused lowering pass that shares a single instruction walk.
+void SpirvLowerMemoryOp::finishVisit() {
   // Remove those instructions that are replaced by this lower pass
   for (auto inst : m_preRemoveInsts) {
     assert(inst->user_empty());
@@ -89,10 +100,6 @@ bool SpirvLowerMemoryOp::runOnModule(Module &module) {
     inst->eraseFromParent();
   }
   m_removeInsts.clear();
-
-  LLVM_DEBUG(dbgs() << "After the pass Spirv-Lower-Memory-Op " << module);
-
-  return true;
 }
 
 // =====================================================================================================================
@@ -59,6 +59,9 @@ public:
   virtual void visitGetElementPtrInst(llvm::GetElementPtrInst &getElementPtrInst);
   virtual void visitExtractElementInst(llvm::ExtractElementInst &extractElementInst);
 
+  // Applies the changes recorded during the visit, called after the instruction walk finishes
+  void finishVisit();
+
   static char ID; // ID of this pass
 
 private:
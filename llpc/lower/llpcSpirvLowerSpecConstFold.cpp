@@ -0,0 +1,139 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcSpirvLowerSpecConstFold.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::SpirvLowerSpecConstFold.
+ ***********************************************************************************************************************
+ */
+#include "llpcSpirvLowerSpecConstFold.h"
+#include "SPIRVInternal.h"
+#include "llpcContext.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Debug.h"
+#include <string.h>
+
+#define DEBUG_TYPE "llpc-spirv-lower-spec-const-fold"
+
+using namespace llvm;
+using namespace SPIRV;
+using namespace Llpc;
+
+namespace Llpc {
+
+// =====================================================================================================================
+// Initializes static members.
+char SpirvLowerSpecConstFold::ID = 0;
+
+// =====================================================================================================================
+// Pass creator, creates the pass that folds specialization constant globals to this pipeline's specialized values
+//
+// @param specializationInfo : Specialization info of this pipeline for the shader, can be null
+ModulePass *createSpirvLowerSpecConstFold(const VkSpecializationInfo *specializationInfo) {
+  return new SpirvLowerSpecConstFold(specializationInfo);
+}
+
+// =====================================================================================================================
+SpirvLowerSpecConstFold::SpirvLowerSpecConstFold() : SpirvLower(ID), m_specializationInfo(nullptr) {
+}
+
+// =====================================================================================================================
+// Executes this SPIR-V lowering pass on the specified LLVM module.
+//
+// @param [in,out] module : LLVM module to be run on
+bool SpirvLowerSpecConstFold::runOnModule(Module &module) {
+  LLVM_DEBUG(dbgs() << "Run the pass Spirv-Lower-Spec-Const-Fold\n");
+
+  SpirvLower::init(&module);
+
+  SmallVector<GlobalVariable *, 8> specConstGlobals;
+  for (GlobalVariable &global : module.globals()) {
+    if (global.getName().startswith(gSPIRVName::SpecConstantPrefix))
+      specConstGlobals.push_back(&global);
+  }
+
+  bool changed = false;
+  for (GlobalVariable *global : specConstGlobals) {
+    unsigned specId = 0;
+    if (global->getName().drop_front(strlen(gSPIRVName::SpecConstantPrefix)).getAsInteger(10, specId))
+      continue;
+
+    // The global's initializer holds the default value of the constant; replace it with the value this pipeline
+    // specializes it to, if any.
+    Constant *value = global->getInitializer();
+    Type *valueTy = global->getValueType();
+    if (m_specializationInfo) {
+      for (unsigned i = 0; i < m_specializationInfo->mapEntryCount; ++i) {
+        auto mapEntry = &m_specializationInfo->pMapEntries[i];
+        if (mapEntry->constantID != specId)
+          continue;
+
+        uint64_t data = 0;
+        assert(mapEntry->size <= sizeof(data));
+        memcpy(&data, static_cast<const uint8_t *>(m_specializationInfo->pData) + mapEntry->offset,
+               std::min(static_cast<size_t>(mapEntry->size), sizeof(data)));
+
+        if (valueTy->isIntegerTy(1))
+          value = data != 0 ? ConstantInt::getTrue(*m_context) : ConstantInt::getFalse(*m_context);
+        else if (valueTy->isIntegerTy())
+          value = ConstantInt::get(valueTy, data);
+        else if (valueTy->isFloatingPointTy()) {
+          value = ConstantFP::get(*m_context,
+                                  APFloat(valueTy->getFltSemantics(), APInt(valueTy->getPrimitiveSizeInBits(), data)));
+        }
+        break;
+      }
+    }
+
+    // All users are loads placed by the translator; fold them to the value and remove the global.
+    SmallVector<LoadInst *, 8> loads;
+    bool allUsersAreLoads = true;
+    for (User *user : global->users()) {
+      if (auto load = dyn_cast<LoadInst>(user))
+        loads.push_back(load);
+      else
+        allUsersAreLoads = false;
+    }
+    if (!allUsersAreLoads)
+      continue;
+
+    for (LoadInst *load : loads) {
+      load->replaceAllUsesWith(value);
+      load->eraseFromParent();
+    }
+    global->eraseFromParent();
+    changed = true;
+  }
+
+  return changed;
+}
+
+} // namespace Llpc
+
+// =====================================================================================================================
+// Initializes the pass that folds specialization constant globals to this pipeline's specialized values.
+INITIALIZE_PASS(SpirvLowerSpecConstFold, DEBUG_TYPE,
+                "Fold specialization constant globals to the pipeline's specialized values", false, false)
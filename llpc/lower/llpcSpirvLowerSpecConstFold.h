@@ -0,0 +1,61 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcSpirvLowerSpecConstFold.h
+ * @brief LLPC header file: contains declaration of class Llpc::SpirvLowerSpecConstFold.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llpcSpirvLower.h"
+
+namespace Llpc {
+
+// =====================================================================================================================
+// Represents the pass that folds the global variables standing in for specialization constants to this pipeline's
+// specialized values. The SPIR-V translator emits these globals when the module's specialization constants are
+// foldable, so one translation result can be specialized per pipeline instead of retranslating.
+class SpirvLowerSpecConstFold : public SpirvLower {
+public:
+  SpirvLowerSpecConstFold();
+
+  //
+  // @param specializationInfo : Specialization info of this pipeline for the shader, can be null
+  SpirvLowerSpecConstFold(const VkSpecializationInfo *specializationInfo)
+      : SpirvLower(ID), m_specializationInfo(specializationInfo) {}
+
+  virtual bool runOnModule(llvm::Module &module);
+
+  static char ID; // ID of this pass
+
+private:
+  SpirvLowerSpecConstFold(const SpirvLowerSpecConstFold &) = delete;
+  SpirvLowerSpecConstFold &operator=(const SpirvLowerSpecConstFold &) = delete;
+
+  const VkSpecializationInfo *m_specializationInfo; // Specialization info of this pipeline for the shader
+};
+
+} // namespace Llpc
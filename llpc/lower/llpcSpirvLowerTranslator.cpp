@@ -30,10 +30,11 @@
  */
 #include "llpcSpirvLowerTranslator.h"
 #include "LLVMSPIRVLib.h"
+#include "SPIRVStream.h"
 #include "llpcCompiler.h"
 #include "llpcContext.h"
 #include "lgc/Builder.h"
-#include <sstream>
+#include <istream>
 #include <string>
 
 #define DEBUG_TYPE "llpc-spirv-lower-translator"
@@ -48,8 +49,11 @@ char SpirvLowerTranslator::ID = 0;
 //
 // @param stage : Shader stage
 // @param shaderInfo : Shader info for this shader
-ModulePass *Llpc::createSpirvLowerTranslator(ShaderStage stage, const PipelineShaderInfo *shaderInfo) {
-  return new SpirvLowerTranslator(stage, shaderInfo);
+// @param foldSpecConstants : Translate foldable specialization constants symbolically; the caller must run
+//                            SpirvLowerSpecConstFold afterwards to substitute the specialized values
+ModulePass *Llpc::createSpirvLowerTranslator(ShaderStage stage, const PipelineShaderInfo *shaderInfo,
+                                             bool foldSpecConstants) {
+  return new SpirvLowerTranslator(stage, shaderInfo, foldSpecConstants);
 }
 
 // =====================================================================================================================
@@ -85,13 +89,15 @@ void SpirvLowerTranslator::translateSpirvToLlvm(const PipelineShaderInfo *shader
   if (ShaderModuleHelper::optimizeSpirv(spirvBin, &optimizedSpirvBin) == Result::Success)
     spirvBin = &optimizedSpirvBin;
 
-  std::string spirvCode(static_cast<const char *>(spirvBin->pCode), spirvBin->codeSize);
-  std::istringstream spirvStream(spirvCode);
   std::string errMsg;
   SPIRV::SPIRVSpecConstMap specConstMap;
   ShaderStage entryStage = shaderInfo->entryStage;
+  // When every specialization constant in the module is foldable, have the translator emit them as loads of
+  // dedicated globals instead of applying values here; SpirvLowerSpecConstFold substitutes this pipeline's values
+  // afterwards. The translation result is then independent of the specialization and can be reused across it.
+  const bool specConstsToGlobals = m_foldSpecConstants && moduleData->usage.specConstantsFoldable;
   // Build specialization constant map
-  if (shaderInfo->pSpecializationInfo) {
+  if (shaderInfo->pSpecializationInfo && !specConstsToGlobals) {
     for (unsigned i = 0; i < shaderInfo->pSpecializationInfo->mapEntryCount; ++i) {
       SPIRV::SPIRVSpecConstEntry specConstEntry = {};
       auto mapEntry = &shaderInfo->pSpecializationInfo->pMapEntries[i];
@@ -103,8 +109,24 @@ void SpirvLowerTranslator::translateSpirvToLlvm(const PipelineShaderInfo *shader
 
   Context *context = static_cast<Context *>(&module->getContext());
 
-  if (!readSpirv(context->getBuilder(), &(moduleData->usage), spirvStream, convertToExecModel(entryStage),
-                 shaderInfo->pEntryTarget, specConstMap, module, errMsg)) {
+  // Parse the binary, or reuse the representation already parsed for another stage of this pipeline so that
+  // stages compiled from one multi-entry-point module share a single parse. Translating with specialization
+  // values writes them into the parsed module, and the optimized binary is freed below, so both cases parse a
+  // module of their own instead of populating the shared cache.
+  std::unique_ptr<SPIRV::SPIRVModule> ownedModule;
+  SPIRV::SPIRVModule *parsedModule = nullptr;
+  if (specConstMap.empty() && spirvBin != &optimizedSpirvBin) {
+    parsedModule = context->getOrParseSpirvModule(*spirvBin);
+  } else {
+    // Present the binary to the reader in place; the decoder walks the raw word buffer once without copying it.
+    SPIRV::SPIRVMemoryStreamBuf spirvStreamBuf(static_cast<const char *>(spirvBin->pCode), spirvBin->codeSize);
+    std::istream spirvStream(&spirvStreamBuf);
+    ownedModule = parseSpirv(spirvStream);
+    parsedModule = ownedModule.get();
+  }
+
+  if (!readSpirv(context->getBuilder(), &(moduleData->usage), parsedModule, convertToExecModel(entryStage),
+                 shaderInfo->pEntryTarget, specConstMap, module, errMsg, specConstsToGlobals)) {
     report_fatal_error(Twine("Failed to translate SPIR-V to LLVM (") +
                            getShaderStageName(static_cast<ShaderStage>(entryStage)) + " shader): " + errMsg,
                        false);
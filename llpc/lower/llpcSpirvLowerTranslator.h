@@ -44,8 +44,10 @@ public:
   //
   // @param stage : Shader stage
   // @param shaderInfo : Shader info for this shader
-  SpirvLowerTranslator(ShaderStage stage, const PipelineShaderInfo *shaderInfo)
-      : SpirvLower(ID), m_shaderInfo(shaderInfo) {}
+  // @param foldSpecConstants : Translate foldable specialization constants symbolically; the caller must run
+  //                            SpirvLowerSpecConstFold afterwards to substitute the specialized values
+  SpirvLowerTranslator(ShaderStage stage, const PipelineShaderInfo *shaderInfo, bool foldSpecConstants = false)
+      : SpirvLower(ID), m_shaderInfo(shaderInfo), m_foldSpecConstants(foldSpecConstants) {}
 
   bool runOnModule(llvm::Module &module) override;
 
@@ -58,6 +60,7 @@ private:
   // -----------------------------------------------------------------------------------------------------------------
 
   const PipelineShaderInfo *m_shaderInfo; // Input shader info
+  bool m_foldSpecConstants = false;       // Translate foldable specialization constants symbolically
 };
 
 } // namespace Llpc
@@ -25,7 +25,7 @@ void main()
 
 ; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
 ; SHADERTEST: fmul {{.*}}double %{{[^, ]*}}, %{{[^, ]*}}
-; SHADERTEST: fadd {{.*}}double %{{[^, ]*}}, %{{[^, ]*}}
+; SHADERTEST: call {{.*}}@llvm.fmuladd.{{v[0-9]+f64|f64}}
 
 ; SHADERTEST: AMDLLPC SUCCESS
 */
@@ -22,7 +22,7 @@ void main()
 
 ; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
 ; SHADERTEST: fmul {{.*}}float %{{.*}}, %{{[^, ]*}}
-; SHADERTEST: fadd {{.*}}float %{{[^, ]*}}, %{{[^, ]*}}
+; SHADERTEST: call {{.*}}@llvm.fmuladd.{{v[0-9]+f32|f32}}
 
 ; SHADERTEST: AMDLLPC SUCCESS
 */
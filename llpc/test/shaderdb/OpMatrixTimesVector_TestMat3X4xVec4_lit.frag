@@ -28,7 +28,7 @@ void main()
 
 ; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
 ; SHADERTEST: fmul reassoc nnan nsz arcp contract afn float
-; SHADERTEST: fadd reassoc nnan nsz arcp contract afn float
+; SHADERTEST: call {{.*}}@llvm.fmuladd.{{v[0-9]+f32|f32}}
 
 ; SHADERTEST: AMDLLPC SUCCESS
 */
@@ -61,8 +61,14 @@
 #endif
 #endif
 
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdlib.h> // getenv
+#include <thread>
+#include <tuple>
 
 // NOTE: To enable VLD, please add option BUILD_WIN_VLD=1 in build option.To run amdllpc with VLD enabled,
 // please copy vld.ini and all files in.\winVisualMemDetector\bin\Win64 to current directory of amdllpc.
@@ -75,12 +81,17 @@
 #endif
 #include "llpc.h"
 #include "llpcDebug.h"
+#include "llpcFile.h"
+#include "llpcShaderCacheManager.h"
 #include "llpcShaderModuleHelper.h"
 #include "llpcSpirvLowerUtil.h"
 #include "llpcUtil.h"
 #include "spvgen.h"
 #include "vfx.h"
 #include "vkgcElfReader.h"
+#include "vkgcMetroHash.h"
+#include "vkgcPipelineDumper.h"
+#include "vkgcUtil.h"
 
 #define DEBUG_TYPE "amd-llpc"
 
@@ -90,15 +101,18 @@ using namespace Vkgc;
 
 // Represents options of LLPC standalone tool.
 
-// -gfxip: graphics IP version
-static cl::opt<std::string> GfxIp("gfxip", cl::desc("Graphics IP version"), cl::value_desc("major.minor.step"),
-                                  cl::init("8.0.2"));
+// -gfxip: graphics IP version(s); a comma-separated list compiles the inputs once per listed target
+static cl::opt<std::string> GfxIp("gfxip", cl::desc("Graphics IP version(s), comma-separated"),
+                                  cl::value_desc("major.minor.step[,major.minor.step]..."), cl::init("8.0.2"));
 
-// The GFXIP version parsed out of the -gfxip option before normal option processing occurs.
+// The primary GFXIP version parsed out of the -gfxip option before normal option processing occurs.
 static GfxIpVersion ParsedGfxIp = {8, 0, 2};
 
+// All GFXIP versions parsed out of the -gfxip option, in listed order; ParsedGfxIp is the first of them.
+static std::vector<GfxIpVersion> ParsedGfxIps;
+
 // Input sources
-static cl::list<std::string> InFiles(cl::Positional, cl::OneOrMore, cl::ValueRequired,
+static cl::list<std::string> InFiles(cl::Positional, cl::ZeroOrMore, cl::ValueRequired,
                                      cl::desc("<source>...\n"
                                               "Type of input file is determined by its filename extension:\n"
                                               "  .spv      SPIR-V binary\n"
@@ -115,6 +129,56 @@ static cl::list<std::string> InFiles(cl::Positional, cl::OneOrMore, cl::ValueReq
 // -o: output
 static cl::opt<std::string> OutFile("o", cl::desc("Output file"), cl::value_desc("filename (\"-\" for stdout)"));
 
+// -j: number of parallel compile threads
+static cl::opt<unsigned> NumThreads("j",
+                                    cl::desc("Number of worker threads used to compile separate pipeline input "
+                                             "files in parallel (0 or 1 = compile serially)"),
+                                    cl::value_desc("N"), cl::init(0));
+
+// -profile-feedback-file: GPU profile feedback consulted by the wave size and loop unrolling decisions
+static cl::opt<std::string> ProfileFeedbackFile("profile-feedback-file",
+                                                cl::desc("File of per-pipeline GPU profile metrics "
+                                                         "(\"<pipelineHash> <limiter> <memBound> <avgWaves>\" "
+                                                         "per line) consulted when compiling those pipelines"),
+                                                cl::value_desc("filename"), cl::init(""));
+
+// -replay-trace: re-execute a recorded compile trace
+static cl::opt<std::string> ReplayTrace("replay-trace",
+                                        cl::desc("Replay a compile.trace index recorded with -compile-trace-dir: "
+                                                 "re-executes the recorded pipeline builds with the recorded "
+                                                 "per-thread assignment and ordering"),
+                                        cl::value_desc("tracefile"), cl::init(""));
+
+// -server: stay resident and accept compile jobs over stdin
+static cl::opt<bool> ServerMode("server",
+                                cl::desc("Stay resident and read compile jobs from stdin, one per line: an input "
+                                         "file path optionally followed by an output file path. A status line "
+                                         "(\"OK <file>\" or \"ERR <file>\") is printed after each job. LLVM "
+                                         "initialization, the compiler instance and warmed contexts are reused "
+                                         "across all jobs."),
+                                cl::init(false));
+
+// -pipeline-dump-container: collect pipeline dumps into one sequentially written container file
+static cl::opt<std::string>
+    PipelineDumpContainer("pipeline-dump-container",
+                          cl::desc("Collect pipeline dumps as records of the given container file instead of "
+                                   "one .pipe/.elf file per pipeline; expand with -unpack-pipeline-dump"),
+                          cl::value_desc("filename"), cl::init(""));
+
+// -unpack-pipeline-dump: expand a pipeline dump container into per-pipeline files and exit
+static cl::opt<std::string>
+    UnpackPipelineDump("unpack-pipeline-dump",
+                       cl::desc("Expand a container written with -pipeline-dump-container into the per-pipeline "
+                                "files of -enable-pipeline-dump, in the -pipeline-dump-dir directory, then exit"),
+                       cl::value_desc("filename"), cl::init(""));
+
+// -compact-shader-cache: rewrite the on-disk shader cache file and exit
+static cl::opt<bool>
+    CompactShaderCache("compact-shader-cache",
+                       cl::desc("Rewrite the on-disk shader cache selected by the -shader-cache-* options with its "
+                                "entries laid out in last-access order and superseded blobs dropped, then exit"),
+                       cl::init(false));
+
 // -l: link pipeline
 static cl::opt<bool> ToLink("l", cl::desc("Link pipeline and generate ISA codes"), cl::init(true));
 
@@ -132,6 +196,11 @@ static cl::opt<std::string> EntryTarget("entry-target", cl::desc("Name string of
 static cl::opt<bool> IgnoreColorAttachmentFormats("ignore-color-attachment-formats",
                                                   cl::desc("Ignore color attachment formats"), cl::init(false));
 
+// -compile-pipe: compile each input .pipe file to its binary form, written alongside the input with a .bpipe
+// extension. A .bpipe is loaded with near-zero parsing cost and can be used wherever a .pipe is accepted.
+static cl::opt<bool> CompilePipe("compile-pipe",
+                                 cl::desc("Compile each input .pipe file to a binary .bpipe file"), cl::init(false));
+
 // -enable-ngg: enable NGG mode
 static cl::opt<bool> EnableNgg("enable-ngg", cl::desc("Enable implicit primitive shader (NGG) mode"), cl::init(true));
 
@@ -231,6 +300,14 @@ static cl::opt<unsigned>
 // -spvgen-dir: load SPVGEN from specified directory
 static cl::opt<std::string> SpvGenDir("spvgen-dir", cl::desc("Directory to load SPVGEN library from"));
 
+// -spvasm-cache-dir: sidecar cache of assembled SPIR-V binaries for assembly text inputs
+static cl::opt<std::string>
+    SpvAsmCacheDir("spvasm-cache-dir",
+                   cl::desc("Directory caching the assembled binaries of SPIR-V assembly text inputs, keyed and "
+                            "validated by content digest, so repeated runs over an unchanged corpus skip text "
+                            "assembly (empty = disabled)"),
+                   cl::value_desc("dir"));
+
 static cl::opt<bool> RobustBufferAccess("robust-buffer-access", cl::desc("Validate if the index is out of bounds"),
                                         cl::init(false));
 
@@ -290,6 +367,7 @@ namespace LlpcExt {
 const char SpirvBin[] = ".spv";
 const char SpirvText[] = ".spvasm";
 const char PipelineInfo[] = ".pipe";
+const char PipelineBinary[] = ".bpipe";
 const char LlvmIr[] = ".ll";
 
 } // namespace LlpcExt
@@ -394,17 +472,27 @@ static Result init(int argc, char *argv[], ICompiler **ppCompiler) {
         gfxipStr = arg.slice(1, StringRef::npos);
       else
         continue;
-      if (!gfxipStr.consumeInteger(10, ParsedGfxIp.major)) {
-        ParsedGfxIp.minor = 0;
-        ParsedGfxIp.stepping = 0;
-        if (gfxipStr.startswith(".")) {
-          gfxipStr = gfxipStr.slice(1, StringRef::npos);
-          if (!gfxipStr.consumeInteger(10, ParsedGfxIp.minor) && gfxipStr.startswith(".")) {
-            gfxipStr = gfxipStr.slice(1, StringRef::npos);
-            gfxipStr.consumeInteger(10, ParsedGfxIp.stepping);
+      // The option value is a comma-separated list of targets; the first one is the primary target that
+      // existing single-target behavior keys off.
+      while (!gfxipStr.empty()) {
+        StringRef oneGfxipStr;
+        std::tie(oneGfxipStr, gfxipStr) = gfxipStr.split(',');
+        GfxIpVersion gfxIp = {8, 0, 2};
+        if (!oneGfxipStr.consumeInteger(10, gfxIp.major)) {
+          gfxIp.minor = 0;
+          gfxIp.stepping = 0;
+          if (oneGfxipStr.startswith(".")) {
+            oneGfxipStr = oneGfxipStr.slice(1, StringRef::npos);
+            if (!oneGfxipStr.consumeInteger(10, gfxIp.minor) && oneGfxipStr.startswith(".")) {
+              oneGfxipStr = oneGfxipStr.slice(1, StringRef::npos);
+              oneGfxipStr.consumeInteger(10, gfxIp.stepping);
+            }
           }
         }
+        ParsedGfxIps.push_back(gfxIp);
       }
+      if (!ParsedGfxIps.empty())
+        ParsedGfxIp = ParsedGfxIps[0];
       break;
     }
 
@@ -448,6 +536,17 @@ static Result init(int argc, char *argv[], ICompiler **ppCompiler) {
     result = ICompiler::Create(ParsedGfxIp, argc, argv, ppCompiler);
   }
 
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  if (result == Result::Success && !ProfileFeedbackFile.empty()) {
+    result = (*ppCompiler)->LoadProfileFeedback(ProfileFeedbackFile.c_str());
+    if (result != Result::Success)
+      LLPC_ERRS("Failed to load profile feedback from " << ProfileFeedbackFile << "\n");
+  }
+#endif
+
+  if (result == Result::Success && !PipelineDumpContainer.empty())
+    Vkgc::PipelineDumper::SetDumpContainerFile(PipelineDumpContainer.c_str());
+
   if (result == Result::Success && SpvGenDir != "") {
     // -spvgen-dir option: preload spvgen from the given directory
     if (!InitSpvGen(SpvGenDir.c_str())) {
@@ -463,11 +562,12 @@ static Result init(int argc, char *argv[], ICompiler **ppCompiler) {
 // Performs per-pipeline initialization work for LLPC standalone tool.
 //
 // @param [out] compileInfo : Compilation info of LLPC standalone tool
-static Result initCompileInfo(CompileInfo *compileInfo) {
-  compileInfo->gfxIp = ParsedGfxIp;
+// @param gfxIp : Graphics IP version the pipeline is compiled for
+static Result initCompileInfo(CompileInfo *compileInfo, GfxIpVersion gfxIp) {
+  compileInfo->gfxIp = gfxIp;
 
   // Set NGG control settings
-  if (ParsedGfxIp.major >= 10) {
+  if (gfxIp.major >= 10) {
     auto &nggState = compileInfo->gfxPipelineInfo.nggState;
 
     nggState.enableNgg = EnableNgg;
@@ -563,7 +663,8 @@ static bool isSpirvBinaryFile(const std::string &fileName) {
 }
 
 // =====================================================================================================================
-// Checks whether the specified file name represents a LLPC pipeline info file (.pipe).
+// Checks whether the specified file name represents a LLPC pipeline info file (.pipe) or its compiled binary
+// form (.bpipe).
 //
 // @param fileName : File name to check
 static bool isPipelineInfoFile(const std::string &fileName) {
@@ -574,7 +675,7 @@ static bool isPipelineInfoFile(const std::string &fileName) {
   if (extPos != std::string::npos)
     extName = fileName.substr(extPos, fileName.size() - extPos);
 
-  if (!extName.empty() && extName == LlpcExt::PipelineInfo)
+  if (!extName.empty() && (extName == LlpcExt::PipelineInfo || extName == LlpcExt::PipelineBinary))
     isPipelineInfo = true;
 
   return isPipelineInfo;
@@ -604,29 +705,16 @@ static bool isLlvmIrFile(const std::string &fileName) {
 // @param spvBinFile : SPIR-V binary file
 // @param [out] spvBin : SPIR-V binary codes
 static Result getSpirvBinaryFromFile(const std::string &spvBinFile, BinaryData *spvBin) {
-  Result result = Result::Success;
-
-  FILE *binFile = fopen(spvBinFile.c_str(), "rb");
-  if (!binFile) {
+  char *bin = nullptr;
+  size_t binSize = 0;
+  Result result = File::readAll(spvBinFile.c_str(), &bin, &binSize);
+  if (result != Result::Success) {
     LLPC_ERRS("Fails to open SPIR-V binary file: " << spvBinFile << "\n");
-    result = Result::ErrorUnavailable;
+    return result;
   }
 
-  if (result == Result::Success) {
-    fseek(binFile, 0, SEEK_END);
-    size_t binSize = ftell(binFile);
-    fseek(binFile, 0, SEEK_SET);
-
-    char *bin = new char[binSize];
-    assert(bin);
-    memset(bin, 0, binSize);
-    binSize = fread(bin, 1, binSize, binFile);
-
-    spvBin->codeSize = binSize;
-    spvBin->pCode = bin;
-
-    fclose(binFile);
-  }
+  spvBin->codeSize = binSize;
+  spvBin->pCode = bin;
 
   return result;
 }
@@ -653,11 +741,11 @@ static Result compileGlsl(const std::string &inFilename, ShaderStage *stage, std
   }
   *stage = sourceLangToShaderStage(lang);
 
-  FILE *inFile = fopen(inFilename.c_str(), "r");
-  if (!inFile) {
+  char *glslText = nullptr;
+  size_t textSize = 0;
+  result = File::readAll(inFilename.c_str(), &glslText, &textSize, true);
+  if (result != Result::Success)
     LLPC_ERRS("Fails to open input file: " << inFilename << "\n");
-    result = Result::ErrorUnavailable;
-  }
 
   FILE *outFile = nullptr;
   if (result == Result::Success) {
@@ -671,16 +759,6 @@ static Result compileGlsl(const std::string &inFilename, ShaderStage *stage, std
   }
 
   if (result == Result::Success) {
-    fseek(inFile, 0, SEEK_END);
-    size_t textSize = ftell(inFile);
-    fseek(inFile, 0, SEEK_SET);
-
-    char *glslText = new char[textSize + 1];
-    assert(glslText);
-    memset(glslText, 0, textSize + 1);
-    auto readSize = fread(glslText, 1, textSize, inFile);
-    glslText[readSize] = 0;
-
     LLPC_OUTS("===============================================================================\n");
     LLPC_OUTS("// GLSL sources: " << inFilename << "\n\n");
     LLPC_OUTS(glslText);
@@ -722,13 +800,95 @@ static Result compileGlsl(const std::string &inFilename, ShaderStage *stage, std
 
     delete[] glslText;
 
-    fclose(inFile);
     fclose(outFile);
   }
 
   return result;
 }
 
+// =====================================================================================================================
+// Header stored ahead of a cached assembled SPIR-V binary. Validation is purely content-hash based: the file name
+// and the header carry the digest of the assembly text, and the header additionally carries a digest of the binary
+// payload, so a stale or truncated cache file is rejected regardless of its timestamps.
+struct SpvAsmCacheHeader {
+  uint64_t textDigest; // Digest of the assembly text this binary was assembled from
+  uint64_t binDigest;  // Digest of the binary payload that follows the header
+  uint64_t binSize;    // Size of the binary payload in bytes
+};
+
+// =====================================================================================================================
+// Returns the 64-bit content digest of the given buffer, for keying and validating the assembly cache.
+//
+// @param data : Buffer to digest
+// @param size : Size of the buffer in bytes
+static uint64_t getSpvAsmCacheDigest(const void *data, size_t size) {
+  MetroHash::Hash hash = {};
+  MetroHash64::Hash(static_cast<const uint8_t *>(data), size, hash.bytes);
+  return MetroHash::compact64(&hash);
+}
+
+// =====================================================================================================================
+// Returns the path of the assembly cache file for the given assembly text digest.
+//
+// @param textDigest : Digest of the assembly text
+static std::string getSpvAsmCachePath(uint64_t textDigest) {
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(textDigest));
+  return SpvAsmCacheDir + "/" + name;
+}
+
+// =====================================================================================================================
+// Tries to serve an assembled SPIR-V binary from the assembly cache. On a validated hit the binary payload is
+// written to the given output file and true is returned; any mismatch or read failure is treated as a miss.
+//
+// @param cachePath : Path of the cache file to probe
+// @param textDigest : Digest of the assembly text being assembled
+// @param [out] outFile : Output file receiving the binary on a hit
+static bool tryReadSpvAsmCache(const std::string &cachePath, uint64_t textDigest, FILE *outFile) {
+  char *data = nullptr;
+  size_t size = 0;
+  if (File::readAll(cachePath.c_str(), &data, &size, false) != Result::Success)
+    return false;
+
+  bool hit = false;
+  if (size >= sizeof(SpvAsmCacheHeader)) {
+    const auto *header = reinterpret_cast<const SpvAsmCacheHeader *>(data);
+    const char *payload = data + sizeof(SpvAsmCacheHeader);
+    if (header->textDigest == textDigest && header->binSize == size - sizeof(SpvAsmCacheHeader) &&
+        header->binDigest == getSpvAsmCacheDigest(payload, header->binSize)) {
+      fwrite(payload, 1, header->binSize, outFile);
+      hit = true;
+    }
+  }
+  delete[] data;
+  return hit;
+}
+
+// =====================================================================================================================
+// Stores a freshly assembled SPIR-V binary in the assembly cache. Best-effort: failures leave the cache entry
+// absent and the next run just assembles again.
+//
+// @param cachePath : Path of the cache file to write
+// @param textDigest : Digest of the assembly text the binary was assembled from
+// @param spvBin : Assembled SPIR-V binary
+// @param binSize : Size of the binary in bytes
+static void writeSpvAsmCache(const std::string &cachePath, uint64_t textDigest, const unsigned *spvBin,
+                             unsigned binSize) {
+  Vkgc::createDirectory(SpvAsmCacheDir.c_str());
+
+  FILE *cacheFile = fopen(cachePath.c_str(), "wb");
+  if (!cacheFile)
+    return;
+
+  SpvAsmCacheHeader header = {};
+  header.textDigest = textDigest;
+  header.binDigest = getSpvAsmCacheDigest(spvBin, binSize);
+  header.binSize = binSize;
+  fwrite(&header, 1, sizeof(header), cacheFile);
+  fwrite(spvBin, 1, binSize, cacheFile);
+  fclose(cacheFile);
+}
+
 // =====================================================================================================================
 // SPIR-V assembler, converts SPIR-V assembly text file (input) to SPIR-V binary file (output).
 //
@@ -742,11 +902,11 @@ static Result assembleSpirv(const std::string &inFilename, std::string &outFilen
 
   Result result = Result::Success;
 
-  FILE *inFile = fopen(inFilename.c_str(), "r");
-  if (!inFile) {
+  char *spvText = nullptr;
+  size_t textSize = 0;
+  result = File::readAll(inFilename.c_str(), &spvText, &textSize, true);
+  if (result != Result::Success)
     LLPC_ERRS("Fails to open input file: " << inFilename << "\n");
-    result = Result::ErrorUnavailable;
-  }
 
   FILE *outFile = nullptr;
   if (result == Result::Success) {
@@ -759,19 +919,27 @@ static Result assembleSpirv(const std::string &inFilename, std::string &outFilen
     }
   }
 
-  if (result == Result::Success) {
-    fseek(inFile, 0, SEEK_END);
-    size_t textSize = ftell(inFile);
-    fseek(inFile, 0, SEEK_SET);
-
-    char *spvText = new char[textSize + 1];
-    assert(spvText);
-    memset(spvText, 0, textSize + 1);
+  // Probe the assembly cache before paying for text assembly; a validated hit writes the cached binary
+  // straight to the output file.
+  uint64_t textDigest = 0;
+  std::string cachePath;
+  if (result == Result::Success && !SpvAsmCacheDir.empty()) {
+    textDigest = getSpvAsmCacheDigest(spvText, textSize);
+    cachePath = getSpvAsmCachePath(textDigest);
+    if (tryReadSpvAsmCache(cachePath, textDigest, outFile)) {
+      LLPC_OUTS("===============================================================================\n");
+      LLPC_OUTS("// SPIR-V disassembly: " << inFilename << " (from assembly cache)\n");
+      LLPC_OUTS(spvText);
+      LLPC_OUTS("\n\n");
 
-    size_t realSize = fread(spvText, 1, textSize, inFile);
-    spvText[realSize] = '\0';
+      fclose(outFile);
+      delete[] spvText;
+      return result;
+    }
+  }
 
-    int binSize = realSize * 4 + 1024; // Estimated SPIR-V binary size
+  if (result == Result::Success) {
+    int binSize = textSize * 4 + 1024; // Estimated SPIR-V binary size
     unsigned *spvBin = new unsigned[binSize / sizeof(unsigned)];
     assert(spvBin);
 
@@ -783,13 +951,15 @@ static Result assembleSpirv(const std::string &inFilename, std::string &outFilen
     } else {
       fwrite(spvBin, 1, binSize, outFile);
 
+      if (!cachePath.empty())
+        writeSpvAsmCache(cachePath, textDigest, spvBin, binSize);
+
       LLPC_OUTS("===============================================================================\n");
       LLPC_OUTS("// SPIR-V disassembly: " << inFilename << "\n");
       LLPC_OUTS(spvText);
       LLPC_OUTS("\n\n");
     }
 
-    fclose(inFile);
     fclose(outFile);
 
     delete[] spvText;
@@ -887,7 +1057,7 @@ static Result checkAutoLayoutCompatibleFunc(const ICompiler *compiler, CompileIn
         doAutoLayoutDesc(compileInfo->shaderModuleDatas[i].shaderStage, compileInfo->shaderModuleDatas[i].spirvBin,
                          &pipelineInfoCopy, &shaderInfoCopy, userDataOffset, true);
         if (checkShaderInfoComptible(shaderInfo, shaderInfoCopy.userDataNodeCount, shaderInfoCopy.pUserDataNodes) &&
-            checkPipelineStateCompatible(compiler, pipelineInfo, &pipelineInfoCopy, ParsedGfxIp))
+            checkPipelineStateCompatible(compiler, pipelineInfo, &pipelineInfoCopy, compileInfo->gfxIp))
           outs() << "Auto Layout fragment shader in " << compileInfo->fileNames << " hitted\n";
         else
           outs() << "Auto Layout fragment shader in " << compileInfo->fileNames << " failed to hit\n";
@@ -1000,7 +1170,7 @@ static Result buildPipeline(ICompiler *compiler, CompileInfo *compileInfo) {
         Vkgc::BinaryData pipelineBinary = {};
         pipelineBinary.codeSize = pipelineOut->pipelineBin.codeSize;
         pipelineBinary.pCode = pipelineOut->pipelineBin.pCode;
-        Vkgc::IPipelineDumper::DumpPipelineBinary(pipelineDumpHandle, ParsedGfxIp, &pipelineBinary);
+        Vkgc::IPipelineDumper::DumpPipelineBinary(pipelineDumpHandle, compileInfo->gfxIp, &pipelineBinary);
 
         Vkgc::IPipelineDumper::EndPipelineDump(pipelineDumpHandle);
       }
@@ -1066,7 +1236,7 @@ static Result buildPipeline(ICompiler *compiler, CompileInfo *compileInfo) {
         Vkgc::BinaryData pipelineBinary = {};
         pipelineBinary.codeSize = pipelineOut->pipelineBin.codeSize;
         pipelineBinary.pCode = pipelineOut->pipelineBin.pCode;
-        Vkgc::IPipelineDumper::DumpPipelineBinary(pipelineDumpHandle, ParsedGfxIp, &pipelineBinary);
+        Vkgc::IPipelineDumper::DumpPipelineBinary(pipelineDumpHandle, compileInfo->gfxIp, &pipelineBinary);
 
         Vkgc::IPipelineDumper::EndPipelineDump(pipelineDumpHandle);
       }
@@ -1085,7 +1255,10 @@ static Result buildPipeline(ICompiler *compiler, CompileInfo *compileInfo) {
 // @param suppliedOutFile : Name of the file to output ELF binary (specify "" to use base name of first input file with
 // appropriate extension; specify "-" to use stdout)
 // @param firstInFile : Name of first input file
-static Result outputElf(CompileInfo *compileInfo, const std::string &suppliedOutFile, StringRef firstInFile) {
+// @param outFileSuffix : Suffix inserted before the file extension, used to tell per-target outputs apart when
+// compiling for several graphics IP versions at once
+static Result outputElf(CompileInfo *compileInfo, const std::string &suppliedOutFile, StringRef firstInFile,
+                        StringRef outFileSuffix = {}) {
   Result result = Result::Success;
   const BinaryData *pipelineBin = (compileInfo->stageMask & shaderStageToMask(ShaderStageCompute))
                                       ? &compileInfo->compPipelineOut.pipelineBin
@@ -1108,6 +1281,13 @@ static Result outputElf(CompileInfo *compileInfo, const std::string &suppliedOut
     sys::path::replace_extension(outFileName, ext);
   }
 
+  if (!outFileSuffix.empty() && outFileName != "-") {
+    const SmallString<16> ext(sys::path::extension(outFileName));
+    sys::path::replace_extension(outFileName, "");
+    outFileName += outFileSuffix;
+    outFileName += ext;
+  }
+
   FILE *outFile = stdout;
   if (outFileName != "-")
     outFile = fopen(outFileName.c_str(), "wb");
@@ -1166,8 +1346,10 @@ static void enableMemoryLeakDetection() {
 // @param inFiles : Input filename(s)
 // @param startFile : Index of the starting file name being processed in the file name array
 // @param [out] nextFile : Index of next file name being processed in the file name array
+// @param gfxIp : Graphics IP version to compile for; defaults to the primary -gfxip target
+// @param outFileSuffix : Suffix inserted before the output file extension; empty in single-target mode
 static Result processPipeline(ICompiler *compiler, ArrayRef<std::string> inFiles, unsigned startFile,
-                              unsigned *nextFile) {
+                              unsigned *nextFile, GfxIpVersion gfxIp = ParsedGfxIp, StringRef outFileSuffix = {}) {
   Result result = Result::Success;
   CompileInfo compileInfo = {};
   std::string fileNames;
@@ -1175,7 +1357,7 @@ static Result processPipeline(ICompiler *compiler, ArrayRef<std::string> inFiles
   compileInfo.doAutoLayout = true;
   compileInfo.checkAutoLayoutCompatible = CheckAutoLayoutCompatible;
 
-  result = initCompileInfo(&compileInfo);
+  result = initCompileInfo(&compileInfo, gfxIp);
 
   //
   // Translate sources to SPIR-V binary
@@ -1256,7 +1438,9 @@ static Result processPipeline(ICompiler *compiler, ArrayRef<std::string> inFiles
     } else if (isPipelineInfoFile(inFile)) {
       const char *log = nullptr;
       bool vfxResult =
-          Vfx::vfxParseFile(inFile.c_str(), 0, nullptr, VfxDocTypePipeline, &compileInfo.pipelineInfoFile, &log);
+          Vfx::vfxIsPipelineBinaryFile(inFile.c_str())
+              ? Vfx::vfxLoadPipelineBinary(inFile.c_str(), &compileInfo.pipelineInfoFile, &log)
+              : Vfx::vfxParseFile(inFile.c_str(), 0, nullptr, VfxDocTypePipeline, &compileInfo.pipelineInfoFile, &log);
       if (vfxResult) {
         VfxPipelineStatePtr pipelineState = nullptr;
         Vfx::vfxGetPipelineDoc(compileInfo.pipelineInfoFile, &pipelineState);
@@ -1273,6 +1457,17 @@ static Result processPipeline(ICompiler *compiler, ArrayRef<std::string> inFiles
             LLPC_OUTS("Pipeline file parse warning:\n" << log << "\n");
           }
 
+          if (CompilePipe && !Vfx::vfxIsPipelineBinaryFile(inFile.c_str())) {
+            std::string binFileName = inFile.substr(0, inFile.find_last_of('.')) + LlpcExt::PipelineBinary;
+            const char *compileLog = nullptr;
+            if (Vfx::vfxCompilePipelineBinary(compileInfo.pipelineInfoFile, binFileName.c_str(), &compileLog))
+              LLPC_OUTS("// Compiled pipeline info file to " << binFileName << "\n\n");
+            else {
+              LLPC_ERRS("Fails to compile pipeline info file to " << binFileName << ": " << compileLog << "\n");
+              result = Result::ErrorUnavailable;
+            }
+          }
+
           compileInfo.compPipelineInfo = pipelineState->compPipelineInfo;
           compileInfo.gfxPipelineInfo = pipelineState->gfxPipelineInfo;
           if (IgnoreColorAttachmentFormats) {
@@ -1426,7 +1621,7 @@ static Result processPipeline(ICompiler *compiler, ArrayRef<std::string> inFiles
       compileInfo.fileNames = fileNames.c_str();
       result = buildPipeline(compiler, &compileInfo);
       if (result == Result::Success)
-        result = outputElf(&compileInfo, OutFile, inFiles[0]);
+        result = outputElf(&compileInfo, OutFile, inFiles[0], outFileSuffix);
     }
   }
   //
@@ -1437,6 +1632,296 @@ static Result processPipeline(ICompiler *compiler, ArrayRef<std::string> inFiles
   return result;
 }
 
+// =====================================================================================================================
+// Runs amdllpc as a resident compile server, reading jobs from stdin until end-of-file.
+//
+// Each job is one line holding an input file path, optionally followed by an output file path; empty lines and
+// lines starting with '#' are ignored. A flushed status line is printed per job, so a driving process can
+// pipeline jobs into one resident amdllpc instead of paying LLVM and compiler startup per compile. The compiler
+// instance, its warmed contexts and their pass-manager caches are reused across all jobs; a failing job does not
+// terminate the server.
+//
+// @param compiler : Compiler instance shared by all jobs
+static Result runCompileServer(ICompiler *compiler) {
+  // Per-job option state is restored before every job, so one job's defaults (e.g. an entry target derived
+  // from a SPIR-V binary) cannot leak into the next.
+  const std::string initialEntryTarget = EntryTarget;
+  const std::string initialOutFile = OutFile;
+
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    StringRef trimmed = StringRef(line).trim();
+    if (trimmed.empty() || trimmed.startswith("#"))
+      continue;
+
+    StringRef inFile;
+    StringRef outFile;
+    std::tie(inFile, outFile) = trimmed.split(' ');
+    outFile = outFile.trim();
+
+    EntryTarget.setValue(initialEntryTarget);
+    OutFile.setValue(outFile.empty() ? initialOutFile : outFile.str());
+
+    const std::string inFileStr = inFile.str();
+    unsigned nextFile = 0;
+    Result jobResult = processPipeline(compiler, {inFileStr}, 0, &nextFile);
+
+    outs() << (jobResult == Result::Success ? "OK " : "ERR ") << inFileStr << "\n";
+    outs().flush();
+  }
+
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Replays a compile trace recorded with -compile-trace-dir.
+//
+// The trace index holds one line per recorded build request, "<sequence> <thread> <pipe file>", with file names
+// relative to the index's directory. Each recorded thread is replayed by a dedicated worker with its own
+// compiler instance, compiling its builds in recorded order, so the run reproduces the recorded concurrency
+// pattern and is repeatable for a given trace. The first failure in recorded sequence order is reported.
+//
+// @param compiler : Compiler instance, used by the first worker
+// @param argc : Count of command-line arguments, used to create the extra compiler instances
+// @param argv : List of command-line arguments
+static Result runTraceReplay(ICompiler *compiler, int argc, char *argv[]) {
+  std::ifstream traceFile(ReplayTrace.c_str());
+  if (!traceFile) {
+    LLPC_ERRS("Failed to open compile trace " << ReplayTrace << "\n");
+    return Result::ErrorUnavailable;
+  }
+
+  // Recorded build files are dumped next to the index.
+  std::string traceDir;
+  const auto separatorPos = ReplayTrace.find_last_of("/\\");
+  if (separatorPos != std::string::npos)
+    traceDir = ReplayTrace.substr(0, separatorPos + 1);
+
+  // One build recorded in the trace
+  struct TraceEntry {
+    unsigned sequence; // Global submission order of the build
+    std::string file;  // Pipeline dump file holding the build inputs
+  };
+
+  std::vector<std::vector<TraceEntry>> threadEntries; // Recorded builds, grouped by recorded thread
+  std::string line;
+  while (std::getline(traceFile, line)) {
+    StringRef trimmed = StringRef(line).trim();
+    if (trimmed.empty() || trimmed.startswith("#"))
+      continue;
+
+    unsigned sequence = 0;
+    unsigned threadIndex = 0;
+    StringRef rest;
+    std::tie(trimmed, rest) = trimmed.split(' ');
+    if (trimmed.getAsInteger(10, sequence))
+      return Result::ErrorInvalidValue;
+    std::tie(trimmed, rest) = rest.split(' ');
+    if (trimmed.getAsInteger(10, threadIndex))
+      return Result::ErrorInvalidValue;
+
+    if (threadIndex >= threadEntries.size())
+      threadEntries.resize(threadIndex + 1);
+    threadEntries[threadIndex].push_back({sequence, traceDir + rest.trim().str()});
+  }
+
+  Result result = Result::Success;
+  std::vector<ICompiler *> compilers(threadEntries.size(), nullptr);
+  if (!compilers.empty())
+    compilers[0] = compiler;
+  for (unsigned i = 1; i < compilers.size() && result == Result::Success; ++i)
+    result = ICompiler::Create(ParsedGfxIp, argc, argv, &compilers[i]);
+
+  // First failing sequence number and its result, aggregated across the workers
+  std::mutex resultMutex;
+  unsigned failedSequence = ~0u;
+  Result failedResult = Result::Success;
+
+  if (result == Result::Success) {
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threadEntries.size(); ++i) {
+      workers.emplace_back([&resultMutex, &failedSequence, &failedResult, entries = &threadEntries[i],
+                            workerCompiler = compilers[i]] {
+        for (const TraceEntry &entry : *entries) {
+          unsigned nextFile = 0;
+          Result entryResult = processPipeline(workerCompiler, {entry.file}, 0, &nextFile);
+          if (entryResult != Result::Success) {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (entry.sequence < failedSequence) {
+              failedSequence = entry.sequence;
+              failedResult = entryResult;
+            }
+          }
+        }
+      });
+    }
+    for (auto &worker : workers)
+      worker.join();
+
+    if (failedResult != Result::Success) {
+      LLPC_ERRS("Failed to replay build " << failedSequence << " of " << ReplayTrace << "\n");
+      result = failedResult;
+    }
+  }
+
+  for (unsigned i = 1; i < compilers.size(); ++i) {
+    if (compilers[i])
+      compilers[i]->Destroy();
+  }
+
+  return result;
+}
+
+// =====================================================================================================================
+// Processes input files in parallel, one pipeline per file, across a pool of worker threads.
+//
+// Each worker compiles with its own compiler instance (and thus its own contexts); the instances share one
+// on-disk shader cache through the common -shader-cache-* options. Results are aggregated in input order, so the
+// reported failure is always the first failing file regardless of scheduling. Log output of concurrently
+// processed files may interleave.
+//
+// @param compiler : Compiler instance, used by the first worker
+// @param inFiles : Input filenames, each holding a separate pipeline
+// @param argc : Count of command-line arguments, used to create the extra compiler instances
+// @param argv : List of command-line arguments
+static Result processPipelinesInParallel(ICompiler *compiler, ArrayRef<std::string> inFiles, int argc, char *argv[]) {
+  const unsigned threadCount =
+      NumThreads < inFiles.size() ? NumThreads.getValue() : static_cast<unsigned>(inFiles.size());
+
+  std::vector<ICompiler *> compilers(threadCount, nullptr);
+  compilers[0] = compiler;
+  Result result = Result::Success;
+  for (unsigned i = 1; i < threadCount && result == Result::Success; ++i)
+    result = ICompiler::Create(ParsedGfxIp, argc, argv, &compilers[i]);
+
+  std::vector<Result> results(inFiles.size(), Result::Success);
+  if (result == Result::Success) {
+    std::atomic<unsigned> nextFileIndex(0);
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threadCount; ++i) {
+      workers.emplace_back([&inFiles, &results, &nextFileIndex, workerCompiler = compilers[i]] {
+        for (;;) {
+          const unsigned fileIndex = nextFileIndex.fetch_add(1);
+          if (fileIndex >= inFiles.size())
+            break;
+          unsigned nextFile = 0;
+          results[fileIndex] = processPipeline(workerCompiler, {inFiles[fileIndex]}, 0, &nextFile);
+        }
+      });
+    }
+    for (auto &worker : workers)
+      worker.join();
+  }
+
+  for (unsigned i = 1; i < threadCount; ++i) {
+    if (compilers[i])
+      compilers[i]->Destroy();
+  }
+
+  for (unsigned i = 0; i < results.size() && result == Result::Success; ++i) {
+    if (results[i] != Result::Success) {
+      LLPC_ERRS("Failed to compile " << inFiles[i] << "\n");
+      result = results[i];
+    }
+  }
+
+  return result;
+}
+
+// =====================================================================================================================
+// Compiles the input files once per graphics IP version listed in -gfxip, sharing the target-independent
+// front-end work.
+//
+// Shader source inputs are translated to SPIR-V binaries once up front, so glslang and the SPIR-V assembler run
+// once however many targets were requested; the entry target is also resolved up front so the per-target workers
+// do not write the shared option state. Each target then compiles the shared binaries with its own compiler
+// instance on its own thread, with ".gfx<major>.<minor>.<stepping>" inserted before the output file extension to
+// tell the results apart. With "-o -" the targets are compiled serially so their stdout output cannot interleave.
+//
+// @param compiler : Compiler instance for the primary target
+// @param inFiles : Input filenames
+// @param argc : Count of command-line arguments, used to create the per-target compiler instances
+// @param argv : List of command-line arguments
+static Result processPipelinesForAllTargets(ICompiler *compiler, ArrayRef<std::string> inFiles, int argc,
+                                            char *argv[]) {
+  Result result = Result::Success;
+
+  // Translate target-independent sources to SPIR-V binaries once.
+  std::vector<std::string> translatedFiles;
+  for (const std::string &inFile : inFiles) {
+    std::string spvBinFile;
+    if (isSpirvTextFile(inFile)) {
+      result = assembleSpirv(inFile, spvBinFile);
+      if (result != Result::Success)
+        return result;
+      translatedFiles.push_back(spvBinFile);
+    } else if (isSpirvBinaryFile(inFile) || isPipelineInfoFile(inFile) || isLlvmIrFile(inFile))
+      translatedFiles.push_back(inFile);
+    else {
+      // GLSL source text
+      // NOTE: If the entry target is not specified, we set it to GLSL default ("main").
+      if (EntryTarget.empty())
+        EntryTarget.setValue("main");
+      ShaderStage stage = ShaderStageInvalid;
+      result = compileGlsl(inFile, &stage, spvBinFile);
+      if (result != Result::Success)
+        return result;
+      translatedFiles.push_back(spvBinFile);
+    }
+  }
+
+  // Resolve the entry target from the first binary before the workers start, as each of them would otherwise
+  // store the same default into the shared option concurrently.
+  if (EntryTarget.empty() && isSpirvBinaryFile(translatedFiles[0])) {
+    BinaryData spvBin = {};
+    if (getSpirvBinaryFromFile(translatedFiles[0], &spvBin) == Result::Success) {
+      EntryTarget.setValue(ShaderModuleHelper::getEntryPointNameFromSpirvBinary(&spvBin));
+      delete[] static_cast<const char *>(spvBin.pCode);
+    }
+  }
+
+  std::vector<ICompiler *> compilers(ParsedGfxIps.size(), nullptr);
+  compilers[0] = compiler;
+  for (unsigned i = 1; i < compilers.size() && result == Result::Success; ++i)
+    result = ICompiler::Create(ParsedGfxIps[i], argc, argv, &compilers[i]);
+
+  std::vector<Result> results(ParsedGfxIps.size(), Result::Success);
+  if (result == Result::Success) {
+    const bool toStdout = OutFile == "-";
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < ParsedGfxIps.size(); ++i) {
+      auto compileForTarget = [&translatedFiles, &results, i, targetCompiler = compilers[i]] {
+        const GfxIpVersion gfxIp = ParsedGfxIps[i];
+        const std::string outFileSuffix = ".gfx" + std::to_string(gfxIp.major) + "." + std::to_string(gfxIp.minor) +
+                                          "." + std::to_string(gfxIp.stepping);
+        for (unsigned nextFile = 0; nextFile < translatedFiles.size() && results[i] == Result::Success;)
+          results[i] = processPipeline(targetCompiler, translatedFiles, nextFile, &nextFile, gfxIp, outFileSuffix);
+      };
+      if (toStdout)
+        compileForTarget();
+      else
+        workers.emplace_back(compileForTarget);
+    }
+    for (auto &worker : workers)
+      worker.join();
+  }
+
+  for (unsigned i = 1; i < compilers.size(); ++i) {
+    if (compilers[i])
+      compilers[i]->Destroy();
+  }
+
+  for (unsigned i = 0; i < results.size() && result == Result::Success; ++i) {
+    if (results[i] != Result::Success) {
+      LLPC_ERRS("Failed to compile for gfxip " << ParsedGfxIps[i].major << "." << ParsedGfxIps[i].minor << "."
+                                               << ParsedGfxIps[i].stepping << "\n");
+      result = results[i];
+    }
+  }
+
+  return result;
+}
+
 #ifdef WIN_OS
 // =====================================================================================================================
 // Finds all filenames which can match input file name
@@ -1497,6 +1982,65 @@ static Result expandInputFilenames(std::vector<std::string> &expandedFilenames)
   return Result::Success;
 }
 
+// =====================================================================================================================
+// Expands a pipeline dump container written with -pipeline-dump-container into the per-pipeline .pipe and .elf
+// files that -enable-pipeline-dump writes directly, so captured runs can use the fast single-file mode and be
+// converted to the text format offline on demand.
+//
+// @param containerFile : Name of the container file to expand
+// @param outDir : Directory the per-pipeline files are written to
+static Result unpackPipelineDumpContainer(const std::string &containerFile, const std::string &outDir) {
+  std::ifstream container(containerFile.c_str(), std::ios_base::binary | std::ios_base::in);
+  if (!container) {
+    LLPC_ERRS("Failed to open pipeline dump container " << containerFile << "\n");
+    return Result::ErrorUnavailable;
+  }
+
+  char magic[4] = {};
+  unsigned version = 0;
+  container.read(magic, sizeof(magic));
+  container.read(reinterpret_cast<char *>(&version), sizeof(version));
+  if (!container || memcmp(magic, "VPDC", sizeof(magic)) != 0 || version != 1) {
+    LLPC_ERRS(containerFile << " is not a pipeline dump container\n");
+    return Result::ErrorInvalidValue;
+  }
+
+  Vkgc::createDirectory(outDir.c_str());
+
+  unsigned fileCount = 0;
+  for (;;) {
+    uint64_t nameSize = 0;
+    uint64_t contentsSize = 0;
+    container.read(reinterpret_cast<char *>(&nameSize), sizeof(nameSize));
+    if (container.eof())
+      break;
+    container.read(reinterpret_cast<char *>(&contentsSize), sizeof(contentsSize));
+
+    std::string name(nameSize, '\0');
+    std::string contents(contentsSize, '\0');
+    container.read(&name[0], nameSize);
+    container.read(&contents[0], contentsSize);
+    if (!container) {
+      LLPC_ERRS("Truncated record at end of pipeline dump container " << containerFile << "\n");
+      return Result::ErrorInvalidValue;
+    }
+
+    // Records carry the path the file would have been written under; re-root the base name in the output
+    // directory.
+    const std::string outPathName = outDir + "/" + sys::path::filename(name).str();
+    std::ofstream outFile(outPathName.c_str(), std::ios_base::binary | std::ios_base::out);
+    if (!outFile) {
+      LLPC_ERRS("Failed to write " << outPathName << "\n");
+      return Result::ErrorUnavailable;
+    }
+    outFile.write(contents.data(), contents.size());
+    ++fileCount;
+  }
+
+  LLPC_OUTS("Expanded " << fileCount << " files from " << containerFile << " into " << outDir << "\n");
+  return Result::Success;
+}
+
 // =====================================================================================================================
 // Main function of LLPC standalone tool, entry-point.
 //
@@ -1548,6 +2092,55 @@ int main(int argc, char *argv[]) {
   if (isFailure())
     return onFailure();
 
+  if (!UnpackPipelineDump.empty()) {
+    // Offline conversion mode: expand a dump container and exit without compiling anything.
+    result = unpackPipelineDumpContainer(UnpackPipelineDump, cl::PipelineDumpDir);
+    if (isFailure())
+      return onFailure();
+    compiler->Destroy();
+    LLPC_OUTS("\n=====  AMDLLPC SUCCESS  =====\n");
+    return 0;
+  }
+
+  if (ServerMode) {
+    // Resident server mode: all jobs come from stdin; positional inputs are not used.
+    result = runCompileServer(compiler);
+    if (isFailure())
+      return onFailure();
+    compiler->Destroy();
+    LLPC_OUTS("\n=====  AMDLLPC SUCCESS  =====\n");
+    return 0;
+  }
+
+  if (!ReplayTrace.empty()) {
+    // Trace replay mode: all jobs come from the recorded trace; positional inputs are not used.
+    result = runTraceReplay(compiler, argc, argv);
+    if (isFailure())
+      return onFailure();
+    compiler->Destroy();
+    LLPC_OUTS("\n=====  AMDLLPC SUCCESS  =====\n");
+    return 0;
+  }
+
+  if (CompactShaderCache) {
+    // Maintenance mode: the compiler instance created above already loaded the on-disk cache, so compact it and
+    // exit without compiling anything.
+    result = ShaderCacheManager::getShaderCacheManager()->compactShaderCaches({});
+    if (result == Result::ErrorUnavailable)
+      LLPC_ERRS("No on-disk shader cache to compact; check the -shader-cache-* options\n");
+    if (isFailure())
+      return onFailure();
+    compiler->Destroy();
+    LLPC_OUTS("\n=====  AMDLLPC SUCCESS  =====\n");
+    return 0;
+  }
+
+  if (InFiles.empty()) {
+    LLPC_ERRS("No input file specified\n");
+    result = Result::ErrorInvalidValue;
+    return onFailure();
+  }
+
   std::vector<std::string> expandedInputFiles;
   result = expandInputFilenames(expandedInputFiles);
   if (isFailure())
@@ -1579,15 +2172,28 @@ int main(int argc, char *argv[]) {
       if (isFailure())
         return onFailure();
     }
+  } else if (ParsedGfxIps.size() > 1) {
+    // Multiple -gfxip targets: translate the inputs once and compile them for every target.
+    result = processPipelinesForAllTargets(compiler, expandedInputFiles, argc, argv);
+    if (isFailure())
+      return onFailure();
   } else if (isPipelineInfoFile(expandedInputFiles[0]) || isLlvmIrFile(expandedInputFiles[0])) {
     // The first input file is a pipeline file or LLVM IR file. Assume they all are, and compile each one
     // separately but in the same context.
-    unsigned nextFile = 0;
-
-    for (const std::string &file : expandedInputFiles) {
-      result = processPipeline(compiler, {file}, 0, &nextFile);
+    // NOTE: When everything is written to stdout, the files are compiled serially even with -j, so the
+    // outputs cannot interleave.
+    if (NumThreads > 1 && expandedInputFiles.size() > 1 && OutFile != "-") {
+      result = processPipelinesInParallel(compiler, expandedInputFiles, argc, argv);
       if (isFailure())
         return onFailure();
+    } else {
+      unsigned nextFile = 0;
+
+      for (const std::string &file : expandedInputFiles) {
+        result = processPipeline(compiler, {file}, 0, &nextFile);
+        if (isFailure())
+          return onFailure();
+      }
     }
   } else {
     // Otherwise, join all input files into the same pipeline.
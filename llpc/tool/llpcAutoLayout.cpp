@@ -41,8 +41,13 @@
 #include "llpcDebug.h"
 #include "llpcUtil.h"
 #include "vfx.h"
+#include "vkgcMetroHash.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Format.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
 
 #define DEBUG_TYPE "llpc-auto-layout"
 
@@ -261,6 +266,37 @@ bool checkPipelineStateCompatible(const ICompiler *compiler, Llpc::GraphicsPipel
   return compatible;
 }
 
+// =====================================================================================================================
+// Parse a SPIR-V binary into a SPIRVModule, caching the parsed module keyed by the binary's hash. The layout
+// derivation only reads the module, so repeated derivations over the same binary (the auto-layout compatibility
+// check replays the derivation, and a corpus passed in one run can repeat binaries) share one parse.
+//
+// @param spirvBin : SPIR-V binary
+static SPIRVModule *getCachedSpirvModule(BinaryData spirvBin) {
+  uint64_t hash = 0;
+  MetroHash64::Hash(static_cast<const uint8_t *>(spirvBin.pCode), spirvBin.codeSize,
+                    reinterpret_cast<uint8_t *>(&hash));
+
+  // The multi-target mode runs one worker thread per target over the same inputs, so lookups and inserts race
+  // without a lock. The lock is held across the parse as well: the workers process the same files in lockstep,
+  // so losing the parse once per binary to a near-certain collision would cost more than the serialization.
+  static std::mutex cacheMutex;
+  static std::map<uint64_t, std::unique_ptr<SPIRVModule>> moduleCache;
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  auto cacheIt = moduleCache.find(hash);
+  if (cacheIt != moduleCache.end())
+    return cacheIt->second.get();
+
+  std::string spirvCode(static_cast<const char *>(spirvBin.pCode), spirvBin.codeSize);
+  std::istringstream spirvStream(spirvCode);
+  std::unique_ptr<SPIRVModule> module(SPIRVModule::createSPIRVModule());
+  spirvStream >> *module;
+
+  SPIRVModule *result = module.get();
+  moduleCache[hash] = std::move(module);
+  return result;
+}
+
 // =====================================================================================================================
 // Lay out dummy descriptors and other information for one shader stage. This is used when running amdllpc on a single
 // SPIR-V or GLSL shader, rather than on a .pipe file. Memory allocated here may be leaked, but that does not
@@ -275,11 +311,8 @@ bool checkPipelineStateCompatible(const ICompiler *compiler, Llpc::GraphicsPipel
 // @param checkAutoLayoutCompatible : if check AutoLayout Compatiple
 void doAutoLayoutDesc(ShaderStage shaderStage, BinaryData spirvBin, GraphicsPipelineBuildInfo *pipelineInfo,
                       PipelineShaderInfo *shaderInfo, unsigned &topLevelOffset, bool checkAutoLayoutCompatible) {
-  // Read the SPIR-V.
-  std::string spirvCode(static_cast<const char *>(spirvBin.pCode), spirvBin.codeSize);
-  std::istringstream spirvStream(spirvCode);
-  std::unique_ptr<SPIRVModule> module(SPIRVModule::createSPIRVModule());
-  spirvStream >> *module;
+  // Read the SPIR-V, sharing the parsed module with any earlier derivation over the same binary.
+  SPIRVModule *module = getCachedSpirvModule(spirvBin);
 
   // Find the entry target.
   SPIRVEntryPoint *entryPoint = nullptr;
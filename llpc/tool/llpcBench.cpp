@@ -0,0 +1,392 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcBench.cpp
+ * @brief LLPC source file: contains implementation of LLPC compile-time benchmark harness llpc-bench.
+ *
+ * llpc-bench drives an amdllpc binary over a corpus of .pipe/SPIR-V workloads (typically llpc/test/shaderdb),
+ * compiling each input several times in a fresh process so every run starts cold. Per-phase times come from
+ * amdllpc's -timer-profile-file output; peak RSS and minor page faults (a proxy for allocation pressure) come
+ * from the child's rusage. The results are written as a JSON report, and a report from another build can be
+ * passed as a baseline to get a per-input diff, so compile-time regressions across LLVM uprevs show up in CI
+ * instead of being bisected by hand.
+ ***********************************************************************************************************************
+ */
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <cinttypes>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace llvm;
+
+// -amdllpc: path of the amdllpc binary to benchmark
+static cl::opt<std::string> AmdllpcPath("amdllpc", cl::desc("Path of the amdllpc binary to benchmark"),
+                                        cl::init("amdllpc"));
+
+// -runs: number of measured compilations per input
+static cl::opt<unsigned> Runs("runs", cl::desc("Number of measured compilations per input"), cl::init(3));
+
+// -warmup-runs: number of unmeasured compilations per input, to warm the file cache
+static cl::opt<unsigned> WarmupRuns("warmup-runs",
+                                    cl::desc("Number of unmeasured compilations per input, to warm the file cache"),
+                                    cl::init(1));
+
+// -o: output report file
+static cl::opt<std::string> OutFile("o", cl::desc("Output report file (JSON)"), cl::init("llpc-bench-report.json"));
+
+// -baseline: report file from another build to diff against
+static cl::opt<std::string> Baseline("baseline", cl::desc("Report file from another build to diff against"),
+                                     cl::init(""));
+
+// -extra-arg: extra argument passed through to amdllpc (e.g. -extra-arg=-gfxip=9.0.0)
+static cl::list<std::string> ExtraArgs("extra-arg", cl::ZeroOrMore,
+                                       cl::desc("Extra argument passed through to amdllpc"));
+
+// Input sources
+static cl::list<std::string> InFiles(cl::Positional, cl::OneOrMore,
+                                     cl::desc("<corpus inputs: .pipe/.spv files or directories to scan>"));
+
+namespace {
+
+// =====================================================================================================================
+// Measurements aggregated over the runs of one corpus input
+struct InputResult {
+  std::string name;                     // Input file path
+  double totalSeconds = 0.0;            // Best (minimum) total compile time over the runs
+  uint64_t peakRssKb = 0;               // Largest peak resident set size over the runs, in kilobytes
+  uint64_t pageFaults = 0;              // Largest minor page fault count over the runs (allocation-pressure proxy)
+  std::map<std::string, double> phases; // Per-phase times of the best run, in seconds
+  bool failed = false;                  // Whether any run of this input failed
+};
+
+} // namespace
+
+// =====================================================================================================================
+// Runs one command to completion and reports its wall-clock time and, where the platform allows, its peak RSS
+// and minor page fault count.
+//
+// @param args : Command line; args[0] is the program path
+// @param [out] seconds : Wall-clock run time
+// @param [out] peakRssKb : Peak resident set size in kilobytes, or 0 if unavailable
+// @param [out] pageFaults : Minor page fault count, or 0 if unavailable
+// @returns : Exit code of the process, or -1 on failure to run it
+static int runProcess(ArrayRef<std::string> args, double *seconds, uint64_t *peakRssKb, uint64_t *pageFaults) {
+  *peakRssKb = 0;
+  *pageFaults = 0;
+  auto startTime = std::chrono::steady_clock::now();
+  int exitCode = -1;
+
+#if defined(__unix__) || defined(__APPLE__)
+  std::vector<char *> argv;
+  for (const std::string &arg : args)
+    argv.push_back(const_cast<char *>(arg.c_str()));
+  argv.push_back(nullptr);
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+  if (pid > 0) {
+    int status = 0;
+    struct rusage usage = {};
+    if (wait4(pid, &status, 0, &usage) == pid && WIFEXITED(status)) {
+      exitCode = WEXITSTATUS(status);
+      *peakRssKb = usage.ru_maxrss;
+      *pageFaults = usage.ru_minflt;
+    }
+  }
+#else
+  // No per-child rusage on this platform; fall back to wall-clock time only.
+  std::vector<StringRef> argRefs(args.begin(), args.end());
+  exitCode = sys::ExecuteAndWait(args[0], argRefs);
+#endif
+
+  *seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+  return exitCode;
+}
+
+// =====================================================================================================================
+// Reads an amdllpc -timer-profile-file (JSON lines) and sums the totals and per-phase times over all records.
+//
+// @param profileFile : Path of the profile file
+// @param [out] totalSeconds : Sum of the per-compilation totals
+// @param [in/out] phases : Per-phase sums; entries are overwritten, not accumulated across calls
+// @returns : True on success
+static bool readProfile(StringRef profileFile, double *totalSeconds, std::map<std::string, double> *phases) {
+  auto bufferOrErr = MemoryBuffer::getFile(profileFile);
+  if (!bufferOrErr)
+    return false;
+
+  *totalSeconds = 0.0;
+  phases->clear();
+
+  SmallVector<StringRef, 8> lines;
+  (*bufferOrErr)->getBuffer().split(lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef line : lines) {
+    auto record = json::parse(line);
+    if (!record) {
+      consumeError(record.takeError());
+      return false;
+    }
+    const json::Object *object = record->getAsObject();
+    if (!object)
+      return false;
+    if (auto total = object->getNumber("total"))
+      *totalSeconds += *total;
+    if (const json::Object *phaseObject = object->getObject("phases")) {
+      for (const auto &phase : *phaseObject) {
+        if (auto value = phase.second.getAsNumber())
+          (*phases)[phase.first.str()] += *value;
+      }
+    }
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Expands the positional inputs: directories are scanned recursively for .pipe and SPIR-V files.
+//
+// @param [out] inputs : Expanded list of input files
+// @returns : True on success
+static bool expandInputs(std::vector<std::string> *inputs) {
+  for (const std::string &inFile : InFiles) {
+    if (sys::fs::is_directory(inFile)) {
+      std::error_code errorCode;
+      for (sys::fs::recursive_directory_iterator iter(inFile, errorCode), end; iter != end && !errorCode;
+           iter.increment(errorCode)) {
+        StringRef ext = sys::path::extension(iter->path());
+        if (ext == ".pipe" || ext == ".spv" || ext == ".spvasm")
+          inputs->push_back(iter->path());
+      }
+      if (errorCode) {
+        errs() << "Failed to scan directory " << inFile << ": " << errorCode.message() << "\n";
+        return false;
+      }
+    } else {
+      inputs->push_back(inFile);
+    }
+  }
+  llvm::sort(inputs->begin(), inputs->end());
+  return true;
+}
+
+// =====================================================================================================================
+// Benchmarks one corpus input: compiles it -warmup-runs + -runs times with a fresh amdllpc process per run and
+// keeps the best run's times and the largest run's memory numbers.
+//
+// @param input : Input file path
+// @param [out] result : Aggregated measurements
+static void benchInput(StringRef input, InputResult *result) {
+  result->name = input.str();
+
+  SmallString<128> elfFile;
+  SmallString<128> profileFile;
+  if (sys::fs::createTemporaryFile("llpc-bench", "elf", elfFile) ||
+      sys::fs::createTemporaryFile("llpc-bench", "json", profileFile)) {
+    result->failed = true;
+    return;
+  }
+
+  std::vector<std::string> args;
+  args.push_back(AmdllpcPath);
+  args.push_back(input.str());
+  args.push_back("-o=" + std::string(elfFile.str()));
+  args.push_back("-timer-profile-file=" + std::string(profileFile.str()));
+  for (const std::string &extraArg : ExtraArgs)
+    args.push_back(extraArg);
+
+  for (unsigned run = 0; run != WarmupRuns + Runs && !result->failed; ++run) {
+    double wallSeconds = 0.0;
+    uint64_t peakRssKb = 0;
+    uint64_t pageFaults = 0;
+    if (runProcess(args, &wallSeconds, &peakRssKb, &pageFaults) != 0) {
+      result->failed = true;
+      break;
+    }
+    if (run < WarmupRuns)
+      continue;
+
+    double totalSeconds = 0.0;
+    std::map<std::string, double> phases;
+    if (!readProfile(profileFile, &totalSeconds, &phases)) {
+      // amdllpc built without phase timing still gets a wall-clock number.
+      totalSeconds = wallSeconds;
+    }
+    if (result->totalSeconds == 0.0 || totalSeconds < result->totalSeconds) {
+      result->totalSeconds = totalSeconds;
+      result->phases = std::move(phases);
+    }
+    result->peakRssKb = std::max(result->peakRssKb, peakRssKb);
+    result->pageFaults = std::max(result->pageFaults, pageFaults);
+  }
+
+  sys::fs::remove(elfFile);
+  sys::fs::remove(profileFile);
+}
+
+// =====================================================================================================================
+// Writes the JSON report.
+//
+// @param results : Per-input measurements
+// @returns : True on success
+static bool writeReport(ArrayRef<InputResult> results) {
+  json::Array inputArray;
+  for (const InputResult &result : results) {
+    json::Object phaseObject;
+    for (const auto &phase : result.phases)
+      phaseObject[phase.first] = phase.second;
+    inputArray.push_back(json::Object{{"name", result.name},
+                                      {"failed", result.failed},
+                                      {"total", result.totalSeconds},
+                                      {"peakRssKb", int64_t(result.peakRssKb)},
+                                      {"pageFaults", int64_t(result.pageFaults)},
+                                      {"phases", std::move(phaseObject)}});
+  }
+  json::Object report{{"amdllpc", AmdllpcPath.getValue()}, {"runs", int64_t(Runs)}, {"inputs", std::move(inputArray)}};
+
+  std::error_code errorCode;
+  raw_fd_ostream stream(OutFile.c_str(), errorCode, sys::fs::F_Text);
+  if (errorCode) {
+    errs() << "Failed to open " << OutFile << ": " << errorCode.message() << "\n";
+    return false;
+  }
+  stream << formatv("{0:2}", json::Value(std::move(report))) << "\n";
+  return true;
+}
+
+// =====================================================================================================================
+// Diffs the results against a baseline report written by another build of amdllpc and prints a per-input table.
+//
+// @param results : Per-input measurements of this run
+// @returns : True on success
+static bool diffAgainstBaseline(ArrayRef<InputResult> results) {
+  auto bufferOrErr = MemoryBuffer::getFile(Baseline);
+  if (!bufferOrErr) {
+    errs() << "Failed to read baseline " << Baseline << "\n";
+    return false;
+  }
+  auto baselineValue = json::parse((*bufferOrErr)->getBuffer());
+  if (!baselineValue) {
+    consumeError(baselineValue.takeError());
+    errs() << "Failed to parse baseline " << Baseline << "\n";
+    return false;
+  }
+
+  std::map<std::string, std::pair<double, uint64_t>> baselineResults;
+  if (const json::Object *report = baselineValue->getAsObject()) {
+    if (const json::Array *inputs = report->getArray("inputs")) {
+      for (const json::Value &input : *inputs) {
+        const json::Object *object = input.getAsObject();
+        if (!object)
+          continue;
+        auto name = object->getString("name");
+        auto total = object->getNumber("total");
+        auto peakRssKb = object->getInteger("peakRssKb");
+        if (name && total)
+          baselineResults[name->str()] = {*total, peakRssKb ? uint64_t(*peakRssKb) : 0};
+      }
+    }
+  }
+
+  outs() << format("%-60s %12s %12s %8s %12s\n", "input", "base (s)", "now (s)", "delta", "rss delta");
+  double baseTotal = 0.0;
+  double nowTotal = 0.0;
+  for (const InputResult &result : results) {
+    auto baseIter = baselineResults.find(result.name);
+    if (baseIter == baselineResults.end() || result.failed)
+      continue;
+    double base = baseIter->second.first;
+    baseTotal += base;
+    nowTotal += result.totalSeconds;
+    double deltaPercent = base > 0.0 ? (result.totalSeconds - base) / base * 100.0 : 0.0;
+    int64_t rssDeltaKb = int64_t(result.peakRssKb) - int64_t(baseIter->second.second);
+    outs() << format("%-60s %12.6f %12.6f %+7.1f%% %+10" PRId64 "Kb\n", result.name.c_str(), base,
+                     result.totalSeconds, deltaPercent, rssDeltaKb);
+  }
+  if (baseTotal > 0.0) {
+    outs() << format("%-60s %12.6f %12.6f %+7.1f%%\n", "TOTAL", baseTotal, nowTotal,
+                     (nowTotal - baseTotal) / baseTotal * 100.0);
+  }
+  return true;
+}
+
+// =====================================================================================================================
+// Main function of llpc-bench.
+//
+// @param argc : Count of arguments
+// @param argv : List of arguments
+int main(int argc, char *argv[]) {
+  InitLLVM initLlvm(argc, argv);
+  cl::ParseCommandLineOptions(argc, argv, "LLPC compile-time benchmark harness\n");
+
+  std::vector<std::string> inputs;
+  if (!expandInputs(&inputs))
+    return 1;
+  if (inputs.empty()) {
+    errs() << "No benchmark inputs found\n";
+    return 1;
+  }
+
+  std::vector<InputResult> results(inputs.size());
+  unsigned failCount = 0;
+  for (unsigned i = 0; i != inputs.size(); ++i) {
+    benchInput(inputs[i], &results[i]);
+    if (results[i].failed) {
+      ++failCount;
+      errs() << "Failed to compile " << inputs[i] << "\n";
+    }
+  }
+
+  if (!writeReport(results))
+    return 1;
+
+  if (!Baseline.empty() && !diffAgainstBaseline(results))
+    return 1;
+
+  outs() << "Benchmarked " << (inputs.size() - failCount) << " of " << inputs.size() << " inputs, report written to "
+         << OutFile << "\n";
+  return failCount != 0 ? 1 : 0;
+}
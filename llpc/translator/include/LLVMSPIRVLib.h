@@ -106,7 +106,14 @@ class raw_pwrite_stream;
 /// \returns true if succeeds.
 bool writeSpirv(llvm::Module *M, llvm::raw_ostream &OS, std::string &ErrMsg);
 
+/// \brief Parse a SPIRV binary from istream into its in-memory representation without translating it.
+/// Parse errors surface when the returned module is translated.
+std::unique_ptr<SPIRV::SPIRVModule> parseSpirv(std::istream &IS);
+
 /// \brief Load SPIRV from istream and translate to LLVM module.
+/// When SpecConstsToGlobals is true, scalar specialization constants are translated to loads of dedicated
+/// global variables holding their default values, so the caller can substitute specialized values after
+/// translation instead of retranslating per specialization.
 /// \returns true if succeeds.
 bool readSpirv(lgc::Builder *Builder,
                const Vkgc::ShaderModuleUsage* ModuleData,
@@ -115,7 +122,21 @@ bool readSpirv(lgc::Builder *Builder,
                const char *EntryName,
                const SPIRV::SPIRVSpecConstMap &SpecConstMap,
                llvm::Module *M,
-               std::string &ErrMsg);
+               std::string &ErrMsg,
+               bool SpecConstsToGlobals = false);
+
+/// \brief Translate an already-parsed SPIRV module to an LLVM module. With no specialization to apply,
+/// translation leaves the parsed module reusable, so several entry points of a multi-entry-point module can be
+/// translated from one parse.
+bool readSpirv(lgc::Builder *Builder,
+               const Vkgc::ShaderModuleUsage* ModuleData,
+               SPIRV::SPIRVModule *BM,
+               spv::ExecutionModel EntryExecModel,
+               const char *EntryName,
+               const SPIRV::SPIRVSpecConstMap &SpecConstMap,
+               llvm::Module *M,
+               std::string &ErrMsg,
+               bool SpecConstsToGlobals = false);
 
 /// \brief Regularize LLVM module by removing entities not representable by
 /// SPIRV.
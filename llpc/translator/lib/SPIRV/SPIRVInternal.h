@@ -233,6 +233,9 @@ const static char InterpolateAtOffset[] = "interpolateAtOffset";
 const static char InterpolateAtVertexAMD[] = "InterpolateAtVertexAMD";
 const static char NonUniform[] = "spirv.NonUniform";
 const static char UnpackHalf2x16[] = "unpackHalf2x16";
+// Name prefix of the global variables standing in for scalar specialization constants; the SpecId decoration
+// value is appended to it.
+const static char SpecConstantPrefix[] = "spirv.SpecConstant.";
 } // namespace gSPIRVName
 
 enum SPIRVBlockTypeKind {
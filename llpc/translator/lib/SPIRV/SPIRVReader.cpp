@@ -49,6 +49,7 @@
 #include "llpcContext.h"
 #include "lgc/Pipeline.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/BinaryFormat/Dwarf.h"
 #include "llvm/IR/CFG.h"
@@ -124,13 +125,16 @@ static void dumpLLVM(Module *m, const std::string &fName) {
 }
 
 SPIRVToLLVM::SPIRVToLLVM(Module *llvmModule, SPIRVModule *theSpirvModule, const SPIRVSpecConstMap &theSpecConstMap,
-                         lgc::Builder *builder, const Vkgc::ShaderModuleUsage *moduleUsage)
+                         lgc::Builder *builder, const Vkgc::ShaderModuleUsage *moduleUsage, bool specConstsToGlobals)
     : m_m(llvmModule), m_builder(builder), m_bm(theSpirvModule), m_enableXfb(false), m_entryTarget(nullptr),
       m_specConstMap(theSpecConstMap), m_dbgTran(m_bm, m_m),
-      m_moduleUsage(reinterpret_cast<const Vkgc::ShaderModuleUsage *>(moduleUsage)) {
+      m_moduleUsage(reinterpret_cast<const Vkgc::ShaderModuleUsage *>(moduleUsage)),
+      m_specConstsToGlobals(specConstsToGlobals) {
   assert(m_m);
   m_context = &m_m->getContext();
   m_spirvOpMetaKindId = m_context->getMDKindID(MetaNameSpirvOp);
+  // The module is fully decoded by now, so its id bound is final.
+  m_valueMap.resize(m_bm->getIdBound());
 }
 
 void SPIRVToLLVM::recordRemappedTypeElements(SPIRVType *bt, unsigned from, unsigned to) {
@@ -153,11 +157,19 @@ uint64_t SPIRVToLLVM::getTypeStoreSize(Type *const t) {
 }
 
 Value *SPIRVToLLVM::mapValue(SPIRVValue *bv, Value *v) {
-  auto loc = m_valueMap.find(bv);
-  if (loc != m_valueMap.end()) {
-    if (loc->second == v)
+  // Values without a result id (e.g. stores and branches) are reached exactly once through the basic block walk and
+  // never referenced again, so there is nothing to record for them.
+  if (!bv->hasId())
+    return v;
+  // Folding OpSpecConstantOp during translation adds constants with ids past the decoded bound, so the map may
+  // have to grow beyond its initial size.
+  if (bv->getId() >= m_valueMap.size())
+    m_valueMap.resize(m_bm->getIdBound());
+  Value *&slot = m_valueMap[bv->getId()];
+  if (slot) {
+    if (slot == v)
       return v;
-    auto ld = dyn_cast<LoadInst>(loc->second);
+    auto ld = dyn_cast<LoadInst>(slot);
     auto placeholder = dyn_cast<GlobalVariable>(ld->getPointerOperand());
     assert(ld && placeholder && placeholder->getName().startswith(KPlaceholderPrefix) && "A value is translated twice");
     // Replaces placeholders for PHI nodes
@@ -165,7 +177,7 @@ Value *SPIRVToLLVM::mapValue(SPIRVValue *bv, Value *v) {
     ld->eraseFromParent();
     placeholder->eraseFromParent();
   }
-  m_valueMap[bv] = v;
+  slot = v;
   return v;
 }
 
@@ -189,10 +201,9 @@ bool SPIRVToLLVM::isSPIRVBuiltinVariable(GlobalVariable *gv, SPIRVBuiltinVariabl
 }
 
 Value *SPIRVToLLVM::getTranslatedValue(SPIRVValue *bv) {
-  auto loc = m_valueMap.find(bv);
-  if (loc != m_valueMap.end())
-    return loc->second;
-  return nullptr;
+  if (!bv->hasId() || bv->getId() >= m_valueMap.size())
+    return nullptr;
+  return m_valueMap[bv->getId()];
 }
 
 void SPIRVToLLVM::setAttrByCalledFunc(CallInst *call) {
@@ -618,8 +629,23 @@ Type *SPIRVToLLVM::transTypeWithOpcode<spv::OpTypeStruct>(SPIRVType *const spvTy
   if (spvStructType->isLiteral())
     structType = StructType::get(*m_context, memberTypes, isPacked);
   else {
-    structType = StructType::create(*m_context, spvStructType->getName());
-    structType->setBody(memberTypes, isPacked);
+    // Identified structs are not uniqued by the LLVMContext, so translating the same struct from several
+    // modules of one pipeline would pile up renamed duplicates. Reuse a previously created identical one from
+    // this context; the digest hit is verified against name, member types and packing before use.
+    const std::string &name = spvStructType->getName();
+    const uint64_t digest = static_cast<size_t>(
+        hash_combine(hash_combine_range(memberTypes.begin(), memberTypes.end()), StringRef(name), isPacked));
+    auto llpcContext = static_cast<Llpc::Context *>(m_context);
+    StructType *cached = llpcContext->findDigestedStructType(digest);
+    if (cached && cached->getName() == name && cached->isPacked() == isPacked &&
+        cached->elements() == ArrayRef<Type *>(memberTypes))
+      structType = cached;
+    else {
+      structType = StructType::create(*m_context, name);
+      structType->setBody(memberTypes, isPacked);
+      if (!cached)
+        llpcContext->addDigestedStructType(digest, structType);
+    }
   }
 
   return isExplicitlyLaidOut && hasMemberOffset ? recordTypeWithPad(structType) : structType;
@@ -658,7 +684,8 @@ Type *SPIRVToLLVM::transType(SPIRVType *t, unsigned matrixStride, bool columnMaj
       return loc->second;
   }
 
-  t->validate();
+  if (!m_bm->isTrustedInput())
+    t->validate();
   switch (t->getOpCode()) {
   case OpTypeVoid:
     return mapType(t, Type::getVoidTy(*m_context));
@@ -838,12 +865,13 @@ void SPIRVToLLVM::setLLVMLoopMetadata(SPIRVLoopMerge *lm, BranchInst *bi) {
 }
 
 Value *SPIRVToLLVM::transValue(SPIRVValue *bv, Function *f, BasicBlock *bb, bool createPlaceHolder) {
-  SPIRVToLLVMValueMap::iterator loc = m_valueMap.find(bv);
+  Value *translated = getTranslatedValue(bv);
 
-  if (loc != m_valueMap.end() && (!m_placeholderMap.count(bv) || createPlaceHolder))
-    return loc->second;
+  if (translated && (!m_placeholderMap.count(bv) || createPlaceHolder))
+    return translated;
 
-  bv->validate();
+  if (!m_bm->isTrustedInput())
+    bv->validate();
 
   auto v = transValueWithoutDecoration(bv, f, bb, createPlaceHolder);
   if (!v)
@@ -1716,7 +1744,7 @@ Value *SPIRVToLLVM::transAtomicRMW(SPIRVValue *const spvValue, const AtomicRMWIn
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicLoad>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1744,7 +1772,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicLoad>(SPIRVValue *c
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicStore>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1774,7 +1802,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicStore>(SPIRVValue *
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicExchange>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1787,7 +1815,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicExchange>(SPIRVValu
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicIAdd>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1800,7 +1828,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicIAdd>(SPIRVValue *c
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicISub>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1813,7 +1841,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicISub>(SPIRVValue *c
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicSMin>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1826,7 +1854,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicSMin>(SPIRVValue *c
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicUMin>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1839,7 +1867,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicUMin>(SPIRVValue *c
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicSMax>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1852,7 +1880,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicSMax>(SPIRVValue *c
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicUMax>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1865,7 +1893,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicUMax>(SPIRVValue *c
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicAnd>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1878,7 +1906,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicAnd>(SPIRVValue *co
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicOr>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1891,7 +1919,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicOr>(SPIRVValue *con
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicXor>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1904,7 +1932,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicXor>(SPIRVValue *co
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicIIncrement>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1928,7 +1956,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicIIncrement>(SPIRVVa
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicIDecrement>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -1952,7 +1980,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicIDecrement>(SPIRVVa
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpAtomicCompareExchange>(SPIRVValue *const spvValue) {
   // Image texel atomic operations use the older path for now.
-  if (static_cast<SPIRVInstruction *>(spvValue)->getOperands()[0]->getOpCode() == OpImageTexelPointer) {
+  if (static_cast<SPIRVInstruction *>(spvValue)->getOperand(0)->getOpCode() == OpImageTexelPointer) {
     return transSPIRVImageAtomicOpFromInst(static_cast<SPIRVInstruction *>(spvValue), getBuilder()->GetInsertBlock());
   }
 
@@ -2692,7 +2720,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpIsHelperInvocationEXT>(SP
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<spv::OpReadClockKHR>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  SPIRVConstant *const spvScope = static_cast<SPIRVConstant *>(spvInst->getOperands()[0]);
+  SPIRVConstant *const spvScope = static_cast<SPIRVConstant *>(spvInst->getOperand(0));
   const spv::Scope scope = static_cast<spv::Scope>(spvScope->getZExtIntValue());
   assert(scope == spv::ScopeDevice || scope == spv::ScopeWorkgroup);
 
@@ -2714,12 +2742,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<spv::OpReadClockKHR>(SPIRVV
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupAll>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const predicate = transValue(spvOperands[1], func, block);
+  Value *const predicate = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupAll(predicate);
 }
 
@@ -2729,12 +2756,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupAll>(SPIRVValue *con
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupAny>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const predicate = transValue(spvOperands[1], func, block);
+  Value *const predicate = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupAny(predicate);
 }
 
@@ -2744,13 +2770,12 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupAny>(SPIRVValue *con
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupBroadcast>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
-  Value *const id = transValue(spvOperands[2], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
+  Value *const id = transValue(spvInst->getOperand(2), func, block);
   return getBuilder()->CreateSubgroupBroadcast(value, id);
 }
 
@@ -2832,12 +2857,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformElect>(SPI
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformAll>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const predicate = transValue(spvOperands[1], func, block);
+  Value *const predicate = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupAll(predicate, m_moduleUsage->useHelpInvocation);
 }
 
@@ -2847,12 +2871,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformAll>(SPIRV
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformAny>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const predicate = transValue(spvOperands[1], func, block);
+  Value *const predicate = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupAny(predicate, m_moduleUsage->useHelpInvocation);
 }
 
@@ -2862,12 +2885,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformAny>(SPIRV
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformAllEqual>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupAllEqual(value, m_moduleUsage->useHelpInvocation);
 }
 
@@ -2877,13 +2899,12 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformAllEqual>(
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBroadcast>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
-  Value *const index = transValue(spvOperands[2], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
+  Value *const index = transValue(spvInst->getOperand(2), func, block);
   return getBuilder()->CreateSubgroupBroadcast(value, index);
 }
 
@@ -2893,12 +2914,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBroadcast>
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBroadcastFirst>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupBroadcastFirst(value);
 }
 
@@ -2908,12 +2928,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBroadcastF
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBallot>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const predicate = transValue(spvOperands[1], func, block);
+  Value *const predicate = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupBallot(predicate);
 }
 
@@ -2923,12 +2942,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBallot>(SP
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformInverseBallot>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupInverseBallot(value);
 }
 
@@ -2938,13 +2956,12 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformInverseBal
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBallotBitExtract>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
-  Value *const index = transValue(spvOperands[2], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
+  Value *const index = transValue(spvInst->getOperand(2), func, block);
   return getBuilder()->CreateSubgroupBallotBitExtract(value, index);
 }
 
@@ -2954,14 +2971,13 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBallotBitE
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBallotBitCount>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[2], func, block);
+  Value *const value = transValue(spvInst->getOperand(2), func, block);
 
-  switch (static_cast<SPIRVConstant *>(spvOperands[1])->getZExtIntValue()) {
+  switch (static_cast<SPIRVConstant *>(spvInst->getOperand(1))->getZExtIntValue()) {
   case GroupOperationReduce:
     return getBuilder()->CreateSubgroupBallotBitCount(value);
   case GroupOperationInclusiveScan:
@@ -2980,12 +2996,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBallotBitC
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBallotFindLSB>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupBallotFindLsb(value);
 }
 
@@ -2995,12 +3010,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBallotFind
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBallotFindMSB>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupBallotFindMsb(value);
 }
 
@@ -3010,13 +3024,12 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformBallotFind
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformShuffle>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
-  Value *const index = transValue(spvOperands[2], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
+  Value *const index = transValue(spvInst->getOperand(2), func, block);
   return getBuilder()->CreateSubgroupShuffle(value, index);
 }
 
@@ -3026,13 +3039,12 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformShuffle>(S
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformShuffleXor>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
-  Value *const mask = transValue(spvOperands[2], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
+  Value *const mask = transValue(spvInst->getOperand(2), func, block);
   return getBuilder()->CreateSubgroupShuffleXor(value, mask);
 }
 
@@ -3042,13 +3054,12 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformShuffleXor
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformShuffleUp>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
-  Value *const delta = transValue(spvOperands[2], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
+  Value *const delta = transValue(spvInst->getOperand(2), func, block);
   return getBuilder()->CreateSubgroupShuffleUp(value, delta);
 }
 
@@ -3058,13 +3069,12 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformShuffleUp>
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformShuffleDown>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
-  Value *const delta = transValue(spvOperands[2], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
+  Value *const delta = transValue(spvInst->getOperand(2), func, block);
   return getBuilder()->CreateSubgroupShuffleDown(value, delta);
 }
 
@@ -3075,15 +3085,14 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformShuffleDow
 // @param spvValue : A SPIR-V value.
 Value *SPIRVToLLVM::transGroupArithOp(Builder::GroupArithOp groupArithOp, SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
 
-  Value *const value = transValue(spvOperands[2], func, block);
+  Value *const value = transValue(spvInst->getOperand(2), func, block);
 
-  switch (static_cast<SPIRVConstant *>(spvOperands[1])->getZExtIntValue()) {
+  switch (static_cast<SPIRVConstant *>(spvInst->getOperand(1))->getZExtIntValue()) {
   case GroupOperationReduce:
     return getBuilder()->CreateSubgroupClusteredReduction(groupArithOp, value, getBuilder()->CreateGetSubgroupSize());
   case GroupOperationInclusiveScan:
@@ -3091,7 +3100,8 @@ Value *SPIRVToLLVM::transGroupArithOp(Builder::GroupArithOp groupArithOp, SPIRVV
   case GroupOperationExclusiveScan:
     return getBuilder()->CreateSubgroupClusteredExclusive(groupArithOp, value, getBuilder()->CreateGetSubgroupSize());
   case GroupOperationClusteredReduce:
-    return getBuilder()->CreateSubgroupClusteredReduction(groupArithOp, value, transValue(spvOperands[3], func, block));
+    return getBuilder()->CreateSubgroupClusteredReduction(groupArithOp, value,
+                                                          transValue(spvInst->getOperand(3), func, block));
   default:
     llvm_unreachable("Should never be called!");
     return nullptr;
@@ -3232,13 +3242,12 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformLogicalXor
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformQuadBroadcast>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
-  Value *const index = transValue(spvOperands[2], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
+  Value *const index = transValue(spvInst->getOperand(2), func, block);
   return getBuilder()->CreateSubgroupQuadBroadcast(value, index);
 }
 
@@ -3248,14 +3257,13 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformQuadBroadc
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformQuadSwap>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
-  assert(static_cast<SPIRVConstant *>(spvOperands[0])->getZExtIntValue() == ScopeSubgroup);
+  assert(static_cast<SPIRVConstant *>(spvInst->getOperand(0))->getZExtIntValue() == ScopeSubgroup);
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[1], func, block);
+  Value *const value = transValue(spvInst->getOperand(1), func, block);
 
-  switch (static_cast<SPIRVConstant *>(spvOperands[2])->getZExtIntValue()) {
+  switch (static_cast<SPIRVConstant *>(spvInst->getOperand(2))->getZExtIntValue()) {
   case 0:
     return getBuilder()->CreateSubgroupQuadSwapHorizontal(value);
   case 1:
@@ -3274,11 +3282,10 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpGroupNonUniformQuadSwap>(
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupBallotKHR>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const predicate = transValue(spvOperands[0], func, block);
+  Value *const predicate = transValue(spvInst->getOperand(0), func, block);
   return getBuilder()->CreateSubgroupBallot(predicate);
 }
 
@@ -3288,11 +3295,10 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupBallotKHR>(SPIRVV
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupFirstInvocationKHR>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[0], func, block);
+  Value *const value = transValue(spvInst->getOperand(0), func, block);
   return getBuilder()->CreateSubgroupBroadcastFirst(value);
 }
 
@@ -3302,11 +3308,10 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupFirstInvocationKH
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupAllKHR>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const predicate = transValue(spvOperands[0], func, block);
+  Value *const predicate = transValue(spvInst->getOperand(0), func, block);
   return getBuilder()->CreateSubgroupAll(predicate, m_moduleUsage->useHelpInvocation);
 }
 
@@ -3316,11 +3321,10 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupAllKHR>(SPIRVValu
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupAnyKHR>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const predicate = transValue(spvOperands[0], func, block);
+  Value *const predicate = transValue(spvInst->getOperand(0), func, block);
   return getBuilder()->CreateSubgroupAny(predicate, m_moduleUsage->useHelpInvocation);
 }
 
@@ -3330,11 +3334,10 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupAnyKHR>(SPIRVValu
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupAllEqualKHR>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[0], func, block);
+  Value *const value = transValue(spvInst->getOperand(0), func, block);
   return getBuilder()->CreateSubgroupAllEqual(value, m_moduleUsage->useHelpInvocation);
 }
 
@@ -3344,12 +3347,11 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupAllEqualKHR>(SPIR
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpSubgroupReadInvocationKHR>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
 
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const value = transValue(spvOperands[0], func, block);
-  Value *const index = transValue(spvOperands[1], func, block);
+  Value *const value = transValue(spvInst->getOperand(0), func, block);
+  Value *const index = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateSubgroupBroadcast(value, index);
 }
 
@@ -3645,7 +3647,7 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpVariable>(SPIRVValue *con
   }
 
   unsigned addrSpace = ptrType->getPointerAddressSpace();
-  string varName = spvVar->getName();
+  string varName = spvVar->getName().str();
 
   GlobalVariable *const globalVar =
       new GlobalVariable(*m_m, varType, readOnly, GlobalValue::ExternalLinkage, initializer, varName, nullptr,
@@ -3686,11 +3688,10 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpTranspose>(SPIRVValue *co
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpMatrixTimesScalar>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const matrix = transValue(spvOperands[0], func, block);
-  Value *const scalar = transValue(spvOperands[1], func, block);
+  Value *const matrix = transValue(spvInst->getOperand(0), func, block);
+  Value *const scalar = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateMatrixTimesScalar(matrix, scalar);
 }
 
@@ -3700,11 +3701,10 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpMatrixTimesScalar>(SPIRVV
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpVectorTimesMatrix>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const vector = transValue(spvOperands[0], func, block);
-  Value *const matrix = transValue(spvOperands[1], func, block);
+  Value *const vector = transValue(spvInst->getOperand(0), func, block);
+  Value *const matrix = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateVectorTimesMatrix(vector, matrix);
 }
 
@@ -3714,11 +3714,10 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpVectorTimesMatrix>(SPIRVV
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpMatrixTimesVector>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const matrix = transValue(spvOperands[0], func, block);
-  Value *const vector = transValue(spvOperands[1], func, block);
+  Value *const matrix = transValue(spvInst->getOperand(0), func, block);
+  Value *const vector = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateMatrixTimesVector(matrix, vector);
 }
 
@@ -3728,11 +3727,10 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpMatrixTimesVector>(SPIRVV
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpMatrixTimesMatrix>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const matrix1 = transValue(spvOperands[0], func, block);
-  Value *const matrix2 = transValue(spvOperands[1], func, block);
+  Value *const matrix1 = transValue(spvInst->getOperand(0), func, block);
+  Value *const matrix2 = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateMatrixTimesMatrix(matrix1, matrix2);
 }
 
@@ -3742,11 +3740,10 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpMatrixTimesMatrix>(SPIRVV
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpOuterProduct>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const vector1 = transValue(spvOperands[0], func, block);
-  Value *const vector2 = transValue(spvOperands[1], func, block);
+  Value *const vector1 = transValue(spvInst->getOperand(0), func, block);
+  Value *const vector2 = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateOuterProduct(vector1, vector2);
 }
 
@@ -3756,14 +3753,85 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpOuterProduct>(SPIRVValue
 // @param spvValue : A SPIR-V value.
 template <> Value *SPIRVToLLVM::transValueWithOpcode<OpDot>(SPIRVValue *const spvValue) {
   SPIRVInstruction *const spvInst = static_cast<SPIRVInstruction *>(spvValue);
-  std::vector<SPIRVValue *> spvOperands = spvInst->getOperands();
   BasicBlock *const block = getBuilder()->GetInsertBlock();
   Function *const func = getBuilder()->GetInsertBlock()->getParent();
-  Value *const vector1 = transValue(spvOperands[0], func, block);
-  Value *const vector2 = transValue(spvOperands[1], func, block);
+  Value *const vector1 = transValue(spvInst->getOperand(0), func, block);
+  Value *const vector2 = transValue(spvInst->getOperand(1), func, block);
   return getBuilder()->CreateDotProduct(vector1, vector2);
 }
 
+/// Translates a scalar specialization constant to a load of a dedicated
+/// global variable holding its default value, so the client can substitute
+/// the specialized value after translation instead of retranslating per
+/// specialization. The load is placed in the entry block of the using
+/// function, where it dominates every use, and is created once per
+/// function; the value is deliberately not recorded in the value map since
+/// the mapping is per-function rather than per-module.
+///
+/// Returns null when the constant cannot be represented this way (symbolic
+/// mode disabled, no SpecId decoration, no containing function, or a
+/// non-scalar type); the caller falls back to the normal constant
+/// translation.
+Value *SPIRVToLLVM::transSymbolicSpecConstant(SPIRVValue *bv, Function *f) {
+  unsigned specId = SPIRVID_INVALID;
+  if (!m_specConstsToGlobals || !f || !bv->hasDecorate(DecorationSpecId, 0, &specId))
+    return nullptr;
+
+  // Compute the default value of the constant, which becomes the global's initializer.
+  auto oc = bv->getOpCode();
+  Type *lt = transType(bv->getType());
+  Constant *defaultValue = nullptr;
+  if (oc == OpSpecConstantTrue || oc == OpSpecConstantFalse) {
+    bool boolVal = oc == OpSpecConstantTrue ? static_cast<SPIRVConstantTrue *>(bv)->getBoolValue()
+                                            : static_cast<SPIRVConstantFalse *>(bv)->getBoolValue();
+    defaultValue = boolVal ? ConstantInt::getTrue(*m_context) : ConstantInt::getFalse(*m_context);
+  } else {
+    SPIRVConstant *bConst = static_cast<SPIRVConstant *>(bv);
+    SPIRVType *bt = bv->getType();
+    switch (bt->getOpCode()) {
+    case OpTypeInt:
+      defaultValue = ConstantInt::get(lt, bConst->getZExtIntValue(), static_cast<SPIRVTypeInt *>(bt)->isSigned());
+      break;
+    case OpTypeFloat: {
+      const llvm::fltSemantics *fs = nullptr;
+      switch (bt->getFloatBitWidth()) {
+      case 16:
+        fs = &APFloat::IEEEhalf();
+        break;
+      case 32:
+        fs = &APFloat::IEEEsingle();
+        break;
+      case 64:
+        fs = &APFloat::IEEEdouble();
+        break;
+      default:
+        llvm_unreachable("invalid float type");
+      }
+      defaultValue =
+          ConstantFP::get(*m_context, APFloat(*fs, APInt(bt->getFloatBitWidth(), bConst->getZExtIntValue())));
+      break;
+    }
+    default:
+      return nullptr;
+    }
+  }
+
+  std::string name = gSPIRVName::SpecConstantPrefix + std::to_string(specId);
+  GlobalVariable *gv = m_m->getGlobalVariable(name, true);
+  if (!gv)
+    gv = new GlobalVariable(*m_m, lt, /*isConstant=*/true, GlobalValue::InternalLinkage, defaultValue, name);
+
+  LoadInst *&load = m_specConstLoadMap[{f, gv}];
+  if (!load) {
+    BasicBlock &entryBlock = f->getEntryBlock();
+    if (Instruction *terminator = entryBlock.getTerminator())
+      load = new LoadInst(lt, gv, name, terminator);
+    else
+      load = new LoadInst(lt, gv, name, &entryBlock);
+  }
+  return load;
+}
+
 /// For instructions, this function assumes they are created in order
 /// and appended to the given basic block. An instruction may use a
 /// instruction from another BB which has not been translated. Such
@@ -3774,6 +3842,43 @@ template <> Value *SPIRVToLLVM::transValueWithOpcode<OpDot>(SPIRVValue *const sp
 /// When CreatePlaceHolder is true, create a load instruction of a
 /// global variable as placeholder for SPIRV instruction. Otherwise,
 /// create instruction and replace placeholder if there is one.
+// =====================================================================================================================
+// Computes a structural digest of a constant for the per-context composite constant cache, or returns 0 if the
+// constant is not structurally cacheable: specialization constants depend on the specialization map, and
+// workgroup pointer nulls translate to instructions.
+//
+// @param bv : SPIR-V constant to digest
+uint64_t SPIRVToLLVM::computeConstantDigest(SPIRVValue *bv) {
+  // Key on the translated LLVM type, which is uniqued in the context, plus the opcode and contents.
+  hash_code hash = hash_combine(unsigned(bv->getOpCode()), transType(bv->getType()));
+  switch (bv->getOpCode()) {
+  case OpConstant:
+    hash = hash_combine(hash, static_cast<SPIRVConstant *>(bv)->getZExtIntValue());
+    break;
+  case OpConstantTrue:
+  case OpConstantFalse:
+  case OpUndef:
+    break;
+  case OpConstantNull:
+    if (bv->getType()->isTypePointer())
+      return 0;
+    break;
+  case OpConstantComposite: {
+    for (SPIRVValue *element : static_cast<SPIRVConstantComposite *>(bv)->getElements()) {
+      const uint64_t elementDigest = computeConstantDigest(element);
+      if (elementDigest == 0)
+        return 0;
+      hash = hash_combine(hash, elementDigest);
+    }
+    break;
+  }
+  default:
+    return 0;
+  }
+  const uint64_t digest = static_cast<size_t>(hash);
+  return digest != 0 ? digest : 1;
+}
+
 Value *SPIRVToLLVM::transValueWithoutDecoration(SPIRVValue *bv, Function *f, BasicBlock *bb, bool createPlaceHolder) {
 
   auto oc = bv->getOpCode();
@@ -3783,6 +3888,10 @@ Value *SPIRVToLLVM::transValueWithoutDecoration(SPIRVValue *bv, Function *f, Bas
   switch (oc) {
   case OpConstant:
   case OpSpecConstant: {
+    if (bv->getOpCode() == OpSpecConstant) {
+      if (Value *symbolic = transSymbolicSpecConstant(bv, f))
+        return symbolic;
+    }
     SPIRVConstant *bConst = static_cast<SPIRVConstant *>(bv);
     SPIRVType *bt = bv->getType();
     Type *lt = transType(bt);
@@ -3818,6 +3927,10 @@ Value *SPIRVToLLVM::transValueWithoutDecoration(SPIRVValue *bv, Function *f, Bas
   case OpConstantFalse:
   case OpSpecConstantTrue:
   case OpSpecConstantFalse: {
+    if (bv->getOpCode() == OpSpecConstantTrue || bv->getOpCode() == OpSpecConstantFalse) {
+      if (Value *symbolic = transSymbolicSpecConstant(bv, f))
+        return symbolic;
+    }
     bool boolVal = oc == OpConstantTrue || oc == OpSpecConstantTrue
                        ? static_cast<SPIRVConstantTrue *>(bv)->getBoolValue()
                        : static_cast<SPIRVConstantFalse *>(bv)->getBoolValue();
@@ -3840,14 +3953,31 @@ Value *SPIRVToLLVM::transValueWithoutDecoration(SPIRVValue *bv, Function *f, Bas
   case OpConstantComposite:
   case OpSpecConstantComposite: {
     auto bcc = static_cast<SPIRVConstantComposite *>(bv);
+    std::vector<SPIRVValue *> elements = bcc->getElements();
+    // Structurally identical aggregate constants (e.g. large lookup tables) commonly recur across the modules
+    // of one pipeline. Constants are uniqued in the LLVMContext, so one converted for another module can be
+    // reused directly, skipping the per-element translation walk. Small composites are not worth the digest.
+    uint64_t digest = 0;
+    auto llpcContext = static_cast<Llpc::Context *>(m_context);
+    if (bv->getOpCode() == OpConstantComposite && elements.size() >= 8) {
+      digest = computeConstantDigest(bv);
+      if (digest != 0) {
+        if (Constant *cached = llpcContext->findDigestedCompositeConstant(digest))
+          return mapValue(bv, cached);
+      }
+    }
     std::vector<Constant *> cv;
-    for (auto &i : bcc->getElements())
+    for (auto &i : elements)
       cv.push_back(dyn_cast<Constant>(transValue(i, f, bb)));
+    Constant *converted = nullptr;
     switch (bv->getType()->getOpCode()) {
     case OpTypeVector:
-      return mapValue(bv, ConstantVector::get(cv));
+      converted = ConstantVector::get(cv);
+      break;
     case OpTypeArray:
-      return mapValue(bv, ConstantArray::get(dyn_cast<ArrayType>(transType(bcc->getType())), cv));
+    case OpTypeMatrix:
+      converted = ConstantArray::get(dyn_cast<ArrayType>(transType(bcc->getType())), cv);
+      break;
     case OpTypeStruct: {
       auto bccTy = dyn_cast<StructType>(transType(bcc->getType()));
       auto members = bccTy->getNumElements();
@@ -3865,15 +3995,16 @@ Value *SPIRVToLLVM::transValueWithoutDecoration(SPIRVValue *bv, Function *f, Bas
         }
       }
 
-      return mapValue(bv, ConstantStruct::get(dyn_cast<StructType>(transType(bcc->getType())), cv));
-    }
-    case OpTypeMatrix: {
-      return mapValue(bv, ConstantArray::get(dyn_cast<ArrayType>(transType(bcc->getType())), cv));
+      converted = ConstantStruct::get(bccTy, cv);
+      break;
     }
     default:
       llvm_unreachable("not implemented");
       return nullptr;
     }
+    if (digest != 0)
+      llpcContext->addDigestedCompositeConstant(digest, converted);
+    return mapValue(bv, converted);
   }
 
   case OpSpecConstantOp: {
@@ -3925,7 +4056,7 @@ Value *SPIRVToLLVM::transValueWithoutDecoration(SPIRVValue *bv, Function *f, Bas
   if (createPlaceHolder) {
     auto gvType = transType(bv->getType());
     auto gv = new GlobalVariable(*m_m, gvType, false, GlobalValue::PrivateLinkage, nullptr,
-                                 std::string(KPlaceholderPrefix) + bv->getName(), 0, GlobalVariable::NotThreadLocal, 0);
+                                 Twine(KPlaceholderPrefix) + bv->getName(), 0, GlobalVariable::NotThreadLocal, 0);
     auto ld = new LoadInst(gvType, gv, bv->getName(), bb);
     m_placeholderMap[bv] = ld;
     return mapValue(bv, ld);
@@ -5072,12 +5203,12 @@ void SPIRVToLLVM::getImageDesc(SPIRVValue *bImageInst, ExtractedImageInfo *info)
     // We also need to trace back to the OpVariable or OpFunctionParam to find
     // the coherent and volatile decorations.
     while (bImagePtr->getOpCode() == OpAccessChain || bImagePtr->getOpCode() == OpInBoundsAccessChain) {
-      std::vector<SPIRVValue *> operands = static_cast<SPIRVInstTemplateBase *>(bImagePtr)->getOperands();
-      for (SPIRVValue *operand : operands) {
-        if (operand->hasDecorate(DecorationNonUniformEXT))
+      SPIRVInstTemplateBase *const accessChain = static_cast<SPIRVInstTemplateBase *>(bImagePtr);
+      for (size_t i = 0, e = accessChain->getNumOperands(); i != e; ++i) {
+        if (accessChain->getOperand(i)->hasDecorate(DecorationNonUniformEXT))
           info->flags |= lgc::Builder::ImageFlagNonUniformImage;
       }
-      bImagePtr = operands[0];
+      bImagePtr = accessChain->getOperand(0);
     }
     assert(bImagePtr->getOpCode() == OpVariable || bImagePtr->getOpCode() == OpFunctionParameter);
     if (bImageInst->hasDecorate(DecorationCoherent))
@@ -5993,8 +6124,37 @@ bool SPIRVToLLVM::translate(ExecutionModel entryExecModel, const char *entryName
       transValue(bv, nullptr, nullptr);
   }
 
+  // Unless the client asked to keep unused functions, collect the set of functions reachable from the targeted
+  // entry-point so untargeted entry-points and their exclusive callees are never translated at all. Modules
+  // produced by uber-shader style front-ends can carry many dead entry-points, and translating them just to
+  // erase them afterwards is wasted time.
+  std::set<SPIRVFunction *> reachableFuncs;
+  if (!m_moduleUsage->keepUnusedFunctions) {
+    std::vector<SPIRVFunction *> worklist;
+    worklist.push_back(m_entryTarget);
+    reachableFuncs.insert(m_entryTarget);
+    while (!worklist.empty()) {
+      SPIRVFunction *bf = worklist.back();
+      worklist.pop_back();
+      for (size_t block = 0, blockCount = bf->getNumBasicBlock(); block != blockCount; ++block) {
+        SPIRVBasicBlock *bb = bf->getBasicBlock(block);
+        for (size_t inst = 0, instCount = bb->getNumInst(); inst != instCount; ++inst) {
+          SPIRVInstruction *bi = bb->getInst(inst);
+          if (bi->getOpCode() == OpFunctionCall) {
+            SPIRVFunction *callee = static_cast<SPIRVFunctionCall *>(bi)->getFunction();
+            if (reachableFuncs.insert(callee).second)
+              worklist.push_back(callee);
+          }
+        }
+      }
+    }
+  }
+
   for (unsigned i = 0, e = m_bm->getNumFunctions(); i != e; ++i) {
     auto bf = m_bm->getFunction(i);
+    // Skip functions that cannot be reached from the targeted entry-point.
+    if (!m_moduleUsage->keepUnusedFunctions && reachableFuncs.count(bf) == 0)
+      continue;
     // Non entry-points and targeted entry-point should be translated.
     // Set DLLExport on targeted entry-point so we can find it later.
     if (!m_bm->getEntryPoint(bf->getId()) || bf == m_entryTarget) {
@@ -7837,16 +7997,30 @@ llvm::GlobalValue::LinkageTypes SPIRVToLLVM::transLinkageType(const SPIRVValue *
 
 } // namespace SPIRV
 
+std::unique_ptr<SPIRVModule> llvm::parseSpirv(std::istream &is) {
+  std::unique_ptr<SPIRVModule> bm(SPIRVModule::createSPIRVModule());
+  is >> *bm;
+  return bm;
+}
+
 bool llvm::readSpirv(Builder *builder, const ShaderModuleUsage *shaderInfo, std::istream &is,
                      spv::ExecutionModel entryExecModel, const char *entryName, const SPIRVSpecConstMap &specConstMap,
-                     Module *m, std::string &errMsg) {
-  assert(entryExecModel != ExecutionModelKernel && "Not support ExecutionModelKernel");
+                     Module *m, std::string &errMsg, bool specConstsToGlobals) {
+  std::unique_ptr<SPIRVModule> bm = parseSpirv(is);
+  return readSpirv(builder, shaderInfo, bm.get(), entryExecModel, entryName, specConstMap, m, errMsg,
+                   specConstsToGlobals);
+}
 
-  std::unique_ptr<SPIRVModule> bm(SPIRVModule::createSPIRVModule());
+bool llvm::readSpirv(Builder *builder, const ShaderModuleUsage *shaderInfo, SPIRVModule *bm,
+                     spv::ExecutionModel entryExecModel, const char *entryName, const SPIRVSpecConstMap &specConstMap,
+                     Module *m, std::string &errMsg, bool specConstsToGlobals) {
+  assert(entryExecModel != ExecutionModelKernel && "Not support ExecutionModelKernel");
 
-  is >> *bm;
+  // Modules our own toolchain has already run through spirv-val need no second validation here, so skip the
+  // per-entry operand checks on the translation hot path for them.
+  bm->setTrustedInput(shaderInfo && shaderInfo->trustedMode);
 
-  SPIRVToLLVM btl(m, bm.get(), specConstMap, builder, shaderInfo);
+  SPIRVToLLVM btl(m, bm, specConstMap, builder, shaderInfo, specConstsToGlobals);
   bool succeed = true;
   if (!btl.translate(entryExecModel, entryName)) {
     bm->getError(errMsg);
@@ -68,7 +68,7 @@ class SPIRVToLLVMDbgTran;
 class SPIRVToLLVM {
 public:
   SPIRVToLLVM(Module *llvmModule, SPIRVModule *theSpirvModule, const SPIRVSpecConstMap &theSpecConstMap,
-              lgc::Builder *builder, const Vkgc::ShaderModuleUsage *moduleUsage);
+              lgc::Builder *builder, const Vkgc::ShaderModuleUsage *moduleUsage, bool specConstsToGlobals = false);
 
   DebugLoc getDebugLoc(SPIRVInstruction *bi, Function *f);
 
@@ -85,6 +85,8 @@ public:
 
   Value *transValue(SPIRVValue *, Function *f, BasicBlock *, bool createPlaceHolder = true);
   Value *transValueWithoutDecoration(SPIRVValue *, Function *f, BasicBlock *, bool createPlaceHolder = true);
+  Value *transSymbolicSpecConstant(SPIRVValue *bv, Function *f);
+  uint64_t computeConstantDigest(SPIRVValue *bv);
   Value *transAtomicRMW(SPIRVValue *, const AtomicRMWInst::BinOp);
   Constant *transInitializer(SPIRVValue *, Type *);
   template <spv::Op> Value *transValueWithOpcode(SPIRVValue *);
@@ -176,7 +178,6 @@ public:
   bool postProcessRowMajorMatrix();
 
   typedef DenseMap<SPIRVType *, Type *> SPIRVToLLVMTypeMap;
-  typedef DenseMap<SPIRVValue *, Value *> SPIRVToLLVMValueMap;
   typedef DenseMap<SPIRVValue *, Value *> SPIRVBlockToLLVMStructMap;
   typedef DenseMap<SPIRVFunction *, Function *> SPIRVToLLVMFunctionMap;
   typedef DenseMap<GlobalVariable *, SPIRVBuiltinVariableKind> BuiltinVarMap;
@@ -199,7 +200,10 @@ private:
   SPIRVFunction *m_entryTarget;
   const SPIRVSpecConstMap &m_specConstMap;
   SPIRVToLLVMTypeMap m_typeMap;
-  SPIRVToLLVMValueMap m_valueMap;
+  // Translated values, indexed by SPIR-V result id. SPIR-V ids are dense small integers below the module's id bound,
+  // so a flat array turns the hottest lookup in translation into an index. Values without a result id are never
+  // looked up again and are not recorded.
+  std::vector<Value *> m_valueMap;
   SPIRVToLLVMFunctionMap m_funcMap;
   SPIRVBlockToLLVMStructMap m_blockMap;
   SPIRVToLLVMPlaceholderMap m_placeholderMap;
@@ -212,6 +216,11 @@ private:
   DenseMap<std::pair<BasicBlock *, BasicBlock *>, unsigned> m_blockPredecessorToCount;
   const Vkgc::ShaderModuleUsage *m_moduleUsage;
   unsigned m_spirvOpMetaKindId;
+  bool m_specConstsToGlobals;
+
+  // Per-function loads of the global variables standing in for specialization constants, placed in the entry
+  // block so they dominate every use in the function.
+  DenseMap<std::pair<Function *, GlobalVariable *>, LoadInst *> m_specConstLoadMap;
 
   lgc::Builder *getBuilder() const { return m_builder; }
 
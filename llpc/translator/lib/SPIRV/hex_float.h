@@ -19,9 +19,12 @@
 #include <cctype>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <limits>
 #include <sstream>
+#include <string>
 
 #include "bitutils.h"
 
@@ -69,6 +72,10 @@ struct FloatProxyTraits<float> {
   static float max() { return std::numeric_limits<float>::max(); }
   // Returns the lowest normal value.
   static float lowest() { return std::numeric_limits<float>::lowest(); }
+  // Parses a decimal float from the given C string at full precision.
+  static float fromCString(const char* str, char** str_end) {
+    return std::strtof(str, str_end);
+  }
 };
 
 template <>
@@ -81,6 +88,10 @@ struct FloatProxyTraits<double> {
   static double max() { return std::numeric_limits<double>::max(); }
   // Returns the lowest normal value.
   static double lowest() { return std::numeric_limits<double>::lowest(); }
+  // Parses a decimal float from the given C string at full precision.
+  static double fromCString(const char* str, char** str_end) {
+    return std::strtod(str, str_end);
+  }
 };
 
 template <>
@@ -650,9 +661,16 @@ inline uint8_t get_nibble_from_character(int character) {
   return 0;
 }
 
-// Outputs the given HexFloat to the stream.
+// Maximum number of characters PrintHexFloat may write, including the
+// terminating NUL: sign, "0x1.", one hex digit per fraction nibble, "p",
+// the exponent sign and the decimal exponent digits.
+const size_t kMaxHexFloatTextLength = 32;
+
+// Prints the given HexFloat into the buffer as a NUL-terminated hex-float
+// literal, without any stream, locale or sentry machinery. The buffer must
+// hold at least kMaxHexFloatTextLength characters. Returns the buffer.
 template <typename T, typename Traits>
-std::ostream& operator<<(std::ostream& os, const HexFloat<T, Traits>& value) {
+char* PrintHexFloat(const HexFloat<T, Traits>& value, char* buffer) {
   typedef HexFloat<T, Traits> HF;
   typedef typename HF::uint_type uint_type;
   typedef typename HF::int_type int_type;
@@ -665,7 +683,6 @@ std::ostream& operator<<(std::ostream& os, const HexFloat<T, Traits>& value) {
                 "num_fractin_bits must be non-zero for a valid float");
 
   const uint_type bits = spvutils::BitwiseCast<uint_type>(value.value());
-  const char* const sign = (bits & HF::sign_mask) ? "-" : "";
   const uint_type exponent = static_cast<uint_type>(
       (bits & HF::exponent_mask) >> HF::num_fraction_bits);
 
@@ -705,22 +722,43 @@ std::ostream& operator<<(std::ostream& os, const HexFloat<T, Traits>& value) {
     --fraction_nibbles;
   }
 
-  const auto saved_flags = os.flags();
-  const auto saved_fill = os.fill();
-
-  os << sign << "0x" << (is_zero ? '0' : '1');
+  char* pos = buffer;
+  if (bits & HF::sign_mask) *pos++ = '-';
+  *pos++ = '0';
+  *pos++ = 'x';
+  *pos++ = is_zero ? '0' : '1';
   if (fraction_nibbles) {
     // Make sure to keep the leading 0s in place, since this is the fractional
     // part.
-    os << "." << std::setw(static_cast<int>(fraction_nibbles))
-       << std::setfill('0') << std::hex << fraction;
+    *pos++ = '.';
+    for (int nibble = static_cast<int>(fraction_nibbles) - 1; nibble >= 0;
+         --nibble) {
+      *pos++ = "0123456789abcdef"[(fraction >> (nibble * 4)) & 0xF];
+    }
   }
-  os << "p" << std::dec << (int_exponent >= 0 ? "+" : "") << int_exponent;
-
-  os.flags(saved_flags);
-  os.fill(saved_fill);
+  *pos++ = 'p';
+  *pos++ = int_exponent >= 0 ? '+' : '-';
+  // Hex-floats express their exponent in decimal.
+  const int exponent_value = static_cast<int>(int_exponent);
+  unsigned remaining = static_cast<unsigned>(
+      exponent_value < 0 ? -exponent_value : exponent_value);
+  char digits[8];
+  int num_digits = 0;
+  do {
+    digits[num_digits++] = static_cast<char>('0' + remaining % 10);
+    remaining /= 10;
+  } while (remaining != 0);
+  while (num_digits != 0) *pos++ = digits[--num_digits];
+  *pos = '\0';
+  assert(static_cast<size_t>(pos - buffer) < kMaxHexFloatTextLength);
+  return buffer;
+}
 
-  return os;
+// Outputs the given HexFloat to the stream, as formatted by PrintHexFloat.
+template <typename T, typename Traits>
+std::ostream& operator<<(std::ostream& os, const HexFloat<T, Traits>& value) {
+  char buffer[kMaxHexFloatTextLength];
+  return os << PrintHexFloat(value, buffer);
 }
 
 // Returns true if negate_value is true and the next character on the
@@ -812,10 +850,42 @@ ParseNormalFloat<FloatProxy<Float16>, HexFloatTraits<FloatProxy<Float16>>>(
   return is;
 }
 
-// Reads a HexFloat from the given stream.
-// If the float is not encoded as a hex-float then it will be parsed
-// as a regular float.
-// This may fail if your stream does not support at least one unget.
+// Adapts a std::istream to the character-source interface consumed by
+// ParseHexFloatAfterPrefix.
+class IStreamCharSource {
+ public:
+  explicit IStreamCharSource(std::istream& is) : is_(is) {}
+  int peek() const { return is_.peek(); }
+  void get() { is_.get(); }
+  void fail() { is_.setstate(std::ios::failbit); }
+
+ private:
+  std::istream& is_;
+};
+
+// Walks a character range directly, with no stream state, locale or sentry
+// objects in the way.
+class BufferCharSource {
+ public:
+  BufferCharSource(const char* pos, const char* end) : pos_(pos), end_(end) {}
+  int peek() const {
+    return pos_ == end_ ? -1 : static_cast<unsigned char>(*pos_);
+  }
+  void get() {
+    if (pos_ != end_) ++pos_;
+  }
+  void fail() { failed_ = true; }
+  bool failed() const { return failed_; }
+  const char* position() const { return pos_; }
+
+ private:
+  const char* pos_;
+  const char* end_;
+  bool failed_ = false;
+};
+
+// Parses the body of a hex-float (everything after the "0x" prefix) from
+// the given character source and stores it into the value parameter.
 // Nan values can be encoded with "0x1.<not zero>p+exponent_bias".
 // This would normally overflow a float and round to
 // infinity but this special pattern is the exact representation for a NaN,
@@ -831,48 +901,13 @@ ParseNormalFloat<FloatProxy<Float16>, HexFloatTraits<FloatProxy<Float16>>>(
 //
 //    0x1p+129 (+inf)
 //    -0x1p+129 (-inf)
-template <typename T, typename Traits>
-std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
+template <typename CharSource, typename T, typename Traits>
+void ParseHexFloatAfterPrefix(CharSource& src, bool negate_value,
+                              HexFloat<T, Traits>& value) {
   using HF = HexFloat<T, Traits>;
   using uint_type = typename HF::uint_type;
   using int_type = typename HF::int_type;
 
-  value.set_value(static_cast<typename HF::native_type>(0.f));
-
-  if (is.flags() & std::ios::skipws) {
-    // If the user wants to skip whitespace , then we should obey that.
-    while (std::isspace(is.peek())) {
-      is.get();
-    }
-  }
-
-  auto next_char = is.peek();
-  bool negate_value = false;
-
-  if (next_char != '-' && next_char != '0') {
-    return ParseNormalFloat(is, negate_value, value);
-  }
-
-  if (next_char == '-') {
-    negate_value = true;
-    is.get();
-    next_char = is.peek();
-  }
-
-  if (next_char == '0') {
-    is.get();  // We may have to unget this.
-    auto maybe_hex_start = is.peek();
-    if (maybe_hex_start != 'x' && maybe_hex_start != 'X') {
-      is.unget();
-      return ParseNormalFloat(is, negate_value, value);
-    } else {
-      is.get();  // Throw away the 'x';
-    }
-  } else {
-    return ParseNormalFloat(is, negate_value, value);
-  }
-
-  // This "looks" like a hex-float so treat it as one.
   bool seen_p = false;
   bool seen_dot = false;
   uint_type fraction_index = 0;
@@ -881,8 +916,9 @@ std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
   int_type exponent = HF::exponent_bias;
 
   // Strip off leading zeros so we don't have to special-case them later.
-  while ((next_char = is.peek()) == '0') {
-    is.get();
+  int next_char;
+  while ((next_char = src.peek()) == '0') {
+    src.get();
   }
 
   bool is_denorm =
@@ -916,11 +952,11 @@ std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
       }
     } else {
       // We have not found our exponent yet, so we have to fail.
-      is.setstate(std::ios::failbit);
-      return is;
+      src.fail();
+      return;
     }
-    is.get();
-    next_char = is.peek();
+    src.get();
+    next_char = src.peek();
   }
   bits_written = false;
   while (seen_dot && !seen_p) {
@@ -947,11 +983,11 @@ std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
     } else {
       // We still have not found our 'p' exponent yet, so this is not a valid
       // hex-float.
-      is.setstate(std::ios::failbit);
-      return is;
+      src.fail();
+      return;
     }
-    is.get();
-    next_char = is.peek();
+    src.get();
+    next_char = src.peek();
   }
 
   bool seen_sign = false;
@@ -960,8 +996,8 @@ std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
   while (true) {
     if ((next_char == '-' || next_char == '+')) {
       if (seen_sign) {
-        is.setstate(std::ios::failbit);
-        return is;
+        src.fail();
+        return;
       }
       seen_sign = true;
       exponent_sign = (next_char == '-') ? -1 : 1;
@@ -973,8 +1009,8 @@ std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
     } else {
       break;
     }
-    is.get();
-    next_char = is.peek();
+    src.get();
+    next_char = src.peek();
   }
 
   written_exponent = static_cast<int_type>(written_exponent * exponent_sign);
@@ -1028,10 +1064,171 @@ std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
 
   T output_float = spvutils::BitwiseCast<T>(output_bits);
   value.set_value(output_float);
+}
+
+// Reads a HexFloat from the given stream.
+// If the float is not encoded as a hex-float then it will be parsed
+// as a regular float.
+// This may fail if your stream does not support at least one unget.
+// See ParseHexFloatAfterPrefix for the accepted hex-float encodings.
+template <typename T, typename Traits>
+std::istream& operator>>(std::istream& is, HexFloat<T, Traits>& value) {
+  value.set_value(static_cast<typename HexFloat<T, Traits>::native_type>(0.f));
 
+  if (is.flags() & std::ios::skipws) {
+    // If the user wants to skip whitespace , then we should obey that.
+    while (std::isspace(is.peek())) {
+      is.get();
+    }
+  }
+
+  auto next_char = is.peek();
+  bool negate_value = false;
+
+  if (next_char != '-' && next_char != '0') {
+    return ParseNormalFloat(is, negate_value, value);
+  }
+
+  if (next_char == '-') {
+    negate_value = true;
+    is.get();
+    next_char = is.peek();
+  }
+
+  if (next_char == '0') {
+    is.get();  // We may have to unget this.
+    auto maybe_hex_start = is.peek();
+    if (maybe_hex_start != 'x' && maybe_hex_start != 'X') {
+      is.unget();
+      return ParseNormalFloat(is, negate_value, value);
+    } else {
+      is.get();  // Throw away the 'x';
+    }
+  } else {
+    return ParseNormalFloat(is, negate_value, value);
+  }
+
+  // This "looks" like a hex-float so treat it as one.
+  IStreamCharSource src(is);
+  ParseHexFloatAfterPrefix(src, negate_value, value);
   return is;
 }
 
+// Parses a decimal float directly from the character range [pos, end) and
+// stores it into the value parameter, mirroring the stream overload of
+// ParseNormalFloat above including its overflow clamping. On success sets
+// *parse_end to one past the last consumed character and returns true.
+template <typename T, typename Traits>
+inline bool ParseNormalFloat(const char* pos, const char* end,
+                             const char** parse_end, bool negate_value,
+                             HexFloat<T, Traits>& value) {
+  typedef typename Traits::native_type native_type;
+  if (negate_value && pos != end && (*pos == '-' || *pos == '+')) {
+    // Emulate standard behaviour by setting the value to the zero value.
+    value = HexFloat<T, Traits>(typename HexFloat<T, Traits>::uint_type(0));
+    return false;
+  }
+  // The C parsing routines need a NUL-terminated buffer, so take a copy of
+  // the longest prefix a decimal float literal may span.
+  const char* scan = pos;
+  while (scan != end &&
+         (std::isdigit(static_cast<unsigned char>(*scan)) || *scan == '.' ||
+          *scan == 'e' || *scan == 'E' ||
+          ((*scan == '+' || *scan == '-') &&
+           (scan == pos || scan[-1] == 'e' || scan[-1] == 'E')))) {
+    ++scan;
+  }
+  const std::string token(pos, scan);
+  char* number_end = nullptr;
+  const native_type native_val =
+      FloatProxyTraits<native_type>::fromCString(token.c_str(), &number_end);
+  if (number_end == token.c_str()) {
+    value = HexFloat<T, Traits>(typename HexFloat<T, Traits>::uint_type(0));
+    return false;
+  }
+  T val(native_val);
+  if (negate_value) {
+    val = -val;
+  }
+  value.set_value(val);
+  if (val.isInfinity()) {
+    // Emulate standard behaviour by setting the value to the closest normal
+    // value.
+    value.set_value((value.isNegative() | negate_value) ? T::lowest()
+                                                        : T::max());
+    return false;
+  }
+  *parse_end = pos + (number_end - token.c_str());
+  return true;
+}
+
+// Specialization of the pointer-based ParseNormalFloat for
+// FloatProxy<Float16> values. This will parse the float as it were a 32-bit
+// floating point number, and then round it down to fit into a Float16 value,
+// rounding towards zero, like the stream specialization above.
+template <>
+inline bool
+ParseNormalFloat<FloatProxy<Float16>, HexFloatTraits<FloatProxy<Float16>>>(
+    const char* pos, const char* end, const char** parse_end,
+    bool negate_value,
+    HexFloat<FloatProxy<Float16>, HexFloatTraits<FloatProxy<Float16>>>&
+        value) {
+  // First parse as a 32-bit float.
+  HexFloat<FloatProxy<float>> float_val(0.0f);
+  if (!ParseNormalFloat(pos, end, parse_end, negate_value, float_val)) {
+    return false;
+  }
+
+  // Then convert to 16-bit float, saturating at infinities, and
+  // rounding toward zero.
+  float_val.castTo(value, kRoundToZero);
+
+  // Overflow on 16-bit behaves the same as for 32- and 64-bit: set the
+  // lowest or highest value.
+  if (Float16::isInfinity(value.value().getAsFloat())) {
+    value.set_value(value.isNegative() ? Float16::lowest() : Float16::max());
+    return false;
+  }
+  return true;
+}
+
+// Parses a float from the character range [pos, end) into the value
+// parameter, accepting the same hex-float and decimal forms as the stream
+// operator>> above but walking the characters directly: no stream state,
+// locale or sentry objects. On success sets *parse_end to one past the last
+// consumed character and returns true.
+template <typename T, typename Traits>
+bool ParseFloat(const char* pos, const char* end, const char** parse_end,
+                HexFloat<T, Traits>& value) {
+  value.set_value(static_cast<typename HexFloat<T, Traits>::native_type>(0.f));
+
+  while (pos != end && std::isspace(static_cast<unsigned char>(*pos))) {
+    ++pos;
+  }
+
+  bool negate_value = false;
+  const char* after_sign = pos;
+  if (pos != end && *pos == '-') {
+    negate_value = true;
+    ++after_sign;
+  }
+
+  if (end - after_sign >= 2 && after_sign[0] == '0' &&
+      (after_sign[1] == 'x' || after_sign[1] == 'X')) {
+    // This "looks" like a hex-float so treat it as one.
+    BufferCharSource src(after_sign + 2, end);
+    ParseHexFloatAfterPrefix(src, negate_value, value);
+    if (src.failed()) {
+      return false;
+    }
+    *parse_end = src.position();
+    return true;
+  }
+
+  // Not a hex-float: hand the range, sign included, to the decimal parser.
+  return ParseNormalFloat(pos, end, parse_end, false, value);
+}
+
 // Writes a FloatProxy value to a stream.
 // Zero and normal numbers are printed in the usual notation, but with
 // enough digits to fully reproduce the value.  Other values (subnormal,
@@ -80,6 +80,9 @@ public:
 
   void setScope(SPIRVEntry *Scope) override;
   void setParent(SPIRVFunction *F) { ParentF = F; }
+  // Size the instruction vector up front when the decoder knows how many
+  // instructions the block holds, so addInstruction never reallocates.
+  void reserveInstructions(size_t N) { InstVec.reserve(N); }
   SPIRVInstruction *addInstruction(SPIRVInstruction *I);
   void eraseInstruction(const SPIRVInstruction *I) {
     auto Loc = find(I);
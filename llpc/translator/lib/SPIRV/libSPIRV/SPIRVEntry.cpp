@@ -47,6 +47,7 @@
 #include "SPIRVType.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <map>
 #include <set>
 #include <sstream>
@@ -57,6 +58,76 @@ using namespace SPIRV;
 
 namespace SPIRV {
 
+// Arena SPIRVEntry allocations on this thread are routed to, if any. Module
+// parsing and translation happen on a single thread, so a thread-local is
+// enough to reach the allocator without threading it through every entry
+// construction site.
+static thread_local SPIRVEntryArena *ActiveEntryArena = nullptr;
+
+// Every allocation is prefixed with one maximally aligned tag word telling
+// operator delete whether the memory belongs to an arena or the heap.
+static const size_t AllocHeaderSize = alignof(std::max_align_t);
+
+void *SPIRVEntryArena::allocate(size_t Size) {
+  // Keep every returned pointer maximally aligned.
+  const size_t Align = alignof(std::max_align_t);
+  Size = (Size + Align - 1) & ~(Align - 1);
+  const size_t HeaderBytes = (sizeof(BlockHeader) + Align - 1) & ~(Align - 1);
+
+  if (Size > Avail) {
+    size_t NewBlockBytes = BlockSize;
+    if (HeaderBytes + Size > NewBlockBytes)
+      NewBlockBytes = HeaderBytes + Size;
+    auto NewBlock = static_cast<BlockHeader *>(::operator new(NewBlockBytes));
+    NewBlock->Prev = Block;
+    Block = NewBlock;
+    BlockBytes = NewBlockBytes;
+    Avail = NewBlockBytes - HeaderBytes;
+  }
+
+  void *Ptr = reinterpret_cast<char *>(Block) + (BlockBytes - Avail);
+  Avail -= Size;
+  return Ptr;
+}
+
+void SPIRVEntryArena::reset() {
+  while (Block) {
+    BlockHeader *Prev = Block->Prev;
+    ::operator delete(Block);
+    Block = Prev;
+  }
+  BlockBytes = 0;
+  Avail = 0;
+}
+
+SPIRVEntryArenaScope::SPIRVEntryArenaScope(SPIRVEntryArena &A)
+    : Saved(ActiveEntryArena) {
+  ActiveEntryArena = &A;
+}
+
+SPIRVEntryArenaScope::~SPIRVEntryArenaScope() { ActiveEntryArena = Saved; }
+
+void *SPIRVEntry::operator new(size_t Size) {
+  if (ActiveEntryArena) {
+    auto Mem =
+        static_cast<char *>(ActiveEntryArena->allocate(Size + AllocHeaderSize));
+    *reinterpret_cast<size_t *>(Mem) = 1;
+    return Mem + AllocHeaderSize;
+  }
+  auto Mem = static_cast<char *>(::operator new(Size + AllocHeaderSize));
+  *reinterpret_cast<size_t *>(Mem) = 0;
+  return Mem + AllocHeaderSize;
+}
+
+void SPIRVEntry::operator delete(void *Ptr) {
+  if (!Ptr)
+    return;
+  auto Mem = static_cast<char *>(Ptr) - AllocHeaderSize;
+  // Arena-backed memory is released wholesale by the arena.
+  if (*reinterpret_cast<size_t *>(Mem) == 0)
+    ::operator delete(Mem);
+}
+
 template <typename T> SPIRVEntry *create() { return new T(); }
 
 SPIRVEntry *SPIRVEntry::create(Op OpCode) {
@@ -124,8 +195,11 @@ void SPIRVEntry::setWordCount(SPIRVWord TheWordCount) {
   WordCount = TheWordCount;
 }
 
-void SPIRVEntry::setName(const std::string &TheName) {
-  Name = TheName;
+void SPIRVEntry::setName(llvm::StringRef TheName) {
+  // Names are interned in the module's string arena: the entry only holds a view, so the many identical names in a
+  // debug-annotated module are stored once and naming an entry does not allocate.
+  assert(Module && "Entry must be added to a module before it is named");
+  Name = Module->internString(TheName);
 }
 
 void SPIRVEntry::setModule(SPIRVModule *TheModule) {
@@ -317,7 +391,7 @@ SPIRVLinkageTypeKind SPIRVEntry::getLinkageType() const {
 void SPIRVEntry::setLinkageType(SPIRVLinkageTypeKind LT) {
   assert(isValid(LT));
   assert(hasLinkageType());
-  addDecorate(new SPIRVDecorateLinkageAttr(this, Name, LT));
+  addDecorate(new SPIRVDecorateLinkageAttr(this, Name.str(), LT));
 }
 
 void SPIRVEntry::updateModuleVersion() const {
@@ -43,6 +43,7 @@
 #include "SPIRVEnum.h"
 #include "SPIRVError.h"
 #include "SPIRVIsValidEnum.h"
+#include "llvm/ADT/StringRef.h"
 #include <cassert>
 #include <iostream>
 #include <map>
@@ -182,6 +183,50 @@ class SPIRVExtInst;
 /// 7. Add the class to the Table of SPIRVEntry::create().
 /// 8. Add the class to SPIRVToLLVM.
 
+/// Bump allocator providing the backing memory for all SPIRVEntry objects
+/// of a module. Entries are allocated with a pointer bump and their memory
+/// is released wholesale when the owning module is destroyed, replacing one
+/// malloc/free pair per entry. Destructors still run through operator
+/// delete since entries own container members; only the entry storage
+/// itself is pooled.
+class SPIRVEntryArena {
+public:
+  SPIRVEntryArena() : Block(nullptr), BlockBytes(0), Avail(0) {}
+  ~SPIRVEntryArena() { reset(); }
+
+  void *allocate(size_t Size);
+  void reset();
+
+private:
+  SPIRVEntryArena(const SPIRVEntryArena &) = delete;
+  SPIRVEntryArena &operator=(const SPIRVEntryArena &) = delete;
+
+  // Default size of an arena block. Entries are small, so one block
+  // typically serves thousands of allocations; oversized requests get a
+  // dedicated block.
+  static const size_t BlockSize = 256 * 1024;
+
+  struct BlockHeader {
+    BlockHeader *Prev; // Previously filled block, so reset() can walk them
+  };
+
+  BlockHeader *Block; // Current block; filled blocks are chained via Prev
+  size_t BlockBytes;  // Total size of the current block
+  size_t Avail;       // Bytes still free at the end of the current block
+};
+
+/// RAII helper routing SPIRVEntry allocations on the current thread to the
+/// given arena for the duration of the scope. Typically instantiated around
+/// module parsing, where the bulk of the entries are created.
+class SPIRVEntryArenaScope {
+public:
+  SPIRVEntryArenaScope(SPIRVEntryArena &A);
+  ~SPIRVEntryArenaScope();
+
+private:
+  SPIRVEntryArena *Saved;
+};
+
 class SPIRVEntry {
 public:
   enum SPIRVEntryAttrib {
@@ -215,6 +260,13 @@ public:
 
   virtual ~SPIRVEntry() {}
 
+  // Entries allocated while a SPIRVEntryArenaScope is active on the current
+  // thread come from that arena; operator delete then only runs the
+  // destructor and leaves the memory to the arena. Entries created outside
+  // such a scope fall back to the heap and behave as usual.
+  void *operator new(size_t Size);
+  void operator delete(void *Ptr);
+
   bool exist(SPIRVId) const;
   template <class T> T *get(SPIRVId TheId) const {
     return static_cast<T *>(getEntry(TheId));
@@ -238,7 +290,7 @@ public:
   Op getOpCode() const { return OpCode; }
   SPIRVModule *getModule() const { return Module; }
   virtual SPIRVCapVec getRequiredCapability() const { return SPIRVCapVec(); }
-  const std::string &getName() const { return Name; }
+  llvm::StringRef getName() const { return Name; }
   bool hasDecorate(Decoration Kind, size_t Index = 0,
                    SPIRVWord *Result = 0) const;
   bool hasMemberDecorate(SPIRVWord MemberIndex, Decoration Kind,
@@ -279,7 +331,7 @@ public:
   void setLine(const std::shared_ptr<const SPIRVLine> &L);
   void setLinkageType(SPIRVLinkageTypeKind);
   void setModule(SPIRVModule *TheModule);
-  void setName(const std::string &TheName);
+  void setName(llvm::StringRef TheName);
   virtual void setScope(SPIRVEntry *Scope){};
   void takeAnnotations(SPIRVForward *);
   void takeDecorates(SPIRVEntry *);
@@ -351,7 +403,7 @@ protected:
   SPIRVModule *Module;
   Op OpCode;
   SPIRVId Id;
-  std::string Name;
+  llvm::StringRef Name; // View into the owning module's string arena, see SPIRVModule::internString()
   unsigned Attrib;
   SPIRVWord WordCount;
 
@@ -60,11 +60,64 @@ SPIRVDecoder SPIRVFunction::getDecoder(std::istream &IS) {
   return SPIRVDecoder(IS, *this);
 }
 
+/// Walk the function body by instruction headers only, without decoding
+/// operands or constructing entries, to learn how many parameters, basic
+/// blocks and per-block instructions the body holds. Reads through the
+/// stream buffer directly and restores the read position afterwards, so
+/// the decode that follows is unaffected. A no-op on unseekable streams.
+void SPIRVFunction::prescanBody(std::istream &I, size_t &NumParams,
+                                std::vector<size_t> &BlockInstCounts) const {
+  std::streambuf *Buf = I.rdbuf();
+  const std::streampos Start =
+      Buf->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+  if (Start == std::streampos(-1))
+    return;
+  SPIRVWord Header = 0;
+  while (Buf->sgetn(reinterpret_cast<char *>(&Header), sizeof(Header)) ==
+         sizeof(Header)) {
+    const SPIRVWord WordCount = Header >> 16;
+    const Op OpCode = static_cast<Op>(Header & 0xFFFF);
+    if (OpCode == OpFunctionEnd)
+      break;
+    switch (OpCode) {
+    case OpFunctionParameter:
+      ++NumParams;
+      break;
+    case OpLabel:
+      BlockInstCounts.push_back(0);
+      break;
+    case OpLine:
+    case OpNoLine:
+    case OpNop:
+      break;
+    default:
+      if (!BlockInstCounts.empty())
+        ++BlockInstCounts.back();
+      break;
+    }
+    if (WordCount > 1 &&
+        Buf->pubseekoff(std::streamoff(WordCount - 1) * sizeof(SPIRVWord),
+                        std::ios_base::cur,
+                        std::ios_base::in) == std::streampos(-1))
+      break;
+  }
+  Buf->pubseekpos(Start, std::ios_base::in);
+}
+
 void SPIRVFunction::decode(std::istream &I) {
   SPIRVDecoder Decoder = getDecoder(I);
   Decoder >> Type >> Id >> FCtrlMask >> FuncType;
   Module->addFunction(this);
 
+  // Pre-size the containers filled below, so decoding a large body never
+  // reallocates them.
+  size_t NumParams = 0;
+  std::vector<size_t> BlockInstCounts;
+  prescanBody(I, NumParams, BlockInstCounts);
+  Parameters.reserve(Parameters.size() + NumParams);
+  BBVec.reserve(BBVec.size() + BlockInstCounts.size());
+  size_t BlockIdx = 0;
+
   Decoder.getWordCountAndOpCode();
   while (!I.eof()) {
     if (Decoder.OpCode == OpFunctionEnd)
@@ -81,7 +134,9 @@ void SPIRVFunction::decode(std::istream &I) {
       break;
     }
     case OpLabel: {
-      decodeBB(Decoder);
+      decodeBB(Decoder, BlockIdx < BlockInstCounts.size()
+                            ? BlockInstCounts[BlockIdx] : 0);
+      ++BlockIdx;
       break;
     }
     case OpLine:
@@ -98,10 +153,14 @@ void SPIRVFunction::decode(std::istream &I) {
 
 /// Decode basic block and contained instructions.
 /// Do it here instead of in BB:decode to avoid back track in input stream.
-void SPIRVFunction::decodeBB(SPIRVDecoder &Decoder) {
+/// InstCountHint is the instruction count found by prescanBody, or 0 if the
+/// body was not prescanned.
+void SPIRVFunction::decodeBB(SPIRVDecoder &Decoder, size_t InstCountHint) {
   SPIRVBasicBlock *BB = static_cast<SPIRVBasicBlock *>(Decoder.getEntry());
   assert(BB);
   addBasicBlock(BB);
+  if (InstCountHint)
+    BB->reserveInstructions(InstCountHint);
 
   Decoder.setScope(BB);
   while (Decoder.getWordCountAndOpCode()) {
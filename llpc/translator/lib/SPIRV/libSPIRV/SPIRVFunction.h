@@ -135,7 +135,9 @@ private:
     for (size_t I = 0, E = getFunctionType()->getNumParameters(); I != E; ++I)
       addArgument(I, FirstArgId + I);
   }
-  void decodeBB(SPIRVDecoder &);
+  void prescanBody(std::istream &I, size_t &NumParams,
+                   std::vector<size_t> &BlockInstCounts) const;
+  void decodeBB(SPIRVDecoder &, size_t InstCountHint);
 
   SPIRVTypeFunction *FuncType; // Function type
   SPIRVWord FCtrlMask;         // Function control mask
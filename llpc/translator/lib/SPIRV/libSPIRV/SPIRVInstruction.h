@@ -123,6 +123,12 @@ public:
   SPIRVInstruction *getPrevious() const { return BB->getPrevious(this); }
   SPIRVInstruction *getNext() const { return BB->getNext(this); }
   virtual std::vector<SPIRVValue *> getOperands();
+  // Non-allocating operand access. The defaults fall back on getOperands()
+  // for the few instructions that define custom operand lists;
+  // SPIRVInstTemplateBase overrides both to read the decoded words directly,
+  // so hot paths can visit operands without materializing a vector per query.
+  virtual size_t getNumOperands() { return getOperands().size(); }
+  virtual SPIRVValue *getOperand(unsigned I) { return getOperands()[I]; }
   std::vector<SPIRVType *> getOperandTypes();
   static std::vector<SPIRVType *>
   getOperandTypes(const std::vector<SPIRVValue *> &Ops);
@@ -298,6 +304,8 @@ public:
     return VOps;
   }
 
+  size_t getNumOperands() override { return Ops.size() - getOperandOffset(); }
+
   std::vector<SPIRVEntry *> getNonLiteralOperands() const override {
     std::vector<SPIRVEntry *> Operands;
     for (size_t I = getOperandOffset(), E = Ops.size(); I < E; ++I)
@@ -306,7 +314,7 @@ public:
     return Operands;
   }
 
-  virtual SPIRVValue *getOperand(unsigned I) {
+  SPIRVValue *getOperand(unsigned I) override {
     return getOpValue(I + getOperandOffset());
   }
 
@@ -46,15 +46,30 @@
 #include "SPIRVStream.h"
 #include "SPIRVType.h"
 #include "SPIRVValue.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/StringSaver.h"
 
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
 
+namespace {
+
+// Skip decoding of debug-only instructions (names, lines, sources) when
+// parsing a module. The default pipeline path strips them from the stored
+// module binary already; this covers clients that feed untrimmed SPIR-V
+// straight to the translator and do not need names or line info.
+llvm::cl::opt<bool> SkipDebugInfoParse(
+    "spirv-skip-debug-info-parse", llvm::cl::init(false),
+    llvm::cl::desc("Skip decoding of debug-only SPIR-V instructions when "
+                   "parsing a module"));
+
+} // namespace
+
 namespace SPIRV {
 
 SPIRVModule::SPIRVModule()
-    : AutoAddCapability(true), ValidateCapability(false) {}
+    : AutoAddCapability(true), ValidateCapability(false), TrustedInput(false) {}
 
 SPIRVModule::~SPIRVModule() {}
 
@@ -76,6 +91,7 @@ public:
   bool exist(SPIRVId, SPIRVEntry **) const override;
   SPIRVId getId(SPIRVId Id = SPIRVID_INVALID, unsigned Increment = 1);
   SPIRVEntry *getEntry(SPIRVId Id) const override;
+  SPIRVId getIdBound() const override { return NextId; }
   bool hasDebugInfo() const override { return !StringVec.empty(); }
 
   // Error handling functions
@@ -156,7 +172,8 @@ public:
     AddrModel = AM;
   }
   void setMemoryModel(SPIRVMemoryModelKind MM) override { MemoryModel = MM; }
-  void setName(SPIRVEntry *E, const std::string &Name) override;
+  void setName(SPIRVEntry *E, llvm::StringRef Name) override;
+  llvm::StringRef internString(llvm::StringRef Str) override;
   void setSourceLanguage(SourceLanguage Lang, SPIRVWord Ver) override {
     SrcLang = Lang;
     SrcLangVer = Ver;
@@ -353,7 +370,10 @@ private:
   SPIRVAddressingModelKind AddrModel;
   SPIRVMemoryModelKind MemoryModel;
 
-  typedef std::map<SPIRVId, SPIRVEntry *> SPIRVIdToEntryMap;
+  // Ids are dense small integers below the module's id bound, so entries are
+  // kept in a flat vector indexed by id (null for unused ids) and every
+  // getEntry()/getValue()/getType() lookup is an array index.
+  typedef std::vector<SPIRVEntry *> SPIRVIdToEntryMap;
   typedef std::vector<SPIRVEntry *> SPIRVEntryVector;
   typedef std::set<SPIRVId> SPIRVIdSet;
   typedef std::vector<SPIRVId> SPIRVIdVec;
@@ -394,13 +414,33 @@ private:
   std::map<unsigned, SPIRVTypeInt *> IntTypeMap;
   std::map<unsigned, SPIRVConstant *> LiteralMap;
 
+  // Backing memory for this module's entries. Declared here so its blocks
+  // are released after the destructor has run the entry destructors.
+  SPIRVEntryArena EntryArena;
+
+  // Arena holding one deduplicated copy of every string interned via
+  // internString(); entry names are views into it.
+  llvm::BumpPtrAllocator StrArena;
+  llvm::UniqueStringSaver StrSaver{StrArena};
+
   void layoutEntry(SPIRVEntry *Entry);
+
+  // Records Entry as the definition of Id, growing the id-indexed vector as
+  // needed. When decoding, the first insertion grows it straight to the id
+  // bound read from the module header.
+  void setEntry(SPIRVId Id, SPIRVEntry *Entry) {
+    if (Id >= IdEntryMap.size())
+      IdEntryMap.resize(std::max(static_cast<size_t>(Id) + 1,
+                                 static_cast<size_t>(NextId)),
+                        nullptr);
+    IdEntryMap[Id] = Entry;
+  }
 };
 
 SPIRVModuleImpl::~SPIRVModuleImpl() {
 
-  for (auto I : IdEntryMap)
-    delete I.second;
+  for (auto *E : IdEntryMap)
+    delete E;
 
   for (auto I : EntryNoId) {
     if (I->getOpCode() == OpLine)
@@ -544,7 +584,7 @@ SPIRVEntry *SPIRVModuleImpl::addEntry(SPIRVEntry *Entry) {
         assert(Mapped == Entry && "Id used twice");
       }
     } else
-      IdEntryMap[Id] = Entry;
+      setEntry(Id, Entry);
   } else {
     if (EntryNoId.empty() || Entry !=  EntryNoId.back())
       EntryNoId.push_back(Entry);
@@ -571,11 +611,11 @@ bool SPIRVModuleImpl::exist(SPIRVId Id) const { return exist(Id, nullptr); }
 
 bool SPIRVModuleImpl::exist(SPIRVId Id, SPIRVEntry **Entry) const {
   assert(Id != SPIRVID_INVALID && "Invalid Id");
-  SPIRVIdToEntryMap::const_iterator Loc = IdEntryMap.find(Id);
-  if (Loc == IdEntryMap.end())
+  SPIRVEntry *E = Id < IdEntryMap.size() ? IdEntryMap[Id] : nullptr;
+  if (!E)
     return false;
   if (Entry)
-    *Entry = Loc->second;
+    *Entry = E;
   return true;
 }
 
@@ -592,9 +632,8 @@ SPIRVId SPIRVModuleImpl::getId(SPIRVId Id, unsigned Increment) {
 
 SPIRVEntry *SPIRVModuleImpl::getEntry(SPIRVId Id) const {
   assert(Id != SPIRVID_INVALID && "Invalid Id");
-  SPIRVIdToEntryMap::const_iterator Loc = IdEntryMap.find(Id);
-  assert(Loc != IdEntryMap.end() && "Id is not in map");
-  return Loc->second;
+  assert(Id < IdEntryMap.size() && IdEntryMap[Id] && "Id is not in map");
+  return IdEntryMap[Id];
 }
 
 SPIRVExtInstSetKind SPIRVModuleImpl::getBuiltinSet(SPIRVId SetId) const {
@@ -651,7 +690,7 @@ bool SPIRVModuleImpl::importBuiltinSetWithId(const std::string &BuiltinSetName,
   return true;
 }
 
-void SPIRVModuleImpl::setName(SPIRVEntry *E, const std::string &Name) {
+void SPIRVModuleImpl::setName(SPIRVEntry *E, llvm::StringRef Name) {
   E->setName(Name);
   if (!E->hasId())
     return;
@@ -661,6 +700,12 @@ void SPIRVModuleImpl::setName(SPIRVEntry *E, const std::string &Name) {
     NamedId.erase(E->getId());
 }
 
+llvm::StringRef SPIRVModuleImpl::internString(llvm::StringRef Str) {
+  if (Str.empty())
+    return "";
+  return StrSaver.save(Str);
+}
+
 void SPIRVModuleImpl::resolveUnknownStructFields() {
   for (auto &KV : UnknownStructFieldMap) {
     auto *Struct = KV.first;
@@ -815,13 +860,12 @@ SPIRVEntry *SPIRVModuleImpl::replaceForward(SPIRVForward *Forward,
   SPIRVId Id = Entry->getId();
   SPIRVId ForwardId = Forward->getId();
   if (ForwardId == Id)
-    IdEntryMap[Id] = Entry;
+    setEntry(Id, Entry);
   else {
-    auto Loc = IdEntryMap.find(Id);
-    assert(Loc != IdEntryMap.end());
-    IdEntryMap.erase(Loc);
+    assert(Id < IdEntryMap.size() && IdEntryMap[Id]);
+    IdEntryMap[Id] = nullptr;
     Entry->setId(ForwardId);
-    IdEntryMap[ForwardId] = Entry;
+    setEntry(ForwardId, Entry);
   }
   // Annotations include name, decorations, execution modes
   Entry->takeAnnotations(Forward);
@@ -840,9 +884,8 @@ void SPIRVModuleImpl::eraseInstruction(SPIRVInstruction *I,
                                        SPIRVBasicBlock *BB) {
   SPIRVId Id = I->getId();
   BB->eraseInstruction(I);
-  auto Loc = IdEntryMap.find(Id);
-  assert(Loc != IdEntryMap.end());
-  IdEntryMap.erase(Loc);
+  assert(Id < IdEntryMap.size() && IdEntryMap[Id]);
+  IdEntryMap[Id] = nullptr;
   delete I;
 }
 
@@ -1234,12 +1277,34 @@ void SPIRVModuleImpl::addUnknownStructField(SPIRVTypeStruct *Struct, unsigned I,
   UnknownStructFieldMap[Struct].push_back(std::make_pair(I, ID));
 }
 
+// Returns true for instructions that carry only debug information and can be
+// skipped at decode time without affecting translation.
+static bool isDebugOnlyOpCode(Op OC) {
+  switch (OC) {
+  case OpSource:
+  case OpSourceContinued:
+  case OpSourceExtension:
+  case OpName:
+  case OpMemberName:
+  case OpLine:
+  case OpNoLine:
+  case OpModuleProcessed:
+    return true;
+  default:
+    return false;
+  }
+}
+
 std::istream &operator>>(std::istream &I, SPIRVModule &M) {
   SPIRVDecoder Decoder(I, M);
   SPIRVModuleImpl &MI = *static_cast<SPIRVModuleImpl *>(&M);
   // Disable automatic capability filling.
   MI.setAutoAddCapability(false);
 
+  // Entries created while parsing are bump-allocated from the module's
+  // arena and released wholesale when the module dies.
+  SPIRVEntryArenaScope ArenaScope(MI.EntryArena);
+
   SPIRVWord Magic;
   Decoder >> Magic;
   assert(Magic == MagicNumber && "Invalid magic number");
@@ -1259,8 +1324,16 @@ std::istream &operator>>(std::istream &I, SPIRVModule &M) {
   assert(MI.InstSchema == SPIRVISCH_Default &&
          "Unsupported instruction schema");
 
-  while(Decoder.getWordCountAndOpCode())
-    Decoder.getEntry();
+  while (Decoder.getWordCountAndOpCode()) {
+    // Debug-only instructions can be skipped by word count without
+    // constructing entries at all; parse time then scales with the module's
+    // semantic content only. OpString is kept, as non-semantic extended
+    // instructions may reference it.
+    if (SkipDebugInfoParse && isDebugOnlyOpCode(Decoder.OpCode))
+      Decoder.ignoreInstruction();
+    else
+      Decoder.getEntry();
+  }
 
   MI.optimizeDecorates();
   MI.resolveUnknownStructFields();
@@ -96,6 +96,8 @@ public:
     return static_cast<T *>(getEntry(Id));
   }
   virtual SPIRVEntry *getEntry(SPIRVId) const = 0;
+  /// Returns one past the largest id used by the module (the header's id bound after decoding).
+  virtual SPIRVId getIdBound() const = 0;
   virtual bool hasDebugInfo() const = 0;
 
   // Error handling functions
@@ -145,11 +147,18 @@ public:
   virtual bool importBuiltinSetWithId(const std::string &, SPIRVId) = 0;
   virtual void setAddressingModel(SPIRVAddressingModelKind) = 0;
   virtual void setMemoryModel(SPIRVMemoryModelKind) = 0;
-  virtual void setName(SPIRVEntry *, const std::string &) = 0;
+  virtual void setName(SPIRVEntry *, llvm::StringRef) = 0;
+  /// Stores a copy of the string in the module's string arena, deduplicating repeats, and returns a view of it
+  /// that stays valid for the module's lifetime. Entry names hold such views instead of owning strings.
+  virtual llvm::StringRef internString(llvm::StringRef) = 0;
   virtual void setSourceLanguage(SourceLanguage, SPIRVWord) = 0;
   virtual void optimizeDecorates() = 0;
   virtual void setAutoAddCapability(bool E) { AutoAddCapability = E; }
   virtual void setValidateCapability(bool E) { ValidateCapability = E; }
+  /// Marks the module as already validated by an external tool (e.g. spirv-val),
+  /// letting the translator skip per-entry operand validation during translation.
+  virtual void setTrustedInput(bool E) { TrustedInput = E; }
+  bool isTrustedInput() const { return TrustedInput; }
   virtual void setGeneratorId(unsigned short) = 0;
   virtual void setGeneratorVer(unsigned short) = 0;
   virtual void resolveUnknownStructFields() = 0;
@@ -345,6 +354,7 @@ public:
 protected:
   bool AutoAddCapability;
   bool ValidateCapability;
+  bool TrustedInput;
 };
 
 class SPIRVDbgInfo {
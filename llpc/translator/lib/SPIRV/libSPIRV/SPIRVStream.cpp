@@ -76,17 +76,22 @@ SPIRV_DEF_ENCDEC(LinkageType)
 // Read a string with padded 0's at the end so that they form a stream of
 // words.
 const SPIRVDecoder &operator>>(const SPIRVDecoder &I, std::string &Str) {
+  // Read characters straight from the stream buffer, for the same reason
+  // decodeBinary does.
+  std::streambuf *Buf = I.IS.rdbuf();
   uint64_t Count = 0;
-  char Ch;
-  while (I.IS.get(Ch) && Ch != '\0') {
-    Str += Ch;
+  std::streambuf::int_type Ch;
+  while ((Ch = Buf->sbumpc()) != std::streambuf::traits_type::eof() &&
+         Ch != '\0') {
+    Str += static_cast<char>(Ch);
     ++Count;
   }
   Count = (Count + 1) % 4;
   Count = Count ? 4 - Count : 0;
   for (; Count; --Count) {
-    I.IS >> Ch;
+    Ch = Buf->sbumpc();
     assert(Ch == '\0' && "Invalid string in SPIRV");
+    (void)Ch;
   }
   return I;
 }
@@ -129,6 +134,18 @@ SPIRVEntry *SPIRVDecoder::getEntry() {
   return Entry;
 }
 
+// Skip the operand words of the current instruction without decoding them or
+// constructing an entry. Used to pass over debug-only instructions at parse
+// time.
+void SPIRVDecoder::ignoreInstruction() {
+  assert(WordCount > 0 && "Invalid word count");
+  const std::streamsize Bytes =
+      std::streamsize(WordCount - 1) * sizeof(SPIRVWord);
+  if (IS.rdbuf()->pubseekoff(Bytes, std::ios_base::cur, std::ios_base::in) ==
+      std::streampos(-1))
+    IS.ignore(Bytes);
+}
+
 void SPIRVDecoder::validate() const {
   assert(OpCode != OpNop && "Invalid op code");
   assert(WordCount && "Invalid word count");
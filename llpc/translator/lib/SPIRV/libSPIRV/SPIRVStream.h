@@ -47,6 +47,7 @@
 #include <cstdint>
 #include <iostream>
 #include <iterator>
+#include <streambuf>
 #include <string>
 #include <vector>
 
@@ -55,6 +56,50 @@ namespace SPIRV {
 class SPIRVFunction;
 class SPIRVBasicBlock;
 
+/// Read-only stream buffer presenting an in-memory SPIR-V binary to the
+/// decoder without copying it. Together with the raw buffer reads in
+/// decodeBinary this lets module parsing walk the original word buffer
+/// exactly once, with no istream extraction machinery in the way.
+class SPIRVMemoryStreamBuf : public std::streambuf {
+public:
+  SPIRVMemoryStreamBuf(const char *Data, size_t Size) {
+    char *Begin = const_cast<char *>(Data);
+    setg(Begin, Begin, Begin + Size);
+  }
+
+protected:
+  // The underlying binary is immutable, so refuse putback of modified
+  // characters.
+  int_type pbackfail(int_type) override { return traits_type::eof(); }
+
+  // Support seeking within the buffer, so the decoder can skip over
+  // instructions by word count without consuming them character by
+  // character.
+  pos_type seekoff(off_type Off, std::ios_base::seekdir Dir,
+                   std::ios_base::openmode Which) override {
+    if (!(Which & std::ios_base::in))
+      return pos_type(off_type(-1));
+    char *Target = nullptr;
+    if (Dir == std::ios_base::cur)
+      Target = gptr() + Off;
+    else if (Dir == std::ios_base::beg)
+      Target = eback() + Off;
+    else
+      Target = egptr() + Off;
+    if (Target < eback() || Target > egptr())
+      return pos_type(off_type(-1));
+    setg(eback(), Target, egptr());
+    return pos_type(Target - eback());
+  }
+
+  // Absolute seek. The streambuf default returns failure rather than
+  // forwarding to seekoff, which would break istream::tellg/seekg and
+  // pubseekpos on this buffer.
+  pos_type seekpos(pos_type Pos, std::ios_base::openmode Which) override {
+    return seekoff(off_type(Pos), std::ios_base::beg, Which);
+  }
+};
+
 class SPIRVDecoder {
 public:
   SPIRVDecoder(std::istream &InputStream, SPIRVModule &Module)
@@ -65,6 +110,7 @@ public:
   void setScope(SPIRVEntry *);
   bool getWordCountAndOpCode();
   SPIRVEntry *getEntry();
+  void ignoreInstruction();
   void validate() const;
 
   std::istream &IS;
@@ -76,8 +122,13 @@ public:
 
 template <typename T>
 const SPIRVDecoder &decodeBinary(const SPIRVDecoder &I, T &V) {
-  uint32_t W;
-  I.IS.read(reinterpret_cast<char *>(&W), sizeof(W));
+  uint32_t W = 0;
+  // Pull the word straight out of the stream buffer. Module parsing reads
+  // millions of words, and going through istream::read costs a sentry
+  // object and stream state checks per word.
+  if (I.IS.rdbuf()->sgetn(reinterpret_cast<char *>(&W), sizeof(W)) !=
+      sizeof(W))
+    I.IS.setstate(std::ios::failbit | std::ios::eofbit);
   V = static_cast<T>(W);
   return I;
 }
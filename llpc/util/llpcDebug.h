@@ -30,24 +30,62 @@
  */
 #pragma once
 
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/raw_ostream.h"
 #include <stdint.h>
 
+// Compile-time log levels. Build with LLPC_LOG_LEVEL set below a message's level to compile the message (including
+// the evaluation of its operands) out entirely.
+#define LLPC_LOG_LEVEL_NONE 0
+#define LLPC_LOG_LEVEL_ERRS 1
+#define LLPC_LOG_LEVEL_OUTS 2
+
+#ifndef LLPC_LOG_LEVEL
+#define LLPC_LOG_LEVEL LLPC_LOG_LEVEL_OUTS
+#endif
+
 // Output error message
+#if LLPC_LOG_LEVEL >= LLPC_LOG_LEVEL_ERRS
 #define LLPC_ERRS(_msg)                                                                                                \
-  {                                                                                                                    \
+  do                                                                                                                   \
     if (EnableErrs()) {                                                                                                \
-      outs() << "ERROR: " << _msg;                                                                                     \
-      outs().flush();                                                                                                  \
+      ::Llpc::DebugStream _stream(true);                                                                               \
+      _stream.stream() << "ERROR: " << _msg;                                                                           \
     }                                                                                                                  \
-  }
+  while (false)
+#else
+#define LLPC_ERRS(_msg)                                                                                                \
+  do {                                                                                                                 \
+  } while (false)
+#endif
 
 // Output general message
+#if LLPC_LOG_LEVEL >= LLPC_LOG_LEVEL_OUTS
 #define LLPC_OUTS(_msg)                                                                                                \
-  {                                                                                                                    \
+  do                                                                                                                   \
     if (EnableOuts()) {                                                                                                \
-      outs() << _msg;                                                                                                  \
+      ::Llpc::DebugStream _stream;                                                                                     \
+      _stream.stream() << _msg;                                                                                        \
     }                                                                                                                  \
-  }
+  while (false)
+
+// Output general message built by a callable taking a llvm::raw_ostream&, for messages whose formatting is itself
+// expensive: the callable only runs when output is enabled.
+#define LLPC_OUTS_LAZY(_callable)                                                                                      \
+  do                                                                                                                   \
+    if (EnableOuts()) {                                                                                                \
+      ::Llpc::DebugStream _stream;                                                                                     \
+      (_callable)(_stream.stream());                                                                                   \
+    }                                                                                                                  \
+  while (false)
+#else
+#define LLPC_OUTS(_msg)                                                                                                \
+  do {                                                                                                                 \
+  } while (false)
+#define LLPC_OUTS_LAZY(_callable)                                                                                      \
+  do {                                                                                                                 \
+  } while (false)
+#endif
 
 namespace llvm {
 class raw_ostream;
@@ -62,6 +100,34 @@ struct Hash;
 
 namespace Llpc {
 
+// =====================================================================================================================
+// Represents the builder of one log message. The message is accumulated in a buffer on the calling thread's stack
+// and handed to the shared output stream as a single write when the statement ends, so concurrent compile threads
+// neither serialize on the stream for each stream operand nor interleave partial messages.
+class DebugStream {
+public:
+  //
+  // @param flushOnEnd : Whether to flush the output stream after the message is written
+  explicit DebugStream(bool flushOnEnd = false) : m_flushOnEnd(flushOnEnd), m_stream(m_buffer) {}
+
+  ~DebugStream() {
+    llvm::outs() << m_stream.str();
+    if (m_flushOnEnd)
+      llvm::outs().flush();
+  }
+
+  // Gets the stream that the message is built into.
+  llvm::raw_ostream &stream() { return m_stream; }
+
+private:
+  DebugStream(const DebugStream &) = delete;
+  DebugStream &operator=(const DebugStream &) = delete;
+
+  bool m_flushOnEnd;                  // Whether to flush the output stream after the message is written
+  llvm::SmallString<512> m_buffer;    // Per-message buffer, written to the output stream in one go
+  llvm::raw_svector_ostream m_stream; // Stream wrapping the buffer
+};
+
 // Gets the value of option "enable-outs"
 bool EnableOuts();
 
@@ -32,7 +32,11 @@
 #include "llpcContext.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
+#include "llvm/Support/CommandLine.h"
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string.h>
 
 #define DEBUG_TYPE "llpc-elf-writer"
@@ -40,10 +44,31 @@
 using namespace llvm;
 using namespace Vkgc;
 
+// -elf-page-align-code: lay out the code and read-only data sections of written ELFs on page boundaries
+static cl::opt<bool> ElfPageAlignCode("elf-page-align-code",
+                                      cl::desc("Lay out the .text and .rodata sections of written pipeline ELFs on "
+                                               "4 KiB boundaries so their bytes can be mapped read-only straight "
+                                               "from an mmap'd shader cache file and shared between processes"),
+                                      cl::init(false));
+
 namespace Llpc {
 // The names of API shader stages used in PAL metadata, in ShaderStage order.
 static const char *const ApiStageNames[] = {".vertex", ".hull", ".domain", ".geometry", ".pixel", ".compute"};
 
+// File-offset alignment of written ELF sections when -elf-page-align-code places them on page boundaries
+static constexpr unsigned ElfPageAlignment = 4096;
+
+// =====================================================================================================================
+// Returns the file-offset alignment for the given section when it is written out: page alignment for the mappable
+// code and read-only data sections when -elf-page-align-code is on, the default word alignment otherwise.
+//
+// @param name : Name of the section
+static unsigned sectionOffsetAlignment(const char *name) {
+  if (ElfPageAlignCode && name && (strcmp(name, TextName) == 0 || strcmp(name, RoDataName) == 0))
+    return ElfPageAlignment;
+  return sizeof(unsigned);
+}
+
 // The names of hardware shader stages used in PAL metadata, in Util::Abi::HardwareStage order.
 static const char *const HwStageNames[] = {".ls", ".hs", ".es", ".gs", ".vs", ".ps", ".cs"};
 
@@ -58,9 +83,12 @@ ElfWriter<Elf>::ElfWriter(GfxIpVersion gfxIp)
 
 // =====================================================================================================================
 template <class Elf> ElfWriter<Elf>::~ElfWriter() {
-  for (auto &section : m_sections)
-    delete[] section.data;
+  for (size_t i = 0; i < m_sections.size(); ++i) {
+    if (m_sectionOwned[i])
+      delete[] m_sections[i].data;
+  }
   m_sections.clear();
+  m_sectionOwned.clear();
 
   for (auto &note : m_notes)
     delete[] note.data;
@@ -234,6 +262,14 @@ static void updateRootDescriptorRegisters(Context *context, msgpack::Document &d
   }
 }
 
+// =====================================================================================================================
+// Parsed PAL metadata note of the cached side of a merge, retained between merges. The strings in the document
+// reference the owned blob copy, so the two must stay together.
+struct ParsedMetaNote {
+  std::string blob;           // Copy of the note blob the document was parsed from
+  msgpack::Document document; // The parsed document
+};
+
 // =====================================================================================================================
 // Merges fragment shader related info for meta notes.
 //
@@ -244,15 +280,38 @@ static void updateRootDescriptorRegisters(Context *context, msgpack::Document &d
 template <class Elf>
 void ElfWriter<Elf>::mergeMetaNote(Context *pContext, const ElfNote *pNote1, const ElfNote *pNote2, ElfNote *pNewNote) {
   msgpack::Document destDocument;
-  msgpack::Document srcDocument;
 
   auto success =
       destDocument.readFromBlob(StringRef(reinterpret_cast<const char *>(pNote1->data), pNote1->hdr.descSize), false);
   assert(success);
 
-  success =
-      srcDocument.readFromBlob(StringRef(reinterpret_cast<const char *>(pNote2->data), pNote2->hdr.descSize), false);
-  assert(success);
+  // The fragment side usually comes from the shader cache, and the same cached shader is merged with many
+  // freshly built pre-raster halves, so its parsed document is kept in a small content-keyed cache instead of
+  // being reparsed per merge. The lock is held for the rest of the merge: reading a document with
+  // default-construction can mutate it, and the copied nodes reference the cached blob until writeToBlob.
+  static std::mutex parsedSrcNotesMutex;
+  static std::map<uint64_t, std::unique_ptr<ParsedMetaNote>> parsedSrcNotes;
+
+  StringRef srcBlob(reinterpret_cast<const char *>(pNote2->data), pNote2->hdr.descSize);
+  std::lock_guard<std::mutex> lock(parsedSrcNotesMutex);
+  auto parsedSrcIt = parsedSrcNotes.find(hash_value(srcBlob));
+  if (parsedSrcIt != parsedSrcNotes.end() && parsedSrcIt->second->blob != srcBlob) {
+    // Hash collision; replace the entry.
+    parsedSrcNotes.erase(parsedSrcIt);
+    parsedSrcIt = parsedSrcNotes.end();
+  }
+  if (parsedSrcIt == parsedSrcNotes.end()) {
+    // Titles cycle through a handful of cached shaders at a time, so simply start over when the cache grows
+    // beyond that.
+    if (parsedSrcNotes.size() >= 64)
+      parsedSrcNotes.clear();
+    auto parsedSrc = std::make_unique<ParsedMetaNote>();
+    parsedSrc->blob = srcBlob.str();
+    success = parsedSrc->document.readFromBlob(parsedSrc->blob, false);
+    assert(success);
+    parsedSrcIt = parsedSrcNotes.emplace(hash_value(srcBlob), std::move(parsedSrc)).first;
+  }
+  msgpack::Document &srcDocument = parsedSrcIt->second->document;
   (void(success)); // unused
 
   auto destPipeline =
@@ -417,22 +476,20 @@ template <class Elf> void ElfWriter<Elf>::setSection(unsigned secIndex, SectionB
   assert(pSection->name == m_sections[secIndex].name);
   assert(pSection->data != m_sections[secIndex].data);
 
-  delete[] m_sections[secIndex].data;
+  if (m_sectionOwned[secIndex])
+    delete[] m_sections[secIndex].data;
   m_sections[secIndex] = *pSection;
+  m_sectionOwned[secIndex] = true;
 }
 
 // =====================================================================================================================
 // Determines the size needed for a memory buffer to store this ELF.
 template <class Elf> size_t ElfWriter<Elf>::getRequiredBufferSizeBytes() {
-  // Update offsets and size values
+  // Update offsets and size values. The section header table is the last thing in the file, so its offset plus
+  // its size is the total layout size.
   calcSectionHeaderOffset();
 
-  size_t totalBytes = sizeof(typename Elf::FormatHeader);
-
-  // Iterate through the section list
-  for (auto &section : m_sections)
-    totalBytes += alignTo(section.secHead.sh_size, sizeof(unsigned));
-
+  size_t totalBytes = m_header.e_shoff;
   totalBytes += m_header.e_shentsize * m_header.e_shnum;
   totalBytes += m_header.e_phentsize * m_header.e_phnum;
 
@@ -452,12 +509,14 @@ template <class Elf> void ElfWriter<Elf>::assembleNotes() {
     noteSize += noteHeaderSize + noteNameSize + alignTo(note.hdr.descSize, sizeof(unsigned));
   }
 
-  delete[] noteSection->data;
+  if (m_sectionOwned[m_noteSecIdx])
+    delete[] noteSection->data;
   uint8_t *data = new uint8_t[std::max(noteSize, noteHeaderSize)];
   assert(data);
   memset(data, 0, std::max(noteSize, noteHeaderSize));
   noteSection->data = data;
   noteSection->secHead.sh_size = noteSize;
+  m_sectionOwned[m_noteSecIdx] = true;
 
   for (auto &note : m_notes) {
     memcpy(data, &note.hdr, noteHeaderSize);
@@ -491,10 +550,12 @@ template <class Elf> void ElfWriter<Elf>::assembleSymbols() {
     unsigned strTabOffset = strTabSection->secHead.sh_size;
     auto strTabBuffer = new uint8_t[strTabSection->secHead.sh_size + newStrTabSize];
     memcpy(strTabBuffer, strTabSection->data, strTabSection->secHead.sh_size);
-    delete[] strTabSection->data;
+    if (m_sectionOwned[m_strtabSecIdx])
+      delete[] strTabSection->data;
 
     strTabSection->data = strTabBuffer;
     strTabSection->secHead.sh_size += newStrTabSize;
+    m_sectionOwned[m_strtabSecIdx] = true;
 
     for (auto &symbol : m_symbols) {
       if (symbol.nameOffset == InvalidValue) {
@@ -511,9 +572,11 @@ template <class Elf> void ElfWriter<Elf>::assembleSymbols() {
   auto symSectionSize = sizeof(typename Elf::Symbol) * symbolCount;
   auto symbolSection = &m_sections[m_symSecIdx];
 
-  if (!symbolSection->data)
+  // The symbol entries are written in place, so the section must be writer-owned and large enough.
+  if (!symbolSection->data || !m_sectionOwned[m_symSecIdx]) {
     symbolSection->data = new uint8_t[symSectionSize];
-  else if (symSectionSize > symbolSection->secHead.sh_size) {
+    m_sectionOwned[m_symSecIdx] = true;
+  } else if (symSectionSize > symbolSection->secHead.sh_size) {
     delete[] symbolSection->data;
     symbolSection->data = new uint8_t[symSectionSize];
   }
@@ -549,34 +612,41 @@ template <class Elf> void ElfWriter<Elf>::calcSectionHeaderOffset() {
   sharedHdrOffset += m_header.e_phnum * hdrSize;
 
   for (auto &section : m_sections) {
-    const unsigned secSzBytes = alignTo(section.secHead.sh_size, sizeof(unsigned));
-    sharedHdrOffset += secSzBytes;
+    sharedHdrOffset = alignTo(sharedHdrOffset, sectionOffsetAlignment(section.name));
+    sharedHdrOffset += section.secHead.sh_size;
   }
 
   m_header.e_phoff = m_header.e_phnum > 0 ? elfHdrSize : 0;
-  m_header.e_shoff = sharedHdrOffset;
+  m_header.e_shoff = alignTo(sharedHdrOffset, unsigned(sizeof(unsigned)));
   m_header.e_shstrndx = m_strtabSecIdx;
   m_header.e_shnum = m_sections.size();
 }
 
 // =====================================================================================================================
-// Writes the data out to the given buffer in ELF format. Assumes the buffer has been pre-allocated with adequate
-// space, which can be determined with a call to "GetRequireBufferSizeBytes()".
-//
-// @param pElf : Output buffer to write ELF data
-template <class Elf> void ElfWriter<Elf>::writeToBuffer(ElfPackage *pElf) {
-  assert(pElf);
-
-  // Update offsets and size values
+// Finalizes the ELF layout: assembles notes and symbols and computes the section offsets. Returns the exact number
+// of bytes a subsequent writeToMemory call emits, so a caller that owns the destination memory (for example a
+// driver output allocation) can size it up front and receive the ELF without an intermediate copy.
+template <class Elf> size_t ElfWriter<Elf>::finalize() {
   assembleNotes();
   assembleSymbols();
+  return getRequiredBufferSizeBytes();
+}
 
+// =====================================================================================================================
+// Writes the finalized ELF directly into the given caller-owned memory, which must be at least the size returned
+// by finalize() and must not back any of this writer's unowned sections (use writeToBuffer when the destination
+// may alias the input ELF, as in updateElfBinary).
+//
+// @param [out] dest : Destination memory
+// @param size : Size of the destination in bytes, as returned by finalize()
+template <class Elf> void ElfWriter<Elf>::writeToMemory(void *dest, size_t size) {
   const size_t reqSize = getRequiredBufferSizeBytes();
-  pElf->resize(reqSize);
-  auto data = pElf->data();
+  assert(size >= reqSize);
+  (void(size)); // unused
+  auto data = static_cast<char *>(dest);
   memset(data, 0, reqSize);
 
-  char *buffer = static_cast<char *>(data);
+  char *buffer = data;
 
   // ELF header comes first
   const unsigned elfHdrSize = sizeof(typename Elf::FormatHeader);
@@ -585,14 +655,19 @@ template <class Elf> void ElfWriter<Elf>::writeToBuffer(ElfPackage *pElf) {
 
   assert(m_header.e_phnum == 0);
 
-  // Write each section buffer
+  // Write each section buffer. The gaps alignment opens up were zeroed with the whole staging buffer above.
   for (auto &section : m_sections) {
+    const unsigned alignment = sectionOffsetAlignment(section.name);
+    buffer = data + alignTo(static_cast<unsigned>(buffer - data), alignment);
     section.secHead.sh_offset = static_cast<unsigned>(buffer - data);
+    if (alignment > section.secHead.sh_addralign)
+      section.secHead.sh_addralign = alignment;
     const unsigned sizeBytes = section.secHead.sh_size;
     if (sizeBytes > 0)
       memcpy(buffer, section.data, sizeBytes);
-    buffer += alignTo(sizeBytes, sizeof(unsigned));
+    buffer += sizeBytes;
   }
+  buffer = data + alignTo(static_cast<unsigned>(buffer - data), unsigned(sizeof(unsigned)));
 
   const unsigned secHdrSize = sizeof(typename Elf::SectionHeader);
   for (auto &section : m_sections) {
@@ -600,25 +675,44 @@ template <class Elf> void ElfWriter<Elf>::writeToBuffer(ElfPackage *pElf) {
     buffer += secHdrSize;
   }
 
-  assert((buffer - data) == reqSize);
+  assert(size_t(buffer - data) == reqSize);
 }
 
 // =====================================================================================================================
-// Copies ELF content from a ElfReader.
+// Writes the data out to the given buffer in ELF format, sizing it as needed.
+//
+// @param pElf : Output buffer to write ELF data
+template <class Elf> void ElfWriter<Elf>::writeToBuffer(ElfPackage *pElf) {
+  assert(pElf);
+
+  const size_t reqSize = finalize();
+
+  // Materialize into a staging buffer rather than directly into *pElf: unowned sections reference the input ELF
+  // in place, and that input may be the very buffer we are asked to write to (see updateElfBinary).
+  ElfPackage staging;
+  staging.resize(reqSize);
+  writeToMemory(staging.data(), reqSize);
+
+  *pElf = std::move(staging);
+}
+
+// =====================================================================================================================
+// Takes over ELF content from a ElfReader.
+//
+// The section data is referenced in place rather than copied; the reader's underlying buffer must stay alive for as
+// long as the writer reads section data. Sections the writer later rebuilds get fresh writer-owned allocations.
 //
 // @param reader : The ElfReader to copy from.
 template <class Elf> Result ElfWriter<Elf>::copyFromReader(const ElfReader<Elf> &reader) {
   Result result = Result::Success;
   m_header = reader.getHeader();
   m_sections.resize(reader.getSections().size());
+  m_sectionOwned.assign(reader.getSections().size(), false);
   for (size_t i = 0; i < reader.getSections().size(); ++i) {
     auto section = reader.getSections()[i];
     m_sections[i].secHead = section->secHead;
     m_sections[i].name = section->name;
-    auto data = new uint8_t[section->secHead.sh_size + 1];
-    memcpy(data, section->data, section->secHead.sh_size);
-    data[section->secHead.sh_size] = 0;
-    m_sections[i].data = data;
+    m_sections[i].data = section->data;
   }
 
   m_map = reader.getMap();
@@ -787,6 +881,49 @@ template <class Elf> void ElfWriter<Elf>::updateElfBinary(Context *pContext, Elf
   writeToBuffer(pPipelineElf);
 }
 
+// =====================================================================================================================
+// Retarget a cached pipeline ELF to a different pipeline state by overriding register values in the PAL metadata.
+//
+// Only the .note section is rewritten; the ISA and all other sections are passed through unchanged. This lets a
+// cached ELF be reused for a pipeline that differs only in state expressed through context registers (for example
+// color export formats or depth clamp controls), without recompiling.
+//
+// @param pContext : Pipeline context
+// @param registerOverrides : Registers to override, as register number/value pairs
+// @param [out] pPipelineElf : Final ELF binary
+template <class Elf>
+void ElfWriter<Elf>::retargetElfBinary(Context *pContext, ArrayRef<PalRegisterOverride> registerOverrides,
+                                       ElfPackage *pPipelineElf) {
+  ElfNote metaNote = getNote(Util::Abi::PipelineAbiNoteType::PalMetadata);
+  assert(metaNote.data);
+
+  msgpack::Document document;
+  auto success =
+      document.readFromBlob(StringRef(reinterpret_cast<const char *>(metaNote.data), metaNote.hdr.descSize), false);
+  assert(success);
+  (void(success)); // unused
+
+  auto pipeline = document.getRoot().getMap(true)[Util::Abi::PalCodeObjectMetadataKey::Pipelines].getArray(true)[0];
+  auto registers = pipeline.getMap(true)[Util::Abi::PipelineMetadataKey::Registers].getMap(true);
+  for (const PalRegisterOverride &registerOverride : registerOverrides)
+    registers[document.getNode(registerOverride.regNumber)] = document.getNode(registerOverride.value);
+
+  // A cached ELF may still carry unresolved descriptor user data values; resolve them against the resource
+  // mapping of the pipeline we are retargeting to.
+  updateRootDescriptorRegisters(pContext, document);
+
+  std::string blob;
+  document.writeToBlob(blob);
+  ElfNote newMetaNote = metaNote;
+  auto data = new uint8_t[blob.size()];
+  memcpy(data, blob.data(), blob.size());
+  newMetaNote.hdr.descSize = blob.size();
+  newMetaNote.data = data;
+  setNote(&newMetaNote);
+
+  writeToBuffer(pPipelineElf);
+}
+
 // =====================================================================================================================
 // Merge ELF binary of fragment shader and ELF binary of non-fragment shaders into single ELF binary
 //
@@ -892,8 +1029,8 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
   if (nonFragmentDisassemblySection) {
     assert(fragmentDisassemblySection);
     // NOTE: We have to replace last character with null terminator and restore it afterwards. Otherwise, the
-    // text search will be incorrect. It is only needed for ElfReader, ElfWriter always append a null terminator
-    // for all section data.
+    // text search will be incorrect. Both readers and the writer reference the section data of the input ELF
+    // in place, so neither side is guaranteed to be null-terminated.
     auto fragmentDisassemblySectionEnd =
         fragmentDisassemblySection->data + fragmentDisassemblySection->secHead.sh_size - 1;
     uint8_t lastChar = *fragmentDisassemblySectionEnd;
@@ -906,8 +1043,13 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
         !fragmentDisassembly ? 0
                              : (fragmentDisassembly - reinterpret_cast<const char *>(fragmentDisassemblySection->data));
 
+    auto nonFragmentDisassemblySectionEnd =
+        nonFragmentDisassemblySection->data + nonFragmentDisassemblySection->secHead.sh_size - 1;
+    lastChar = *nonFragmentDisassemblySectionEnd;
+    const_cast<uint8_t *>(nonFragmentDisassemblySectionEnd)[0] = '\0';
     auto disassemblyEnd =
         strstr(reinterpret_cast<const char *>(nonFragmentDisassemblySection->data), fragmentIsaSymbolName);
+    const_cast<uint8_t *>(nonFragmentDisassemblySectionEnd)[0] = lastChar;
     auto disassemblySize = !disassemblyEnd
                                ? nonFragmentDisassemblySection->secHead.sh_size
                                : disassemblyEnd - reinterpret_cast<const char *>(nonFragmentDisassemblySection->data);
@@ -932,8 +1074,8 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
     assert(fragmentLlvmIrSection);
 
     // NOTE: We have to replace last character with null terminator and restore it afterwards. Otherwise, the
-    // text search will be incorrect. It is only needed for ElfReader, ElfWriter always append a null terminator
-    // for all section data.
+    // text search will be incorrect. Both readers and the writer reference the section data of the input ELF
+    // in place, so neither side is guaranteed to be null-terminated.
     auto fragmentLlvmIrSectionEnd = fragmentLlvmIrSection->data + fragmentLlvmIrSection->secHead.sh_size - 1;
     uint8_t lastChar = *fragmentLlvmIrSectionEnd;
     const_cast<uint8_t *>(fragmentLlvmIrSectionEnd)[0] = '\0';
@@ -944,7 +1086,11 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
     auto fragmentLlvmIrOffset =
         !fragmentLlvmIrStart ? 0 : (fragmentLlvmIrStart - reinterpret_cast<const char *>(fragmentLlvmIrSection->data));
 
+    auto nonFragmentLlvmIrSectionEnd = nonFragmentLlvmIrSection->data + nonFragmentLlvmIrSection->secHead.sh_size - 1;
+    lastChar = *nonFragmentLlvmIrSectionEnd;
+    const_cast<uint8_t *>(nonFragmentLlvmIrSectionEnd)[0] = '\0';
     auto llvmIrEnd = strstr(reinterpret_cast<const char *>(nonFragmentLlvmIrSection->data), fragmentIsaSymbolName);
+    const_cast<uint8_t *>(nonFragmentLlvmIrSectionEnd)[0] = lastChar;
     auto llvmIrSize = !llvmIrEnd ? nonFragmentLlvmIrSection->secHead.sh_size
                                  : llvmIrEnd - reinterpret_cast<const char *>(nonFragmentLlvmIrSection->data);
 
@@ -965,7 +1111,11 @@ void ElfWriter<Elf>::mergeElfBinary(Context *pContext, const BinaryData *pFragme
   mergeMetaNote(pContext, &nonFragmentMetaNote, &fragmentMetaNote, &newMetaNote);
   setNote(&newMetaNote);
 
-  writeToBuffer(pPipelineElf);
+  // The output package never backs any of this writer's sections (they reference the two input ELFs in place),
+  // so emit straight into it without the staging buffer writeToBuffer needs for the in-place update case.
+  const size_t reqSize = finalize();
+  pPipelineElf->resize(reqSize);
+  writeToMemory(pPipelineElf->data(), reqSize);
 }
 
 // =====================================================================================================================
@@ -992,6 +1142,8 @@ template <class Elf> void ElfWriter<Elf>::reinitialize() {
   m_noteSecIdx = m_sections.size();
   m_sections.push_back({});
   m_map[NoteName] = m_noteSecIdx;
+
+  m_sectionOwned.assign(m_sections.size(), true);
 }
 
 template class ElfWriter<Elf64>;
@@ -31,6 +31,7 @@
 #pragma once
 
 #include "vkgcElfReader.h"
+#include "llvm/ADT/ArrayRef.h"
 
 // Forward declaration
 namespace llvm {
@@ -54,10 +55,23 @@ using Vkgc::Result;
 // Forward declaration
 class Context;
 
+// =====================================================================================================================
+// Represents one register override applied by ElfWriter::retargetElfBinary
+struct PalRegisterOverride {
+  unsigned regNumber; // Register number, as used as a key in the PAL metadata registers map
+  unsigned value;     // New register value
+};
+
 // =====================================================================================================================
 // Represents a writer for storing data to an ELF buffer.
 //
 // NOTE: It is a limited implementation, it is designed for merging two ELF binaries which generated by LLVM back-end.
+//
+// Section contents are gathered rather than staged: copyFromReader() references the input ELF's section data in
+// place, and the bytes are only materialized once, when writeToBuffer() lays out the final ELF. Only sections that
+// the writer itself rebuilds (merged text/disassembly, notes, symbol and string tables) get their own allocations;
+// m_sectionOwned records which entries the writer must free. The input buffer therefore has to outlive the writer,
+// or at least any call that reads section data (which all existing clients already guarantee).
 template <class Elf> class ElfWriter {
 public:
   typedef ElfSectionBuffer<typename Elf::SectionHeader> SectionBuffer;
@@ -79,6 +93,9 @@ public:
 
   void updateElfBinary(Context *context, ElfPackage *pipelineElf);
 
+  void retargetElfBinary(Context *context, llvm::ArrayRef<PalRegisterOverride> registerOverrides,
+                         ElfPackage *pipelineElf);
+
   void mergeElfBinary(Context *context, const BinaryData *fragmentElf, ElfPackage *pipelineElf);
 
   // Gets the section index for the specified section name.
@@ -103,6 +120,10 @@ public:
 
   void writeToBuffer(ElfPackage *elf);
 
+  size_t finalize();
+
+  void writeToMemory(void *dest, size_t size);
+
 private:
   ElfWriter(const ElfWriter &) = delete;
   ElfWriter &operator=(const ElfWriter &) = delete;
@@ -124,6 +145,8 @@ private:
   std::map<std::string, unsigned> m_map; // Map between section name and section index
 
   std::vector<SectionBuffer> m_sections; // List of section data and headers
+  std::vector<bool> m_sectionOwned;      // Whether the corresponding section's data is owned by the writer
+                                         //  (false means it references the input ELF buffer in place)
   std::vector<ElfNote> m_notes;          // List of Elf notes
   std::vector<ElfSymbol> m_symbols;      // List of Elf symbols
 
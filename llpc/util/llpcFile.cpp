@@ -32,6 +32,12 @@
 #include <cassert>
 #include <stdarg.h>
 #include <sys/stat.h>
+#ifndef WIN_OS
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
 
 #define DEBUG_TYPE "llpc-file"
 
@@ -310,6 +316,77 @@ size_t File::getFileSize(const char *filename) {
   return result == 0 ? fileStatus.st_size : 0;
 }
 
+// =====================================================================================================================
+// Truncates the file to the given size. Buffered writes are flushed first so nothing gets cut off in the wrong
+// order. The file position is left unspecified; callers must seek before the next access.
+//
+// @param size : New size of the file in bytes
+Result File::truncate(size_t size) {
+  if (!m_fileHandle)
+    return Result::ErrorUnavailable;
+
+  fflush(m_fileHandle);
+#ifndef WIN_OS
+  if (ftruncate(fileno(m_fileHandle), size) != 0)
+    return Result::ErrorUnknown;
+#else
+  if (_chsize_s(_fileno(m_fileHandle), size) != 0)
+    return Result::ErrorUnknown;
+#endif
+  return Result::Success;
+}
+
+// =====================================================================================================================
+// Advises the OS that the given number of bytes is about to be read sequentially from the start of the file, so it
+// can read the data ahead. A no-op where the platform offers no such hint.
+//
+// @param readSize : Number of bytes about to be read
+void File::adviseSequentialRead(size_t readSize) const {
+#ifndef WIN_OS
+  if (m_fileHandle)
+    posix_fadvise(fileno(m_fileHandle), 0, readSize, POSIX_FADV_SEQUENTIAL);
+#else
+  (void(readSize)); // unused
+#endif
+}
+
+// =====================================================================================================================
+// Reads an entire file into one allocation sized up front from the file's metadata, avoiding reallocation churn and
+// repeated small reads. On POSIX systems the kernel is advised of the sequential read ahead of time. On success the
+// caller owns the returned buffer and frees it with delete[].
+//
+// @param filename : Name of the file to read
+// @param [out] data : Buffer holding the entire file contents, allocated by this function
+// @param [out] dataSize : Size of the file contents in bytes, excluding the terminator if one was requested
+// @param nullTerminate : Whether to append a null terminator to the buffer
+Result File::readAll(const char *filename, char **data, size_t *dataSize, bool nullTerminate) {
+  const size_t fileSize = getFileSize(filename);
+
+  File file;
+  Result result = file.open(filename, FileAccessRead | FileAccessBinary);
+  if (result != Result::Success)
+    return result;
+
+  file.adviseSequentialRead(fileSize);
+
+  char *buffer = new char[fileSize + (nullTerminate ? 1 : 0)];
+  assert(buffer);
+
+  size_t bytesRead = 0;
+  if (fileSize > 0)
+    result = file.read(buffer, fileSize, &bytesRead);
+
+  if (result == Result::Success) {
+    if (nullTerminate)
+      buffer[bytesRead] = '\0';
+    *data = buffer;
+    *dataSize = bytesRead;
+  } else
+    delete[] buffer;
+
+  return result;
+}
+
 // =====================================================================================================================
 // Returns true if a file with the given name exists.
 //
@@ -56,6 +56,7 @@ public:
 
   static size_t getFileSize(const char *filename);
   static bool exists(const char *filename);
+  static Result readAll(const char *filename, char **data, size_t *dataSize, bool nullTerminate = false);
 
   Result open(const char *filename, unsigned accessFlags);
   void close();
@@ -67,6 +68,8 @@ public:
   Result flush() const;
   void rewind();
   void seek(int offset, bool fromOrigin);
+  void adviseSequentialRead(size_t readSize) const;
+  Result truncate(size_t size);
 
   // Returns true if the file is presently open.
   bool isOpen() const { return (m_fileHandle); }
@@ -47,11 +47,13 @@ namespace Llpc {
 // @param spvBinCode : SPIR-V binary data
 // @param [out] shaderModuleUsage : Shader module usage info
 // @param [out] shaderEntryNames : Entry names for this shader module
-// @param debugInfoSize : Debug info size
+// @param [out] debugInfoSize : Total size of debug instructions, in bytes
+// @param [out] debugInfoRanges : Word ranges occupied by debug instructions, for trimSpirvDebugInfo() (could be null)
 Result ShaderModuleHelper::collectInfoFromSpirvBinary(const BinaryData *spvBinCode,
                                                       ShaderModuleUsage *shaderModuleUsage,
                                                       std::vector<ShaderEntryName> &shaderEntryNames,
-                                                      unsigned *debugInfoSize) {
+                                                      unsigned *debugInfoSize,
+                                                      std::vector<SpirvWordRange> *debugInfoRanges) {
   Result result = Result::Success;
 
   const unsigned *code = reinterpret_cast<const unsigned *>(spvBinCode->pCode);
@@ -62,6 +64,12 @@ Result ShaderModuleHelper::collectInfoFromSpirvBinary(const BinaryData *spvBinCo
   // Parse SPIR-V instructions
   std::unordered_set<unsigned> capabilities;
 
+  // Result IDs of scalar specialization constants, and whether all specialization constants in the module are
+  // scalars used only as plain values. Such constants can have their values substituted after translation, so
+  // one translation can serve all specializations of the module.
+  std::unordered_set<unsigned> scalarSpecConstIds;
+  bool specConstantsFoldable = true;
+
   while (codePos < end) {
     unsigned opCode = (codePos[0] & OpCodeMask);
     unsigned wordCount = (codePos[0] >> WordCountShift);
@@ -107,20 +115,84 @@ Result ShaderModuleHelper::collectInfoFromSpirvBinary(const BinaryData *spvBinCo
     case OpNoLine:
     case OpModuleProcessed: {
       *debugInfoSize += wordCount * sizeof(unsigned);
+      if (debugInfoRanges) {
+        // Record where the debug instructions are, merging adjacent ones into one range, so trimming can copy the
+        // kept spans in bulk without decoding the word stream again.
+        const unsigned offset = static_cast<unsigned>(codePos - code);
+        if (!debugInfoRanges->empty() && debugInfoRanges->back().offset + debugInfoRanges->back().count == offset)
+          debugInfoRanges->back().count += wordCount;
+        else
+          debugInfoRanges->push_back({offset, wordCount});
+      }
       break;
     }
     case OpSpecConstantTrue:
     case OpSpecConstantFalse:
-    case OpSpecConstant:
+    case OpSpecConstant: {
+      shaderModuleUsage->useSpecConstant = true;
+      scalarSpecConstIds.insert(codePos[2]);
+      break;
+    }
     case OpSpecConstantComposite:
     case OpSpecConstantOp: {
+      // Composites and constant expressions are folded during translation, so their operands cannot be
+      // substituted afterwards.
       shaderModuleUsage->useSpecConstant = true;
+      specConstantsFoldable = false;
+      break;
+    }
+    case OpConstantComposite: {
+      for (unsigned i = 3; i < wordCount; ++i) {
+        if (scalarSpecConstIds.count(codePos[i]) > 0)
+          specConstantsFoldable = false;
+      }
+      break;
+    }
+    case OpTypeArray: {
+      // A specialization constant used as an array length shapes types during translation.
+      if (scalarSpecConstIds.count(codePos[3]) > 0)
+        specConstantsFoldable = false;
+      break;
+    }
+    case OpVariable: {
+      // A specialization constant used as a variable initializer is folded during translation.
+      if (wordCount > 4 && scalarSpecConstIds.count(codePos[4]) > 0)
+        specConstantsFoldable = false;
       break;
     }
     case OpIsNan: {
       shaderModuleUsage->useIsNan = true;
       break;
     }
+    case OpTypeFloat: {
+      if (codePos[2] == 16)
+        shaderModuleUsage->useFp16 = true;
+      else if (codePos[2] == 64)
+        shaderModuleUsage->useFp64 = true;
+      break;
+    }
+    case OpFNegate:
+    case OpFAdd:
+    case OpFSub:
+    case OpFMul:
+    case OpFDiv:
+    case OpFRem:
+    case OpFMod:
+    case OpVectorTimesScalar:
+    case OpMatrixTimesScalar:
+    case OpVectorTimesMatrix:
+    case OpMatrixTimesVector:
+    case OpMatrixTimesMatrix:
+    case OpOuterProduct:
+    case OpDot:
+    case OpFConvert:
+    case OpQuantizeToF16:
+    case OpExtInst: {
+      // NOTE: OpExtInst is included because GLSL.std.450 instructions (fma, fabs etc.) expand to floating-point
+      // arithmetic during translation.
+      shaderModuleUsage->useFpArith = true;
+      break;
+    }
     case OpEntryPoint: {
       ShaderEntryName entry = {};
       // The fourth word is start of the name string of the entry-point
@@ -136,6 +208,9 @@ Result ShaderModuleHelper::collectInfoFromSpirvBinary(const BinaryData *spvBinCo
     codePos += wordCount;
   }
 
+  shaderModuleUsage->specConstantsFoldable =
+      shaderModuleUsage->useSpecConstant && !scalarSpecConstIds.empty() && specConstantsFoldable;
+
   if (capabilities.find(CapabilityVariablePointersStorageBuffer) != capabilities.end())
     shaderModuleUsage->enableVarPtrStorageBuf = true;
 
@@ -148,54 +223,41 @@ Result ShaderModuleHelper::collectInfoFromSpirvBinary(const BinaryData *spvBinCo
 // =====================================================================================================================
 // Removes all debug instructions for SPIR-V binary.
 //
+// The debug instructions were already located by collectInfoFromSpirvBinary(), so this is a bulk copy of the spans
+// between the recorded ranges (including the header) rather than a second instruction-by-instruction walk.
+//
 // @param spvBin : SPIR-V binay code
+// @param debugInfoRanges : Word ranges occupied by debug instructions, from collectInfoFromSpirvBinary()
 // @param bufferSize : Output buffer size in bytes
 // @param [out] trimSpvBin : Trimmed SPIR-V binary code
-void ShaderModuleHelper::trimSpirvDebugInfo(const BinaryData *spvBin, unsigned bufferSize, void *trimSpvBin) {
+void ShaderModuleHelper::trimSpirvDebugInfo(const BinaryData *spvBin,
+                                            const std::vector<SpirvWordRange> &debugInfoRanges, unsigned bufferSize,
+                                            void *trimSpvBin) {
   assert(bufferSize > sizeof(SpirvHeader));
 
   const unsigned *code = reinterpret_cast<const unsigned *>(spvBin->pCode);
-  const unsigned *end = code + spvBin->codeSize / sizeof(unsigned);
-  const unsigned *codePos = code + sizeof(SpirvHeader) / sizeof(unsigned);
+  const unsigned totalWords = static_cast<unsigned>(spvBin->codeSize / sizeof(unsigned));
 
+  unsigned *trimCodePos = reinterpret_cast<unsigned *>(trimSpvBin);
   unsigned *trimEnd = reinterpret_cast<unsigned *>(voidPtrInc(trimSpvBin, bufferSize));
   (void(trimEnd)); // unused
-  unsigned *trimCodePos = reinterpret_cast<unsigned *>(voidPtrInc(trimSpvBin, sizeof(SpirvHeader)));
-
-  // Copy SPIR-V header
-  memcpy(trimSpvBin, code, sizeof(SpirvHeader));
-
-  // Copy SPIR-V instructions
-  while (codePos < end) {
-    unsigned opCode = (codePos[0] & OpCodeMask);
-    unsigned wordCount = (codePos[0] >> WordCountShift);
-    switch (opCode) {
-    case OpString:
-    case OpSource:
-    case OpSourceContinued:
-    case OpSourceExtension:
-    case OpName:
-    case OpMemberName:
-    case OpLine:
-    case OpNop:
-    case OpNoLine:
-    case OpModuleProcessed: {
-      // Skip debug instructions
-      break;
-    }
-    default: {
-      // Copy other instructions
-      assert(codePos + wordCount <= end);
-      assert(trimCodePos + wordCount <= trimEnd);
-      memcpy(trimCodePos, codePos, wordCount * sizeof(unsigned));
-      trimCodePos += wordCount;
-      break;
-    }
-    }
 
-    codePos += wordCount;
+  unsigned keptStart = 0;
+  for (const SpirvWordRange &range : debugInfoRanges) {
+    assert(range.offset >= keptStart && range.offset + range.count <= totalWords);
+    const unsigned keptWords = range.offset - keptStart;
+    assert(trimCodePos + keptWords <= trimEnd);
+    memcpy(trimCodePos, code + keptStart, keptWords * sizeof(unsigned));
+    trimCodePos += keptWords;
+    keptStart = range.offset + range.count;
   }
 
+  // Copy the tail of the binary after the last debug instruction
+  const unsigned tailWords = totalWords - keptStart;
+  assert(trimCodePos + tailWords <= trimEnd);
+  memcpy(trimCodePos, code + keptStart, tailWords * sizeof(unsigned));
+  trimCodePos += tailWords;
+
   assert(trimCodePos == trimEnd);
 }
 
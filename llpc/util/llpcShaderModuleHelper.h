@@ -58,14 +58,23 @@ struct ShaderEntryName {
   const char *name;  // Entry name
 };
 
+// Represents a contiguous range of words in a SPIR-V binary. Carries the location of debug instructions from
+// collectInfoFromSpirvBinary() to trimSpirvDebugInfo(), so trimming does not decode the word stream a second time.
+struct SpirvWordRange {
+  unsigned offset; // Start of the range, in words from the beginning of the binary
+  unsigned count;  // Size of the range, in words
+};
+
 // =====================================================================================================================
 // Represents LLPC shader module helper class
 class ShaderModuleHelper {
 public:
   static Result collectInfoFromSpirvBinary(const BinaryData *spvBinCode, ShaderModuleUsage *shaderModuleUsage,
-                                           std::vector<ShaderEntryName> &shaderEntryNames, unsigned *debugInfoSize);
+                                           std::vector<ShaderEntryName> &shaderEntryNames, unsigned *debugInfoSize,
+                                           std::vector<SpirvWordRange> *debugInfoRanges);
 
-  static void trimSpirvDebugInfo(const BinaryData *spvBin, unsigned bufferSize, void *trimSpvBin);
+  static void trimSpirvDebugInfo(const BinaryData *spvBin, const std::vector<SpirvWordRange> &debugInfoRanges,
+                                 unsigned bufferSize, void *trimSpvBin);
 
   static Result optimizeSpirv(const BinaryData *spirvBinIn, BinaryData *spirvBinOut);
 
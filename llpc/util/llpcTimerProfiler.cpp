@@ -36,8 +36,15 @@
 #include "llvm/ADT/Twine.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <chrono>
+
+#define DEBUG_TYPE "llpc-timer-profiler"
 
 using namespace llvm;
 
@@ -48,19 +55,343 @@ namespace cl {
 // -enable-time-profile : profile the compile time of pipeline
 opt<bool> EnableTimerProfile("enable-timer-profile", desc("profile the compile time of pipeline"), init(false));
 
+// -timer-profile-file : file to dump per-compilation phase times to
+opt<std::string> TimerProfileFile("timer-profile-file",
+                                  desc("Dump per-compilation phase times to the given file at shutdown, one "
+                                       "record per compilation hash (JSON lines, or CSV if the file name ends "
+                                       "in .csv)"),
+                                  init(""));
+
+// -chrome-trace-file : file to dump a Chrome trace of compilation activity to
+opt<std::string> ChromeTraceFile("chrome-trace-file",
+                                 desc("Record spans of compilation activity (phases, context acquisition, "
+                                      "cache lookups and file I/O) to a ring buffer and write them to the "
+                                      "given file at shutdown as a Chrome trace (chrome://tracing, Perfetto)"),
+                                 init(""));
+
 } // namespace cl
 
 } // namespace llvm
 
 namespace Llpc {
 
+// Phase names used in the -timer-profile-file output, indexed by TimerKind
+static const char *const PhaseNames[TimerCount] = {"translate", "lower", "loadBc", "patch", "opt", "codeGen"};
+
+namespace {
+
+// =====================================================================================================================
+// Phase-time record for one compilation, collected for the -timer-profile-file output
+struct ProfileRecord {
+  ProfileRecord *next;             // Next record on the global list
+  uint64_t hash64;                 // Hash of the compilation
+  const char *description;         // Description prefix, e.g. "LLPC ShaderModule"
+  uint64_t totalNanos;             // Total compilation time
+  uint64_t phaseNanos[TimerCount]; // Accumulated time of each phase
+  uint64_t peakBytes;              // Largest allocation footprint sampled during the compilation
+  uint64_t phasePeakBytes[TimerCount]; // Largest allocation footprint sampled during each phase
+};
+
+// =====================================================================================================================
+// Pass to start or stop a phase's monotonic counter. This mirrors the lgc start/stop timer pass, but feeds the
+// TimerProfiler's counters instead of an LLVM Timer, so the hot path takes no global timer locks.
+class StartStopPhaseTimer : public ModulePass {
+public:
+  static char ID;
+  StartStopPhaseTimer() : ModulePass(ID) {}
+  StartStopPhaseTimer(TimerProfiler *profiler, TimerKind timerKind, bool starting)
+      : ModulePass(ID), m_profiler(profiler), m_timerKind(timerKind), m_starting(starting) {}
+
+  bool runOnModule(Module &module) override {
+    m_profiler->startStopPhase(m_timerKind, m_starting);
+    return false;
+  }
+
+private:
+  StartStopPhaseTimer(const StartStopPhaseTimer &) = delete;
+  StartStopPhaseTimer &operator=(const StartStopPhaseTimer &) = delete;
+
+  TimerProfiler *m_profiler; // The profiler whose phase counter to start or stop
+  TimerKind m_timerKind;     // Kind of phase timer
+  bool m_starting;           // True to start the counter, false to stop it
+};
+
+char StartStopPhaseTimer::ID = 0;
+
+} // namespace
+
+// Head of the lock-free global list of profile records
+static std::atomic<ProfileRecord *> ProfileRecordList(nullptr);
+
+// Count of power-of-two duration buckets in the session summary histograms; bucket i counts compilations whose
+// duration is in [2^i, 2^(i+1)) microseconds, with the last bucket collecting everything longer
+static const unsigned HistogramBucketCount = 24;
+
+namespace {
+
+// =====================================================================================================================
+// Session-wide aggregate of one phase, or of whole compilations, across all profile records
+struct PhaseSummary {
+  uint64_t count = 0;                            // Number of compilations the phase ran in
+  uint64_t totalNanos = 0;                       // Summed time across those compilations
+  uint64_t histogram[HistogramBucketCount] = {}; // Compilation count per power-of-two duration bucket
+};
+
+} // namespace
+
+// =====================================================================================================================
+// Accumulates one duration into a phase summary. Phases that did not run in a compilation are not counted.
+//
+// @param [in/out] summary : Summary to accumulate into
+// @param nanos : Duration of the phase in one compilation
+static void accumulatePhase(PhaseSummary &summary, uint64_t nanos) {
+  if (nanos == 0)
+    return;
+  ++summary.count;
+  summary.totalNanos += nanos;
+  const uint64_t micros = nanos / 1000;
+  unsigned bucket = 0;
+  while (bucket + 1 < HistogramBucketCount && (micros >> (bucket + 1)) != 0)
+    ++bucket;
+  ++summary.histogram[bucket];
+}
+
+// =====================================================================================================================
+// Writes one phase summary as a JSON object.
+//
+// @param [in/out] stream : Stream to write to
+// @param summary : Summary to write
+static void writePhaseSummary(raw_ostream &stream, const PhaseSummary &summary) {
+  stream << "{\"count\":" << summary.count << ",\"total\":" << format("%.6f", summary.totalNanos * 1e-9)
+         << ",\"histogramUs\":[";
+  for (unsigned i = 0; i != HistogramBucketCount; ++i)
+    stream << (i == 0 ? "" : ",") << summary.histogram[i];
+  stream << "]}";
+}
+
+// =====================================================================================================================
+// Gets the current monotonic time in nanoseconds.
+static uint64_t getMonotonicNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+namespace {
+
+// =====================================================================================================================
+// One completed span in the -chrome-trace-file compile trace
+struct TraceEvent {
+  const char *name;       // Name of the span
+  uint64_t hash64;        // Hash of the compilation the span belongs to, or 0
+  uint64_t startNanos;    // Monotonic time when the span was opened
+  uint64_t durationNanos; // Duration of the span
+  uint64_t threadId;      // Thread the span ran on
+};
+
+} // namespace
+
+// Number of events the compile trace ring buffer holds. Power of two so the ring index is a mask. When a build
+// storm records more, the oldest events are overwritten; an overwrite racing a reader only ever affects events
+// that were about to be dropped anyway, which is acceptable for a diagnostic trace.
+static const unsigned TraceRingSize = 1 << 16;
+
+// Next slot of the compile trace ring buffer; monotonically increasing, so it also counts recorded events
+static std::atomic<uint64_t> TraceRingNext(0);
+
+// =====================================================================================================================
+// Returns the compile trace ring buffer, allocated on first use so runs that never trace pay nothing.
+static TraceEvent *getTraceRing() {
+  static std::vector<TraceEvent> TraceRing(TraceRingSize);
+  return TraceRing.data();
+}
+
+// =====================================================================================================================
+// Writes the recorded compile trace events to the -chrome-trace-file file, oldest first, in the Chrome trace
+// event format ("X" complete events with microsecond timestamps).
+static void writeTraceEvents() {
+  const uint64_t recorded = TraceRingNext.load();
+  if (recorded == 0)
+    return;
+
+  std::error_code errorCode;
+  raw_fd_ostream stream(cl::ChromeTraceFile.c_str(), errorCode, sys::fs::F_Text);
+  if (errorCode)
+    return;
+
+  const TraceEvent *ring = getTraceRing();
+  const uint64_t count = std::min<uint64_t>(recorded, TraceRingSize);
+  const uint64_t first = recorded - count;
+  stream << "{\"traceEvents\":[";
+  for (uint64_t i = 0; i != count; ++i) {
+    const TraceEvent &event = ring[(first + i) & (TraceRingSize - 1)];
+    stream << (i == 0 ? "" : ",") << "\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+           << event.threadId << ",\"ts\":" << format("%.3f", event.startNanos * 1e-3)
+           << ",\"dur\":" << format("%.3f", event.durationNanos * 1e-3);
+    if (event.hash64 != 0)
+      stream << ",\"args\":{\"hash\":\"" << format("0x%016" PRIX64, event.hash64) << "\"}";
+    stream << "}";
+  }
+  stream << "\n]}\n";
+}
+
+namespace {
+
+// =====================================================================================================================
+// Helper whose destructor writes the compile trace out at static destruction time
+struct TraceEventWriter {
+  ~TraceEventWriter() { writeTraceEvents(); }
+};
+
+} // namespace
+
+// =====================================================================================================================
+// Records one completed span into the compile trace ring buffer. The caller has checked that tracing is enabled.
+//
+// @param name : Name of the span; must outlive the trace ring (event names here are all literals)
+// @param hash64 : Hash of the compilation the span belongs to, or 0
+// @param startNanos : Monotonic time when the span was opened
+// @param durationNanos : Duration of the span
+static void recordTraceEvent(const char *name, uint64_t hash64, uint64_t startNanos, uint64_t durationNanos) {
+  // Make sure the trace is written at process shutdown.
+  static TraceEventWriter Writer;
+  ((void)Writer);
+
+  TraceEvent &event = getTraceRing()[TraceRingNext.fetch_add(1, std::memory_order_relaxed) & (TraceRingSize - 1)];
+  event.name = name;
+  event.hash64 = hash64;
+  event.startNanos = startNanos;
+  event.durationNanos = durationNanos;
+  event.threadId = get_threadid();
+}
+
+// =====================================================================================================================
+//
+// @param name : Name of the span; must be a literal or otherwise outlive the trace ring
+// @param hash64 : Hash of the compilation the span belongs to, or 0 when not tied to one
+CompileTraceSpan::CompileTraceSpan(const char *name, uint64_t hash64) : m_name(name), m_hash64(hash64) {
+  m_startNanos = isEnabled() ? getMonotonicNanos() : 0;
+}
+
+// =====================================================================================================================
+CompileTraceSpan::~CompileTraceSpan() {
+  if (m_startNanos != 0)
+    recordTraceEvent(m_name, m_hash64, m_startNanos, getMonotonicNanos() - m_startNanos);
+}
+
+// =====================================================================================================================
+// Returns true if the -chrome-trace-file compile trace is being recorded.
+bool CompileTraceSpan::isEnabled() {
+  return !cl::ChromeTraceFile.empty();
+}
+
+// =====================================================================================================================
+// Writes the collected profile records to the -timer-profile-file file and frees them.
+static void writeProfileRecords() {
+  ProfileRecord *record = ProfileRecordList.exchange(nullptr);
+  if (!record)
+    return;
+
+  std::error_code errorCode;
+  raw_fd_ostream stream(cl::TimerProfileFile.c_str(), errorCode, sys::fs::F_Text);
+  if (errorCode) {
+    while (record) {
+      ProfileRecord *next = record->next;
+      delete record;
+      record = next;
+    }
+    return;
+  }
+
+  const bool csv = StringRef(cl::TimerProfileFile).endswith(".csv");
+  if (csv) {
+    stream << "hash,description,total";
+    for (unsigned i = 0; i != TimerCount; ++i)
+      stream << "," << PhaseNames[i];
+    stream << ",peakBytes";
+    for (unsigned i = 0; i != TimerCount; ++i)
+      stream << "," << PhaseNames[i] << "PeakBytes";
+    stream << "\n";
+  }
+
+  PhaseSummary totalSummary;
+  PhaseSummary phaseSummaries[TimerCount];
+
+  while (record) {
+    accumulatePhase(totalSummary, record->totalNanos);
+    for (unsigned i = 0; i != TimerCount; ++i)
+      accumulatePhase(phaseSummaries[i], record->phaseNanos[i]);
+
+    if (csv) {
+      stream << format("0x%016" PRIX64, record->hash64) << "," << record->description << ","
+             << format("%.6f", record->totalNanos * 1e-9);
+      for (unsigned i = 0; i != TimerCount; ++i)
+        stream << "," << format("%.6f", record->phaseNanos[i] * 1e-9);
+      stream << "," << record->peakBytes;
+      for (unsigned i = 0; i != TimerCount; ++i)
+        stream << "," << record->phasePeakBytes[i];
+      stream << "\n";
+    } else {
+      // One JSON object per line, so the file can be consumed as JSON lines while records are appended.
+      stream << "{\"hash\":\"" << format("0x%016" PRIX64, record->hash64) << "\",\"description\":\""
+             << record->description << "\",\"total\":" << format("%.6f", record->totalNanos * 1e-9) << ",\"phases\":{";
+      for (unsigned i = 0; i != TimerCount; ++i) {
+        stream << (i == 0 ? "" : ",") << "\"" << PhaseNames[i]
+               << "\":" << format("%.6f", record->phaseNanos[i] * 1e-9);
+      }
+      stream << "},\"peakBytes\":" << record->peakBytes << ",\"phasePeakBytes\":{";
+      for (unsigned i = 0; i != TimerCount; ++i)
+        stream << (i == 0 ? "" : ",") << "\"" << PhaseNames[i] << "\":" << record->phasePeakBytes[i];
+      stream << "}}\n";
+    }
+    ProfileRecord *next = record->next;
+    delete record;
+    record = next;
+  }
+
+  // Session summary across all compilations: per phase, the compilation count, summed time and a histogram of
+  // durations in power-of-two microsecond buckets. Written as one JSON object, prefixed with '#' in CSV mode so
+  // record consumers can skip it.
+  if (csv)
+    stream << "#";
+  stream << "{\"summary\":{\"total\":";
+  writePhaseSummary(stream, totalSummary);
+  stream << ",\"phases\":{";
+  for (unsigned i = 0; i != TimerCount; ++i) {
+    stream << (i == 0 ? "" : ",") << "\"" << PhaseNames[i] << "\":";
+    writePhaseSummary(stream, phaseSummaries[i]);
+  }
+  stream << "}}}\n";
+}
+
+namespace {
+
+// =====================================================================================================================
+// Helper whose destructor writes the profile records out at static destruction time, after all compilations
+// have finished
+struct ProfileRecordWriter {
+  ~ProfileRecordWriter() { writeProfileRecords(); }
+};
+
+} // namespace
+
+// =====================================================================================================================
+// Makes sure the profile records are written at process shutdown. Called whenever a record is pushed.
+static void ensureProfileRecordWriter() {
+  static ProfileRecordWriter Writer;
+  ((void)Writer);
+}
+
 // =====================================================================================================================
 //
 // @param hash64 : Hash code
 // @param descriptionPrefix : Profiler description prefix string
 // @param enableMask : Mask of enabled phase timers
 TimerProfiler::TimerProfiler(uint64_t hash64, const char *descriptionPrefix, unsigned enableMask)
-    : m_total("", "", getDummyTimeRecords()), m_phases("", "", getDummyTimeRecords()) {
+    : m_total("", "", getDummyTimeRecords()), m_phases("", "", getDummyTimeRecords()), m_hash64(hash64),
+      m_descriptionPrefix(descriptionPrefix) {
+  if (isProfilingToFile() || CompileTraceSpan::isEnabled())
+    m_startNanos = getMonotonicNanos();
+
   if (TimePassesIsEnabled || cl::EnableTimerProfile) {
     std::string hashString;
     raw_string_ostream ostream(hashString);
@@ -111,6 +442,25 @@ TimerProfiler::~TimerProfiler() {
     // Stop whole timer
     m_wholeTimer.stopTimer();
   }
+
+  if (CompileTraceSpan::isEnabled())
+    recordTraceEvent(m_descriptionPrefix, m_hash64, m_startNanos, getMonotonicNanos() - m_startNanos);
+
+  if (isProfilingToFile()) {
+    // Push the finished record onto the global list with a lock-free prepend; it is written out at shutdown.
+    ProfileRecord *record = new ProfileRecord;
+    record->hash64 = m_hash64;
+    record->description = m_descriptionPrefix;
+    record->totalNanos = getMonotonicNanos() - m_startNanos;
+    memcpy(record->phaseNanos, m_phaseNanos, sizeof(m_phaseNanos));
+    record->peakBytes = m_peakBytes;
+    memcpy(record->phasePeakBytes, m_phasePeakBytes, sizeof(m_phasePeakBytes));
+    record->next = ProfileRecordList.load(std::memory_order_relaxed);
+    while (!ProfileRecordList.compare_exchange_weak(record->next, record, std::memory_order_release,
+                                                    std::memory_order_relaxed))
+      ;
+    ensureProfileRecordWriter();
+  }
 }
 
 // =====================================================================================================================
@@ -122,6 +472,8 @@ TimerProfiler::~TimerProfiler() {
 void TimerProfiler::addTimerStartStopPass(lgc::PassManager *passMgr, TimerKind timerKind, bool start) {
   if (TimePassesIsEnabled || cl::EnableTimerProfile)
     passMgr->add(lgc::LgcContext::createStartStopTimer(&m_phaseTimers[timerKind], start));
+  if (isProfilingToFile() || CompileTraceSpan::isEnabled())
+    passMgr->add(new StartStopPhaseTimer(this, timerKind, start));
 }
 
 // =====================================================================================================================
@@ -130,6 +482,7 @@ void TimerProfiler::addTimerStartStopPass(lgc::PassManager *passMgr, TimerKind t
 // @param timerKind : Kind of phase timer
 // @param start : Start or  stop timer
 void TimerProfiler::startStopTimer(TimerKind timerKind, bool start) {
+  startStopPhase(timerKind, start);
   if (TimePassesIsEnabled || cl::EnableTimerProfile) {
     if (start)
       m_phaseTimers[timerKind].startTimer();
@@ -138,6 +491,38 @@ void TimerProfiler::startStopTimer(TimerKind timerKind, bool start) {
   }
 }
 
+// =====================================================================================================================
+// Starts or stops the monotonic counter for the specified phase. Unlike the LLVM timers, this takes no locks:
+// the counters belong to this TimerProfiler, which is only used by the thread doing the compilation.
+//
+// @param timerKind : Kind of phase timer
+// @param start : Start or stop the counter
+void TimerProfiler::startStopPhase(TimerKind timerKind, bool start) {
+  const bool tracing = CompileTraceSpan::isEnabled();
+  if (!isProfilingToFile() && !tracing)
+    return;
+  if (start)
+    m_phaseStartNanos[timerKind] = getMonotonicNanos();
+  else {
+    const uint64_t endNanos = getMonotonicNanos();
+    m_phaseNanos[timerKind] += endNanos - m_phaseStartNanos[timerKind];
+    if (tracing)
+      recordTraceEvent(PhaseNames[timerKind], m_hash64, m_phaseStartNanos[timerKind],
+                       endNanos - m_phaseStartNanos[timerKind]);
+  }
+
+  if (!isProfilingToFile())
+    return;
+
+  // Sample the allocation footprint at both boundaries; the end-of-phase sample captures what the phase
+  // allocated, so footprint growth is attributed to the phase that caused it.
+  uint64_t bytes = sys::Process::GetMallocUsage();
+  if (bytes > m_peakBytes)
+    m_peakBytes = bytes;
+  if (bytes > m_phasePeakBytes[timerKind])
+    m_phasePeakBytes[timerKind] = bytes;
+}
+
 // =====================================================================================================================
 // Gets a specific timer. Returns nullptr if TimePassesIsEnabled isn't enabled.
 //
@@ -146,6 +531,12 @@ Timer *TimerProfiler::getTimer(TimerKind timerKind) {
   return TimePassesIsEnabled || cl::EnableTimerProfile ? &m_phaseTimers[timerKind] : nullptr;
 }
 
+// =====================================================================================================================
+// Returns true if phase times are collected for the -timer-profile-file output.
+bool TimerProfiler::isProfilingToFile() {
+  return !cl::TimerProfileFile.empty();
+}
+
 // =====================================================================================================================
 // Gets dummy TimeRecords.
 const StringMap<TimeRecord> &TimerProfiler::getDummyTimeRecords() {
@@ -43,6 +43,30 @@ class PassManager;
 
 namespace Llpc {
 
+// =====================================================================================================================
+// RAII span for the -chrome-trace-file compile trace: records the enclosed interval, tagged with the current
+// thread and an optional compilation hash, into a global ring buffer that is written out as a Chrome trace
+// (chrome://tracing, Perfetto) at shutdown. When tracing is off the constructor is one string-empty check and
+// nothing is recorded, so spans can stay in production code paths.
+class CompileTraceSpan {
+public:
+  CompileTraceSpan(const char *name, uint64_t hash64 = 0);
+
+  ~CompileTraceSpan();
+
+  // Returns true if the -chrome-trace-file compile trace is being recorded.
+  static bool isEnabled();
+
+private:
+  CompileTraceSpan(const CompileTraceSpan &) = delete;
+  CompileTraceSpan &operator=(const CompileTraceSpan &) = delete;
+
+  const char *m_name;    // Name of the span, shown as the event name in the trace; must be a literal or otherwise
+                         //  outlive the trace ring
+  uint64_t m_hash64;     // Hash of the compilation the span belongs to, or 0 when not tied to one
+  uint64_t m_startNanos; // Monotonic time when the span was opened; 0 when tracing is off
+};
+
 // =====================================================================================================================
 // Enumerates the kinds of timer used to do profiling for LLPC compilation phases.
 enum TimerKind : unsigned {
@@ -58,6 +82,11 @@ enum TimerKind : unsigned {
 
 // =====================================================================================================================
 // Represents a utility class for time profile, it wraps LLVM Timer and TimerGroup in internal.
+//
+// In addition to the LLVM timers (enabled with -time-passes or -enable-timer-profile, and printed as text at
+// shutdown), phase times can be collected with plain monotonic counters and written out per compilation hash in
+// machine-readable form with -timer-profile-file. That path takes no locks while timing: each TimerProfiler is
+// used by a single thread, and the finished records are aggregated on a lock-free list.
 class TimerProfiler {
 public:
   TimerProfiler(uint64_t hash64, const char *descriptionPrefix, unsigned enableMask);
@@ -68,10 +97,17 @@ public:
 
   void startStopTimer(TimerKind name, bool start);
 
+  // Start or stop the monotonic counter for the given phase. Only used internally and by the start/stop
+  // pass inserted by addTimerStartStopPass; other callers want startStopTimer.
+  void startStopPhase(TimerKind timerKind, bool start);
+
   llvm::Timer *getTimer(TimerKind timerKind);
 
   static const llvm::StringMap<llvm::TimeRecord> &getDummyTimeRecords();
 
+  // Returns true if phase times are collected for the -timer-profile-file output.
+  static bool isProfilingToFile();
+
   static const unsigned PipelineTimerEnableMask = ((1 << TimerCount) - 1);
   static const unsigned ShaderModuleTimerEnableMask = ((1 << TimerTranslate) | (1 << TimerLower));
 
@@ -83,6 +119,18 @@ private:
   llvm::TimerGroup m_phases;             // TimeGroup for each phase
   llvm::Timer m_wholeTimer;              // Whole timer
   llvm::Timer m_phaseTimers[TimerCount]; // Phase timer
+
+  // State for the -timer-profile-file output
+  uint64_t m_hash64;                           // Hash of the compilation being profiled
+  const char *m_descriptionPrefix;             // Description prefix, e.g. "LLPC ShaderModule"
+  uint64_t m_startNanos = 0;                   // Monotonic time at construction
+  uint64_t m_phaseStartNanos[TimerCount] = {}; // Monotonic time at the start of each running phase
+  uint64_t m_phaseNanos[TimerCount] = {};      // Accumulated monotonic time of each phase
+
+  // Allocation footprint, sampled at phase boundaries (per-allocation tracking would require replacing the
+  // allocator, which LLVM does not support). The peak seen while a phase was running is attributed to it.
+  uint64_t m_peakBytes = 0;                    // Largest allocation footprint sampled during the compilation
+  uint64_t m_phasePeakBytes[TimerCount] = {};  // Largest allocation footprint sampled during each phase
 };
 
 } // namespace Llpc
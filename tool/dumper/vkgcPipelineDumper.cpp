@@ -34,10 +34,14 @@
 #include "vkgcElfReader.h"
 #include "vkgcPipelineDumper.h"
 #include "vkgcUtil.h"
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <mutex>
 #include <sstream>
 #include <stdarg.h>
 #include <sys/stat.h>
+#include <thread>
 #include <unordered_set>
 
 #define DEBUG_TYPE "vkgc-pipeline-dumper"
@@ -85,18 +89,134 @@ private:
 // Mutex for pipeline dump
 static Mutex SDumpMutex;
 
+// Name of the single-file dump container, or empty for one file per dump; see PipelineDumper::SetDumpContainerFile
+static std::string SDumpContainerFile;
+
+// Magic number at the start of a dump container file
+static const char DumpContainerMagic[4] = {'V', 'P', 'D', 'C'};
+
+// Version of the dump container format
+static const unsigned DumpContainerVersion = 1;
+
 // =====================================================================================================================
-// Represents the file objects for pipeline dump
+// Represents the in-memory buffers for one pipeline dump. The buffered contents are handed to the background dump
+// file writer when the dump ends, so dumping never blocks a compile thread on the filesystem.
 struct PipelineDumpFile {
   PipelineDumpFile(const char *dumpFileName, const char *binaryFileName)
-      : dumpFile(dumpFileName), binaryIndex(0), binaryFileName(binaryFileName) {}
+      : dumpFileName(dumpFileName), binaryIndex(0), binaryFileName(binaryFileName) {}
+
+  std::ostringstream dumpFile; // Buffered contents of the .pipe file
+  std::string dumpFileName;    // File name of .pipe file
+  unsigned binaryIndex;        // ELF Binary index
+  std::string binaryFileName;  // File name of binary file
+};
+
+// =====================================================================================================================
+// Background writer that performs the filesystem I/O of pipeline dumps. Each queue entry is one whole file, written
+// in a single call, so writes are coalesced instead of trickling out per << operator. Queued files are drained when
+// the writer is destroyed on process exit.
+class DumpFileWriter {
+public:
+  ~DumpFileWriter();
+
+  void post(std::string &&fileName, std::string &&contents);
+
+  // Gets the singleton dump file writer, starting its thread on first use.
+  static DumpFileWriter *getInstance() {
+    static DumpFileWriter Instance;
+    return &Instance;
+  }
+
+private:
+  DumpFileWriter() : m_exiting(false) { m_thread = std::thread(&DumpFileWriter::run, this); }
 
-  std::ofstream dumpFile;     // File object for .pipe file
-  std::ofstream binaryFile;   // File object for ELF binary
-  unsigned binaryIndex;       // ELF Binary index
-  std::string binaryFileName; // File name of binary file
+  void run();
+  void writeContainerRecord(const std::string &name, const std::string &contents);
+
+  std::deque<std::pair<std::string, std::string>> m_queue; // Queued files: {file name, whole file contents}
+  std::mutex m_mutex;                                      // Protects the queue
+  std::condition_variable m_condition;                     // Signaled when a file is queued or at exit
+  std::thread m_thread;                                    // Writer thread
+  std::ofstream m_containerFile;                           // Container file, opened on the first record
+  bool m_exiting;                                          // Makes the writer thread drain the queue and exit
 };
 
+// =====================================================================================================================
+// Destroys the dump file writer: makes the writer thread drain any queued files and waits for it.
+DumpFileWriter::~DumpFileWriter() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_exiting = true;
+  }
+  m_condition.notify_all();
+  m_thread.join();
+}
+
+// =====================================================================================================================
+// Queues one whole file for writing. Returns without touching the filesystem.
+//
+// @param fileName : Name of the file to write
+// @param contents : Whole contents of the file
+void DumpFileWriter::post(std::string &&fileName, std::string &&contents) {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queue.emplace_back(std::move(fileName), std::move(contents));
+  }
+  m_condition.notify_one();
+}
+
+// =====================================================================================================================
+// Writer thread main loop: writes queued files until told to exit and the queue is drained.
+void DumpFileWriter::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    if (m_queue.empty()) {
+      if (m_exiting)
+        break;
+      m_condition.wait(lock);
+      continue;
+    }
+
+    std::pair<std::string, std::string> entry = std::move(m_queue.front());
+    m_queue.pop_front();
+    lock.unlock();
+
+    if (!SDumpContainerFile.empty())
+      writeContainerRecord(entry.first, entry.second);
+    else {
+      std::ofstream file(entry.first.c_str(), std::ios_base::binary | std::ios_base::out);
+      if (!file.bad())
+        file.write(entry.second.data(), entry.second.size());
+    }
+
+    lock.lock();
+  }
+}
+
+// =====================================================================================================================
+// Appends one dump file as a record of the single-file dump container, opening the container and writing its header
+// on the first record. Each record is the file name size, the contents size, the file name and the contents, written
+// back to back, so a capture run costs one sequentially written file instead of millions of small ones.
+//
+// @param name : Name the file would have been written under in one-file-per-dump mode
+// @param contents : Whole contents of the file
+void DumpFileWriter::writeContainerRecord(const std::string &name, const std::string &contents) {
+  if (!m_containerFile.is_open()) {
+    m_containerFile.open(SDumpContainerFile.c_str(), std::ios_base::binary | std::ios_base::out);
+    if (!m_containerFile.is_open())
+      return;
+    m_containerFile.write(DumpContainerMagic, sizeof(DumpContainerMagic));
+    m_containerFile.write(reinterpret_cast<const char *>(&DumpContainerVersion), sizeof(DumpContainerVersion));
+  }
+
+  const uint64_t nameSize = name.size();
+  const uint64_t contentsSize = contents.size();
+  m_containerFile.write(reinterpret_cast<const char *>(&nameSize), sizeof(nameSize));
+  m_containerFile.write(reinterpret_cast<const char *>(&contentsSize), sizeof(contentsSize));
+  m_containerFile.write(name.data(), name.size());
+  m_containerFile.write(contents.data(), contents.size());
+}
+
 // =====================================================================================================================
 // Dumps SPIR-V shader binary to external file.
 //
@@ -104,7 +224,8 @@ struct PipelineDumpFile {
 // @param spirvBin : SPIR-V binary
 void VKAPI_CALL IPipelineDumper::DumpSpirvBinary(const char *dumpDir, const BinaryData *spirvBin) {
   MetroHash::Hash hash = {};
-  MetroHash64::Hash(reinterpret_cast<const uint8_t *>(spirvBin->pCode), spirvBin->codeSize, hash.bytes);
+  // NOTE: Must match the module hash computed by Compiler::BuildShaderModule, so the dumped file names agree.
+  MetroHash128::Hash(reinterpret_cast<const uint8_t *>(spirvBin->pCode), spirvBin->codeSize, hash.bytes);
   PipelineDumper::DumpSpirvBinary(dumpDir, spirvBin, &hash);
 }
 
@@ -251,6 +372,16 @@ std::string PipelineDumper::getPipelineInfoFileName(PipelineBuildInfo pipelineIn
   return std::string(fileName);
 }
 
+// =====================================================================================================================
+// Sets the file that collects all pipeline dumps as records of one sequentially written container, instead of one
+// .pipe/.elf file per pipeline. Must be called before the first dump begins and is not reread while dumps are in
+// flight. Records are expanded back to the per-pipeline text files offline with "amdllpc -unpack-pipeline-dump".
+//
+// @param fileName : Container file name; nullptr returns to one-file-per-dump output
+void PipelineDumper::SetDumpContainerFile(const char *fileName) {
+  SDumpContainerFile = fileName ? fileName : "";
+}
+
 // =====================================================================================================================
 // Begins to dump graphics/compute pipeline info.
 //
@@ -302,6 +433,9 @@ PipelineDumpFile *PipelineDumper::BeginPipelineDump(const PipelineDumpOptions *d
 
     // Build dump file name
     if (dumpOptions->dumpDuplicatePipelines) {
+      // NOTE: Recently queued dumps may not have reached the filesystem yet, so names picked within this process
+      // must be tracked here in addition to probing for files left by earlier runs.
+      static std::unordered_set<std::string> UsedPathNames;
       unsigned index = 0;
       int result = 0;
       while (result != -1) {
@@ -315,10 +449,15 @@ PipelineDumpFile *PipelineDumper::BeginPipelineDump(const PipelineDumpOptions *d
         }
         dumpBinaryName = dumpPathName + ".elf";
         dumpPathName += ".pipe";
+        if (UsedPathNames.find(dumpPathName) != UsedPathNames.end()) {
+          ++index;
+          continue;
+        }
         struct FILE_STAT fileStatus = {};
         result = FILE_STAT(dumpPathName.c_str(), &fileStatus);
         ++index;
       };
+      UsedPathNames.insert(dumpPathName);
     } else {
       static std::unordered_set<std::string> FileNames;
 
@@ -333,14 +472,9 @@ PipelineDumpFile *PipelineDumper::BeginPipelineDump(const PipelineDumpOptions *d
         enableDump = false;
     }
 
-    // Open dump file
-    if (enableDump) {
+    // Create the dump buffers; the file itself is only written when the dump ends.
+    if (enableDump)
       dumpFile = new PipelineDumpFile(dumpPathName.c_str(), dumpBinaryName.c_str());
-      if (dumpFile->dumpFile.bad()) {
-        delete dumpFile;
-        dumpFile = nullptr;
-      }
-    }
 
     SDumpMutex.unlock();
 
@@ -363,6 +497,8 @@ PipelineDumpFile *PipelineDumper::BeginPipelineDump(const PipelineDumpOptions *d
 //
 // @param dumpFile : Dump file
 void PipelineDumper::EndPipelineDump(PipelineDumpFile *dumpFile) {
+  if (dumpFile)
+    DumpFileWriter::getInstance()->post(std::move(dumpFile->dumpFileName), dumpFile->dumpFile.str());
   delete dumpFile;
 }
 
@@ -517,6 +653,9 @@ void PipelineDumper::dumpPipelineShaderInfo(const PipelineShaderInfo *shaderInfo
   dumpFile << "options.unrollThreshold = " << shaderInfo->options.unrollThreshold << "\n";
   dumpFile << "options.scalarThreshold = " << shaderInfo->options.scalarThreshold << "\n";
   dumpFile << "options.disableLoopUnroll = " << shaderInfo->options.disableLoopUnroll << "\n";
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+  dumpFile << "options.transcendentalPrecision = " << shaderInfo->options.transcendentalPrecision << "\n";
+#endif
 
   dumpFile << "\n";
 }
@@ -568,11 +707,8 @@ void PipelineDumper::DumpPipelineBinary(PipelineDumpFile *dumpFile, GfxIpVersion
   }
 
   dumpFile->binaryIndex++;
-  dumpFile->binaryFile.open(binaryFileName.c_str(), std::ostream::out | std::ostream::binary);
-  if (!dumpFile->binaryFile.bad()) {
-    dumpFile->binaryFile.write(reinterpret_cast<const char *>(pipelineBin->pCode), pipelineBin->codeSize);
-    dumpFile->binaryFile.close();
-  }
+  DumpFileWriter::getInstance()->post(
+      std::move(binaryFileName), std::string(static_cast<const char *>(pipelineBin->pCode), pipelineBin->codeSize));
 }
 
 // =====================================================================================================================
@@ -773,48 +909,59 @@ void PipelineDumper::dumpGraphicsPipelineInfo(std::ostream *dumpFile, const char
 // @param isCacheHash : TRUE if the hash is used by shader cache
 // @param isRelocatableShader : TRUE if we are building relocatable shader
 // @param stage : The stage for which we are building the hash. ShaderStageInvalid if building for the entire pipeline.
+// @param stateHashes : Optional memo of the state sub-digests, reused across the per-stage hashes of one pipeline
 MetroHash::Hash PipelineDumper::generateHashForGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline,
                                                                 bool isCacheHash, bool isRelocatableShader,
-                                                                unsigned stage) {
+                                                                unsigned stage,
+                                                                GraphicsPipelineStateHashes *stateHashes) {
   MetroHash64 hasher;
 
-  switch (stage) {
-  case ShaderStageVertex:
-    updateHashForPipelineShaderInfo(ShaderStageVertex, &pipeline->vs, isCacheHash, &hasher, isRelocatableShader);
-    break;
-  case ShaderStageTessControl:
-    updateHashForPipelineShaderInfo(ShaderStageTessControl, &pipeline->tcs, isCacheHash, &hasher, isRelocatableShader);
-    break;
-  case ShaderStageTessEval:
-    updateHashForPipelineShaderInfo(ShaderStageTessEval, &pipeline->tes, isCacheHash, &hasher, isRelocatableShader);
-    break;
-  case ShaderStageGeometry:
-    updateHashForPipelineShaderInfo(ShaderStageGeometry, &pipeline->gs, isCacheHash, &hasher, isRelocatableShader);
-    break;
-  case ShaderStageFragment:
-    updateHashForPipelineShaderInfo(ShaderStageFragment, &pipeline->fs, isCacheHash, &hasher, isRelocatableShader);
-    break;
-  case ShaderStageInvalid:
-    updateHashForPipelineShaderInfo(ShaderStageVertex, &pipeline->vs, isCacheHash, &hasher, isRelocatableShader);
-    updateHashForPipelineShaderInfo(ShaderStageTessControl, &pipeline->tcs, isCacheHash, &hasher, isRelocatableShader);
-    updateHashForPipelineShaderInfo(ShaderStageTessEval, &pipeline->tes, isCacheHash, &hasher, isRelocatableShader);
-    updateHashForPipelineShaderInfo(ShaderStageGeometry, &pipeline->gs, isCacheHash, &hasher, isRelocatableShader);
-    updateHashForPipelineShaderInfo(ShaderStageFragment, &pipeline->fs, isCacheHash, &hasher, isRelocatableShader);
-    break;
-  default:
-    llvm_unreachable("Should never be called!");
-    break;
+  // Each stage is hashed to an independent digest and the digests are combined, so the per-stage digests can also
+  // be computed separately (even concurrently) and reused by per-stage consumers.
+  const PipelineShaderInfo *shaderInfos[] = {&pipeline->vs, &pipeline->tcs, &pipeline->tes, &pipeline->gs,
+                                             &pipeline->fs};
+  if (stage == ShaderStageInvalid) {
+    for (unsigned shaderStage = ShaderStageVertex; shaderStage <= ShaderStageFragment; ++shaderStage) {
+      MetroHash::Hash stageHash = generateHashForPipelineShaderInfo(static_cast<ShaderStage>(shaderStage),
+                                                                    shaderInfos[shaderStage], isCacheHash,
+                                                                    isRelocatableShader);
+      hasher.Update(stageHash.bytes, sizeof(stageHash.bytes));
+    }
+  } else {
+    assert(stage <= ShaderStageFragment);
+    MetroHash::Hash stageHash = generateHashForPipelineShaderInfo(static_cast<ShaderStage>(stage), shaderInfos[stage],
+                                                                  isCacheHash, isRelocatableShader);
+    hasher.Update(stageHash.bytes, sizeof(stageHash.bytes));
   }
 
   hasher.Update(pipeline->iaState.deviceIndex);
 
+  // The state sections are folded in as independent sub-digests, so callers hashing several stages of the same
+  // pipeline (via the stateHashes memo) pay for each state walk only once.
+  GraphicsPipelineStateHashes localStateHashes;
+  if (!stateHashes)
+    stateHashes = &localStateHashes;
+
   if (stage != ShaderStageFragment) {
-    updateHashForVertexInputState(pipeline->pVertexInput, &hasher);
-    updateHashForNonFragmentState(pipeline, isCacheHash, &hasher);
+    if (!stateHashes->nonFragmentValid) {
+      MetroHash64 stateHasher;
+      updateHashForVertexInputState(pipeline->pVertexInput, &stateHasher);
+      updateHashForNonFragmentState(pipeline, isCacheHash, &stateHasher);
+      stateHasher.Finalize(stateHashes->nonFragmentState.bytes);
+      stateHashes->nonFragmentValid = true;
+    }
+    hasher.Update(stateHashes->nonFragmentState.bytes, sizeof(stateHashes->nonFragmentState.bytes));
   }
 
-  if (stage == ShaderStageFragment || stage == ShaderStageInvalid)
-    updateHashForFragmentState(pipeline, &hasher);
+  if (stage == ShaderStageFragment || stage == ShaderStageInvalid) {
+    if (!stateHashes->fragmentValid) {
+      MetroHash64 stateHasher;
+      updateHashForFragmentState(pipeline, &stateHasher);
+      stateHasher.Finalize(stateHashes->fragmentState.bytes);
+      stateHashes->fragmentValid = true;
+    }
+    hasher.Update(stateHashes->fragmentState.bytes, sizeof(stateHashes->fragmentState.bytes));
+  }
 
   MetroHash::Hash hash = {};
   hasher.Finalize(hash.bytes);
@@ -849,6 +996,27 @@ MetroHash::Hash PipelineDumper::generateHashForComputePipeline(const ComputePipe
   return hash;
 }
 
+// =====================================================================================================================
+// Builds the digest of a single pipeline shader info. The digest depends only on that shader's info, so stage
+// digests can be computed in any order or concurrently, and reused by per-stage consumers such as the relocatable
+// shader compilation path.
+//
+// @param stage : Shader stage of the shader info
+// @param shaderInfo : Shader info of the specified shader stage
+// @param isCacheHash : TRUE if the hash is used by shader cache
+// @param isRelocatableShader : TRUE if we are building relocatable shader
+MetroHash::Hash PipelineDumper::generateHashForPipelineShaderInfo(ShaderStage stage,
+                                                                  const PipelineShaderInfo *shaderInfo,
+                                                                  bool isCacheHash, bool isRelocatableShader) {
+  MetroHash64 hasher;
+  updateHashForPipelineShaderInfo(stage, shaderInfo, isCacheHash, &hasher, isRelocatableShader);
+
+  MetroHash::Hash hash = {};
+  hasher.Finalize(hash.bytes);
+
+  return hash;
+}
+
 // =====================================================================================================================
 // Updates hash code context for vertex input state
 //
@@ -1064,6 +1232,9 @@ void PipelineDumper::updateHashForPipelineShaderInfo(ShaderStage stage, const Pi
       hasher->Update(options.unrollThreshold);
       hasher->Update(options.scalarThreshold);
       hasher->Update(options.disableLoopUnroll);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+      hasher->Update(options.transcendentalPrecision);
+#endif
     }
   }
 }
@@ -67,6 +67,8 @@ public:
 
   static void DumpSpirvBinary(const char *dumpDir, const BinaryData *spirvBin, MetroHash::Hash *hash);
 
+  static void SetDumpContainerFile(const char *fileName);
+
   static PipelineDumpFile *BeginPipelineDump(const PipelineDumpOptions *dumpOptions, PipelineBuildInfo pipelineInfo,
                                              const MetroHash::Hash *hash);
 
@@ -76,12 +78,28 @@ public:
 
   static void DumpPipelineExtraInfo(PipelineDumpFile *binaryFile, const std::string *str);
 
+  // Memo of the pipeline-state sub-digests shared by the per-stage hashes of one graphics pipeline. A caller
+  // hashing several stages of the same pipeline (such as the relocatable per-stage cache lookups) passes one
+  // instance across the calls, so the vertex-input, non-fragment and fragment state walks are paid only once.
+  // The digests depend on isCacheHash, so an instance must not be shared between cache-hash and pipeline-hash
+  // calls.
+  struct GraphicsPipelineStateHashes {
+    bool nonFragmentValid = false;    // Whether nonFragmentState has been computed yet
+    bool fragmentValid = false;       // Whether fragmentState has been computed yet
+    MetroHash::Hash nonFragmentState; // Digest of the vertex input state and the non-fragment state
+    MetroHash::Hash fragmentState;    // Digest of the fragment state
+  };
+
   static MetroHash::Hash generateHashForGraphicsPipeline(const GraphicsPipelineBuildInfo *pipeline, bool isCacheHash,
-                                                         bool isRelocatableShader, unsigned stage = ShaderStageInvalid);
+                                                         bool isRelocatableShader, unsigned stage = ShaderStageInvalid,
+                                                         GraphicsPipelineStateHashes *stateHashes = nullptr);
 
   static MetroHash::Hash generateHashForComputePipeline(const ComputePipelineBuildInfo *pipeline, bool isCacheHash,
                                                         bool isRelocatableShader);
 
+  static MetroHash::Hash generateHashForPipelineShaderInfo(ShaderStage stage, const PipelineShaderInfo *shaderInfo,
+                                                           bool isCacheHash, bool isRelocatableShader);
+
   static std::string getPipelineInfoFileName(PipelineBuildInfo pipelineInfo, const MetroHash::Hash *hash);
 
   static void updateHashForPipelineShaderInfo(ShaderStage stage, const PipelineShaderInfo *shaderInfo, bool isCacheHash,
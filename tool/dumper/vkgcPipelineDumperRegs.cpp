@@ -29,10 +29,13 @@
 ***********************************************************************************************************************
 */
 #include "vkgcPipelineDumper.h"
+#include <algorithm>
+#include <cassert>
 
 namespace Vkgc {
 
-// A single register in the pipelineDumperRegs table
+// A single register in the pipelineDumperRegs table; the table is sorted by register number so lookups can
+// binary-search it
 struct PipelineDumperReg {
   unsigned number;
   const char *name;
@@ -423,11 +426,19 @@ const PipelineDumperReg PipelineDumperRegs[] = {
 //
 // @param regNumber : Register number
 const char *PipelineDumper::getRegisterNameString(unsigned regNumber) {
-  for (unsigned idx = 0, end = sizeof(PipelineDumperRegs) / sizeof(PipelineDumperRegs[0]); idx != end; ++idx) {
-    const auto &regEntry = PipelineDumperRegs[idx];
-    if (regEntry.number == regNumber)
-      return regEntry.name;
-  }
+  const auto begin = std::begin(PipelineDumperRegs);
+  const auto end = std::end(PipelineDumperRegs);
+  assert(std::is_sorted(begin, end,
+                        [](const PipelineDumperReg &reg1, const PipelineDumperReg &reg2) {
+                          return reg1.number < reg2.number;
+                        }));
+  // For the few numbers listed under more than one name, lower_bound yields the first entry, matching the
+  // order the former linear scan resolved them in.
+  const auto regEntry = std::lower_bound(begin, end, regNumber, [](const PipelineDumperReg &reg, unsigned number) {
+    return reg.number < number;
+  });
+  if (regEntry != end && regEntry->number == regNumber)
+    return regEntry->name;
   return "";
 }
 
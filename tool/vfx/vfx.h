@@ -575,6 +575,21 @@ struct VfxPipelineState {
 };
 
 typedef struct VfxPipelineState *VfxPipelineStatePtr;
+
+static const unsigned VfxPipelineBinaryMagic = 0x58465642; // Identifies a compiled pipeline document ("BVFX")
+static const unsigned VfxPipelineBinaryVersion = 1;        // Version of the compiled pipeline document format
+
+// =====================================================================================================================
+// Represents the header of the compiled (binary) form of a pipeline document. The body is the VfxPipelineState
+// flattened into one blob, with pointer members replaced by byte offsets from the start of this header.
+struct VfxPipelineBinaryHeader {
+  unsigned magic;       // Magic number identifying a compiled pipeline document (VfxPipelineBinaryMagic)
+  unsigned version;     // Format version (VfxPipelineBinaryVersion)
+  unsigned size;        // Total size of the document in bytes, including this header
+  unsigned stateSize;   // sizeof(VfxPipelineState) when the document was compiled, guards struct layout changes
+  unsigned pointerSize; // sizeof(void *) when the document was compiled
+  unsigned stateOffset; // Offset of the flattened VfxPipelineState
+};
 #else
 typedef void *VfxPipelineStatePtr;
 #endif
@@ -590,6 +605,9 @@ namespace Vfx {
 bool VFXAPI vfxParseFile(const char *pFilename, unsigned int numMacro, const char *pMacros[], VfxDocType type,
                          void **ppDoc, const char **ppErrorMsg);
 
+bool VFXAPI vfxParseFiles(unsigned int numFiles, const char *pFilenames[], unsigned int numMacro,
+                          const char *pMacros[], VfxDocType type, void **ppDocs, const char **ppErrorMsgs);
+
 void VFXAPI vfxCloseDoc(void *pDoc);
 
 #if VFX_SUPPORT_RENDER_DOCOUMENT
@@ -598,6 +616,12 @@ void VFXAPI vfxGetRenderDoc(void *pDoc, VfxRenderStatePtr *pRenderState);
 
 #if VFX_SUPPORT_VK_PIPELINE
 void VFXAPI vfxGetPipelineDoc(void *pDoc, VfxPipelineStatePtr *pPipelineState);
+
+bool VFXAPI vfxIsPipelineBinaryFile(const char *pFilename);
+
+bool VFXAPI vfxCompilePipelineBinary(void *pDoc, const char *pFilename, const char **ppErrorMsg);
+
+bool VFXAPI vfxLoadPipelineBinary(const char *pFilename, void **ppDoc, const char **ppErrorMsg);
 #endif
 
 void VFXAPI vfxPrintDoc(void *pDoc);
@@ -43,12 +43,30 @@
 #endif
 
 #include <assert.h>
+#include <atomic>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <thread>
 #include <vector>
 
 namespace Vfx {
+
+// =====================================================================================================================
+// Tokenizes a string like strtok, but keeps the hidden scan state in a thread-local rather than a process global,
+// so documents being parsed concurrently by vfxParseFiles cannot interleave each other's token sequences.
+//
+// @param str : String to tokenize on the first call of a sequence; nullptr to continue the previous sequence
+// @param delim : Delimiter characters
+static char *vfxStrtok(char *str, const char *delim) {
+  static thread_local char *context = nullptr;
+#ifdef _WIN32
+  return strtok_s(str, delim, &context);
+#else
+  return strtok_r(str, delim, &context);
+#endif
+}
+
 // Parser functions to parse a value by it's type
 bool parseInt(char *str, unsigned lineNum, IUFValue *output);
 bool parseFloat(char *str, unsigned lineNum, IUFValue *output);
@@ -167,6 +185,7 @@ bool Document::compileShader() {
 // Constructs an instance of class Document.
 Document::Document()
     : m_isValidVfxFile(false), m_currentSection(nullptr), m_currentLineNum(0), m_currentSectionLineNum(0) {
+  initBaseSections();
 }
 
 // =====================================================================================================================
@@ -189,7 +208,7 @@ bool Document::parseLine(char *line) {
     if (result)
       result = beginSection(line);
   } else
-    m_currentSectionStringBuffer << line;
+    m_currentSectionLines.push_back(line);
 
   return result;
 }
@@ -211,13 +230,12 @@ bool Document::beginSection(char *line) {
 
   if (result) {
     line = line + 1;
-    char *sectionName = strtok(line, ",");
+    char *sectionName = vfxStrtok(line, ",");
     m_currentSection = getFreeSection(sectionName);
     if (m_currentSection) {
       // Next line is the first line of section content.
       m_currentSectionLineNum = m_currentLineNum + 1;
-      m_currentSectionStringBuffer.str("");
-      m_currentSectionStringBuffer.clear();
+      m_currentSectionLines.clear();
       m_currentSection->setLineNum(m_currentLineNum);
     }
   }
@@ -257,15 +275,8 @@ bool Document::parseSectionKeyValues() {
 
   // Set line number variable which is used in error report.
   unsigned lineNum = m_currentSectionLineNum;
-  char lineBuffer[MaxLineBufSize];
-  while (true) {
-    m_currentSectionStringBuffer.getline(lineBuffer, MaxLineBufSize);
-
-    size_t readCount = static_cast<size_t>(m_currentSectionStringBuffer.gcount());
-    VFX_ASSERT(readCount < MaxLineBufSize);
-    if (readCount == 0)
-      break;
-    if (lineBuffer[0] == '\0' || memcmp(lineBuffer, "\r", 2) == 0) {
+  for (char *line : m_currentSectionLines) {
+    if (line[0] == '\0' || memcmp(line, "\r", 2) == 0) {
       // Skip empty line
       continue;
     }
@@ -273,7 +284,7 @@ bool Document::parseSectionKeyValues() {
     char *key = nullptr;
     char *value = nullptr;
 
-    result = extractKeyAndValue(lineBuffer, lineNum, '=', &key, &value, &m_errorMsg);
+    result = extractKeyAndValue(line, lineNum, '=', &key, &value, &m_errorMsg);
 
     if (!result)
       break;
@@ -310,7 +321,7 @@ bool Document::parseKey(const char *key, unsigned lineNum, Section *sectionObjec
   Section *tempSectionObj = sectionObjectIn;
 
   // Process member access
-  char *keyTok = strtok(keyBuffer, ".");
+  char *keyTok = vfxStrtok(keyBuffer, ".");
   keyTok = trimStringBeginning(keyTok);
   keyTok = trimStringEnd(keyTok);
 
@@ -342,7 +353,7 @@ bool Document::parseKey(const char *key, unsigned lineNum, Section *sectionObjec
         break;
     }
 
-    keyTok = strtok(nullptr, ".");
+    keyTok = vfxStrtok(nullptr, ".");
   }
 
   if (arrayIndex)
@@ -505,17 +516,13 @@ bool Document::parseKeyValue(char *key, char *valueStr, unsigned lineNum, Sectio
 void Document::parseSectionShaderSource() {
   char lineBuffer[MaxLineBufSize];
 
-  while (true) {
-    m_currentSectionStringBuffer.getline(lineBuffer, MaxLineBufSize);
-
-    size_t readCount = static_cast<size_t>(m_currentSectionStringBuffer.gcount());
-    VFX_ASSERT(readCount < MaxLineBufSize);
-    if (readCount == 0)
-      break;
-
-    // Line ending is not returned by getline(), so append them manually.
-    lineBuffer[readCount - 1] = '\n';
-    lineBuffer[readCount] = '\0';
+  for (const char *line : m_currentSectionLines) {
+    // Line endings were stripped when the file buffer was split into lines, so append them manually.
+    size_t length = strlen(line);
+    VFX_ASSERT(length + 1 < MaxLineBufSize);
+    memcpy(lineBuffer, line, length);
+    lineBuffer[length] = '\n';
+    lineBuffer[length + 1] = '\0';
     m_currentSection->addLine(lineBuffer);
   }
 }
@@ -528,30 +535,50 @@ void Document::parseSectionShaderSource() {
 bool Document::parse(const TestCaseInfo &info) {
   bool result = true;
 
-  FILE *configFile = fopen(info.vfxFile.c_str(), "r");
+  FILE *configFile = fopen(info.vfxFile.c_str(), "rb");
   if (configFile) {
     setFileName(info.vfxFile);
-    char lineBuf[MaxLineBufSize];
-    char *linePtr = nullptr;
 
-    while (true) {
-      linePtr = fgets(lineBuf, MaxLineBufSize, configFile);
+    // Read the whole file into one buffer up front and split it into lines in place, so the section parsers can
+    // work on pointers into the buffer instead of copying every line through an intermediate stream.
+    fseek(configFile, 0, SEEK_END);
+    const long fileSize = ftell(configFile);
+    fseek(configFile, 0, SEEK_SET);
+    m_fileBuffer.resize(fileSize + 1);
+    const size_t readSize = fread(m_fileBuffer.data(), 1, fileSize, configFile);
+    fclose(configFile);
+    m_fileBuffer[readSize] = '\0';
+
+    char *const bufferEnd = m_fileBuffer.data() + readSize;
+    for (char *linePtr = m_fileBuffer.data(); linePtr != bufferEnd;) {
+      char *lineEnd = static_cast<char *>(memchr(linePtr, '\n', bufferEnd - linePtr));
+      char *nextLine = bufferEnd;
+      if (lineEnd) {
+        *lineEnd = '\0';
+        nextLine = lineEnd + 1;
+      }
 
-      if (!linePtr) {
-        result = endSection();
-        break;
-      } else {
-        result = macroSubstituteLine(linePtr, m_currentLineNum + 1, &info.macros, MaxLineBufSize);
-        if (!result)
-          break;
+      if (!info.macros.empty()) {
+        // Macro substitution can grow a line beyond the room it has in the file buffer, so substituted lines get
+        // their own stably allocated storage, which must live until the section they belong to is ended.
+        VFX_ASSERT(strlen(linePtr) < MaxLineBufSize);
+        m_macroSubstitutedLines.emplace_back(MaxLineBufSize, '\0');
+        char *substitutedLine = &m_macroSubstitutedLines.back()[0];
+        strcpy(substitutedLine, linePtr);
+        result = macroSubstituteLine(substitutedLine, m_currentLineNum + 1, &info.macros, MaxLineBufSize);
+        linePtr = substitutedLine;
+      }
 
+      if (result)
         result = parseLine(linePtr);
-        if (!result)
-          break;
-      }
+      if (!result)
+        break;
+
+      linePtr = nextLine;
     }
 
-    fclose(configFile);
+    if (result)
+      result = endSection();
 
     if (result)
       result = validate();
@@ -760,7 +787,7 @@ bool parseIVec4(char *str, unsigned lineNum, IUFValue *output) {
   if (p0x)
     isHex = true;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   unsigned numberId = 0;
   while (number) {
     result = true;
@@ -769,7 +796,7 @@ bool parseIVec4(char *str, unsigned lineNum, IUFValue *output) {
       output->uVec4[numberId] = strtoul(number, nullptr, 0);
     else
       output->iVec4[numberId] = strtol(number, nullptr, 0);
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
     ++numberId;
   }
 
@@ -798,7 +825,7 @@ bool parseI64Vec2(char *str, unsigned lineNum, IUFValue *output) {
   if (p0x)
     isHex = true;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   unsigned numberId = 0;
   while (number) {
     result = true;
@@ -807,7 +834,7 @@ bool parseI64Vec2(char *str, unsigned lineNum, IUFValue *output) {
       output->i64Vec2[numberId] = strtoull(number, nullptr, 0);
     else
       output->i64Vec2[numberId] = strtoll(number, nullptr, 0);
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
     ++numberId;
   }
 
@@ -831,7 +858,7 @@ bool parseFVec4(char *str, unsigned lineNum, IUFValue *output) {
   VFX_ASSERT(output);
   bool result = false;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   unsigned numberId = 0;
   while (number) {
     result = true;
@@ -839,7 +866,7 @@ bool parseFVec4(char *str, unsigned lineNum, IUFValue *output) {
 
     output->fVec4[numberId] = static_cast<float>(strtod(number, nullptr));
 
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
     ++numberId;
   }
 
@@ -862,7 +889,7 @@ bool parseF16Vec4(char *str, unsigned lineNum, IUFValue *output) {
   VFX_ASSERT(output);
   bool result = false;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   unsigned numberId = 0;
   while (number) {
     result = true;
@@ -873,7 +900,7 @@ bool parseF16Vec4(char *str, unsigned lineNum, IUFValue *output) {
     v16.FromFloat32(v);
     output->f16Vec4[numberId] = v16;
 
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
     ++numberId;
   }
 
@@ -897,7 +924,7 @@ bool parseDVec2(char *str, unsigned lineNum, IUFValue *output) {
   VFX_ASSERT(output);
   bool result = false;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   unsigned numberId = 0;
   while (number) {
     result = true;
@@ -905,7 +932,7 @@ bool parseDVec2(char *str, unsigned lineNum, IUFValue *output) {
 
     output->dVec2[numberId] = strtod(number, nullptr);
 
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
     ++numberId;
   }
 
@@ -928,7 +955,7 @@ bool parseDVec2(char *str, unsigned lineNum, IUFValue *output) {
 bool parseIArray(char *str, unsigned lineNum, bool isSign, std::vector<uint8_t> &bufMem) {
   bool result = true;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   while (number) {
     bool isHex = false;
     char *p0x = strstr(number, "0x");
@@ -950,7 +977,7 @@ bool parseIArray(char *str, unsigned lineNum, bool isSign, std::vector<uint8_t>
     for (unsigned i = 0; i < sizeof(val); ++i)
       bufMem.push_back(val[i]);
 
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
   }
 
   return result;
@@ -967,7 +994,7 @@ bool parseIArray(char *str, unsigned lineNum, bool isSign, std::vector<uint8_t>
 bool parseI64Array(char *str, unsigned lineNum, bool isSign, std::vector<uint8_t> &bufMem) {
   bool result = true;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   while (number) {
     bool isHex = false;
     char *p0x = strstr(number, "0x");
@@ -990,7 +1017,7 @@ bool parseI64Array(char *str, unsigned lineNum, bool isSign, std::vector<uint8_t
     for (unsigned i = 0; i < sizeof(val); ++i)
       bufMem.push_back(val[i]);
 
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
   }
 
   return result;
@@ -1006,7 +1033,7 @@ bool parseI64Array(char *str, unsigned lineNum, bool isSign, std::vector<uint8_t
 bool parseFArray(char *str, unsigned lineNum, std::vector<uint8_t> &bufMem) {
   bool result = true;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   while (number) {
     union {
       float fVal;
@@ -1019,7 +1046,7 @@ bool parseFArray(char *str, unsigned lineNum, std::vector<uint8_t> &bufMem) {
     for (unsigned i = 0; i < sizeof(val); ++i)
       bufMem.push_back(val[i]);
 
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
   }
 
   return result;
@@ -1035,7 +1062,7 @@ bool parseFArray(char *str, unsigned lineNum, std::vector<uint8_t> &bufMem) {
 bool parseF16Array(char *str, unsigned lineNum, std::vector<uint8_t> &bufMem) {
   bool result = true;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   while (number) {
     union {
       Float16Bits fVal;
@@ -1051,7 +1078,7 @@ bool parseF16Array(char *str, unsigned lineNum, std::vector<uint8_t> &bufMem) {
     for (unsigned i = 0; i < sizeof(val); ++i)
       bufMem.push_back(val[i]);
 
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
   }
 
   return result;
@@ -1067,7 +1094,7 @@ bool parseF16Array(char *str, unsigned lineNum, std::vector<uint8_t> &bufMem) {
 bool parseDArray(char *str, unsigned lineNum, std::vector<uint8_t> &bufMem) {
   bool result = true;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   while (number) {
     union {
       double dVal;
@@ -1080,7 +1107,7 @@ bool parseDArray(char *str, unsigned lineNum, std::vector<uint8_t> &bufMem) {
     for (unsigned i = 0; i < sizeof(val); ++i)
       bufMem.push_back(val[i]);
 
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
   }
 
   return result;
@@ -1102,7 +1129,7 @@ bool parseBinding(char *str, unsigned lineNum, IUFValue *output) {
   if (p0x)
     isHex = true;
 
-  char *number = strtok(str, ", ");
+  char *number = vfxStrtok(str, ", ");
   unsigned numberId = 0;
   while (number) {
     result = true;
@@ -1117,7 +1144,7 @@ bool parseBinding(char *str, unsigned lineNum, IUFValue *output) {
       else
         output->iVec4[numberId] = strtol(number, nullptr, 0);
     }
-    number = strtok(nullptr, ", ");
+    number = vfxStrtok(nullptr, ", ");
     ++numberId;
   }
 
@@ -1380,11 +1407,68 @@ bool VFXAPI vfxParseFile(const char *filename, unsigned int numMacro, const char
   return ret;
 }
 
+// =====================================================================================================================
+// Parses a batch of input files of one document type concurrently across a pool of worker threads.
+//
+// Per-file results are written at the file's index in the output arrays. As with vfxParseFile, each error message
+// points into its document's storage, so every returned document must be closed with vfxCloseDoc even when its
+// parse failed. The shared parser tables (section info, member tables, enum maps) are built exactly once under
+// function-local statics on first document construction and are read-only afterwards, so the workers can share
+// them without further synchronization.
+//
+// @param numFiles : Number of input files
+// @param pFilenames : Input file names
+// @param numMacro : Number of marcos
+// @param pMacros : Marco list, Two strings are a macro, and macro will be extract before parse
+// @param type : Document type, common to all files
+// @param [out] ppDocs : Per-file document handles
+// @param [out] ppErrorMsgs : Per-file error messages
+bool VFXAPI vfxParseFiles(unsigned int numFiles, const char *pFilenames[], unsigned int numMacro,
+                          const char *pMacros[], VfxDocType type, void **ppDocs, const char **ppErrorMsgs) {
+  std::atomic<unsigned> nextFile(0);
+  std::atomic<bool> allParsed(true);
+
+  auto worker = [&] {
+    for (;;) {
+      const unsigned fileIndex = nextFile.fetch_add(1);
+      if (fileIndex >= numFiles)
+        break;
+      if (!vfxParseFile(pFilenames[fileIndex], numMacro, pMacros, type, &ppDocs[fileIndex], &ppErrorMsgs[fileIndex]))
+        allParsed = false;
+    }
+  };
+
+  unsigned threadCount = std::thread::hardware_concurrency();
+  if (threadCount == 0)
+    threadCount = 1;
+  if (threadCount > numFiles)
+    threadCount = numFiles;
+
+  if (threadCount <= 1) {
+    worker();
+  } else {
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threadCount; ++i)
+      workers.emplace_back(worker);
+    for (auto &oneWorker : workers)
+      oneWorker.join();
+  }
+
+  return allParsed;
+}
+
 // =====================================================================================================================
 // Closes document handle
 //
 // @param doc : Document handle
 void VFXAPI vfxCloseDoc(void *doc) {
+#if VFX_SUPPORT_VK_PIPELINE
+  // A compiled pipeline document is one flat allocation rather than a Document object.
+  if (*static_cast<const unsigned *>(doc) == VfxPipelineBinaryMagic) {
+    VFX_DELETE_ARRAY static_cast<uint8_t *>(doc);
+    return;
+  }
+#endif
   delete reinterpret_cast<Document *>(doc);
 }
 
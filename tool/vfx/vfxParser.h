@@ -32,14 +32,16 @@
 #pragma once
 
 #include "vfxSection.h"
+#include <list>
 #include <map>
-#include <sstream>
 #include <stddef.h>
 #include <string.h>
 #include <vector>
 
 namespace Vfx {
 
+extern void initBaseSections();
+
 typedef std::map<std::string, std::string> MacroDefinition;
 
 // =====================================================================================================================
@@ -104,7 +106,9 @@ protected:
   bool m_isValidVfxFile;                          // If VFX file is valid
   Section *m_currentSection;                      // Current section
   unsigned m_currentLineNum;                      // Current line number
-  std::stringstream m_currentSectionStringBuffer; // Current section string buffer
+  std::vector<char> m_fileBuffer;                 // Whole VFX file contents, mutated in place while parsing
+  std::vector<char *> m_currentSectionLines;      // Lines of current section, pointing into m_fileBuffer
+  std::list<std::string> m_macroSubstitutedLines; // Stable storage for lines changed by macro substitution
   unsigned m_currentSectionLineNum;               // Current section line number
 };
 
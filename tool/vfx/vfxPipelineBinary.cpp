@@ -0,0 +1,456 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2020 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+***********************************************************************************************************************
+* @file  vfxPipelineBinary.cpp
+* @brief Contains implementation of the compiled (binary) form of a pipeline document
+***********************************************************************************************************************
+*/
+#include "vfx.h"
+
+#if VFX_SUPPORT_VK_PIPELINE
+
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace Vkgc;
+
+namespace Vfx {
+
+// =====================================================================================================================
+// Helper that flattens a VfxPipelineState into one relocatable blob, headed by a VfxPipelineBinaryHeader.
+//
+// Every pointer member in the blob is replaced by the byte offset of its pointee from the start of the blob (0 for
+// null), so loading the document back is a single file read plus pointer fix-up. Struct layouts are stored as-is,
+// which makes the binary specific to the ABI it was written with; the header carries enough information for the
+// loader to reject a binary written with different layouts.
+class PipelineBinaryWriter {
+public:
+  void write(const VfxPipelineState *pipelineState);
+  bool writeToFile(const char *filename);
+
+private:
+  size_t appendBytes(const void *data, size_t size);
+  void setOffset(size_t slot, size_t offset);
+  void writePointee(size_t slot, const void *data, size_t size);
+  void writeShaderInfo(size_t infoOffset, const PipelineShaderInfo *shaderInfo);
+  void writeResourceMappingNodes(size_t slot, const ResourceMappingNode *nodes, unsigned nodeCount);
+  void writeVertexInput(size_t slot, const VkPipelineVertexInputStateCreateInfo *vertexInput);
+
+  std::vector<uint8_t> m_data; // Blob under construction
+};
+
+// =====================================================================================================================
+// Appends a range of bytes to the blob and returns its offset. The range is aligned to pointer size, which is
+// sufficient for every struct stored in the blob.
+//
+// @param data : Bytes to append
+// @param size : Size of the range in bytes
+size_t PipelineBinaryWriter::appendBytes(const void *data, size_t size) {
+  m_data.resize((m_data.size() + sizeof(void *) - 1) & ~(sizeof(void *) - 1), 0);
+  const size_t offset = m_data.size();
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  m_data.insert(m_data.end(), bytes, bytes + size);
+  return offset;
+}
+
+// =====================================================================================================================
+// Stores an offset into a pointer-sized slot of the blob, replacing the raw pointer copied there.
+//
+// @param slot : Offset of the pointer member within the blob
+// @param offset : Offset of the pointee (0 for null)
+void PipelineBinaryWriter::setOffset(size_t slot, size_t offset) {
+  *reinterpret_cast<uintptr_t *>(&m_data[slot]) = offset;
+}
+
+// =====================================================================================================================
+// Appends the pointee of a pointer member and stores its offset into the member's slot.
+//
+// @param slot : Offset of the pointer member within the blob
+// @param data : Pointee (can be null)
+// @param size : Size of the pointee in bytes
+void PipelineBinaryWriter::writePointee(size_t slot, const void *data, size_t size) {
+  if (data && size > 0)
+    setOffset(slot, appendBytes(data, size));
+  else
+    setOffset(slot, 0);
+}
+
+// =====================================================================================================================
+// Appends the pointees of one pipeline shader info whose struct has already been appended.
+//
+// @param infoOffset : Offset of the PipelineShaderInfo struct within the blob
+// @param shaderInfo : Shader info to flatten
+void PipelineBinaryWriter::writeShaderInfo(size_t infoOffset, const PipelineShaderInfo *shaderInfo) {
+  // Module data is rebuilt by the client after load, it never goes into the binary.
+  setOffset(infoOffset + offsetof(PipelineShaderInfo, pModuleData), 0);
+
+  writePointee(infoOffset + offsetof(PipelineShaderInfo, pEntryTarget), shaderInfo->pEntryTarget,
+               shaderInfo->pEntryTarget ? strlen(shaderInfo->pEntryTarget) + 1 : 0);
+
+  if (shaderInfo->pSpecializationInfo) {
+    const VkSpecializationInfo *specializationInfo = shaderInfo->pSpecializationInfo;
+    const size_t specOffset = appendBytes(specializationInfo, sizeof(VkSpecializationInfo));
+    setOffset(infoOffset + offsetof(PipelineShaderInfo, pSpecializationInfo), specOffset);
+    writePointee(specOffset + offsetof(VkSpecializationInfo, pMapEntries), specializationInfo->pMapEntries,
+                 specializationInfo->mapEntryCount * sizeof(VkSpecializationMapEntry));
+    writePointee(specOffset + offsetof(VkSpecializationInfo, pData), specializationInfo->pData,
+                 specializationInfo->dataSize);
+  } else
+    setOffset(infoOffset + offsetof(PipelineShaderInfo, pSpecializationInfo), 0);
+
+  if (shaderInfo->pDescriptorRangeValues && shaderInfo->descriptorRangeValueCount > 0) {
+    const size_t valuesOffset = appendBytes(shaderInfo->pDescriptorRangeValues,
+                                            shaderInfo->descriptorRangeValueCount * sizeof(DescriptorRangeValue));
+    setOffset(infoOffset + offsetof(PipelineShaderInfo, pDescriptorRangeValues), valuesOffset);
+    for (unsigned i = 0; i < shaderInfo->descriptorRangeValueCount; ++i) {
+      const DescriptorRangeValue &value = shaderInfo->pDescriptorRangeValues[i];
+      // A static descriptor is 4 dwords; a YCbCr sampler appends 4 more dwords of metadata.
+      const unsigned descriptorSize = value.type != ResourceMappingNodeType::DescriptorYCbCrSampler ? 16 : 32;
+      writePointee(valuesOffset + i * sizeof(DescriptorRangeValue) + offsetof(DescriptorRangeValue, pValue),
+                   value.pValue, value.arraySize * descriptorSize);
+    }
+  } else
+    setOffset(infoOffset + offsetof(PipelineShaderInfo, pDescriptorRangeValues), 0);
+
+  writeResourceMappingNodes(infoOffset + offsetof(PipelineShaderInfo, pUserDataNodes), shaderInfo->pUserDataNodes,
+                            shaderInfo->userDataNodeCount);
+}
+
+// =====================================================================================================================
+// Appends an array of resource mapping nodes, recursing into descriptor tables.
+//
+// @param slot : Offset of the pointer member that references the array
+// @param nodes : Node array (can be null)
+// @param nodeCount : Number of nodes in the array
+void PipelineBinaryWriter::writeResourceMappingNodes(size_t slot, const ResourceMappingNode *nodes,
+                                                     unsigned nodeCount) {
+  if (!nodes || nodeCount == 0) {
+    setOffset(slot, 0);
+    return;
+  }
+
+  const size_t arrayOffset = appendBytes(nodes, nodeCount * sizeof(ResourceMappingNode));
+  setOffset(slot, arrayOffset);
+  for (unsigned i = 0; i < nodeCount; ++i) {
+    if (nodes[i].type == ResourceMappingNodeType::DescriptorTableVaPtr) {
+      writeResourceMappingNodes(arrayOffset + i * sizeof(ResourceMappingNode) +
+                                    offsetof(ResourceMappingNode, tablePtr.pNext),
+                                nodes[i].tablePtr.pNext, nodes[i].tablePtr.nodeCount);
+    }
+  }
+}
+
+// =====================================================================================================================
+// Appends the vertex input state and its arrays.
+//
+// @param slot : Offset of the pVertexInput member within the blob
+// @param vertexInput : Vertex input state (can be null)
+void PipelineBinaryWriter::writeVertexInput(size_t slot, const VkPipelineVertexInputStateCreateInfo *vertexInput) {
+  if (!vertexInput) {
+    setOffset(slot, 0);
+    return;
+  }
+
+  const size_t inputOffset = appendBytes(vertexInput, sizeof(VkPipelineVertexInputStateCreateInfo));
+  setOffset(slot, inputOffset);
+  writePointee(inputOffset + offsetof(VkPipelineVertexInputStateCreateInfo, pVertexBindingDescriptions),
+               vertexInput->pVertexBindingDescriptions,
+               vertexInput->vertexBindingDescriptionCount * sizeof(VkVertexInputBindingDescription));
+  writePointee(inputOffset + offsetof(VkPipelineVertexInputStateCreateInfo, pVertexAttributeDescriptions),
+               vertexInput->pVertexAttributeDescriptions,
+               vertexInput->vertexAttributeDescriptionCount * sizeof(VkVertexInputAttributeDescription));
+
+  // The only extension struct the pipeline document schema can put on the chain is the vertex divisor state.
+  struct VkStructHeader {
+    VkStructureType type;
+    VkStructHeader *next;
+  };
+  const VkPipelineVertexInputDivisorStateCreateInfoEXT *divisorState = nullptr;
+  for (const VkStructHeader *header = reinterpret_cast<const VkStructHeader *>(vertexInput->pNext); header;
+       header = header->next) {
+    if (header->type == VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_DIVISOR_STATE_CREATE_INFO_EXT) {
+      divisorState = reinterpret_cast<const VkPipelineVertexInputDivisorStateCreateInfoEXT *>(header);
+      break;
+    }
+  }
+
+  if (divisorState) {
+    const size_t divisorOffset = appendBytes(divisorState, sizeof(VkPipelineVertexInputDivisorStateCreateInfoEXT));
+    setOffset(inputOffset + offsetof(VkPipelineVertexInputStateCreateInfo, pNext), divisorOffset);
+    setOffset(divisorOffset + offsetof(VkPipelineVertexInputDivisorStateCreateInfoEXT, pNext), 0);
+    writePointee(divisorOffset + offsetof(VkPipelineVertexInputDivisorStateCreateInfoEXT, pVertexBindingDivisors),
+                 divisorState->pVertexBindingDivisors,
+                 divisorState->vertexBindingDivisorCount * sizeof(VkVertexInputBindingDivisorDescriptionEXT));
+  } else
+    setOffset(inputOffset + offsetof(VkPipelineVertexInputStateCreateInfo, pNext), 0);
+}
+
+// =====================================================================================================================
+// Flattens a whole pipeline state into the blob.
+//
+// @param pipelineState : Pipeline state to flatten
+void PipelineBinaryWriter::write(const VfxPipelineState *pipelineState) {
+  VfxPipelineBinaryHeader header = {};
+  header.magic = VfxPipelineBinaryMagic;
+  header.version = VfxPipelineBinaryVersion;
+  header.stateSize = sizeof(VfxPipelineState);
+  header.pointerSize = sizeof(void *);
+  appendBytes(&header, sizeof(header));
+
+  const size_t stateOffset = appendBytes(pipelineState, sizeof(VfxPipelineState));
+  reinterpret_cast<VfxPipelineBinaryHeader *>(&m_data[0])->stateOffset = static_cast<unsigned>(stateOffset);
+
+  // Graphics pipeline build info: zero the client runtime pointers, then flatten the per-stage infos and the
+  // vertex input state.
+  const size_t gfxOffset = stateOffset + offsetof(VfxPipelineState, gfxPipelineInfo);
+  setOffset(gfxOffset + offsetof(GraphicsPipelineBuildInfo, pInstance), 0);
+  setOffset(gfxOffset + offsetof(GraphicsPipelineBuildInfo, pUserData), 0);
+  setOffset(gfxOffset + offsetof(GraphicsPipelineBuildInfo, pfnOutputAlloc), 0);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38 || LLPC_ENABLE_SHADER_CACHE
+  setOffset(gfxOffset + offsetof(GraphicsPipelineBuildInfo, pShaderCache), 0);
+#endif
+  writeShaderInfo(gfxOffset + offsetof(GraphicsPipelineBuildInfo, vs), &pipelineState->gfxPipelineInfo.vs);
+  writeShaderInfo(gfxOffset + offsetof(GraphicsPipelineBuildInfo, tcs), &pipelineState->gfxPipelineInfo.tcs);
+  writeShaderInfo(gfxOffset + offsetof(GraphicsPipelineBuildInfo, tes), &pipelineState->gfxPipelineInfo.tes);
+  writeShaderInfo(gfxOffset + offsetof(GraphicsPipelineBuildInfo, gs), &pipelineState->gfxPipelineInfo.gs);
+  writeShaderInfo(gfxOffset + offsetof(GraphicsPipelineBuildInfo, fs), &pipelineState->gfxPipelineInfo.fs);
+  writeVertexInput(gfxOffset + offsetof(GraphicsPipelineBuildInfo, pVertexInput),
+                   pipelineState->gfxPipelineInfo.pVertexInput);
+
+  // Compute pipeline build info
+  const size_t compOffset = stateOffset + offsetof(VfxPipelineState, compPipelineInfo);
+  setOffset(compOffset + offsetof(ComputePipelineBuildInfo, pInstance), 0);
+  setOffset(compOffset + offsetof(ComputePipelineBuildInfo, pUserData), 0);
+  setOffset(compOffset + offsetof(ComputePipelineBuildInfo, pfnOutputAlloc), 0);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38 || LLPC_ENABLE_SHADER_CACHE
+  setOffset(compOffset + offsetof(ComputePipelineBuildInfo, pShaderCache), 0);
+#endif
+  writeShaderInfo(compOffset + offsetof(ComputePipelineBuildInfo, cs), &pipelineState->compPipelineInfo.cs);
+
+  // Shader stages with their SPIR-V binaries
+  if (pipelineState->stages && pipelineState->numStages > 0) {
+    const size_t stagesOffset = appendBytes(pipelineState->stages, pipelineState->numStages * sizeof(ShaderSource));
+    setOffset(stateOffset + offsetof(VfxPipelineState, stages), stagesOffset);
+    for (unsigned i = 0; i < pipelineState->numStages; ++i) {
+      writePointee(stagesOffset + i * sizeof(ShaderSource) + offsetof(ShaderSource, pData),
+                   pipelineState->stages[i].pData, pipelineState->stages[i].dataSize);
+    }
+  } else
+    setOffset(stateOffset + offsetof(VfxPipelineState, stages), 0);
+
+  reinterpret_cast<VfxPipelineBinaryHeader *>(&m_data[0])->size = static_cast<unsigned>(m_data.size());
+}
+
+// =====================================================================================================================
+// Writes the blob to the specified file.
+//
+// @param filename : Name of the file to write
+bool PipelineBinaryWriter::writeToFile(const char *filename) {
+  FILE *file = fopen(filename, "wb");
+  if (!file)
+    return false;
+  const bool result = fwrite(m_data.data(), 1, m_data.size(), file) == m_data.size();
+  fclose(file);
+  return result;
+}
+
+// =====================================================================================================================
+// Converts the offset stored in a pointer member of a loaded blob back to a pointer into the blob.
+//
+// @param base : Start of the blob
+// @param [in/out] member : Pointer member holding an offset, replaced by the pointer it encodes
+template <typename T> static void relocate(uint8_t *base, T &member) {
+  const uintptr_t offset = reinterpret_cast<uintptr_t>(member);
+  member = offset != 0 ? reinterpret_cast<T>(base + offset) : nullptr;
+}
+
+// =====================================================================================================================
+// Fixes up an array of resource mapping nodes, recursing into descriptor tables.
+//
+// @param base : Start of the blob
+// @param [in/out] nodes : Pointer member referencing the node array
+// @param nodeCount : Number of nodes in the array
+static void relocateResourceMappingNodes(uint8_t *base, const ResourceMappingNode *&nodes, unsigned nodeCount) {
+  relocate(base, nodes);
+  for (unsigned i = 0; nodes && i < nodeCount; ++i) {
+    auto node = const_cast<ResourceMappingNode *>(&nodes[i]);
+    if (node->type == ResourceMappingNodeType::DescriptorTableVaPtr)
+      relocateResourceMappingNodes(base, node->tablePtr.pNext, node->tablePtr.nodeCount);
+  }
+}
+
+// =====================================================================================================================
+// Fixes up one pipeline shader info of a loaded blob.
+//
+// @param base : Start of the blob
+// @param [in/out] shaderInfo : Shader info to fix up
+static void relocateShaderInfo(uint8_t *base, PipelineShaderInfo *shaderInfo) {
+  relocate(base, shaderInfo->pModuleData);
+  relocate(base, shaderInfo->pEntryTarget);
+
+  relocate(base, shaderInfo->pSpecializationInfo);
+  if (shaderInfo->pSpecializationInfo) {
+    auto specializationInfo = const_cast<VkSpecializationInfo *>(shaderInfo->pSpecializationInfo);
+    relocate(base, specializationInfo->pMapEntries);
+    relocate(base, specializationInfo->pData);
+  }
+
+  relocate(base, shaderInfo->pDescriptorRangeValues);
+  for (unsigned i = 0; shaderInfo->pDescriptorRangeValues && i < shaderInfo->descriptorRangeValueCount; ++i)
+    relocate(base, shaderInfo->pDescriptorRangeValues[i].pValue);
+
+  relocateResourceMappingNodes(base, shaderInfo->pUserDataNodes, shaderInfo->userDataNodeCount);
+}
+
+// =====================================================================================================================
+// Fixes up all pointer members of a loaded blob, mirroring the traversal of PipelineBinaryWriter.
+//
+// @param blob : Start of the blob
+static void relocatePipelineBinary(uint8_t *blob) {
+  const auto header = reinterpret_cast<const VfxPipelineBinaryHeader *>(blob);
+  auto pipelineState = reinterpret_cast<VfxPipelineState *>(blob + header->stateOffset);
+
+  auto gfxPipelineInfo = &pipelineState->gfxPipelineInfo;
+  relocateShaderInfo(blob, &gfxPipelineInfo->vs);
+  relocateShaderInfo(blob, &gfxPipelineInfo->tcs);
+  relocateShaderInfo(blob, &gfxPipelineInfo->tes);
+  relocateShaderInfo(blob, &gfxPipelineInfo->gs);
+  relocateShaderInfo(blob, &gfxPipelineInfo->fs);
+  relocate(blob, gfxPipelineInfo->pVertexInput);
+  if (gfxPipelineInfo->pVertexInput) {
+    auto vertexInput = const_cast<VkPipelineVertexInputStateCreateInfo *>(gfxPipelineInfo->pVertexInput);
+    relocate(blob, vertexInput->pVertexBindingDescriptions);
+    relocate(blob, vertexInput->pVertexAttributeDescriptions);
+    relocate(blob, vertexInput->pNext);
+    if (vertexInput->pNext) {
+      // The writer only ever stores the vertex divisor state on the chain.
+      auto divisorState =
+          reinterpret_cast<VkPipelineVertexInputDivisorStateCreateInfoEXT *>(const_cast<void *>(vertexInput->pNext));
+      relocate(blob, divisorState->pVertexBindingDivisors);
+    }
+  }
+
+  relocateShaderInfo(blob, &pipelineState->compPipelineInfo.cs);
+
+  relocate(blob, pipelineState->stages);
+  for (unsigned i = 0; pipelineState->stages && i < pipelineState->numStages; ++i)
+    relocate(blob, pipelineState->stages[i].pData);
+}
+
+// =====================================================================================================================
+// Checks whether a file starts with the compiled pipeline document magic number.
+//
+// @param filename : Name of the file to check
+bool VFXAPI vfxIsPipelineBinaryFile(const char *filename) {
+  unsigned magic = 0;
+  FILE *file = fopen(filename, "rb");
+  if (!file)
+    return false;
+  const bool isBinary = fread(&magic, sizeof(magic), 1, file) == 1 && magic == VfxPipelineBinaryMagic;
+  fclose(file);
+  return isBinary;
+}
+
+// =====================================================================================================================
+// Compiles a parsed pipeline document to its binary form and writes it to the specified file.
+//
+// @param doc : Document handle gotten from vfxParseFile
+// @param filename : Name of the file to write
+// @param [out] ppErrorMsg : Error message
+bool VFXAPI vfxCompilePipelineBinary(void *doc, const char *filename, const char **ppErrorMsg) {
+  // NOTE: Unlike a parsed document there is no object to own the error message, so it is kept in a static that
+  // stays valid until the next call.
+  static std::string errorMsg;
+  errorMsg.clear();
+
+  VfxPipelineStatePtr pipelineState = nullptr;
+  vfxGetPipelineDoc(doc, &pipelineState);
+
+  PipelineBinaryWriter writer;
+  writer.write(pipelineState);
+  bool result = writer.writeToFile(filename);
+  if (!result)
+    errorMsg = std::string("Fails to write ") + filename;
+
+  *ppErrorMsg = errorMsg.c_str();
+  return result;
+}
+
+// =====================================================================================================================
+// Loads a compiled pipeline document. The returned handle can be passed to vfxGetPipelineDoc and vfxCloseDoc like
+// a handle gotten from vfxParseFile.
+//
+// @param filename : Name of the file to load
+// @param [out] ppDoc : Document handle
+// @param [out] ppErrorMsg : Error message
+bool VFXAPI vfxLoadPipelineBinary(const char *filename, void **ppDoc, const char **ppErrorMsg) {
+  // NOTE: Unlike a parsed document there is no object to own the error message, so it is kept in a static that
+  // stays valid until the next call.
+  static std::string errorMsg;
+  errorMsg.clear();
+  *ppDoc = nullptr;
+
+  FILE *file = fopen(filename, "rb");
+  if (!file)
+    errorMsg = std::string("Fails to open ") + filename;
+  else {
+    fseek(file, 0, SEEK_END);
+    const long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (fileSize < static_cast<long>(sizeof(VfxPipelineBinaryHeader)))
+      errorMsg = std::string(filename) + " is not a compiled pipeline document";
+    else {
+      uint8_t *blob = VFX_NEW uint8_t[fileSize];
+      const size_t readSize = fread(blob, 1, fileSize, file);
+
+      const auto header = reinterpret_cast<const VfxPipelineBinaryHeader *>(blob);
+      if (readSize != static_cast<size_t>(fileSize) || header->magic != VfxPipelineBinaryMagic ||
+          header->size != readSize)
+        errorMsg = std::string(filename) + " is not a compiled pipeline document";
+      else if (header->version != VfxPipelineBinaryVersion || header->stateSize != sizeof(VfxPipelineState) ||
+               header->pointerSize != sizeof(void *))
+        errorMsg = std::string(filename) + " was compiled with an incompatible version, recompile it";
+      else {
+        relocatePipelineBinary(blob);
+        *ppDoc = blob;
+      }
+
+      if (!*ppDoc)
+        VFX_DELETE_ARRAY blob;
+    }
+    fclose(file);
+  }
+
+  *ppErrorMsg = errorMsg.c_str();
+  return *ppDoc != nullptr;
+}
+
+} // namespace Vfx
+
+#endif
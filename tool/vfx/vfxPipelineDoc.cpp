@@ -305,6 +305,12 @@ bool PipelineDocument::getPtrOfSubSection(Section *section, unsigned lineNum, co
 // @param doc : Document handle
 // @param [out] pipelineState : Pointer of struct VfxPipelineState
 void VFXAPI vfxGetPipelineDoc(void *doc, VfxPipelineStatePtr *pipelineState) {
+  // The handle is either a compiled pipeline document (identified by its leading magic number) or a parsed one.
+  if (*static_cast<const unsigned *>(doc) == VfxPipelineBinaryMagic) {
+    auto header = static_cast<const VfxPipelineBinaryHeader *>(doc);
+    *pipelineState = reinterpret_cast<VfxPipelineState *>(static_cast<uint8_t *>(doc) + header->stateOffset);
+    return;
+  }
   *pipelineState = reinterpret_cast<PipelineDocument *>(doc)->getDocument();
 }
 
@@ -33,6 +33,7 @@
 #include "vfxEnumsConverter.h"
 #include "vfxParser.h"
 #include <inttypes.h>
+#include <mutex>
 
 #ifndef VFX_DISABLE_SPVGEN
 #if VFX_INSIDE_SPVGEN
@@ -84,7 +85,12 @@ public:
   };
 };
 
-static ParserInit Init;
+// =====================================================================================================================
+// Initialize the common sections and enum map. Construction happens on first document use rather than at process
+// start-up, so runs that never parse a VFX document do not pay for building the tables.
+void initBaseSections() {
+  static ParserInit init;
+}
 
 // =====================================================================================================================
 // Constructs an Section object.
@@ -179,15 +185,12 @@ void Section::initSectionInfo() {
 // @param [out] errorMsg : Error message
 bool Section::getMemberType(unsigned lineNum, const char *memberName, MemberType *valueType, std::string *errorMsg) {
   bool result = false;
-  for (unsigned i = 0; i < m_tableSize; ++i) {
-    if (m_memberTable[i].memberName && strcmp(memberName, m_memberTable[i].memberName) == 0) {
-      result = true;
+  const int memberIdx = findMember(memberName);
+  if (memberIdx >= 0) {
+    result = true;
 
-      if (valueType)
-        *valueType = m_memberTable[i].memberType;
-
-      break;
-    }
+    if (valueType)
+      *valueType = m_memberTable[memberIdx].memberType;
   }
 
   if (!result) {
@@ -197,6 +200,34 @@ bool Section::getMemberType(unsigned lineNum, const char *memberName, MemberType
   return result;
 }
 
+// =====================================================================================================================
+// Finds a member in the member address table by its string name. Returns the member's table index, or -1 if the name
+// is unknown. The linear strcmp scan is replaced by an index built once per member table; all instances of a section
+// class share one statically allocated table, so they share its index too.
+//
+// @param memberName : Member string name
+int Section::findMember(const char *memberName) const {
+  typedef std::map<std::string, unsigned, std::less<>> MemberIndex;
+  static std::map<const StrToMemberAddr *, MemberIndex> memberIndices;
+  static std::mutex memberIndicesLock;
+
+  // Take the lock only to look up (and build, first time) the per-table index; once built the index is never
+  // modified, so the lookup below can run lock-free even when vfxParseFiles parses documents concurrently.
+  // std::map node stability keeps the reference valid while other tables are inserted.
+  std::unique_lock<std::mutex> lock(memberIndicesLock);
+  MemberIndex &index = memberIndices[m_memberTable];
+  if (index.empty()) {
+    for (unsigned i = 0; i < m_tableSize; ++i) {
+      if (m_memberTable[i].memberName)
+        index[m_memberTable[i].memberName] = i;
+    }
+  }
+  lock.unlock();
+
+  auto it = index.find(memberName);
+  return it != index.end() ? static_cast<int>(it->second) : -1;
+}
+
 // =====================================================================================================================
 // Is this member a section object.
 //
@@ -209,16 +240,14 @@ bool Section::isSection(unsigned lineNum, const char *memberName, bool *output,
                         std::string *errorMsg) {
   bool result = false;
 
-  for (unsigned i = 0; i < m_tableSize; ++i) {
-    if (m_memberTable[i].memberName && strcmp(memberName, m_memberTable[i].memberName) == 0) {
-      result = true;
-      if (output)
-        *output = m_memberTable[i].isSection;
+  const int memberIdx = findMember(memberName);
+  if (memberIdx >= 0) {
+    result = true;
+    if (output)
+      *output = m_memberTable[memberIdx].isSection;
 
-      if (type)
-        *type = m_memberTable[i].memberType;
-      break;
-    }
+    if (type)
+      *type = m_memberTable[memberIdx].memberType;
   }
 
   if (!result) {
@@ -315,6 +315,8 @@ public:
 private:
   Section(){};
 
+  int findMember(const char *memberName) const;
+
 public:
   static std::map<std::string, SectionInfo> m_sectionInfo; // Section info
 
@@ -348,17 +350,15 @@ bool Section::getPtrOf(unsigned lineNum, const char *memberName, bool isWriteAcc
   if (isWriteAccess)
     setActive(true);
   // Search section member
-  for (unsigned i = 0; i < m_tableSize; ++i) {
-    if (strcmp(memberName, m_memberTable[i].memberName) == 0) {
-      memberAddr = getMemberAddr(i);
-      if (arrayIndex >= m_memberTable[i].arrayMaxSize) {
-        PARSE_ERROR(*errorMsg, lineNum, "Array access out of bound: %u of %s[%u]", arrayIndex, memberName,
-                    m_memberTable[i].arrayMaxSize);
-        result = false;
-      }
-      arrayMaxSize = m_memberTable[i].arrayMaxSize;
-      break;
+  const int memberIdx = findMember(memberName);
+  if (memberIdx >= 0) {
+    memberAddr = getMemberAddr(memberIdx);
+    if (arrayIndex >= m_memberTable[memberIdx].arrayMaxSize) {
+      PARSE_ERROR(*errorMsg, lineNum, "Array access out of bound: %u of %s[%u]", arrayIndex, memberName,
+                  m_memberTable[memberIdx].arrayMaxSize);
+      result = false;
     }
+    arrayMaxSize = m_memberTable[memberIdx].arrayMaxSize;
   }
 
   if (result && memberAddr == reinterpret_cast<void *>(static_cast<size_t>(VfxInvalidValue))) {
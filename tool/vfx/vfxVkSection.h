@@ -136,6 +136,9 @@ public:
 #endif
     INIT_STATE_MEMBER_NAME_TO_ADDR(SectionShaderOption, unrollThreshold, MemberTypeInt, false);
     INIT_STATE_MEMBER_NAME_TO_ADDR(SectionShaderOption, scalarThreshold, MemberTypeInt, false);
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 41
+    INIT_STATE_MEMBER_NAME_TO_ADDR(SectionShaderOption, transcendentalPrecision, MemberTypeInt, false);
+#endif
 
     VFX_ASSERT(tableItem - &m_addrTable[0] <= MemberCount);
   }
@@ -144,7 +147,7 @@ public:
   SubState &getSubStateRef() { return m_state; };
 
 private:
-  static const unsigned MemberCount = 18;
+  static const unsigned MemberCount = 19;
   static StrToMemberAddr m_addrTable[MemberCount];
 
   SubState m_state;
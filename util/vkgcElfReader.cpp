@@ -49,8 +49,6 @@ ElfReader<Elf>::ElfReader(GfxIpVersion gfxIp)
 
 // =====================================================================================================================
 template <class Elf> ElfReader<Elf>::~ElfReader() {
-  for (auto section : m_sections)
-    delete section;
   m_sections.clear();
 }
 
@@ -102,6 +100,11 @@ template <class Elf> Result ElfReader<Elf>::ReadFromBuffer(const void *buffer, s
         reinterpret_cast<const typename Elf::SectionHeader *>(data + sectionStrTableHeaderOffset);
     const unsigned sectionStrTableOffset = static_cast<unsigned>(sectionStrTableHeader->sh_offset);
 
+    // Reserve the section buffers contiguously up front; the section count is known, so the pointers handed
+    // out through getSections() and the GetSectionData*() family stay valid as the storage fills up.
+    m_sectionStorage.reserve(sectionHeaderNum);
+    m_sections.reserve(sectionHeaderNum);
+
     for (unsigned section = 0; section < sectionHeaderNum; section++) {
       // Where the header is located for this section
       const unsigned sectionOffset = sectionHeaderOffset + (section * sectionHeaderSize);
@@ -114,20 +117,17 @@ template <class Elf> Result ElfReader<Elf>::ReadFromBuffer(const void *buffer, s
 
       // Where the data is located for this section
       const unsigned sectionDataOffset = static_cast<unsigned>(sectionHeader->sh_offset);
-      auto buf = new SectionBuffer;
-
-      result = buf ? Result::Success : Result::ErrorOutOfMemory;
+      m_sectionStorage.push_back({});
+      auto buf = &m_sectionStorage.back();
 
-      if (result == Result::Success) {
-        buf->secHead = *sectionHeader;
-        buf->name = sectionName;
-        buf->data = (data + sectionDataOffset);
+      buf->secHead = *sectionHeader;
+      buf->name = sectionName;
+      buf->data = (data + sectionDataOffset);
 
-        readSize += static_cast<size_t>(sectionHeader->sh_size);
+      readSize += static_cast<size_t>(sectionHeader->sh_size);
 
-        m_sections.push_back(buf);
-        m_map[sectionName] = section;
-      }
+      m_sections.push_back(buf);
+      m_map[sectionName] = section;
     }
 
     *bufSize = readSize;
@@ -139,9 +139,66 @@ template <class Elf> Result ElfReader<Elf>::ReadFromBuffer(const void *buffer, s
   m_strtabSecIdx = GetSectionIndex(StrTabName);
   m_textSecIdx = GetSectionIndex(TextName);
 
+  if (result == Result::Success)
+    buildIndices();
+
   return result;
 }
 
+// =====================================================================================================================
+// Builds the one-time query indices over the section and symbol tables.
+//
+// The reader is immutable once ReadFromBuffer() succeeds, so the sorting-index order and the per-section symbol
+// groups can be computed a single time here rather than rederived on every query. The merge and dump paths issue
+// these queries per section (and the dumper per sorting index in a loop), which made the previous rescans O(n^2)
+// over the symbol and section tables.
+template <class Elf> void ElfReader<Elf>::buildIndices() {
+  // Section indices in section-name order, so getSectionDataBySortingIndex() no longer walks the name map from
+  // the beginning for every query.
+  m_sortedSectionIndices.reserve(m_map.size());
+  for (auto &entry : m_map)
+    m_sortedSectionIndices.push_back(entry.second);
+
+  // All symbols, grouped by owning section and sorted by value within each group, with a per-section span so
+  // GetSymbolsBySectionIndex() is a plain copy of the precomputed range.
+  m_symbolSpans.resize(m_sections.size(), {0, 0});
+  if (m_symSecIdx >= 0 && m_strtabSecIdx >= 0) {
+    auto &section = m_sections[m_symSecIdx];
+    const char *strTab = reinterpret_cast<const char *>(m_sections[m_strtabSecIdx]->data);
+
+    auto symbols = reinterpret_cast<const typename Elf::Symbol *>(section->data);
+    const unsigned symCount = getSymbolCount();
+    m_sortedSymbols.reserve(symCount);
+
+    ElfSymbol symbol = {};
+    for (unsigned idx = 0; idx < symCount; ++idx) {
+      // Symbols not attached to a real section (undefined/absolute) are never returned by section queries.
+      if (symbols[idx].st_shndx >= m_sections.size())
+        continue;
+
+      symbol.secIdx = symbols[idx].st_shndx;
+      symbol.secName = m_sections[symbol.secIdx]->name;
+      symbol.pSymName = strTab + symbols[idx].st_name;
+      symbol.size = symbols[idx].st_size;
+      symbol.value = symbols[idx].st_value;
+      symbol.info.all = symbols[idx].st_info.all;
+
+      m_sortedSymbols.push_back(symbol);
+    }
+
+    std::sort(m_sortedSymbols.begin(), m_sortedSymbols.end(), [](const ElfSymbol &a, const ElfSymbol &b) {
+      return a.secIdx != b.secIdx ? a.secIdx < b.secIdx : a.value < b.value;
+    });
+
+    for (unsigned idx = 0; idx < m_sortedSymbols.size(); ++idx) {
+      auto &span = m_symbolSpans[m_sortedSymbols[idx].secIdx];
+      if (span.second == 0)
+        span.first = idx;
+      span.second = idx + 1;
+    }
+  }
+}
+
 // =====================================================================================================================
 // Retrieves the section data for the specified section name, if it exists.
 //
@@ -250,12 +307,9 @@ template <class Elf>
 Result ElfReader<Elf>::getSectionDataBySortingIndex(unsigned sortIdx, unsigned *secIdx,
                                                     SectionBuffer **ppSectionData) const {
   Result result = Result::ErrorInvalidValue;
-  if (sortIdx < m_sections.size()) {
-    auto it = m_map.begin();
-    for (unsigned i = 0; i < sortIdx; ++i)
-      ++it;
-    *secIdx = it->second;
-    *ppSectionData = m_sections[it->second];
+  if (sortIdx < m_sortedSectionIndices.size()) {
+    *secIdx = m_sortedSectionIndices[sortIdx];
+    *ppSectionData = m_sections[*secIdx];
     result = Result::Success;
   }
   return result;
@@ -268,29 +322,11 @@ Result ElfReader<Elf>::getSectionDataBySortingIndex(unsigned sortIdx, unsigned *
 // @param [out] secSymbols : ELF symbols
 template <class Elf>
 void ElfReader<Elf>::GetSymbolsBySectionIndex(unsigned secIdx, std::vector<ElfSymbol> &secSymbols) const {
-  if (secIdx < m_sections.size() && m_symSecIdx >= 0) {
-    auto &section = m_sections[m_symSecIdx];
-    const char *strTab = reinterpret_cast<const char *>(m_sections[m_strtabSecIdx]->data);
-
-    auto symbols = reinterpret_cast<const typename Elf::Symbol *>(section->data);
-    unsigned symCount = getSymbolCount();
-    ElfSymbol symbol = {};
-
-    for (unsigned idx = 0; idx < symCount; ++idx) {
-      if (symbols[idx].st_shndx == secIdx) {
-        symbol.secIdx = symbols[idx].st_shndx;
-        symbol.secName = m_sections[symbol.secIdx]->name;
-        symbol.pSymName = strTab + symbols[idx].st_name;
-        symbol.size = symbols[idx].st_size;
-        symbol.value = symbols[idx].st_value;
-        symbol.info.all = symbols[idx].st_info.all;
-
-        secSymbols.push_back(symbol);
-      }
-    }
-
-    std::sort(secSymbols.begin(), secSymbols.end(),
-              [](const ElfSymbol &a, const ElfSymbol &b) { return a.value < b.value; });
+  if (secIdx < m_symbolSpans.size()) {
+    // The symbols were grouped by section and sorted by value when the ELF was read, so this is a copy of the
+    // precomputed range rather than a rescan of the whole symbol table.
+    const auto &span = m_symbolSpans[secIdx];
+    secSymbols.insert(secSymbols.end(), m_sortedSymbols.begin() + span.first, m_sortedSymbols.begin() + span.second);
   }
 }
 
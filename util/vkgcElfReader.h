@@ -33,6 +33,7 @@
 #include <functional>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 #include "llvm/BinaryFormat/MsgPackDocument.h"
 
@@ -396,6 +397,11 @@ struct MsgPackIterator {
 //
 // The client should call "ReadFromBuffer()" to initialize the context with the contents of an ELF, then
 // "GetSectionData()" to retrieve the contents of a particular named section.
+//
+// The reader is non-owning and zero-copy: section data and names reference the caller's buffer (which may be a
+// memory-mapped file) in place, so reading an ELF for inspection or merge costs no allocation or memcpy of the
+// contents. The buffer must stay alive and unmodified for the lifetime of the reader and anything that retains
+// pointers obtained from it.
 template <class Elf> class ElfReader {
 public:
   typedef ElfSectionBuffer<typename Elf::SectionHeader> SectionBuffer;
@@ -479,11 +485,22 @@ private:
   ElfReader(const ElfReader &) = delete;
   ElfReader &operator=(const ElfReader &) = delete;
 
+  void buildIndices();
+
   GfxIpVersion m_gfxIp; // Graphics IP version info (used by ELF dump only)
 
-  typename Elf::FormatHeader m_header;     // ELF header
-  std::map<std::string, uint32_t> m_map;   // Map between section name and section index
-  std::vector<SectionBuffer *> m_sections; // List of section data and headers
+  typename Elf::FormatHeader m_header;         // ELF header
+  std::map<std::string, uint32_t> m_map;       // Map between section name and section index
+  std::vector<SectionBuffer> m_sectionStorage; // Contiguous storage of the section buffers; reserved up front
+                                               //  in ReadFromBuffer so the pointers below stay valid
+  std::vector<SectionBuffer *> m_sections;     // List of section data and headers
+
+  // One-time query indices built by buildIndices() once the section and symbol tables are known. The reader is
+  // immutable after ReadFromBuffer(), so the merge and dump paths can issue per-section queries in O(1) instead
+  // of rescanning the symbol table or re-walking the name map for every call.
+  std::vector<ElfSymbol> m_sortedSymbols;       // All symbols, grouped by section index and sorted by value
+  std::vector<std::pair<uint32_t, uint32_t>> m_symbolSpans; // Per-section [begin, end) range into m_sortedSymbols
+  std::vector<uint32_t> m_sortedSectionIndices; // Section indices in section-name order (mirrors m_map)
 
   int32_t m_symSecIdx;    // Index of symbol section
   int32_t m_relocSecIdx;  // Index of relocation section
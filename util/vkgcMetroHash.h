@@ -31,6 +31,7 @@
 #pragma once
 
 #include "metrohash.h"
+#include <cstddef>
 
 // Namespace containing functions that provide support for MetroHash.
 namespace MetroHash {
@@ -43,6 +44,63 @@ struct Hash {
   };
 };
 
+// Describes one input buffer for the multi-buffer hashing interface.
+struct BufferRange {
+  const void *data; // Start of the buffer
+  size_t size;      // Byte size of the buffer
+};
+
+// Computes an independent hash with the given hasher type for each of the given buffers in a single
+// interleaved pass. See hash64Buffers/hash128Buffers for the public interface.
+template <class Hasher> inline void hashBuffers(const BufferRange *buffers, unsigned bufferCount, Hash *hashes) {
+  // Cap on the number of hash states kept live at once; larger requests are processed in batches.
+  constexpr unsigned MaxStreams = 8;
+  constexpr size_t ChunkSize = 64 * 1024;
+
+  for (unsigned base = 0; base < bufferCount; base += MaxStreams) {
+    const unsigned count = bufferCount - base < MaxStreams ? bufferCount - base : MaxStreams;
+    Hasher hashers[MaxStreams];
+
+    for (size_t offset = 0, remaining = count; remaining > 0; offset += ChunkSize) {
+      remaining = 0;
+      for (unsigned i = 0; i < count; ++i) {
+        const BufferRange &buffer = buffers[base + i];
+        if (offset >= buffer.size)
+          continue;
+        const size_t chunk = buffer.size - offset < ChunkSize ? buffer.size - offset : ChunkSize;
+        hashers[i].Update(static_cast<const uint8_t *>(buffer.data) + offset, chunk);
+        if (offset + chunk < buffer.size)
+          ++remaining;
+      }
+    }
+
+    for (unsigned i = 0; i < count; ++i)
+      hashers[i].Finalize(hashes[base + i].bytes);
+  }
+}
+
+// Computes an independent 64-bit hash for each of the given buffers in a single interleaved pass.
+//
+// The buffers are walked in lockstep in large chunks, so the independent hash states can pipeline their
+// multiplies against each other, and buffers that alias each other (e.g. two digests over mostly the same
+// module bytes) stay cache-hot across the streams. The digest written for each buffer is identical to what
+// MetroHash64::Hash produces over that buffer alone.
+//
+// Takes input parameters buffers and bufferCount describing the buffers to hash, and writes one digest per
+// buffer to hashes. Like MetroHash64::Hash, only the low 64 bits of each output Hash are written; callers
+// should zero-initialize the array.
+inline void hash64Buffers(const BufferRange *buffers, unsigned bufferCount, Hash *hashes) {
+  hashBuffers<MetroHash64>(buffers, bufferCount, hashes);
+}
+
+// Computes an independent 128-bit hash for each of the given buffers in a single interleaved pass.
+//
+// Same as hash64Buffers, but each digest is identical to what MetroHash128::Hash produces over that buffer
+// alone, and all 128 bits of each output Hash are written.
+inline void hash128Buffers(const BufferRange *buffers, unsigned bufferCount, Hash *hashes) {
+  hashBuffers<MetroHash128>(buffers, bufferCount, hashes);
+}
+
 // Compacts a 128-bit hash into a 64-bit one by XOR'ing the low and high 64-bits together.
 //
 // Takes input parameter pHash, which is 128-bit hash to be compacted.